@@ -116,6 +116,50 @@ static void BM_Time_Parse(benchmark::State& state) {
 }
 BENCHMARK(BM_Time_Parse);
 
+/* Layouts Discord sends for timestamp, edited_timestamp, joined_at, premium_since */
+static const char* const kDiscordTimestamps[] = {
+    "2023-01-01T12:34:56.789000+00:00",
+    "2023-01-01T12:34:56.789+00:00",
+    "2023-01-01T12:34:56+00:00",
+};
+static const size_t kDiscordTimestampCount = sizeof(kDiscordTimestamps) / sizeof(kDiscordTimestamps[0]);
+
+static void BM_Time_ParseUnixMs_General(benchmark::State& state) {
+    size_t total_bytes = 0;
+    size_t i = 0;
+    for (auto _ : state) {
+        const char* iso = kDiscordTimestamps[i++ % kDiscordTimestampCount];
+        dc_iso8601_t ts;
+        uint64_t ms = 0;
+        dc_status_t st = dc_iso8601_parse(iso, &ts);
+        if (st == DC_OK) st = dc_iso8601_to_unix_ms(&ts, &ms);
+        benchmark::DoNotOptimize(st);
+        benchmark::DoNotOptimize(ms);
+        total_bytes += strlen(iso);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(total_bytes));
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+BENCHMARK(BM_Time_ParseUnixMs_General);
+
+static void BM_Time_ParseUnixMs_Fast(benchmark::State& state) {
+    size_t lengths[kDiscordTimestampCount];
+    for (size_t k = 0; k < kDiscordTimestampCount; k++) lengths[k] = strlen(kDiscordTimestamps[k]);
+    size_t total_bytes = 0;
+    size_t i = 0;
+    for (auto _ : state) {
+        size_t k = i++ % kDiscordTimestampCount;
+        int64_t ms = 0;
+        dc_status_t st = dc_iso8601_parse_unix_ms(kDiscordTimestamps[k], lengths[k], &ms);
+        benchmark::DoNotOptimize(st);
+        benchmark::DoNotOptimize(ms);
+        total_bytes += lengths[k];
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(total_bytes));
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+BENCHMARK(BM_Time_ParseUnixMs_Fast);
+
 static void BM_String_Append(benchmark::State& state) {
     const char* part = "abcdefghij";
     const size_t reps = static_cast<size_t>(state.range(0));
@@ -4,9 +4,11 @@
  */
 
 #include <benchmark/benchmark.h>
+#include <cstring>
 
 extern "C" {
 #include "core/dc_format.h"
+#include "core/dc_markdown.h"
 #include "core/dc_allowed_mentions.h"
 #include "json/dc_json.h"
 }
@@ -74,4 +76,68 @@ static void BM_AllowedMentions_Build(benchmark::State& state) {
 }
 BENCHMARK(BM_AllowedMentions_Build);
 
+/* Mix of chat lines, announcements, code help and link shares */
+static const char* const kMarkdownCorpus[] = {
+    "lol yeah that's what I said yesterday",
+    "hey <@123456789012345678> can you check <#234567890123456789> when you get a sec?",
+    "**Patch notes** for v2.3 are up: https://example.com/blog/patch-2-3 <:pepe_yes:345678901234567890>",
+    "try this:\n```c\nint main(void) {\n    printf(\"<@1> is not a mention\\n\");\n    return 0;\n}\n```\nthen run `make test`",
+    "||ending spoiler: the butler did it|| ~~don't~~ read if you haven't finished",
+    "event starts <t:1700000000:R> (<t:1700000000:F>) in <#345678901234567890>, ping <@&456789012345678901> for roles",
+    "@everyone server maintenance tonight, see <https://status.example.com/incidents/42> for details",
+    "i_think_snake_case_names are fine but __underline__ and *italics* and ***both*** render weird on mobile",
+    "<a:blob_dance:567890123456789012><a:blob_dance:567890123456789012> gg wp </leaderboard:678901234567890123>",
+    "Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do eiusmod tempor incididunt ut labore et "
+    "dolore magna aliqua. Ut enim ad minim veniam, quis nostrud exercitation ullamco laboris nisi ut aliquip.",
+};
+static const size_t kMarkdownCorpusCount = sizeof(kMarkdownCorpus) / sizeof(kMarkdownCorpus[0]);
+
+static void BM_Markdown_Tokenize_Corpus(benchmark::State& state) {
+    size_t lengths[kMarkdownCorpusCount];
+    size_t corpus_bytes = 0;
+    for (size_t i = 0; i < kMarkdownCorpusCount; i++) {
+        lengths[i] = strlen(kMarkdownCorpus[i]);
+        corpus_bytes += lengths[i];
+    }
+    for (auto _ : state) {
+        size_t tokens = 0;
+        for (size_t i = 0; i < kMarkdownCorpusCount; i++) {
+            dc_markdown_tokenizer_t tok;
+            dc_markdown_token_t token;
+            dc_markdown_tokenizer_init(&tok, kMarkdownCorpus[i], lengths[i]);
+            while (dc_markdown_next(&tok, &token)) tokens++;
+        }
+        benchmark::DoNotOptimize(tokens);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * corpus_bytes));
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * kMarkdownCorpusCount));
+}
+BENCHMARK(BM_Markdown_Tokenize_Corpus);
+
+static void BM_Markdown_ExtractMentions_Corpus(benchmark::State& state) {
+    size_t lengths[kMarkdownCorpusCount];
+    size_t corpus_bytes = 0;
+    for (size_t i = 0; i < kMarkdownCorpusCount; i++) {
+        lengths[i] = strlen(kMarkdownCorpus[i]);
+        corpus_bytes += lengths[i];
+    }
+    for (auto _ : state) {
+        dc_snowflake_t sum = 0;
+        for (size_t i = 0; i < kMarkdownCorpusCount; i++) {
+            dc_markdown_tokenizer_t tok;
+            dc_markdown_token_t token;
+            dc_markdown_tokenizer_init(&tok, kMarkdownCorpus[i], lengths[i]);
+            while (dc_markdown_next(&tok, &token)) {
+                if (token.type == DC_MARKDOWN_TOKEN_USER_MENTION && !(token.styles & DC_MARKDOWN_STYLE_SPOILER)) {
+                    sum += token.id;
+                }
+            }
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * corpus_bytes));
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * kMarkdownCorpusCount));
+}
+BENCHMARK(BM_Markdown_ExtractMentions_Corpus);
+
 BENCHMARK_MAIN();
@@ -10,8 +10,29 @@ extern "C" {
 #include "gw/dc_gateway.h"
 #include "gw/dc_events.h"
 #include "core/dc_status.h"
+#include "http/dc_tls_sessions.h"
 }
 
+#if defined(DC_HAVE_OPENSSL) && defined(__linux__)
+#include <openssl/evp.h>
+#include <openssl/pem.h>
+#include <openssl/ssl.h>
+#include <openssl/x509.h>
+#include <openssl/x509v3.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <signal.h>
+#include <stdio.h>
+#include <strings.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#endif
+
 static dc_gateway_config_t bench_gateway_default_config(void) {
     dc_gateway_config_t cfg;
     memset(&cfg, 0, sizeof(cfg));
@@ -260,4 +281,286 @@ static void BM_Gateway_ParseThreadChannel(benchmark::State& state) {
 }
 BENCHMARK(BM_Gateway_ParseThreadChannel);
 
+#if defined(DC_HAVE_OPENSSL) && defined(__linux__)
+/*
+ * The library's gateway receive path over a loopback TLS connection: a
+ * minimal wss server upgrades the connection, sends HELLO and then streams
+ * MESSAGE_CREATE dispatches, which a dc_gateway_client_t receives through
+ * libwebsockets, parses and hands to its event callback. The client trusts
+ * the server's self-signed certificate through extra_ca_pem. One iteration
+ * is about 1 MiB of frames, so CPU time per iteration is client CPU per
+ * gateway MB (the server thread runs in the same process, so compare the
+ * two args rather than reading absolute numbers).
+ * Arg 1 enables kernel TLS offload; the server pins TLS 1.2 with AES-GCM so
+ * the connection is offloadable. Where the kernel or OpenSSL lacks kTLS the
+ * run falls back to userspace TLS, and ktls_rx reads 0.
+ */
+static const size_t kTlsBenchBytes = 1024u * 1024u;
+static const size_t kTlsBenchRecord = 16u * 1024u;
+static const int kTlsBenchIoTimeoutSec = 5;
+static const uint64_t kTlsBenchIterationTimeoutMs = 10000u;
+
+/* Self-signed server context for "localhost"; the certificate is returned as PEM. */
+static SSL_CTX* bench_tls_server_ctx(std::string* cert_pem) {
+    SSL_CTX* ctx = SSL_CTX_new(TLS_server_method());
+    if (!ctx) return NULL;
+    SSL_CTX_set_max_proto_version(ctx, TLS1_2_VERSION);
+    SSL_CTX_set_cipher_list(ctx, "ECDHE-ECDSA-AES128-GCM-SHA256");
+    dc_tls_configure_ssl_ctx(ctx);
+
+    EVP_PKEY* pkey = NULL;
+    EVP_PKEY_CTX* kctx = EVP_PKEY_CTX_new_id(EVP_PKEY_EC, NULL);
+    if (kctx && EVP_PKEY_keygen_init(kctx) > 0 &&
+        EVP_PKEY_CTX_set_ec_paramgen_curve_nid(kctx, NID_X9_62_prime256v1) > 0) {
+        EVP_PKEY_keygen(kctx, &pkey);
+    }
+    EVP_PKEY_CTX_free(kctx);
+    X509* cert = X509_new();
+    int ok = pkey && cert;
+    if (ok) {
+        X509_set_version(cert, 2);
+        ASN1_INTEGER_set(X509_get_serialNumber(cert), 1);
+        X509_gmtime_adj(X509_getm_notBefore(cert), 0);
+        X509_gmtime_adj(X509_getm_notAfter(cert), 3600L);
+        X509_set_pubkey(cert, pkey);
+        X509_NAME* name = X509_get_subject_name(cert);
+        X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC, (const unsigned char*)"localhost", -1, -1, 0);
+        X509_set_issuer_name(cert, name);
+        X509V3_CTX v3;
+        X509V3_set_ctx_nodb(&v3);
+        X509V3_set_ctx(&v3, cert, cert, NULL, NULL, 0);
+        X509_EXTENSION* san = X509V3_EXT_conf_nid(NULL, &v3, NID_subject_alt_name,
+                                                  "DNS:localhost,IP:127.0.0.1");
+        ok = san && X509_add_ext(cert, san, -1) == 1;
+        X509_EXTENSION_free(san);
+        ok = ok && X509_sign(cert, pkey, EVP_sha256()) > 0 &&
+             SSL_CTX_use_certificate(ctx, cert) == 1 &&
+             SSL_CTX_use_PrivateKey(ctx, pkey) == 1;
+    }
+    BIO* bio = ok ? BIO_new(BIO_s_mem()) : NULL;
+    ok = bio && PEM_write_bio_X509(bio, cert) == 1;
+    if (ok) {
+        char* data = NULL;
+        long len = BIO_get_mem_data(bio, &data);
+        cert_pem->assign(data, len > 0 ? (size_t)len : 0u);
+    }
+    BIO_free(bio);
+    X509_free(cert);
+    EVP_PKEY_free(pkey);
+    if (!ok) {
+        SSL_CTX_free(ctx);
+        return NULL;
+    }
+    return ctx;
+}
+
+static int bench_ws_write_all(SSL* ssl, const std::string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        int n = SSL_write(ssl, data.data() + sent, (int)(data.size() - sent));
+        if (n <= 0) return 0;
+        sent += (size_t)n;
+    }
+    return 1;
+}
+
+/* Appends one unmasked server text frame. */
+static void bench_ws_append_text(std::string* out, const char* payload, size_t len) {
+    out->push_back((char)0x81);
+    if (len < 126u) {
+        out->push_back((char)len);
+    } else if (len <= 0xFFFFu) {
+        out->push_back((char)126);
+        out->push_back((char)(len >> 8));
+        out->push_back((char)(len & 0xFFu));
+    } else {
+        out->push_back((char)127);
+        for (int shift = 56; shift >= 0; shift -= 8) out->push_back((char)(((uint64_t)len >> shift) & 0xFFu));
+    }
+    out->append(payload, len);
+}
+
+/* Value of a request header, matched case-insensitively; empty when absent. */
+static std::string bench_http_header(const std::string& request, const char* name) {
+    size_t name_len = strlen(name);
+    size_t line = request.find("\r\n");
+    while (line != std::string::npos && line + 2u < request.size()) {
+        size_t start = line + 2u;
+        size_t next = request.find("\r\n", start);
+        if (next == std::string::npos) break;
+        if (next - start > name_len && strncasecmp(request.c_str() + start, name, name_len) == 0 &&
+            request[start + name_len] == ':') {
+            size_t v = start + name_len + 1u;
+            while (v < next && request[v] == ' ') v++;
+            return request.substr(v, next - v);
+        }
+        line = next;
+    }
+    return std::string();
+}
+
+/* Reads the upgrade request and answers 101; 0 on any failure. */
+static int bench_ws_accept(SSL* ssl) {
+    std::string request;
+    char chunk[1024];
+    while (request.find("\r\n\r\n") == std::string::npos) {
+        if (request.size() > 16u * 1024u) return 0;
+        int n = SSL_read(ssl, chunk, (int)sizeof(chunk));
+        if (n <= 0) return 0;
+        request.append(chunk, (size_t)n);
+    }
+    std::string key = bench_http_header(request, "Sec-WebSocket-Key");
+    if (key.empty()) return 0;
+    key += "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+    unsigned char digest[EVP_MAX_MD_SIZE];
+    unsigned int digest_len = 0;
+    if (EVP_Digest(key.data(), key.size(), digest, &digest_len, EVP_sha1(), NULL) != 1) return 0;
+    unsigned char accept[64];
+    EVP_EncodeBlock(accept, digest, (int)digest_len);
+
+    std::string response = "HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\n"
+                           "Connection: Upgrade\r\nSec-WebSocket-Accept: ";
+    response += (const char*)accept;
+    response += "\r\n";
+    std::string protocol = bench_http_header(request, "Sec-WebSocket-Protocol");
+    if (!protocol.empty()) response += "Sec-WebSocket-Protocol: " + protocol + "\r\n";
+    response += "\r\n";
+    return bench_ws_write_all(ssl, response);
+}
+
+/*
+ * Serves one connection: HELLO, then dispatches until the client goes away,
+ * stop is set, or a read/write times out. Every socket call is bounded by
+ * kTlsBenchIoTimeoutSec, so join() cannot hang on a client that never shows up.
+ */
+static void bench_ws_serve(SSL_CTX* ctx, int listen_fd, std::atomic<bool>* stop) {
+    int fd = accept(listen_fd, NULL, NULL);
+    if (fd < 0) return;
+    struct timeval tv;
+    tv.tv_sec = kTlsBenchIoTimeoutSec;
+    tv.tv_usec = 0;
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+    SSL* ssl = SSL_new(ctx);
+    SSL_set_fd(ssl, fd);
+    if (SSL_accept(ssl) == 1 && bench_ws_accept(ssl)) {
+        std::string out;
+        static const char kHello[] = "{\"op\":10,\"d\":{\"heartbeat_interval\":3600000}}";
+        bench_ws_append_text(&out, kHello, sizeof(kHello) - 1u);
+        char payload[2048];
+        unsigned long long seq = 0;
+        while (!stop->load(std::memory_order_relaxed)) {
+            int n = snprintf(payload, sizeof(payload), "{\"op\":0,\"s\":%llu,\"t\":\"MESSAGE_CREATE\",\"d\":%s}",
+                             ++seq, kMessageCreateJson);
+            if (n <= 0 || (size_t)n >= sizeof(payload)) break;
+            bench_ws_append_text(&out, payload, (size_t)n);
+            if (out.size() >= kTlsBenchRecord) {
+                if (!bench_ws_write_all(ssl, out)) break;
+                out.clear();
+            }
+        }
+    }
+    SSL_free(ssl);
+    close(fd);
+}
+
+static void bench_gateway_rx_event(const char* event_name, const char* event_data, void* user_data) {
+    (void)event_name;
+    benchmark::DoNotOptimize(event_data);
+    (*static_cast<uint64_t*>(user_data))++;
+}
+
+static uint64_t bench_now_ms(void) {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+/* Services the client until events reaches target; 0 on error or timeout. */
+static int bench_gateway_pump(dc_gateway_client_t* gw, const uint64_t* events, uint64_t target) {
+    uint64_t deadline = bench_now_ms() + kTlsBenchIterationTimeoutMs;
+    while (*events < target) {
+        if (dc_gateway_client_process(gw, 50) != DC_OK) return 0;
+        if (bench_now_ms() > deadline) return 0;
+    }
+    return 1;
+}
+
+static void BM_Gateway_TlsLoopback_ReceiveMB(benchmark::State& state) {
+    int offload = (int)state.range(0);
+    if (dc_tls_set_kernel_offload(offload) != DC_OK) {
+        state.SkipWithError("kernel TLS offload not built in");
+        return;
+    }
+    /* A client that disconnects mid-write must fail the server's SSL_write, not kill the run. */
+    signal(SIGPIPE, SIG_IGN);
+
+    std::string cert_pem;
+    SSL_CTX* server_ctx = bench_tls_server_ctx(&cert_pem);
+    int listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t alen = sizeof(addr);
+    struct timeval tv;
+    tv.tv_sec = kTlsBenchIoTimeoutSec;
+    tv.tv_usec = 0;
+    if (!server_ctx || listen_fd < 0 ||
+        setsockopt(listen_fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv)) != 0 ||
+        bind(listen_fd, (struct sockaddr*)&addr, sizeof(addr)) != 0 || listen(listen_fd, 1) != 0 ||
+        getsockname(listen_fd, (struct sockaddr*)&addr, &alen) != 0) {
+        state.SkipWithError("loopback TLS setup failed");
+        if (listen_fd >= 0) close(listen_fd);
+        SSL_CTX_free(server_ctx);
+        dc_tls_set_kernel_offload(0);
+        return;
+    }
+    std::atomic<bool> stop(false);
+    std::thread server(bench_ws_serve, server_ctx, listen_fd, &stop);
+
+    /* Frames carry a growing sequence number; size the iteration from a typical one. */
+    char sample[2048];
+    int sample_len = snprintf(sample, sizeof(sample), "{\"op\":0,\"s\":%llu,\"t\":\"MESSAGE_CREATE\",\"d\":%s}",
+                              100000ULL, kMessageCreateJson);
+    uint64_t frames_per_iter = kTlsBenchBytes / (uint64_t)(sample_len > 0 ? sample_len : 1);
+
+    uint64_t events = 0;
+    dc_gateway_config_t cfg = bench_gateway_default_config();
+    cfg.event_callback = bench_gateway_rx_event;
+    cfg.user_data = &events;
+    cfg.connect_timeout_ms = (uint32_t)kTlsBenchIoTimeoutSec * 1000u;
+    cfg.extra_ca_pem = cert_pem.c_str();
+    char url[64];
+    snprintf(url, sizeof(url), "wss://localhost:%u", (unsigned)ntohs(addr.sin_port));
+
+    dc_tls_sessions_reset_stats();
+    dc_gateway_client_t* gw = NULL;
+    int ok = dc_gateway_client_create(&cfg, &gw) == DC_OK &&
+             dc_gateway_client_connect(gw, url) == DC_OK &&
+             bench_gateway_pump(gw, &events, 1u);
+
+    for (auto _ : state) {
+        if (!ok) break;
+        ok = bench_gateway_pump(gw, &events, events + frames_per_iter);
+    }
+    if (!ok) state.SkipWithError("loopback gateway receive failed");
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                            static_cast<int64_t>(frames_per_iter) * static_cast<int64_t>(sample_len));
+    dc_tls_session_stats_t stats;
+    dc_tls_sessions_get_stats(&stats);
+    state.counters["ktls_tx"] = static_cast<double>(stats.gateway.ktls_tx);
+    state.counters["ktls_rx"] = static_cast<double>(stats.gateway.ktls_rx);
+
+    stop.store(true, std::memory_order_relaxed);
+    dc_gateway_client_free(gw);
+    /* Wakes an accept() still waiting for a client that never connected. */
+    shutdown(listen_fd, SHUT_RDWR);
+    server.join();
+    close(listen_fd);
+    SSL_CTX_free(server_ctx);
+    dc_tls_set_kernel_offload(0);
+}
+BENCHMARK(BM_Gateway_TlsLoopback_ReceiveMB)->Arg(0)->Arg(1)->UseRealTime();
+#endif
+
 BENCHMARK_MAIN();
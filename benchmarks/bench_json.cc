@@ -1,9 +1,17 @@
 #include <benchmark/benchmark.h>
 #include <cstring>
+#include <string>
+#include <vector>
+#include <yyjson.h>
 
 extern "C" {
 #include "json/dc_json.h"
 #include "core/dc_string.h"
+#include "core/dc_arena.h"
+#include "json/dc_json_model.h"
+#include "json/dc_json_component_node.h"
+#include "model/dc_component.h"
+#include "model/dc_component_node.h"
 #include "model/dc_user.h"
 #include "model/dc_channel.h"
 #include "model/dc_message.h"
@@ -784,4 +792,181 @@ static void BM_JSON_Model_InitFree_Message(benchmark::State& state) {
 }
 BENCHMARK(BM_JSON_Model_InitFree_Message);
 
+/* Components V2 layout: a container of sections plus button and select rows */
+static std::string dc_bench_components_json() {
+    std::string json = "[{\"type\":17,\"accent_color\":3447003,\"components\":[";
+    for (int i = 0; i < 8; i++) {
+        if (i > 0) json += ",";
+        std::string n = std::to_string(i);
+        json += "{\"type\":9,\"components\":[{\"type\":10,\"content\":\"**Item " + n +
+                "** with a short description\"}],\"accessory\":{\"type\":2,\"style\":2,"
+                "\"custom_id\":\"item:" + n + "\",\"label\":\"Open\"}}";
+    }
+    json += ",{\"type\":14,\"divider\":true,\"spacing\":1}]}";
+    for (int row = 0; row < 3; row++) {
+        json += ",{\"type\":1,\"components\":[";
+        for (int b = 0; b < 5; b++) {
+            if (b > 0) json += ",";
+            std::string n = std::to_string(row * 5 + b);
+            json += "{\"type\":2,\"style\":1,\"custom_id\":\"btn:" + n + "\",\"label\":\"Button " + n +
+                    "\",\"emoji\":{\"id\":\"123456789012345678\",\"name\":\"e" + n + "\"}}";
+        }
+        json += "]}";
+    }
+    json += ",{\"type\":1,\"components\":[{\"type\":3,\"custom_id\":\"pick\",\"placeholder\":\"Choose\","
+            "\"min_values\":1,\"max_values\":3,\"options\":[";
+    for (int o = 0; o < 10; o++) {
+        if (o > 0) json += ",";
+        std::string n = std::to_string(o);
+        json += "{\"label\":\"Option " + n + "\",\"value\":\"opt" + n + "\",\"description\":\"Choice " + n + "\"}";
+    }
+    json += "]}]}]";
+    return json;
+}
+
+static const std::string& dc_bench_components() {
+    static const std::string json = dc_bench_components_json();
+    return json;
+}
+
+static dc_status_t dc_bench_decode_components_fat(yyjson_val* arr, std::vector<dc_component_t>& out) {
+    size_t idx, max;
+    yyjson_val* item;
+    yyjson_arr_foreach(arr, idx, max, item) {
+        dc_component_t component;
+        dc_status_t st = dc_component_init(&component);
+        if (st == DC_OK) st = dc_json_model_component_from_val(item, &component);
+        if (st != DC_OK) {
+            dc_component_free(&component);
+            return st;
+        }
+        out.push_back(component);
+    }
+    return DC_OK;
+}
+
+static void dc_bench_free_components_fat(std::vector<dc_component_t>& components) {
+    for (dc_component_t& component : components) dc_component_free(&component);
+    components.clear();
+}
+
+static void BM_JSON_Components_Decode_Fat(benchmark::State& state) {
+    const std::string& json = dc_bench_components();
+    size_t total_bytes = 0;
+    std::vector<dc_component_t> components;
+    for (auto _ : state) {
+        dc_json_doc_t doc;
+        dc_status_t st = dc_json_parse(json.c_str(), &doc);
+        if (st == DC_OK) {
+            st = dc_bench_decode_components_fat(doc.root, components);
+            dc_json_doc_free(&doc);
+        }
+        benchmark::DoNotOptimize(st);
+        benchmark::DoNotOptimize(components.data());
+        dc_bench_free_components_fat(components);
+        total_bytes += json.size();
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(total_bytes));
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+BENCHMARK(BM_JSON_Components_Decode_Fat);
+
+static void BM_JSON_Components_Decode_Compact(benchmark::State& state) {
+    const std::string& json = dc_bench_components();
+    dc_arena_t arena;
+    if (dc_arena_init(&arena, 0) != DC_OK) {
+        state.SkipWithError("dc_arena_init failed");
+        return;
+    }
+    size_t total_bytes = 0;
+    for (auto _ : state) {
+        dc_arena_reset(&arena);
+        dc_component_children_t list = {};
+        dc_status_t st = dc_json_component_nodes_parse(json.c_str(), &arena, &list);
+        benchmark::DoNotOptimize(st);
+        benchmark::DoNotOptimize(list.first);
+        total_bytes += json.size();
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(total_bytes));
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+    dc_arena_free(&arena);
+}
+BENCHMARK(BM_JSON_Components_Decode_Compact);
+
+static void BM_JSON_Components_Encode_Fat(benchmark::State& state) {
+    dc_json_doc_t parsed;
+    if (dc_json_parse(dc_bench_components().c_str(), &parsed) != DC_OK) {
+        state.SkipWithError("dc_json_parse failed");
+        return;
+    }
+    std::vector<dc_component_t> components;
+    dc_status_t decoded = dc_bench_decode_components_fat(parsed.root, components);
+    dc_json_doc_free(&parsed);
+    if (decoded != DC_OK) {
+        dc_bench_free_components_fat(components);
+        state.SkipWithError("component decode failed");
+        return;
+    }
+    dc_string_t out;
+    if (dc_string_init(&out) != DC_OK) {
+        dc_bench_free_components_fat(components);
+        state.SkipWithError("dc_string_init failed");
+        return;
+    }
+    size_t total_bytes = 0;
+    for (auto _ : state) {
+        dc_json_mut_doc_t doc;
+        dc_status_t st = dc_json_mut_doc_create(&doc);
+        if (st == DC_OK) {
+            doc.root = yyjson_mut_arr(doc.doc);
+            yyjson_mut_doc_set_root(doc.doc, doc.root);
+            for (const dc_component_t& component : components) {
+                yyjson_mut_val* obj = yyjson_mut_arr_add_obj(doc.doc, doc.root);
+                st = obj ? dc_json_model_component_to_mut(&doc, obj, &component) : DC_ERROR_OUT_OF_MEMORY;
+                if (st != DC_OK) break;
+            }
+            if (st == DC_OK) st = dc_json_write_mut_doc_to_string(doc.doc, 0, &out);
+            dc_json_mut_doc_free(&doc);
+        }
+        benchmark::DoNotOptimize(st);
+        total_bytes += dc_string_length(&out);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(total_bytes));
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+    dc_string_free(&out);
+    dc_bench_free_components_fat(components);
+}
+BENCHMARK(BM_JSON_Components_Encode_Fat);
+
+static void BM_JSON_Components_Encode_Compact(benchmark::State& state) {
+    dc_arena_t arena;
+    if (dc_arena_init(&arena, 0) != DC_OK) {
+        state.SkipWithError("dc_arena_init failed");
+        return;
+    }
+    dc_component_children_t list = {};
+    if (dc_json_component_nodes_parse(dc_bench_components().c_str(), &arena, &list) != DC_OK) {
+        dc_arena_free(&arena);
+        state.SkipWithError("dc_json_component_nodes_parse failed");
+        return;
+    }
+    dc_string_t out;
+    if (dc_string_init(&out) != DC_OK) {
+        dc_arena_free(&arena);
+        state.SkipWithError("dc_string_init failed");
+        return;
+    }
+    size_t total_bytes = 0;
+    for (auto _ : state) {
+        dc_status_t st = dc_json_component_nodes_serialize(&list, &out);
+        benchmark::DoNotOptimize(st);
+        total_bytes += dc_string_length(&out);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(total_bytes));
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+    dc_string_free(&out);
+    dc_arena_free(&arena);
+}
+BENCHMARK(BM_JSON_Components_Encode_Compact);
+
 BENCHMARK_MAIN();
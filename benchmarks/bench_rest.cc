@@ -0,0 +1,283 @@
+/**
+ * @file bench_rest.cc
+ * @brief REST hot-path benchmarks over a no-op transport
+ *
+ * The transport answers every request with a canned 200 and rate limit
+ * headers, so the timings only contain library work: route-key building,
+ * bucket lookup and locking, header formatting, rate limit and body parsing.
+ * Arg 0 is the number of distinct routes (one bucket each) the requests
+ * cycle through. allocs_per_req counts dc_alloc/dc_realloc calls made by the
+ * library per request; allocations inside the transport are not counted.
+ */
+
+#include <benchmark/benchmark.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+extern "C" {
+#include "core/dc_alloc.h"
+#include "core/dc_string.h"
+#include "http/dc_http.h"
+#include "http/dc_rest.h"
+#include "client/dc_client.h"
+#include "model/dc_channel.h"
+}
+
+static const dc_snowflake_t kBenchChannelBase = 100000000000000000ULL;
+
+static thread_local uint64_t t_bench_allocs = 0;
+static thread_local int t_bench_in_transport = 0;
+
+static void* dc_bench_count_alloc(size_t size) {
+    if (!t_bench_in_transport) t_bench_allocs++;
+    return malloc(size);
+}
+
+static void* dc_bench_count_realloc(void* ptr, size_t size) {
+    if (!t_bench_in_transport) t_bench_allocs++;
+    return realloc(ptr, size);
+}
+
+/* Installed before main so no thread is running yet (dc_alloc_set_hooks is not thread-safe). */
+static const int kBenchHooksInstalled = []() {
+    dc_alloc_hooks_t hooks = {dc_bench_count_alloc, dc_bench_count_realloc, free};
+    return dc_alloc_set_hooks(&hooks) == DC_OK ? 1 : 0;
+}();
+
+static const char* kMessageBody =
+    "{\"id\":\"1100000000000000001\",\"type\":0,\"content\":\"hello\","
+    "\"channel_id\":\"100000000000000000\",\"author\":{\"id\":\"200000000000000000\","
+    "\"username\":\"bench\",\"discriminator\":\"0\",\"global_name\":null,\"avatar\":null,"
+    "\"bot\":true},\"attachments\":[],\"embeds\":[],\"mentions\":[],\"mention_roles\":[],"
+    "\"pinned\":false,\"mention_everyone\":false,\"tts\":false,"
+    "\"timestamp\":\"2024-01-01T00:00:00.000000+00:00\",\"edited_timestamp\":null,"
+    "\"flags\":0,\"components\":[]}";
+
+static const char* kChannelBody =
+    "{\"id\":\"100000000000000000\",\"type\":0,\"guild_id\":\"300000000000000000\","
+    "\"position\":3,\"permission_overwrites\":[{\"id\":\"300000000000000000\",\"type\":0,"
+    "\"allow\":\"0\",\"deny\":\"2048\"}],\"name\":\"general\",\"topic\":\"bench channel\","
+    "\"nsfw\":false,\"last_message_id\":\"1100000000000000001\",\"rate_limit_per_user\":0,"
+    "\"parent_id\":\"400000000000000000\",\"flags\":0}";
+
+static dc_status_t dc_bench_add_header(dc_http_response_t* response, const char* name, const char* value) {
+    dc_http_header_t header;
+    dc_status_t st = dc_string_init_from_cstr(&header.name, name);
+    if (st != DC_OK) return st;
+    st = dc_string_init_from_cstr(&header.value, value);
+    if (st != DC_OK) {
+        dc_string_free(&header.name);
+        return st;
+    }
+    st = dc_vec_push(&response->headers, &header);
+    if (st != DC_OK) {
+        dc_string_free(&header.name);
+        dc_string_free(&header.value);
+    }
+    return st;
+}
+
+/* Canned 200; the bucket hash is derived from the channel id so every route gets its own bucket. */
+static dc_status_t dc_bench_transport(void* userdata, const dc_http_request_t* request,
+                                      dc_http_response_t* response) {
+    (void)userdata;
+    t_bench_in_transport = 1;
+    const char* url = dc_string_cstr(&request->url);
+    const char* channel = strstr(url, "/channels/");
+    char bucket[40];
+    size_t n = 0;
+    bucket[n++] = 'b';
+    if (channel) {
+        for (const char* p = channel + 10; *p >= '0' && *p <= '9' && n < sizeof(bucket) - 1; p++) {
+            bucket[n++] = *p;
+        }
+    }
+    bucket[n] = '\0';
+
+    response->status_code = 200;
+    const char* body = (request->method == DC_HTTP_GET) ? kChannelBody : kMessageBody;
+    dc_status_t st = dc_string_set_cstr(&response->body, body);
+    if (st == DC_OK) st = dc_bench_add_header(response, "Content-Type", "application/json");
+    if (st == DC_OK) st = dc_bench_add_header(response, "X-RateLimit-Limit", "1000000");
+    if (st == DC_OK) st = dc_bench_add_header(response, "X-RateLimit-Remaining", "999999");
+    if (st == DC_OK) st = dc_bench_add_header(response, "X-RateLimit-Reset", "1999999999.000");
+    if (st == DC_OK) st = dc_bench_add_header(response, "X-RateLimit-Reset-After", "60.000");
+    if (st == DC_OK) st = dc_bench_add_header(response, "X-RateLimit-Bucket", bucket);
+    t_bench_in_transport = 0;
+    return st;
+}
+
+static void dc_bench_report(benchmark::State& state, uint64_t allocs) {
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+    state.counters["allocs_per_req"] = benchmark::Counter(
+        static_cast<double>(allocs) / static_cast<double>(state.iterations()),
+        benchmark::Counter::kAvgThreads);
+}
+
+static dc_rest_client_t* g_bench_rest = NULL;
+static dc_client_t* g_bench_client = NULL;
+
+static dc_rest_client_t* dc_bench_rest_create(void) {
+    dc_rest_client_config_t config;
+    memset(&config, 0, sizeof(config));
+    config.token = "bench_token";
+    config.auth_type = DC_HTTP_AUTH_BOT;
+    config.user_agent = "DiscordBot (https://example.com, 1.0.0) fishydslib";
+    config.global_rate_limit_per_sec = UINT32_MAX; /* Measure the guard, never wait on it */
+    config.transport = dc_bench_transport;
+    dc_rest_client_t* client = NULL;
+    if (dc_rest_client_create(&config, &client) != DC_OK) return NULL;
+    return client;
+}
+
+static dc_client_t* dc_bench_client_create(void) {
+    dc_client_config_t config;
+    dc_client_config_init(&config);
+    config.token = "bench_token";
+    config.user_agent = "DiscordBot (https://example.com, 1.0.0) fishydslib";
+    config.log_level = DC_LOG_ERROR;
+    config.rest_global_rate_limit_per_sec = UINT32_MAX;
+    config.rest_transport = dc_bench_transport;
+    dc_client_t* client = NULL;
+    if (dc_client_create(&config, &client) != DC_OK) return NULL;
+    return client;
+}
+
+/* One request per route, built outside the timed loop. */
+static int dc_bench_build_requests(std::vector<dc_rest_request_t>& requests, size_t routes,
+                                   dc_http_method_t method) {
+    requests.resize(routes);
+    for (size_t i = 0; i < routes; i++) {
+        dc_rest_request_t* req = &requests[i];
+        char path[64];
+        if (method == DC_HTTP_GET) {
+            snprintf(path, sizeof(path), "/channels/%llu",
+                     (unsigned long long)(kBenchChannelBase + i));
+        } else {
+            snprintf(path, sizeof(path), "/channels/%llu/messages",
+                     (unsigned long long)(kBenchChannelBase + i));
+        }
+        if (dc_rest_request_init(req) != DC_OK ||
+            dc_rest_request_set_method(req, method) != DC_OK ||
+            dc_rest_request_set_path(req, path) != DC_OK) {
+            return 0;
+        }
+        if (method == DC_HTTP_POST &&
+            dc_rest_request_set_json_body(req, "{\"content\":\"hello\"}") != DC_OK) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static void dc_bench_free_requests(std::vector<dc_rest_request_t>& requests) {
+    for (size_t i = 0; i < requests.size(); i++) {
+        dc_rest_request_free(&requests[i]);
+    }
+    requests.clear();
+}
+
+static void dc_bench_rest_execute(benchmark::State& state, dc_http_method_t method) {
+    if (state.thread_index() == 0) {
+        g_bench_rest = dc_bench_rest_create();
+    }
+    size_t routes = static_cast<size_t>(state.range(0));
+    std::vector<dc_rest_request_t> requests;
+    dc_rest_response_t response;
+    int ready = dc_bench_build_requests(requests, routes, method) &&
+                dc_rest_response_init(&response) == DC_OK;
+
+    /* The timed loop starts once every thread got here, so the client exists by then. */
+    size_t next = static_cast<size_t>(state.thread_index()) % routes;
+    uint64_t allocs_before = t_bench_allocs;
+    for (auto _ : state) {
+        if (!ready || !g_bench_rest) {
+            state.SkipWithError("setup failed");
+            break;
+        }
+        dc_status_t st = dc_rest_execute(g_bench_rest, &requests[next], &response);
+        if (st != DC_OK) {
+            state.SkipWithError("dc_rest_execute failed");
+            break;
+        }
+        benchmark::DoNotOptimize(response.http.status_code);
+        if (++next == routes) next = 0;
+    }
+    dc_bench_report(state, t_bench_allocs - allocs_before);
+
+    if (ready) dc_rest_response_free(&response);
+    dc_bench_free_requests(requests);
+    if (state.thread_index() == 0) {
+        dc_rest_client_free(g_bench_rest);
+        g_bench_rest = NULL;
+    }
+}
+
+static void BM_Rest_Execute_Get(benchmark::State& state) {
+    dc_bench_rest_execute(state, DC_HTTP_GET);
+}
+BENCHMARK(BM_Rest_Execute_Get)->Arg(1)->Arg(64)->Arg(1024)->ThreadRange(1, 8)->UseRealTime();
+
+static void BM_Rest_Execute_PostJson(benchmark::State& state) {
+    dc_bench_rest_execute(state, DC_HTTP_POST);
+}
+BENCHMARK(BM_Rest_Execute_PostJson)->Arg(1)->Arg(64)->Arg(1024)->ThreadRange(1, 8)->UseRealTime();
+
+static void BM_Client_CreateMessage(benchmark::State& state) {
+    if (state.thread_index() == 0) {
+        g_bench_client = dc_bench_client_create();
+    }
+    uint64_t routes = static_cast<uint64_t>(state.range(0));
+    uint64_t next = static_cast<uint64_t>(state.thread_index()) % routes;
+    uint64_t allocs_before = t_bench_allocs;
+    for (auto _ : state) {
+        dc_snowflake_t message_id = 0;
+        if (!g_bench_client ||
+            dc_client_create_message(g_bench_client, kBenchChannelBase + next, "hello", &message_id) != DC_OK) {
+            state.SkipWithError("dc_client_create_message failed");
+            break;
+        }
+        benchmark::DoNotOptimize(message_id);
+        if (++next == routes) next = 0;
+    }
+    dc_bench_report(state, t_bench_allocs - allocs_before);
+    if (state.thread_index() == 0) {
+        dc_client_free(g_bench_client);
+        g_bench_client = NULL;
+    }
+}
+BENCHMARK(BM_Client_CreateMessage)->Arg(1)->Arg(64)->Arg(1024)->ThreadRange(1, 8)->UseRealTime();
+
+static void BM_Client_GetChannel(benchmark::State& state) {
+    if (state.thread_index() == 0) {
+        g_bench_client = dc_bench_client_create();
+    }
+    uint64_t routes = static_cast<uint64_t>(state.range(0));
+    uint64_t next = static_cast<uint64_t>(state.thread_index()) % routes;
+    uint64_t allocs_before = t_bench_allocs;
+    for (auto _ : state) {
+        /* Each call fills a fresh channel; free it here so the loop does not leak. */
+        dc_channel_t channel;
+        dc_channel_init(&channel);
+        dc_status_t st = g_bench_client
+                             ? dc_client_get_channel(g_bench_client, kBenchChannelBase + next, &channel)
+                             : DC_ERROR_NULL_POINTER;
+        benchmark::DoNotOptimize(channel.id);
+        dc_channel_free(&channel);
+        if (st != DC_OK) {
+            state.SkipWithError("dc_client_get_channel failed");
+            break;
+        }
+        if (++next == routes) next = 0;
+    }
+    dc_bench_report(state, t_bench_allocs - allocs_before);
+    if (state.thread_index() == 0) {
+        dc_client_free(g_bench_client);
+        g_bench_client = NULL;
+    }
+}
+BENCHMARK(BM_Client_GetChannel)->Arg(1)->Arg(64)->Arg(1024)->ThreadRange(1, 8)->UseRealTime();
+
+BENCHMARK_MAIN();
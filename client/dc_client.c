@@ -8,16 +8,34 @@
 #include "core/dc_status.h"
 #include "http/dc_rest.h"
 #include "http/dc_multipart.h"
+#include "http/dc_upload.h"
+#include "http/dc_transfer.h"
+#include "core/dc_platform.h"
+#include "core/dc_attachments.h"
 #include "json/dc_json.h"
 #include "json/dc_json_model.h"
+#include "json/dc_json_patch.h"
 #include <string.h>
 #include <stdint.h>
+#include <stdlib.h>
 #include <stdarg.h>
+#include <stdatomic.h>
 #include <stdio.h>
+#include <fcntl.h>
 #include <yyjson.h>
 
+#if defined(_WIN32)
+#include <io.h>
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
 #define DC_MESSAGE_CONTENT_MAX_LEN 2000u
 
+/* Larger PATCH bodies (e.g. guild images) are not kept for reuse. */
+#define DC_CLIENT_PATCH_BODY_KEEP_MAX 65536u
+
 struct dc_client {
     dc_rest_client_t* rest;
     dc_gateway_client_t* gateway;
@@ -26,6 +44,19 @@ struct dc_client {
     dc_log_callback_t log_callback;
     void* log_user_data;
     dc_log_level_t log_level;
+    int hedge_message_sends;
+    atomic_uint_fast32_t nonce_counter;
+    uint16_t nonce_origin;          /* worker/process bits of nonces, 10 bits */
+    dc_string_t patch_body;         /* reused by the *_diff wrappers */
+    atomic_int patch_body_busy;
+    dc_waiter_registry_t waiters;
+    dc_preflight_t* preflight;
+    dc_interaction_watchdog_t* watchdog;
+    dc_role_coalescer_t* roles;
+    dc_poll_tally_t* polls;
+    dc_gateway_event_callback_t event_callback;
+    dc_gateway_state_callback_t state_callback;
+    void* user_data;
 };
 
 static void dc_client_log(const dc_client_t* client, dc_log_level_t level, const char* fmt, ...) {
@@ -53,6 +84,92 @@ static void dc_client_log(const dc_client_t* client, dc_log_level_t level, const
     dc_free(heap_buf);
 }
 
+static uint64_t dc_client_now_ms(void) {
+    uint64_t now_ms = 0;
+    (void)dc_platform_now_monotonic_ms(&now_ms);
+    return now_ms;
+}
+
+static dc_status_t dc_client_interaction_callback_send(dc_client_t* client,
+                                                      dc_snowflake_t interaction_id,
+                                                      const char* interaction_token,
+                                                      dc_interaction_callback_type_t callback_type,
+                                                      const char* data_json);
+
+static dc_status_t dc_client_watchdog_defer(void* user_data, dc_snowflake_t interaction_id,
+                                            const char* interaction_token, int update_message,
+                                            int ephemeral) {
+    dc_client_t* client = (dc_client_t*)user_data;
+    dc_status_t st = update_message
+        ? dc_client_interaction_callback_send(client, interaction_id, interaction_token,
+                                              DC_INTERACTION_CALLBACK_DEFERRED_UPDATE_MESSAGE, NULL)
+        : dc_client_interaction_callback_send(client, interaction_id, interaction_token,
+                                              DC_INTERACTION_CALLBACK_DEFERRED_CHANNEL_MESSAGE_WITH_SOURCE,
+                                              ephemeral ? "{\"flags\":64}" : NULL);
+    if (st == DC_OK) {
+        dc_client_log(client, DC_LOG_WARN, "Interaction %llu missed its deadline; deferred automatically",
+                      (unsigned long long)interaction_id);
+    } else {
+        dc_client_log(client, DC_LOG_ERROR, "Automatic deferral of interaction %llu failed: %s",
+                      (unsigned long long)interaction_id, dc_status_string(st));
+    }
+    return st;
+}
+
+static void dc_client_role_result(void* user_data, dc_snowflake_t guild_id, dc_snowflake_t user_id,
+                                  dc_status_t status) {
+    if (status == DC_OK) return;
+    dc_client_log((dc_client_t*)user_data, DC_LOG_WARN, "Role update of member %llu in guild %llu failed: %s",
+                  (unsigned long long)user_id, (unsigned long long)guild_id, dc_status_string(status));
+}
+
+/* Preflight state and waiters see every dispatch before the application callback does. */
+static void dc_client_on_gateway_event(const char* event_name, const char* event_data,
+                                       void* user_data) {
+    dc_client_t* client = (dc_client_t*)user_data;
+    dc_status_t st = DC_OK;
+    /* The watchdog clock starts before anything else runs. */
+    if (client->watchdog && strcmp(event_name, "INTERACTION_CREATE") == 0) {
+        st = dc_interaction_watchdog_track(client->watchdog, event_data, dc_client_now_ms());
+        if (st != DC_OK) {
+            dc_client_log(client, DC_LOG_WARN, "Interaction watchdog tracking failed: %s",
+                          dc_status_string(st));
+        }
+    }
+    if (client->roles) {
+        st = dc_role_coalescer_feed_event(client->roles, event_name, event_data, dc_client_now_ms());
+        if (st != DC_OK) {
+            dc_client_log(client, DC_LOG_WARN, "Role coalescer update for %s failed: %s",
+                          event_name, dc_status_string(st));
+        }
+    }
+    if (client->polls) {
+        st = dc_poll_tally_feed_event(client->polls, event_name, event_data);
+        if (st != DC_OK) {
+            dc_client_log(client, DC_LOG_WARN, "Poll tally update for %s failed: %s",
+                          event_name, dc_status_string(st));
+        }
+    }
+    if (client->preflight) {
+        st = dc_preflight_feed_event(client->preflight, event_name, event_data);
+        if (st != DC_OK) {
+            dc_client_log(client, DC_LOG_WARN, "Preflight update for %s failed: %s",
+                          event_name, dc_status_string(st));
+        }
+    }
+    st = dc_waiter_registry_dispatch(&client->waiters, event_name, event_data, NULL);
+    if (st != DC_OK) {
+        dc_client_log(client, DC_LOG_WARN, "Waiter dispatch for %s failed: %s",
+                      event_name, dc_status_string(st));
+    }
+    if (client->event_callback) client->event_callback(event_name, event_data, client->user_data);
+}
+
+static void dc_client_on_gateway_state(dc_gateway_state_t state, void* user_data) {
+    dc_client_t* client = (dc_client_t*)user_data;
+    if (client->state_callback) client->state_callback(state, client->user_data);
+}
+
 static dc_status_t dc_client_double_ms_to_u32(double val, uint32_t* out) {
     if (!out) return DC_ERROR_NULL_POINTER;
     if (val < 0.0 || val > (double)UINT32_MAX) return DC_ERROR_INVALID_FORMAT;
@@ -424,9 +541,10 @@ cleanup:
     return st;
 }
 
-static dc_status_t dc_client_response_body_to_json_out(const dc_rest_response_t* resp, dc_string_t* out_json) {
+/* Moves the body out; @p resp is only good for freeing afterwards. */
+static dc_status_t dc_client_response_body_to_json_out(dc_rest_response_t* resp, dc_string_t* out_json) {
     if (!resp || !out_json) return DC_ERROR_NULL_POINTER;
-    return dc_string_set_cstr(out_json, dc_string_cstr(&resp->http.body));
+    return dc_rest_response_take_body(resp, out_json);
 }
 
 static dc_status_t dc_client_json_content_body(const char* content, int ephemeral, dc_string_t* out_json) {
@@ -504,9 +622,16 @@ static dc_status_t dc_client_execute_json_request_out(dc_client_t* client,
     dc_status_t st = dc_rest_response_init(&resp);
     if (st != DC_OK) return st;
 
+    /* An empty out_json lends its capacity, so the body is received straight into it. */
+    int lent = out_json && dc_string_is_empty(out_json);
+    if (lent) dc_string_swap(out_json, &resp.http.body);
+
     st = dc_client_execute_json_request(client, method, path, json_body, is_interaction, &resp);
     if (st == DC_OK && out_json) {
-        st = dc_string_set_cstr(out_json, dc_string_cstr(&resp.http.body));
+        st = dc_rest_response_take_body(&resp, out_json);
+    } else if (lent) {
+        dc_string_swap(out_json, &resp.http.body);
+        dc_string_clear(out_json);
     }
 
     dc_rest_response_free(&resp);
@@ -594,6 +719,11 @@ void dc_client_config_init(dc_client_config_t* config) {
     config->http_timeout_ms = 30000;
     config->gateway_timeout_ms = 60000;
     config->log_level = DC_LOG_INFO;
+    config->hedge_percentile = 95;
+    config->hedge_min_delay_ms = 20;
+    config->interaction_watchdog_deadline_ms = 2000;
+    config->role_coalescer_window_ms = 250;
+    config->role_coalescer_roles_ttl_ms = DC_CLIENT_ROLES_TTL_AUTO;
 }
 
 dc_status_t dc_client_config_set_user_agent_info(dc_client_config_t* config, const dc_user_agent_t* ua) {
@@ -604,6 +734,30 @@ dc_status_t dc_client_config_set_user_agent_info(dc_client_config_t* config, con
     return DC_OK;
 }
 
+/*
+ * Nonces are only unique per (worker, process, increment) within one
+ * millisecond. Mix the process id, the clock and the client's address so
+ * separate processes, shards and clients pick different worker/process bits
+ * and counter starts.
+ */
+static uint64_t dc_client_nonce_seed(const dc_client_t* client) {
+    uint64_t now_ms = 0;
+    (void)dc_platform_now_epoch_ms(&now_ms);
+#if defined(_WIN32)
+    uint64_t pid = (uint64_t)_getpid();
+#else
+    uint64_t pid = (uint64_t)getpid();
+#endif
+    uint64_t x = pid ^ (now_ms << 16) ^ (uint64_t)(uintptr_t)client;
+    /* splitmix64 finalizer */
+    x ^= x >> 30;
+    x *= 0xBF58476D1CE4E5B9ull;
+    x ^= x >> 27;
+    x *= 0x94D049BB133111EBull;
+    x ^= x >> 31;
+    return x;
+}
+
 dc_status_t dc_client_create(const dc_client_config_t* config, dc_client_t** client) {
     if (!config || !client) return DC_ERROR_NULL_POINTER;
     if (!config->token || config->token[0] == '\0') return DC_ERROR_INVALID_PARAM;
@@ -616,6 +770,12 @@ dc_status_t dc_client_create(const dc_client_config_t* config, dc_client_t** cli
     c->log_callback = config->log_callback;
     c->log_user_data = config->log_user_data;
     c->log_level = config->log_level;
+    c->hedge_message_sends = config->hedge_message_sends;
+    uint64_t nonce_seed = dc_client_nonce_seed(c);
+    c->nonce_origin = (uint16_t)(nonce_seed & 0x3FFu);
+    atomic_init(&c->nonce_counter, (uint_fast32_t)((nonce_seed >> 10) & 0xFFFu));
+    (void)dc_string_init(&c->patch_body);
+    atomic_init(&c->patch_body_busy, 0);
 
     const char* user_agent = config->user_agent;
     dc_string_t ua_buf;
@@ -643,9 +803,26 @@ dc_status_t dc_client_create(const dc_client_config_t* config, dc_client_t** cli
     rest_cfg.auth_type = config->auth_type;
     rest_cfg.user_agent = user_agent;
     rest_cfg.timeout_ms = config->http_timeout_ms;
+    rest_cfg.transport = config->rest_transport;
+    rest_cfg.transport_userdata = config->rest_transport_userdata;
+    rest_cfg.hedge_percentile = config->hedge_percentile;
+    rest_cfg.hedge_min_delay_ms = config->hedge_min_delay_ms;
+    rest_cfg.global_rate_limit_per_sec = config->rest_global_rate_limit_per_sec;
+
+    if (config->permission_preflight) {
+        st = dc_preflight_create(&c->preflight);
+        if (st != DC_OK) {
+            if (ua_inited) dc_string_free(&ua_buf);
+            dc_free(c);
+            return st;
+        }
+        rest_cfg.preflight = dc_preflight_rest_hook;
+        rest_cfg.preflight_userdata = c->preflight;
+    }
 
     st = dc_rest_client_create(&rest_cfg, &c->rest);
     if (st != DC_OK) {
+        dc_preflight_free(c->preflight);
         if (ua_inited) dc_string_free(&ua_buf);
         dc_free(c);
         return st;
@@ -659,22 +836,101 @@ dc_status_t dc_client_create(const dc_client_config_t* config, dc_client_t** cli
     gw_cfg.shard_count = config->shard_count;
     gw_cfg.large_threshold = config->large_threshold;
     gw_cfg.user_agent = user_agent;
-    gw_cfg.event_callback = config->event_callback;
-    gw_cfg.state_callback = config->state_callback;
-    gw_cfg.user_data = config->user_data;
+    gw_cfg.event_callback = dc_client_on_gateway_event;
+    gw_cfg.state_callback = dc_client_on_gateway_state;
+    gw_cfg.user_data = c;
     gw_cfg.heartbeat_timeout_ms = config->gateway_timeout_ms;
     gw_cfg.connect_timeout_ms = config->gateway_timeout_ms;
     gw_cfg.enable_compression = config->enable_compression;
     gw_cfg.enable_payload_compression = config->enable_payload_compression;
 
+    c->event_callback = config->event_callback;
+    c->state_callback = config->state_callback;
+    c->user_data = config->user_data;
+    st = dc_waiter_registry_init(&c->waiters);
+    if (st != DC_OK) {
+        dc_rest_client_free(c->rest);
+        dc_preflight_free(c->preflight);
+        if (ua_inited) dc_string_free(&ua_buf);
+        dc_free(c);
+        return st;
+    }
+
     st = dc_gateway_client_create(&gw_cfg, &c->gateway);
     if (st != DC_OK) {
+        dc_waiter_registry_free(&c->waiters);
         dc_rest_client_free(c->rest);
+        dc_preflight_free(c->preflight);
         if (ua_inited) dc_string_free(&ua_buf);
         dc_free(c);
         return st;
     }
 
+    if (config->interaction_watchdog) {
+        dc_interaction_watchdog_config_t wd_cfg;
+        dc_interaction_watchdog_config_init(&wd_cfg);
+        if (config->interaction_watchdog_deadline_ms > 0) {
+            wd_cfg.deadline_ms = config->interaction_watchdog_deadline_ms;
+        }
+        wd_cfg.defer_ephemeral = config->interaction_watchdog_ephemeral;
+        wd_cfg.defer = dc_client_watchdog_defer;
+        wd_cfg.user_data = c;
+        st = dc_interaction_watchdog_create(&wd_cfg, &c->watchdog);
+        if (st != DC_OK) {
+            dc_gateway_client_free(c->gateway);
+            dc_waiter_registry_free(&c->waiters);
+            dc_rest_client_free(c->rest);
+            dc_preflight_free(c->preflight);
+            if (ua_inited) dc_string_free(&ua_buf);
+            dc_free(c);
+            return st;
+        }
+    }
+
+    if (config->role_coalescer) {
+        dc_role_coalescer_config_t rc_cfg;
+        dc_role_coalescer_config_init(&rc_cfg);
+        if (config->role_coalescer_window_ms > 0) {
+            rc_cfg.window_ms = config->role_coalescer_window_ms;
+        }
+        if (config->role_coalescer_roles_ttl_ms != DC_CLIENT_ROLES_TTL_AUTO) {
+            rc_cfg.roles_ttl_ms = config->role_coalescer_roles_ttl_ms;
+        } else if (!(config->intents & DC_INTENT_GUILD_MEMBERS)) {
+            rc_cfg.roles_ttl_ms = 0;
+        }
+        rc_cfg.on_result = dc_client_role_result;
+        rc_cfg.user_data = c;
+        st = dc_role_coalescer_create(c, &rc_cfg, &c->roles);
+        if (st != DC_OK) {
+            dc_interaction_watchdog_free(c->watchdog);
+            dc_gateway_client_free(c->gateway);
+            dc_waiter_registry_free(&c->waiters);
+            dc_rest_client_free(c->rest);
+            dc_preflight_free(c->preflight);
+            if (ua_inited) dc_string_free(&ua_buf);
+            dc_free(c);
+            return st;
+        }
+    }
+
+    if (config->poll_tally) {
+        dc_poll_tally_config_t pt_cfg;
+        dc_poll_tally_config_init(&pt_cfg);
+        pt_cfg.track_voters = config->poll_tally_voters;
+        st = dc_poll_tally_create(c, &pt_cfg, &c->polls);
+        if (st != DC_OK) {
+            dc_role_coalescer_free(c->roles);
+            dc_interaction_watchdog_free(c->watchdog);
+            dc_gateway_client_free(c->gateway);
+            dc_waiter_registry_free(&c->waiters);
+            dc_rest_client_free(c->rest);
+            dc_preflight_free(c->preflight);
+            if (ua_inited) dc_string_free(&ua_buf);
+            dc_free(c);
+            return st;
+        }
+    }
+
     c->started = 0;
     c->auth_type = config->auth_type;
     if (ua_inited) dc_string_free(&ua_buf);
@@ -697,6 +953,16 @@ dc_status_t dc_client_init(const dc_client_config_t* config, dc_client_t** clien
 
 void dc_client_free(dc_client_t* client) {
     if (!client) return;
+    /* First: their threads send requests through the REST client. */
+    if (client->roles) {
+        (void)dc_role_coalescer_flush(client->roles);
+        dc_role_coalescer_free(client->roles);
+        client->roles = NULL;
+    }
+    dc_interaction_watchdog_free(client->watchdog);
+    client->watchdog = NULL;
+    dc_poll_tally_free(client->polls);
+    client->polls = NULL;
     if (client->gateway) {
         dc_gateway_client_free(client->gateway);
         client->gateway = NULL;
@@ -705,6 +971,9 @@ void dc_client_free(dc_client_t* client) {
         dc_rest_client_free(client->rest);
         client->rest = NULL;
     }
+    dc_waiter_registry_free(&client->waiters);
+    dc_preflight_free(client->preflight);
+    dc_string_free(&client->patch_body);
     dc_free(client);
 }
 
@@ -772,13 +1041,79 @@ dc_status_t dc_client_stop(dc_client_t* client) {
 dc_status_t dc_client_process(dc_client_t* client, uint32_t timeout_ms) {
     if (!client || !client->gateway) return DC_ERROR_NULL_POINTER;
     dc_client_log(client, DC_LOG_TRACE, "Process tick timeout_ms=%u", timeout_ms);
+    /* Wake up in time for the next waiter, watchdog or role batch deadline. */
+    uint64_t deadline_ms = 0;
+    if (dc_waiter_registry_next_deadline(&client->waiters, &deadline_ms)) {
+        uint64_t now_ms = dc_client_now_ms();
+        uint64_t wait_ms = (deadline_ms > now_ms) ? deadline_ms - now_ms : 0;
+        if (wait_ms < timeout_ms) timeout_ms = (uint32_t)wait_ms;
+    }
+    if (dc_interaction_watchdog_next_deadline(client->watchdog, &deadline_ms)) {
+        uint64_t now_ms = dc_client_now_ms();
+        uint64_t wait_ms = (deadline_ms > now_ms) ? deadline_ms - now_ms : 0;
+        if (wait_ms < timeout_ms) timeout_ms = (uint32_t)wait_ms;
+    }
+    if (dc_role_coalescer_next_deadline(client->roles, &deadline_ms)) {
+        uint64_t now_ms = dc_client_now_ms();
+        uint64_t wait_ms = (deadline_ms > now_ms) ? deadline_ms - now_ms : 0;
+        if (wait_ms < timeout_ms) timeout_ms = (uint32_t)wait_ms;
+    }
     dc_status_t st = dc_gateway_client_process(client->gateway, timeout_ms);
     if (st != DC_OK && st != DC_ERROR_TIMEOUT) {
         dc_client_log(client, DC_LOG_WARN, "Gateway process error: %s", dc_status_string(st));
     }
+    (void)dc_waiter_registry_expire(&client->waiters, dc_client_now_ms());
+    /* Without a watchdog thread this is what sends the deferrals. */
+    (void)dc_interaction_watchdog_poll(client->watchdog, dc_client_now_ms());
+    (void)dc_role_coalescer_poll(client->roles, dc_client_now_ms());
     return st;
 }
 
+dc_status_t dc_client_wait_for(dc_client_t* client, const dc_waiter_spec_t* spec, uint64_t* waiter_id) {
+    if (!client || !spec) return DC_ERROR_NULL_POINTER;
+    return dc_waiter_registry_add(&client->waiters, spec, dc_client_now_ms(), waiter_id);
+}
+
+dc_status_t dc_client_cancel_waiter(dc_client_t* client, uint64_t waiter_id) {
+    if (!client) return DC_ERROR_NULL_POINTER;
+    return dc_waiter_registry_cancel(&client->waiters, waiter_id);
+}
+
+dc_status_t dc_client_dispatch_to_waiters(dc_client_t* client, const char* event_name,
+                                          const char* event_data) {
+    if (!client || !event_name || !event_data) return DC_ERROR_NULL_POINTER;
+    return dc_waiter_registry_dispatch(&client->waiters, event_name, event_data, NULL);
+}
+
+dc_preflight_t* dc_client_get_preflight(dc_client_t* client) {
+    return client ? client->preflight : NULL;
+}
+
+dc_interaction_watchdog_t* dc_client_get_interaction_watchdog(dc_client_t* client) {
+    return client ? client->watchdog : NULL;
+}
+
+dc_status_t dc_client_get_interaction_watchdog_stats(dc_client_t* client,
+                                                     dc_interaction_watchdog_stats_t* out) {
+    if (!client || !out) return DC_ERROR_NULL_POINTER;
+    if (!client->watchdog) return DC_ERROR_INVALID_STATE;
+    return dc_interaction_watchdog_get_stats(client->watchdog, out);
+}
+
+dc_role_coalescer_t* dc_client_get_role_coalescer(dc_client_t* client) {
+    return client ? client->roles : NULL;
+}
+
+dc_status_t dc_client_get_role_coalescer_stats(dc_client_t* client, dc_role_coalescer_stats_t* out) {
+    if (!client || !out) return DC_ERROR_NULL_POINTER;
+    if (!client->roles) return DC_ERROR_INVALID_STATE;
+    return dc_role_coalescer_get_stats(client->roles, out);
+}
+
+dc_poll_tally_t* dc_client_get_poll_tally(dc_client_t* client) {
+    return client ? client->polls : NULL;
+}
+
 dc_status_t dc_client_get_gateway_info(dc_client_t* client, dc_gateway_info_t* info) {
     if (!client || !client->rest || !info) return DC_ERROR_NULL_POINTER;
 
@@ -1279,6 +1614,59 @@ dc_status_t dc_client_create_message(dc_client_t* client, dc_snowflake_t channel
     return st;
 }
 
+/* Copies the payload, adding a nonce if it has none and forcing enforce_nonce. */
+static dc_status_t dc_client_build_nonce_body(dc_client_t* client, const char* json_body,
+                                              dc_string_t* out_json) {
+    dc_json_doc_t payload;
+    dc_status_t st = dc_json_parse(json_body, &payload);
+    if (st != DC_OK) return st;
+    if (!yyjson_is_obj(payload.root)) {
+        dc_json_doc_free(&payload);
+        return DC_ERROR_INVALID_PARAM;
+    }
+
+    dc_json_mut_doc_t doc;
+    st = dc_json_mut_doc_create(&doc);
+    if (st != DC_OK) {
+        dc_json_doc_free(&payload);
+        return st;
+    }
+    int has_nonce = 0;
+    size_t idx, max;
+    yyjson_val* key;
+    yyjson_val* val;
+    yyjson_obj_foreach(payload.root, idx, max, key, val) {
+        if (yyjson_equals_str(key, "enforce_nonce")) continue;
+        if (yyjson_equals_str(key, "nonce") && !yyjson_is_null(val)) has_nonce = 1;
+        yyjson_mut_val* mut_key = yyjson_mut_strcpy(doc.doc, yyjson_get_str(key));
+        yyjson_mut_val* mut_val = yyjson_val_mut_copy(doc.doc, val);
+        if (!mut_key || !mut_val || !yyjson_mut_obj_add(doc.root, mut_key, mut_val)) {
+            st = DC_ERROR_OUT_OF_MEMORY;
+            break;
+        }
+    }
+    dc_json_doc_free(&payload);
+
+    if (st == DC_OK && !has_nonce) {
+        uint32_t seq = (uint32_t)atomic_fetch_add(&client->nonce_counter, 1u);
+        dc_snowflake_t nonce = 0;
+        char nonce_buf[32];
+        st = dc_snowflake_generate((uint8_t)(client->nonce_origin >> 5),
+                                   (uint8_t)(client->nonce_origin & 0x1Fu),
+                                   (uint16_t)(seq & 0xFFFu), &nonce);
+        if (st == DC_OK) st = dc_snowflake_to_cstr(nonce, nonce_buf, sizeof(nonce_buf));
+        if (st == DC_OK && !yyjson_mut_obj_add_strcpy(doc.doc, doc.root, "nonce", nonce_buf)) {
+            st = DC_ERROR_OUT_OF_MEMORY;
+        }
+    }
+    if (st == DC_OK && !yyjson_mut_obj_add_bool(doc.doc, doc.root, "enforce_nonce", true)) {
+        st = DC_ERROR_OUT_OF_MEMORY;
+    }
+    if (st == DC_OK) st = dc_json_mut_doc_serialize(&doc, out_json);
+    dc_json_mut_doc_free(&doc);
+    return st;
+}
+
 dc_status_t dc_client_create_message_json(dc_client_t* client,
                                           dc_snowflake_t channel_id,
                                           const char* json_body,
@@ -1316,10 +1704,20 @@ dc_status_t dc_client_create_message_json(dc_client_t* client,
     dc_string_free(&path);
     if (st != DC_OK) goto cleanup;
 
-    st = dc_rest_request_set_json_body(&req, json_body);
-    if (st != DC_OK) goto cleanup;
-
-    st = dc_rest_execute(client->rest, &req, &resp);
+    if (client->hedge_message_sends) {
+        dc_string_t nonce_body;
+        st = dc_string_init(&nonce_body);
+        if (st != DC_OK) goto cleanup;
+        st = dc_client_build_nonce_body(client, json_body, &nonce_body);
+        if (st == DC_OK) st = dc_rest_request_set_json_body(&req, dc_string_cstr(&nonce_body));
+        dc_string_free(&nonce_body);
+        if (st != DC_OK) goto cleanup;
+        st = dc_rest_execute_hedged(client->rest, &req, &resp);
+    } else {
+        st = dc_rest_request_set_json_body(&req, json_body);
+        if (st != DC_OK) goto cleanup;
+        st = dc_rest_execute(client->rest, &req, &resp);
+    }
     if (st != DC_OK) goto cleanup;
 
     if (resp.http.status_code < 200 || resp.http.status_code >= 300) {
@@ -1339,6 +1737,271 @@ cleanup:
     return st;
 }
 
+dc_status_t dc_client_get_hedge_stats(dc_client_t* client, dc_rest_hedge_stats_t* out) {
+    if (!client || !client->rest || !out) return DC_ERROR_NULL_POINTER;
+    return dc_rest_get_hedge_stats(client->rest, out);
+}
+
+dc_status_t dc_client_get_route_budget(dc_client_t* client, dc_http_method_t method,
+                                       const char* path, dc_rest_route_budget_t* out) {
+    if (!client || !client->rest || !path || !out) return DC_ERROR_NULL_POINTER;
+    return dc_rest_get_route_budget(client->rest, method, path, out);
+}
+
+static int dc_client_open_readonly(const char* path) {
+#if defined(_WIN32)
+    return _open(path, _O_RDONLY | _O_BINARY);
+#else
+    return open(path, O_RDONLY | O_CLOEXEC);
+#endif
+}
+
+static void dc_client_close_fd(int fd) {
+#if defined(_WIN32)
+    _close(fd);
+#else
+    close(fd);
+#endif
+}
+
+static dc_status_t dc_client_build_upload_slots_body(const dc_client_upload_file_t* files,
+                                                     const uint64_t* sizes,
+                                                     size_t count,
+                                                     dc_string_t* out_json) {
+    dc_json_mut_doc_t doc;
+    dc_status_t st = dc_json_mut_doc_create(&doc);
+    if (st != DC_OK) return st;
+    yyjson_mut_val* arr = yyjson_mut_obj_add_arr(doc.doc, doc.root, "files");
+    if (!arr) {
+        dc_json_mut_doc_free(&doc);
+        return DC_ERROR_OUT_OF_MEMORY;
+    }
+    for (size_t i = 0; i < count; i++) {
+        char id_buf[24];
+        snprintf(id_buf, sizeof(id_buf), "%zu", i);
+        yyjson_mut_val* item = yyjson_mut_arr_add_obj(doc.doc, arr);
+        if (!item ||
+            !yyjson_mut_obj_add_strcpy(doc.doc, item, "id", id_buf) ||
+            !yyjson_mut_obj_add_strcpy(doc.doc, item, "filename", files[i].filename) ||
+            !yyjson_mut_obj_add_uint(doc.doc, item, "file_size", sizes[i])) {
+            dc_json_mut_doc_free(&doc);
+            return DC_ERROR_OUT_OF_MEMORY;
+        }
+    }
+    st = dc_json_mut_doc_serialize(&doc, out_json);
+    dc_json_mut_doc_free(&doc);
+    return st;
+}
+
+/* Maps the attachments[] answer to upload URL/filename per file index. */
+static dc_status_t dc_client_parse_upload_slots(yyjson_val* root, size_t count,
+                                                const char** urls, const char** names) {
+    yyjson_val* arr = NULL;
+    dc_status_t st = dc_json_get_array(root, "attachments", &arr);
+    if (st != DC_OK) return DC_ERROR_INVALID_FORMAT;
+    if (yyjson_arr_size(arr) != count) return DC_ERROR_INVALID_FORMAT;
+    size_t idx, max;
+    yyjson_val* slot;
+    yyjson_arr_foreach(arr, idx, max, slot) {
+        size_t file_index = idx;
+        yyjson_val* id = yyjson_is_obj(slot) ? yyjson_obj_get(slot, "id") : NULL;
+        if (id && yyjson_is_uint(id)) {
+            file_index = (size_t)yyjson_get_uint(id);
+        } else if (id && yyjson_is_str(id)) {
+            file_index = (size_t)strtoull(yyjson_get_str(id), NULL, 10);
+        }
+        if (file_index >= count || urls[file_index]) return DC_ERROR_INVALID_FORMAT;
+        const char* url = NULL;
+        const char* name = NULL;
+        if (dc_json_get_string(slot, "upload_url", &url) != DC_OK ||
+            dc_json_get_string(slot, "upload_filename", &name) != DC_OK ||
+            url[0] == '\0' || name[0] == '\0') {
+            return DC_ERROR_INVALID_FORMAT;
+        }
+        urls[file_index] = url;
+        names[file_index] = name;
+    }
+    return DC_OK;
+}
+
+static dc_status_t dc_client_build_uploaded_message_body(const char* payload_json,
+                                                         const dc_client_upload_file_t* files,
+                                                         const char* const* uploaded_names,
+                                                         size_t count,
+                                                         dc_string_t* out_json) {
+    dc_json_doc_t payload;
+    memset(&payload, 0, sizeof(payload));
+    if (payload_json) {
+        dc_status_t pst = dc_json_parse(payload_json, &payload);
+        if (pst != DC_OK) return pst;
+        if (!yyjson_is_obj(payload.root)) {
+            dc_json_doc_free(&payload);
+            return DC_ERROR_INVALID_PARAM;
+        }
+    }
+
+    dc_json_mut_doc_t doc;
+    dc_status_t st = dc_json_mut_doc_create(&doc);
+    if (st != DC_OK) {
+        if (payload_json) dc_json_doc_free(&payload);
+        return st;
+    }
+    if (payload_json) {
+        size_t idx, max;
+        yyjson_val* key;
+        yyjson_val* val;
+        yyjson_obj_foreach(payload.root, idx, max, key, val) {
+            if (yyjson_equals_str(key, "attachments")) continue;
+            yyjson_mut_val* mut_key = yyjson_mut_strcpy(doc.doc, yyjson_get_str(key));
+            yyjson_mut_val* mut_val = yyjson_val_mut_copy(doc.doc, val);
+            if (!mut_key || !mut_val || !yyjson_mut_obj_add(doc.root, mut_key, mut_val)) {
+                st = DC_ERROR_OUT_OF_MEMORY;
+                break;
+            }
+        }
+        dc_json_doc_free(&payload);
+    }
+
+    yyjson_mut_val* arr = NULL;
+    if (st == DC_OK) {
+        arr = yyjson_mut_obj_add_arr(doc.doc, doc.root, "attachments");
+        if (!arr) st = DC_ERROR_OUT_OF_MEMORY;
+    }
+    for (size_t i = 0; st == DC_OK && i < count; i++) {
+        char id_buf[24];
+        snprintf(id_buf, sizeof(id_buf), "%zu", i);
+        yyjson_mut_val* item = yyjson_mut_arr_add_obj(doc.doc, arr);
+        if (!item ||
+            !yyjson_mut_obj_add_strcpy(doc.doc, item, "id", id_buf) ||
+            !yyjson_mut_obj_add_strcpy(doc.doc, item, "filename", files[i].filename) ||
+            !yyjson_mut_obj_add_strcpy(doc.doc, item, "uploaded_filename", uploaded_names[i])) {
+            st = DC_ERROR_OUT_OF_MEMORY;
+            break;
+        }
+        if (files[i].description && files[i].description[0] != '\0' &&
+            !yyjson_mut_obj_add_strcpy(doc.doc, item, "description", files[i].description)) {
+            st = DC_ERROR_OUT_OF_MEMORY;
+        }
+    }
+    if (st == DC_OK) st = dc_json_mut_doc_serialize(&doc, out_json);
+    dc_json_mut_doc_free(&doc);
+    return st;
+}
+
+dc_status_t dc_client_create_message_with_uploads(dc_client_t* client,
+                                                  dc_snowflake_t channel_id,
+                                                  const char* payload_json,
+                                                  const dc_client_upload_file_t* files,
+                                                  size_t file_count,
+                                                  dc_snowflake_t* message_id) {
+    if (!client || !client->rest || !files) return DC_ERROR_NULL_POINTER;
+    if (!dc_snowflake_is_valid(channel_id)) return DC_ERROR_INVALID_PARAM;
+    if (file_count == 0 || file_count > DC_CLIENT_MAX_UPLOAD_FILES) return DC_ERROR_INVALID_PARAM;
+    if (payload_json && payload_json[0] == '\0') return DC_ERROR_INVALID_PARAM;
+    for (size_t i = 0; i < file_count; i++) {
+        if (!files[i].filename) return DC_ERROR_NULL_POINTER;
+        if (!dc_attachment_filename_is_valid(files[i].filename)) return DC_ERROR_INVALID_PARAM;
+        if (!files[i].path && files[i].fd < 0) return DC_ERROR_INVALID_PARAM;
+    }
+
+    char id_buf[32];
+    dc_status_t st = dc_client_snowflake_to_buf(channel_id, id_buf);
+    if (st != DC_OK) return st;
+
+    dc_client_log(client, DC_LOG_DEBUG, "Create message with %zu direct uploads channel=%s",
+                  file_count, id_buf);
+
+    int fds[DC_CLIENT_MAX_UPLOAD_FILES];
+    int owned[DC_CLIENT_MAX_UPLOAD_FILES];
+    uint64_t sizes[DC_CLIENT_MAX_UPLOAD_FILES];
+    const char* urls[DC_CLIENT_MAX_UPLOAD_FILES];
+    const char* names[DC_CLIENT_MAX_UPLOAD_FILES];
+    dc_upload_item_t items[DC_CLIENT_MAX_UPLOAD_FILES];
+    memset(owned, 0, sizeof(owned));
+    memset(items, 0, sizeof(items));
+    memset(urls, 0, sizeof(urls));
+    memset(names, 0, sizeof(names));
+
+    dc_string_t path;
+    dc_string_t body;
+    dc_string_t slots_json;
+    dc_json_doc_t slots_doc;
+    int path_inited = 0;
+    int body_inited = 0;
+    int slots_json_inited = 0;
+    int slots_doc_inited = 0;
+    dc_uploader_t* uploader = NULL;
+
+    for (size_t i = 0; i < file_count; i++) {
+        fds[i] = files[i].fd;
+        if (files[i].path) {
+            fds[i] = dc_client_open_readonly(files[i].path);
+            if (fds[i] < 0) {
+                st = DC_ERROR_NOT_FOUND;
+                goto cleanup;
+            }
+            owned[i] = 1;
+        }
+        if (!dc_transfer_file_size(fds[i], &sizes[i])) {
+            st = DC_ERROR_INVALID_PARAM;
+            goto cleanup;
+        }
+    }
+
+    st = dc_string_init(&path);
+    if (st != DC_OK) goto cleanup;
+    path_inited = 1;
+    st = dc_string_init(&body);
+    if (st != DC_OK) goto cleanup;
+    body_inited = 1;
+    st = dc_string_init(&slots_json);
+    if (st != DC_OK) goto cleanup;
+    slots_json_inited = 1;
+
+    st = dc_client_build_upload_slots_body(files, sizes, file_count, &body);
+    if (st != DC_OK) goto cleanup;
+    st = dc_string_printf(&path, "/channels/%s/attachments", id_buf);
+    if (st != DC_OK) goto cleanup;
+    st = dc_client_execute_json_request_out(client, DC_HTTP_POST, dc_string_cstr(&path),
+                                            dc_string_cstr(&body), 0, &slots_json);
+    if (st != DC_OK) goto cleanup;
+    st = dc_json_parse(dc_string_cstr(&slots_json), &slots_doc);
+    if (st != DC_OK) goto cleanup;
+    slots_doc_inited = 1;
+    st = dc_client_parse_upload_slots(slots_doc.root, file_count, urls, names);
+    if (st != DC_OK) goto cleanup;
+
+    for (size_t i = 0; i < file_count; i++) {
+        items[i].url = urls[i];
+        items[i].fd = fds[i];
+        items[i].size = sizes[i];
+        items[i].content_type = files[i].content_type;
+    }
+    st = dc_uploader_create(&uploader);
+    if (st != DC_OK) goto cleanup;
+    st = dc_upload_files(uploader, items, file_count, NULL);
+    if (st != DC_OK) {
+        dc_client_log(client, DC_LOG_WARN, "Direct upload failed channel=%s status=%d",
+                      id_buf, (int)st);
+        goto cleanup;
+    }
+
+    st = dc_client_build_uploaded_message_body(payload_json, files, names, file_count, &body);
+    if (st != DC_OK) goto cleanup;
+    st = dc_client_create_message_json(client, channel_id, dc_string_cstr(&body), message_id);
+
+cleanup:
+    if (uploader) dc_uploader_free(uploader);
+    if (slots_doc_inited) dc_json_doc_free(&slots_doc);
+    if (slots_json_inited) dc_string_free(&slots_json);
+    if (body_inited) dc_string_free(&body);
+    if (path_inited) dc_string_free(&path);
+    for (size_t i = 0; i < file_count; i++) {
+        if (owned[i]) dc_client_close_fd(fds[i]);
+    }
+    return st;
+}
+
 dc_status_t dc_client_get_guild_json(dc_client_t* client,
                                      dc_snowflake_t guild_id,
                                      dc_string_t* guild_json) {
@@ -1364,7 +2027,7 @@ dc_status_t dc_client_get_guild_json(dc_client_t* client,
         st = dc_client_execute_json_request(client, DC_HTTP_GET, dc_string_cstr(&path), NULL, 0, &resp);
     }
     if (st == DC_OK) {
-        st = dc_string_set_cstr(guild_json, dc_string_cstr(&resp.http.body));
+        st = dc_rest_response_take_body(&resp, guild_json);
     }
 
     dc_rest_response_free(&resp);
@@ -1417,7 +2080,7 @@ dc_status_t dc_client_get_guild_channels_json(dc_client_t* client,
         st = dc_client_execute_json_request(client, DC_HTTP_GET, dc_string_cstr(&path), NULL, 0, &resp);
     }
     if (st == DC_OK) {
-        st = dc_string_set_cstr(channels_json, dc_string_cstr(&resp.http.body));
+        st = dc_rest_response_take_body(&resp, channels_json);
     }
 
     dc_rest_response_free(&resp);
@@ -1480,6 +2143,26 @@ dc_status_t dc_client_get_channel(dc_client_t* client,
     return st;
 }
 
+/* The client's PATCH body buffer, or @p own (initialized here) while another call holds it. */
+static dc_string_t* dc_client_patch_body_acquire(dc_client_t* client, dc_string_t* own) {
+    if (atomic_exchange(&client->patch_body_busy, 1) == 0) return &client->patch_body;
+    (void)dc_string_init(own);
+    return own;
+}
+
+static void dc_client_patch_body_release(dc_client_t* client, dc_string_t* body) {
+    if (body != &client->patch_body) {
+        dc_string_free(body);
+        return;
+    }
+    if (dc_string_capacity(body) > DC_CLIENT_PATCH_BODY_KEEP_MAX) {
+        dc_string_free(body);
+    } else {
+        (void)dc_string_clear(body);
+    }
+    atomic_store(&client->patch_body_busy, 0);
+}
+
 dc_status_t dc_client_modify_channel_json(dc_client_t* client,
                                           dc_snowflake_t channel_id,
                                           const char* json_body,
@@ -1516,6 +2199,23 @@ dc_status_t dc_client_modify_channel_json(dc_client_t* client,
     return st;
 }
 
+dc_status_t dc_client_modify_channel_diff(dc_client_t* client,
+                                          const dc_channel_t* original,
+                                          const dc_channel_t* edited,
+                                          dc_channel_t* channel) {
+    if (!client || !client->rest || !original || !edited) return DC_ERROR_NULL_POINTER;
+
+    dc_string_t own;
+    dc_string_t* body = dc_client_patch_body_acquire(client, &own);
+    dc_status_t st = dc_json_patch_channel(original, edited, body, NULL);
+    if (st == DC_OK && !dc_string_is_empty(body)) {
+        st = dc_client_modify_channel_json(client, original->id, dc_string_cstr(body), channel);
+    }
+
+    dc_client_patch_body_release(client, body);
+    return st;
+}
+
 dc_status_t dc_client_delete_channel(dc_client_t* client,
                                      dc_snowflake_t channel_id,
                                      dc_channel_t* channel) {
@@ -1615,7 +2315,7 @@ dc_status_t dc_client_list_channel_messages_json(dc_client_t* client,
     st = dc_client_execute_json_request(client, DC_HTTP_GET, dc_string_cstr(&path), NULL, 0, &resp);
     if (st != DC_OK) goto cleanup;
 
-    st = dc_string_set_cstr(messages_json, dc_string_cstr(&resp.http.body));
+    st = dc_rest_response_take_body(&resp, messages_json);
 
 cleanup:
     dc_rest_response_free(&resp);
@@ -1864,7 +2564,7 @@ dc_status_t dc_client_get_pinned_messages_json(dc_client_t* client,
         st = dc_client_execute_json_request(client, DC_HTTP_GET, dc_string_cstr(&path), NULL, 0, &resp);
     }
     if (st == DC_OK) {
-        st = dc_string_set_cstr(messages_json, dc_string_cstr(&resp.http.body));
+        st = dc_rest_response_take_body(&resp, messages_json);
     }
 
     dc_rest_response_free(&resp);
@@ -1956,6 +2656,23 @@ dc_status_t dc_client_modify_guild(dc_client_t* client,
     return st;
 }
 
+dc_status_t dc_client_modify_guild_diff(dc_client_t* client,
+                                        const dc_guild_t* original,
+                                        const dc_guild_t* edited,
+                                        dc_guild_t* guild) {
+    if (!client || !client->rest || !original || !edited) return DC_ERROR_NULL_POINTER;
+
+    dc_string_t own;
+    dc_string_t* body = dc_client_patch_body_acquire(client, &own);
+    dc_status_t st = dc_json_patch_guild(original, edited, body, NULL);
+    if (st == DC_OK && !dc_string_is_empty(body)) {
+        st = dc_client_modify_guild(client, original->id, dc_string_cstr(body), guild);
+    }
+
+    dc_client_patch_body_release(client, body);
+    return st;
+}
+
 dc_status_t dc_client_create_guild_channel_json(dc_client_t* client,
                                                 dc_snowflake_t guild_id,
                                                 const char* json_body,
@@ -2289,6 +3006,25 @@ dc_status_t dc_client_modify_guild_role_json(dc_client_t* client,
     return st;
 }
 
+dc_status_t dc_client_modify_guild_role_diff(dc_client_t* client,
+                                             dc_snowflake_t guild_id,
+                                             const dc_role_t* original,
+                                             const dc_role_t* edited,
+                                             dc_role_t* role) {
+    if (!client || !client->rest || !original || !edited) return DC_ERROR_NULL_POINTER;
+
+    dc_string_t own;
+    dc_string_t* body = dc_client_patch_body_acquire(client, &own);
+    dc_status_t st = dc_json_patch_role(original, edited, body, NULL);
+    if (st == DC_OK && !dc_string_is_empty(body)) {
+        st = dc_client_modify_guild_role_json(client, guild_id, original->id,
+                                              dc_string_cstr(body), role);
+    }
+
+    dc_client_patch_body_release(client, body);
+    return st;
+}
+
 dc_status_t dc_client_delete_guild_role(dc_client_t* client,
                                         dc_snowflake_t guild_id,
                                         dc_snowflake_t role_id) {
@@ -2439,6 +3175,24 @@ dc_status_t dc_client_remove_guild_member_role(dc_client_t* client,
     return st;
 }
 
+dc_status_t dc_client_queue_add_guild_member_role(dc_client_t* client,
+                                                  dc_snowflake_t guild_id,
+                                                  dc_snowflake_t user_id,
+                                                  dc_snowflake_t role_id) {
+    if (!client) return DC_ERROR_NULL_POINTER;
+    if (!client->roles) return DC_ERROR_INVALID_STATE;
+    return dc_role_coalescer_add(client->roles, guild_id, user_id, role_id, dc_client_now_ms());
+}
+
+dc_status_t dc_client_queue_remove_guild_member_role(dc_client_t* client,
+                                                     dc_snowflake_t guild_id,
+                                                     dc_snowflake_t user_id,
+                                                     dc_snowflake_t role_id) {
+    if (!client) return DC_ERROR_NULL_POINTER;
+    if (!client->roles) return DC_ERROR_INVALID_STATE;
+    return dc_role_coalescer_remove(client->roles, guild_id, user_id, role_id, dc_client_now_ms());
+}
+
 dc_status_t dc_client_create_channel_webhook_json(dc_client_t* client,
                                                   dc_snowflake_t channel_id,
                                                   const char* json_body,
@@ -3965,6 +4719,26 @@ dc_status_t dc_client_modify_guild_member_json(dc_client_t* client,
     return st;
 }
 
+dc_status_t dc_client_modify_guild_member_diff(dc_client_t* client,
+                                               dc_snowflake_t guild_id,
+                                               dc_snowflake_t user_id,
+                                               const dc_guild_member_t* original,
+                                               const dc_guild_member_t* edited,
+                                               dc_string_t* member_json) {
+    if (!client || !client->rest || !original || !edited) return DC_ERROR_NULL_POINTER;
+
+    dc_string_t own;
+    dc_string_t* body = dc_client_patch_body_acquire(client, &own);
+    dc_status_t st = dc_json_patch_guild_member(original, edited, body, NULL);
+    if (st == DC_OK && !dc_string_is_empty(body)) {
+        st = dc_client_modify_guild_member_json(client, guild_id, user_id,
+                                                dc_string_cstr(body), member_json);
+    }
+
+    dc_client_patch_body_release(client, body);
+    return st;
+}
+
 dc_status_t dc_client_modify_current_member_json(dc_client_t* client,
                                                  dc_snowflake_t guild_id,
                                                  const char* json_body,
@@ -5871,7 +6645,7 @@ dc_status_t dc_client_create_guild_sticker_multipart(dc_client_t* client,
         goto cleanup_create_sticker_multipart;
     }
     if (sticker_json) {
-        st = dc_string_set_cstr(sticker_json, dc_string_cstr(&resp.http.body));
+        st = dc_rest_response_take_body(&resp, sticker_json);
     }
 
 cleanup_create_sticker_multipart:
@@ -6100,11 +6874,11 @@ dc_status_t dc_client_create_message_command_simple(dc_client_t* client,
     return dc_client_create_context_command_simple(client, application_id, guild_id, name, 3);
 }
 
-dc_status_t dc_client_interaction_callback_json(dc_client_t* client,
-                                                dc_snowflake_t interaction_id,
-                                                const char* interaction_token,
-                                                dc_interaction_callback_type_t callback_type,
-                                                const char* data_json) {
+static dc_status_t dc_client_interaction_callback_send(dc_client_t* client,
+                                                      dc_snowflake_t interaction_id,
+                                                      const char* interaction_token,
+                                                      dc_interaction_callback_type_t callback_type,
+                                                      const char* data_json) {
     if (!client || !client->rest) return DC_ERROR_NULL_POINTER;
     if (!dc_snowflake_is_valid(interaction_id)) return DC_ERROR_INVALID_PARAM;
     if (!interaction_token || interaction_token[0] == '\0') return DC_ERROR_INVALID_PARAM;
@@ -6135,6 +6909,117 @@ cleanup:
     return st;
 }
 
+/*
+ * Clears EPHEMERAL from "flags": the deferral already fixed ephemerality and
+ * edits reject the bit. Other bits (SUPPRESS_EMBEDS, IS_COMPONENTS_V2, ...)
+ * are kept; "flags" is dropped only when nothing else is left in it.
+ */
+static dc_status_t dc_client_json_without_ephemeral_flag(const char* data_json, dc_string_t* out_json) {
+    dc_json_doc_t payload;
+    dc_status_t st = dc_json_parse(data_json, &payload);
+    if (st != DC_OK) return st;
+    if (!yyjson_is_obj(payload.root)) {
+        dc_json_doc_free(&payload);
+        return DC_ERROR_INVALID_PARAM;
+    }
+
+    dc_json_mut_doc_t doc;
+    st = dc_json_mut_doc_create(&doc);
+    if (st != DC_OK) {
+        dc_json_doc_free(&payload);
+        return st;
+    }
+    size_t idx, max;
+    yyjson_val* key;
+    yyjson_val* val;
+    yyjson_obj_foreach(payload.root, idx, max, key, val) {
+        yyjson_mut_val* mut_val = NULL;
+        if (yyjson_equals_str(key, "flags") && yyjson_is_uint(val)) {
+            uint64_t flags = yyjson_get_uint(val) & ~(uint64_t)DC_MESSAGE_FLAG_EPHEMERAL;
+            if (flags == 0) continue;
+            mut_val = yyjson_mut_uint(doc.doc, flags);
+        } else {
+            mut_val = yyjson_val_mut_copy(doc.doc, val);
+        }
+        yyjson_mut_val* mut_key = yyjson_mut_strcpy(doc.doc, yyjson_get_str(key));
+        if (!mut_key || !mut_val || !yyjson_mut_obj_add(doc.root, mut_key, mut_val)) {
+            st = DC_ERROR_OUT_OF_MEMORY;
+            break;
+        }
+    }
+    dc_json_doc_free(&payload);
+    if (st == DC_OK) st = dc_json_mut_doc_serialize(&doc, out_json);
+    dc_json_mut_doc_free(&doc);
+    return st;
+}
+
+/* The watchdog acknowledged the interaction already; send the response in the form still allowed. */
+static dc_status_t dc_client_interaction_respond_deferred(dc_client_t* client,
+                                                          dc_interaction_watchdog_claim_t claim,
+                                                          dc_snowflake_t application_id,
+                                                          const char* interaction_token,
+                                                          dc_interaction_callback_type_t callback_type,
+                                                          const char* data_json) {
+    switch (callback_type) {
+        case DC_INTERACTION_CALLBACK_DEFERRED_CHANNEL_MESSAGE_WITH_SOURCE:
+        case DC_INTERACTION_CALLBACK_DEFERRED_UPDATE_MESSAGE:
+            return DC_OK;
+        case DC_INTERACTION_CALLBACK_CHANNEL_MESSAGE_WITH_SOURCE:
+        case DC_INTERACTION_CALLBACK_UPDATE_MESSAGE:
+            break;
+        default:
+            return DC_ERROR_INVALID_STATE;
+    }
+    if (!data_json || data_json[0] == '\0') return DC_ERROR_INVALID_PARAM;
+
+    /* A new message on a component that was deferred as an update. */
+    if (claim == DC_WATCHDOG_DEFERRED_UPDATE &&
+        callback_type == DC_INTERACTION_CALLBACK_CHANNEL_MESSAGE_WITH_SOURCE) {
+        return dc_client_interaction_create_followup_message_json(client, application_id,
+                                                                  interaction_token, data_json, NULL);
+    }
+
+    dc_string_t edit_json;
+    dc_status_t st = dc_string_init(&edit_json);
+    if (st != DC_OK) return st;
+    st = dc_client_json_without_ephemeral_flag(data_json, &edit_json);
+    if (st == DC_OK) {
+        st = dc_client_interaction_edit_original_response_json(client, application_id, interaction_token,
+                                                               dc_string_cstr(&edit_json));
+    }
+    dc_string_free(&edit_json);
+    return st;
+}
+
+dc_status_t dc_client_interaction_callback_json(dc_client_t* client,
+                                                dc_snowflake_t interaction_id,
+                                                const char* interaction_token,
+                                                dc_interaction_callback_type_t callback_type,
+                                                const char* data_json) {
+    if (!client || !client->rest) return DC_ERROR_NULL_POINTER;
+    if (!client->watchdog) {
+        return dc_client_interaction_callback_send(client, interaction_id, interaction_token,
+                                                   callback_type, data_json);
+    }
+    if (!dc_snowflake_is_valid(interaction_id)) return DC_ERROR_INVALID_PARAM;
+    if (!interaction_token || interaction_token[0] == '\0') return DC_ERROR_INVALID_PARAM;
+
+    dc_interaction_watchdog_claim_t claim = DC_WATCHDOG_RESPOND;
+    dc_snowflake_t application_id = 0;
+    dc_status_t st = dc_interaction_watchdog_begin_response(client->watchdog, interaction_id,
+                                                            &claim, &application_id);
+    if (st != DC_OK) return st;
+    if (claim == DC_WATCHDOG_RESPOND) {
+        st = dc_client_interaction_callback_send(client, interaction_id, interaction_token,
+                                                 callback_type, data_json);
+    } else {
+        st = dc_client_interaction_respond_deferred(client, claim, application_id, interaction_token,
+                                                    callback_type, data_json);
+    }
+    dc_interaction_watchdog_end_response(client->watchdog, interaction_id, st);
+    return st;
+}
+
 dc_status_t dc_client_interaction_respond_message_json(dc_client_t* client,
                                                        dc_snowflake_t interaction_id,
                                                        const char* interaction_token,
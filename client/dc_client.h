@@ -13,7 +13,15 @@
 #include "core/dc_string.h"
 #include "core/dc_snowflake.h"
 #include "http/dc_http_compliance.h"
+#include "http/dc_rest.h"
 #include "gw/dc_gateway.h"
+#include "client/dc_waiters.h"
+#include "client/dc_preflight.h"
+#include "client/dc_command_deploy.h"
+#include "client/dc_interaction_watchdog.h"
+#include "client/dc_role_coalescer.h"
+#include "client/dc_webhook_relay.h"
+#include "client/dc_poll_tally.h"
 #include "model/dc_user.h"
 #include "model/dc_guild.h"
 #include "model/dc_guild_member.h"
@@ -52,6 +60,9 @@ dc_status_t dc_gateway_info_init(dc_gateway_info_t* info);
  */
 void dc_gateway_info_free(dc_gateway_info_t* info);
 
+/** role_coalescer_roles_ttl_ms value that picks the TTL from the client's intents */
+#define DC_CLIENT_ROLES_TTL_AUTO UINT32_MAX
+
 /**
  * @brief Client configuration
  */
@@ -75,6 +86,21 @@ typedef struct {
     dc_log_callback_t log_callback;             /**< Optional log callback */
     void* log_user_data;                        /**< User data for log callback */
     dc_log_level_t log_level;                   /**< Log level filter */
+    dc_rest_transport_fn rest_transport;        /**< Optional REST transport override (tests, proxies) */
+    void* rest_transport_userdata;              /**< User data for rest_transport */
+    int hedge_message_sends;                    /**< Send messages with a nonce and hedge slow sends */
+    uint32_t hedge_percentile;                  /**< Latency percentile that triggers a hedge */
+    uint32_t hedge_min_delay_ms;                /**< Never hedge sooner than this */
+    int permission_preflight;                   /**< Reject REST calls that known permissions make fail */
+    uint32_t rest_global_rate_limit_per_sec;    /**< Global REST request limit (0 = default) */
+    int interaction_watchdog;                   /**< Defer interactions not answered by the deadline */
+    uint32_t interaction_watchdog_deadline_ms;  /**< Time after arrival before the watchdog defers */
+    int interaction_watchdog_ephemeral;         /**< Watchdog deferrals of commands/modals are ephemeral */
+    int role_coalescer;                         /**< Coalesce queued member role mutations */
+    uint32_t role_coalescer_window_ms;          /**< Time queued role mutations wait for more */
+    uint32_t role_coalescer_roles_ttl_ms;       /**< How long observed member roles are trusted (0 = fetch first) */
+    int poll_tally;                             /**< Keep live vote counts of tracked polls */
+    int poll_tally_voters;                      /**< Poll tally also keeps per-answer voter sets */
 } dc_client_config_t;
 
 /**
@@ -85,6 +111,16 @@ typedef struct {
  * - http_timeout_ms: 30000
  * - gateway_timeout_ms: 60000
  * - log_level: INFO
+ * - hedge_message_sends: 0, hedge_percentile: 95, hedge_min_delay_ms: 20
+ * - permission_preflight: 0
+ * - rest_global_rate_limit_per_sec: 0 (50 per second, Discord's default)
+ * - interaction_watchdog: 0, interaction_watchdog_deadline_ms: 2000,
+ *   interaction_watchdog_ephemeral: 0
+ * - role_coalescer: 0, role_coalescer_window_ms: 250,
+ *   role_coalescer_roles_ttl_ms: DC_CLIENT_ROLES_TTL_AUTO (30000 with the
+ *   GUILD_MEMBERS intent, otherwise 0: nothing reports role changes made
+ *   elsewhere, so members are fetched before a PATCH)
+ * - poll_tally: 0, poll_tally_voters: 0
  */
 void dc_client_config_init(dc_client_config_t* config);
 
@@ -162,9 +198,117 @@ dc_status_t dc_client_stop(dc_client_t* client);
  * @return DC_OK on success, error code on failure
  *
  * @note Callbacks run on the calling thread; do not block in callbacks.
+ * @note Returns early enough to time out the next waiter on schedule.
  */
 dc_status_t dc_client_process(dc_client_t* client, uint32_t timeout_ms);
 
+/**
+ * @brief Wait for a component click, reply or modal submit
+ *
+ * The callback runs from dc_client_process when a matching dispatch
+ * arrives (before event_callback sees it) or when the waiter times out.
+ * Matching is a hash lookup, so pending waiters add no per-event scan.
+ *
+ * @param client Discord client
+ * @param spec Waiter description (see dc_waiter_spec_init)
+ * @param waiter_id Optional; receives an ID for dc_client_cancel_waiter
+ * @return DC_OK on success, error code on failure
+ *
+ * @note Not thread-safe; call from the thread running dc_client_process.
+ */
+dc_status_t dc_client_wait_for(dc_client_t* client, const dc_waiter_spec_t* spec, uint64_t* waiter_id);
+
+/**
+ * @brief Cancel a pending waiter (its callback gets DC_WAIT_CANCELLED)
+ * @param client Discord client
+ * @param waiter_id ID from dc_client_wait_for
+ * @return DC_OK on success, DC_ERROR_NOT_FOUND if it already completed
+ */
+dc_status_t dc_client_cancel_waiter(dc_client_t* client, uint64_t waiter_id);
+
+/**
+ * @brief Feed a dispatch to the client's waiters
+ *
+ * For events obtained outside the client's own gateway (e.g. an HTTP
+ * interactions endpoint); gateway dispatches are routed automatically.
+ *
+ * @param client Discord client
+ * @param event_name Dispatch event name
+ * @param event_data Dispatch event JSON data
+ * @return DC_OK on success, error code on failure
+ */
+dc_status_t dc_client_dispatch_to_waiters(dc_client_t* client, const char* event_name,
+                                          const char* event_data);
+
+/**
+ * @brief Get the client's permission preflight
+ *
+ * Gateway dispatches keep it up to date. Feed it guilds or channels from
+ * elsewhere (e.g. REST fetches) with the dc_preflight_set_* functions.
+ *
+ * @param client Discord client
+ * @return Preflight, or NULL when permission_preflight is off
+ */
+dc_preflight_t* dc_client_get_preflight(dc_client_t* client);
+
+/**
+ * @brief Get the client's interaction watchdog
+ *
+ * Gateway INTERACTION_CREATE dispatches are tracked automatically, and the
+ * dc_client_interaction_* callbacks claim the interaction they answer. When
+ * the watchdog deferred first, a later callback is rewritten: a message or
+ * update response edits the original response (the EPHEMERAL flag is
+ * cleared, as ephemerality was fixed by the deferral; other flags are
+ * kept), a message response to an
+ * auto-deferred component becomes a follow-up, a deferral is a no-op, and
+ * modals fail with DC_ERROR_INVALID_STATE.
+ *
+ * @param client Discord client
+ * @return Watchdog, or NULL when interaction_watchdog is off
+ */
+dc_interaction_watchdog_t* dc_client_get_interaction_watchdog(dc_client_t* client);
+
+/**
+ * @brief Get interaction watchdog counters (missed deadlines, auto-deferrals)
+ * @param client Discord client
+ * @param out Receives the counters
+ * @return DC_OK on success, DC_ERROR_INVALID_STATE when interaction_watchdog is off
+ */
+dc_status_t dc_client_get_interaction_watchdog_stats(dc_client_t* client,
+                                                     dc_interaction_watchdog_stats_t* out);
+
+/**
+ * @brief Get the member role coalescer
+ *
+ * Gateway dispatches carrying members keep its role cache current. Batches
+ * are flushed from its thread; dc_client_free flushes what is still queued.
+ *
+ * @param client Discord client
+ * @return Coalescer, or NULL when role_coalescer is off
+ */
+dc_role_coalescer_t* dc_client_get_role_coalescer(dc_client_t* client);
+
+/**
+ * @brief Get role coalescer counters (queued mutations, requests sent)
+ * @param client Discord client
+ * @param out Receives the counters
+ * @return DC_OK on success, DC_ERROR_INVALID_STATE when role_coalescer is off
+ */
+dc_status_t dc_client_get_role_coalescer_stats(dc_client_t* client,
+                                               dc_role_coalescer_stats_t* out);
+
+/**
+ * @brief Get the poll tally
+ *
+ * Fed with every dispatch; polls are added with dc_poll_tally_track or
+ * dc_poll_tally_seed. Needs the GUILD_MESSAGE_POLLS or DIRECT_MESSAGE_POLLS
+ * intent.
+ *
+ * @param client Discord client
+ * @return Tally, or NULL when poll_tally is off
+ */
+dc_poll_tally_t* dc_client_get_poll_tally(dc_client_t* client);
+
 /**
  * @brief Get gateway info from REST /gateway/bot
  * @param client Discord client
@@ -322,6 +466,12 @@ dc_status_t dc_client_create_message(dc_client_t* client, dc_snowflake_t channel
 
 /**
  * @brief Create message in channel with a raw JSON payload
+ *
+ * With hedge_message_sends enabled, the payload gets a nonce (unless it
+ * already has one) and "enforce_nonce": true, and the send goes through
+ * dc_rest_execute_hedged. Discord returns the same message for a repeated
+ * nonce, so a hedged duplicate cannot post twice.
+ *
  * @param client Discord client
  * @param channel_id Channel ID
  * @param json_body Message JSON payload
@@ -333,6 +483,68 @@ dc_status_t dc_client_create_message_json(dc_client_t* client,
                                           const char* json_body,
                                           dc_snowflake_t* message_id);
 
+/**
+ * @brief Maximum files per dc_client_create_message_with_uploads call
+ */
+#define DC_CLIENT_MAX_UPLOAD_FILES 10
+
+/**
+ * @brief File for a direct-to-storage upload
+ */
+typedef struct {
+    const char* path;           /**< File to read (NULL to use fd) */
+    int fd;                     /**< Readable, seekable file when path is NULL */
+    const char* filename;       /**< Attachment filename shown in Discord */
+    const char* description;    /**< Optional alt text */
+    const char* content_type;   /**< Optional Content-Type for the storage PUT */
+} dc_client_upload_file_t;
+
+/**
+ * @brief Create a message whose files are uploaded straight to storage
+ *
+ * Requests upload slots with POST /channels/{id}/attachments, PUTs every
+ * file to its pre-signed URL in parallel while streaming it from disk, then
+ * creates the message with a small JSON body that references each
+ * uploaded_filename. Unlike a multipart create, the file bytes never pass
+ * through the API host, so large files neither sit in memory nor hold the
+ * channel's message bucket while they transfer.
+ *
+ * @param client Discord client
+ * @param channel_id Channel ID
+ * @param payload_json Message JSON object without files (NULL for none);
+ *        its "attachments" field is replaced
+ * @param files Files to attach
+ * @param file_count Number of files (1..DC_CLIENT_MAX_UPLOAD_FILES)
+ * @param message_id Pointer to store created message ID (optional)
+ * @return DC_OK on success, error code on failure (upload failures return the
+ *         dc_upload_files status and no message is created)
+ */
+dc_status_t dc_client_create_message_with_uploads(dc_client_t* client,
+                                                  dc_snowflake_t channel_id,
+                                                  const char* payload_json,
+                                                  const dc_client_upload_file_t* files,
+                                                  size_t file_count,
+                                                  dc_snowflake_t* message_id);
+
+/**
+ * @brief Get hedged send counters for this client
+ * @param client Discord client
+ * @param out Receives the counters
+ * @return DC_OK on success, error code on failure
+ */
+dc_status_t dc_client_get_hedge_stats(dc_client_t* client, dc_rest_hedge_stats_t* out);
+
+/**
+ * @brief Get the rate limit budget of the bucket a request would use
+ * @param client Discord client
+ * @param method Request method
+ * @param path Request path (e.g. "/webhooks/{id}/{token}")
+ * @param out Receives the budget
+ * @return DC_OK on success, error code on failure
+ */
+dc_status_t dc_client_get_route_budget(dc_client_t* client, dc_http_method_t method,
+                                       const char* path, dc_rest_route_budget_t* out);
+
 /**
  * @brief Get guild JSON object
  * @param client Discord client
@@ -405,6 +617,24 @@ dc_status_t dc_client_modify_channel_json(dc_client_t* client,
                                           const char* json_body,
                                           dc_channel_t* channel);
 
+/**
+ * @brief Modify channel, sending only the fields that differ
+ *
+ * The body is built with dc_json_patch_channel() in a buffer the client
+ * keeps for the *_diff calls. If nothing changed, no request is made and
+ * @p channel is left untouched.
+ *
+ * @param client Discord client
+ * @param original Channel as fetched
+ * @param edited Channel with changes applied (same ID)
+ * @param channel Output channel (optional)
+ * @return DC_OK on success, error code on failure
+ */
+dc_status_t dc_client_modify_channel_diff(dc_client_t* client,
+                                          const dc_channel_t* original,
+                                          const dc_channel_t* edited,
+                                          dc_channel_t* channel);
+
 /**
  * @brief Delete/close channel
  * @param client Discord client
@@ -546,6 +776,23 @@ dc_status_t dc_client_modify_guild(dc_client_t* client,
                                    const char* json_body,
                                    dc_guild_t* guild);
 
+/**
+ * @brief Modify guild, sending only the fields that differ
+ *
+ * The body is built with dc_json_patch_guild(). If nothing changed, no
+ * request is made and @p guild is left untouched.
+ *
+ * @param client Discord client
+ * @param original Guild as fetched
+ * @param edited Guild with changes applied (same ID)
+ * @param guild Output guild (optional, overwritten when non-NULL)
+ * @return DC_OK on success, error code on failure
+ */
+dc_status_t dc_client_modify_guild_diff(dc_client_t* client,
+                                        const dc_guild_t* original,
+                                        const dc_guild_t* edited,
+                                        dc_guild_t* guild);
+
 /**
  * @brief Create guild channel using JSON body
  * @param client Discord client
@@ -684,6 +931,25 @@ dc_status_t dc_client_modify_guild_role_json(dc_client_t* client,
                                              const char* json_body,
                                              dc_role_t* role);
 
+/**
+ * @brief Modify guild role, sending only the fields that differ
+ *
+ * The body is built with dc_json_patch_role(). If nothing changed, no
+ * request is made and @p role is left untouched.
+ *
+ * @param client Discord client
+ * @param guild_id Guild ID
+ * @param original Role as fetched
+ * @param edited Role with changes applied (same ID)
+ * @param role Output role (optional)
+ * @return DC_OK on success, error code on failure
+ */
+dc_status_t dc_client_modify_guild_role_diff(dc_client_t* client,
+                                             dc_snowflake_t guild_id,
+                                             const dc_role_t* original,
+                                             const dc_role_t* edited,
+                                             dc_role_t* role);
+
 /**
  * @brief Delete guild role
  * @param client Discord client
@@ -732,6 +998,36 @@ dc_status_t dc_client_remove_guild_member_role(dc_client_t* client,
                                                dc_snowflake_t user_id,
                                                dc_snowflake_t role_id);
 
+/**
+ * @brief Queue adding a role to a guild member through the role coalescer
+ *
+ * Returns once queued. Failed batches are logged and counted in
+ * dc_client_get_role_coalescer_stats.
+ *
+ * @param client Discord client
+ * @param guild_id Guild ID
+ * @param user_id User ID
+ * @param role_id Role ID
+ * @return DC_OK when queued, DC_ERROR_INVALID_STATE when role_coalescer is off
+ */
+dc_status_t dc_client_queue_add_guild_member_role(dc_client_t* client,
+                                                  dc_snowflake_t guild_id,
+                                                  dc_snowflake_t user_id,
+                                                  dc_snowflake_t role_id);
+
+/**
+ * @brief Queue removing a role from a guild member through the role coalescer
+ * @param client Discord client
+ * @param guild_id Guild ID
+ * @param user_id User ID
+ * @param role_id Role ID
+ * @return DC_OK when queued, DC_ERROR_INVALID_STATE when role_coalescer is off
+ */
+dc_status_t dc_client_queue_remove_guild_member_role(dc_client_t* client,
+                                                     dc_snowflake_t guild_id,
+                                                     dc_snowflake_t user_id,
+                                                     dc_snowflake_t role_id);
+
 /**
  * @brief Create channel webhook using JSON body
  * @param client Discord client
@@ -1136,6 +1432,27 @@ dc_status_t dc_client_modify_guild_member_json(dc_client_t* client,
                                                dc_snowflake_t user_id,
                                                const char* json_body,
                                                dc_string_t* member_json);
+
+/**
+ * @brief Modify guild member, sending only the fields that differ
+ *
+ * The body is built with dc_json_patch_guild_member(). If nothing changed,
+ * no request is made and @p member_json is left untouched.
+ *
+ * @param client Discord client
+ * @param guild_id Guild ID
+ * @param user_id Member's user ID
+ * @param original Member as fetched
+ * @param edited Member with changes applied
+ * @param member_json Output member JSON (optional)
+ * @return DC_OK on success, error code on failure
+ */
+dc_status_t dc_client_modify_guild_member_diff(dc_client_t* client,
+                                               dc_snowflake_t guild_id,
+                                               dc_snowflake_t user_id,
+                                               const dc_guild_member_t* original,
+                                               const dc_guild_member_t* edited,
+                                               dc_string_t* member_json);
 dc_status_t dc_client_modify_current_member_json(dc_client_t* client,
                                                  dc_snowflake_t guild_id,
                                                  const char* json_body,
@@ -0,0 +1,231 @@
+/**
+ * @file dc_command_deploy.c
+ * @brief Bulk per-guild application command deployment
+ */
+
+#include "dc_command_deploy.h"
+#include "client/dc_client.h"
+#include "core/dc_alloc.h"
+#include "core/dc_platform.h"
+#include <string.h>
+
+#define DC_DEPLOY_IDLE UINT64_MAX
+#define DC_DEPLOY_BACKOFF_MS 250u
+#define DC_DEPLOY_BACKOFF_MAX_MS 5000u
+
+typedef struct dc_deploy_run dc_deploy_run_t;
+
+typedef struct {
+    dc_deploy_run_t* run;
+    uint64_t current;       /* plan index being deployed, DC_DEPLOY_IDLE otherwise */
+} dc_deploy_worker_t;
+
+struct dc_deploy_run {
+    dc_client_t* client;
+    const dc_command_deploy_config_t* config;
+    dc_platform_mutex_t lock;
+    dc_deploy_worker_t* workers;
+    uint32_t worker_count;
+    uint64_t next_index;
+    uint64_t first_failed;  /* lowest failed plan index, DC_DEPLOY_IDLE if none */
+    int exhausted;
+    int stopped;
+    dc_status_t stop_status;
+    uint64_t start_ms;
+    uint64_t last_progress_ms;
+    dc_command_deploy_progress_t progress;
+};
+
+void dc_command_deploy_config_init(dc_command_deploy_config_t* config) {
+    if (!config) return;
+    memset(config, 0, sizeof(*config));
+    config->concurrency = 16;
+    config->max_attempts = 3;
+    config->progress_interval_ms = 1000;
+}
+
+static uint64_t dc_deploy_now_ms(void) {
+    uint64_t now = 0;
+    dc_platform_now_monotonic_ms(&now);
+    return now;
+}
+
+static int dc_deploy_is_transient(dc_status_t st) {
+    return st == DC_ERROR_RATE_LIMITED || st == DC_ERROR_NETWORK || st == DC_ERROR_TIMEOUT ||
+           st == DC_ERROR_UNAVAILABLE || st == DC_ERROR_SERVER || st == DC_ERROR_TRY_AGAIN;
+}
+
+/* Lock held. */
+static void dc_deploy_snapshot(dc_deploy_run_t* run, uint64_t now_ms) {
+    dc_command_deploy_progress_t* p = &run->progress;
+    uint64_t checkpoint = (run->first_failed < run->next_index) ? run->first_failed : run->next_index;
+    for (uint32_t i = 0; i < run->worker_count; i++) {
+        if (run->workers[i].current < checkpoint) checkpoint = run->workers[i].current;
+    }
+    p->checkpoint = checkpoint;
+    p->elapsed_ms = now_ms - run->start_ms;
+    uint64_t done = p->succeeded + p->failed;
+    p->per_sec = (p->elapsed_ms > 0) ? (double)done * 1000.0 / (double)p->elapsed_ms : 0.0;
+    p->eta_ms = 0;
+    if (p->total > 0 && p->per_sec > 0.0) {
+        uint64_t finished = run->config->start_index + done;
+        uint64_t remaining = (p->total > finished) ? p->total - finished : 0;
+        p->eta_ms = (uint64_t)((double)remaining * 1000.0 / p->per_sec);
+    }
+}
+
+/* Lock held. */
+static void dc_deploy_report(dc_deploy_run_t* run, int force) {
+    const dc_command_deploy_config_t* cfg = run->config;
+    uint64_t now = dc_deploy_now_ms();
+    if (!force && now - run->last_progress_ms < cfg->progress_interval_ms) return;
+    run->last_progress_ms = now;
+    dc_deploy_snapshot(run, now);
+    if (!cfg->on_progress) return;
+    dc_status_t st = cfg->on_progress(cfg->user_data, &run->progress);
+    if (st != DC_OK && !run->stopped) {
+        run->stopped = 1;
+        run->stop_status = st;
+    }
+}
+
+static dc_status_t dc_deploy_one(dc_deploy_run_t* run, const dc_command_deploy_item_t* item) {
+    const dc_command_deploy_config_t* cfg = run->config;
+    uint32_t max_attempts = (cfg->max_attempts == 0) ? 1u : cfg->max_attempts;
+    dc_status_t st = DC_OK;
+    for (uint32_t attempt = 1; ; attempt++) {
+        st = dc_client_bulk_overwrite_guild_application_commands_json(
+            run->client, cfg->application_id, item->guild_id,
+            dc_string_cstr(&item->commands_json), NULL);
+        if (st == DC_OK || !dc_deploy_is_transient(st) || attempt >= max_attempts) break;
+
+        uint64_t backoff = (uint64_t)DC_DEPLOY_BACKOFF_MS << (attempt - 1u);
+        if (backoff > DC_DEPLOY_BACKOFF_MAX_MS) backoff = DC_DEPLOY_BACKOFF_MAX_MS;
+        if (dc_platform_mutex_lock(&run->lock)) {
+            run->progress.retries++;
+            dc_platform_mutex_unlock(&run->lock);
+        }
+        dc_platform_sleep_ms(backoff);
+    }
+    return st;
+}
+
+static void dc_deploy_worker_loop(dc_deploy_worker_t* worker) {
+    dc_deploy_run_t* run = worker->run;
+    const dc_command_deploy_config_t* cfg = run->config;
+    dc_command_deploy_item_t item;
+    item.guild_id = 0;
+    if (dc_string_init(&item.commands_json) != DC_OK) return;
+    if (!dc_platform_mutex_lock(&run->lock)) {
+        dc_string_free(&item.commands_json);
+        return;
+    }
+
+    while (!run->stopped && !run->exhausted) {
+        uint64_t index = run->next_index;
+        item.guild_id = 0;
+        dc_string_clear(&item.commands_json);
+        dc_status_t st = cfg->next(cfg->user_data, index, &item);
+        if (st == DC_ERROR_NOT_FOUND) {
+            run->exhausted = 1;
+            break;
+        }
+        if (st != DC_OK) {
+            run->stopped = 1;
+            run->stop_status = st;
+            break;
+        }
+        run->next_index++;
+        worker->current = index;
+        run->progress.in_flight++;
+        dc_platform_mutex_unlock(&run->lock);
+
+        st = dc_deploy_one(run, &item);
+
+        if (!dc_platform_mutex_lock(&run->lock)) {
+            dc_string_free(&item.commands_json);
+            return;
+        }
+        run->progress.in_flight--;
+        worker->current = DC_DEPLOY_IDLE;
+        if (st == DC_OK) {
+            run->progress.succeeded++;
+        } else {
+            run->progress.failed++;
+            if (index < run->first_failed) run->first_failed = index;
+        }
+        if (cfg->on_result) cfg->on_result(cfg->user_data, index, item.guild_id, st);
+        dc_deploy_report(run, 0);
+    }
+
+    dc_platform_mutex_unlock(&run->lock);
+    dc_string_free(&item.commands_json);
+}
+
+static void dc_deploy_worker_main(void* arg) {
+    dc_deploy_worker_loop((dc_deploy_worker_t*)arg);
+}
+
+dc_status_t dc_command_deploy_run(dc_client_t* client, const dc_command_deploy_config_t* config,
+                                  dc_command_deploy_progress_t* out_progress) {
+    if (!client || !config || !config->next) return DC_ERROR_NULL_POINTER;
+    if (!dc_snowflake_is_valid(config->application_id)) return DC_ERROR_INVALID_PARAM;
+
+    uint32_t concurrency = (config->concurrency == 0) ? 1u : config->concurrency;
+
+    dc_deploy_run_t run;
+    memset(&run, 0, sizeof(run));
+    run.client = client;
+    run.config = config;
+    run.next_index = config->start_index;
+    run.first_failed = DC_DEPLOY_IDLE;
+    run.stop_status = DC_OK;
+    run.progress.total = config->total;
+    run.start_ms = dc_deploy_now_ms();
+    run.last_progress_ms = run.start_ms;
+    run.workers = (dc_deploy_worker_t*)dc_calloc(concurrency, sizeof(dc_deploy_worker_t));
+    if (!run.workers) return DC_ERROR_OUT_OF_MEMORY;
+    if (!dc_platform_mutex_init(&run.lock)) {
+        dc_free(run.workers);
+        return DC_ERROR_INVALID_STATE;
+    }
+    run.worker_count = concurrency;
+    for (uint32_t i = 0; i < concurrency; i++) {
+        run.workers[i].run = &run;
+        run.workers[i].current = DC_DEPLOY_IDLE;
+    }
+
+    /* The calling thread is worker 0; if threads cannot be started, fewer workers share the plan. */
+    dc_platform_thread_t* threads = NULL;
+    uint32_t started = 0;
+    if (concurrency > 1) {
+        threads = (dc_platform_thread_t*)dc_calloc(concurrency - 1u, sizeof(dc_platform_thread_t));
+        if (threads) {
+            for (uint32_t i = 1; i < concurrency; i++) {
+                if (!dc_platform_thread_create(&threads[started], dc_deploy_worker_main, &run.workers[i])) break;
+                started++;
+            }
+        }
+    }
+
+    dc_deploy_worker_loop(&run.workers[0]);
+
+    for (uint32_t i = 0; i < started; i++) {
+        (void)dc_platform_thread_join(threads[i]);
+    }
+    dc_free(threads);
+
+    dc_status_t result = DC_OK;
+    if (dc_platform_mutex_lock(&run.lock)) {
+        dc_deploy_report(&run, 1);
+        result = run.stop_status;
+        if (out_progress) *out_progress = run.progress;
+        dc_platform_mutex_unlock(&run.lock);
+    } else {
+        result = DC_ERROR_INVALID_STATE;
+    }
+
+    dc_platform_mutex_destroy(&run.lock);
+    dc_free(run.workers);
+    return result;
+}
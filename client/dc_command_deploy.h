@@ -0,0 +1,133 @@
+#ifndef DC_COMMAND_DEPLOY_H
+#define DC_COMMAND_DEPLOY_H
+
+/**
+ * @file dc_command_deploy.h
+ * @brief Bulk per-guild application command deployment
+ *
+ * Deploys per-guild command sets with one bulk overwrite
+ * (PUT /applications/{app}/guilds/{guild}/commands) per guild. The plan is
+ * pulled from a generator one guild at a time, so it never has to be held in
+ * memory. Several workers share the client: each guild route has its own
+ * rate limit bucket, so a 429 or an exhausted bucket only holds up the
+ * worker on that guild, while the REST client's global limiter keeps the
+ * total request rate within the global limit.
+ *
+ * Progress is checkpointed as the plan index below which every guild has
+ * been deployed. A failed guild holds the checkpoint at its index, so
+ * passing it back as start_index resumes an interrupted deployment without
+ * skipping failures; guilds after the first failure are deployed again.
+ */
+
+#include <stdint.h>
+#include "core/dc_status.h"
+#include "core/dc_string.h"
+#include "core/dc_snowflake.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct dc_client dc_client_t;
+
+/**
+ * @brief One guild of the plan, filled by the generator
+ */
+typedef struct {
+    dc_snowflake_t guild_id;    /**< Guild to deploy to */
+    dc_string_t commands_json;  /**< JSON array of command objects (the full set for the guild) */
+} dc_command_deploy_item_t;
+
+/**
+ * @brief Produce plan entry @p index
+ *
+ * item->commands_json is initialized and empty on entry.
+ *
+ * @return DC_OK with item filled, DC_ERROR_NOT_FOUND when the plan is
+ *         exhausted, anything else to abort the deployment
+ */
+typedef dc_status_t (*dc_command_deploy_next_fn)(void* user_data, uint64_t index,
+                                                 dc_command_deploy_item_t* item);
+
+/**
+ * @brief Called once per finished guild
+ * @param status DC_OK, or the error of the last attempt
+ */
+typedef void (*dc_command_deploy_result_fn)(void* user_data, uint64_t index,
+                                            dc_snowflake_t guild_id, dc_status_t status);
+
+/**
+ * @brief Deployment progress
+ */
+typedef struct {
+    uint64_t total;         /**< Plan size from the config (0 if unknown) */
+    uint64_t checkpoint;    /**< Every entry below this index has been deployed */
+    uint64_t succeeded;     /**< Guilds deployed in this run */
+    uint64_t failed;        /**< Guilds that failed in this run */
+    uint64_t retries;       /**< Extra attempts after transient errors */
+    uint32_t in_flight;     /**< Guilds currently being deployed */
+    uint64_t elapsed_ms;    /**< Time since the run started */
+    double per_sec;         /**< Finished guilds per second */
+    uint64_t eta_ms;        /**< Estimated time left (0 if total is unknown or no guild finished yet) */
+} dc_command_deploy_progress_t;
+
+/**
+ * @brief Periodic progress report
+ * @return DC_OK to continue, anything else to stop issuing new guilds
+ */
+typedef dc_status_t (*dc_command_deploy_progress_fn)(void* user_data,
+                                                     const dc_command_deploy_progress_t* progress);
+
+/**
+ * @brief Deployment configuration
+ *
+ * Callbacks run on worker threads but never concurrently, so they need no
+ * locking of their own. Keep them short: workers wait for them.
+ */
+typedef struct {
+    dc_snowflake_t application_id;          /**< Application owning the commands */
+    dc_command_deploy_next_fn next;         /**< Plan generator (required) */
+    dc_command_deploy_result_fn on_result;  /**< Optional per-guild result */
+    dc_command_deploy_progress_fn on_progress; /**< Optional progress report */
+    void* user_data;                        /**< Passed to every callback */
+    uint64_t start_index;                   /**< First plan index (a previous checkpoint to resume) */
+    uint64_t total;                         /**< Plan size for the ETA (0 if unknown) */
+    uint32_t concurrency;                   /**< Guilds deployed at once */
+    uint32_t max_attempts;                  /**< Attempts per guild on transient errors */
+    uint32_t progress_interval_ms;          /**< Minimum time between progress reports */
+} dc_command_deploy_config_t;
+
+/**
+ * @brief Initialize a deployment configuration with defaults
+ *
+ * Defaults:
+ * - concurrency: 16
+ * - max_attempts: 3
+ * - progress_interval_ms: 1000
+ */
+void dc_command_deploy_config_init(dc_command_deploy_config_t* config);
+
+/**
+ * @brief Deploy the plan, blocking until it is exhausted or stopped
+ *
+ * Rate limits, network errors and 5xx responses are retried up to
+ * max_attempts with a short backoff; other errors fail the guild and the run
+ * moves on. on_progress is called at most every progress_interval_ms and
+ * once more when the run ends. On platforms without threads the guilds are
+ * deployed one at a time on the calling thread.
+ *
+ * @param client Discord client (its REST client is shared by the workers)
+ * @param config Deployment configuration
+ * @param out_progress Final progress (optional); its checkpoint is the
+ *        start_index for resuming
+ * @return DC_OK when the plan was exhausted (check failed for per-guild
+ *         errors), or the status the generator or progress callback stopped with
+ */
+dc_status_t dc_command_deploy_run(dc_client_t* client, const dc_command_deploy_config_t* config,
+                                  dc_command_deploy_progress_t* out_progress);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DC_COMMAND_DEPLOY_H */
@@ -0,0 +1,436 @@
+/**
+ * @file dc_interaction_watchdog.c
+ * @brief Automatic deferral of interactions nobody answered in time
+ */
+
+#include "dc_interaction_watchdog.h"
+#include "core/dc_alloc.h"
+#include "core/dc_platform.h"
+#include "core/dc_snowflake_map.h"
+#include "core/dc_string.h"
+#include "json/dc_json.h"
+#include <string.h>
+#include <yyjson.h>
+
+/* Interaction types from the INTERACTION_CREATE payload */
+#define DC_WATCHDOG_INTERACTION_COMMAND 2
+#define DC_WATCHDOG_INTERACTION_COMPONENT 3
+#define DC_WATCHDOG_INTERACTION_MODAL 5
+
+#define DC_WATCHDOG_DEFAULT_DEADLINE_MS 2000u
+#define DC_WATCHDOG_DEFAULT_DEFER_THREADS 4u
+#define DC_WATCHDOG_MAX_DEFER_THREADS 32u
+
+typedef enum {
+    DC_WATCHDOG_PENDING = 0,    /* waiting for its deadline (pending list) */
+    DC_WATCHDOG_DEFERRING,      /* deferral in flight (no list) */
+    DC_WATCHDOG_DEFERRED,       /* deferred, waiting for the response (deferred list) */
+    DC_WATCHDOG_RESPONDING,     /* response in flight (no list) */
+    DC_WATCHDOG_CONVERTING      /* rewritten response in flight (no list) */
+} dc_watchdog_state_t;
+
+typedef struct dc_watchdog_entry dc_watchdog_entry_t;
+
+struct dc_watchdog_entry {
+    dc_snowflake_t interaction_id;
+    dc_snowflake_t application_id;
+    int update_message;             /* component: defer as an update */
+    dc_watchdog_state_t state;
+    uint64_t arrived_ms;
+    dc_string_t token;
+    dc_watchdog_entry_t* prev;
+    dc_watchdog_entry_t* next;
+};
+
+typedef struct {
+    dc_watchdog_entry_t* head;
+    dc_watchdog_entry_t* tail;
+} dc_watchdog_list_t;
+
+struct dc_interaction_watchdog {
+    dc_interaction_watchdog_config_t config;
+    dc_platform_mutex_t lock;
+    dc_platform_cond_t work;        /* threads: pending list or stop changed */
+    dc_platform_cond_t settled;     /* a deferral left DEFERRING */
+    dc_snowflake_map_t entries;     /* interaction_id -> dc_watchdog_entry_t* */
+    dc_watchdog_list_t pending;     /* arrival order, so deadline order */
+    dc_watchdog_list_t deferred;    /* deferral order */
+    dc_interaction_watchdog_stats_t stats;
+    int stop;
+    dc_platform_thread_t threads[DC_WATCHDOG_MAX_DEFER_THREADS];
+    uint32_t thread_count;
+};
+
+void dc_interaction_watchdog_config_init(dc_interaction_watchdog_config_t* config) {
+    if (!config) return;
+    memset(config, 0, sizeof(*config));
+    config->deadline_ms = DC_WATCHDOG_DEFAULT_DEADLINE_MS;
+    config->use_thread = 1;
+    config->defer_threads = DC_WATCHDOG_DEFAULT_DEFER_THREADS;
+}
+
+static void dc_watchdog_list_unlink(dc_watchdog_list_t* list, dc_watchdog_entry_t* e) {
+    if (e->prev) e->prev->next = e->next; else list->head = e->next;
+    if (e->next) e->next->prev = e->prev; else list->tail = e->prev;
+    e->prev = NULL;
+    e->next = NULL;
+}
+
+static void dc_watchdog_list_append(dc_watchdog_list_t* list, dc_watchdog_entry_t* e) {
+    e->next = NULL;
+    e->prev = list->tail;
+    if (list->tail) list->tail->next = e; else list->head = e;
+    list->tail = e;
+}
+
+/* Keeps the pending list in arrival order when a failed response puts an entry back. */
+static void dc_watchdog_list_insert_by_arrival(dc_watchdog_list_t* list, dc_watchdog_entry_t* e) {
+    dc_watchdog_entry_t* after = list->tail;
+    while (after && after->arrived_ms > e->arrived_ms) after = after->prev;
+    e->prev = after;
+    e->next = after ? after->next : list->head;
+    if (e->next) e->next->prev = e; else list->tail = e;
+    if (after) after->next = e; else list->head = e;
+}
+
+static dc_watchdog_entry_t* dc_watchdog_find(dc_interaction_watchdog_t* wd, dc_snowflake_t id) {
+    dc_watchdog_entry_t** slot = (dc_watchdog_entry_t**)dc_snowflake_map_get(&wd->entries, id);
+    return slot ? *slot : NULL;
+}
+
+/* Lock held; the entry must not be linked. */
+static void dc_watchdog_remove(dc_interaction_watchdog_t* wd, dc_watchdog_entry_t* e) {
+    (void)dc_snowflake_map_remove(&wd->entries, e->interaction_id, NULL);
+    dc_string_free(&e->token);
+    dc_free(e);
+}
+
+static uint64_t dc_watchdog_now_ms(void) {
+    uint64_t now = 0;
+    dc_platform_now_monotonic_ms(&now);
+    return now;
+}
+
+/*
+ * Lock held on entry and on return. Sends the deferral for @p e with the lock
+ * released; the entry is only freed by whoever moves it out of DEFERRING,
+ * which is us. Returns 0 if the lock could not be taken back.
+ */
+static int dc_watchdog_defer_one(dc_interaction_watchdog_t* wd, dc_watchdog_entry_t* e) {
+    dc_watchdog_list_unlink(&wd->pending, e);
+    e->state = DC_WATCHDOG_DEFERRING;
+    wd->stats.missed_deadlines++;
+    dc_platform_mutex_unlock(&wd->lock);
+
+    dc_status_t st = wd->config.defer(wd->config.user_data, e->interaction_id,
+                                      dc_string_cstr(&e->token), e->update_message,
+                                      wd->config.defer_ephemeral);
+
+    if (!dc_platform_mutex_lock(&wd->lock)) return 0;
+    if (st == DC_OK) {
+        e->state = DC_WATCHDOG_DEFERRED;
+        dc_watchdog_list_append(&wd->deferred, e);
+        wd->stats.auto_deferred++;
+    } else {
+        wd->stats.defer_failures++;
+        dc_watchdog_remove(wd, e);
+    }
+    dc_platform_cond_broadcast(&wd->settled);
+    return 1;
+}
+
+/* Lock held. */
+static void dc_watchdog_expire(dc_interaction_watchdog_t* wd, uint64_t now_ms) {
+    dc_watchdog_entry_t* e = wd->deferred.head;
+    while (e && e->arrived_ms + DC_INTERACTION_TOKEN_TTL_MS <= now_ms) {
+        dc_watchdog_entry_t* next = e->next;
+        dc_watchdog_list_unlink(&wd->deferred, e);
+        wd->stats.expired++;
+        dc_watchdog_remove(wd, e);
+        e = next;
+    }
+}
+
+/*
+ * Every thread takes the next overdue interaction off the pending list, so
+ * a slow deferral only holds up its own thread and up to defer_threads go
+ * out at once.
+ */
+static void dc_watchdog_thread_main(void* arg) {
+    dc_interaction_watchdog_t* wd = (dc_interaction_watchdog_t*)arg;
+    if (!dc_platform_mutex_lock(&wd->lock)) return;
+    while (!wd->stop) {
+        uint64_t now = dc_watchdog_now_ms();
+        dc_watchdog_entry_t* e = wd->pending.head;
+        if (e && e->arrived_ms + wd->config.deadline_ms <= now) {
+            if (!dc_watchdog_defer_one(wd, e)) return;
+            continue;
+        }
+        dc_watchdog_expire(wd, now);
+
+        /* Sleep until the next deadline or expiry; track() and stop wake us earlier. */
+        uint64_t wake_ms = UINT64_MAX;
+        if (wd->pending.head) wake_ms = wd->pending.head->arrived_ms + wd->config.deadline_ms;
+        if (wd->deferred.head) {
+            uint64_t expiry = wd->deferred.head->arrived_ms + DC_INTERACTION_TOKEN_TTL_MS;
+            if (expiry < wake_ms) wake_ms = expiry;
+        }
+        if (wake_ms == UINT64_MAX) {
+            (void)dc_platform_cond_wait(&wd->work, &wd->lock);
+        } else if (wake_ms > now) {
+            (void)dc_platform_cond_timedwait_ms(&wd->work, &wd->lock, wake_ms - now);
+        }
+    }
+    dc_platform_mutex_unlock(&wd->lock);
+}
+
+/* Stops and joins the threads started so far. */
+static void dc_watchdog_stop_threads(dc_interaction_watchdog_t* wd) {
+    if (dc_platform_mutex_lock(&wd->lock)) {
+        wd->stop = 1;
+        dc_platform_cond_broadcast(&wd->work);
+        dc_platform_mutex_unlock(&wd->lock);
+    }
+    for (uint32_t i = 0; i < wd->thread_count; i++) (void)dc_platform_thread_join(wd->threads[i]);
+    wd->thread_count = 0;
+}
+
+dc_status_t dc_interaction_watchdog_create(const dc_interaction_watchdog_config_t* config,
+                                           dc_interaction_watchdog_t** out) {
+    if (!config || !out || !config->defer) return DC_ERROR_NULL_POINTER;
+    *out = NULL;
+
+    dc_interaction_watchdog_t* wd = (dc_interaction_watchdog_t*)dc_alloc(sizeof(*wd));
+    if (!wd) return DC_ERROR_OUT_OF_MEMORY;
+    memset(wd, 0, sizeof(*wd));
+    wd->config = *config;
+    if (wd->config.deadline_ms == 0) wd->config.deadline_ms = DC_WATCHDOG_DEFAULT_DEADLINE_MS;
+    if (wd->config.defer_threads == 0) wd->config.defer_threads = 1;
+    if (wd->config.defer_threads > DC_WATCHDOG_MAX_DEFER_THREADS) {
+        wd->config.defer_threads = DC_WATCHDOG_MAX_DEFER_THREADS;
+    }
+
+    if (!dc_platform_mutex_init(&wd->lock)) {
+        dc_free(wd);
+        return DC_ERROR_INVALID_STATE;
+    }
+    if (!dc_platform_cond_init(&wd->work)) {
+        dc_platform_mutex_destroy(&wd->lock);
+        dc_free(wd);
+        return DC_ERROR_INVALID_STATE;
+    }
+    if (!dc_platform_cond_init(&wd->settled)) {
+        dc_platform_cond_destroy(&wd->work);
+        dc_platform_mutex_destroy(&wd->lock);
+        dc_free(wd);
+        return DC_ERROR_INVALID_STATE;
+    }
+    dc_status_t st = dc_snowflake_map_init(&wd->entries, sizeof(dc_watchdog_entry_t*));
+    if (st != DC_OK) {
+        dc_platform_cond_destroy(&wd->settled);
+        dc_platform_cond_destroy(&wd->work);
+        dc_platform_mutex_destroy(&wd->lock);
+        dc_free(wd);
+        return st;
+    }
+
+    if (config->use_thread) {
+        for (uint32_t i = 0; i < wd->config.defer_threads; i++) {
+            if (!dc_platform_thread_create(&wd->threads[i], dc_watchdog_thread_main, wd)) {
+                dc_watchdog_stop_threads(wd);
+                dc_snowflake_map_free(&wd->entries);
+                dc_platform_cond_destroy(&wd->settled);
+                dc_platform_cond_destroy(&wd->work);
+                dc_platform_mutex_destroy(&wd->lock);
+                dc_free(wd);
+                return DC_ERROR_INVALID_STATE;
+            }
+            wd->thread_count++;
+        }
+    }
+
+    *out = wd;
+    return DC_OK;
+}
+
+void dc_interaction_watchdog_free(dc_interaction_watchdog_t* watchdog) {
+    if (!watchdog) return;
+    dc_watchdog_stop_threads(watchdog);
+    size_t cursor = 0;
+    void* slot = NULL;
+    while (dc_snowflake_map_next(&watchdog->entries, &cursor, NULL, &slot)) {
+        dc_watchdog_entry_t* e = *(dc_watchdog_entry_t**)slot;
+        dc_string_free(&e->token);
+        dc_free(e);
+    }
+    dc_snowflake_map_free(&watchdog->entries);
+    dc_platform_cond_destroy(&watchdog->settled);
+    dc_platform_cond_destroy(&watchdog->work);
+    dc_platform_mutex_destroy(&watchdog->lock);
+    dc_free(watchdog);
+}
+
+dc_status_t dc_interaction_watchdog_track(dc_interaction_watchdog_t* watchdog,
+                                          const char* event_data, uint64_t now_ms) {
+    if (!watchdog || !event_data) return DC_ERROR_NULL_POINTER;
+
+    dc_json_doc_t doc;
+    dc_status_t st = dc_json_parse(event_data, &doc);
+    if (st != DC_OK) return st;
+
+    int64_t type = 0;
+    uint64_t interaction_id = 0;
+    uint64_t application_id = 0;
+    const char* token = NULL;
+    st = dc_json_get_int64(doc.root, "type", &type);
+    if (st == DC_OK && type != DC_WATCHDOG_INTERACTION_COMMAND &&
+        type != DC_WATCHDOG_INTERACTION_COMPONENT && type != DC_WATCHDOG_INTERACTION_MODAL) {
+        dc_json_doc_free(&doc);
+        return DC_OK;
+    }
+    if (st == DC_OK) st = dc_json_get_snowflake(doc.root, "id", &interaction_id);
+    if (st == DC_OK) st = dc_json_get_snowflake(doc.root, "application_id", &application_id);
+    if (st == DC_OK) st = dc_json_get_string(doc.root, "token", &token);
+    if (st == DC_OK && token[0] == '\0') st = DC_ERROR_INVALID_FORMAT;
+    if (st != DC_OK) {
+        dc_json_doc_free(&doc);
+        return st;
+    }
+
+    dc_watchdog_entry_t* e = (dc_watchdog_entry_t*)dc_alloc(sizeof(*e));
+    if (!e) {
+        dc_json_doc_free(&doc);
+        return DC_ERROR_OUT_OF_MEMORY;
+    }
+    memset(e, 0, sizeof(*e));
+    e->interaction_id = (dc_snowflake_t)interaction_id;
+    e->application_id = (dc_snowflake_t)application_id;
+    e->update_message = (type == DC_WATCHDOG_INTERACTION_COMPONENT);
+    e->state = DC_WATCHDOG_PENDING;
+    e->arrived_ms = now_ms;
+    st = dc_string_init_from_cstr(&e->token, token);
+    dc_json_doc_free(&doc);
+    if (st != DC_OK) {
+        dc_free(e);
+        return st;
+    }
+
+    if (!dc_platform_mutex_lock(&watchdog->lock)) {
+        dc_string_free(&e->token);
+        dc_free(e);
+        return DC_ERROR_INVALID_STATE;
+    }
+    if (dc_snowflake_map_contains(&watchdog->entries, e->interaction_id)) {
+        dc_platform_mutex_unlock(&watchdog->lock);
+        dc_string_free(&e->token);
+        dc_free(e);
+        return DC_OK;
+    }
+    st = dc_snowflake_map_put(&watchdog->entries, e->interaction_id, &e);
+    if (st == DC_OK) {
+        dc_watchdog_list_append(&watchdog->pending, e);
+        watchdog->stats.tracked++;
+        dc_platform_cond_signal(&watchdog->work);
+    }
+    dc_platform_mutex_unlock(&watchdog->lock);
+    if (st != DC_OK) {
+        dc_string_free(&e->token);
+        dc_free(e);
+    }
+    return st;
+}
+
+uint32_t dc_interaction_watchdog_poll(dc_interaction_watchdog_t* watchdog, uint64_t now_ms) {
+    if (!watchdog) return 0;
+    if (!dc_platform_mutex_lock(&watchdog->lock)) return 0;
+
+    uint32_t attempted = 0;
+    const uint64_t deadline_ms = watchdog->config.deadline_ms;
+    dc_watchdog_entry_t* e = watchdog->pending.head;
+    while (e && e->arrived_ms + deadline_ms <= now_ms) {
+        attempted++;
+        if (!dc_watchdog_defer_one(watchdog, e)) return attempted;
+        e = watchdog->pending.head;
+    }
+    dc_watchdog_expire(watchdog, now_ms);
+
+    dc_platform_mutex_unlock(&watchdog->lock);
+    return attempted;
+}
+
+int dc_interaction_watchdog_next_deadline(dc_interaction_watchdog_t* watchdog, uint64_t* out_ms) {
+    if (!watchdog || !out_ms) return 0;
+    if (!dc_platform_mutex_lock(&watchdog->lock)) return 0;
+    int has = watchdog->pending.head != NULL;
+    if (has) *out_ms = watchdog->pending.head->arrived_ms + watchdog->config.deadline_ms;
+    dc_platform_mutex_unlock(&watchdog->lock);
+    return has;
+}
+
+dc_status_t dc_interaction_watchdog_begin_response(dc_interaction_watchdog_t* watchdog,
+                                                   dc_snowflake_t interaction_id,
+                                                   dc_interaction_watchdog_claim_t* claim,
+                                                   dc_snowflake_t* application_id) {
+    if (!watchdog || !claim) return DC_ERROR_NULL_POINTER;
+    *claim = DC_WATCHDOG_RESPOND;
+    if (!dc_platform_mutex_lock(&watchdog->lock)) return DC_ERROR_INVALID_STATE;
+
+    dc_watchdog_entry_t* e = dc_watchdog_find(watchdog, interaction_id);
+    /* A deferral is one REST call; wait for it rather than racing it. */
+    while (e && e->state == DC_WATCHDOG_DEFERRING) {
+        if (!dc_platform_cond_wait(&watchdog->settled, &watchdog->lock)) {
+            dc_platform_mutex_unlock(&watchdog->lock);
+            return DC_ERROR_INVALID_STATE;
+        }
+        e = dc_watchdog_find(watchdog, interaction_id);
+    }
+
+    if (e && e->state == DC_WATCHDOG_PENDING) {
+        dc_watchdog_list_unlink(&watchdog->pending, e);
+        e->state = DC_WATCHDOG_RESPONDING;
+    } else if (e && e->state == DC_WATCHDOG_DEFERRED) {
+        dc_watchdog_list_unlink(&watchdog->deferred, e);
+        e->state = DC_WATCHDOG_CONVERTING;
+        *claim = e->update_message ? DC_WATCHDOG_DEFERRED_UPDATE : DC_WATCHDOG_DEFERRED_MESSAGE;
+        if (application_id) *application_id = e->application_id;
+    }
+    dc_platform_mutex_unlock(&watchdog->lock);
+    return DC_OK;
+}
+
+void dc_interaction_watchdog_end_response(dc_interaction_watchdog_t* watchdog,
+                                          dc_snowflake_t interaction_id, dc_status_t status) {
+    if (!watchdog) return;
+    if (!dc_platform_mutex_lock(&watchdog->lock)) return;
+
+    dc_watchdog_entry_t* e = dc_watchdog_find(watchdog, interaction_id);
+    if (e && e->state == DC_WATCHDOG_RESPONDING) {
+        if (status == DC_OK) {
+            watchdog->stats.responded++;
+            dc_watchdog_remove(watchdog, e);
+        } else {
+            e->state = DC_WATCHDOG_PENDING;
+            dc_watchdog_list_insert_by_arrival(&watchdog->pending, e);
+            dc_platform_cond_signal(&watchdog->work);
+        }
+    } else if (e && e->state == DC_WATCHDOG_CONVERTING) {
+        if (status == DC_OK) {
+            watchdog->stats.converted++;
+            dc_watchdog_remove(watchdog, e);
+        } else {
+            e->state = DC_WATCHDOG_DEFERRED;
+            dc_watchdog_list_append(&watchdog->deferred, e);
+        }
+    }
+    dc_platform_mutex_unlock(&watchdog->lock);
+}
+
+dc_status_t dc_interaction_watchdog_get_stats(dc_interaction_watchdog_t* watchdog,
+                                              dc_interaction_watchdog_stats_t* out) {
+    if (!watchdog || !out) return DC_ERROR_NULL_POINTER;
+    if (!dc_platform_mutex_lock(&watchdog->lock)) return DC_ERROR_INVALID_STATE;
+    *out = watchdog->stats;
+    out->pending = (uint32_t)dc_snowflake_map_length(&watchdog->entries);
+    dc_platform_mutex_unlock(&watchdog->lock);
+    return DC_OK;
+}
@@ -0,0 +1,201 @@
+#ifndef DC_INTERACTION_WATCHDOG_H
+#define DC_INTERACTION_WATCHDOG_H
+
+/**
+ * @file dc_interaction_watchdog.h
+ * @brief Automatic deferral of interactions nobody answered in time
+ *
+ * Discord drops an interaction that is not acknowledged within 3 seconds.
+ * The watchdog records each command, component and modal interaction when
+ * it arrives. If no response has been started by the deadline, it defers
+ * the interaction itself: components with a deferred update (callback type
+ * 6), everything else with a deferred message (type 5). Interaction
+ * callbacks are exempt from the REST global limit, so the deferral does not
+ * queue behind other traffic.
+ *
+ * A response started after the watchdog deferred is rewritten by the
+ * caller using the claim from dc_interaction_watchdog_begin_response;
+ * the client does this transparently. Deferred entries are kept until they
+ * are answered or the 15 minute interaction token expires.
+ *
+ * Thread-safe: tracking, responses and polling may come from different
+ * threads.
+ */
+
+#include <stdint.h>
+#include "core/dc_status.h"
+#include "core/dc_snowflake.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** How long an interaction token stays valid */
+#define DC_INTERACTION_TOKEN_TTL_MS 900000u
+
+/**
+ * @brief Send the deferral for an interaction that missed its deadline
+ * @param update_message 1 for a deferred update (type 6), 0 for a deferred message (type 5)
+ * @param ephemeral 1 if a deferred message should be ephemeral
+ * @return DC_OK if Discord accepted the deferral
+ */
+typedef dc_status_t (*dc_interaction_watchdog_defer_fn)(void* user_data,
+                                                        dc_snowflake_t interaction_id,
+                                                        const char* interaction_token,
+                                                        int update_message,
+                                                        int ephemeral);
+
+/**
+ * @brief Watchdog configuration
+ */
+typedef struct {
+    uint32_t deadline_ms;                   /**< Time after arrival before deferring */
+    int defer_ephemeral;                    /**< Deferred messages are ephemeral */
+    int use_thread;                         /**< Poll from background threads */
+    uint32_t defer_threads;                 /**< Background threads, i.e. deferrals sent at once (use_thread) */
+    dc_interaction_watchdog_defer_fn defer; /**< Sends the deferral (required) */
+    void* user_data;                        /**< Passed to defer */
+} dc_interaction_watchdog_config_t;
+
+/**
+ * @brief Watchdog counters
+ */
+typedef struct {
+    uint64_t tracked;           /**< Interactions recorded */
+    uint64_t responded;         /**< Answered before the deadline */
+    uint64_t missed_deadlines;  /**< Deadline passed without a response */
+    uint64_t auto_deferred;     /**< Deferrals Discord accepted */
+    uint64_t defer_failures;    /**< Deferrals that failed (the interaction is dropped from tracking) */
+    uint64_t converted;         /**< Responses rewritten after an automatic deferral */
+    uint64_t expired;           /**< Deferred interactions never answered before the token expired */
+    uint32_t pending;           /**< Interactions currently tracked */
+} dc_interaction_watchdog_stats_t;
+
+/**
+ * @brief How a response has to be sent
+ */
+typedef enum {
+    DC_WATCHDOG_RESPOND = 0,        /**< Not deferred by the watchdog: send as usual */
+    DC_WATCHDOG_DEFERRED_MESSAGE,   /**< Auto-deferred with a loading message (type 5) */
+    DC_WATCHDOG_DEFERRED_UPDATE     /**< Auto-deferred as a component update (type 6) */
+} dc_interaction_watchdog_claim_t;
+
+/**
+ * @brief Watchdog (opaque)
+ */
+typedef struct dc_interaction_watchdog dc_interaction_watchdog_t;
+
+/**
+ * @brief Initialize a watchdog configuration with defaults
+ *
+ * Defaults:
+ * - deadline_ms: 2000 (leaves a second for the deferral to reach Discord)
+ * - defer_ephemeral: 0
+ * - use_thread: 1
+ * - defer_threads: 4 (capped at 32)
+ */
+void dc_interaction_watchdog_config_init(dc_interaction_watchdog_config_t* config);
+
+/**
+ * @brief Create a watchdog
+ *
+ * With use_thread, defer_threads background threads wait for the deadlines
+ * so deferrals go out even while the thread running the handlers is
+ * blocked. Each thread sends one deferral at a time, so a burst of up to
+ * defer_threads overdue interactions is deferred concurrently and a slow
+ * deferral only delays the ones queued behind it once every thread is busy.
+ * Without use_thread (or on platforms without threads) the owner calls
+ * dc_interaction_watchdog_poll.
+ *
+ * @param config Configuration
+ * @param out Pointer to store created watchdog
+ * @return DC_OK on success, error code on failure
+ */
+dc_status_t dc_interaction_watchdog_create(const dc_interaction_watchdog_config_t* config,
+                                           dc_interaction_watchdog_t** out);
+
+/**
+ * @brief Stop the background thread and free the watchdog
+ * @param watchdog Watchdog to free (may be NULL)
+ */
+void dc_interaction_watchdog_free(dc_interaction_watchdog_t* watchdog);
+
+/**
+ * @brief Record an INTERACTION_CREATE payload
+ *
+ * PING and autocomplete interactions are ignored, as are interactions that
+ * are already tracked.
+ *
+ * @param watchdog Watchdog
+ * @param event_data INTERACTION_CREATE JSON data
+ * @param now_ms Arrival time (monotonic ms)
+ * @return DC_OK on success, error code on failure
+ */
+dc_status_t dc_interaction_watchdog_track(dc_interaction_watchdog_t* watchdog,
+                                          const char* event_data, uint64_t now_ms);
+
+/**
+ * @brief Defer every interaction past its deadline and drop expired ones
+ *
+ * Deferrals are sent one after another from the calling thread, without
+ * holding the watchdog lock.
+ *
+ * @param watchdog Watchdog
+ * @param now_ms Current time (monotonic ms)
+ * @return Number of deferrals attempted
+ */
+uint32_t dc_interaction_watchdog_poll(dc_interaction_watchdog_t* watchdog, uint64_t now_ms);
+
+/**
+ * @brief Earliest pending deadline
+ * @param watchdog Watchdog
+ * @param out_ms Receives the deadline (monotonic ms)
+ * @return 1 if an interaction is waiting for its deadline, 0 otherwise
+ */
+int dc_interaction_watchdog_next_deadline(dc_interaction_watchdog_t* watchdog, uint64_t* out_ms);
+
+/**
+ * @brief Claim an interaction before sending its response
+ *
+ * While the response is in flight the watchdog does not defer the
+ * interaction. If a deferral is in flight, waits for it to finish. Every
+ * call must be paired with dc_interaction_watchdog_end_response.
+ *
+ * @param watchdog Watchdog
+ * @param interaction_id Interaction being answered
+ * @param claim Receives how the response has to be sent
+ * @param application_id Receives the application ID for DC_WATCHDOG_DEFERRED_* (optional)
+ * @return DC_OK on success, error code on failure
+ */
+dc_status_t dc_interaction_watchdog_begin_response(dc_interaction_watchdog_t* watchdog,
+                                                   dc_snowflake_t interaction_id,
+                                                   dc_interaction_watchdog_claim_t* claim,
+                                                   dc_snowflake_t* application_id);
+
+/**
+ * @brief Release a claim from dc_interaction_watchdog_begin_response
+ *
+ * On DC_OK the interaction is answered and no longer tracked. On failure it
+ * goes back to waiting, so the watchdog can still defer it.
+ *
+ * @param watchdog Watchdog
+ * @param interaction_id Interaction that was answered
+ * @param status Result of the response
+ */
+void dc_interaction_watchdog_end_response(dc_interaction_watchdog_t* watchdog,
+                                          dc_snowflake_t interaction_id, dc_status_t status);
+
+/**
+ * @brief Get the watchdog counters
+ * @param watchdog Watchdog
+ * @param out Receives the counters
+ * @return DC_OK on success, error code on failure
+ */
+dc_status_t dc_interaction_watchdog_get_stats(dc_interaction_watchdog_t* watchdog,
+                                              dc_interaction_watchdog_stats_t* out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DC_INTERACTION_WATCHDOG_H */
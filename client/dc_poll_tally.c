@@ -0,0 +1,480 @@
+/**
+ * @file dc_poll_tally.c
+ * @brief Live poll vote tallies
+ */
+
+#include "dc_poll_tally.h"
+#include "client/dc_client.h"
+#include "core/dc_alloc.h"
+#include "core/dc_platform.h"
+#include "core/dc_snowflake_map.h"
+#include "gw/dc_events.h"
+#include "json/dc_json.h"
+#include <string.h>
+#include <yyjson.h>
+
+#define DC_POLL_TALLY_DEFAULT_MAX_POLLS 1024u
+#define DC_POLL_TALLY_PAGE_LIMIT 100u
+
+/* A vote removed while its poll was being seeded; later pages must not bring it back. */
+typedef struct {
+    dc_snowflake_t user_id;
+    uint32_t answer_id;
+} dc_poll_removal_t;
+
+/* Stored inline in the poll map; the vectors only own heap buffers, so moving is safe. */
+typedef struct {
+    dc_snowflake_t channel_id;
+    uint32_t counts[DC_POLL_TALLY_MAX_ANSWERS];
+    int seeded;
+    uint64_t seed_gen;          /* non-zero while a seed is running */
+    int has_sets;               /* voters[] maintained (track_voters or seeding) */
+    dc_vec_t voters[DC_POLL_TALLY_MAX_ANSWERS];  /* sorted dc_snowflake_t */
+    dc_vec_t removals;          /* dc_poll_removal_t, while seeding */
+} dc_poll_record_t;
+
+struct dc_poll_tally {
+    dc_client_t* client;
+    int track_voters;
+    uint32_t max_polls;
+    dc_platform_mutex_t lock;
+    dc_snowflake_map_t polls;   /* message_id -> dc_poll_record_t */
+    uint64_t next_gen;
+    dc_poll_tally_stats_t stats;
+};
+
+void dc_poll_tally_config_init(dc_poll_tally_config_t* config) {
+    if (!config) return;
+    memset(config, 0, sizeof(*config));
+    config->max_polls = DC_POLL_TALLY_DEFAULT_MAX_POLLS;
+}
+
+/* Binary search; returns 1 if found. *index is the match or the insertion point. */
+static int dc_poll_set_find(const dc_vec_t* set, dc_snowflake_t id, size_t* index) {
+    const dc_snowflake_t* ids = (const dc_snowflake_t*)dc_vec_data(set);
+    size_t lo = 0;
+    size_t hi = dc_vec_length(set);
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (ids[mid] < id) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    *index = lo;
+    return lo < dc_vec_length(set) && ids[lo] == id;
+}
+
+/* Returns 1 if added, 0 if present, -1 on allocation failure. */
+static int dc_poll_set_add(dc_vec_t* set, dc_snowflake_t id) {
+    size_t len = dc_vec_length(set);
+    /* Voter pages arrive in ID order, so seeding appends. */
+    if (len == 0 || *(const dc_snowflake_t*)dc_vec_back(set) < id) {
+        return dc_vec_push(set, &id) == DC_OK ? 1 : -1;
+    }
+    size_t index = 0;
+    if (dc_poll_set_find(set, id, &index)) return 0;
+    return dc_vec_insert(set, index, &id) == DC_OK ? 1 : -1;
+}
+
+static int dc_poll_set_remove(dc_vec_t* set, dc_snowflake_t id) {
+    size_t index = 0;
+    if (!dc_poll_set_find(set, id, &index)) return 0;
+    (void)dc_vec_remove(set, index, NULL);
+    return 1;
+}
+
+static void dc_poll_record_init(dc_poll_record_t* rec, dc_snowflake_t channel_id) {
+    memset(rec, 0, sizeof(*rec));
+    rec->channel_id = channel_id;
+    for (size_t i = 0; i < DC_POLL_TALLY_MAX_ANSWERS; i++) {
+        (void)dc_vec_init(&rec->voters[i], sizeof(dc_snowflake_t));
+    }
+    (void)dc_vec_init(&rec->removals, sizeof(dc_poll_removal_t));
+}
+
+static void dc_poll_record_drop_sets(dc_poll_record_t* rec) {
+    for (size_t i = 0; i < DC_POLL_TALLY_MAX_ANSWERS; i++) {
+        dc_vec_free(&rec->voters[i]);
+        (void)dc_vec_init(&rec->voters[i], sizeof(dc_snowflake_t));
+    }
+    rec->has_sets = 0;
+}
+
+static void dc_poll_record_free(dc_poll_record_t* rec) {
+    for (size_t i = 0; i < DC_POLL_TALLY_MAX_ANSWERS; i++) dc_vec_free(&rec->voters[i]);
+    dc_vec_free(&rec->removals);
+}
+
+static uint32_t dc_poll_record_total(const dc_poll_record_t* rec) {
+    uint32_t total = 0;
+    for (size_t i = 0; i < DC_POLL_TALLY_MAX_ANSWERS; i++) total += rec->counts[i];
+    return total;
+}
+
+dc_status_t dc_poll_tally_create(dc_client_t* client, const dc_poll_tally_config_t* config,
+                                 dc_poll_tally_t** out) {
+    if (!client || !config || !out) return DC_ERROR_NULL_POINTER;
+    *out = NULL;
+
+    dc_poll_tally_t* tally = (dc_poll_tally_t*)dc_alloc(sizeof(*tally));
+    if (!tally) return DC_ERROR_OUT_OF_MEMORY;
+    memset(tally, 0, sizeof(*tally));
+    tally->client = client;
+    tally->track_voters = config->track_voters ? 1 : 0;
+    tally->max_polls = (config->max_polls == 0) ? DC_POLL_TALLY_DEFAULT_MAX_POLLS : config->max_polls;
+
+    dc_status_t st = dc_snowflake_map_init(&tally->polls, sizeof(dc_poll_record_t));
+    if (st != DC_OK) {
+        dc_free(tally);
+        return st;
+    }
+    if (!dc_platform_mutex_init(&tally->lock)) {
+        dc_snowflake_map_free(&tally->polls);
+        dc_free(tally);
+        return DC_ERROR_INVALID_STATE;
+    }
+    *out = tally;
+    return DC_OK;
+}
+
+void dc_poll_tally_free(dc_poll_tally_t* tally) {
+    if (!tally) return;
+    size_t cursor = 0;
+    dc_snowflake_t key = 0;
+    void* value = NULL;
+    while (dc_snowflake_map_next(&tally->polls, &cursor, &key, &value)) {
+        dc_poll_record_free((dc_poll_record_t*)value);
+    }
+    dc_snowflake_map_free(&tally->polls);
+    dc_platform_mutex_destroy(&tally->lock);
+    dc_free(tally);
+}
+
+/* Lock held. Finds or creates the record of a poll. */
+static dc_status_t dc_poll_tally_upsert(dc_poll_tally_t* tally, dc_snowflake_t channel_id,
+                                        dc_snowflake_t message_id, dc_poll_record_t** out,
+                                        int* out_inserted) {
+    *out = (dc_poll_record_t*)dc_snowflake_map_get(&tally->polls, message_id);
+    *out_inserted = 0;
+    if (*out) return DC_OK;
+    if (dc_snowflake_map_length(&tally->polls) >= tally->max_polls) return DC_ERROR_BUFFER_TOO_SMALL;
+    void* slot = NULL;
+    dc_status_t st = dc_snowflake_map_upsert(&tally->polls, message_id, &slot, out_inserted);
+    if (st != DC_OK) return st;
+    *out = (dc_poll_record_t*)slot;
+    dc_poll_record_init(*out, channel_id);
+    (*out)->has_sets = tally->track_voters;
+    return DC_OK;
+}
+
+dc_status_t dc_poll_tally_track(dc_poll_tally_t* tally, dc_snowflake_t channel_id,
+                                dc_snowflake_t message_id) {
+    if (!tally) return DC_ERROR_NULL_POINTER;
+    if (!dc_snowflake_is_valid(channel_id) || !dc_snowflake_is_valid(message_id)) {
+        return DC_ERROR_INVALID_PARAM;
+    }
+    if (!dc_platform_mutex_lock(&tally->lock)) return DC_ERROR_INVALID_STATE;
+    dc_poll_record_t* rec = NULL;
+    int inserted = 0;
+    dc_status_t st = dc_poll_tally_upsert(tally, channel_id, message_id, &rec, &inserted);
+    if (st == DC_OK && inserted) rec->seeded = 1;
+    dc_platform_mutex_unlock(&tally->lock);
+    return st;
+}
+
+static void dc_poll_tally_remove_locked(dc_poll_tally_t* tally, dc_snowflake_t message_id) {
+    dc_poll_record_t rec;
+    if (dc_snowflake_map_remove(&tally->polls, message_id, &rec) == DC_OK) dc_poll_record_free(&rec);
+}
+
+dc_status_t dc_poll_tally_untrack(dc_poll_tally_t* tally, dc_snowflake_t message_id) {
+    if (!tally) return DC_ERROR_NULL_POINTER;
+    if (!dc_platform_mutex_lock(&tally->lock)) return DC_ERROR_INVALID_STATE;
+    dc_status_t st = DC_ERROR_NOT_FOUND;
+    if (dc_snowflake_map_contains(&tally->polls, message_id)) {
+        dc_poll_tally_remove_locked(tally, message_id);
+        st = DC_OK;
+    }
+    dc_platform_mutex_unlock(&tally->lock);
+    return st;
+}
+
+/* Lock held. Applies one vote dispatch. */
+static dc_status_t dc_poll_tally_apply(dc_poll_tally_t* tally, const dc_gateway_message_poll_vote_t* vote,
+                                       int add) {
+    dc_poll_record_t* rec = (dc_poll_record_t*)dc_snowflake_map_get(&tally->polls, vote->message_id);
+    if (!rec || vote->answer_id > DC_POLL_TALLY_MAX_ANSWERS) {
+        tally->stats.ignored++;
+        return DC_OK;
+    }
+    uint32_t slot = vote->answer_id - 1;
+    if (rec->seed_gen != 0) {
+        /* The removal log only guards pages still to come; a re-vote clears it. */
+        dc_poll_removal_t* removals = (dc_poll_removal_t*)dc_vec_data(&rec->removals);
+        for (size_t i = 0; i < dc_vec_length(&rec->removals); i++) {
+            if (removals[i].user_id == vote->user_id && removals[i].answer_id == vote->answer_id) {
+                (void)dc_vec_swap_remove(&rec->removals, i, NULL);
+                break;
+            }
+        }
+        if (!add) {
+            dc_poll_removal_t removal = {vote->user_id, vote->answer_id};
+            dc_status_t st = dc_vec_push(&rec->removals, &removal);
+            if (st != DC_OK) return st;
+        }
+    }
+
+    int changed = 1;
+    if (rec->has_sets) {
+        if (add) {
+            changed = dc_poll_set_add(&rec->voters[slot], vote->user_id);
+            if (changed < 0) return DC_ERROR_OUT_OF_MEMORY;
+        } else {
+            changed = dc_poll_set_remove(&rec->voters[slot], vote->user_id);
+        }
+    } else if (!add && rec->counts[slot] == 0) {
+        changed = 0;
+    }
+    if (!changed) {
+        tally->stats.duplicates++;
+        return DC_OK;
+    }
+    if (add) {
+        rec->counts[slot]++;
+        tally->stats.votes_added++;
+    } else {
+        rec->counts[slot]--;
+        tally->stats.votes_removed++;
+    }
+    return DC_OK;
+}
+
+/* Lock held. Merges one page of voters; returns the number of users and the last ID. */
+static dc_status_t dc_poll_tally_merge_page(dc_poll_record_t* rec, uint32_t answer_id, yyjson_val* users,
+                                            size_t* out_count, dc_snowflake_t* out_last) {
+    dc_vec_t* set = &rec->voters[answer_id - 1];
+    const dc_poll_removal_t* removals = (const dc_poll_removal_t*)dc_vec_data(&rec->removals);
+    size_t removal_count = dc_vec_length(&rec->removals);
+    size_t idx = 0, max = 0;
+    yyjson_val* user = NULL;
+    *out_count = 0;
+    yyjson_arr_foreach(users, idx, max, user) {
+        dc_snowflake_t id = 0;
+        dc_status_t st = dc_json_get_snowflake(user, "id", &id);
+        if (st != DC_OK) return st;
+        (*out_count)++;
+        *out_last = id;
+        int removed = 0;
+        for (size_t i = 0; i < removal_count && !removed; i++) {
+            removed = removals[i].user_id == id && removals[i].answer_id == answer_id;
+        }
+        if (!removed && dc_poll_set_add(set, id) < 0) return DC_ERROR_OUT_OF_MEMORY;
+    }
+    return DC_OK;
+}
+
+/* Lock held. The record of a running seed, or NULL if it was untracked or reseeded. */
+static dc_poll_record_t* dc_poll_tally_seed_record(dc_poll_tally_t* tally, dc_snowflake_t message_id,
+                                                   uint64_t gen) {
+    dc_poll_record_t* rec = (dc_poll_record_t*)dc_snowflake_map_get(&tally->polls, message_id);
+    return (rec && rec->seed_gen == gen) ? rec : NULL;
+}
+
+static dc_status_t dc_poll_tally_seed_answer(dc_poll_tally_t* tally, dc_snowflake_t channel_id,
+                                             dc_snowflake_t message_id, uint32_t answer_id, uint64_t gen) {
+    dc_string_t page_json;
+    dc_status_t st = dc_string_init(&page_json);
+    if (st != DC_OK) return st;
+    dc_snowflake_t after = 0;
+    for (;;) {
+        st = dc_client_get_poll_answer_voters_json(tally->client, channel_id, message_id, answer_id, after,
+                                                   DC_POLL_TALLY_PAGE_LIMIT, &page_json);
+        if (st != DC_OK) break;
+        dc_json_doc_t doc;
+        st = dc_json_parse(dc_string_cstr(&page_json), &doc);
+        if (st != DC_OK) break;
+        yyjson_val* users = NULL;
+        size_t count = 0;
+        st = dc_json_get_array(doc.root, "users", &users);
+        if (st == DC_OK && !dc_platform_mutex_lock(&tally->lock)) st = DC_ERROR_INVALID_STATE;
+        if (st == DC_OK) {
+            dc_poll_record_t* rec = dc_poll_tally_seed_record(tally, message_id, gen);
+            st = rec ? dc_poll_tally_merge_page(rec, answer_id, users, &count, &after) : DC_ERROR_CONFLICT;
+            tally->stats.pages++;
+            dc_platform_mutex_unlock(&tally->lock);
+        }
+        dc_json_doc_free(&doc);
+        if (st != DC_OK || count < DC_POLL_TALLY_PAGE_LIMIT) break;
+    }
+    dc_string_free(&page_json);
+    return st;
+}
+
+dc_status_t dc_poll_tally_seed(dc_poll_tally_t* tally, dc_snowflake_t channel_id,
+                               dc_snowflake_t message_id, uint32_t answer_count) {
+    if (!tally) return DC_ERROR_NULL_POINTER;
+    if (!dc_snowflake_is_valid(channel_id) || !dc_snowflake_is_valid(message_id)) {
+        return DC_ERROR_INVALID_PARAM;
+    }
+    if (answer_count == 0 || answer_count > DC_POLL_TALLY_MAX_ANSWERS) return DC_ERROR_INVALID_PARAM;
+
+    /* Votes dispatched while the pages are read go into fresh voter sets. */
+    if (!dc_platform_mutex_lock(&tally->lock)) return DC_ERROR_INVALID_STATE;
+    dc_poll_record_t* rec = NULL;
+    int inserted = 0;
+    dc_status_t st = dc_poll_tally_upsert(tally, channel_id, message_id, &rec, &inserted);
+    if (st != DC_OK) {
+        dc_platform_mutex_unlock(&tally->lock);
+        return st;
+    }
+    uint64_t gen = ++tally->next_gen;
+    dc_poll_record_drop_sets(rec);
+    (void)dc_vec_clear(&rec->removals);
+    memset(rec->counts, 0, sizeof(rec->counts));
+    rec->channel_id = channel_id;
+    rec->seeded = 0;
+    rec->seed_gen = gen;
+    rec->has_sets = 1;
+    dc_platform_mutex_unlock(&tally->lock);
+
+    for (uint32_t answer_id = 1; answer_id <= answer_count && st == DC_OK; answer_id++) {
+        st = dc_poll_tally_seed_answer(tally, channel_id, message_id, answer_id, gen);
+    }
+
+    if (!dc_platform_mutex_lock(&tally->lock)) return DC_ERROR_INVALID_STATE;
+    rec = dc_poll_tally_seed_record(tally, message_id, gen);
+    if (!rec) {
+        st = DC_ERROR_CONFLICT;
+    } else if (st != DC_OK) {
+        dc_poll_tally_remove_locked(tally, message_id);
+    } else {
+        for (size_t i = 0; i < DC_POLL_TALLY_MAX_ANSWERS; i++) {
+            rec->counts[i] = (uint32_t)dc_vec_length(&rec->voters[i]);
+        }
+        rec->seeded = 1;
+        rec->seed_gen = 0;
+        dc_vec_free(&rec->removals);
+        (void)dc_vec_init(&rec->removals, sizeof(dc_poll_removal_t));
+        if (!tally->track_voters) dc_poll_record_drop_sets(rec);
+        tally->stats.seeds++;
+    }
+    dc_platform_mutex_unlock(&tally->lock);
+    return st;
+}
+
+static dc_status_t dc_poll_tally_feed_vote(dc_poll_tally_t* tally, const char* event_data, int add) {
+    dc_gateway_message_poll_vote_t vote;
+    dc_status_t st = dc_gateway_event_parse_message_poll_vote(event_data, &vote);
+    if (st != DC_OK) return st;
+    if (!dc_platform_mutex_lock(&tally->lock)) return DC_ERROR_INVALID_STATE;
+    st = dc_poll_tally_apply(tally, &vote, add);
+    dc_platform_mutex_unlock(&tally->lock);
+    dc_gateway_message_poll_vote_free(&vote);
+    return st;
+}
+
+dc_status_t dc_poll_tally_feed_event(dc_poll_tally_t* tally, const char* event_name,
+                                     const char* event_data) {
+    if (!tally || !event_name || !event_data) return DC_ERROR_NULL_POINTER;
+    switch (dc_gateway_event_kind_from_name(event_name)) {
+        case DC_GATEWAY_EVENT_MESSAGE_POLL_VOTE_ADD:
+            return dc_poll_tally_feed_vote(tally, event_data, 1);
+        case DC_GATEWAY_EVENT_MESSAGE_POLL_VOTE_REMOVE:
+            return dc_poll_tally_feed_vote(tally, event_data, 0);
+        case DC_GATEWAY_EVENT_MESSAGE_DELETE: {
+            dc_gateway_message_delete_t del;
+            dc_status_t st = dc_gateway_event_parse_message_delete(event_data, &del);
+            if (st != DC_OK) return st;
+            if (!dc_platform_mutex_lock(&tally->lock)) return DC_ERROR_INVALID_STATE;
+            dc_poll_tally_remove_locked(tally, del.id);
+            dc_platform_mutex_unlock(&tally->lock);
+            dc_gateway_message_delete_free(&del);
+            return DC_OK;
+        }
+        case DC_GATEWAY_EVENT_MESSAGE_DELETE_BULK: {
+            dc_gateway_message_delete_bulk_t bulk;
+            dc_status_t st = dc_gateway_event_parse_message_delete_bulk(event_data, &bulk);
+            if (st != DC_OK) return st;
+            if (dc_platform_mutex_lock(&tally->lock)) {
+                for (size_t i = 0; i < dc_vec_length(&bulk.ids); i++) {
+                    dc_poll_tally_remove_locked(tally, *(const dc_snowflake_t*)dc_vec_at(&bulk.ids, i));
+                }
+                dc_platform_mutex_unlock(&tally->lock);
+            } else {
+                st = DC_ERROR_INVALID_STATE;
+            }
+            dc_gateway_message_delete_bulk_free(&bulk);
+            return st;
+        }
+        default:
+            return DC_OK;
+    }
+}
+
+dc_status_t dc_poll_tally_get(dc_poll_tally_t* tally, dc_snowflake_t message_id,
+                              dc_poll_tally_result_t* out) {
+    if (!tally || !out) return DC_ERROR_NULL_POINTER;
+    if (!dc_platform_mutex_lock(&tally->lock)) return DC_ERROR_INVALID_STATE;
+    const dc_poll_record_t* rec = (const dc_poll_record_t*)dc_snowflake_map_get(&tally->polls, message_id);
+    dc_status_t st = DC_ERROR_NOT_FOUND;
+    if (rec) {
+        memset(out, 0, sizeof(*out));
+        out->channel_id = rec->channel_id;
+        memcpy(out->votes, rec->counts, sizeof(out->votes));
+        out->total_votes = dc_poll_record_total(rec);
+        out->seeded = rec->seeded;
+        st = DC_OK;
+    }
+    dc_platform_mutex_unlock(&tally->lock);
+    return st;
+}
+
+/* Lock held. The voter set of an answer, checking the tracking mode. */
+static dc_status_t dc_poll_tally_voter_set(dc_poll_tally_t* tally, dc_snowflake_t message_id,
+                                           uint32_t answer_id, const dc_vec_t** out) {
+    const dc_poll_record_t* rec = (const dc_poll_record_t*)dc_snowflake_map_get(&tally->polls, message_id);
+    if (!rec) return DC_ERROR_NOT_FOUND;
+    /* Sets of a poll being seeded are still incomplete. */
+    if (!tally->track_voters || rec->seed_gen != 0) return DC_ERROR_INVALID_STATE;
+    *out = &rec->voters[answer_id - 1];
+    return DC_OK;
+}
+
+dc_status_t dc_poll_tally_has_voted(dc_poll_tally_t* tally, dc_snowflake_t message_id,
+                                    uint32_t answer_id, dc_snowflake_t user_id, int* out_voted) {
+    if (!tally || !out_voted) return DC_ERROR_NULL_POINTER;
+    if (answer_id == 0 || answer_id > DC_POLL_TALLY_MAX_ANSWERS) return DC_ERROR_INVALID_PARAM;
+    if (!dc_platform_mutex_lock(&tally->lock)) return DC_ERROR_INVALID_STATE;
+    const dc_vec_t* set = NULL;
+    dc_status_t st = dc_poll_tally_voter_set(tally, message_id, answer_id, &set);
+    if (st == DC_OK) {
+        size_t index = 0;
+        *out_voted = dc_poll_set_find(set, user_id, &index);
+    }
+    dc_platform_mutex_unlock(&tally->lock);
+    return st;
+}
+
+dc_status_t dc_poll_tally_get_voters(dc_poll_tally_t* tally, dc_snowflake_t message_id,
+                                     uint32_t answer_id, dc_vec_t* out) {
+    if (!tally || !out) return DC_ERROR_NULL_POINTER;
+    if (answer_id == 0 || answer_id > DC_POLL_TALLY_MAX_ANSWERS) return DC_ERROR_INVALID_PARAM;
+    if (out->element_size != sizeof(dc_snowflake_t)) return DC_ERROR_INVALID_PARAM;
+    if (!dc_platform_mutex_lock(&tally->lock)) return DC_ERROR_INVALID_STATE;
+    const dc_vec_t* set = NULL;
+    dc_status_t st = dc_poll_tally_voter_set(tally, message_id, answer_id, &set);
+    if (st == DC_OK) st = dc_vec_copy(out, set);
+    dc_platform_mutex_unlock(&tally->lock);
+    return st;
+}
+
+dc_status_t dc_poll_tally_get_stats(dc_poll_tally_t* tally, dc_poll_tally_stats_t* out) {
+    if (!tally || !out) return DC_ERROR_NULL_POINTER;
+    if (!dc_platform_mutex_lock(&tally->lock)) return DC_ERROR_INVALID_STATE;
+    *out = tally->stats;
+    out->polls = (uint32_t)dc_snowflake_map_length(&tally->polls);
+    dc_platform_mutex_unlock(&tally->lock);
+    return DC_OK;
+}
@@ -0,0 +1,201 @@
+#ifndef DC_POLL_TALLY_H
+#define DC_POLL_TALLY_H
+
+/**
+ * @file dc_poll_tally.h
+ * @brief Live poll vote tallies
+ *
+ * Reading poll results through GET /channels/{channel}/polls/{message}/answers/{answer}
+ * means paging every voter of every answer. The tally pages the voters once
+ * (dc_poll_tally_seed) and then keeps per-answer counts current from
+ * MESSAGE_POLL_VOTE_ADD/REMOVE dispatches, so results are read without a
+ * request. Polls the bot has just created start at zero with
+ * dc_poll_tally_track instead.
+ *
+ * Votes need the GUILD_MESSAGE_POLLS (or DIRECT_MESSAGE_POLLS) intent. Votes
+ * of polls that are not tracked are ignored.
+ *
+ * With track_voters, each answer also keeps its voters as a sorted snowflake
+ * array (8 bytes per vote), which makes repeated dispatches idempotent and
+ * answers "did this user vote for that answer". Without it only the counts
+ * are kept once seeding is done.
+ *
+ * Thread-safe: feeding, seeding and reads may come from different threads.
+ */
+
+#include <stdint.h>
+#include "core/dc_status.h"
+#include "core/dc_snowflake.h"
+#include "core/dc_vec.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Discord allows up to 10 answers per poll; answer IDs start at 1. */
+#define DC_POLL_TALLY_MAX_ANSWERS 10
+
+typedef struct dc_client dc_client_t;
+
+/**
+ * @brief Tally configuration
+ */
+typedef struct {
+    int track_voters;       /**< Keep per-answer voter sets */
+    uint32_t max_polls;     /**< Polls tracked at once */
+} dc_poll_tally_config_t;
+
+/**
+ * @brief Current results of one poll
+ */
+typedef struct {
+    dc_snowflake_t channel_id;                      /**< Channel of the poll message */
+    uint32_t votes[DC_POLL_TALLY_MAX_ANSWERS];      /**< Votes per answer; votes[answer_id - 1] */
+    uint32_t total_votes;                           /**< Sum of votes (multi-select voters count once per answer) */
+    int seeded;                                     /**< Counts include votes cast before tracking began */
+} dc_poll_tally_result_t;
+
+/**
+ * @brief Tally counters
+ */
+typedef struct {
+    uint64_t votes_added;   /**< Vote additions applied */
+    uint64_t votes_removed; /**< Vote removals applied */
+    uint64_t duplicates;    /**< Dispatches that changed nothing (needs track_voters) */
+    uint64_t ignored;       /**< Votes of untracked polls */
+    uint64_t seeds;         /**< Polls seeded */
+    uint64_t pages;         /**< Voter pages fetched while seeding */
+    uint32_t polls;         /**< Polls tracked */
+} dc_poll_tally_stats_t;
+
+/**
+ * @brief Poll tally (opaque)
+ */
+typedef struct dc_poll_tally dc_poll_tally_t;
+
+/**
+ * @brief Initialize a tally configuration with defaults
+ *
+ * Defaults:
+ * - track_voters: 0
+ * - max_polls: 1024
+ */
+void dc_poll_tally_config_init(dc_poll_tally_config_t* config);
+
+/**
+ * @brief Create a tally
+ * @param client Discord client used for seeding
+ * @param config Configuration
+ * @param out Pointer to store created tally
+ * @return DC_OK on success, error code on failure
+ */
+dc_status_t dc_poll_tally_create(dc_client_t* client, const dc_poll_tally_config_t* config,
+                                 dc_poll_tally_t** out);
+
+/**
+ * @brief Free the tally
+ * @param tally Tally to free (may be NULL)
+ */
+void dc_poll_tally_free(dc_poll_tally_t* tally);
+
+/**
+ * @brief Track a poll with no votes yet (e.g. one the bot just sent)
+ *
+ * Does nothing if the poll is already tracked.
+ *
+ * @param tally Tally
+ * @param channel_id Channel of the poll message
+ * @param message_id Poll message
+ * @return DC_OK on success, DC_ERROR_BUFFER_TOO_SMALL when max_polls are tracked
+ */
+dc_status_t dc_poll_tally_track(dc_poll_tally_t* tally, dc_snowflake_t channel_id,
+                                dc_snowflake_t message_id);
+
+/**
+ * @brief Track a poll and count the votes it already has
+ *
+ * Pages the voters of answers 1..answer_count (100 per request) without
+ * holding the tally lock; votes dispatched meanwhile are merged. Seeding an
+ * already tracked poll recounts it. If a request fails, the poll is no
+ * longer tracked.
+ *
+ * @param tally Tally
+ * @param channel_id Channel of the poll message
+ * @param message_id Poll message
+ * @param answer_count Number of answers (1..DC_POLL_TALLY_MAX_ANSWERS)
+ * @return DC_OK on success, error code on failure (DC_ERROR_CONFLICT if the
+ *         poll was untracked or seeded again meanwhile)
+ */
+dc_status_t dc_poll_tally_seed(dc_poll_tally_t* tally, dc_snowflake_t channel_id,
+                               dc_snowflake_t message_id, uint32_t answer_count);
+
+/**
+ * @brief Stop tracking a poll
+ * @param tally Tally
+ * @param message_id Poll message
+ * @return DC_OK on success, DC_ERROR_NOT_FOUND if it was not tracked
+ */
+dc_status_t dc_poll_tally_untrack(dc_poll_tally_t* tally, dc_snowflake_t message_id);
+
+/**
+ * @brief Apply a gateway dispatch
+ *
+ * Handles MESSAGE_POLL_VOTE_ADD/REMOVE; MESSAGE_DELETE and
+ * MESSAGE_DELETE_BULK untrack deleted polls. Other events are ignored.
+ *
+ * @param tally Tally
+ * @param event_name Dispatch event name
+ * @param event_data Dispatch JSON data
+ * @return DC_OK on success, error code on failure
+ */
+dc_status_t dc_poll_tally_feed_event(dc_poll_tally_t* tally, const char* event_name,
+                                     const char* event_data);
+
+/**
+ * @brief Get the current results of a poll
+ * @param tally Tally
+ * @param message_id Poll message
+ * @param out Receives the results
+ * @return DC_OK on success, DC_ERROR_NOT_FOUND if the poll is not tracked
+ */
+dc_status_t dc_poll_tally_get(dc_poll_tally_t* tally, dc_snowflake_t message_id,
+                              dc_poll_tally_result_t* out);
+
+/**
+ * @brief Check whether a user voted for an answer
+ * @param tally Tally
+ * @param message_id Poll message
+ * @param answer_id Answer (1-based)
+ * @param user_id User
+ * @param out_voted Receives 1 if the user voted for the answer, 0 otherwise
+ * @return DC_OK on success, DC_ERROR_NOT_FOUND if the poll is not tracked,
+ *         DC_ERROR_INVALID_STATE without track_voters
+ */
+dc_status_t dc_poll_tally_has_voted(dc_poll_tally_t* tally, dc_snowflake_t message_id,
+                                    uint32_t answer_id, dc_snowflake_t user_id, int* out_voted);
+
+/**
+ * @brief Copy the voters of an answer
+ * @param tally Tally
+ * @param message_id Poll message
+ * @param answer_id Answer (1-based)
+ * @param out Initialized vector of dc_snowflake_t; replaced with the voters in ID order
+ * @return DC_OK on success, DC_ERROR_NOT_FOUND if the poll is not tracked,
+ *         DC_ERROR_INVALID_STATE without track_voters
+ */
+dc_status_t dc_poll_tally_get_voters(dc_poll_tally_t* tally, dc_snowflake_t message_id,
+                                     uint32_t answer_id, dc_vec_t* out);
+
+/**
+ * @brief Get the tally counters
+ * @param tally Tally
+ * @param out Receives the counters
+ * @return DC_OK on success, error code on failure
+ */
+dc_status_t dc_poll_tally_get_stats(dc_poll_tally_t* tally, dc_poll_tally_stats_t* out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DC_POLL_TALLY_H */
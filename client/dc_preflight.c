@@ -0,0 +1,858 @@
+/**
+ * @file dc_preflight.c
+ * @brief Permission preflight for REST requests
+ */
+
+#include "dc_preflight.h"
+#include "core/dc_alloc.h"
+#include "core/dc_platform.h"
+#include "core/dc_snowflake_map.h"
+#include "core/dc_time.h"
+#include "json/dc_json.h"
+#include <string.h>
+#include <yyjson.h>
+
+#define DC_PREFLIGHT_MAX_SEGMENTS 8
+
+/* Rule flags */
+#define DC_PREFLIGHT_SEND           0x1u  /* threads need SEND_MESSAGES_IN_THREADS instead */
+#define DC_PREFLIGHT_NOT_THREAD     0x2u  /* thread owners may do this without the permission */
+#define DC_PREFLIGHT_THREAD_MANAGE  0x4u  /* threads need MANAGE_THREADS instead of MANAGE_CHANNELS */
+#define DC_PREFLIGHT_ROLE           0x8u  /* {r} must sit below the bot's highest role */
+
+typedef struct {
+    dc_snowflake_t owner_id;
+    dc_role_list_t roles;           /* only id, permissions and position are set */
+    int has_self_roles;
+    dc_vec_t self_roles;            /* dc_snowflake_t */
+    uint64_t self_timeout_until_ms; /* epoch ms, 0 = not timed out */
+} dc_preflight_guild_t;
+
+typedef struct {
+    dc_snowflake_t guild_id;
+    dc_snowflake_t parent_id;
+    dc_channel_type_t type;
+    dc_vec_t overwrites;            /* dc_permission_overwrite_t */
+} dc_preflight_channel_t;
+
+struct dc_preflight {
+    dc_platform_mutex_t lock;
+    dc_snowflake_t self_id;
+    dc_snowflake_map_t guilds;      /* guild_id -> dc_preflight_guild_t */
+    dc_snowflake_map_t channels;    /* channel_id -> dc_preflight_channel_t */
+    dc_preflight_stats_t stats;
+};
+
+typedef struct {
+    dc_http_method_t method;
+    const char* pattern;    /* {c} channel, {g} guild, {r} role, * any segment */
+    dc_permissions_t all;   /* every bit required */
+    dc_permissions_t any;   /* at least one bit required (0 = none) */
+    unsigned flags;
+} dc_preflight_rule_t;
+
+/*
+ * Only routes whose requirement does not depend on the body or on who wrote
+ * the message. Deleting or editing a message, for example, is allowed for
+ * its author without MANAGE_MESSAGES, so it is not listed.
+ */
+static const dc_preflight_rule_t dc_preflight_rules[] = {
+    { DC_HTTP_POST, "channels/{c}/messages",
+      DC_PERMISSION_VIEW_CHANNEL | DC_PERMISSION_SEND_MESSAGES, 0, DC_PREFLIGHT_SEND },
+    { DC_HTTP_POST, "channels/{c}/typing",
+      DC_PERMISSION_VIEW_CHANNEL | DC_PERMISSION_SEND_MESSAGES, 0, DC_PREFLIGHT_SEND },
+    { DC_HTTP_GET, "channels/{c}/messages",
+      DC_PERMISSION_VIEW_CHANNEL | DC_PERMISSION_READ_MESSAGE_HISTORY, 0, 0 },
+    { DC_HTTP_GET, "channels/{c}/messages/*",
+      DC_PERMISSION_VIEW_CHANNEL | DC_PERMISSION_READ_MESSAGE_HISTORY, 0, 0 },
+    { DC_HTTP_POST, "channels/{c}/messages/bulk-delete",
+      DC_PERMISSION_VIEW_CHANNEL | DC_PERMISSION_MANAGE_MESSAGES, 0, 0 },
+    { DC_HTTP_POST, "channels/{c}/messages/*/crosspost",
+      DC_PERMISSION_VIEW_CHANNEL, DC_PERMISSION_SEND_MESSAGES | DC_PERMISSION_MANAGE_MESSAGES, 0 },
+    { DC_HTTP_PUT, "channels/{c}/messages/*/reactions/*/@me",
+      DC_PERMISSION_VIEW_CHANNEL | DC_PERMISSION_READ_MESSAGE_HISTORY, 0, 0 },
+    { DC_HTTP_DELETE, "channels/{c}/messages/*/reactions/*/@me",
+      DC_PERMISSION_VIEW_CHANNEL, 0, 0 },
+    { DC_HTTP_DELETE, "channels/{c}/messages/*/reactions/*/*",
+      DC_PERMISSION_VIEW_CHANNEL | DC_PERMISSION_MANAGE_MESSAGES, 0, 0 },
+    { DC_HTTP_DELETE, "channels/{c}/messages/*/reactions/*",
+      DC_PERMISSION_VIEW_CHANNEL | DC_PERMISSION_MANAGE_MESSAGES, 0, 0 },
+    { DC_HTTP_DELETE, "channels/{c}/messages/*/reactions",
+      DC_PERMISSION_VIEW_CHANNEL | DC_PERMISSION_MANAGE_MESSAGES, 0, 0 },
+    { DC_HTTP_PUT, "channels/{c}/pins/*",
+      DC_PERMISSION_VIEW_CHANNEL, DC_PERMISSION_MANAGE_MESSAGES | DC_PERMISSION_PIN_MESSAGES, 0 },
+    { DC_HTTP_DELETE, "channels/{c}/pins/*",
+      DC_PERMISSION_VIEW_CHANNEL, DC_PERMISSION_MANAGE_MESSAGES | DC_PERMISSION_PIN_MESSAGES, 0 },
+    { DC_HTTP_PUT, "channels/{c}/messages/pins/*",
+      DC_PERMISSION_VIEW_CHANNEL, DC_PERMISSION_MANAGE_MESSAGES | DC_PERMISSION_PIN_MESSAGES, 0 },
+    { DC_HTTP_DELETE, "channels/{c}/messages/pins/*",
+      DC_PERMISSION_VIEW_CHANNEL, DC_PERMISSION_MANAGE_MESSAGES | DC_PERMISSION_PIN_MESSAGES, 0 },
+    { DC_HTTP_PUT, "channels/{c}/permissions/*",
+      DC_PERMISSION_VIEW_CHANNEL | DC_PERMISSION_MANAGE_ROLES, 0, 0 },
+    { DC_HTTP_DELETE, "channels/{c}/permissions/*",
+      DC_PERMISSION_VIEW_CHANNEL | DC_PERMISSION_MANAGE_ROLES, 0, 0 },
+    { DC_HTTP_GET, "channels/{c}/invites",
+      DC_PERMISSION_VIEW_CHANNEL | DC_PERMISSION_MANAGE_CHANNELS, 0, 0 },
+    { DC_HTTP_POST, "channels/{c}/invites",
+      DC_PERMISSION_VIEW_CHANNEL | DC_PERMISSION_CREATE_INSTANT_INVITE, 0, 0 },
+    { DC_HTTP_GET, "channels/{c}/webhooks",
+      DC_PERMISSION_VIEW_CHANNEL | DC_PERMISSION_MANAGE_WEBHOOKS, 0, 0 },
+    { DC_HTTP_POST, "channels/{c}/webhooks",
+      DC_PERMISSION_VIEW_CHANNEL | DC_PERMISSION_MANAGE_WEBHOOKS, 0, 0 },
+    { DC_HTTP_PATCH, "channels/{c}",
+      DC_PERMISSION_VIEW_CHANNEL | DC_PERMISSION_MANAGE_CHANNELS, 0, DC_PREFLIGHT_NOT_THREAD },
+    { DC_HTTP_DELETE, "channels/{c}",
+      DC_PERMISSION_VIEW_CHANNEL | DC_PERMISSION_MANAGE_CHANNELS, 0, DC_PREFLIGHT_THREAD_MANAGE },
+    { DC_HTTP_POST, "channels/{c}/messages/*/threads",
+      DC_PERMISSION_VIEW_CHANNEL | DC_PERMISSION_CREATE_PUBLIC_THREADS, 0, 0 },
+    { DC_HTTP_POST, "channels/{c}/threads",
+      DC_PERMISSION_VIEW_CHANNEL,
+      DC_PERMISSION_CREATE_PUBLIC_THREADS | DC_PERMISSION_CREATE_PRIVATE_THREADS |
+          DC_PERMISSION_SEND_MESSAGES, 0 },
+
+    { DC_HTTP_PATCH, "guilds/{g}", DC_PERMISSION_MANAGE_GUILD, 0, 0 },
+    { DC_HTTP_GET, "guilds/{g}/audit-logs", DC_PERMISSION_VIEW_AUDIT_LOG, 0, 0 },
+    { DC_HTTP_POST, "guilds/{g}/channels", DC_PERMISSION_MANAGE_CHANNELS, 0, 0 },
+    { DC_HTTP_PATCH, "guilds/{g}/channels", DC_PERMISSION_MANAGE_CHANNELS, 0, 0 },
+    { DC_HTTP_GET, "guilds/{g}/bans", DC_PERMISSION_BAN_MEMBERS, 0, 0 },
+    { DC_HTTP_GET, "guilds/{g}/bans/*", DC_PERMISSION_BAN_MEMBERS, 0, 0 },
+    { DC_HTTP_PUT, "guilds/{g}/bans/*", DC_PERMISSION_BAN_MEMBERS, 0, 0 },
+    { DC_HTTP_DELETE, "guilds/{g}/bans/*", DC_PERMISSION_BAN_MEMBERS, 0, 0 },
+    { DC_HTTP_POST, "guilds/{g}/bulk-ban", DC_PERMISSION_BAN_MEMBERS | DC_PERMISSION_MANAGE_GUILD, 0, 0 },
+    { DC_HTTP_DELETE, "guilds/{g}/members/*", DC_PERMISSION_KICK_MEMBERS, 0, 0 },
+    { DC_HTTP_GET, "guilds/{g}/prune", DC_PERMISSION_MANAGE_GUILD | DC_PERMISSION_KICK_MEMBERS, 0, 0 },
+    { DC_HTTP_POST, "guilds/{g}/prune", DC_PERMISSION_MANAGE_GUILD | DC_PERMISSION_KICK_MEMBERS, 0, 0 },
+    { DC_HTTP_POST, "guilds/{g}/roles", DC_PERMISSION_MANAGE_ROLES, 0, 0 },
+    { DC_HTTP_PATCH, "guilds/{g}/roles", DC_PERMISSION_MANAGE_ROLES, 0, 0 },
+    { DC_HTTP_PATCH, "guilds/{g}/roles/{r}", DC_PERMISSION_MANAGE_ROLES, 0, DC_PREFLIGHT_ROLE },
+    { DC_HTTP_DELETE, "guilds/{g}/roles/{r}", DC_PERMISSION_MANAGE_ROLES, 0, DC_PREFLIGHT_ROLE },
+    { DC_HTTP_PUT, "guilds/{g}/members/*/roles/{r}", DC_PERMISSION_MANAGE_ROLES, 0, DC_PREFLIGHT_ROLE },
+    { DC_HTTP_DELETE, "guilds/{g}/members/*/roles/{r}", DC_PERMISSION_MANAGE_ROLES, 0, DC_PREFLIGHT_ROLE },
+    { DC_HTTP_GET, "guilds/{g}/webhooks", DC_PERMISSION_MANAGE_WEBHOOKS, 0, 0 },
+    { DC_HTTP_GET, "guilds/{g}/integrations", DC_PERMISSION_MANAGE_GUILD, 0, 0 },
+    { DC_HTTP_PATCH, "guilds/{g}/widget", DC_PERMISSION_MANAGE_GUILD, 0, 0 },
+    { DC_HTTP_PATCH, "guilds/{g}/welcome-screen", DC_PERMISSION_MANAGE_GUILD, 0, 0 },
+};
+
+typedef struct {
+    const char* ptr;
+    size_t len;
+} dc_preflight_segment_t;
+
+typedef struct {
+    dc_snowflake_t channel_id;
+    dc_snowflake_t guild_id;
+    dc_snowflake_t role_id;
+} dc_preflight_ids_t;
+
+static int dc_preflight_is_thread(dc_channel_type_t type) {
+    return type == DC_CHANNEL_TYPE_ANNOUNCEMENT_THREAD ||
+           type == DC_CHANNEL_TYPE_PUBLIC_THREAD ||
+           type == DC_CHANNEL_TYPE_PRIVATE_THREAD;
+}
+
+/* ---- state ---- */
+
+static dc_status_t dc_preflight_guild_init(dc_preflight_guild_t* guild) {
+    memset(guild, 0, sizeof(*guild));
+    dc_status_t st = dc_role_list_init(&guild->roles);
+    if (st != DC_OK) return st;
+    st = dc_vec_init(&guild->self_roles, sizeof(dc_snowflake_t));
+    if (st != DC_OK) dc_role_list_free(&guild->roles);
+    return st;
+}
+
+static void dc_preflight_guild_free(dc_preflight_guild_t* guild) {
+    dc_role_list_free(&guild->roles);
+    dc_vec_free(&guild->self_roles);
+}
+
+static dc_status_t dc_preflight_guild_upsert(dc_preflight_t* p, dc_snowflake_t guild_id,
+                                             dc_preflight_guild_t** out) {
+    void* slot = NULL;
+    int inserted = 0;
+    dc_status_t st = dc_snowflake_map_upsert(&p->guilds, guild_id, &slot, &inserted);
+    if (st != DC_OK) return st;
+    if (inserted) {
+        st = dc_preflight_guild_init((dc_preflight_guild_t*)slot);
+        if (st != DC_OK) {
+            (void)dc_snowflake_map_remove(&p->guilds, guild_id, NULL);
+            return st;
+        }
+    }
+    *out = (dc_preflight_guild_t*)slot;
+    return DC_OK;
+}
+
+static dc_status_t dc_preflight_role_put(dc_preflight_guild_t* guild, dc_snowflake_t role_id,
+                                         dc_permissions_t permissions, int position) {
+    for (size_t i = 0; i < dc_vec_length(&guild->roles.items); i++) {
+        dc_role_t* role = (dc_role_t*)dc_vec_at(&guild->roles.items, i);
+        if (role->id == role_id) {
+            role->permissions = permissions;
+            role->position = position;
+            return DC_OK;
+        }
+    }
+    dc_role_t role;
+    dc_status_t st = dc_role_init(&role);
+    if (st != DC_OK) return st;
+    role.id = role_id;
+    role.permissions = permissions;
+    role.position = position;
+    st = dc_vec_push(&guild->roles.items, &role);
+    if (st != DC_OK) dc_role_free(&role);
+    return st;
+}
+
+static dc_status_t dc_preflight_role_drop(dc_preflight_guild_t* guild, dc_snowflake_t role_id) {
+    for (size_t i = 0; i < dc_vec_length(&guild->roles.items); i++) {
+        dc_role_t* role = (dc_role_t*)dc_vec_at(&guild->roles.items, i);
+        if (role->id == role_id) {
+            dc_role_free(role);
+            return dc_vec_swap_remove(&guild->roles.items, i, NULL);
+        }
+    }
+    return DC_ERROR_NOT_FOUND;
+}
+
+static void dc_preflight_roles_clear(dc_preflight_guild_t* guild) {
+    for (size_t i = 0; i < dc_vec_length(&guild->roles.items); i++) {
+        dc_role_free((dc_role_t*)dc_vec_at(&guild->roles.items, i));
+    }
+    (void)dc_vec_clear(&guild->roles.items);
+}
+
+static dc_status_t dc_preflight_channel_put(dc_preflight_t* p, dc_snowflake_t channel_id,
+                                            dc_snowflake_t guild_id, dc_snowflake_t parent_id,
+                                            dc_channel_type_t type, dc_preflight_channel_t** out) {
+    void* slot = NULL;
+    int inserted = 0;
+    dc_status_t st = dc_snowflake_map_upsert(&p->channels, channel_id, &slot, &inserted);
+    if (st != DC_OK) return st;
+    dc_preflight_channel_t* channel = (dc_preflight_channel_t*)slot;
+    if (inserted) {
+        st = dc_vec_init(&channel->overwrites, sizeof(dc_permission_overwrite_t));
+        if (st != DC_OK) {
+            (void)dc_snowflake_map_remove(&p->channels, channel_id, NULL);
+            return st;
+        }
+    } else {
+        (void)dc_vec_clear(&channel->overwrites);
+    }
+    channel->guild_id = guild_id;
+    channel->parent_id = parent_id;
+    channel->type = type;
+    *out = channel;
+    return DC_OK;
+}
+
+static dc_status_t dc_preflight_channel_drop(dc_preflight_t* p, dc_snowflake_t channel_id) {
+    dc_preflight_channel_t channel;
+    dc_status_t st = dc_snowflake_map_remove(&p->channels, channel_id, &channel);
+    if (st == DC_OK) dc_vec_free(&channel.overwrites);
+    return st;
+}
+
+static dc_status_t dc_preflight_guild_drop(dc_preflight_t* p, dc_snowflake_t guild_id) {
+    dc_preflight_guild_t guild;
+    dc_status_t st = dc_snowflake_map_remove(&p->guilds, guild_id, &guild);
+    if (st != DC_OK) return st;
+    dc_preflight_guild_free(&guild);
+
+    /* Collect first: the map must not change while iterating */
+    dc_vec_t doomed;
+    if (dc_vec_init(&doomed, sizeof(dc_snowflake_t)) != DC_OK) return DC_OK;
+    size_t cursor = 0;
+    dc_snowflake_t key = 0;
+    void* slot = NULL;
+    while (dc_snowflake_map_next(&p->channels, &cursor, &key, &slot)) {
+        if (((dc_preflight_channel_t*)slot)->guild_id == guild_id) (void)dc_vec_push(&doomed, &key);
+    }
+    for (size_t i = 0; i < dc_vec_length(&doomed); i++) {
+        (void)dc_preflight_channel_drop(p, *(dc_snowflake_t*)dc_vec_at(&doomed, i));
+    }
+    dc_vec_free(&doomed);
+    return DC_OK;
+}
+
+dc_status_t dc_preflight_create(dc_preflight_t** out) {
+    if (!out) return DC_ERROR_NULL_POINTER;
+    *out = NULL;
+
+    dc_preflight_t* p = (dc_preflight_t*)dc_alloc(sizeof(*p));
+    if (!p) return DC_ERROR_OUT_OF_MEMORY;
+    memset(p, 0, sizeof(*p));
+
+    if (!dc_platform_mutex_init(&p->lock)) {
+        dc_free(p);
+        return DC_ERROR_INVALID_STATE;
+    }
+    dc_status_t st = dc_snowflake_map_init(&p->guilds, sizeof(dc_preflight_guild_t));
+    if (st == DC_OK) {
+        st = dc_snowflake_map_init(&p->channels, sizeof(dc_preflight_channel_t));
+        if (st != DC_OK) dc_snowflake_map_free(&p->guilds);
+    }
+    if (st != DC_OK) {
+        dc_platform_mutex_destroy(&p->lock);
+        dc_free(p);
+        return st;
+    }
+
+    *out = p;
+    return DC_OK;
+}
+
+void dc_preflight_free(dc_preflight_t* preflight) {
+    if (!preflight) return;
+    size_t cursor = 0;
+    void* slot = NULL;
+    while (dc_snowflake_map_next(&preflight->guilds, &cursor, NULL, &slot)) {
+        dc_preflight_guild_free((dc_preflight_guild_t*)slot);
+    }
+    cursor = 0;
+    while (dc_snowflake_map_next(&preflight->channels, &cursor, NULL, &slot)) {
+        dc_vec_free(&((dc_preflight_channel_t*)slot)->overwrites);
+    }
+    dc_snowflake_map_free(&preflight->guilds);
+    dc_snowflake_map_free(&preflight->channels);
+    dc_platform_mutex_destroy(&preflight->lock);
+    dc_free(preflight);
+}
+
+dc_status_t dc_preflight_set_self(dc_preflight_t* preflight, dc_snowflake_t user_id) {
+    if (!preflight) return DC_ERROR_NULL_POINTER;
+    if (!dc_platform_mutex_lock(&preflight->lock)) return DC_ERROR_INVALID_STATE;
+    preflight->self_id = user_id;
+    dc_platform_mutex_unlock(&preflight->lock);
+    return DC_OK;
+}
+
+dc_status_t dc_preflight_set_guild(dc_preflight_t* preflight, const dc_guild_t* guild) {
+    if (!preflight || !guild) return DC_ERROR_NULL_POINTER;
+    if (!dc_snowflake_is_valid(guild->id)) return DC_ERROR_INVALID_PARAM;
+    if (!dc_platform_mutex_lock(&preflight->lock)) return DC_ERROR_INVALID_STATE;
+
+    dc_preflight_guild_t* g = NULL;
+    dc_status_t st = dc_preflight_guild_upsert(preflight, guild->id, &g);
+    if (st == DC_OK) {
+        if (guild->owner_id.is_set) g->owner_id = guild->owner_id.value;
+        if (guild->has_roles) {
+            dc_preflight_roles_clear(g);
+            for (size_t i = 0; st == DC_OK && i < dc_vec_length(&guild->roles.items); i++) {
+                const dc_role_t* role = (const dc_role_t*)dc_vec_at(&guild->roles.items, i);
+                st = dc_preflight_role_put(g, role->id, role->permissions, role->position);
+            }
+        }
+    }
+
+    dc_platform_mutex_unlock(&preflight->lock);
+    return st;
+}
+
+dc_status_t dc_preflight_remove_guild(dc_preflight_t* preflight, dc_snowflake_t guild_id) {
+    if (!preflight) return DC_ERROR_NULL_POINTER;
+    if (!dc_platform_mutex_lock(&preflight->lock)) return DC_ERROR_INVALID_STATE;
+    dc_status_t st = dc_preflight_guild_drop(preflight, guild_id);
+    dc_platform_mutex_unlock(&preflight->lock);
+    return st;
+}
+
+dc_status_t dc_preflight_set_role(dc_preflight_t* preflight, dc_snowflake_t guild_id,
+                                  const dc_role_t* role) {
+    if (!preflight || !role) return DC_ERROR_NULL_POINTER;
+    if (!dc_platform_mutex_lock(&preflight->lock)) return DC_ERROR_INVALID_STATE;
+    dc_preflight_guild_t* g = (dc_preflight_guild_t*)dc_snowflake_map_get(&preflight->guilds, guild_id);
+    dc_status_t st = g ? dc_preflight_role_put(g, role->id, role->permissions, role->position)
+                       : DC_ERROR_NOT_FOUND;
+    dc_platform_mutex_unlock(&preflight->lock);
+    return st;
+}
+
+dc_status_t dc_preflight_remove_role(dc_preflight_t* preflight, dc_snowflake_t guild_id,
+                                     dc_snowflake_t role_id) {
+    if (!preflight) return DC_ERROR_NULL_POINTER;
+    if (!dc_platform_mutex_lock(&preflight->lock)) return DC_ERROR_INVALID_STATE;
+    dc_preflight_guild_t* g = (dc_preflight_guild_t*)dc_snowflake_map_get(&preflight->guilds, guild_id);
+    dc_status_t st = g ? dc_preflight_role_drop(g, role_id) : DC_ERROR_NOT_FOUND;
+    dc_platform_mutex_unlock(&preflight->lock);
+    return st;
+}
+
+dc_status_t dc_preflight_set_self_roles(dc_preflight_t* preflight, dc_snowflake_t guild_id,
+                                        const dc_vec_t* role_ids) {
+    if (!preflight || !role_ids) return DC_ERROR_NULL_POINTER;
+    if (role_ids->element_size != sizeof(dc_snowflake_t)) return DC_ERROR_INVALID_PARAM;
+    if (!dc_platform_mutex_lock(&preflight->lock)) return DC_ERROR_INVALID_STATE;
+    dc_preflight_guild_t* g = (dc_preflight_guild_t*)dc_snowflake_map_get(&preflight->guilds, guild_id);
+    dc_status_t st = DC_ERROR_NOT_FOUND;
+    if (g) {
+        (void)dc_vec_clear(&g->self_roles);
+        st = dc_vec_append(&g->self_roles, dc_vec_data(role_ids), dc_vec_length(role_ids));
+        g->has_self_roles = (st == DC_OK);
+    }
+    dc_platform_mutex_unlock(&preflight->lock);
+    return st;
+}
+
+dc_status_t dc_preflight_set_channel(dc_preflight_t* preflight, const dc_channel_t* channel) {
+    if (!preflight || !channel) return DC_ERROR_NULL_POINTER;
+    if (!channel->guild_id.is_set || !dc_snowflake_is_valid(channel->id)) return DC_ERROR_INVALID_PARAM;
+    if (!dc_platform_mutex_lock(&preflight->lock)) return DC_ERROR_INVALID_STATE;
+
+    dc_preflight_channel_t* c = NULL;
+    dc_status_t st = dc_preflight_channel_put(preflight, channel->id, channel->guild_id.value,
+                                              channel->parent_id.is_set ? channel->parent_id.value : 0,
+                                              channel->type, &c);
+    if (st == DC_OK) {
+        st = dc_vec_append(&c->overwrites, dc_vec_data(&channel->permission_overwrites),
+                           dc_vec_length(&channel->permission_overwrites));
+    }
+
+    dc_platform_mutex_unlock(&preflight->lock);
+    return st;
+}
+
+dc_status_t dc_preflight_remove_channel(dc_preflight_t* preflight, dc_snowflake_t channel_id) {
+    if (!preflight) return DC_ERROR_NULL_POINTER;
+    if (!dc_platform_mutex_lock(&preflight->lock)) return DC_ERROR_INVALID_STATE;
+    dc_status_t st = dc_preflight_channel_drop(preflight, channel_id);
+    dc_platform_mutex_unlock(&preflight->lock);
+    return st;
+}
+
+/* ---- gateway feed ---- */
+
+static dc_status_t dc_preflight_load_role(dc_preflight_guild_t* guild, yyjson_val* role) {
+    dc_snowflake_t id = 0;
+    uint64_t permissions = 0;
+    int64_t position = 0;
+    dc_status_t st = dc_json_get_snowflake(role, "id", &id);
+    if (st == DC_OK) st = dc_json_get_permission(role, "permissions", &permissions);
+    if (st == DC_OK) st = dc_json_get_int64_opt(role, "position", &position, 0);
+    if (st != DC_OK) return st;
+    return dc_preflight_role_put(guild, id, permissions, (int)position);
+}
+
+static dc_status_t dc_preflight_load_roles(dc_preflight_guild_t* guild, yyjson_val* obj) {
+    yyjson_val* roles = NULL;
+    dc_status_t st = dc_json_get_array_opt(obj, "roles", &roles);
+    if (st != DC_OK || !roles) return st;
+    dc_preflight_roles_clear(guild);
+    size_t idx = 0, max = 0;
+    yyjson_val* role = NULL;
+    yyjson_arr_foreach(roles, idx, max, role) {
+        st = dc_preflight_load_role(guild, role);
+        if (st != DC_OK) return st;
+    }
+    return DC_OK;
+}
+
+static dc_status_t dc_preflight_load_channel(dc_preflight_t* p, yyjson_val* obj, dc_snowflake_t guild_id) {
+    dc_snowflake_t id = 0;
+    dc_snowflake_t parent_id = 0;
+    int64_t type = 0;
+    dc_status_t st = dc_json_get_snowflake(obj, "id", &id);
+    if (st == DC_OK) st = dc_json_get_int64(obj, "type", &type);
+    if (st == DC_OK) st = dc_json_get_snowflake_opt(obj, "guild_id", &guild_id, guild_id);
+    if (st == DC_OK) st = dc_json_get_snowflake_opt(obj, "parent_id", &parent_id, 0);
+    if (st != DC_OK) return st;
+    if (guild_id == 0) return DC_OK;  /* DMs have no permissions to check */
+
+    dc_preflight_channel_t* channel = NULL;
+    st = dc_preflight_channel_put(p, id, guild_id, parent_id, (dc_channel_type_t)type, &channel);
+    if (st != DC_OK) return st;
+
+    yyjson_val* overwrites = NULL;
+    st = dc_json_get_array_opt(obj, "permission_overwrites", &overwrites);
+    if (st != DC_OK || !overwrites) return st;
+    size_t idx = 0, max = 0;
+    yyjson_val* item = NULL;
+    yyjson_arr_foreach(overwrites, idx, max, item) {
+        dc_permission_overwrite_t ow;
+        int64_t ow_type = 0;
+        memset(&ow, 0, sizeof(ow));
+        st = dc_json_get_snowflake(item, "id", &ow.id);
+        if (st == DC_OK) st = dc_json_get_int64(item, "type", &ow_type);
+        if (st == DC_OK) st = dc_json_get_permission(item, "allow", &ow.allow);
+        if (st == DC_OK) st = dc_json_get_permission(item, "deny", &ow.deny);
+        if (st != DC_OK) return st;
+        ow.type = (dc_permission_overwrite_type_t)ow_type;
+        st = dc_vec_push(&channel->overwrites, &ow);
+        if (st != DC_OK) return st;
+    }
+    return DC_OK;
+}
+
+static dc_status_t dc_preflight_load_channels(dc_preflight_t* p, yyjson_val* obj, const char* key,
+                                              dc_snowflake_t guild_id) {
+    yyjson_val* channels = NULL;
+    dc_status_t st = dc_json_get_array_opt(obj, key, &channels);
+    if (st != DC_OK || !channels) return st;
+    size_t idx = 0, max = 0;
+    yyjson_val* channel = NULL;
+    yyjson_arr_foreach(channels, idx, max, channel) {
+        st = dc_preflight_load_channel(p, channel, guild_id);
+        if (st != DC_OK) return st;
+    }
+    return DC_OK;
+}
+
+/* Member object with a user: loads roles and timeout when it is the bot. */
+static dc_status_t dc_preflight_load_self_member(dc_preflight_t* p, dc_preflight_guild_t* guild,
+                                                 yyjson_val* member) {
+    yyjson_val* user = NULL;
+    dc_snowflake_t user_id = 0;
+    if (dc_json_get_object(member, "user", &user) != DC_OK) return DC_OK;
+    if (dc_json_get_snowflake(user, "id", &user_id) != DC_OK) return DC_OK;
+    if (p->self_id == 0 || user_id != p->self_id) return DC_OK;
+
+    yyjson_val* roles = NULL;
+    dc_status_t st = dc_json_get_array(member, "roles", &roles);
+    if (st != DC_OK) return st;
+    (void)dc_vec_clear(&guild->self_roles);
+    size_t idx = 0, max = 0;
+    yyjson_val* item = NULL;
+    yyjson_arr_foreach(roles, idx, max, item) {
+        dc_snowflake_t role_id = 0;
+        if (!yyjson_is_str(item)) return DC_ERROR_INVALID_FORMAT;
+        st = dc_snowflake_from_string(yyjson_get_str(item), &role_id);
+        if (st != DC_OK) return st;
+        st = dc_vec_push(&guild->self_roles, &role_id);
+        if (st != DC_OK) return st;
+    }
+    guild->has_self_roles = 1;
+
+    guild->self_timeout_until_ms = 0;
+    const char* until = NULL;
+    if (dc_json_get_string(member, "communication_disabled_until", &until) == DC_OK) {
+        int64_t until_ms = 0;
+        if (dc_iso8601_parse_unix_ms(until, strlen(until), &until_ms) == DC_OK && until_ms > 0) {
+            guild->self_timeout_until_ms = (uint64_t)until_ms;
+        }
+    }
+    return DC_OK;
+}
+
+static dc_status_t dc_preflight_feed_guild(dc_preflight_t* p, yyjson_val* root, int full) {
+    dc_snowflake_t guild_id = 0;
+    int unavailable = 0;
+    dc_status_t st = dc_json_get_snowflake(root, "id", &guild_id);
+    if (st != DC_OK) return st;
+    if (dc_json_get_bool_opt(root, "unavailable", &unavailable, 0) == DC_OK && unavailable) return DC_OK;
+
+    dc_preflight_guild_t* guild = NULL;
+    st = dc_preflight_guild_upsert(p, guild_id, &guild);
+    if (st != DC_OK) return st;
+    st = dc_json_get_snowflake_opt(root, "owner_id", &guild->owner_id, guild->owner_id);
+    if (st == DC_OK) st = dc_preflight_load_roles(guild, root);
+    if (st != DC_OK || !full) return st;
+
+    st = dc_preflight_load_channels(p, root, "channels", guild_id);
+    if (st == DC_OK) st = dc_preflight_load_channels(p, root, "threads", guild_id);
+    if (st != DC_OK) return st;
+
+    yyjson_val* members = NULL;
+    st = dc_json_get_array_opt(root, "members", &members);
+    if (st != DC_OK || !members) return st;
+    size_t idx = 0, max = 0;
+    yyjson_val* member = NULL;
+    yyjson_arr_foreach(members, idx, max, member) {
+        st = dc_preflight_load_self_member(p, guild, member);
+        if (st != DC_OK) return st;
+    }
+    return DC_OK;
+}
+
+static dc_status_t dc_preflight_feed_parsed(dc_preflight_t* p, const char* event_name, yyjson_val* root) {
+    dc_snowflake_t id = 0;
+    dc_snowflake_t guild_id = 0;
+    yyjson_val* obj = NULL;
+    dc_status_t st = DC_OK;
+
+    if (strcmp(event_name, "READY") == 0) {
+        st = dc_json_get_object(root, "user", &obj);
+        if (st == DC_OK) st = dc_json_get_snowflake(obj, "id", &p->self_id);
+        return st;
+    }
+    if (strcmp(event_name, "GUILD_CREATE") == 0) return dc_preflight_feed_guild(p, root, 1);
+    if (strcmp(event_name, "GUILD_UPDATE") == 0) return dc_preflight_feed_guild(p, root, 0);
+    if (strcmp(event_name, "GUILD_DELETE") == 0) {
+        st = dc_json_get_snowflake(root, "id", &id);
+        if (st == DC_OK) (void)dc_preflight_guild_drop(p, id);
+        return st;
+    }
+    if (strcmp(event_name, "GUILD_ROLE_CREATE") == 0 || strcmp(event_name, "GUILD_ROLE_UPDATE") == 0) {
+        st = dc_json_get_snowflake(root, "guild_id", &guild_id);
+        if (st == DC_OK) st = dc_json_get_object(root, "role", &obj);
+        if (st != DC_OK) return st;
+        dc_preflight_guild_t* guild = (dc_preflight_guild_t*)dc_snowflake_map_get(&p->guilds, guild_id);
+        return guild ? dc_preflight_load_role(guild, obj) : DC_OK;
+    }
+    if (strcmp(event_name, "GUILD_ROLE_DELETE") == 0) {
+        st = dc_json_get_snowflake(root, "guild_id", &guild_id);
+        if (st == DC_OK) st = dc_json_get_snowflake(root, "role_id", &id);
+        if (st != DC_OK) return st;
+        dc_preflight_guild_t* guild = (dc_preflight_guild_t*)dc_snowflake_map_get(&p->guilds, guild_id);
+        if (guild) (void)dc_preflight_role_drop(guild, id);
+        return DC_OK;
+    }
+    if (strcmp(event_name, "CHANNEL_CREATE") == 0 || strcmp(event_name, "CHANNEL_UPDATE") == 0 ||
+        strcmp(event_name, "THREAD_CREATE") == 0 || strcmp(event_name, "THREAD_UPDATE") == 0) {
+        return dc_preflight_load_channel(p, root, 0);
+    }
+    if (strcmp(event_name, "CHANNEL_DELETE") == 0 || strcmp(event_name, "THREAD_DELETE") == 0) {
+        st = dc_json_get_snowflake(root, "id", &id);
+        if (st == DC_OK) (void)dc_preflight_channel_drop(p, id);
+        return st;
+    }
+    if (strcmp(event_name, "GUILD_MEMBER_UPDATE") == 0) {
+        st = dc_json_get_snowflake(root, "guild_id", &guild_id);
+        if (st != DC_OK) return st;
+        dc_preflight_guild_t* guild = (dc_preflight_guild_t*)dc_snowflake_map_get(&p->guilds, guild_id);
+        return guild ? dc_preflight_load_self_member(p, guild, root) : DC_OK;
+    }
+    return DC_OK;
+}
+
+static int dc_preflight_event_relevant(const char* name) {
+    static const char* const names[] = {
+        "READY", "GUILD_CREATE", "GUILD_UPDATE", "GUILD_DELETE",
+        "GUILD_ROLE_CREATE", "GUILD_ROLE_UPDATE", "GUILD_ROLE_DELETE",
+        "CHANNEL_CREATE", "CHANNEL_UPDATE", "CHANNEL_DELETE",
+        "THREAD_CREATE", "THREAD_UPDATE", "THREAD_DELETE", "GUILD_MEMBER_UPDATE"
+    };
+    for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+        if (strcmp(name, names[i]) == 0) return 1;
+    }
+    return 0;
+}
+
+dc_status_t dc_preflight_feed_event(dc_preflight_t* preflight, const char* event_name,
+                                    const char* event_data) {
+    if (!preflight || !event_name || !event_data) return DC_ERROR_NULL_POINTER;
+    if (!dc_preflight_event_relevant(event_name)) return DC_OK;
+
+    dc_json_doc_t doc;
+    dc_status_t st = dc_json_parse(event_data, &doc);
+    if (st != DC_OK) return st;
+    if (!yyjson_is_obj(doc.root)) {
+        dc_json_doc_free(&doc);
+        return DC_ERROR_INVALID_FORMAT;
+    }
+
+    if (dc_platform_mutex_lock(&preflight->lock)) {
+        st = dc_preflight_feed_parsed(preflight, event_name, doc.root);
+        dc_platform_mutex_unlock(&preflight->lock);
+    } else {
+        st = DC_ERROR_INVALID_STATE;
+    }
+    dc_json_doc_free(&doc);
+    return st;
+}
+
+/* ---- checks ---- */
+
+/* Splits the path after any scheme, host and /api/vN prefix; stops at '?'. */
+static size_t dc_preflight_split(const char* path, dc_preflight_segment_t* segs) {
+    const char* scheme = strstr(path, "://");
+    if (scheme) {
+        path = strchr(scheme + 3, '/');
+        if (!path) return 0;
+    }
+    if (strncmp(path, "/api/", 5) == 0) {
+        path += 4;
+        if (path[1] == 'v' && path[2] >= '0' && path[2] <= '9') {
+            path += 2;
+            while (*path >= '0' && *path <= '9') path++;
+        }
+    }
+
+    size_t count = 0;
+    while (*path == '/') {
+        path++;
+        size_t len = strcspn(path, "/?#");
+        if (len == 0) break;
+        if (count == DC_PREFLIGHT_MAX_SEGMENTS) return DC_PREFLIGHT_MAX_SEGMENTS + 1;
+        segs[count].ptr = path;
+        segs[count].len = len;
+        count++;
+        path += len;
+    }
+    return count;
+}
+
+static int dc_preflight_segment_id(const dc_preflight_segment_t* seg, dc_snowflake_t* out) {
+    if (seg->len == 0 || seg->len > 20) return 0;
+    uint64_t value = 0;
+    for (size_t i = 0; i < seg->len; i++) {
+        char c = seg->ptr[i];
+        if (c < '0' || c > '9') return 0;
+        uint64_t digit = (uint64_t)(c - '0');
+        if (value > (UINT64_MAX - digit) / 10u) return 0;
+        value = value * 10u + digit;
+    }
+    if (value == 0) return 0;
+    *out = value;
+    return 1;
+}
+
+static int dc_preflight_match(const char* pattern, const dc_preflight_segment_t* segs, size_t count,
+                              dc_preflight_ids_t* ids) {
+    size_t i = 0;
+    while (*pattern) {
+        size_t len = strcspn(pattern, "/");
+        if (i >= count) return 0;
+        const dc_preflight_segment_t* seg = &segs[i];
+        if (len == 3 && pattern[0] == '{') {
+            dc_snowflake_t* slot = pattern[1] == 'c' ? &ids->channel_id
+                                 : pattern[1] == 'g' ? &ids->guild_id : &ids->role_id;
+            if (!dc_preflight_segment_id(seg, slot)) return 0;
+        } else if (!(len == 1 && pattern[0] == '*')) {
+            if (seg->len != len || memcmp(seg->ptr, pattern, len) != 0) return 0;
+        }
+        i++;
+        pattern += len;
+        if (*pattern == '/') pattern++;
+    }
+    return i == count;
+}
+
+typedef enum {
+    DC_PREFLIGHT_PASS = 0,
+    DC_PREFLIGHT_UNKNOWN,
+    DC_PREFLIGHT_REJECT
+} dc_preflight_verdict_t;
+
+static int dc_preflight_highest_position(const dc_preflight_guild_t* guild) {
+    int highest = 0;
+    for (size_t i = 0; i < dc_vec_length(&guild->self_roles); i++) {
+        dc_snowflake_t id = *(const dc_snowflake_t*)dc_vec_at(&guild->self_roles, i);
+        for (size_t j = 0; j < dc_vec_length(&guild->roles.items); j++) {
+            const dc_role_t* role = (const dc_role_t*)dc_vec_at(&guild->roles.items, j);
+            if (role->id == id && role->position > highest) highest = role->position;
+        }
+    }
+    return highest;
+}
+
+static dc_preflight_verdict_t dc_preflight_evaluate(dc_preflight_t* p, const dc_preflight_rule_t* rule,
+                                                    const dc_preflight_ids_t* ids,
+                                                    dc_permissions_t* out_missing) {
+    const dc_preflight_channel_t* channel = NULL;
+    const dc_preflight_channel_t* source = NULL;
+    dc_snowflake_t guild_id = ids->guild_id;
+    int thread = 0;
+
+    if (ids->channel_id) {
+        channel = (const dc_preflight_channel_t*)dc_snowflake_map_get(&p->channels, ids->channel_id);
+        if (!channel) return DC_PREFLIGHT_UNKNOWN;
+        thread = dc_preflight_is_thread(channel->type);
+        if (thread && (rule->flags & DC_PREFLIGHT_NOT_THREAD)) return DC_PREFLIGHT_PASS;
+        /* Threads take their permissions from the parent channel's overwrites */
+        source = thread ? (const dc_preflight_channel_t*)dc_snowflake_map_get(&p->channels, channel->parent_id)
+                        : channel;
+        if (!source) return DC_PREFLIGHT_UNKNOWN;
+        guild_id = channel->guild_id;
+    }
+
+    const dc_preflight_guild_t* guild = (const dc_preflight_guild_t*)dc_snowflake_map_get(&p->guilds, guild_id);
+    if (!guild || p->self_id == 0 || !guild->has_self_roles) return DC_PREFLIGHT_UNKNOWN;
+
+    dc_permissions_t perms = DC_PERMISSIONS_NONE;
+    if (dc_permissions_compute_base(guild_id, guild->owner_id, p->self_id, &guild->roles,
+                                    &guild->self_roles, &perms) != DC_OK) {
+        return DC_PREFLIGHT_UNKNOWN;
+    }
+    int privileged = (perms == DC_PERMISSIONS_ALL);
+    if (source) {
+        if (dc_permissions_compute_overwrites(perms, guild_id, p->self_id, &guild->self_roles,
+                                              &source->overwrites, &perms) != DC_OK) {
+            return DC_PREFLIGHT_UNKNOWN;
+        }
+        perms = dc_permissions_apply_implicit_text(perms);
+        if (thread) perms = dc_permissions_apply_thread_rules(perms, channel->type);
+    }
+    if (!privileged && guild->self_timeout_until_ms != 0) {
+        uint64_t now_ms = 0;
+        if (dc_platform_now_epoch_ms(&now_ms) && now_ms < guild->self_timeout_until_ms) {
+            perms = dc_permissions_apply_timed_out_mask(perms);
+        }
+    }
+
+    dc_permissions_t all = rule->all;
+    if (thread && (rule->flags & DC_PREFLIGHT_SEND)) {
+        all = (all & ~DC_PERMISSION_SEND_MESSAGES) | DC_PERMISSION_SEND_MESSAGES_IN_THREADS;
+    }
+    if (thread && (rule->flags & DC_PREFLIGHT_THREAD_MANAGE)) {
+        all = (all & ~DC_PERMISSION_MANAGE_CHANNELS) | DC_PERMISSION_MANAGE_THREADS;
+    }
+    dc_permissions_t missing = all & ~perms;
+    if (rule->any && (perms & rule->any) == 0) missing |= rule->any;
+    if (missing) {
+        *out_missing = missing;
+        return DC_PREFLIGHT_REJECT;
+    }
+
+    /* Even administrators cannot touch roles at or above their own highest */
+    if ((rule->flags & DC_PREFLIGHT_ROLE) && guild->owner_id != p->self_id) {
+        const dc_role_t* target = NULL;
+        for (size_t i = 0; i < dc_vec_length(&guild->roles.items); i++) {
+            const dc_role_t* role = (const dc_role_t*)dc_vec_at(&guild->roles.items, i);
+            if (role->id == ids->role_id) target = role;
+        }
+        if (!target) return DC_PREFLIGHT_UNKNOWN;
+        if (target->position >= dc_preflight_highest_position(guild)) {
+            *out_missing = DC_PERMISSIONS_NONE;
+            return DC_PREFLIGHT_REJECT;
+        }
+    }
+    return DC_PREFLIGHT_PASS;
+}
+
+dc_status_t dc_preflight_check(dc_preflight_t* preflight, dc_http_method_t method,
+                               const char* path, dc_permissions_t* out_missing) {
+    if (!preflight || !path) return DC_ERROR_NULL_POINTER;
+    if (out_missing) *out_missing = DC_PERMISSIONS_NONE;
+
+    dc_preflight_segment_t segs[DC_PREFLIGHT_MAX_SEGMENTS];
+    size_t count = dc_preflight_split(path, segs);
+    if (count == 0 || count > DC_PREFLIGHT_MAX_SEGMENTS) return DC_OK;
+
+    const dc_preflight_rule_t* rule = NULL;
+    dc_preflight_ids_t ids;
+    for (size_t i = 0; i < sizeof(dc_preflight_rules) / sizeof(dc_preflight_rules[0]); i++) {
+        memset(&ids, 0, sizeof(ids));
+        if (dc_preflight_rules[i].method == method &&
+            dc_preflight_match(dc_preflight_rules[i].pattern, segs, count, &ids)) {
+            rule = &dc_preflight_rules[i];
+            break;
+        }
+    }
+    if (!rule) return DC_OK;
+
+    /* A preflight that cannot lock lets the request through */
+    if (!dc_platform_mutex_lock(&preflight->lock)) return DC_OK;
+    dc_permissions_t missing = DC_PERMISSIONS_NONE;
+    dc_preflight_verdict_t verdict = dc_preflight_evaluate(preflight, rule, &ids, &missing);
+    preflight->stats.checked++;
+    if (verdict == DC_PREFLIGHT_UNKNOWN) preflight->stats.unknown++;
+    if (verdict == DC_PREFLIGHT_REJECT) preflight->stats.rejected++;
+    dc_platform_mutex_unlock(&preflight->lock);
+
+    if (verdict != DC_PREFLIGHT_REJECT) return DC_OK;
+    if (out_missing) *out_missing = missing;
+    return DC_ERROR_MISSING_PERMISSIONS;
+}
+
+dc_status_t dc_preflight_rest_hook(void* userdata, dc_http_method_t method, const char* path) {
+    return dc_preflight_check((dc_preflight_t*)userdata, method, path, NULL);
+}
+
+dc_status_t dc_preflight_get_stats(dc_preflight_t* preflight, dc_preflight_stats_t* out) {
+    if (!preflight || !out) return DC_ERROR_NULL_POINTER;
+    if (!dc_platform_mutex_lock(&preflight->lock)) return DC_ERROR_INVALID_STATE;
+    *out = preflight->stats;
+    dc_platform_mutex_unlock(&preflight->lock);
+    return DC_OK;
+}
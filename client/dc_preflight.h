@@ -0,0 +1,190 @@
+#ifndef DC_PREFLIGHT_H
+#define DC_PREFLIGHT_H
+
+/**
+ * @file dc_preflight.h
+ * @brief Permission preflight for REST requests
+ *
+ * Discord counts every 401/403/429 towards the invalid request limit, and
+ * crossing it bans the IP for a while. Many 403s can be predicted from state
+ * the bot already has: the guild's roles and owner, the bot's own roles and
+ * each channel's permission overwrites. The preflight keeps that state (fed
+ * from gateway dispatches or set directly) and, for routes with a known
+ * permission requirement, computes the bot's permissions with
+ * model/dc_permissions.h before the request is sent. A request that is sure
+ * to fail returns DC_ERROR_MISSING_PERMISSIONS instead.
+ *
+ * Only certain failures are rejected: routes whose requirement depends on
+ * the body or on message authorship are not checked, and a request is always
+ * sent when any piece of state it needs is unknown. Role edits and role
+ * grants also check that the role is below the bot's highest role.
+ *
+ * Thread-safe: state updates and checks may come from different threads.
+ */
+
+#include <stdint.h>
+#include "core/dc_status.h"
+#include "core/dc_snowflake.h"
+#include "core/dc_vec.h"
+#include "http/dc_http.h"
+#include "model/dc_channel.h"
+#include "model/dc_guild.h"
+#include "model/dc_role.h"
+#include "model/dc_permissions.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Preflight counters
+ */
+typedef struct {
+    uint64_t checked;       /**< Requests on a route with a known requirement */
+    uint64_t rejected;      /**< Rejected locally: invalid requests avoided */
+    uint64_t unknown;       /**< Sent unchecked because state was missing */
+} dc_preflight_stats_t;
+
+/**
+ * @brief Preflight state (opaque)
+ */
+typedef struct dc_preflight dc_preflight_t;
+
+/**
+ * @brief Create an empty preflight
+ * @param out Pointer to store created preflight
+ * @return DC_OK on success, error code on failure
+ */
+dc_status_t dc_preflight_create(dc_preflight_t** out);
+
+/**
+ * @brief Free a preflight
+ * @param preflight Preflight to free
+ */
+void dc_preflight_free(dc_preflight_t* preflight);
+
+/**
+ * @brief Set the bot's user ID (READY does this when fed)
+ * @param preflight Preflight
+ * @param user_id Bot user ID
+ * @return DC_OK on success, error code on failure
+ */
+dc_status_t dc_preflight_set_self(dc_preflight_t* preflight, dc_snowflake_t user_id);
+
+/**
+ * @brief Set a guild's owner and roles
+ *
+ * Roles are replaced when @p guild has them; the bot's roles and the
+ * guild's channels are kept.
+ *
+ * @param preflight Preflight
+ * @param guild Guild (id, owner_id and roles are used)
+ * @return DC_OK on success, error code on failure
+ */
+dc_status_t dc_preflight_set_guild(dc_preflight_t* preflight, const dc_guild_t* guild);
+
+/**
+ * @brief Forget a guild and its channels
+ * @param preflight Preflight
+ * @param guild_id Guild ID
+ * @return DC_OK on success, DC_ERROR_NOT_FOUND if unknown
+ */
+dc_status_t dc_preflight_remove_guild(dc_preflight_t* preflight, dc_snowflake_t guild_id);
+
+/**
+ * @brief Add or update one role of a known guild
+ * @param preflight Preflight
+ * @param guild_id Guild ID
+ * @param role Role (id, permissions and position are used)
+ * @return DC_OK on success, DC_ERROR_NOT_FOUND if the guild is unknown
+ */
+dc_status_t dc_preflight_set_role(dc_preflight_t* preflight, dc_snowflake_t guild_id,
+                                  const dc_role_t* role);
+
+/**
+ * @brief Remove one role of a known guild
+ * @param preflight Preflight
+ * @param guild_id Guild ID
+ * @param role_id Role ID
+ * @return DC_OK on success, DC_ERROR_NOT_FOUND if unknown
+ */
+dc_status_t dc_preflight_remove_role(dc_preflight_t* preflight, dc_snowflake_t guild_id,
+                                     dc_snowflake_t role_id);
+
+/**
+ * @brief Set the bot's roles in a known guild
+ * @param preflight Preflight
+ * @param guild_id Guild ID
+ * @param role_ids Role IDs (dc_snowflake_t), excluding @everyone
+ * @return DC_OK on success, DC_ERROR_NOT_FOUND if the guild is unknown
+ */
+dc_status_t dc_preflight_set_self_roles(dc_preflight_t* preflight, dc_snowflake_t guild_id,
+                                        const dc_vec_t* role_ids);
+
+/**
+ * @brief Add or update a guild channel or thread
+ * @param preflight Preflight
+ * @param channel Channel (id, type, guild_id, parent_id and overwrites are used)
+ * @return DC_OK on success, DC_ERROR_INVALID_PARAM for a channel without guild
+ */
+dc_status_t dc_preflight_set_channel(dc_preflight_t* preflight, const dc_channel_t* channel);
+
+/**
+ * @brief Forget a channel
+ * @param preflight Preflight
+ * @param channel_id Channel ID
+ * @return DC_OK on success, DC_ERROR_NOT_FOUND if unknown
+ */
+dc_status_t dc_preflight_remove_channel(dc_preflight_t* preflight, dc_snowflake_t channel_id);
+
+/**
+ * @brief Update state from a gateway dispatch
+ *
+ * Handles READY, GUILD_CREATE/UPDATE/DELETE, GUILD_ROLE_CREATE/UPDATE/DELETE,
+ * CHANNEL_CREATE/UPDATE/DELETE, THREAD_CREATE/UPDATE/DELETE and
+ * GUILD_MEMBER_UPDATE for the bot itself. Other events are ignored without
+ * being parsed.
+ *
+ * @param preflight Preflight
+ * @param event_name Dispatch event name
+ * @param event_data Dispatch event JSON data
+ * @return DC_OK on success, error code if a relevant event cannot be parsed
+ */
+dc_status_t dc_preflight_feed_event(dc_preflight_t* preflight, const char* event_name,
+                                    const char* event_data);
+
+/**
+ * @brief Check a request against known permissions
+ * @param preflight Preflight
+ * @param method HTTP method
+ * @param path Request path ("/channels/...") or full API URL
+ * @param out_missing Optional; receives the missing permissions on rejection
+ *        (0 when the role hierarchy is the reason)
+ * @return DC_OK to send, DC_ERROR_MISSING_PERMISSIONS if the request is
+ *         certain to fail
+ */
+dc_status_t dc_preflight_check(dc_preflight_t* preflight, dc_http_method_t method,
+                               const char* path, dc_permissions_t* out_missing);
+
+/**
+ * @brief dc_rest_preflight_fn adapter for dc_preflight_check()
+ * @param userdata dc_preflight_t*
+ * @param method HTTP method
+ * @param path Request path
+ * @return Result of dc_preflight_check()
+ */
+dc_status_t dc_preflight_rest_hook(void* userdata, dc_http_method_t method, const char* path);
+
+/**
+ * @brief Read counters
+ * @param preflight Preflight
+ * @param out Receives the counters
+ * @return DC_OK on success, error code on failure
+ */
+dc_status_t dc_preflight_get_stats(dc_preflight_t* preflight, dc_preflight_stats_t* out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DC_PREFLIGHT_H */
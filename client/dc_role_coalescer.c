@@ -0,0 +1,851 @@
+/**
+ * @file dc_role_coalescer.c
+ * @brief Coalesced member role mutations
+ */
+
+#include "dc_role_coalescer.h"
+#include "client/dc_client.h"
+#include "core/dc_alloc.h"
+#include "core/dc_platform.h"
+#include "core/dc_snowflake_map.h"
+#include "core/dc_string.h"
+#include "core/dc_vec.h"
+#include "json/dc_json.h"
+#include <stdatomic.h>
+#include <string.h>
+#include <yyjson.h>
+
+#define DC_COALESCER_DEFAULT_WINDOW_MS 250u
+#define DC_COALESCER_DEFAULT_TTL_MS 30000u
+#define DC_COALESCER_IDLE_TICK_MS 50u
+
+/* Above this many mutations, fetching an unknown member and patching it is cheaper. */
+#define DC_COALESCER_FETCH_MIN_OPS 3u
+
+typedef enum {
+    DC_COALESCER_LIST_NONE = 0,      /* in flight, or not settled yet */
+    DC_COALESCER_LIST_PENDING,       /* mutations queued (pending list) */
+    DC_COALESCER_LIST_IDLE           /* roles known, nothing queued (idle list) */
+} dc_coalescer_list_id_t;
+
+typedef struct {
+    dc_snowflake_t role_id;
+    int remove;
+} dc_coalescer_op_t;
+
+typedef struct dc_coalescer_member dc_coalescer_member_t;
+
+struct dc_coalescer_member {
+    dc_snowflake_t guild_id;
+    dc_snowflake_t user_id;
+    dc_vec_t roles;                 /* dc_snowflake_t, meaningful when has_roles */
+    int has_roles;
+    uint64_t roles_ms;              /* when roles were observed */
+    dc_vec_t ops;                   /* dc_coalescer_op_t, one per role */
+    uint64_t queued_ms;             /* first mutation of the next batch */
+    int in_flight;
+    dc_coalescer_list_id_t list;
+    dc_coalescer_member_t* same_user;    /* the user's record in another guild */
+    dc_coalescer_member_t* prev;
+    dc_coalescer_member_t* next;
+};
+
+typedef struct {
+    dc_coalescer_member_t* head;
+    dc_coalescer_member_t* tail;
+} dc_coalescer_list_t;
+
+/* A batch taken off a member while its requests are in flight. */
+typedef struct {
+    dc_snowflake_t guild_id;
+    dc_snowflake_t user_id;
+    dc_vec_t ops;
+    dc_vec_t roles;
+    int has_roles;
+    int refreshed;                  /* roles came from Discord */
+    uint64_t roles_ms;              /* member roles_ms when the batch was taken */
+} dc_coalescer_batch_t;
+
+struct dc_role_coalescer {
+    dc_client_t* client;
+    dc_role_coalescer_config_t config;
+    dc_platform_mutex_t lock;
+    dc_platform_cond_t settled;     /* broadcast when an in-flight batch finishes */
+    dc_snowflake_map_t users;       /* user_id -> dc_coalescer_member_t* (one per guild, chained) */
+    dc_coalescer_list_t pending;         /* window order */
+    dc_coalescer_list_t idle;            /* observation order */
+    uint32_t in_flight;
+    dc_role_coalescer_stats_t stats;
+    atomic_int stop;
+    dc_platform_thread_t thread;
+    int thread_started;
+};
+
+void dc_role_coalescer_config_init(dc_role_coalescer_config_t* config) {
+    if (!config) return;
+    memset(config, 0, sizeof(*config));
+    config->window_ms = DC_COALESCER_DEFAULT_WINDOW_MS;
+    config->roles_ttl_ms = DC_COALESCER_DEFAULT_TTL_MS;
+    config->fetch_unknown = 1;
+    config->use_thread = 1;
+}
+
+static uint64_t dc_coalescer_now_ms(void) {
+    uint64_t now = 0;
+    dc_platform_now_monotonic_ms(&now);
+    return now;
+}
+
+static dc_coalescer_list_t* dc_coalescer_list(dc_role_coalescer_t* co, dc_coalescer_list_id_t id) {
+    return (id == DC_COALESCER_LIST_PENDING) ? &co->pending : &co->idle;
+}
+
+static void dc_coalescer_list_unlink(dc_role_coalescer_t* co, dc_coalescer_member_t* m) {
+    if (m->list == DC_COALESCER_LIST_NONE) return;
+    dc_coalescer_list_t* list = dc_coalescer_list(co, m->list);
+    if (m->prev) m->prev->next = m->next; else list->head = m->next;
+    if (m->next) m->next->prev = m->prev; else list->tail = m->prev;
+    m->prev = NULL;
+    m->next = NULL;
+    m->list = DC_COALESCER_LIST_NONE;
+}
+
+static uint64_t dc_coalescer_list_key(const dc_coalescer_member_t* m, dc_coalescer_list_id_t id) {
+    return (id == DC_COALESCER_LIST_PENDING) ? m->queued_ms : m->roles_ms;
+}
+
+/* Keeps both lists sorted by their key; records mostly arrive in order, so this is an append. */
+static void dc_coalescer_list_insert(dc_role_coalescer_t* co, dc_coalescer_member_t* m, dc_coalescer_list_id_t id) {
+    dc_coalescer_list_t* list = dc_coalescer_list(co, id);
+    uint64_t key = dc_coalescer_list_key(m, id);
+    dc_coalescer_member_t* after = list->tail;
+    while (after && dc_coalescer_list_key(after, id) > key) after = after->prev;
+    m->prev = after;
+    m->next = after ? after->next : list->head;
+    if (m->next) m->next->prev = m; else list->tail = m;
+    if (after) after->next = m; else list->head = m;
+    m->list = id;
+}
+
+static dc_coalescer_member_t* dc_coalescer_find(dc_role_coalescer_t* co, dc_snowflake_t guild_id,
+                                      dc_snowflake_t user_id) {
+    dc_coalescer_member_t** slot = (dc_coalescer_member_t**)dc_snowflake_map_get(&co->users, user_id);
+    dc_coalescer_member_t* m = slot ? *slot : NULL;
+    while (m && m->guild_id != guild_id) m = m->same_user;
+    return m;
+}
+
+static dc_status_t dc_coalescer_find_or_create(dc_role_coalescer_t* co, dc_snowflake_t guild_id,
+                                          dc_snowflake_t user_id, dc_coalescer_member_t** out) {
+    dc_coalescer_member_t* m = dc_coalescer_find(co, guild_id, user_id);
+    if (m) {
+        *out = m;
+        return DC_OK;
+    }
+    m = (dc_coalescer_member_t*)dc_alloc(sizeof(*m));
+    if (!m) return DC_ERROR_OUT_OF_MEMORY;
+    memset(m, 0, sizeof(*m));
+    m->guild_id = guild_id;
+    m->user_id = user_id;
+    dc_status_t st = dc_vec_init(&m->roles, sizeof(dc_snowflake_t));
+    if (st == DC_OK) st = dc_vec_init(&m->ops, sizeof(dc_coalescer_op_t));
+    if (st != DC_OK) {
+        dc_vec_free(&m->roles);
+        dc_free(m);
+        return st;
+    }
+
+    dc_coalescer_member_t** slot = (dc_coalescer_member_t**)dc_snowflake_map_get(&co->users, user_id);
+    if (slot) {
+        m->same_user = *slot;
+        *slot = m;
+    } else {
+        st = dc_snowflake_map_put(&co->users, user_id, &m);
+        if (st != DC_OK) {
+            dc_vec_free(&m->ops);
+            dc_vec_free(&m->roles);
+            dc_free(m);
+            return st;
+        }
+    }
+    *out = m;
+    return DC_OK;
+}
+
+/* Lock held; the record must not be in flight. */
+static void dc_coalescer_destroy(dc_role_coalescer_t* co, dc_coalescer_member_t* m) {
+    dc_coalescer_list_unlink(co, m);
+    dc_coalescer_member_t** slot = (dc_coalescer_member_t**)dc_snowflake_map_get(&co->users, m->user_id);
+    if (slot) {
+        if (*slot == m) {
+            if (m->same_user) {
+                *slot = m->same_user;
+            } else {
+                (void)dc_snowflake_map_remove(&co->users, m->user_id, NULL);
+            }
+        } else {
+            dc_coalescer_member_t* prev = *slot;
+            while (prev->same_user && prev->same_user != m) prev = prev->same_user;
+            if (prev->same_user == m) prev->same_user = m->same_user;
+        }
+    }
+    dc_vec_free(&m->ops);
+    dc_vec_free(&m->roles);
+    dc_free(m);
+}
+
+/* Lock held: puts a record that is not in flight on the list matching its state. */
+static void dc_coalescer_settle(dc_role_coalescer_t* co, dc_coalescer_member_t* m) {
+    if (m->in_flight) return;
+    dc_coalescer_list_unlink(co, m);
+    if (!dc_vec_is_empty(&m->ops)) {
+        dc_coalescer_list_insert(co, m, DC_COALESCER_LIST_PENDING);
+    } else if (m->has_roles) {
+        dc_coalescer_list_insert(co, m, DC_COALESCER_LIST_IDLE);
+    } else {
+        dc_coalescer_destroy(co, m);
+    }
+}
+
+static int dc_coalescer_vec_contains(const dc_vec_t* roles, dc_snowflake_t role_id) {
+    const dc_snowflake_t* ids = (const dc_snowflake_t*)dc_vec_data(roles);
+    size_t count = dc_vec_length(roles);
+    for (size_t i = 0; i < count; i++) {
+        if (ids[i] == role_id) return 1;
+    }
+    return 0;
+}
+
+static void dc_coalescer_vec_drop(dc_vec_t* roles, dc_snowflake_t role_id) {
+    const dc_snowflake_t* ids = (const dc_snowflake_t*)dc_vec_data(roles);
+    for (size_t i = dc_vec_length(roles); i > 0; i--) {
+        if (ids[i - 1u] == role_id) (void)dc_vec_remove(roles, i - 1u, NULL);
+    }
+}
+
+static dc_status_t dc_coalescer_parse_roles(yyjson_val* member, dc_vec_t* out) {
+    yyjson_val* roles = NULL;
+    dc_status_t st = dc_json_get_array(member, "roles", &roles);
+    if (st != DC_OK) return st;
+    (void)dc_vec_clear(out);
+    size_t idx = 0, max = 0;
+    yyjson_val* item = NULL;
+    yyjson_arr_foreach(roles, idx, max, item) {
+        dc_snowflake_t role_id = 0;
+        if (!yyjson_is_str(item)) return DC_ERROR_INVALID_FORMAT;
+        st = dc_snowflake_from_string(yyjson_get_str(item), &role_id);
+        if (st == DC_OK) st = dc_vec_push(out, &role_id);
+        if (st != DC_OK) return st;
+    }
+    return DC_OK;
+}
+
+/* Lock held. */
+static dc_status_t dc_coalescer_store(dc_role_coalescer_t* co, dc_snowflake_t guild_id,
+                                 dc_snowflake_t user_id, const dc_snowflake_t* roles, size_t count,
+                                 uint64_t now_ms) {
+    dc_coalescer_member_t* m = NULL;
+    dc_status_t st = dc_coalescer_find_or_create(co, guild_id, user_id, &m);
+    if (st != DC_OK) return st;
+    (void)dc_vec_clear(&m->roles);
+    st = (count > 0) ? dc_vec_append(&m->roles, roles, count) : DC_OK;
+    m->has_roles = (st == DC_OK);
+    m->roles_ms = now_ms;
+    dc_coalescer_settle(co, m);
+    return st;
+}
+
+/* Lock held. Bumping roles_ms keeps a batch in flight from restoring the roles. */
+static void dc_coalescer_forget(dc_role_coalescer_t* co, dc_coalescer_member_t* m, uint64_t now_ms) {
+    m->has_roles = 0;
+    m->roles_ms = now_ms;
+    (void)dc_vec_clear(&m->roles);
+    dc_coalescer_settle(co, m);
+}
+
+static dc_status_t dc_coalescer_queue(dc_role_coalescer_t* co, dc_snowflake_t guild_id,
+                                 dc_snowflake_t user_id, dc_snowflake_t role_id, int remove,
+                                 uint64_t now_ms) {
+    if (!co) return DC_ERROR_NULL_POINTER;
+    if (!dc_snowflake_is_valid(guild_id) || !dc_snowflake_is_valid(user_id) ||
+        !dc_snowflake_is_valid(role_id)) {
+        return DC_ERROR_INVALID_PARAM;
+    }
+    if (!dc_platform_mutex_lock(&co->lock)) return DC_ERROR_INVALID_STATE;
+
+    dc_coalescer_member_t* m = NULL;
+    dc_status_t st = dc_coalescer_find_or_create(co, guild_id, user_id, &m);
+    if (st == DC_OK) {
+        dc_coalescer_op_t* ops = (dc_coalescer_op_t*)dc_vec_data(&m->ops);
+        size_t count = dc_vec_length(&m->ops);
+        size_t i = 0;
+        while (i < count && ops[i].role_id != role_id) i++;
+        if (i < count) {
+            ops[i].remove = remove;
+            co->stats.superseded++;
+        } else {
+            dc_coalescer_op_t op;
+            op.role_id = role_id;
+            op.remove = remove;
+            if (count == 0) m->queued_ms = now_ms;
+            st = dc_vec_push(&m->ops, &op);
+        }
+        if (st == DC_OK) co->stats.queued++;
+        if (m->list != DC_COALESCER_LIST_PENDING) dc_coalescer_settle(co, m);
+    }
+
+    dc_platform_mutex_unlock(&co->lock);
+    return st;
+}
+
+dc_status_t dc_role_coalescer_add(dc_role_coalescer_t* coalescer, dc_snowflake_t guild_id,
+                                  dc_snowflake_t user_id, dc_snowflake_t role_id, uint64_t now_ms) {
+    return dc_coalescer_queue(coalescer, guild_id, user_id, role_id, 0, now_ms);
+}
+
+dc_status_t dc_role_coalescer_remove(dc_role_coalescer_t* coalescer, dc_snowflake_t guild_id,
+                                     dc_snowflake_t user_id, dc_snowflake_t role_id, uint64_t now_ms) {
+    return dc_coalescer_queue(coalescer, guild_id, user_id, role_id, 1, now_ms);
+}
+
+dc_status_t dc_role_coalescer_set_member_roles(dc_role_coalescer_t* coalescer,
+                                               dc_snowflake_t guild_id, dc_snowflake_t user_id,
+                                               const dc_snowflake_t* roles, size_t count,
+                                               uint64_t now_ms) {
+    if (!coalescer || (!roles && count > 0)) return DC_ERROR_NULL_POINTER;
+    if (!dc_snowflake_is_valid(guild_id) || !dc_snowflake_is_valid(user_id)) {
+        return DC_ERROR_INVALID_PARAM;
+    }
+    if (!dc_platform_mutex_lock(&coalescer->lock)) return DC_ERROR_INVALID_STATE;
+    dc_status_t st = dc_coalescer_store(coalescer, guild_id, user_id, roles, count, now_ms);
+    dc_platform_mutex_unlock(&coalescer->lock);
+    return st;
+}
+
+/* ---- gateway feed ---- */
+
+/* Lock held. Member object with a user and roles; anything else is skipped. */
+static dc_status_t dc_coalescer_feed_member(dc_role_coalescer_t* co, dc_snowflake_t guild_id,
+                                       yyjson_val* member, dc_vec_t* scratch, uint64_t now_ms) {
+    yyjson_val* user = NULL;
+    dc_snowflake_t user_id = 0;
+    if (!yyjson_is_obj(member)) return DC_OK;
+    if (dc_json_get_object(member, "user", &user) != DC_OK) return DC_OK;
+    if (dc_json_get_snowflake(user, "id", &user_id) != DC_OK) return DC_OK;
+    dc_status_t st = dc_coalescer_parse_roles(member, scratch);
+    if (st != DC_OK) return (st == DC_ERROR_NOT_FOUND) ? DC_OK : st;
+    return dc_coalescer_store(co, guild_id, user_id, (const dc_snowflake_t*)dc_vec_data(scratch),
+                         dc_vec_length(scratch), now_ms);
+}
+
+static dc_status_t dc_coalescer_feed_members(dc_role_coalescer_t* co, dc_snowflake_t guild_id,
+                                        yyjson_val* root, dc_vec_t* scratch, uint64_t now_ms) {
+    yyjson_val* members = NULL;
+    dc_status_t st = dc_json_get_array_opt(root, "members", &members);
+    if (st != DC_OK || !members) return st;
+    size_t idx = 0, max = 0;
+    yyjson_val* member = NULL;
+    yyjson_arr_foreach(members, idx, max, member) {
+        st = dc_coalescer_feed_member(co, guild_id, member, scratch, now_ms);
+        if (st != DC_OK) return st;
+    }
+    return DC_OK;
+}
+
+/* Lock held. role_id 0 forgets every member of the guild, otherwise drops that role. */
+static void dc_coalescer_feed_guild_wide(dc_role_coalescer_t* co, dc_snowflake_t guild_id,
+                                    dc_snowflake_t role_id, uint64_t now_ms) {
+    size_t cursor = 0;
+    void* slot = NULL;
+    while (dc_snowflake_map_next(&co->users, &cursor, NULL, &slot)) {
+        for (dc_coalescer_member_t* m = *(dc_coalescer_member_t**)slot; m; m = m->same_user) {
+            if (m->guild_id != guild_id) continue;
+            if (role_id != 0) {
+                dc_coalescer_vec_drop(&m->roles, role_id);
+            } else {
+                m->has_roles = 0;
+                m->roles_ms = now_ms;
+                (void)dc_vec_clear(&m->roles);
+            }
+        }
+    }
+    /* Destroying edits the map, so idle records left without roles go afterwards. */
+    dc_coalescer_member_t* m = co->idle.head;
+    while (m) {
+        dc_coalescer_member_t* next = m->next;
+        if (!m->has_roles) dc_coalescer_destroy(co, m);
+        m = next;
+    }
+}
+
+static dc_status_t dc_coalescer_feed_parsed(dc_role_coalescer_t* co, const char* event_name,
+                                       yyjson_val* root, dc_vec_t* scratch, uint64_t now_ms) {
+    dc_snowflake_t guild_id = 0;
+    dc_snowflake_t id = 0;
+    yyjson_val* obj = NULL;
+    dc_status_t st = DC_OK;
+
+    if (strcmp(event_name, "GUILD_CREATE") == 0) {
+        st = dc_json_get_snowflake(root, "id", &guild_id);
+        return (st == DC_OK) ? dc_coalescer_feed_members(co, guild_id, root, scratch, now_ms) : st;
+    }
+    if (strcmp(event_name, "GUILD_MEMBERS_CHUNK") == 0) {
+        st = dc_json_get_snowflake(root, "guild_id", &guild_id);
+        return (st == DC_OK) ? dc_coalescer_feed_members(co, guild_id, root, scratch, now_ms) : st;
+    }
+    if (strcmp(event_name, "GUILD_MEMBER_ADD") == 0 || strcmp(event_name, "GUILD_MEMBER_UPDATE") == 0) {
+        st = dc_json_get_snowflake(root, "guild_id", &guild_id);
+        return (st == DC_OK) ? dc_coalescer_feed_member(co, guild_id, root, scratch, now_ms) : st;
+    }
+    if (strcmp(event_name, "MESSAGE_REACTION_ADD") == 0 || strcmp(event_name, "INTERACTION_CREATE") == 0) {
+        /* Only guild events carry a member. */
+        if (dc_json_get_snowflake(root, "guild_id", &guild_id) != DC_OK) return DC_OK;
+        if (dc_json_get_object(root, "member", &obj) != DC_OK) return DC_OK;
+        return dc_coalescer_feed_member(co, guild_id, obj, scratch, now_ms);
+    }
+    if (strcmp(event_name, "GUILD_MEMBER_REMOVE") == 0) {
+        st = dc_json_get_snowflake(root, "guild_id", &guild_id);
+        if (st == DC_OK) st = dc_json_get_object(root, "user", &obj);
+        if (st == DC_OK) st = dc_json_get_snowflake(obj, "id", &id);
+        if (st != DC_OK) return st;
+        dc_coalescer_member_t* m = dc_coalescer_find(co, guild_id, id);
+        if (m) dc_coalescer_forget(co, m, now_ms);
+        return DC_OK;
+    }
+    if (strcmp(event_name, "GUILD_DELETE") == 0) {
+        st = dc_json_get_snowflake(root, "id", &guild_id);
+        if (st == DC_OK) dc_coalescer_feed_guild_wide(co, guild_id, 0, now_ms);
+        return st;
+    }
+    if (strcmp(event_name, "GUILD_ROLE_DELETE") == 0) {
+        st = dc_json_get_snowflake(root, "guild_id", &guild_id);
+        if (st == DC_OK) st = dc_json_get_snowflake(root, "role_id", &id);
+        if (st == DC_OK) dc_coalescer_feed_guild_wide(co, guild_id, id, now_ms);
+        return st;
+    }
+    return DC_OK;
+}
+
+static int dc_coalescer_event_relevant(const char* name) {
+    static const char* const names[] = {
+        "GUILD_CREATE", "GUILD_DELETE", "GUILD_ROLE_DELETE", "GUILD_MEMBERS_CHUNK",
+        "GUILD_MEMBER_ADD", "GUILD_MEMBER_UPDATE", "GUILD_MEMBER_REMOVE",
+        "MESSAGE_REACTION_ADD", "INTERACTION_CREATE"
+    };
+    for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+        if (strcmp(name, names[i]) == 0) return 1;
+    }
+    return 0;
+}
+
+dc_status_t dc_role_coalescer_feed_event(dc_role_coalescer_t* coalescer, const char* event_name,
+                                         const char* event_data, uint64_t now_ms) {
+    if (!coalescer || !event_name || !event_data) return DC_ERROR_NULL_POINTER;
+    if (!dc_coalescer_event_relevant(event_name)) return DC_OK;
+
+    dc_json_doc_t doc;
+    dc_status_t st = dc_json_parse(event_data, &doc);
+    if (st != DC_OK) return st;
+    if (!yyjson_is_obj(doc.root)) {
+        dc_json_doc_free(&doc);
+        return DC_ERROR_INVALID_FORMAT;
+    }
+    dc_vec_t scratch;
+    st = dc_vec_init(&scratch, sizeof(dc_snowflake_t));
+    if (st != DC_OK) {
+        dc_json_doc_free(&doc);
+        return st;
+    }
+
+    if (dc_platform_mutex_lock(&coalescer->lock)) {
+        st = dc_coalescer_feed_parsed(coalescer, event_name, doc.root, &scratch, now_ms);
+        dc_platform_mutex_unlock(&coalescer->lock);
+    } else {
+        st = DC_ERROR_INVALID_STATE;
+    }
+    dc_vec_free(&scratch);
+    dc_json_doc_free(&doc);
+    return st;
+}
+
+/* ---- flushing ---- */
+
+static dc_status_t dc_coalescer_fetch(dc_role_coalescer_t* co, dc_coalescer_batch_t* b) {
+    dc_string_t member_json;
+    dc_status_t st = dc_string_init(&member_json);
+    if (st != DC_OK) return st;
+    st = dc_client_get_guild_member_json(co->client, b->guild_id, b->user_id, &member_json);
+    if (st == DC_OK) {
+        dc_json_doc_t doc;
+        st = dc_json_parse(dc_string_cstr(&member_json), &doc);
+        if (st == DC_OK) {
+            st = dc_coalescer_parse_roles(doc.root, &b->roles);
+            dc_json_doc_free(&doc);
+        }
+    }
+    dc_string_free(&member_json);
+    if (st == DC_OK) {
+        b->has_roles = 1;
+        b->refreshed = 1;
+    }
+    return st;
+}
+
+/* One add/remove call per mutation; the first error wins. */
+static dc_status_t dc_coalescer_apply_each(dc_role_coalescer_t* co, dc_coalescer_batch_t* b,
+                                      dc_role_coalescer_stats_t* d) {
+    const dc_coalescer_op_t* ops = (const dc_coalescer_op_t*)dc_vec_data(&b->ops);
+    size_t count = dc_vec_length(&b->ops);
+    dc_status_t result = DC_OK;
+    for (size_t i = 0; i < count; i++) {
+        dc_status_t st = ops[i].remove
+            ? dc_client_remove_guild_member_role(co->client, b->guild_id, b->user_id, ops[i].role_id)
+            : dc_client_add_guild_member_role(co->client, b->guild_id, b->user_id, ops[i].role_id);
+        d->requests++;
+        d->individual++;
+        if (st != DC_OK) {
+            /* A timed out call may still have landed: the roles are no longer known. */
+            if (result == DC_OK) result = st;
+            b->has_roles = 0;
+            continue;
+        }
+        if (!b->has_roles) continue;
+        if (ops[i].remove) {
+            dc_coalescer_vec_drop(&b->roles, ops[i].role_id);
+        } else if (!dc_coalescer_vec_contains(&b->roles, ops[i].role_id)) {
+            st = dc_vec_push(&b->roles, &ops[i].role_id);
+            if (st != DC_OK) b->has_roles = 0;
+        }
+    }
+    b->refreshed = 0;
+    return result;
+}
+
+static dc_status_t dc_coalescer_apply_patch(dc_role_coalescer_t* co, dc_coalescer_batch_t* b,
+                                       const dc_vec_t* final_roles, dc_role_coalescer_stats_t* d) {
+    dc_string_t body;
+    dc_string_t member_json;
+    dc_status_t st = dc_string_init(&body);
+    if (st != DC_OK) return st;
+    st = dc_string_init(&member_json);
+    if (st != DC_OK) {
+        dc_string_free(&body);
+        return st;
+    }
+
+    const dc_snowflake_t* ids = (const dc_snowflake_t*)dc_vec_data(final_roles);
+    size_t count = dc_vec_length(final_roles);
+    st = dc_string_append_cstr(&body, "{\"roles\":[");
+    for (size_t i = 0; st == DC_OK && i < count; i++) {
+        st = dc_string_append_printf(&body, "%s\"%llu\"", (i > 0) ? "," : "",
+                                     (unsigned long long)ids[i]);
+    }
+    if (st == DC_OK) st = dc_string_append_cstr(&body, "]}");
+    if (st == DC_OK) {
+        st = dc_client_modify_guild_member_json(co->client, b->guild_id, b->user_id,
+                                                dc_string_cstr(&body), &member_json);
+        d->requests++;
+        d->patches++;
+    }
+
+    b->refreshed = 0;
+    if (st == DC_OK) {
+        /* Prefer what Discord reports; fall back to the set that was sent. */
+        dc_json_doc_t doc;
+        if (dc_json_parse(dc_string_cstr(&member_json), &doc) == DC_OK) {
+            b->refreshed = (dc_coalescer_parse_roles(doc.root, &b->roles) == DC_OK);
+            dc_json_doc_free(&doc);
+        }
+        if (!b->refreshed && dc_vec_copy(&b->roles, final_roles) != DC_OK) b->has_roles = 0;
+    } else {
+        b->has_roles = 0;
+    }
+
+    dc_string_free(&member_json);
+    dc_string_free(&body);
+    return st;
+}
+
+static dc_status_t dc_coalescer_apply(dc_role_coalescer_t* co, dc_coalescer_batch_t* b,
+                                 dc_role_coalescer_stats_t* d) {
+    if (!b->has_roles && co->config.fetch_unknown &&
+        dc_vec_length(&b->ops) >= DC_COALESCER_FETCH_MIN_OPS) {
+        dc_status_t st = dc_coalescer_fetch(co, b);
+        d->requests++;
+        d->fetches++;
+        if (st != DC_OK) return st;
+    }
+    if (!b->has_roles) return dc_coalescer_apply_each(co, b, d);
+
+    /* Drop mutations the member already satisfies and build the final set. */
+    dc_vec_t final_roles;
+    dc_status_t st = dc_vec_init(&final_roles, sizeof(dc_snowflake_t));
+    if (st == DC_OK) st = dc_vec_copy(&final_roles, &b->roles);
+    if (st != DC_OK) return st;
+    dc_coalescer_op_t* ops = (dc_coalescer_op_t*)dc_vec_data(&b->ops);
+    size_t count = dc_vec_length(&b->ops);
+    size_t kept = 0;
+    for (size_t i = 0; i < count; i++) {
+        int present = dc_coalescer_vec_contains(&b->roles, ops[i].role_id);
+        if (present != ops[i].remove) continue;
+        ops[kept++] = ops[i];
+        if (ops[i].remove) {
+            dc_coalescer_vec_drop(&final_roles, ops[i].role_id);
+        } else if (st == DC_OK) {
+            st = dc_vec_push(&final_roles, &ops[i].role_id);
+        }
+    }
+    if (st == DC_OK) st = dc_vec_resize(&b->ops, kept);
+
+    if (st != DC_OK) {
+        /* Cannot build the set: fall back to individual calls. */
+        b->has_roles = 0;
+        st = dc_coalescer_apply_each(co, b, d);
+    } else if (kept == 0) {
+        d->unchanged++;
+    } else if (kept == 1) {
+        st = dc_coalescer_apply_each(co, b, d);
+    } else {
+        st = dc_coalescer_apply_patch(co, b, &final_roles, d);
+    }
+    dc_vec_free(&final_roles);
+    return st;
+}
+
+/* Lock held: takes the member's queued mutations off it. */
+static dc_status_t dc_coalescer_take(dc_role_coalescer_t* co, dc_coalescer_member_t* m, uint64_t now_ms,
+                                dc_coalescer_batch_t* b) {
+    memset(b, 0, sizeof(*b));
+    b->guild_id = m->guild_id;
+    b->user_id = m->user_id;
+    b->roles_ms = m->roles_ms;
+    dc_status_t st = dc_vec_init(&b->ops, sizeof(dc_coalescer_op_t));
+    if (st != DC_OK) return st;
+    if (m->has_roles && now_ms < m->roles_ms + co->config.roles_ttl_ms) {
+        st = dc_vec_copy(&b->roles, &m->roles);
+        b->has_roles = (st == DC_OK);
+    }
+    if (!b->has_roles) st = dc_vec_init(&b->roles, sizeof(dc_snowflake_t));
+    if (st != DC_OK) {
+        dc_vec_free(&b->ops);
+        return st;
+    }
+    dc_vec_swap(&b->ops, &m->ops);
+    dc_coalescer_list_unlink(co, m);
+    m->in_flight = 1;
+    co->in_flight++;
+    return DC_OK;
+}
+
+/* Lock held: hands the batch result back to the member. */
+static void dc_coalescer_finish(dc_role_coalescer_t* co, dc_coalescer_batch_t* b, dc_status_t status,
+                           const dc_role_coalescer_stats_t* d, uint64_t now_ms) {
+    dc_coalescer_member_t* m = dc_coalescer_find(co, b->guild_id, b->user_id);
+    if (m) {
+        m->in_flight = 0;
+        co->in_flight--;
+        /* Roles observed while the batch was in flight are newer unless Discord just reported them. */
+        if (b->refreshed || m->roles_ms == b->roles_ms) {
+            if (b->has_roles) {
+                dc_vec_swap(&m->roles, &b->roles);
+                m->has_roles = 1;
+                if (b->refreshed) m->roles_ms = now_ms;
+            } else {
+                m->has_roles = 0;
+                (void)dc_vec_clear(&m->roles);
+            }
+        }
+        dc_coalescer_settle(co, m);
+    }
+    dc_platform_cond_broadcast(&co->settled);
+
+    dc_role_coalescer_stats_t* s = &co->stats;
+    s->batches++;
+    s->requests += d->requests;
+    s->patches += d->patches;
+    s->fetches += d->fetches;
+    s->individual += d->individual;
+    s->unchanged += d->unchanged;
+    if (status != DC_OK) s->failures++;
+}
+
+static void dc_coalescer_batch_free(dc_coalescer_batch_t* b) {
+    dc_vec_free(&b->ops);
+    dc_vec_free(&b->roles);
+}
+
+/* Applies a batch taken with dc_coalescer_take; called and returns without the lock. */
+static void dc_coalescer_run(dc_role_coalescer_t* co, dc_coalescer_batch_t* b, uint64_t now_ms) {
+    dc_role_coalescer_stats_t d;
+    memset(&d, 0, sizeof(d));
+    dc_status_t st = dc_coalescer_apply(co, b, &d);
+    if (dc_platform_mutex_lock(&co->lock)) {
+        dc_coalescer_finish(co, b, st, &d, now_ms);
+        dc_platform_mutex_unlock(&co->lock);
+    }
+    if (co->config.on_result) co->config.on_result(co->config.user_data, b->guild_id, b->user_id, st);
+    dc_coalescer_batch_free(b);
+}
+
+uint32_t dc_role_coalescer_poll(dc_role_coalescer_t* coalescer, uint64_t now_ms) {
+    if (!coalescer) return 0;
+    uint32_t flushed = 0;
+    for (;;) {
+        if (!dc_platform_mutex_lock(&coalescer->lock)) break;
+        if (flushed == 0) {
+            uint64_t ttl = coalescer->config.roles_ttl_ms;
+            while (coalescer->idle.head && coalescer->idle.head->roles_ms + ttl <= now_ms) {
+                dc_coalescer_destroy(coalescer, coalescer->idle.head);
+            }
+        }
+        dc_coalescer_member_t* m = coalescer->pending.head;
+        if (!m || m->queued_ms + coalescer->config.window_ms > now_ms) {
+            dc_platform_mutex_unlock(&coalescer->lock);
+            break;
+        }
+        dc_coalescer_batch_t batch;
+        dc_status_t st = dc_coalescer_take(coalescer, m, now_ms, &batch);
+        dc_platform_mutex_unlock(&coalescer->lock);
+        if (st != DC_OK) break;
+        dc_coalescer_run(coalescer, &batch, now_ms);
+        flushed++;
+    }
+    return flushed;
+}
+
+uint32_t dc_role_coalescer_flush(dc_role_coalescer_t* coalescer) {
+    if (!coalescer) return 0;
+    uint32_t flushed = 0;
+    for (;;) {
+        if (!dc_platform_mutex_lock(&coalescer->lock)) break;
+        /* Batches in flight on other threads may requeue their member. */
+        while (!coalescer->pending.head && coalescer->in_flight > 0) {
+            if (!dc_platform_cond_wait(&coalescer->settled, &coalescer->lock)) break;
+        }
+        dc_coalescer_member_t* m = coalescer->pending.head;
+        if (!m) {
+            dc_platform_mutex_unlock(&coalescer->lock);
+            break;
+        }
+        uint64_t now_ms = dc_coalescer_now_ms();
+        dc_coalescer_batch_t batch;
+        dc_status_t st = dc_coalescer_take(coalescer, m, now_ms, &batch);
+        dc_platform_mutex_unlock(&coalescer->lock);
+        if (st != DC_OK) break;
+        dc_coalescer_run(coalescer, &batch, now_ms);
+        flushed++;
+    }
+    return flushed;
+}
+
+int dc_role_coalescer_next_deadline(dc_role_coalescer_t* coalescer, uint64_t* out_ms) {
+    if (!coalescer || !out_ms) return 0;
+    int found = 0;
+    if (dc_platform_mutex_lock(&coalescer->lock)) {
+        if (coalescer->pending.head) {
+            *out_ms = coalescer->pending.head->queued_ms + coalescer->config.window_ms;
+            found = 1;
+        }
+        dc_platform_mutex_unlock(&coalescer->lock);
+    }
+    return found;
+}
+
+dc_status_t dc_role_coalescer_get_stats(dc_role_coalescer_t* coalescer,
+                                        dc_role_coalescer_stats_t* out) {
+    if (!coalescer || !out) return DC_ERROR_NULL_POINTER;
+    if (!dc_platform_mutex_lock(&coalescer->lock)) return DC_ERROR_INVALID_STATE;
+    *out = coalescer->stats;
+    out->pending = 0;
+    out->cached = 0;
+    for (const dc_coalescer_member_t* m = coalescer->pending.head; m; m = m->next) {
+        out->pending++;
+        if (m->has_roles) out->cached++;
+    }
+    for (const dc_coalescer_member_t* m = coalescer->idle.head; m; m = m->next) out->cached++;
+    dc_platform_mutex_unlock(&coalescer->lock);
+    return DC_OK;
+}
+
+static void dc_coalescer_thread_main(void* arg) {
+    dc_role_coalescer_t* co = (dc_role_coalescer_t*)arg;
+    while (!atomic_load(&co->stop)) {
+        uint64_t now = dc_coalescer_now_ms();
+        (void)dc_role_coalescer_poll(co, now);
+        uint64_t wait_ms = DC_COALESCER_IDLE_TICK_MS;
+        uint64_t deadline = 0;
+        if (dc_role_coalescer_next_deadline(co, &deadline)) {
+            now = dc_coalescer_now_ms();
+            uint64_t due = (deadline > now) ? deadline - now : 0;
+            if (due < wait_ms) wait_ms = due;
+        }
+        if (wait_ms > 0) dc_platform_sleep_ms(wait_ms);
+    }
+}
+
+dc_status_t dc_role_coalescer_create(dc_client_t* client, const dc_role_coalescer_config_t* config,
+                                     dc_role_coalescer_t** out) {
+    if (!client || !config || !out) return DC_ERROR_NULL_POINTER;
+    *out = NULL;
+
+    dc_role_coalescer_t* co = (dc_role_coalescer_t*)dc_alloc(sizeof(*co));
+    if (!co) return DC_ERROR_OUT_OF_MEMORY;
+    memset(co, 0, sizeof(*co));
+    co->client = client;
+    co->config = *config;
+    if (co->config.window_ms == 0) co->config.window_ms = DC_COALESCER_DEFAULT_WINDOW_MS;
+    atomic_init(&co->stop, 0);
+
+    if (!dc_platform_mutex_init(&co->lock)) {
+        dc_free(co);
+        return DC_ERROR_INVALID_STATE;
+    }
+    if (!dc_platform_cond_init(&co->settled)) {
+        dc_platform_mutex_destroy(&co->lock);
+        dc_free(co);
+        return DC_ERROR_INVALID_STATE;
+    }
+    dc_status_t st = dc_snowflake_map_init(&co->users, sizeof(dc_coalescer_member_t*));
+    if (st != DC_OK) {
+        dc_platform_cond_destroy(&co->settled);
+        dc_platform_mutex_destroy(&co->lock);
+        dc_free(co);
+        return st;
+    }
+
+    if (config->use_thread) {
+        if (!dc_platform_thread_create(&co->thread, dc_coalescer_thread_main, co)) {
+            dc_snowflake_map_free(&co->users);
+            dc_platform_cond_destroy(&co->settled);
+            dc_platform_mutex_destroy(&co->lock);
+            dc_free(co);
+            return DC_ERROR_INVALID_STATE;
+        }
+        co->thread_started = 1;
+    }
+
+    *out = co;
+    return DC_OK;
+}
+
+void dc_role_coalescer_free(dc_role_coalescer_t* coalescer) {
+    if (!coalescer) return;
+    atomic_store(&coalescer->stop, 1);
+    if (coalescer->thread_started) (void)dc_platform_thread_join(coalescer->thread);
+    size_t cursor = 0;
+    void* slot = NULL;
+    while (dc_snowflake_map_next(&coalescer->users, &cursor, NULL, &slot)) {
+        dc_coalescer_member_t* m = *(dc_coalescer_member_t**)slot;
+        while (m) {
+            dc_coalescer_member_t* next = m->same_user;
+            dc_vec_free(&m->ops);
+            dc_vec_free(&m->roles);
+            dc_free(m);
+            m = next;
+        }
+    }
+    dc_snowflake_map_free(&coalescer->users);
+    dc_platform_cond_destroy(&coalescer->settled);
+    dc_platform_mutex_destroy(&coalescer->lock);
+    dc_free(coalescer);
+}
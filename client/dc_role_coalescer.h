@@ -0,0 +1,219 @@
+#ifndef DC_ROLE_COALESCER_H
+#define DC_ROLE_COALESCER_H
+
+/**
+ * @file dc_role_coalescer.h
+ * @brief Coalesced member role mutations
+ *
+ * Reaction-role and auto-role bots tend to add and remove several roles of
+ * the same member in quick succession. The coalescer queues those mutations
+ * per (guild, member) for a short window; the last mutation of a role wins.
+ * When the window closes the batch is applied with as few requests as
+ * possible:
+ * - member roles known: one PATCH /guilds/{guild}/members/{user} with the
+ *   final role set (a batch that changes nothing sends no request, a single
+ *   change uses the add/remove role route)
+ * - roles unknown: the member is fetched first when that is cheaper than
+ *   one call per mutation, otherwise each mutation is its own add/remove call
+ *
+ * Only one batch per member is in flight at a time, so concurrent adds and
+ * removes of the same role are applied in the order they were queued.
+ *
+ * Current roles are learned from gateway payloads carrying a member
+ * (GUILD_CREATE, GUILD_MEMBERS_CHUNK, GUILD_MEMBER_ADD/UPDATE,
+ * MESSAGE_REACTION_ADD, INTERACTION_CREATE) and from PATCH responses. A PATCH
+ * replaces the whole role list, so roles changed elsewhere after they were
+ * observed would be reverted: without the GUILD_MEMBERS intent nothing
+ * reports such changes, and roles_ttl_ms bounds how long an observation
+ * is trusted.
+ *
+ * Thread-safe: queueing, feeding and polling may come from different threads.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include "core/dc_status.h"
+#include "core/dc_snowflake.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct dc_client dc_client_t;
+
+/**
+ * @brief Called once per flushed member batch
+ * @param status DC_OK, or the first error of the batch
+ */
+typedef void (*dc_role_coalescer_result_fn)(void* user_data, dc_snowflake_t guild_id,
+                                            dc_snowflake_t user_id, dc_status_t status);
+
+/**
+ * @brief Coalescer configuration
+ */
+typedef struct {
+    uint32_t window_ms;                     /**< Time from the first queued mutation to the flush */
+    uint32_t roles_ttl_ms;                  /**< How long observed member roles are trusted (0 = never) */
+    int fetch_unknown;                      /**< Fetch unknown members when that saves requests */
+    int use_thread;                         /**< Flush from a background thread */
+    dc_role_coalescer_result_fn on_result;  /**< Optional per-batch result */
+    void* user_data;                        /**< Passed to on_result */
+} dc_role_coalescer_config_t;
+
+/**
+ * @brief Coalescer counters
+ *
+ * queued - requests is the number of requests saved.
+ */
+typedef struct {
+    uint64_t queued;        /**< Mutations queued */
+    uint64_t superseded;    /**< Mutations replaced by a later one for the same role */
+    uint64_t batches;       /**< Member batches flushed */
+    uint64_t requests;      /**< REST requests sent (patches, fetches and individual calls) */
+    uint64_t patches;       /**< Batches applied with one member PATCH */
+    uint64_t fetches;       /**< Member fetches for batches without known roles */
+    uint64_t individual;    /**< Individual add/remove role calls */
+    uint64_t unchanged;     /**< Batches that needed no request */
+    uint64_t failures;      /**< Batches that ended with an error */
+    uint32_t pending;       /**< Members with queued mutations */
+    uint32_t cached;        /**< Members whose roles are known */
+} dc_role_coalescer_stats_t;
+
+/**
+ * @brief Role coalescer (opaque)
+ */
+typedef struct dc_role_coalescer dc_role_coalescer_t;
+
+/**
+ * @brief Initialize a coalescer configuration with defaults
+ *
+ * Defaults:
+ * - window_ms: 250
+ * - roles_ttl_ms: 30000
+ * - fetch_unknown: 1
+ * - use_thread: 1
+ */
+void dc_role_coalescer_config_init(dc_role_coalescer_config_t* config);
+
+/**
+ * @brief Create a coalescer
+ *
+ * With use_thread, a background thread flushes batches whose window closed.
+ * Without it (or on platforms without threads) the owner calls
+ * dc_role_coalescer_poll.
+ *
+ * @param client Discord client used for the requests
+ * @param config Configuration
+ * @param out Pointer to store created coalescer
+ * @return DC_OK on success, error code on failure
+ */
+dc_status_t dc_role_coalescer_create(dc_client_t* client, const dc_role_coalescer_config_t* config,
+                                     dc_role_coalescer_t** out);
+
+/**
+ * @brief Stop the background thread and free the coalescer
+ *
+ * Mutations still queued are dropped; call dc_role_coalescer_flush first to
+ * apply them.
+ *
+ * @param coalescer Coalescer to free (may be NULL)
+ */
+void dc_role_coalescer_free(dc_role_coalescer_t* coalescer);
+
+/**
+ * @brief Queue adding a role to a member
+ * @param coalescer Coalescer
+ * @param guild_id Guild
+ * @param user_id Member
+ * @param role_id Role to add
+ * @param now_ms Current time (monotonic ms)
+ * @return DC_OK on success, error code on failure
+ */
+dc_status_t dc_role_coalescer_add(dc_role_coalescer_t* coalescer, dc_snowflake_t guild_id,
+                                  dc_snowflake_t user_id, dc_snowflake_t role_id, uint64_t now_ms);
+
+/**
+ * @brief Queue removing a role from a member
+ * @param coalescer Coalescer
+ * @param guild_id Guild
+ * @param user_id Member
+ * @param role_id Role to remove
+ * @param now_ms Current time (monotonic ms)
+ * @return DC_OK on success, error code on failure
+ */
+dc_status_t dc_role_coalescer_remove(dc_role_coalescer_t* coalescer, dc_snowflake_t guild_id,
+                                     dc_snowflake_t user_id, dc_snowflake_t role_id, uint64_t now_ms);
+
+/**
+ * @brief Record the current roles of a member
+ * @param coalescer Coalescer
+ * @param guild_id Guild
+ * @param user_id Member
+ * @param roles Role IDs (may be NULL when count is 0)
+ * @param count Number of roles
+ * @param now_ms Time the roles were observed (monotonic ms)
+ * @return DC_OK on success, error code on failure
+ */
+dc_status_t dc_role_coalescer_set_member_roles(dc_role_coalescer_t* coalescer,
+                                               dc_snowflake_t guild_id, dc_snowflake_t user_id,
+                                               const dc_snowflake_t* roles, size_t count,
+                                               uint64_t now_ms);
+
+/**
+ * @brief Learn member roles from a gateway dispatch
+ *
+ * Also forgets members that left, guilds that went away and deleted roles.
+ * Other events are ignored.
+ *
+ * @param coalescer Coalescer
+ * @param event_name Dispatch event name
+ * @param event_data Dispatch JSON data
+ * @param now_ms Arrival time (monotonic ms)
+ * @return DC_OK on success, error code on failure
+ */
+dc_status_t dc_role_coalescer_feed_event(dc_role_coalescer_t* coalescer, const char* event_name,
+                                         const char* event_data, uint64_t now_ms);
+
+/**
+ * @brief Flush every batch whose window closed and drop stale roles
+ *
+ * Requests are sent without holding the coalescer lock.
+ *
+ * @param coalescer Coalescer
+ * @param now_ms Current time (monotonic ms)
+ * @return Number of batches flushed
+ */
+uint32_t dc_role_coalescer_poll(dc_role_coalescer_t* coalescer, uint64_t now_ms);
+
+/**
+ * @brief Flush every queued batch now, blocking until all are applied
+ *
+ * Also waits for batches another thread is applying.
+ *
+ * @param coalescer Coalescer
+ * @return Number of batches flushed by this call
+ */
+uint32_t dc_role_coalescer_flush(dc_role_coalescer_t* coalescer);
+
+/**
+ * @brief Earliest window end
+ * @param coalescer Coalescer
+ * @param out_ms Receives the time the next batch is due (monotonic ms)
+ * @return 1 if a batch is waiting, 0 otherwise
+ */
+int dc_role_coalescer_next_deadline(dc_role_coalescer_t* coalescer, uint64_t* out_ms);
+
+/**
+ * @brief Get the coalescer counters
+ * @param coalescer Coalescer
+ * @param out Receives the counters
+ * @return DC_OK on success, error code on failure
+ */
+dc_status_t dc_role_coalescer_get_stats(dc_role_coalescer_t* coalescer,
+                                        dc_role_coalescer_stats_t* out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DC_ROLE_COALESCER_H */
@@ -0,0 +1,438 @@
+/**
+ * @file dc_waiters.c
+ * @brief Indexed one-shot and collecting event waiters
+ */
+
+#include "dc_waiters.h"
+#include "core/dc_alloc.h"
+#include "json/dc_json.h"
+#include <string.h>
+#include <yyjson.h>
+
+#define DC_WAITER_NO_HEAP SIZE_MAX
+
+/* Interaction types from the INTERACTION_CREATE payload */
+#define DC_WAITER_INTERACTION_COMPONENT 3
+#define DC_WAITER_INTERACTION_MODAL 5
+
+struct dc_waiter {
+    uint64_t id;
+    dc_wait_kind_t kind;
+    uint64_t key;
+    dc_snowflake_t message_id;
+    dc_snowflake_t channel_id;
+    dc_snowflake_t user_id;
+    char custom_id[DC_WAITER_CUSTOM_ID_MAX + 1];
+    uint64_t deadline_ms;           /* 0 = none */
+    size_t heap_index;
+    uint32_t max_matches;
+    uint32_t matches;
+    int removed;                    /* detached; no further callbacks */
+    dc_waiter_callback_t callback;
+    void* user_data;
+    dc_waiter_t* prev;              /* chain of waiters sharing kind and key */
+    dc_waiter_t* next;
+};
+
+static uint64_t dc_waiter_mix(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+static uint64_t dc_waiter_hash_str(const char* s) {
+    uint64_t h = 0xCBF29CE484222325ull;
+    for (; *s; s++) {
+        h ^= (unsigned char)*s;
+        h *= 0x100000001B3ull;
+    }
+    return h;
+}
+
+/* Map keys must be non-zero; a collision just lengthens the chain. */
+static uint64_t dc_waiter_nonzero(uint64_t key) {
+    return key ? key : 1u;
+}
+
+static uint64_t dc_waiter_reply_key(dc_snowflake_t channel_id, dc_snowflake_t user_id) {
+    if (user_id == 0) return dc_waiter_nonzero(channel_id);
+    return dc_waiter_nonzero(dc_waiter_mix(channel_id ^ dc_waiter_mix(user_id)));
+}
+
+/* ---- deadline heap ---- */
+
+static dc_waiter_t* dc_waiter_heap_at(const dc_waiter_registry_t* registry, size_t i) {
+    return *(dc_waiter_t**)dc_vec_at(&registry->deadlines, i);
+}
+
+static void dc_waiter_heap_place(dc_waiter_registry_t* registry, size_t i, dc_waiter_t* w) {
+    *(dc_waiter_t**)dc_vec_at(&registry->deadlines, i) = w;
+    w->heap_index = i;
+}
+
+static void dc_waiter_heap_sift_up(dc_waiter_registry_t* registry, size_t i) {
+    dc_waiter_t* w = dc_waiter_heap_at(registry, i);
+    while (i > 0) {
+        size_t parent = (i - 1u) / 2u;
+        dc_waiter_t* p = dc_waiter_heap_at(registry, parent);
+        if (p->deadline_ms <= w->deadline_ms) break;
+        dc_waiter_heap_place(registry, i, p);
+        i = parent;
+    }
+    dc_waiter_heap_place(registry, i, w);
+}
+
+static void dc_waiter_heap_sift_down(dc_waiter_registry_t* registry, size_t i) {
+    size_t n = registry->deadlines.length;
+    dc_waiter_t* w = dc_waiter_heap_at(registry, i);
+    for (;;) {
+        size_t child = 2u * i + 1u;
+        if (child >= n) break;
+        if (child + 1u < n &&
+            dc_waiter_heap_at(registry, child + 1u)->deadline_ms <
+                dc_waiter_heap_at(registry, child)->deadline_ms) {
+            child++;
+        }
+        dc_waiter_t* c = dc_waiter_heap_at(registry, child);
+        if (w->deadline_ms <= c->deadline_ms) break;
+        dc_waiter_heap_place(registry, i, c);
+        i = child;
+    }
+    dc_waiter_heap_place(registry, i, w);
+}
+
+static void dc_waiter_heap_remove(dc_waiter_registry_t* registry, dc_waiter_t* w) {
+    size_t i = w->heap_index;
+    if (i == DC_WAITER_NO_HEAP) return;
+    w->heap_index = DC_WAITER_NO_HEAP;
+    dc_waiter_t* last = NULL;
+    (void)dc_vec_pop(&registry->deadlines, &last);
+    if (last == w) return;
+    dc_waiter_heap_place(registry, i, last);
+    if (i > 0 && dc_waiter_heap_at(registry, (i - 1u) / 2u)->deadline_ms > last->deadline_ms) {
+        dc_waiter_heap_sift_up(registry, i);
+    } else {
+        dc_waiter_heap_sift_down(registry, i);
+    }
+}
+
+/* ---- registration ---- */
+
+static void dc_waiter_detach(dc_waiter_registry_t* registry, dc_waiter_t* w) {
+    if (w->removed) return;
+    w->removed = 1;
+    dc_snowflake_map_t* index = &registry->index[w->kind];
+    if (w->prev) {
+        w->prev->next = w->next;
+    } else if (w->next) {
+        (void)dc_snowflake_map_put(index, w->key, &w->next);
+    } else {
+        (void)dc_snowflake_map_remove(index, w->key, NULL);
+    }
+    if (w->next) w->next->prev = w->prev;
+    w->prev = NULL;
+    w->next = NULL;
+    dc_waiter_heap_remove(registry, w);
+    (void)dc_snowflake_map_remove(&registry->by_id, w->id, NULL);
+}
+
+/* Frees now, or after the outermost callback returns if one is running. */
+static void dc_waiter_release(dc_waiter_registry_t* registry, dc_waiter_t* w) {
+    if (registry->callback_depth > 0) {
+        w->next = registry->graveyard;
+        registry->graveyard = w;
+        return;
+    }
+    dc_free(w);
+}
+
+static void dc_waiter_callbacks_end(dc_waiter_registry_t* registry) {
+    if (--registry->callback_depth > 0) return;
+    while (registry->graveyard) {
+        dc_waiter_t* w = registry->graveyard;
+        registry->graveyard = w->next;
+        dc_free(w);
+    }
+}
+
+void dc_waiter_spec_init(dc_waiter_spec_t* spec) {
+    if (!spec) return;
+    memset(spec, 0, sizeof(*spec));
+    spec->kind = DC_WAIT_COMPONENT;
+    spec->max_matches = 1;
+}
+
+dc_status_t dc_waiter_registry_init(dc_waiter_registry_t* registry) {
+    if (!registry) return DC_ERROR_NULL_POINTER;
+    memset(registry, 0, sizeof(*registry));
+    dc_status_t st = dc_snowflake_map_init(&registry->by_id, sizeof(dc_waiter_t*));
+    for (size_t k = 0; st == DC_OK && k < DC_WAIT_KIND_COUNT; k++) {
+        st = dc_snowflake_map_init(&registry->index[k], sizeof(dc_waiter_t*));
+    }
+    if (st == DC_OK) st = dc_vec_init(&registry->deadlines, sizeof(dc_waiter_t*));
+    if (st != DC_OK) {
+        dc_snowflake_map_free(&registry->by_id);
+        for (size_t k = 0; k < DC_WAIT_KIND_COUNT; k++) {
+            dc_snowflake_map_free(&registry->index[k]);
+        }
+        return st;
+    }
+    registry->next_id = 1;
+    return DC_OK;
+}
+
+void dc_waiter_registry_free(dc_waiter_registry_t* registry) {
+    if (!registry) return;
+    /* Callbacks may add waiters; keep cancelling until none are left. */
+    while (dc_snowflake_map_length(&registry->by_id) > 0) {
+        size_t cursor = 0;
+        dc_snowflake_t id = 0;
+        if (!dc_snowflake_map_next(&registry->by_id, &cursor, &id, NULL)) break;
+        (void)dc_waiter_registry_cancel(registry, id);
+    }
+    dc_vec_free(&registry->deadlines);
+    for (size_t k = 0; k < DC_WAIT_KIND_COUNT; k++) {
+        dc_snowflake_map_free(&registry->index[k]);
+    }
+    dc_snowflake_map_free(&registry->by_id);
+    memset(registry, 0, sizeof(*registry));
+}
+
+dc_status_t dc_waiter_registry_add(dc_waiter_registry_t* registry, const dc_waiter_spec_t* spec,
+                                   uint64_t now_ms, uint64_t* out_id) {
+    if (!registry || !spec) return DC_ERROR_NULL_POINTER;
+    if (!spec->callback || (unsigned)spec->kind >= DC_WAIT_KIND_COUNT) return DC_ERROR_INVALID_PARAM;
+    if (spec->custom_id && strlen(spec->custom_id) > DC_WAITER_CUSTOM_ID_MAX) {
+        return DC_ERROR_INVALID_PARAM;
+    }
+
+    uint64_t key = 0;
+    switch (spec->kind) {
+        case DC_WAIT_COMPONENT:
+            if (spec->message_id == 0) return DC_ERROR_INVALID_PARAM;
+            key = spec->message_id;
+            break;
+        case DC_WAIT_REPLY:
+            if (spec->channel_id == 0) return DC_ERROR_INVALID_PARAM;
+            key = dc_waiter_reply_key(spec->channel_id, spec->user_id);
+            break;
+        case DC_WAIT_MODAL:
+            if (!spec->custom_id || spec->custom_id[0] == '\0') return DC_ERROR_INVALID_PARAM;
+            key = dc_waiter_nonzero(dc_waiter_hash_str(spec->custom_id));
+            break;
+        default:
+            return DC_ERROR_INVALID_PARAM;
+    }
+
+    dc_waiter_t* w = (dc_waiter_t*)dc_calloc(1, sizeof(*w));
+    if (!w) return DC_ERROR_OUT_OF_MEMORY;
+    w->id = registry->next_id++;
+    w->kind = spec->kind;
+    w->key = key;
+    w->message_id = spec->message_id;
+    w->channel_id = spec->channel_id;
+    w->user_id = spec->user_id;
+    if (spec->custom_id) memcpy(w->custom_id, spec->custom_id, strlen(spec->custom_id) + 1u);
+    w->deadline_ms = spec->timeout_ms ? now_ms + spec->timeout_ms : 0;
+    w->heap_index = DC_WAITER_NO_HEAP;
+    w->max_matches = spec->max_matches;
+    w->callback = spec->callback;
+    w->user_data = spec->user_data;
+
+    dc_status_t st = dc_snowflake_map_put(&registry->by_id, w->id, &w);
+    if (st != DC_OK) {
+        dc_free(w);
+        return st;
+    }
+    if (w->deadline_ms) {
+        st = dc_vec_push(&registry->deadlines, &w);
+        if (st == DC_OK) dc_waiter_heap_sift_up(registry, registry->deadlines.length - 1u);
+    }
+    if (st == DC_OK) {
+        /* New waiters go to the front of their chain. */
+        void* slot = NULL;
+        int inserted = 0;
+        st = dc_snowflake_map_upsert(&registry->index[w->kind], key, &slot, &inserted);
+        if (st == DC_OK) {
+            dc_waiter_t** head = (dc_waiter_t**)slot;
+            if (!inserted && *head) {
+                w->next = *head;
+                (*head)->prev = w;
+            }
+            *head = w;
+        }
+    }
+    if (st != DC_OK) {
+        dc_waiter_heap_remove(registry, w);
+        (void)dc_snowflake_map_remove(&registry->by_id, w->id, NULL);
+        dc_free(w);
+        return st;
+    }
+    if (out_id) *out_id = w->id;
+    return DC_OK;
+}
+
+dc_status_t dc_waiter_registry_cancel(dc_waiter_registry_t* registry, uint64_t waiter_id) {
+    if (!registry) return DC_ERROR_NULL_POINTER;
+    dc_waiter_t** slot = (dc_waiter_t**)dc_snowflake_map_get(&registry->by_id, waiter_id);
+    if (!slot) return DC_ERROR_NOT_FOUND;
+    dc_waiter_t* w = *slot;
+    dc_waiter_detach(registry, w);
+    registry->callback_depth++;
+    w->callback(DC_WAIT_CANCELLED, NULL, NULL, 1, w->user_data);
+    dc_waiter_release(registry, w);
+    dc_waiter_callbacks_end(registry);
+    return DC_OK;
+}
+
+/* ---- dispatch ---- */
+
+static int dc_waiter_accepts(const dc_waiter_t* w, dc_snowflake_t message_id,
+                             dc_snowflake_t channel_id, dc_snowflake_t user_id,
+                             const char* custom_id) {
+    if (w->user_id && w->user_id != user_id) return 0;
+    switch (w->kind) {
+        case DC_WAIT_COMPONENT:
+            if (w->message_id != message_id) return 0;
+            return w->custom_id[0] == '\0' || (custom_id && strcmp(w->custom_id, custom_id) == 0);
+        case DC_WAIT_REPLY:
+            return w->channel_id == channel_id;
+        case DC_WAIT_MODAL:
+            return custom_id && strcmp(w->custom_id, custom_id) == 0;
+        default:
+            return 0;
+    }
+}
+
+static dc_status_t dc_waiter_collect(dc_waiter_registry_t* registry, dc_wait_kind_t kind,
+                                     uint64_t key, dc_snowflake_t message_id,
+                                     dc_snowflake_t channel_id, dc_snowflake_t user_id,
+                                     const char* custom_id, dc_vec_t* out) {
+    dc_waiter_t** head = (dc_waiter_t**)dc_snowflake_map_get(&registry->index[kind], key);
+    for (dc_waiter_t* w = head ? *head : NULL; w; w = w->next) {
+        if (!dc_waiter_accepts(w, message_id, channel_id, user_id, custom_id)) continue;
+        dc_status_t st = dc_vec_push(out, &w);
+        if (st != DC_OK) return st;
+    }
+    return DC_OK;
+}
+
+dc_status_t dc_waiter_registry_dispatch(dc_waiter_registry_t* registry, const char* event_name,
+                                        const char* event_data, size_t* out_matched) {
+    if (!registry || !event_name || !event_data) return DC_ERROR_NULL_POINTER;
+    if (out_matched) *out_matched = 0;
+
+    int is_message = strcmp(event_name, "MESSAGE_CREATE") == 0;
+    int is_interaction = !is_message && strcmp(event_name, "INTERACTION_CREATE") == 0;
+    if (is_message && dc_snowflake_map_length(&registry->index[DC_WAIT_REPLY]) == 0) return DC_OK;
+    if (is_interaction &&
+        dc_snowflake_map_length(&registry->index[DC_WAIT_COMPONENT]) == 0 &&
+        dc_snowflake_map_length(&registry->index[DC_WAIT_MODAL]) == 0) {
+        return DC_OK;
+    }
+    if (!is_message && !is_interaction) return DC_OK;
+
+    dc_json_doc_t doc;
+    dc_status_t st = dc_json_parse(event_data, &doc);
+    if (st != DC_OK) return st;
+    dc_vec_t hits;
+    st = dc_vec_init(&hits, sizeof(dc_waiter_t*));
+    if (st != DC_OK) {
+        dc_json_doc_free(&doc);
+        return st;
+    }
+
+    dc_snowflake_t channel_id = 0;
+    dc_snowflake_t user_id = 0;
+    if (is_message) {
+        yyjson_val* author = yyjson_obj_get(doc.root, "author");
+        st = dc_json_get_snowflake(doc.root, "channel_id", &channel_id);
+        if (st == DC_OK) st = dc_json_get_snowflake(author, "id", &user_id);
+        if (st == DC_OK) {
+            st = dc_waiter_collect(registry, DC_WAIT_REPLY, dc_waiter_reply_key(channel_id, user_id),
+                                   0, channel_id, user_id, NULL, &hits);
+        }
+        if (st == DC_OK &&
+            dc_waiter_reply_key(channel_id, 0) != dc_waiter_reply_key(channel_id, user_id)) {
+            st = dc_waiter_collect(registry, DC_WAIT_REPLY, dc_waiter_reply_key(channel_id, 0),
+                                   0, channel_id, user_id, NULL, &hits);
+        }
+    } else {
+        int64_t type = 0;
+        st = dc_json_get_int64(doc.root, "type", &type);
+        /* Guild interactions carry member.user, DMs carry user. */
+        yyjson_val* member = yyjson_obj_get(doc.root, "member");
+        yyjson_val* user = member ? yyjson_obj_get(member, "user") : yyjson_obj_get(doc.root, "user");
+        if (st == DC_OK && user) st = dc_json_get_snowflake_opt(user, "id", &user_id, 0);
+        yyjson_val* data = yyjson_obj_get(doc.root, "data");
+        yyjson_val* custom = data ? yyjson_obj_get(data, "custom_id") : NULL;
+        const char* custom_id = yyjson_is_str(custom) ? yyjson_get_str(custom) : NULL;
+        if (st == DC_OK && type == DC_WAITER_INTERACTION_COMPONENT) {
+            yyjson_val* message = yyjson_obj_get(doc.root, "message");
+            dc_snowflake_t message_id = 0;
+            if (message) st = dc_json_get_snowflake_opt(message, "id", &message_id, 0);
+            if (st == DC_OK && message_id) {
+                st = dc_waiter_collect(registry, DC_WAIT_COMPONENT, message_id, message_id, 0,
+                                       user_id, custom_id, &hits);
+            }
+        } else if (st == DC_OK && type == DC_WAITER_INTERACTION_MODAL && custom_id) {
+            st = dc_waiter_collect(registry, DC_WAIT_MODAL,
+                                   dc_waiter_nonzero(dc_waiter_hash_str(custom_id)), 0, 0,
+                                   user_id, custom_id, &hits);
+        }
+    }
+    dc_json_doc_free(&doc);
+    if (st != DC_OK) {
+        dc_vec_free(&hits);
+        return st;
+    }
+
+    /* Count and retire first, so callbacks see a consistent registry. */
+    for (size_t i = 0; i < hits.length; i++) {
+        dc_waiter_t* w = *(dc_waiter_t**)dc_vec_at(&hits, i);
+        w->matches++;
+        if (w->max_matches && w->matches >= w->max_matches) dc_waiter_detach(registry, w);
+    }
+    size_t ran = 0;
+    registry->callback_depth++;
+    for (size_t i = 0; i < hits.length; i++) {
+        dc_waiter_t* w = *(dc_waiter_t**)dc_vec_at(&hits, i);
+        int final = w->max_matches && w->matches >= w->max_matches;
+        /* A callback earlier in this loop cancelled it. */
+        if (w->removed && !final) continue;
+        w->callback(DC_WAIT_MATCHED, event_name, event_data, final, w->user_data);
+        ran++;
+        if (final) dc_waiter_release(registry, w);
+    }
+    dc_waiter_callbacks_end(registry);
+    dc_vec_free(&hits);
+    if (out_matched) *out_matched = ran;
+    return DC_OK;
+}
+
+size_t dc_waiter_registry_expire(dc_waiter_registry_t* registry, uint64_t now_ms) {
+    if (!registry) return 0;
+    size_t expired = 0;
+    registry->callback_depth++;
+    while (registry->deadlines.length > 0) {
+        dc_waiter_t* w = dc_waiter_heap_at(registry, 0);
+        if (w->deadline_ms > now_ms) break;
+        dc_waiter_detach(registry, w);
+        w->callback(DC_WAIT_TIMEOUT, NULL, NULL, 1, w->user_data);
+        dc_waiter_release(registry, w);
+        expired++;
+    }
+    dc_waiter_callbacks_end(registry);
+    return expired;
+}
+
+int dc_waiter_registry_next_deadline(const dc_waiter_registry_t* registry, uint64_t* out_ms) {
+    if (!registry || !out_ms || registry->deadlines.length == 0) return 0;
+    *out_ms = dc_waiter_heap_at(registry, 0)->deadline_ms;
+    return 1;
+}
+
+size_t dc_waiter_registry_count(const dc_waiter_registry_t* registry) {
+    return registry ? dc_snowflake_map_length(&registry->by_id) : 0;
+}
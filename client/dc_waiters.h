@@ -0,0 +1,178 @@
+#ifndef DC_WAITERS_H
+#define DC_WAITERS_H
+
+/**
+ * @file dc_waiters.h
+ * @brief Indexed one-shot and collecting event waiters
+ *
+ * A waiter resolves on a gateway dispatch that matches its key: a component
+ * click on a message, a message from a user in a channel, or a modal submit
+ * with a custom_id. Waiters are indexed by kind and key in hash tables, so a
+ * dispatch costs one or two lookups no matter how many waiters are pending,
+ * and events nobody waits for are not parsed at all. Deadlines live in a
+ * min-heap; expiring is O(log n) per timed-out waiter.
+ *
+ * Not thread-safe: use from the thread that feeds dispatches. Callbacks may
+ * add and cancel waiters, including themselves.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include "core/dc_status.h"
+#include "core/dc_snowflake.h"
+#include "core/dc_snowflake_map.h"
+#include "core/dc_vec.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Longest custom_id Discord accepts */
+#define DC_WAITER_CUSTOM_ID_MAX 100u
+
+/**
+ * @brief What a waiter listens for
+ */
+typedef enum {
+    DC_WAIT_COMPONENT = 0,  /**< INTERACTION_CREATE (message component) on message_id */
+    DC_WAIT_REPLY,          /**< MESSAGE_CREATE in channel_id */
+    DC_WAIT_MODAL,          /**< INTERACTION_CREATE (modal submit) with custom_id */
+    DC_WAIT_KIND_COUNT
+} dc_wait_kind_t;
+
+/**
+ * @brief Why a waiter callback runs
+ */
+typedef enum {
+    DC_WAIT_MATCHED = 0,    /**< A matching event arrived */
+    DC_WAIT_TIMEOUT,        /**< The deadline passed (final) */
+    DC_WAIT_CANCELLED       /**< Cancelled or registry freed (final) */
+} dc_wait_result_t;
+
+/**
+ * @brief Waiter callback
+ * @param result Why the callback runs
+ * @param event_name Dispatch name for DC_WAIT_MATCHED, NULL otherwise
+ * @param event_data Dispatch JSON for DC_WAIT_MATCHED, NULL otherwise
+ * @param final 1 if the waiter is gone after this call
+ * @param user_data User data from the spec
+ */
+typedef void (*dc_waiter_callback_t)(dc_wait_result_t result, const char* event_name,
+                                     const char* event_data, int final, void* user_data);
+
+/**
+ * @brief Waiter description
+ */
+typedef struct {
+    dc_wait_kind_t kind;
+    dc_snowflake_t message_id;      /**< DC_WAIT_COMPONENT: required */
+    dc_snowflake_t channel_id;      /**< DC_WAIT_REPLY: required */
+    dc_snowflake_t user_id;         /**< Only events from this user (0 = anyone) */
+    const char* custom_id;          /**< DC_WAIT_MODAL: required; DC_WAIT_COMPONENT: optional filter */
+    uint32_t timeout_ms;            /**< Time until DC_WAIT_TIMEOUT (0 = none) */
+    uint32_t max_matches;           /**< Matches before the waiter completes (0 = until timeout) */
+    dc_waiter_callback_t callback;
+    void* user_data;
+} dc_waiter_spec_t;
+
+typedef struct dc_waiter dc_waiter_t;
+
+/**
+ * @brief Waiter registry
+ */
+typedef struct {
+    dc_snowflake_map_t by_id;                       /**< waiter id -> dc_waiter_t* */
+    dc_snowflake_map_t index[DC_WAIT_KIND_COUNT];   /**< key -> dc_waiter_t* chain head */
+    dc_vec_t deadlines;                             /**< dc_waiter_t*, min-heap by deadline */
+    dc_waiter_t* graveyard;                         /**< Removed during callbacks, freed after */
+    uint32_t callback_depth;
+    uint64_t next_id;
+} dc_waiter_registry_t;
+
+/**
+ * @brief Initialize spec with defaults
+ *
+ * Defaults:
+ * - kind: DC_WAIT_COMPONENT, max_matches: 1, timeout_ms: 0
+ */
+void dc_waiter_spec_init(dc_waiter_spec_t* spec);
+
+/**
+ * @brief Initialize registry
+ * @param registry Registry to initialize
+ * @return DC_OK on success, error code on failure
+ */
+dc_status_t dc_waiter_registry_init(dc_waiter_registry_t* registry);
+
+/**
+ * @brief Free registry
+ *
+ * Pending waiters get a final DC_WAIT_CANCELLED callback first.
+ *
+ * @param registry Registry to free
+ */
+void dc_waiter_registry_free(dc_waiter_registry_t* registry);
+
+/**
+ * @brief Register a waiter
+ * @param registry Registry
+ * @param spec Waiter description (custom_id is copied)
+ * @param now_ms Current monotonic time in milliseconds
+ * @param out_id Optional; receives the waiter ID (never 0)
+ * @return DC_OK on success, DC_ERROR_INVALID_PARAM for a missing key or
+ *         callback or a custom_id over DC_WAITER_CUSTOM_ID_MAX
+ */
+dc_status_t dc_waiter_registry_add(dc_waiter_registry_t* registry, const dc_waiter_spec_t* spec,
+                                   uint64_t now_ms, uint64_t* out_id);
+
+/**
+ * @brief Cancel a waiter
+ *
+ * Runs its callback with a final DC_WAIT_CANCELLED.
+ *
+ * @param registry Registry
+ * @param waiter_id Waiter ID
+ * @return DC_OK on success, DC_ERROR_NOT_FOUND if it already completed
+ */
+dc_status_t dc_waiter_registry_cancel(dc_waiter_registry_t* registry, uint64_t waiter_id);
+
+/**
+ * @brief Match a gateway dispatch against pending waiters
+ * @param registry Registry
+ * @param event_name Dispatch event name
+ * @param event_data Dispatch event JSON data
+ * @param out_matched Optional; receives the number of callbacks run
+ * @return DC_OK on success (including events no waiter cares about),
+ *         error code if a relevant event cannot be parsed
+ */
+dc_status_t dc_waiter_registry_dispatch(dc_waiter_registry_t* registry, const char* event_name,
+                                        const char* event_data, size_t* out_matched);
+
+/**
+ * @brief Time out every waiter whose deadline is at or before @p now_ms
+ * @param registry Registry
+ * @param now_ms Current monotonic time in milliseconds
+ * @return Number of waiters that timed out
+ */
+size_t dc_waiter_registry_expire(dc_waiter_registry_t* registry, uint64_t now_ms);
+
+/**
+ * @brief Earliest pending deadline
+ * @param registry Registry
+ * @param out_ms Receives the deadline (monotonic ms)
+ * @return 1 if a waiter has a deadline, 0 otherwise
+ */
+int dc_waiter_registry_next_deadline(const dc_waiter_registry_t* registry, uint64_t* out_ms);
+
+/**
+ * @brief Number of pending waiters
+ * @param registry Registry
+ * @return Pending waiters, 0 if registry is NULL
+ */
+size_t dc_waiter_registry_count(const dc_waiter_registry_t* registry);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DC_WAITERS_H */
@@ -0,0 +1,488 @@
+/**
+ * @file dc_webhook_relay.c
+ * @brief Webhook pool for relaying messages into one channel
+ */
+
+#include "dc_webhook_relay.h"
+#include "client/dc_client.h"
+#include "core/dc_alloc.h"
+#include "core/dc_platform.h"
+#include "core/dc_snowflake_map.h"
+#include "json/dc_json.h"
+#include <string.h>
+#include <yyjson.h>
+
+#define DC_RELAY_DEFAULT_COUNT 4u
+#define DC_RELAY_MAX_COUNT 15u
+#define DC_RELAY_DEFAULT_ATTEMPTS 3u
+#define DC_RELAY_DEFAULT_NAME "Relay"
+#define DC_RELAY_WEBHOOK_INCOMING 1
+
+/* Budget assumed for a webhook whose bucket has not answered yet. */
+#define DC_RELAY_UNKNOWN_BUDGET 5
+
+/* A slot whose replacement failed is not retried sooner than this. */
+#define DC_RELAY_REPLACE_BACKOFF_MS 30000u
+
+typedef enum {
+    DC_RELAY_ACTIVE = 0,
+    DC_RELAY_DEAD,              /* deleted or token revoked, waiting for a replacement */
+    DC_RELAY_REPLACING          /* replacement being created (no lock held) */
+} dc_relay_state_t;
+
+typedef struct {
+    dc_snowflake_t id;
+    dc_string_t token;
+    dc_string_t path;           /* /webhooks/{id}/{token}, for the budget lookup */
+    dc_relay_state_t state;
+    uint32_t in_flight;
+    uint64_t last_pick;         /* pick sequence number, for tie-breaks */
+    uint64_t retry_at_ms;       /* DEAD: earliest replacement attempt */
+} dc_relay_webhook_t;
+
+/* Ticket lock per source: sends are served in ticket order. */
+typedef struct {
+    uint64_t next_ticket;
+    uint64_t serving;
+} dc_relay_source_t;
+
+struct dc_webhook_relay {
+    dc_client_t* client;
+    dc_snowflake_t channel_id;
+    dc_string_t name;
+    uint32_t max_attempts;
+    dc_platform_mutex_t lock;
+    dc_relay_webhook_t* webhooks;
+    uint32_t count;
+    uint64_t pick_seq;
+    dc_snowflake_map_t sources;     /* source_id -> dc_relay_source_t */
+    dc_platform_cond_t source_turn; /* broadcast when a source serves its next ticket */
+    dc_webhook_relay_stats_t stats;
+};
+
+void dc_webhook_relay_config_init(dc_webhook_relay_config_t* config) {
+    if (!config) return;
+    memset(config, 0, sizeof(*config));
+    config->webhook_count = DC_RELAY_DEFAULT_COUNT;
+    config->webhook_name = DC_RELAY_DEFAULT_NAME;
+    config->max_attempts = DC_RELAY_DEFAULT_ATTEMPTS;
+}
+
+static uint64_t dc_relay_now_ms(void) {
+    uint64_t now = 0;
+    dc_platform_now_monotonic_ms(&now);
+    return now;
+}
+
+static int dc_relay_is_gone(dc_status_t st) {
+    return st == DC_ERROR_NOT_FOUND || st == DC_ERROR_UNAUTHORIZED;
+}
+
+static dc_status_t dc_relay_webhook_set(dc_relay_webhook_t* w, dc_snowflake_t id, const char* token) {
+    dc_status_t st = dc_string_set_cstr(&w->token, token);
+    if (st == DC_OK) {
+        st = dc_string_printf(&w->path, "/webhooks/%llu/%s", (unsigned long long)id, token);
+    }
+    if (st != DC_OK) return st;
+    w->id = id;
+    w->state = DC_RELAY_ACTIVE;
+    w->retry_at_ms = 0;
+    return DC_OK;
+}
+
+/* Webhook object with an ID and token: fills the outputs, DC_ERROR_NOT_FOUND without a token. */
+static dc_status_t dc_relay_parse_webhook(yyjson_val* obj, dc_snowflake_t* id, const char** token) {
+    if (!yyjson_is_obj(obj)) return DC_ERROR_INVALID_FORMAT;
+    dc_status_t st = dc_json_get_snowflake(obj, "id", id);
+    if (st != DC_OK) return st;
+    if (dc_json_get_string(obj, "token", token) != DC_OK || (*token)[0] == '\0') {
+        return DC_ERROR_NOT_FOUND;
+    }
+    return DC_OK;
+}
+
+/* Creates a webhook in the channel; no lock held. */
+static dc_status_t dc_relay_create_webhook(dc_webhook_relay_t* relay, dc_relay_webhook_t* into) {
+    dc_json_mut_doc_t body;
+    dc_status_t st = dc_json_mut_doc_create(&body);
+    if (st != DC_OK) return st;
+    dc_string_t body_json;
+    dc_string_t webhook_json;
+    st = dc_string_init(&body_json);
+    if (st != DC_OK) {
+        dc_json_mut_doc_free(&body);
+        return st;
+    }
+    st = dc_string_init(&webhook_json);
+    if (st != DC_OK) {
+        dc_string_free(&body_json);
+        dc_json_mut_doc_free(&body);
+        return st;
+    }
+
+    st = dc_json_mut_set_string(&body, body.root, "name", dc_string_cstr(&relay->name));
+    if (st == DC_OK) st = dc_json_mut_doc_serialize(&body, &body_json);
+    if (st == DC_OK) {
+        st = dc_client_create_channel_webhook_json(relay->client, relay->channel_id,
+                                                   dc_string_cstr(&body_json), &webhook_json);
+    }
+    if (st == DC_OK) {
+        dc_json_doc_t doc;
+        st = dc_json_parse(dc_string_cstr(&webhook_json), &doc);
+        if (st == DC_OK) {
+            dc_snowflake_t id = 0;
+            const char* token = NULL;
+            st = dc_relay_parse_webhook(doc.root, &id, &token);
+            if (st == DC_ERROR_NOT_FOUND) st = DC_ERROR_INVALID_FORMAT;
+            if (st == DC_OK) st = dc_relay_webhook_set(into, id, token);
+            dc_json_doc_free(&doc);
+        }
+    }
+
+    dc_string_free(&webhook_json);
+    dc_string_free(&body_json);
+    dc_json_mut_doc_free(&body);
+    return st;
+}
+
+/* Adopts incoming webhooks named like the pool; returns how many slots were filled. */
+static uint32_t dc_relay_adopt(dc_webhook_relay_t* relay, const char* webhooks_json) {
+    dc_json_doc_t doc;
+    if (dc_json_parse(webhooks_json, &doc) != DC_OK) return 0;
+    uint32_t adopted = 0;
+    if (yyjson_is_arr(doc.root)) {
+        size_t idx = 0, max = 0;
+        yyjson_val* item = NULL;
+        yyjson_arr_foreach(doc.root, idx, max, item) {
+            if (adopted >= relay->count) break;
+            int64_t type = 0;
+            const char* name = NULL;
+            dc_snowflake_t id = 0;
+            const char* token = NULL;
+            if (dc_json_get_int64(item, "type", &type) != DC_OK || type != DC_RELAY_WEBHOOK_INCOMING) continue;
+            if (dc_json_get_string(item, "name", &name) != DC_OK ||
+                strcmp(name, dc_string_cstr(&relay->name)) != 0) {
+                continue;
+            }
+            if (dc_relay_parse_webhook(item, &id, &token) != DC_OK) continue;
+            if (dc_relay_webhook_set(&relay->webhooks[adopted], id, token) == DC_OK) adopted++;
+        }
+    }
+    dc_json_doc_free(&doc);
+    return adopted;
+}
+
+/* Replaces a dead slot unless another sender already is or its backoff has not passed. */
+static void dc_relay_replace(dc_webhook_relay_t* relay, uint32_t index) {
+    dc_relay_webhook_t* w = &relay->webhooks[index];
+    if (!dc_platform_mutex_lock(&relay->lock)) return;
+    if (w->state != DC_RELAY_DEAD || w->retry_at_ms > dc_relay_now_ms()) {
+        dc_platform_mutex_unlock(&relay->lock);
+        return;
+    }
+    w->state = DC_RELAY_REPLACING;
+    dc_platform_mutex_unlock(&relay->lock);
+
+    dc_relay_webhook_t fresh;
+    memset(&fresh, 0, sizeof(fresh));
+    dc_status_t st = dc_string_init(&fresh.token);
+    if (st == DC_OK) st = dc_string_init(&fresh.path);
+    if (st == DC_OK) st = dc_relay_create_webhook(relay, &fresh);
+
+    if (dc_platform_mutex_lock(&relay->lock)) {
+        if (st == DC_OK) {
+            dc_string_swap(&w->token, &fresh.token);
+            dc_string_swap(&w->path, &fresh.path);
+            w->id = fresh.id;
+            w->state = DC_RELAY_ACTIVE;
+            w->retry_at_ms = 0;
+            relay->stats.created++;
+        } else {
+            w->state = DC_RELAY_DEAD;
+            w->retry_at_ms = dc_relay_now_ms() + DC_RELAY_REPLACE_BACKOFF_MS;
+        }
+        dc_platform_mutex_unlock(&relay->lock);
+    }
+    dc_string_free(&fresh.path);
+    dc_string_free(&fresh.token);
+}
+
+typedef struct {
+    int64_t score;              /* budget left after the sends in flight */
+    uint64_t reset_in_ms;
+    uint64_t last_pick;
+} dc_relay_rank_t;
+
+static int dc_relay_rank_better(const dc_relay_rank_t* a, const dc_relay_rank_t* b) {
+    /* With budget somewhere, the most budget wins; otherwise the earliest reset. */
+    if ((a->score > 0 || b->score > 0) && a->score != b->score) return a->score > b->score;
+    if (a->reset_in_ms != b->reset_in_ms) return a->reset_in_ms < b->reset_in_ms;
+    if (a->score != b->score) return a->score > b->score;
+    return a->last_pick < b->last_pick;
+}
+
+/* Lock held. Returns the slot to send through, or -1 if none is usable. */
+static int64_t dc_relay_pick(dc_webhook_relay_t* relay) {
+    int64_t best = -1;
+    dc_relay_rank_t best_rank;
+    memset(&best_rank, 0, sizeof(best_rank));
+    for (uint32_t i = 0; i < relay->count; i++) {
+        dc_relay_webhook_t* w = &relay->webhooks[i];
+        if (w->state != DC_RELAY_ACTIVE) continue;
+        dc_rest_route_budget_t budget;
+        dc_relay_rank_t rank;
+        rank.score = DC_RELAY_UNKNOWN_BUDGET;
+        rank.reset_in_ms = 0;
+        rank.last_pick = w->last_pick;
+        if (dc_client_get_route_budget(relay->client, DC_HTTP_POST, dc_string_cstr(&w->path),
+                                       &budget) == DC_OK && budget.known) {
+            rank.score = (int64_t)budget.remaining;
+            rank.reset_in_ms = budget.reset_in_ms;
+        }
+        rank.score -= (int64_t)w->in_flight;
+        if (best < 0 || dc_relay_rank_better(&rank, &best_rank)) {
+            best = (int64_t)i;
+            best_rank = rank;
+        }
+    }
+    return best;
+}
+
+/* Lock held. First dead slot that may be replaced now, or -1. */
+static int64_t dc_relay_find_replaceable(dc_webhook_relay_t* relay, uint64_t now_ms) {
+    for (uint32_t i = 0; i < relay->count; i++) {
+        const dc_relay_webhook_t* w = &relay->webhooks[i];
+        if (w->state == DC_RELAY_DEAD && w->retry_at_ms <= now_ms) return (int64_t)i;
+    }
+    return -1;
+}
+
+static void dc_relay_free_slots(dc_webhook_relay_t* relay) {
+    for (uint32_t i = 0; i < relay->count; i++) {
+        dc_string_free(&relay->webhooks[i].token);
+        dc_string_free(&relay->webhooks[i].path);
+    }
+    dc_free(relay->webhooks);
+    relay->webhooks = NULL;
+}
+
+dc_status_t dc_webhook_relay_create(dc_client_t* client, const dc_webhook_relay_config_t* config,
+                                    dc_webhook_relay_t** out) {
+    if (!client || !config || !out) return DC_ERROR_NULL_POINTER;
+    *out = NULL;
+    if (!dc_snowflake_is_valid(config->channel_id)) return DC_ERROR_INVALID_PARAM;
+    if (config->webhook_count > DC_RELAY_MAX_COUNT) return DC_ERROR_INVALID_PARAM;
+    const char* name = config->webhook_name ? config->webhook_name : DC_RELAY_DEFAULT_NAME;
+    if (name[0] == '\0') return DC_ERROR_INVALID_PARAM;
+
+    dc_webhook_relay_t* relay = (dc_webhook_relay_t*)dc_alloc(sizeof(*relay));
+    if (!relay) return DC_ERROR_OUT_OF_MEMORY;
+    memset(relay, 0, sizeof(*relay));
+    relay->client = client;
+    relay->channel_id = config->channel_id;
+    relay->count = (config->webhook_count == 0) ? DC_RELAY_DEFAULT_COUNT : config->webhook_count;
+    relay->max_attempts = (config->max_attempts == 0) ? 1u : config->max_attempts;
+
+    dc_status_t st = dc_string_init_from_cstr(&relay->name, name);
+    if (st != DC_OK) {
+        dc_free(relay);
+        return st;
+    }
+    relay->webhooks = (dc_relay_webhook_t*)dc_calloc(relay->count, sizeof(dc_relay_webhook_t));
+    if (!relay->webhooks) {
+        dc_string_free(&relay->name);
+        dc_free(relay);
+        return DC_ERROR_OUT_OF_MEMORY;
+    }
+    for (uint32_t i = 0; i < relay->count && st == DC_OK; i++) {
+        relay->webhooks[i].state = DC_RELAY_DEAD;
+        st = dc_string_init(&relay->webhooks[i].token);
+        if (st == DC_OK) st = dc_string_init(&relay->webhooks[i].path);
+    }
+    if (st == DC_OK) st = dc_snowflake_map_init(&relay->sources, sizeof(dc_relay_source_t));
+    if (st == DC_OK && !dc_platform_mutex_init(&relay->lock)) {
+        dc_snowflake_map_free(&relay->sources);
+        st = DC_ERROR_INVALID_STATE;
+    }
+    if (st == DC_OK && !dc_platform_cond_init(&relay->source_turn)) {
+        dc_platform_mutex_destroy(&relay->lock);
+        dc_snowflake_map_free(&relay->sources);
+        st = DC_ERROR_INVALID_STATE;
+    }
+    if (st != DC_OK) {
+        dc_relay_free_slots(relay);
+        dc_string_free(&relay->name);
+        dc_free(relay);
+        return st;
+    }
+
+    /* Reuse the pool's webhooks from an earlier run, then create the missing ones. */
+    dc_string_t webhooks_json;
+    st = dc_string_init(&webhooks_json);
+    if (st == DC_OK) {
+        if (dc_client_get_channel_webhooks_json(client, relay->channel_id, &webhooks_json) == DC_OK) {
+            relay->stats.adopted = dc_relay_adopt(relay, dc_string_cstr(&webhooks_json));
+        }
+        dc_string_free(&webhooks_json);
+    }
+    dc_status_t create_st = DC_OK;
+    for (uint32_t i = (uint32_t)relay->stats.adopted; i < relay->count; i++) {
+        create_st = dc_relay_create_webhook(relay, &relay->webhooks[i]);
+        if (create_st != DC_OK) {
+            relay->webhooks[i].retry_at_ms = dc_relay_now_ms() + DC_RELAY_REPLACE_BACKOFF_MS;
+            break;
+        }
+        relay->stats.created++;
+    }
+    if (relay->stats.adopted + relay->stats.created == 0) {
+        dc_webhook_relay_free(relay);
+        return (create_st != DC_OK) ? create_st : DC_ERROR_UNAVAILABLE;
+    }
+
+    *out = relay;
+    return DC_OK;
+}
+
+void dc_webhook_relay_free(dc_webhook_relay_t* relay) {
+    if (!relay) return;
+    dc_relay_free_slots(relay);
+    dc_snowflake_map_free(&relay->sources);
+    dc_platform_cond_destroy(&relay->source_turn);
+    dc_platform_mutex_destroy(&relay->lock);
+    dc_string_free(&relay->name);
+    dc_free(relay);
+}
+
+/* Waits for the source's earlier sends; returns 0 without a ticket if none could be taken. */
+static int dc_relay_source_enter(dc_webhook_relay_t* relay, uint64_t source_id, dc_status_t* out_st) {
+    *out_st = DC_OK;
+    if (source_id == 0) return 1;
+    if (!dc_platform_mutex_lock(&relay->lock)) {
+        *out_st = DC_ERROR_INVALID_STATE;
+        return 0;
+    }
+    void* slot = NULL;
+    int inserted = 0;
+    dc_status_t st = dc_snowflake_map_upsert(&relay->sources, source_id, &slot, &inserted);
+    if (st != DC_OK) {
+        dc_platform_mutex_unlock(&relay->lock);
+        *out_st = st;
+        return 0;
+    }
+    dc_relay_source_t* src = (dc_relay_source_t*)slot;
+    if (inserted) memset(src, 0, sizeof(*src));
+    uint64_t ticket = src->next_ticket++;
+    if (ticket != src->serving) relay->stats.ordered_waits++;
+    /* The ticket is held until dc_relay_source_leave; a failed wait sends out of
+     * order rather than leave it unserved and stall the source's later sends. */
+    while (src && src->serving != ticket) {
+        if (!dc_platform_cond_wait(&relay->source_turn, &relay->lock)) break;
+        src = (dc_relay_source_t*)dc_snowflake_map_get(&relay->sources, source_id);
+    }
+    dc_platform_mutex_unlock(&relay->lock);
+    return 1;
+}
+
+static void dc_relay_source_leave(dc_webhook_relay_t* relay, uint64_t source_id) {
+    if (source_id == 0 || !dc_platform_mutex_lock(&relay->lock)) return;
+    dc_relay_source_t* src = (dc_relay_source_t*)dc_snowflake_map_get(&relay->sources, source_id);
+    if (src) {
+        src->serving++;
+        if (src->serving == src->next_ticket) {
+            (void)dc_snowflake_map_remove(&relay->sources, source_id, NULL);
+        } else {
+            dc_platform_cond_broadcast(&relay->source_turn);
+        }
+    }
+    dc_platform_mutex_unlock(&relay->lock);
+}
+
+/* One attempt through the best webhook; *gone_index is set when the webhook is gone. */
+static dc_status_t dc_relay_send_once(dc_webhook_relay_t* relay, const char* json_body,
+                                      dc_string_t* message_json, int64_t* gone_index) {
+    *gone_index = -1;
+    if (!dc_platform_mutex_lock(&relay->lock)) return DC_ERROR_INVALID_STATE;
+    int64_t index = dc_relay_pick(relay);
+    if (index < 0) {
+        int64_t dead = dc_relay_find_replaceable(relay, dc_relay_now_ms());
+        dc_platform_mutex_unlock(&relay->lock);
+        if (dead < 0) return DC_ERROR_UNAVAILABLE;
+        dc_relay_replace(relay, (uint32_t)dead);
+        if (!dc_platform_mutex_lock(&relay->lock)) return DC_ERROR_INVALID_STATE;
+        index = dc_relay_pick(relay);
+        if (index < 0) {
+            dc_platform_mutex_unlock(&relay->lock);
+            return DC_ERROR_UNAVAILABLE;
+        }
+    }
+
+    dc_relay_webhook_t* w = &relay->webhooks[index];
+    dc_snowflake_t id = w->id;
+    dc_string_t token;
+    dc_status_t st = dc_string_init_from_cstr(&token, dc_string_cstr(&w->token));
+    if (st != DC_OK) {
+        dc_platform_mutex_unlock(&relay->lock);
+        return st;
+    }
+    w->in_flight++;
+    w->last_pick = ++relay->pick_seq;
+    relay->stats.in_flight++;
+    dc_platform_mutex_unlock(&relay->lock);
+
+    st = dc_client_execute_webhook_json(relay->client, id, dc_string_cstr(&token), json_body,
+                                        message_json != NULL, message_json);
+    dc_string_free(&token);
+
+    if (dc_platform_mutex_lock(&relay->lock)) {
+        w->in_flight--;
+        relay->stats.in_flight--;
+        /* Another sender may have found it gone already. */
+        if (dc_relay_is_gone(st) && w->state == DC_RELAY_ACTIVE && w->id == id) {
+            w->state = DC_RELAY_DEAD;
+            w->retry_at_ms = 0;
+            relay->stats.lost++;
+        }
+        if (dc_relay_is_gone(st)) *gone_index = index;
+        dc_platform_mutex_unlock(&relay->lock);
+    }
+    return st;
+}
+
+dc_status_t dc_webhook_relay_send(dc_webhook_relay_t* relay, uint64_t source_id,
+                                  const char* json_body, dc_string_t* message_json) {
+    if (!relay || !json_body) return DC_ERROR_NULL_POINTER;
+    if (json_body[0] == '\0') return DC_ERROR_INVALID_PARAM;
+
+    dc_status_t st = DC_OK;
+    if (!dc_relay_source_enter(relay, source_id, &st)) return st;
+
+    for (uint32_t attempt = 1; ; attempt++) {
+        int64_t gone_index = -1;
+        st = dc_relay_send_once(relay, json_body, message_json, &gone_index);
+        if (gone_index < 0 || attempt >= relay->max_attempts) break;
+        dc_relay_replace(relay, (uint32_t)gone_index);
+    }
+
+    if (dc_platform_mutex_lock(&relay->lock)) {
+        if (st == DC_OK) {
+            relay->stats.sends++;
+        } else {
+            relay->stats.failures++;
+        }
+        dc_platform_mutex_unlock(&relay->lock);
+    }
+    dc_relay_source_leave(relay, source_id);
+    return st;
+}
+
+dc_status_t dc_webhook_relay_get_stats(dc_webhook_relay_t* relay, dc_webhook_relay_stats_t* out) {
+    if (!relay || !out) return DC_ERROR_NULL_POINTER;
+    if (!dc_platform_mutex_lock(&relay->lock)) return DC_ERROR_INVALID_STATE;
+    *out = relay->stats;
+    out->webhooks = 0;
+    for (uint32_t i = 0; i < relay->count; i++) {
+        if (relay->webhooks[i].state == DC_RELAY_ACTIVE) out->webhooks++;
+    }
+    dc_platform_mutex_unlock(&relay->lock);
+    return DC_OK;
+}
@@ -0,0 +1,125 @@
+#ifndef DC_WEBHOOK_RELAY_H
+#define DC_WEBHOOK_RELAY_H
+
+/**
+ * @file dc_webhook_relay.h
+ * @brief Webhook pool for relaying messages into one channel
+ *
+ * Bridges and relay bots post messages from many users into one channel
+ * through webhook executes with per-message username/avatar overrides. Each
+ * webhook has its own rate limit bucket, so a single webhook caps the relay
+ * rate. The pool owns several webhooks of the target channel and sends each
+ * message through the one with the most bucket budget left, counting sends
+ * still in flight.
+ *
+ * Sends with the same source ID are delivered in the order
+ * dc_webhook_relay_send was called: a send waits until the previous send of
+ * its source has finished. When a webhook turns out to be deleted (or its
+ * token revoked), the pool replaces it and retries the message on another
+ * webhook.
+ *
+ * Thread-safe: any number of threads may send concurrently.
+ */
+
+#include <stdint.h>
+#include "core/dc_status.h"
+#include "core/dc_string.h"
+#include "core/dc_snowflake.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct dc_client dc_client_t;
+
+/**
+ * @brief Relay pool configuration
+ */
+typedef struct {
+    dc_snowflake_t channel_id;  /**< Target channel (required) */
+    uint32_t webhook_count;     /**< Webhooks to spread sends over (Discord allows 15 per channel) */
+    const char* webhook_name;   /**< Name of the pool's webhooks; existing ones with it are reused */
+    uint32_t max_attempts;      /**< Webhooks tried per message when one is gone */
+} dc_webhook_relay_config_t;
+
+/**
+ * @brief Relay pool counters
+ */
+typedef struct {
+    uint64_t sends;             /**< Messages delivered */
+    uint64_t failures;          /**< Messages that could not be delivered */
+    uint64_t ordered_waits;     /**< Sends that waited for an earlier send of their source */
+    uint64_t adopted;           /**< Existing webhooks taken over at creation */
+    uint64_t created;           /**< Webhooks created (initially and as replacements) */
+    uint64_t lost;              /**< Webhooks found deleted or with a revoked token */
+    uint32_t webhooks;          /**< Usable webhooks */
+    uint32_t in_flight;         /**< Sends currently in flight */
+} dc_webhook_relay_stats_t;
+
+/**
+ * @brief Relay pool (opaque)
+ */
+typedef struct dc_webhook_relay dc_webhook_relay_t;
+
+/**
+ * @brief Initialize a relay pool configuration with defaults
+ *
+ * Defaults:
+ * - webhook_count: 4
+ * - webhook_name: "Relay"
+ * - max_attempts: 3
+ */
+void dc_webhook_relay_config_init(dc_webhook_relay_config_t* config);
+
+/**
+ * @brief Create a relay pool for a channel
+ *
+ * Lists the channel's webhooks and reuses incoming webhooks named
+ * webhook_name; the rest are created (needs MANAGE_WEBHOOKS). Creation fails
+ * only if no webhook could be obtained.
+ *
+ * @param client Discord client (its REST client is shared by the senders)
+ * @param config Configuration
+ * @param out Pointer to store created pool
+ * @return DC_OK on success, error code on failure
+ */
+dc_status_t dc_webhook_relay_create(dc_client_t* client, const dc_webhook_relay_config_t* config,
+                                    dc_webhook_relay_t** out);
+
+/**
+ * @brief Free the pool
+ *
+ * The webhooks stay in the channel so the next pool can reuse them. No
+ * send may be in progress.
+ *
+ * @param relay Pool to free (may be NULL)
+ */
+void dc_webhook_relay_free(dc_webhook_relay_t* relay);
+
+/**
+ * @brief Relay one message
+ *
+ * Blocks until the message is delivered or failed.
+ *
+ * @param relay Pool
+ * @param source_id Ordering key (e.g. the source user or channel); 0 for no ordering
+ * @param json_body Execute webhook JSON (content, username, avatar_url, ...)
+ * @param message_json Output message JSON (optional; waits for the message when given)
+ * @return DC_OK on success, error code on failure
+ */
+dc_status_t dc_webhook_relay_send(dc_webhook_relay_t* relay, uint64_t source_id,
+                                  const char* json_body, dc_string_t* message_json);
+
+/**
+ * @brief Get the pool counters
+ * @param relay Pool
+ * @param out Receives the counters
+ * @return DC_OK on success, error code on failure
+ */
+dc_status_t dc_webhook_relay_get_stats(dc_webhook_relay_t* relay, dc_webhook_relay_stats_t* out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DC_WEBHOOK_RELAY_H */
@@ -205,3 +205,18 @@ if(FISHYDS_USE_GLIB_ALLOC)
             "or set FISHYDS_GLIB_INCLUDE_DIR, FISHYDS_GLIB_CONFIG_INCLUDE_DIR, and FISHYDS_GLIB_LIBRARY.")
     endif()
 endif()
+
+# OpenSSL (optional; lets TLS session counters tell resumed handshakes from full ones)
+set(FISHYDS_OPENSSL_FOUND FALSE)
+find_package(OpenSSL QUIET)
+if(TARGET OpenSSL::SSL)
+    list(APPEND FISHYDS_DEP_LINK_LIBS OpenSSL::SSL)
+    set(FISHYDS_OPENSSL_FOUND TRUE)
+endif()
+
+# Threads (interactions server worker pool, hedged REST sends, command deployment,
+# interaction watchdog, role coalescer)
+if(UNIX)
+    find_package(Threads REQUIRED)
+    list(APPEND FISHYDS_DEP_LINK_LIBS Threads::Threads)
+endif()
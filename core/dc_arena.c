@@ -0,0 +1,136 @@
+/**
+ * @file dc_arena.c
+ * @brief Bump allocator implementation
+ */
+
+#include "dc_arena.h"
+#include "dc_alloc.h"
+#include <stdalign.h>
+#include <stdint.h>
+#include <string.h>
+
+#define DC_ARENA_ALIGN ((size_t)alignof(max_align_t))
+
+struct dc_arena_block {
+    dc_arena_block_t* next;
+    size_t size;    /* usable bytes after the header */
+    size_t used;
+};
+
+/* Header rounded up so block data starts aligned for any type. */
+#define DC_ARENA_HEADER_SIZE \
+    ((sizeof(dc_arena_block_t) + DC_ARENA_ALIGN - 1u) & ~(DC_ARENA_ALIGN - 1u))
+
+static unsigned char* dc_arena_block_data(dc_arena_block_t* block) {
+    return (unsigned char*)block + DC_ARENA_HEADER_SIZE;
+}
+
+static dc_arena_block_t* dc_arena_block_new(size_t size) {
+    if (size > SIZE_MAX - DC_ARENA_HEADER_SIZE) return NULL;
+    dc_arena_block_t* block = (dc_arena_block_t*)dc_alloc(DC_ARENA_HEADER_SIZE + size);
+    if (!block) return NULL;
+    block->next = NULL;
+    block->size = size;
+    block->used = 0;
+    return block;
+}
+
+dc_status_t dc_arena_init(dc_arena_t* arena, size_t block_size) {
+    if (!arena) return DC_ERROR_NULL_POINTER;
+    arena->head = NULL;
+    arena->block_size = block_size ? block_size : DC_ARENA_DEFAULT_BLOCK_SIZE;
+    return DC_OK;
+}
+
+void dc_arena_free(dc_arena_t* arena) {
+    if (!arena) return;
+    dc_arena_block_t* block = arena->head;
+    while (block) {
+        dc_arena_block_t* next = block->next;
+        dc_free(block);
+        block = next;
+    }
+    arena->head = NULL;
+}
+
+void dc_arena_reset(dc_arena_t* arena) {
+    if (!arena) return;
+    dc_arena_block_t* keep = NULL;
+    dc_arena_block_t* block = arena->head;
+    while (block) {
+        dc_arena_block_t* next = block->next;
+        if (!keep && block->size == arena->block_size) {
+            keep = block;
+        } else {
+            dc_free(block);
+        }
+        block = next;
+    }
+    if (keep) {
+        keep->next = NULL;
+        keep->used = 0;
+    }
+    arena->head = keep;
+}
+
+void* dc_arena_alloc(dc_arena_t* arena, size_t size) {
+    if (!arena || size == 0) return NULL;
+    if (size > SIZE_MAX - DC_ARENA_ALIGN) return NULL;
+    size_t rounded = (size + DC_ARENA_ALIGN - 1u) & ~(DC_ARENA_ALIGN - 1u);
+
+    dc_arena_block_t* block = arena->head;
+    if (!block || block->size - block->used < rounded) {
+        if (rounded > arena->block_size / 4u) {
+            /* Oversized: own block behind the current one, which stays in use */
+            dc_arena_block_t* big = dc_arena_block_new(rounded);
+            if (!big) return NULL;
+            big->used = rounded;
+            if (block) {
+                big->next = block->next;
+                block->next = big;
+            } else {
+                arena->head = big;
+            }
+            memset(dc_arena_block_data(big), 0, rounded);
+            return dc_arena_block_data(big);
+        }
+        block = dc_arena_block_new(arena->block_size);
+        if (!block) return NULL;
+        block->next = arena->head;
+        arena->head = block;
+    }
+
+    unsigned char* ptr = dc_arena_block_data(block) + block->used;
+    block->used += rounded;
+    memset(ptr, 0, size);
+    return ptr;
+}
+
+void* dc_arena_calloc(dc_arena_t* arena, size_t count, size_t size) {
+    if (count == 0 || size == 0) return NULL;
+    if (count > SIZE_MAX / size) return NULL;
+    return dc_arena_alloc(arena, count * size);
+}
+
+char* dc_arena_strndup(dc_arena_t* arena, const char* str, size_t length) {
+    if (!str || length == SIZE_MAX) return NULL;
+    char* copy = (char*)dc_arena_alloc(arena, length + 1u);
+    if (!copy) return NULL;
+    memcpy(copy, str, length);
+    copy[length] = '\0';
+    return copy;
+}
+
+char* dc_arena_strdup(dc_arena_t* arena, const char* str) {
+    if (!str) return NULL;
+    return dc_arena_strndup(arena, str, strlen(str));
+}
+
+size_t dc_arena_capacity(const dc_arena_t* arena) {
+    if (!arena) return 0;
+    size_t total = 0;
+    for (const dc_arena_block_t* block = arena->head; block; block = block->next) {
+        total += block->size;
+    }
+    return total;
+}
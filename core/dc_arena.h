@@ -0,0 +1,101 @@
+#ifndef DC_ARENA_H
+#define DC_ARENA_H
+
+/**
+ * @file dc_arena.h
+ * @brief Bump allocator for short-lived object trees
+ *
+ * Allocations come from large blocks and are released all at once with
+ * dc_arena_reset() or dc_arena_free(); there is no per-object free. Reset
+ * keeps one block, so an arena reused for similar trees stops allocating
+ * after the first one.
+ */
+
+#include <stddef.h>
+#include "dc_status.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define DC_ARENA_DEFAULT_BLOCK_SIZE 4096u
+
+typedef struct dc_arena_block dc_arena_block_t;
+
+/**
+ * @brief Arena allocator
+ */
+typedef struct {
+    dc_arena_block_t* head;   /**< Block currently allocated from (newest first) */
+    size_t block_size;        /**< Size of regular blocks */
+} dc_arena_t;
+
+/**
+ * @brief Initialize an empty arena (allocates nothing)
+ * @param arena Arena to initialize
+ * @param block_size Block size in bytes (0 = DC_ARENA_DEFAULT_BLOCK_SIZE)
+ * @return DC_OK on success, error code on failure
+ */
+dc_status_t dc_arena_init(dc_arena_t* arena, size_t block_size);
+
+/**
+ * @brief Free all blocks
+ * @param arena Arena to free
+ */
+void dc_arena_free(dc_arena_t* arena);
+
+/**
+ * @brief Release every allocation, keeping one block for reuse
+ * @param arena Arena to reset
+ */
+void dc_arena_reset(dc_arena_t* arena);
+
+/**
+ * @brief Allocate zeroed memory aligned for any type
+ *
+ * Requests larger than a quarter block get a block of their own.
+ *
+ * @param arena Arena
+ * @param size Size in bytes
+ * @return Pointer, or NULL for size 0 or out of memory
+ */
+void* dc_arena_alloc(dc_arena_t* arena, size_t size);
+
+/**
+ * @brief Allocate a zeroed array
+ * @param arena Arena
+ * @param count Element count
+ * @param size Element size
+ * @return Pointer, or NULL for an empty array, overflow or out of memory
+ */
+void* dc_arena_calloc(dc_arena_t* arena, size_t count, size_t size);
+
+/**
+ * @brief Copy @p length bytes of @p str and NUL-terminate
+ * @param arena Arena
+ * @param str Source (may hold embedded NULs)
+ * @param length Bytes to copy
+ * @return Copy, or NULL on out of memory
+ */
+char* dc_arena_strndup(dc_arena_t* arena, const char* str, size_t length);
+
+/**
+ * @brief Copy a NUL-terminated string
+ * @param arena Arena
+ * @param str Source string
+ * @return Copy, or NULL if @p str is NULL or out of memory
+ */
+char* dc_arena_strdup(dc_arena_t* arena, const char* str);
+
+/**
+ * @brief Bytes held in blocks (for statistics)
+ * @param arena Arena
+ * @return Total block capacity
+ */
+size_t dc_arena_capacity(const dc_arena_t* arena);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DC_ARENA_H */
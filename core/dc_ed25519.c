@@ -0,0 +1,680 @@
+/**
+ * @file dc_ed25519.c
+ * @brief Ed25519 signature verification (RFC 8032)
+ */
+
+#include "dc_ed25519.h"
+#include <string.h>
+#include <stdint.h>
+
+/* ---------------------------------------------------------------------------
+ * SHA-512 (FIPS 180-4)
+ * ------------------------------------------------------------------------- */
+
+typedef struct {
+    uint64_t state[8];
+    uint64_t bytes;
+    uint8_t block[128];
+    size_t used;
+} dc_sha512_t;
+
+static const uint64_t dc_sha512_k[80] = {
+    0x428a2f98d728ae22ULL, 0x7137449123ef65cdULL, 0xb5c0fbcfec4d3b2fULL, 0xe9b5dba58189dbbcULL,
+    0x3956c25bf348b538ULL, 0x59f111f1b605d019ULL, 0x923f82a4af194f9bULL, 0xab1c5ed5da6d8118ULL,
+    0xd807aa98a3030242ULL, 0x12835b0145706fbeULL, 0x243185be4ee4b28cULL, 0x550c7dc3d5ffb4e2ULL,
+    0x72be5d74f27b896fULL, 0x80deb1fe3b1696b1ULL, 0x9bdc06a725c71235ULL, 0xc19bf174cf692694ULL,
+    0xe49b69c19ef14ad2ULL, 0xefbe4786384f25e3ULL, 0x0fc19dc68b8cd5b5ULL, 0x240ca1cc77ac9c65ULL,
+    0x2de92c6f592b0275ULL, 0x4a7484aa6ea6e483ULL, 0x5cb0a9dcbd41fbd4ULL, 0x76f988da831153b5ULL,
+    0x983e5152ee66dfabULL, 0xa831c66d2db43210ULL, 0xb00327c898fb213fULL, 0xbf597fc7beef0ee4ULL,
+    0xc6e00bf33da88fc2ULL, 0xd5a79147930aa725ULL, 0x06ca6351e003826fULL, 0x142929670a0e6e70ULL,
+    0x27b70a8546d22ffcULL, 0x2e1b21385c26c926ULL, 0x4d2c6dfc5ac42aedULL, 0x53380d139d95b3dfULL,
+    0x650a73548baf63deULL, 0x766a0abb3c77b2a8ULL, 0x81c2c92e47edaee6ULL, 0x92722c851482353bULL,
+    0xa2bfe8a14cf10364ULL, 0xa81a664bbc423001ULL, 0xc24b8b70d0f89791ULL, 0xc76c51a30654be30ULL,
+    0xd192e819d6ef5218ULL, 0xd69906245565a910ULL, 0xf40e35855771202aULL, 0x106aa07032bbd1b8ULL,
+    0x19a4c116b8d2d0c8ULL, 0x1e376c085141ab53ULL, 0x2748774cdf8eeb99ULL, 0x34b0bcb5e19b48a8ULL,
+    0x391c0cb3c5c95a63ULL, 0x4ed8aa4ae3418acbULL, 0x5b9cca4f7763e373ULL, 0x682e6ff3d6b2b8a3ULL,
+    0x748f82ee5defb2fcULL, 0x78a5636f43172f60ULL, 0x84c87814a1f0ab72ULL, 0x8cc702081a6439ecULL,
+    0x90befffa23631e28ULL, 0xa4506cebde82bde9ULL, 0xbef9a3f7b2c67915ULL, 0xc67178f2e372532bULL,
+    0xca273eceea26619cULL, 0xd186b8c721c0c207ULL, 0xeada7dd6cde0eb1eULL, 0xf57d4f7fee6ed178ULL,
+    0x06f067aa72176fbaULL, 0x0a637dc5a2c898a6ULL, 0x113f9804bef90daeULL, 0x1b710b35131c471bULL,
+    0x28db77f523047d84ULL, 0x32caab7b40c72493ULL, 0x3c9ebe0a15c9bebcULL, 0x431d67c49c100d4cULL,
+    0x4cc5d4becb3e42b6ULL, 0x597f299cfc657e2aULL, 0x5fcb6fab3ad6faecULL, 0x6c44198c4a475817ULL
+};
+
+static uint64_t dc_sha512_rotr(uint64_t x, unsigned n) {
+    return (x >> n) | (x << (64u - n));
+}
+
+static void dc_sha512_compress(dc_sha512_t* ctx, const uint8_t* block) {
+    uint64_t w[80];
+    for (size_t i = 0; i < 16; i++) {
+        uint64_t v = 0;
+        for (size_t b = 0; b < 8; b++) v = (v << 8) | block[i * 8 + b];
+        w[i] = v;
+    }
+    for (size_t i = 16; i < 80; i++) {
+        uint64_t s0 = dc_sha512_rotr(w[i - 15], 1) ^ dc_sha512_rotr(w[i - 15], 8) ^ (w[i - 15] >> 7);
+        uint64_t s1 = dc_sha512_rotr(w[i - 2], 19) ^ dc_sha512_rotr(w[i - 2], 61) ^ (w[i - 2] >> 6);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+
+    uint64_t a = ctx->state[0], b = ctx->state[1], c = ctx->state[2], d = ctx->state[3];
+    uint64_t e = ctx->state[4], f = ctx->state[5], g = ctx->state[6], h = ctx->state[7];
+    for (size_t i = 0; i < 80; i++) {
+        uint64_t s1 = dc_sha512_rotr(e, 14) ^ dc_sha512_rotr(e, 18) ^ dc_sha512_rotr(e, 41);
+        uint64_t ch = (e & f) ^ (~e & g);
+        uint64_t t1 = h + s1 + ch + dc_sha512_k[i] + w[i];
+        uint64_t s0 = dc_sha512_rotr(a, 28) ^ dc_sha512_rotr(a, 34) ^ dc_sha512_rotr(a, 39);
+        uint64_t maj = (a & b) ^ (a & c) ^ (b & c);
+        uint64_t t2 = s0 + maj;
+        h = g;
+        g = f;
+        f = e;
+        e = d + t1;
+        d = c;
+        c = b;
+        b = a;
+        a = t1 + t2;
+    }
+    ctx->state[0] += a;
+    ctx->state[1] += b;
+    ctx->state[2] += c;
+    ctx->state[3] += d;
+    ctx->state[4] += e;
+    ctx->state[5] += f;
+    ctx->state[6] += g;
+    ctx->state[7] += h;
+}
+
+static void dc_sha512_init(dc_sha512_t* ctx) {
+    static const uint64_t iv[8] = {
+        0x6a09e667f3bcc908ULL, 0xbb67ae8584caa73bULL, 0x3c6ef372fe94f82bULL, 0xa54ff53a5f1d36f1ULL,
+        0x510e527fade682d1ULL, 0x9b05688c2b3e6c1fULL, 0x1f83d9abfb41bd6bULL, 0x5be0cd19137e2179ULL
+    };
+    memcpy(ctx->state, iv, sizeof(iv));
+    ctx->bytes = 0;
+    ctx->used = 0;
+}
+
+static void dc_sha512_update(dc_sha512_t* ctx, const void* data, size_t len) {
+    const uint8_t* p = (const uint8_t*)data;
+    ctx->bytes += len;
+    if (ctx->used > 0) {
+        size_t take = sizeof(ctx->block) - ctx->used;
+        if (take > len) take = len;
+        memcpy(ctx->block + ctx->used, p, take);
+        ctx->used += take;
+        p += take;
+        len -= take;
+        if (ctx->used < sizeof(ctx->block)) return;
+        dc_sha512_compress(ctx, ctx->block);
+        ctx->used = 0;
+    }
+    while (len >= sizeof(ctx->block)) {
+        dc_sha512_compress(ctx, p);
+        p += sizeof(ctx->block);
+        len -= sizeof(ctx->block);
+    }
+    if (len > 0) {
+        memcpy(ctx->block, p, len);
+        ctx->used = len;
+    }
+}
+
+static void dc_sha512_final(dc_sha512_t* ctx, uint8_t out[64]) {
+    uint64_t bits = ctx->bytes * 8u;
+    ctx->block[ctx->used++] = 0x80;
+    if (ctx->used > sizeof(ctx->block) - 16u) {
+        memset(ctx->block + ctx->used, 0, sizeof(ctx->block) - ctx->used);
+        dc_sha512_compress(ctx, ctx->block);
+        ctx->used = 0;
+    }
+    memset(ctx->block + ctx->used, 0, sizeof(ctx->block) - ctx->used);
+    /* Messages stay far below 2^64 bits, so the high length word is zero. */
+    for (size_t b = 0; b < 8; b++) ctx->block[127 - b] = (uint8_t)(bits >> (8 * b));
+    dc_sha512_compress(ctx, ctx->block);
+    for (size_t i = 0; i < 8; i++) {
+        for (size_t b = 0; b < 8; b++) out[i * 8 + b] = (uint8_t)(ctx->state[i] >> (56 - 8 * b));
+    }
+}
+
+/* ---------------------------------------------------------------------------
+ * Field arithmetic mod p = 2^255 - 19, ten signed limbs of 26/25 bits
+ * ------------------------------------------------------------------------- */
+
+typedef int64_t dc_fe_t[10];
+
+static const unsigned dc_fe_bits[10] = { 26, 25, 26, 25, 26, 25, 26, 25, 26, 25 };
+static const unsigned dc_fe_offset[10] = { 0, 26, 51, 77, 102, 128, 153, 179, 204, 230 };
+
+static const dc_fe_t dc_fe_d = {
+    56195235, 13857412, 51736253, 6949390, 114729, 24766616, 60832955, 30306712, 48412415, 21499315
+};
+static const dc_fe_t dc_fe_d2 = {
+    45281625, 27714825, 36363642, 13898781, 229458, 15978800, 54557047, 27058993, 29715967, 9444199
+};
+static const dc_fe_t dc_fe_sqrtm1 = {
+    34513072, 25610706, 9377949, 3500415, 12389472, 33281959, 41962654, 31548777, 326685, 11406482
+};
+static const dc_fe_t dc_fe_base_x = {
+    52811034, 25909283, 16144682, 17082669, 27570973, 30858332, 40966398, 8378388, 20764389, 8758491
+};
+static const dc_fe_t dc_fe_base_y = {
+    40265304, 26843545, 13421772, 20132659, 26843545, 6710886, 53687091, 13421772, 40265318, 26843545
+};
+
+static void dc_fe_copy(dc_fe_t h, const dc_fe_t f) {
+    memcpy(h, f, sizeof(dc_fe_t));
+}
+
+static void dc_fe_set(dc_fe_t h, int64_t v) {
+    memset(h, 0, sizeof(dc_fe_t));
+    h[0] = v;
+}
+
+/*
+ * One rounding carry pass plus a second step on limb 0 (which absorbed
+ * 19 * carry9) brings every limb back to about +/-2^25.
+ */
+static void dc_fe_carry(int64_t* h) {
+#define DC_FE_CARRY(i, bits, next, factor)                                  \
+    do {                                                                    \
+        int64_t c = (h[i] + ((int64_t)1 << ((bits) - 1))) >> (bits);        \
+        h[i] -= c * ((int64_t)1 << (bits));                                 \
+        h[next] += (factor) * c;                                            \
+    } while (0)
+    DC_FE_CARRY(0, 26, 1, 1);
+    DC_FE_CARRY(1, 25, 2, 1);
+    DC_FE_CARRY(2, 26, 3, 1);
+    DC_FE_CARRY(3, 25, 4, 1);
+    DC_FE_CARRY(4, 26, 5, 1);
+    DC_FE_CARRY(5, 25, 6, 1);
+    DC_FE_CARRY(6, 26, 7, 1);
+    DC_FE_CARRY(7, 25, 8, 1);
+    DC_FE_CARRY(8, 26, 9, 1);
+    DC_FE_CARRY(9, 25, 0, 19);
+    DC_FE_CARRY(0, 26, 1, 1);
+#undef DC_FE_CARRY
+}
+
+/*
+ * Sums and differences are left uncarried: the point formulas combine at
+ * most four carried values before the next multiplication, which keeps
+ * every limb below 2^27.5 and the product accumulators below 2^63.
+ */
+static void dc_fe_add(dc_fe_t h, const dc_fe_t f, const dc_fe_t g) {
+    for (size_t i = 0; i < 10; i++) h[i] = f[i] + g[i];
+}
+
+static void dc_fe_sub(dc_fe_t h, const dc_fe_t f, const dc_fe_t g) {
+    for (size_t i = 0; i < 10; i++) h[i] = f[i] - g[i];
+}
+
+static void dc_fe_neg(dc_fe_t h, const dc_fe_t f) {
+    for (size_t i = 0; i < 10; i++) h[i] = -f[i];
+}
+
+/*
+ * Schoolbook product. Limb i weighs 2^ceil(25.5 i): odd*odd products carry an
+ * extra factor 2, and anything at or above limb 10 wraps with factor 19.
+ */
+static void dc_fe_mul(dc_fe_t h, const dc_fe_t f, const dc_fe_t g) {
+    int64_t g19[10];
+    int64_t f2[10];
+    int64_t t[10];
+    for (size_t i = 0; i < 10; i++) {
+        g19[i] = 19 * g[i];
+        f2[i] = 2 * f[i];
+    }
+    t[0] = f[0] * g[0] + f2[1] * g19[9] + f[2] * g19[8] + f2[3] * g19[7] + f[4] * g19[6]
+         + f2[5] * g19[5] + f[6] * g19[4] + f2[7] * g19[3] + f[8] * g19[2] + f2[9] * g19[1];
+    t[1] = f[0] * g[1] + f[1] * g[0] + f[2] * g19[9] + f[3] * g19[8] + f[4] * g19[7]
+         + f[5] * g19[6] + f[6] * g19[5] + f[7] * g19[4] + f[8] * g19[3] + f[9] * g19[2];
+    t[2] = f[0] * g[2] + f2[1] * g[1] + f[2] * g[0] + f2[3] * g19[9] + f[4] * g19[8]
+         + f2[5] * g19[7] + f[6] * g19[6] + f2[7] * g19[5] + f[8] * g19[4] + f2[9] * g19[3];
+    t[3] = f[0] * g[3] + f[1] * g[2] + f[2] * g[1] + f[3] * g[0] + f[4] * g19[9]
+         + f[5] * g19[8] + f[6] * g19[7] + f[7] * g19[6] + f[8] * g19[5] + f[9] * g19[4];
+    t[4] = f[0] * g[4] + f2[1] * g[3] + f[2] * g[2] + f2[3] * g[1] + f[4] * g[0]
+         + f2[5] * g19[9] + f[6] * g19[8] + f2[7] * g19[7] + f[8] * g19[6] + f2[9] * g19[5];
+    t[5] = f[0] * g[5] + f[1] * g[4] + f[2] * g[3] + f[3] * g[2] + f[4] * g[1]
+         + f[5] * g[0] + f[6] * g19[9] + f[7] * g19[8] + f[8] * g19[7] + f[9] * g19[6];
+    t[6] = f[0] * g[6] + f2[1] * g[5] + f[2] * g[4] + f2[3] * g[3] + f[4] * g[2]
+         + f2[5] * g[1] + f[6] * g[0] + f2[7] * g19[9] + f[8] * g19[8] + f2[9] * g19[7];
+    t[7] = f[0] * g[7] + f[1] * g[6] + f[2] * g[5] + f[3] * g[4] + f[4] * g[3]
+         + f[5] * g[2] + f[6] * g[1] + f[7] * g[0] + f[8] * g19[9] + f[9] * g19[8];
+    t[8] = f[0] * g[8] + f2[1] * g[7] + f[2] * g[6] + f2[3] * g[5] + f[4] * g[4]
+         + f2[5] * g[3] + f[6] * g[2] + f2[7] * g[1] + f[8] * g[0] + f2[9] * g19[9];
+    t[9] = f[0] * g[9] + f[1] * g[8] + f[2] * g[7] + f[3] * g[6] + f[4] * g[5]
+         + f[5] * g[4] + f[6] * g[3] + f[7] * g[2] + f[8] * g[1] + f[9] * g[0];
+    dc_fe_carry(t);
+    memcpy(h, t, sizeof(t));
+}
+
+/* Same product with the symmetric terms folded: 55 multiplications instead of 100. */
+static void dc_fe_sq(dc_fe_t h, const dc_fe_t f) {
+    int64_t f2[10];
+    int64_t f19[10];
+    int64_t f38[10];
+    int64_t t[10];
+    for (size_t i = 0; i < 10; i++) {
+        f2[i] = 2 * f[i];
+        f19[i] = 19 * f[i];
+        f38[i] = 38 * f[i];
+    }
+    t[0] = f[0] * f[0] + f2[1] * f38[9] + f2[2] * f19[8]
+         + f2[3] * f38[7] + f2[4] * f19[6] + f[5] * f38[5];
+    t[1] = f2[0] * f[1] + f2[2] * f19[9] + f2[3] * f19[8]
+         + f2[4] * f19[7] + f2[5] * f19[6];
+    t[2] = f2[0] * f[2] + f[1] * f2[1] + f2[3] * f38[9]
+         + f2[4] * f19[8] + f2[5] * f38[7] + f[6] * f19[6];
+    t[3] = f2[0] * f[3] + f2[1] * f[2] + f2[4] * f19[9]
+         + f2[5] * f19[8] + f2[6] * f19[7];
+    t[4] = f2[0] * f[4] + f2[1] * f2[3] + f[2] * f[2]
+         + f2[5] * f38[9] + f2[6] * f19[8] + f[7] * f38[7];
+    t[5] = f2[0] * f[5] + f2[1] * f[4] + f2[2] * f[3]
+         + f2[6] * f19[9] + f2[7] * f19[8];
+    t[6] = f2[0] * f[6] + f2[1] * f2[5] + f2[2] * f[4]
+         + f[3] * f2[3] + f2[7] * f38[9] + f[8] * f19[8];
+    t[7] = f2[0] * f[7] + f2[1] * f[6] + f2[2] * f[5]
+         + f2[3] * f[4] + f2[8] * f19[9];
+    t[8] = f2[0] * f[8] + f2[1] * f2[7] + f2[2] * f[6]
+         + f2[3] * f2[5] + f[4] * f[4] + f[9] * f38[9];
+    t[9] = f2[0] * f[9] + f2[1] * f[8] + f2[2] * f[7]
+         + f2[3] * f[6] + f2[4] * f[5];
+    dc_fe_carry(t);
+    memcpy(h, t, sizeof(t));
+}
+
+static void dc_fe_sq_n(dc_fe_t h, const dc_fe_t f, int n) {
+    dc_fe_sq(h, f);
+    for (int i = 1; i < n; i++) dc_fe_sq(h, h);
+}
+
+/* z^(2^250 - 1) and z^11 via the usual addition chain (shared by invert and sqrt). */
+static void dc_fe_pow_chain(dc_fe_t z_250_0, dc_fe_t z11, const dc_fe_t z) {
+    dc_fe_t z2, z9, t, z_5_0, z_10_0, z_20_0, z_50_0, z_100_0;
+    dc_fe_sq(z2, z);
+    dc_fe_sq_n(t, z2, 2);
+    dc_fe_mul(z9, t, z);
+    dc_fe_mul(z11, z9, z2);
+    dc_fe_sq(t, z11);
+    dc_fe_mul(z_5_0, t, z9);
+    dc_fe_sq_n(t, z_5_0, 5);
+    dc_fe_mul(z_10_0, t, z_5_0);
+    dc_fe_sq_n(t, z_10_0, 10);
+    dc_fe_mul(z_20_0, t, z_10_0);
+    dc_fe_sq_n(t, z_20_0, 20);
+    dc_fe_mul(t, t, z_20_0);
+    dc_fe_sq_n(t, t, 10);
+    dc_fe_mul(z_50_0, t, z_10_0);
+    dc_fe_sq_n(t, z_50_0, 50);
+    dc_fe_mul(z_100_0, t, z_50_0);
+    dc_fe_sq_n(t, z_100_0, 100);
+    dc_fe_mul(t, t, z_100_0);
+    dc_fe_sq_n(t, t, 50);
+    dc_fe_mul(z_250_0, t, z_50_0);
+}
+
+/* z^(p - 2) */
+static void dc_fe_invert(dc_fe_t h, const dc_fe_t z) {
+    dc_fe_t z_250_0, z11;
+    dc_fe_pow_chain(z_250_0, z11, z);
+    dc_fe_sq_n(z_250_0, z_250_0, 5);
+    dc_fe_mul(h, z_250_0, z11);
+}
+
+/* z^((p - 5) / 8) */
+static void dc_fe_pow22523(dc_fe_t h, const dc_fe_t z) {
+    dc_fe_t z_250_0, z11, t;
+    dc_fe_pow_chain(z_250_0, z11, z);
+    dc_fe_sq_n(t, z_250_0, 2);
+    dc_fe_mul(h, t, z);
+}
+
+static void dc_fe_tobytes(uint8_t s[32], const dc_fe_t f) {
+    int64_t t[10];
+    memcpy(t, f, sizeof(t));
+    dc_fe_carry(t);
+
+    /* q = floor(t / p) in {0, 1}; t + 19q then drops 2^255 to reduce fully. */
+    int64_t q = (19 * t[9] + ((int64_t)1 << 24)) >> 25;
+    for (size_t i = 0; i < 10; i++) q = (t[i] + q) >> dc_fe_bits[i];
+    t[0] += 19 * q;
+    for (size_t i = 0; i < 10; i++) {
+        int64_t c = t[i] >> dc_fe_bits[i];
+        t[i] -= c * ((int64_t)1 << dc_fe_bits[i]);
+        if (i < 9) t[i + 1] += c;
+    }
+
+    memset(s, 0, 32);
+    for (size_t i = 0; i < 10; i++) {
+        uint64_t v = (uint64_t)t[i] << (dc_fe_offset[i] & 7u);
+        for (size_t idx = dc_fe_offset[i] >> 3; v != 0 && idx < 32; idx++) {
+            s[idx] |= (uint8_t)(v & 0xffu);
+            v >>= 8;
+        }
+    }
+}
+
+static void dc_fe_frombytes(dc_fe_t h, const uint8_t s[32]) {
+    for (size_t i = 0; i < 10; i++) {
+        size_t idx = dc_fe_offset[i] >> 3;
+        uint64_t v = 0;
+        for (size_t b = 0; b < 5 && idx + b < 32; b++) v |= (uint64_t)s[idx + b] << (8 * b);
+        v >>= dc_fe_offset[i] & 7u;
+        h[i] = (int64_t)(v & (((uint64_t)1 << dc_fe_bits[i]) - 1u));
+    }
+}
+
+static int dc_fe_isneg(const dc_fe_t f) {
+    uint8_t s[32];
+    dc_fe_tobytes(s, f);
+    return s[0] & 1;
+}
+
+static int dc_fe_equal(const dc_fe_t f, const dc_fe_t g) {
+    uint8_t a[32];
+    uint8_t b[32];
+    dc_fe_tobytes(a, f);
+    dc_fe_tobytes(b, g);
+    return memcmp(a, b, sizeof(a)) == 0;
+}
+
+/* ---------------------------------------------------------------------------
+ * Points on -x^2 + y^2 = 1 + d x^2 y^2, extended coordinates (X:Y:Z:T)
+ * ------------------------------------------------------------------------- */
+
+typedef struct {
+    dc_fe_t x;
+    dc_fe_t y;
+    dc_fe_t z;
+    dc_fe_t t;
+} dc_ge_t;
+
+static void dc_ge_identity(dc_ge_t* p) {
+    dc_fe_set(p->x, 0);
+    dc_fe_set(p->y, 1);
+    dc_fe_set(p->z, 1);
+    dc_fe_set(p->t, 0);
+}
+
+/* add-2008-hwcd-3 */
+static void dc_ge_add(dc_ge_t* r, const dc_ge_t* p, const dc_ge_t* q) {
+    dc_fe_t a, b, c, d, e, f, g, h, t0, t1;
+    dc_fe_sub(t0, p->y, p->x);
+    dc_fe_sub(t1, q->y, q->x);
+    dc_fe_mul(a, t0, t1);
+    dc_fe_add(t0, p->y, p->x);
+    dc_fe_add(t1, q->y, q->x);
+    dc_fe_mul(b, t0, t1);
+    dc_fe_mul(c, p->t, q->t);
+    dc_fe_mul(c, c, dc_fe_d2);
+    dc_fe_mul(d, p->z, q->z);
+    dc_fe_add(d, d, d);
+    dc_fe_sub(e, b, a);
+    dc_fe_sub(f, d, c);
+    dc_fe_add(g, d, c);
+    dc_fe_add(h, b, a);
+    dc_fe_mul(r->x, e, f);
+    dc_fe_mul(r->y, g, h);
+    dc_fe_mul(r->t, e, h);
+    dc_fe_mul(r->z, f, g);
+}
+
+/* dbl-2008-hwcd with a = -1 */
+static void dc_ge_double(dc_ge_t* r, const dc_ge_t* p) {
+    dc_fe_t a, b, c, e, f, g, h, t0;
+    dc_fe_sq(a, p->x);
+    dc_fe_sq(b, p->y);
+    dc_fe_sq(c, p->z);
+    dc_fe_add(c, c, c);
+    dc_fe_add(t0, p->x, p->y);
+    dc_fe_sq(e, t0);
+    dc_fe_sub(e, e, a);
+    dc_fe_sub(e, e, b);
+    dc_fe_sub(g, b, a);
+    dc_fe_sub(f, g, c);
+    dc_fe_add(h, a, b);
+    dc_fe_neg(h, h);
+    dc_fe_mul(r->x, e, f);
+    dc_fe_mul(r->y, g, h);
+    dc_fe_mul(r->t, e, h);
+    dc_fe_mul(r->z, f, g);
+}
+
+static void dc_ge_tobytes(uint8_t s[32], const dc_ge_t* p) {
+    dc_fe_t zi, x, y;
+    dc_fe_invert(zi, p->z);
+    dc_fe_mul(x, p->x, zi);
+    dc_fe_mul(y, p->y, zi);
+    dc_fe_tobytes(s, y);
+    s[31] ^= (uint8_t)(dc_fe_isneg(x) << 7);
+}
+
+/* RFC 8032 5.1.3; rejects non-canonical y and non-points. */
+static int dc_ge_frombytes(dc_ge_t* p, const uint8_t s[32]) {
+    uint8_t check[32];
+    dc_fe_t u, v, v3, vxx, t;
+    int sign = s[31] >> 7;
+
+    dc_fe_frombytes(p->y, s);
+    dc_fe_tobytes(check, p->y);
+    check[31] |= (uint8_t)(sign << 7);
+    if (memcmp(check, s, 32) != 0) return 0;
+
+    dc_fe_set(p->z, 1);
+    dc_fe_sq(u, p->y);
+    dc_fe_mul(v, u, dc_fe_d);
+    dc_fe_sub(u, u, p->z);      /* u = y^2 - 1 */
+    dc_fe_add(v, v, p->z);      /* v = d y^2 + 1 */
+
+    dc_fe_sq(v3, v);
+    dc_fe_mul(v3, v3, v);       /* v^3 */
+    dc_fe_sq(t, v3);
+    dc_fe_mul(t, t, v);
+    dc_fe_mul(t, t, u);         /* u v^7 */
+    dc_fe_pow22523(t, t);
+    dc_fe_mul(t, t, v3);
+    dc_fe_mul(p->x, t, u);      /* x = u v^3 (u v^7)^((p-5)/8) */
+
+    dc_fe_sq(vxx, p->x);
+    dc_fe_mul(vxx, vxx, v);
+    if (!dc_fe_equal(vxx, u)) {
+        dc_fe_neg(t, u);
+        if (!dc_fe_equal(vxx, t)) return 0;
+        dc_fe_mul(p->x, p->x, dc_fe_sqrtm1);
+    }
+
+    uint8_t xb[32];
+    dc_fe_tobytes(xb, p->x);
+    int x_zero = 1;
+    for (size_t i = 0; i < 32; i++) {
+        if (xb[i] != 0) x_zero = 0;
+    }
+    if (x_zero && sign) return 0;
+    if ((xb[0] & 1) != sign) dc_fe_neg(p->x, p->x);
+    dc_fe_mul(p->t, p->x, p->y);
+    return 1;
+}
+
+/* table[i] = (2i + 1) P */
+static void dc_ge_odd_multiples(dc_ge_t table[8], const dc_ge_t* p) {
+    dc_ge_t p2;
+    dc_ge_double(&p2, p);
+    table[0] = *p;
+    for (size_t i = 1; i < 8; i++) dc_ge_add(&table[i], &table[i - 1], &p2);
+}
+
+/* r += digit * P for an odd digit in [-15, 15] (0 is a no-op). */
+static void dc_ge_add_digit(dc_ge_t* r, const dc_ge_t table[8], int digit) {
+    if (digit > 0) {
+        dc_ge_add(r, r, &table[digit / 2]);
+    } else if (digit < 0) {
+        dc_ge_t neg = table[-digit / 2];
+        dc_fe_neg(neg.x, neg.x);
+        dc_fe_neg(neg.t, neg.t);
+        dc_ge_add(r, r, &neg);
+    }
+}
+
+/* ---------------------------------------------------------------------------
+ * Scalars mod L = 2^252 + 27742317777372353535851937790883648493
+ * ------------------------------------------------------------------------- */
+
+static const int64_t dc_sc_l[32] = {
+    0xed, 0xd3, 0xf5, 0x5c, 0x1a, 0x63, 0x12, 0x58, 0xd6, 0x9c, 0xf7, 0xa2, 0xde, 0xf9, 0xde, 0x14,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x10
+};
+
+/* Reduce a 64-byte little-endian value mod L (byte-wise folding). */
+static void dc_sc_reduce(uint8_t out[32], const uint8_t in[64]) {
+    int64_t x[64];
+    for (size_t i = 0; i < 64; i++) x[i] = in[i];
+
+    for (size_t i = 63; i >= 32; i--) {
+        int64_t carry = 0;
+        size_t j;
+        for (j = i - 32; j < i - 12; j++) {
+            x[j] += carry - 16 * x[i] * dc_sc_l[j - (i - 32)];
+            carry = (x[j] + 128) >> 8;
+            x[j] -= carry * 256;
+        }
+        x[j] += carry;
+        x[i] = 0;
+    }
+    int64_t carry = 0;
+    for (size_t j = 0; j < 32; j++) {
+        x[j] += carry - (x[31] >> 4) * dc_sc_l[j];
+        carry = x[j] >> 8;
+        x[j] &= 255;
+    }
+    for (size_t j = 0; j < 32; j++) x[j] -= carry * dc_sc_l[j];
+    for (size_t i = 0; i < 32; i++) {
+        x[i + 1] += x[i] >> 8;
+        out[i] = (uint8_t)(x[i] & 255);
+    }
+}
+
+static int dc_sc_is_canonical(const uint8_t s[32]) {
+    for (int i = 31; i >= 0; i--) {
+        if (s[i] < dc_sc_l[i]) return 1;
+        if (s[i] > dc_sc_l[i]) return 0;
+    }
+    return 0;
+}
+
+/*
+ * Recode a scalar into odd signed digits in [-15, 15], at most one nonzero
+ * digit in any five consecutive positions.
+ */
+static void dc_sc_slide(signed char r[256], const uint8_t a[32]) {
+    for (size_t i = 0; i < 256; i++) r[i] = (signed char)((a[i >> 3] >> (i & 7)) & 1);
+    for (size_t i = 0; i < 256; i++) {
+        if (!r[i]) continue;
+        for (size_t b = 1; b <= 6 && i + b < 256; b++) {
+            if (!r[i + b]) continue;
+            int shifted = r[i + b] * (1 << b);
+            if (r[i] + shifted <= 15) {
+                r[i] = (signed char)(r[i] + shifted);
+                r[i + b] = 0;
+            } else if (r[i] - shifted >= -15) {
+                r[i] = (signed char)(r[i] - shifted);
+                for (size_t k = i + b; k < 256; k++) {
+                    if (!r[k]) {
+                        r[k] = 1;
+                        break;
+                    }
+                    r[k] = 0;
+                }
+            } else {
+                break;
+            }
+        }
+    }
+}
+
+/* ---------------------------------------------------------------------------
+ * Public API
+ * ------------------------------------------------------------------------- */
+
+static int dc_ed25519_hex_nibble(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+dc_status_t dc_ed25519_decode_hex(const char* hex, uint8_t* out, size_t out_len) {
+    if (!hex || (!out && out_len > 0)) return DC_ERROR_NULL_POINTER;
+    for (size_t i = 0; i < out_len; i++) {
+        if (hex[2 * i] == '\0' || hex[2 * i + 1] == '\0') return DC_ERROR_INVALID_FORMAT;
+        int hi = dc_ed25519_hex_nibble(hex[2 * i]);
+        int lo = dc_ed25519_hex_nibble(hex[2 * i + 1]);
+        if (hi < 0 || lo < 0) return DC_ERROR_INVALID_FORMAT;
+        out[i] = (uint8_t)((hi << 4) | lo);
+    }
+    if (hex[2 * out_len] != '\0') return DC_ERROR_INVALID_FORMAT;
+    return DC_OK;
+}
+
+dc_status_t dc_ed25519_verify_prefixed(const uint8_t public_key[DC_ED25519_PUBLIC_KEY_SIZE],
+                                       const uint8_t signature[DC_ED25519_SIGNATURE_SIZE],
+                                       const void* prefix, size_t prefix_len,
+                                       const void* message, size_t message_len) {
+    if (!public_key || !signature) return DC_ERROR_NULL_POINTER;
+    if ((!prefix && prefix_len > 0) || (!message && message_len > 0)) return DC_ERROR_NULL_POINTER;
+
+    dc_ge_t a;
+    if (!dc_ge_frombytes(&a, public_key)) return DC_ERROR_INVALID_PARAM;
+    const uint8_t* s = signature + 32;
+    if (!dc_sc_is_canonical(s)) return DC_ERROR_UNAUTHORIZED;
+
+    uint8_t digest[64];
+    uint8_t h[32];
+    dc_sha512_t sha;
+    dc_sha512_init(&sha);
+    dc_sha512_update(&sha, signature, 32);
+    dc_sha512_update(&sha, public_key, 32);
+    if (prefix_len > 0) dc_sha512_update(&sha, prefix, prefix_len);
+    if (message_len > 0) dc_sha512_update(&sha, message, message_len);
+    dc_sha512_final(&sha, digest);
+    dc_sc_reduce(h, digest);
+
+    /* R' = [S]B - [h]A, sharing one doubling chain over signed sliding windows. */
+    dc_ge_t b, neg_a, r;
+    dc_ge_t b_odd[8];
+    dc_ge_t a_odd[8];
+    signed char s_digits[256];
+    signed char h_digits[256];
+    dc_fe_copy(b.x, dc_fe_base_x);
+    dc_fe_copy(b.y, dc_fe_base_y);
+    dc_fe_set(b.z, 1);
+    dc_fe_mul(b.t, b.x, b.y);
+    dc_fe_neg(neg_a.x, a.x);
+    dc_fe_copy(neg_a.y, a.y);
+    dc_fe_copy(neg_a.z, a.z);
+    dc_fe_neg(neg_a.t, a.t);
+    dc_ge_odd_multiples(b_odd, &b);
+    dc_ge_odd_multiples(a_odd, &neg_a);
+    dc_sc_slide(s_digits, s);
+    dc_sc_slide(h_digits, h);
+
+    int top = 255;
+    while (top >= 0 && s_digits[top] == 0 && h_digits[top] == 0) top--;
+    dc_ge_identity(&r);
+    for (int i = top; i >= 0; i--) {
+        dc_ge_double(&r, &r);
+        dc_ge_add_digit(&r, b_odd, s_digits[i]);
+        dc_ge_add_digit(&r, a_odd, h_digits[i]);
+    }
+
+    uint8_t encoded[32];
+    dc_ge_tobytes(encoded, &r);
+    return memcmp(encoded, signature, 32) == 0 ? DC_OK : DC_ERROR_UNAUTHORIZED;
+}
+
+dc_status_t dc_ed25519_verify(const uint8_t public_key[DC_ED25519_PUBLIC_KEY_SIZE],
+                              const uint8_t signature[DC_ED25519_SIGNATURE_SIZE],
+                              const void* message, size_t message_len) {
+    return dc_ed25519_verify_prefixed(public_key, signature, NULL, 0, message, message_len);
+}
@@ -0,0 +1,66 @@
+#ifndef DC_ED25519_H
+#define DC_ED25519_H
+
+/**
+ * @file dc_ed25519.h
+ * @brief Ed25519 signature verification (RFC 8032)
+ *
+ * Self-contained verifier used to authenticate Discord HTTP interactions
+ * (X-Signature-Ed25519 over X-Signature-Timestamp + body). Verification only:
+ * no signing and no secret-key handling, so nothing here needs to be
+ * constant-time.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include "core/dc_status.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define DC_ED25519_PUBLIC_KEY_SIZE 32   /**< Encoded public key size in bytes */
+#define DC_ED25519_SIGNATURE_SIZE 64    /**< Signature size in bytes */
+
+/**
+ * @brief Decode a hex string of exactly 2 * @p out_len characters
+ * @param hex Hex string (either case)
+ * @param out Output bytes
+ * @param out_len Expected byte count
+ * @return DC_OK on success, DC_ERROR_INVALID_FORMAT on bad length or characters
+ */
+dc_status_t dc_ed25519_decode_hex(const char* hex, uint8_t* out, size_t out_len);
+
+/**
+ * @brief Verify a signature over @p message
+ * @param public_key Encoded public key
+ * @param signature Signature (R || S)
+ * @param message Message bytes (may be NULL when @p message_len is 0)
+ * @param message_len Message length
+ * @return DC_OK if valid, DC_ERROR_UNAUTHORIZED if the signature does not match,
+ *         DC_ERROR_INVALID_PARAM if the public key is not a valid point
+ */
+dc_status_t dc_ed25519_verify(const uint8_t public_key[DC_ED25519_PUBLIC_KEY_SIZE],
+                              const uint8_t signature[DC_ED25519_SIGNATURE_SIZE],
+                              const void* message, size_t message_len);
+
+/**
+ * @brief Verify a signature over @p prefix || @p message without concatenating
+ * @param public_key Encoded public key
+ * @param signature Signature (R || S)
+ * @param prefix Leading bytes (e.g. the interaction timestamp)
+ * @param prefix_len Prefix length
+ * @param message Trailing bytes (e.g. the request body)
+ * @param message_len Message length
+ * @return Same as dc_ed25519_verify()
+ */
+dc_status_t dc_ed25519_verify_prefixed(const uint8_t public_key[DC_ED25519_PUBLIC_KEY_SIZE],
+                                       const uint8_t signature[DC_ED25519_SIGNATURE_SIZE],
+                                       const void* prefix, size_t prefix_len,
+                                       const void* message, size_t message_len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DC_ED25519_H */
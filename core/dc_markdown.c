@@ -0,0 +1,396 @@
+/**
+ * @file dc_markdown.c
+ * @brief Markdown tokenizer implementation
+ */
+
+#include "dc_markdown.h"
+#include "dc_format.h"
+#include <string.h>
+
+/* Bytes that may start a token; everything else is scanned as text */
+static const unsigned char dc_md_special[256] = {
+    ['`'] = 1, ['<'] = 1, ['|'] = 1, ['*'] = 1, ['_'] = 1,
+    ['~'] = 1, ['\\'] = 1, ['@'] = 1, ['h'] = 1,
+};
+
+static int dc_md_is_space(unsigned char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
+}
+
+static int dc_md_is_alnum(unsigned char c) {
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+
+static int dc_md_is_punct(unsigned char c) {
+    return (c >= 0x21 && c <= 0x2F) || (c >= 0x3A && c <= 0x40) ||
+           (c >= 0x5B && c <= 0x60) || (c >= 0x7B && c <= 0x7E);
+}
+
+static int dc_md_has(const dc_markdown_tokenizer_t* tok, size_t at, const char* lit, size_t lit_len) {
+    return tok->length - at >= lit_len && memcmp(tok->src + at, lit, lit_len) == 0;
+}
+
+static void dc_md_token(dc_markdown_tokenizer_t* tok, dc_markdown_token_t* out,
+                        dc_markdown_token_type_t type, size_t start, size_t end) {
+    memset(out, 0, sizeof(*out));
+    out->type = type;
+    out->start = tok->src + start;
+    out->length = end - start;
+    out->text = out->start;
+    out->text_length = out->length;
+    out->styles = tok->styles;
+}
+
+/* Parse a non-zero snowflake ending at '>'; returns the position after '>' or 0 */
+static size_t dc_md_parse_id(const dc_markdown_tokenizer_t* tok, size_t at, dc_snowflake_t* out) {
+    uint64_t value = 0;
+    size_t digits = 0;
+    while (at < tok->length && tok->src[at] >= '0' && tok->src[at] <= '9') {
+        uint64_t d = (uint64_t)(tok->src[at] - '0');
+        if (value > (UINT64_MAX - d) / 10u) return 0;
+        value = value * 10u + d;
+        digits++;
+        at++;
+    }
+    if (digits == 0 || value == 0 || at >= tok->length || tok->src[at] != '>') return 0;
+    *out = value;
+    return at + 1;
+}
+
+static size_t dc_md_match_angle(dc_markdown_tokenizer_t* tok, size_t at, dc_markdown_token_t* out) {
+    const char* s = tok->src;
+    const size_t len = tok->length;
+    dc_snowflake_t id = 0;
+    size_t end = 0;
+    size_t i = at + 1;
+    if (i >= len) return 0;
+
+    if (s[i] == '@') {
+        dc_markdown_token_type_t type = DC_MARKDOWN_TOKEN_USER_MENTION;
+        i++;
+        if (i < len && s[i] == '!') {
+            i++;
+        } else if (i < len && s[i] == '&') {
+            type = DC_MARKDOWN_TOKEN_ROLE_MENTION;
+            i++;
+        }
+        end = dc_md_parse_id(tok, i, &id);
+        if (!end) return 0;
+        dc_md_token(tok, out, type, at, end);
+        out->id = id;
+        return end;
+    }
+
+    if (s[i] == '#') {
+        end = dc_md_parse_id(tok, i + 1, &id);
+        if (!end) return 0;
+        dc_md_token(tok, out, DC_MARKDOWN_TOKEN_CHANNEL_MENTION, at, end);
+        out->id = id;
+        return end;
+    }
+
+    if (s[i] == '/') {
+        size_t name_start = ++i;
+        while (i < len && s[i] != ':' && s[i] != '>' && s[i] != '<' && s[i] != '\n' && i - name_start < 100) i++;
+        if (i == name_start || i >= len || s[i] != ':') return 0;
+        end = dc_md_parse_id(tok, i + 1, &id);
+        if (!end) return 0;
+        dc_md_token(tok, out, DC_MARKDOWN_TOKEN_SLASH_COMMAND, at, end);
+        out->name = s + name_start;
+        out->name_length = i - name_start;
+        out->id = id;
+        return end;
+    }
+
+    if (s[i] == ':' || (s[i] == 'a' && i + 1 < len && s[i + 1] == ':')) {
+        int animated = s[i] == 'a';
+        i += animated ? 2 : 1;
+        size_t name_start = i;
+        while (i < len && (dc_md_is_alnum((unsigned char)s[i]) || s[i] == '_') && i - name_start <= 32) i++;
+        if (i - name_start < 2 || i - name_start > 32 || i >= len || s[i] != ':') return 0;
+        end = dc_md_parse_id(tok, i + 1, &id);
+        if (!end) return 0;
+        dc_md_token(tok, out, DC_MARKDOWN_TOKEN_EMOJI, at, end);
+        out->name = s + name_start;
+        out->name_length = i - name_start;
+        out->id = id;
+        out->animated = animated;
+        return end;
+    }
+
+    if (s[i] == 't' && i + 1 < len && s[i + 1] == ':') {
+        i += 2;
+        int negative = 0;
+        if (i < len && s[i] == '-') {
+            negative = 1;
+            i++;
+        }
+        int64_t value = 0;
+        size_t digits = 0;
+        while (i < len && s[i] >= '0' && s[i] <= '9' && digits < 17) {
+            value = value * 10 + (s[i] - '0');
+            digits++;
+            i++;
+        }
+        if (digits == 0 || i >= len) return 0;
+        char style = '\0';
+        if (s[i] == ':') {
+            if (i + 2 >= len || s[i + 2] != '>' || !dc_format_timestamp_style_is_valid(s[i + 1])) return 0;
+            style = s[i + 1];
+            i += 2;
+        }
+        if (s[i] != '>') return 0;
+        end = i + 1;
+        dc_md_token(tok, out, DC_MARKDOWN_TOKEN_TIMESTAMP, at, end);
+        out->timestamp = negative ? -value : value;
+        out->timestamp_style = style;
+        return end;
+    }
+
+    if (dc_md_has(tok, i, "https://", 8) || dc_md_has(tok, i, "http://", 7)) {
+        size_t url_start = i;
+        i += s[i + 4] == 's' ? 8 : 7;
+        size_t host = i;
+        while (i < len && s[i] != '>' && !dc_md_is_space((unsigned char)s[i])) i++;
+        if (i == host || i >= len || s[i] != '>') return 0;
+        end = i + 1;
+        dc_md_token(tok, out, DC_MARKDOWN_TOKEN_URL, at, end);
+        out->text = s + url_start;
+        out->text_length = i - url_start;
+        out->embed_suppressed = 1;
+        return end;
+    }
+    return 0;
+}
+
+static size_t dc_md_match_url(dc_markdown_tokenizer_t* tok, size_t at, dc_markdown_token_t* out) {
+    const char* s = tok->src;
+    if (at > 0 && dc_md_is_alnum((unsigned char)s[at - 1])) return 0;
+    size_t i;
+    if (dc_md_has(tok, at, "https://", 8)) {
+        i = at + 8;
+    } else if (dc_md_has(tok, at, "http://", 7)) {
+        i = at + 7;
+    } else {
+        return 0;
+    }
+    size_t host = i;
+    while (i < tok->length && !dc_md_is_space((unsigned char)s[i]) && s[i] != '<') i++;
+    /* Trailing sentence punctuation is not part of the link */
+    while (i > host && s[i - 1] != '\0' && strchr(".,:;!?\"')", s[i - 1])) i--;
+    if (i == host) return 0;
+    dc_md_token(tok, out, DC_MARKDOWN_TOKEN_URL, at, i);
+    return i;
+}
+
+static size_t dc_md_match_code(dc_markdown_tokenizer_t* tok, size_t at, size_t run, dc_markdown_token_t* out) {
+    const char* s = tok->src;
+    const size_t len = tok->length;
+
+    if (run >= 3) {
+        size_t body = at + 3;
+        size_t lang_end = body;
+        while (lang_end < len && (dc_md_is_alnum((unsigned char)s[lang_end]) ||
+                                  (s[lang_end] != '\0' && strchr("_+-.#", s[lang_end])))) {
+            lang_end++;
+        }
+        size_t name_start = body;
+        size_t name_length = 0;
+        if (lang_end < len && s[lang_end] == '\n') {
+            name_length = lang_end - body;
+            body = lang_end + 1;
+        }
+        for (size_t i = body; i + 3 <= len; i++) {
+            if (s[i] == '`' && s[i + 1] == '`' && s[i + 2] == '`') {
+                dc_md_token(tok, out, DC_MARKDOWN_TOKEN_CODE_BLOCK, at, i + 3);
+                out->text = s + body;
+                out->text_length = i - body;
+                out->name = s + name_start;
+                out->name_length = name_length;
+                return i + 3;
+            }
+        }
+        return 0;
+    }
+
+    /* Inline code closes on a backtick run of the same length */
+    size_t i = at + run;
+    while (i < len) {
+        const char* tick = (const char*)memchr(s + i, '`', len - i);
+        if (!tick) return 0;
+        size_t close = (size_t)(tick - s);
+        size_t close_run = 0;
+        while (close + close_run < len && s[close + close_run] == '`') close_run++;
+        if (close_run == run && close > at + run) {
+            dc_md_token(tok, out, DC_MARKDOWN_TOKEN_INLINE_CODE, at, close + run);
+            out->text = s + at + run;
+            out->text_length = close - at - run;
+            return close + run;
+        }
+        i = close + close_run;
+    }
+    return 0;
+}
+
+static void dc_md_delimiter(dc_markdown_tokenizer_t* tok, dc_markdown_token_t* out, dc_markdown_token_type_t type,
+                            uint32_t style, size_t start, size_t end, int closing) {
+    if (!closing) tok->styles |= style;
+    dc_md_token(tok, out, type, start, end);
+    out->closing = closing;
+    if (closing) tok->styles &= ~style;
+}
+
+/* Emphasis runs: * _ ** __ *** ___; returns the token count */
+static int dc_md_match_emphasis(dc_markdown_tokenizer_t* tok, size_t at, size_t run, dc_markdown_token_t out[2]) {
+    const char* s = tok->src;
+    const unsigned char prev = at > 0 ? (unsigned char)s[at - 1] : ' ';
+    const unsigned char next = at + run < tok->length ? (unsigned char)s[at + run] : ' ';
+    const int star = s[at] == '*';
+    if (run > 3) return 0;
+    if (!star && dc_md_is_alnum(prev) && dc_md_is_alnum(next)) return 0;
+
+    const dc_markdown_token_type_t outer = star ? DC_MARKDOWN_TOKEN_BOLD : DC_MARKDOWN_TOKEN_UNDERLINE;
+    const uint32_t outer_style = star ? DC_MARKDOWN_STYLE_BOLD : DC_MARKDOWN_STYLE_UNDERLINE;
+    const int can_open = !dc_md_is_space(next);
+    const int can_close = !dc_md_is_space(prev);
+
+    if (run == 1 || run == 2) {
+        dc_markdown_token_type_t type = run == 1 ? DC_MARKDOWN_TOKEN_ITALIC : outer;
+        uint32_t style = run == 1 ? DC_MARKDOWN_STYLE_ITALIC : outer_style;
+        int closing = (tok->styles & style) != 0;
+        if (closing ? !can_close : !can_open) return 0;
+        dc_md_delimiter(tok, &out[0], type, style, at, at + run, closing);
+        return 1;
+    }
+
+    /* Triple run: close inner-first, open outer-first */
+    int close_italic = (tok->styles & DC_MARKDOWN_STYLE_ITALIC) != 0;
+    int close_outer = (tok->styles & outer_style) != 0;
+    if ((close_italic || close_outer) && !can_close) return 0;
+    if ((!close_italic || !close_outer) && !can_open) return 0;
+    if (close_italic) {
+        dc_md_delimiter(tok, &out[0], DC_MARKDOWN_TOKEN_ITALIC, DC_MARKDOWN_STYLE_ITALIC, at, at + 1, 1);
+        dc_md_delimiter(tok, &out[1], outer, outer_style, at + 1, at + 3, close_outer);
+    } else {
+        dc_md_delimiter(tok, &out[0], outer, outer_style, at, at + 2, close_outer);
+        dc_md_delimiter(tok, &out[1], DC_MARKDOWN_TOKEN_ITALIC, DC_MARKDOWN_STYLE_ITALIC, at + 2, at + 3, 0);
+    }
+    return 2;
+}
+
+/*
+ * Try to match a token at a special byte. Returns the number of tokens
+ * written to out; *end receives the position after the match, or after the
+ * bytes that should be kept as text when nothing matched.
+ */
+static int dc_md_match(dc_markdown_tokenizer_t* tok, size_t at, dc_markdown_token_t out[2], size_t* end) {
+    const char* s = tok->src;
+    const size_t len = tok->length;
+    const char c = s[at];
+    size_t run = 1;
+    size_t matched = 0;
+
+    switch (c) {
+        case '\\':
+            if (at + 1 < len && dc_md_is_punct((unsigned char)s[at + 1])) {
+                dc_md_token(tok, &out[0], DC_MARKDOWN_TOKEN_TEXT, at, at + 2);
+                out[0].text = s + at + 1;
+                out[0].text_length = 1;
+                *end = at + 2;
+                return 1;
+            }
+            break;
+        case '`':
+            while (at + run < len && s[at + run] == '`') run++;
+            matched = dc_md_match_code(tok, at, run, &out[0]);
+            break;
+        case '<':
+            matched = dc_md_match_angle(tok, at, &out[0]);
+            break;
+        case '@':
+            if (dc_md_has(tok, at, "@everyone", 9)) {
+                dc_md_token(tok, &out[0], DC_MARKDOWN_TOKEN_EVERYONE, at, at + 9);
+                matched = at + 9;
+            } else if (dc_md_has(tok, at, "@here", 5)) {
+                dc_md_token(tok, &out[0], DC_MARKDOWN_TOKEN_HERE, at, at + 5);
+                matched = at + 5;
+            }
+            break;
+        case 'h':
+            matched = dc_md_match_url(tok, at, &out[0]);
+            break;
+        case '|':
+        case '~':
+            if (at + 1 < len && s[at + 1] == c) {
+                uint32_t style = c == '|' ? DC_MARKDOWN_STYLE_SPOILER : DC_MARKDOWN_STYLE_STRIKETHROUGH;
+                dc_markdown_token_type_t type = c == '|' ? DC_MARKDOWN_TOKEN_SPOILER : DC_MARKDOWN_TOKEN_STRIKETHROUGH;
+                dc_md_delimiter(tok, &out[0], type, style, at, at + 2, (tok->styles & style) != 0);
+                matched = at + 2;
+            }
+            break;
+        case '*':
+        case '_': {
+            while (at + run < len && s[at + run] == c) run++;
+            int count = dc_md_match_emphasis(tok, at, run, out);
+            *end = at + run;
+            return count;
+        }
+        default:
+            break;
+    }
+
+    if (matched) {
+        *end = matched;
+        return 1;
+    }
+    *end = at + run;
+    return 0;
+}
+
+void dc_markdown_tokenizer_init(dc_markdown_tokenizer_t* tok, const char* content, size_t length) {
+    if (!tok) return;
+    memset(tok, 0, sizeof(*tok));
+    tok->src = content ? content : "";
+    tok->length = content ? length : 0;
+}
+
+int dc_markdown_next(dc_markdown_tokenizer_t* tok, dc_markdown_token_t* out) {
+    if (!tok || !out) return 0;
+    if (tok->pending_next < tok->pending_count) {
+        *out = tok->pending[tok->pending_next++];
+        return 1;
+    }
+    tok->pending_count = 0;
+    tok->pending_next = 0;
+    if (tok->pos >= tok->length) return 0;
+
+    const unsigned char* s = (const unsigned char*)tok->src;
+    const size_t text_start = tok->pos;
+    const uint32_t text_styles = tok->styles;
+    size_t at = tok->pos;
+    while (at < tok->length) {
+        if (!dc_md_special[s[at]]) {
+            at++;
+            continue;
+        }
+        size_t end = at;
+        int count = dc_md_match(tok, at, tok->pending, &end);
+        if (count == 0) {
+            at = end;
+            continue;
+        }
+        tok->pos = end;
+        tok->pending_count = count;
+        if (at == text_start) {
+            *out = tok->pending[tok->pending_next++];
+            return 1;
+        }
+        break;
+    }
+
+    /* Text run up to the token just matched (or the end of input) */
+    dc_md_token(tok, out, DC_MARKDOWN_TOKEN_TEXT, text_start, at);
+    out->styles = text_styles;
+    if (!tok->pending_count) tok->pos = at;
+    return 1;
+}
@@ -0,0 +1,125 @@
+#ifndef DC_MARKDOWN_H
+#define DC_MARKDOWN_H
+
+/**
+ * @file dc_markdown.h
+ * @brief Single-pass, allocation-free tokenizer for Discord message markdown
+ *
+ * The tokenizer walks message content once and yields spans that point into
+ * the source buffer: plain text, code blocks and inline code, mentions,
+ * custom emoji, timestamps, URLs, and emphasis/spoiler delimiters. Nothing
+ * inside code is tokenized, so mentions or URLs in code are never reported.
+ *
+ * Emphasis is reported as delimiter tokens rather than a tree: each
+ * delimiter toggles its style, and every token carries the styles in effect
+ * for it (see dc_markdown_token_t.styles). A delimiter that is never closed
+ * is still reported as an opener. Line-level syntax (headers, quotes, lists)
+ * is reported as text.
+ *
+ * @code
+ * dc_markdown_tokenizer_t tok;
+ * dc_markdown_token_t token;
+ * dc_markdown_tokenizer_init(&tok, content, strlen(content));
+ * while (dc_markdown_next(&tok, &token)) {
+ *     if (token.type == DC_MARKDOWN_TOKEN_USER_MENTION &&
+ *         !(token.styles & DC_MARKDOWN_STYLE_SPOILER)) {
+ *         ... token.id ...
+ *     }
+ * }
+ * @endcode
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include "dc_snowflake.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Token types
+ */
+typedef enum {
+    DC_MARKDOWN_TOKEN_TEXT = 0,         /**< Plain text; an escaped character has text past the backslash */
+    DC_MARKDOWN_TOKEN_CODE_BLOCK,       /**< ```lang\n...```; text = body, name = language (may be empty) */
+    DC_MARKDOWN_TOKEN_INLINE_CODE,      /**< `...` or ``...``; text = code */
+    DC_MARKDOWN_TOKEN_USER_MENTION,     /**< <@id> or <@!id>; id */
+    DC_MARKDOWN_TOKEN_CHANNEL_MENTION,  /**< <#id>; id */
+    DC_MARKDOWN_TOKEN_ROLE_MENTION,     /**< <@&id>; id */
+    DC_MARKDOWN_TOKEN_SLASH_COMMAND,    /**< </name:id>; name, id */
+    DC_MARKDOWN_TOKEN_EMOJI,            /**< <:name:id> or <a:name:id>; name, id, animated */
+    DC_MARKDOWN_TOKEN_TIMESTAMP,        /**< <t:unix> or <t:unix:style>; timestamp, timestamp_style */
+    DC_MARKDOWN_TOKEN_EVERYONE,         /**< @everyone */
+    DC_MARKDOWN_TOKEN_HERE,             /**< @here */
+    DC_MARKDOWN_TOKEN_URL,              /**< http(s) URL; text = URL, embed_suppressed for <url> */
+    DC_MARKDOWN_TOKEN_SPOILER,          /**< || delimiter */
+    DC_MARKDOWN_TOKEN_BOLD,             /**< ** delimiter */
+    DC_MARKDOWN_TOKEN_ITALIC,           /**< * or _ delimiter */
+    DC_MARKDOWN_TOKEN_UNDERLINE,        /**< __ delimiter */
+    DC_MARKDOWN_TOKEN_STRIKETHROUGH     /**< ~~ delimiter */
+} dc_markdown_token_type_t;
+
+/**
+ * @brief Style bits for dc_markdown_token_t.styles
+ */
+#define DC_MARKDOWN_STYLE_SPOILER       (1u << 0)
+#define DC_MARKDOWN_STYLE_BOLD          (1u << 1)
+#define DC_MARKDOWN_STYLE_ITALIC        (1u << 2)
+#define DC_MARKDOWN_STYLE_UNDERLINE     (1u << 3)
+#define DC_MARKDOWN_STYLE_STRIKETHROUGH (1u << 4)
+
+/**
+ * @brief One token; all pointers reference the tokenizer's source buffer
+ */
+typedef struct {
+    dc_markdown_token_type_t type;
+    const char* start;          /**< Whole span in the source */
+    size_t length;
+    const char* text;           /**< Payload (see token types); equals the span for TEXT */
+    size_t text_length;
+    const char* name;           /**< Emoji name, command name or code block language */
+    size_t name_length;
+    dc_snowflake_t id;          /**< Mention, emoji or command ID */
+    int64_t timestamp;          /**< Unix seconds for TIMESTAMP */
+    char timestamp_style;       /**< Style character, or '\0' for default */
+    int animated;               /**< Animated emoji */
+    int embed_suppressed;       /**< URL written as <url> */
+    int closing;                /**< Delimiter closes its style */
+    uint32_t styles;            /**< DC_MARKDOWN_STYLE_* in effect, including a delimiter's own */
+} dc_markdown_token_t;
+
+/**
+ * @brief Tokenizer state (stack-allocatable)
+ */
+typedef struct {
+    const char* src;
+    size_t length;
+    size_t pos;
+    uint32_t styles;
+    dc_markdown_token_t pending[2]; /**< Tokens found while scanning a text run */
+    int pending_count;
+    int pending_next;
+} dc_markdown_tokenizer_t;
+
+/**
+ * @brief Start tokenizing a buffer
+ * @param tok Tokenizer
+ * @param content Message content (need not be null-terminated; NULL treated as empty)
+ * @param length Content length in bytes
+ */
+void dc_markdown_tokenizer_init(dc_markdown_tokenizer_t* tok, const char* content, size_t length);
+
+/**
+ * @brief Produce the next token
+ * @param tok Tokenizer
+ * @param out Receives the token
+ * @return 1 if a token was produced, 0 at end of input
+ */
+int dc_markdown_next(dc_markdown_tokenizer_t* tok, dc_markdown_token_t* out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DC_MARKDOWN_H */
@@ -4,6 +4,7 @@
  */
 
 #include "core/dc_platform.h"
+#include "core/dc_alloc.h"
 
 #include <errno.h>
 
@@ -129,3 +130,140 @@ int dc_platform_mutex_unlock(dc_platform_mutex_t* mutex) {
     return pthread_mutex_unlock(mutex) == 0;
 #endif
 }
+
+int dc_platform_cond_init(dc_platform_cond_t* cond) {
+    if (!cond) return 0;
+#if defined(_WIN32)
+    InitializeConditionVariable(cond);
+    return 1;
+#elif defined(__APPLE__)
+    /* Timed waits use pthread_cond_timedwait_relative_np, which ignores the clock. */
+    return pthread_cond_init(cond, NULL) == 0;
+#else
+    pthread_condattr_t attr;
+    if (pthread_condattr_init(&attr) != 0) return 0;
+    int ok = pthread_condattr_setclock(&attr, CLOCK_MONOTONIC) == 0 &&
+             pthread_cond_init(cond, &attr) == 0;
+    (void)pthread_condattr_destroy(&attr);
+    return ok;
+#endif
+}
+
+void dc_platform_cond_destroy(dc_platform_cond_t* cond) {
+    if (!cond) return;
+#if !defined(_WIN32)
+    (void)pthread_cond_destroy(cond);
+#else
+    (void)cond;
+#endif
+}
+
+int dc_platform_cond_wait(dc_platform_cond_t* cond, dc_platform_mutex_t* mutex) {
+    if (!cond || !mutex) return 0;
+#if defined(_WIN32)
+    return SleepConditionVariableSRW(cond, mutex, INFINITE, 0) ? 1 : 0;
+#else
+    return pthread_cond_wait(cond, mutex) == 0;
+#endif
+}
+
+int dc_platform_cond_timedwait_ms(dc_platform_cond_t* cond, dc_platform_mutex_t* mutex, uint64_t timeout_ms) {
+    if (!cond || !mutex) return 0;
+#if defined(_WIN32)
+    /* INFINITE is 0xFFFFFFFF, so cap just below it. */
+    DWORD ms = (timeout_ms >= 0xFFFFFFFEULL) ? 0xFFFFFFFEUL : (DWORD)timeout_ms;
+    return SleepConditionVariableSRW(cond, mutex, ms, 0) ? 1 : 0;
+#elif defined(__APPLE__)
+    struct timespec rel;
+    rel.tv_sec = (time_t)(timeout_ms / 1000ULL);
+    rel.tv_nsec = (long)((timeout_ms % 1000ULL) * 1000000ULL);
+    return pthread_cond_timedwait_relative_np(cond, mutex, &rel) == 0;
+#else
+    struct timespec deadline;
+    if (clock_gettime(CLOCK_MONOTONIC, &deadline) != 0) return 0;
+    deadline.tv_sec += (time_t)(timeout_ms / 1000ULL);
+    deadline.tv_nsec += (long)((timeout_ms % 1000ULL) * 1000000ULL);
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+    return pthread_cond_timedwait(cond, mutex, &deadline) == 0;
+#endif
+}
+
+void dc_platform_cond_signal(dc_platform_cond_t* cond) {
+    if (!cond) return;
+#if defined(_WIN32)
+    WakeConditionVariable(cond);
+#else
+    (void)pthread_cond_signal(cond);
+#endif
+}
+
+void dc_platform_cond_broadcast(dc_platform_cond_t* cond) {
+    if (!cond) return;
+#if defined(_WIN32)
+    WakeAllConditionVariable(cond);
+#else
+    (void)pthread_cond_broadcast(cond);
+#endif
+}
+
+typedef struct {
+    dc_platform_thread_fn fn;
+    void* arg;
+} dc_platform_thread_start_t;
+
+#if defined(_WIN32)
+static DWORD WINAPI dc_platform_thread_main(LPVOID param) {
+#else
+static void* dc_platform_thread_main(void* param) {
+#endif
+    dc_platform_thread_start_t start = *(dc_platform_thread_start_t*)param;
+    dc_free(param);
+    start.fn(start.arg);
+#if defined(_WIN32)
+    return 0;
+#else
+    return NULL;
+#endif
+}
+
+int dc_platform_thread_create(dc_platform_thread_t* thread, dc_platform_thread_fn fn, void* arg) {
+    if (!thread || !fn) return 0;
+    dc_platform_thread_start_t* start = (dc_platform_thread_start_t*)dc_alloc(sizeof(*start));
+    if (!start) return 0;
+    start->fn = fn;
+    start->arg = arg;
+#if defined(_WIN32)
+    *thread = CreateThread(NULL, 0, dc_platform_thread_main, start, 0, NULL);
+    if (*thread == NULL) {
+        dc_free(start);
+        return 0;
+    }
+#else
+    if (pthread_create(thread, NULL, dc_platform_thread_main, start) != 0) {
+        dc_free(start);
+        return 0;
+    }
+#endif
+    return 1;
+}
+
+int dc_platform_thread_join(dc_platform_thread_t thread) {
+#if defined(_WIN32)
+    int ok = WaitForSingleObject(thread, INFINITE) == WAIT_OBJECT_0;
+    (void)CloseHandle(thread);
+    return ok;
+#else
+    return pthread_join(thread, NULL) == 0;
+#endif
+}
+
+int dc_platform_thread_detach(dc_platform_thread_t thread) {
+#if defined(_WIN32)
+    return CloseHandle(thread) ? 1 : 0;
+#else
+    return pthread_detach(thread) == 0;
+#endif
+}
@@ -15,9 +15,15 @@
 #endif
 #include <windows.h>
 typedef SRWLOCK dc_platform_mutex_t;
+typedef CONDITION_VARIABLE dc_platform_cond_t;
+typedef HANDLE dc_platform_thread_t;
+#define DC_PLATFORM_MUTEX_INITIALIZER SRWLOCK_INIT
 #else
 #include <pthread.h>
 typedef pthread_mutex_t dc_platform_mutex_t;
+typedef pthread_cond_t dc_platform_cond_t;
+typedef pthread_t dc_platform_thread_t;
+#define DC_PLATFORM_MUTEX_INITIALIZER PTHREAD_MUTEX_INITIALIZER
 #endif
 
 #ifdef __cplusplus
@@ -36,6 +42,21 @@ void dc_platform_mutex_destroy(dc_platform_mutex_t* mutex);
 int dc_platform_mutex_lock(dc_platform_mutex_t* mutex);
 int dc_platform_mutex_unlock(dc_platform_mutex_t* mutex);
 
+/* Condition variables paired with a dc_platform_mutex_t; timeouts use the monotonic clock. */
+int dc_platform_cond_init(dc_platform_cond_t* cond);
+void dc_platform_cond_destroy(dc_platform_cond_t* cond);
+int dc_platform_cond_wait(dc_platform_cond_t* cond, dc_platform_mutex_t* mutex);
+/* Returns 1 when woken (possibly spuriously), 0 on timeout or error. */
+int dc_platform_cond_timedwait_ms(dc_platform_cond_t* cond, dc_platform_mutex_t* mutex, uint64_t timeout_ms);
+void dc_platform_cond_signal(dc_platform_cond_t* cond);
+void dc_platform_cond_broadcast(dc_platform_cond_t* cond);
+
+/* Threads run fn(arg); each one must be joined or detached exactly once. */
+typedef void (*dc_platform_thread_fn)(void* arg);
+int dc_platform_thread_create(dc_platform_thread_t* thread, dc_platform_thread_fn fn, void* arg);
+int dc_platform_thread_join(dc_platform_thread_t thread);
+int dc_platform_thread_detach(dc_platform_thread_t thread);
+
 #ifdef __cplusplus
 }
 #endif
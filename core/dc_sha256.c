@@ -0,0 +1,141 @@
+/**
+ * @file dc_sha256.c
+ * @brief SHA-256 implementation
+ */
+
+#include "dc_sha256.h"
+#include <string.h>
+
+static const uint32_t dc_sha256_k[64] = {
+    0x428a2f98u, 0x71374491u, 0xb5c0fbcfu, 0xe9b5dba5u, 0x3956c25bu, 0x59f111f1u, 0x923f82a4u, 0xab1c5ed5u,
+    0xd807aa98u, 0x12835b01u, 0x243185beu, 0x550c7dc3u, 0x72be5d74u, 0x80deb1feu, 0x9bdc06a7u, 0xc19bf174u,
+    0xe49b69c1u, 0xefbe4786u, 0x0fc19dc6u, 0x240ca1ccu, 0x2de92c6fu, 0x4a7484aau, 0x5cb0a9dcu, 0x76f988dau,
+    0x983e5152u, 0xa831c66du, 0xb00327c8u, 0xbf597fc7u, 0xc6e00bf3u, 0xd5a79147u, 0x06ca6351u, 0x14292967u,
+    0x27b70a85u, 0x2e1b2138u, 0x4d2c6dfcu, 0x53380d13u, 0x650a7354u, 0x766a0abbu, 0x81c2c92eu, 0x92722c85u,
+    0xa2bfe8a1u, 0xa81a664bu, 0xc24b8b70u, 0xc76c51a3u, 0xd192e819u, 0xd6990624u, 0xf40e3585u, 0x106aa070u,
+    0x19a4c116u, 0x1e376c08u, 0x2748774cu, 0x34b0bcb5u, 0x391c0cb3u, 0x4ed8aa4au, 0x5b9cca4fu, 0x682e6ff3u,
+    0x748f82eeu, 0x78a5636fu, 0x84c87814u, 0x8cc70208u, 0x90befffau, 0xa4506cebu, 0xbef9a3f7u, 0xc67178f2u
+};
+
+static uint32_t dc_sha256_rotr(uint32_t x, unsigned n) {
+    return (x >> n) | (x << (32u - n));
+}
+
+static void dc_sha256_compress(dc_sha256_t* ctx, const uint8_t* block) {
+    uint32_t w[64];
+    for (size_t i = 0; i < 16; i++) {
+        w[i] = ((uint32_t)block[i * 4] << 24) | ((uint32_t)block[i * 4 + 1] << 16) |
+               ((uint32_t)block[i * 4 + 2] << 8) | (uint32_t)block[i * 4 + 3];
+    }
+    for (size_t i = 16; i < 64; i++) {
+        uint32_t s0 = dc_sha256_rotr(w[i - 15], 7) ^ dc_sha256_rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+        uint32_t s1 = dc_sha256_rotr(w[i - 2], 17) ^ dc_sha256_rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+
+    uint32_t a = ctx->state[0], b = ctx->state[1], c = ctx->state[2], d = ctx->state[3];
+    uint32_t e = ctx->state[4], f = ctx->state[5], g = ctx->state[6], h = ctx->state[7];
+    for (size_t i = 0; i < 64; i++) {
+        uint32_t s1 = dc_sha256_rotr(e, 6) ^ dc_sha256_rotr(e, 11) ^ dc_sha256_rotr(e, 25);
+        uint32_t ch = (e & f) ^ (~e & g);
+        uint32_t t1 = h + s1 + ch + dc_sha256_k[i] + w[i];
+        uint32_t s0 = dc_sha256_rotr(a, 2) ^ dc_sha256_rotr(a, 13) ^ dc_sha256_rotr(a, 22);
+        uint32_t maj = (a & b) ^ (a & c) ^ (b & c);
+        uint32_t t2 = s0 + maj;
+        h = g;
+        g = f;
+        f = e;
+        e = d + t1;
+        d = c;
+        c = b;
+        b = a;
+        a = t1 + t2;
+    }
+    ctx->state[0] += a;
+    ctx->state[1] += b;
+    ctx->state[2] += c;
+    ctx->state[3] += d;
+    ctx->state[4] += e;
+    ctx->state[5] += f;
+    ctx->state[6] += g;
+    ctx->state[7] += h;
+}
+
+void dc_sha256_init(dc_sha256_t* ctx) {
+    static const uint32_t iv[8] = {
+        0x6a09e667u, 0xbb67ae85u, 0x3c6ef372u, 0xa54ff53au,
+        0x510e527fu, 0x9b05688cu, 0x1f83d9abu, 0x5be0cd19u
+    };
+    if (!ctx) return;
+    memcpy(ctx->state, iv, sizeof(iv));
+    ctx->total_len = 0;
+    ctx->block_len = 0;
+}
+
+void dc_sha256_update(dc_sha256_t* ctx, const void* data, size_t len) {
+    if (!ctx || (!data && len > 0)) return;
+    const uint8_t* p = (const uint8_t*)data;
+    ctx->total_len += len;
+    if (ctx->block_len > 0) {
+        size_t take = sizeof(ctx->block) - ctx->block_len;
+        if (take > len) take = len;
+        memcpy(ctx->block + ctx->block_len, p, take);
+        ctx->block_len += take;
+        p += take;
+        len -= take;
+        if (ctx->block_len < sizeof(ctx->block)) return;
+        dc_sha256_compress(ctx, ctx->block);
+        ctx->block_len = 0;
+    }
+    while (len >= sizeof(ctx->block)) {
+        dc_sha256_compress(ctx, p);
+        p += sizeof(ctx->block);
+        len -= sizeof(ctx->block);
+    }
+    if (len > 0) {
+        memcpy(ctx->block, p, len);
+        ctx->block_len = len;
+    }
+}
+
+void dc_sha256_final(dc_sha256_t* ctx, uint8_t out[DC_SHA256_DIGEST_SIZE]) {
+    if (!ctx || !out) return;
+    uint64_t bits = ctx->total_len * 8u;
+    ctx->block[ctx->block_len++] = 0x80;
+    if (ctx->block_len > 56) {
+        memset(ctx->block + ctx->block_len, 0, sizeof(ctx->block) - ctx->block_len);
+        dc_sha256_compress(ctx, ctx->block);
+        ctx->block_len = 0;
+    }
+    memset(ctx->block + ctx->block_len, 0, 56 - ctx->block_len);
+    for (size_t i = 0; i < 8; i++) {
+        ctx->block[56 + i] = (uint8_t)(bits >> (56 - 8 * i));
+    }
+    dc_sha256_compress(ctx, ctx->block);
+    for (size_t i = 0; i < 8; i++) {
+        out[i * 4] = (uint8_t)(ctx->state[i] >> 24);
+        out[i * 4 + 1] = (uint8_t)(ctx->state[i] >> 16);
+        out[i * 4 + 2] = (uint8_t)(ctx->state[i] >> 8);
+        out[i * 4 + 3] = (uint8_t)ctx->state[i];
+    }
+}
+
+static int dc_sha256_hex_value(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+dc_status_t dc_sha256_compare_hex(const uint8_t digest[DC_SHA256_DIGEST_SIZE], const char* hex) {
+    if (!digest || !hex) return DC_ERROR_NULL_POINTER;
+    if (strlen(hex) != DC_SHA256_DIGEST_SIZE * 2) return DC_ERROR_INVALID_FORMAT;
+    int diff = 0;
+    for (size_t i = 0; i < DC_SHA256_DIGEST_SIZE; i++) {
+        int hi = dc_sha256_hex_value(hex[i * 2]);
+        int lo = dc_sha256_hex_value(hex[i * 2 + 1]);
+        if (hi < 0 || lo < 0) return DC_ERROR_INVALID_FORMAT;
+        diff |= digest[i] ^ ((hi << 4) | lo);
+    }
+    return diff == 0 ? DC_OK : DC_ERROR_INVALID_STATE;
+}
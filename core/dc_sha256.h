@@ -0,0 +1,63 @@
+#ifndef DC_SHA256_H
+#define DC_SHA256_H
+
+/**
+ * @file dc_sha256.h
+ * @brief SHA-256 (FIPS 180-4) for content checksums
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include "core/dc_status.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define DC_SHA256_DIGEST_SIZE 32   /**< Digest size in bytes */
+
+/**
+ * @brief Streaming SHA-256 state
+ */
+typedef struct {
+    uint32_t state[8];
+    uint64_t total_len;
+    uint8_t block[64];
+    size_t block_len;
+} dc_sha256_t;
+
+/**
+ * @brief Start a new digest
+ * @param ctx State to initialize
+ */
+void dc_sha256_init(dc_sha256_t* ctx);
+
+/**
+ * @brief Feed bytes into the digest
+ * @param ctx State
+ * @param data Input bytes (may be NULL when @p len is 0)
+ * @param len Input length
+ */
+void dc_sha256_update(dc_sha256_t* ctx, const void* data, size_t len);
+
+/**
+ * @brief Finish the digest (the state must be re-initialized before reuse)
+ * @param ctx State
+ * @param out Digest bytes
+ */
+void dc_sha256_final(dc_sha256_t* ctx, uint8_t out[DC_SHA256_DIGEST_SIZE]);
+
+/**
+ * @brief Compare a digest with a 64-character hex string (either case)
+ * @param digest Digest bytes
+ * @param hex Expected digest
+ * @return DC_OK if equal, DC_ERROR_INVALID_FORMAT if @p hex is malformed,
+ *         DC_ERROR_INVALID_STATE if the digests differ
+ */
+dc_status_t dc_sha256_compare_hex(const uint8_t digest[DC_SHA256_DIGEST_SIZE], const char* hex);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DC_SHA256_H */
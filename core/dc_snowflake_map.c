@@ -0,0 +1,216 @@
+/**
+ * @file dc_snowflake_map.c
+ * @brief Open-addressing snowflake hash table implementation
+ */
+
+#include "dc_snowflake_map.h"
+#include "dc_alloc.h"
+#include <string.h>
+#include <stdint.h>
+
+#define DC_SNOWFLAKE_MAP_MIN_CAPACITY 16u
+
+/*
+ * Snowflakes share their high (timestamp) bits and keep low-entropy increment
+ * bits at the bottom, so the raw value is a poor bucket index. Mix all bits
+ * (splitmix64 finalizer) before masking.
+ */
+static size_t dc_snowflake_map_hash(dc_snowflake_t key) {
+    uint64_t x = key;
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return (size_t)x;
+}
+
+/* Keep load factor at or below 3/4. */
+static int dc_snowflake_map_fits(size_t capacity, size_t count) {
+    return capacity > 0 && count <= capacity - (capacity / 4u);
+}
+
+static unsigned char* dc_snowflake_map_slot(const dc_snowflake_map_t* map, size_t index) {
+    return map->values + index * map->element_size;
+}
+
+static int dc_snowflake_map_find(const dc_snowflake_map_t* map, dc_snowflake_t key, size_t* out_index) {
+    if (map->capacity == 0 || key == 0) return 0;
+    size_t mask = map->capacity - 1u;
+    size_t i = dc_snowflake_map_hash(key) & mask;
+    for (;;) {
+        dc_snowflake_t k = map->keys[i];
+        if (k == key) {
+            *out_index = i;
+            return 1;
+        }
+        if (k == 0) {
+            *out_index = i;
+            return 0;
+        }
+        i = (i + 1u) & mask;
+    }
+}
+
+static dc_status_t dc_snowflake_map_rehash(dc_snowflake_map_t* map, size_t new_capacity) {
+    if (new_capacity > SIZE_MAX / map->element_size ||
+        new_capacity > SIZE_MAX / sizeof(dc_snowflake_t)) {
+        return DC_ERROR_INVALID_PARAM;
+    }
+    dc_snowflake_t* keys = (dc_snowflake_t*)dc_calloc(new_capacity, sizeof(dc_snowflake_t));
+    if (!keys) return DC_ERROR_OUT_OF_MEMORY;
+    unsigned char* values = (unsigned char*)dc_calloc(new_capacity, map->element_size);
+    if (!values) {
+        dc_free(keys);
+        return DC_ERROR_OUT_OF_MEMORY;
+    }
+
+    size_t mask = new_capacity - 1u;
+    for (size_t i = 0; i < map->capacity; i++) {
+        dc_snowflake_t key = map->keys[i];
+        if (key == 0) continue;
+        size_t j = dc_snowflake_map_hash(key) & mask;
+        while (keys[j] != 0) j = (j + 1u) & mask;
+        keys[j] = key;
+        memcpy(values + j * map->element_size, dc_snowflake_map_slot(map, i), map->element_size);
+    }
+
+    dc_free(map->keys);
+    dc_free(map->values);
+    map->keys = keys;
+    map->values = values;
+    map->capacity = new_capacity;
+    return DC_OK;
+}
+
+dc_status_t dc_snowflake_map_init(dc_snowflake_map_t* map, size_t element_size) {
+    if (!map) return DC_ERROR_NULL_POINTER;
+    if (element_size == 0) return DC_ERROR_INVALID_PARAM;
+    memset(map, 0, sizeof(*map));
+    map->element_size = element_size;
+    return DC_OK;
+}
+
+void dc_snowflake_map_free(dc_snowflake_map_t* map) {
+    if (!map) return;
+    dc_free(map->keys);
+    dc_free(map->values);
+    size_t element_size = map->element_size;
+    memset(map, 0, sizeof(*map));
+    map->element_size = element_size;
+}
+
+dc_status_t dc_snowflake_map_clear(dc_snowflake_map_t* map) {
+    if (!map) return DC_ERROR_NULL_POINTER;
+    if (map->capacity > 0) {
+        memset(map->keys, 0, map->capacity * sizeof(dc_snowflake_t));
+    }
+    map->length = 0;
+    return DC_OK;
+}
+
+dc_status_t dc_snowflake_map_reserve(dc_snowflake_map_t* map, size_t count) {
+    if (!map) return DC_ERROR_NULL_POINTER;
+    if (map->element_size == 0) return DC_ERROR_INVALID_PARAM;
+    if (dc_snowflake_map_fits(map->capacity, count)) return DC_OK;
+
+    size_t capacity = map->capacity ? map->capacity : DC_SNOWFLAKE_MAP_MIN_CAPACITY;
+    while (!dc_snowflake_map_fits(capacity, count)) {
+        if (capacity > SIZE_MAX / 2u) return DC_ERROR_INVALID_PARAM;
+        capacity *= 2u;
+    }
+    return dc_snowflake_map_rehash(map, capacity);
+}
+
+dc_status_t dc_snowflake_map_upsert(dc_snowflake_map_t* map, dc_snowflake_t key,
+                                    void** out_value, int* out_inserted) {
+    if (!map || !out_value) return DC_ERROR_NULL_POINTER;
+    if (key == 0) return DC_ERROR_INVALID_PARAM;
+    if (out_inserted) *out_inserted = 0;
+
+    size_t index = 0;
+    if (dc_snowflake_map_find(map, key, &index)) {
+        *out_value = dc_snowflake_map_slot(map, index);
+        return DC_OK;
+    }
+
+    if (!dc_snowflake_map_fits(map->capacity, map->length + 1u)) {
+        dc_status_t st = dc_snowflake_map_reserve(map, map->length + 1u);
+        if (st != DC_OK) return st;
+        (void)dc_snowflake_map_find(map, key, &index);
+    }
+
+    map->keys[index] = key;
+    unsigned char* slot = dc_snowflake_map_slot(map, index);
+    memset(slot, 0, map->element_size);
+    map->length++;
+    *out_value = slot;
+    if (out_inserted) *out_inserted = 1;
+    return DC_OK;
+}
+
+dc_status_t dc_snowflake_map_put(dc_snowflake_map_t* map, dc_snowflake_t key, const void* value) {
+    void* slot = NULL;
+    dc_status_t st = dc_snowflake_map_upsert(map, key, &slot, NULL);
+    if (st != DC_OK) return st;
+    if (value) {
+        memcpy(slot, value, map->element_size);
+    } else {
+        memset(slot, 0, map->element_size);
+    }
+    return DC_OK;
+}
+
+void* dc_snowflake_map_get(const dc_snowflake_map_t* map, dc_snowflake_t key) {
+    if (!map) return NULL;
+    size_t index = 0;
+    if (!dc_snowflake_map_find(map, key, &index)) return NULL;
+    return dc_snowflake_map_slot(map, index);
+}
+
+int dc_snowflake_map_contains(const dc_snowflake_map_t* map, dc_snowflake_t key) {
+    return dc_snowflake_map_get(map, key) != NULL;
+}
+
+dc_status_t dc_snowflake_map_remove(dc_snowflake_map_t* map, dc_snowflake_t key, void* out_value) {
+    if (!map) return DC_ERROR_NULL_POINTER;
+    size_t index = 0;
+    if (!dc_snowflake_map_find(map, key, &index)) return DC_ERROR_NOT_FOUND;
+    if (out_value) {
+        memcpy(out_value, dc_snowflake_map_slot(map, index), map->element_size);
+    }
+
+    /* Backward-shift deletion keeps probe chains intact without tombstones. */
+    size_t mask = map->capacity - 1u;
+    size_t hole = index;
+    size_t i = (index + 1u) & mask;
+    while (map->keys[i] != 0) {
+        size_t home = dc_snowflake_map_hash(map->keys[i]) & mask;
+        if (((i - home) & mask) >= ((i - hole) & mask)) {
+            map->keys[hole] = map->keys[i];
+            memcpy(dc_snowflake_map_slot(map, hole), dc_snowflake_map_slot(map, i), map->element_size);
+            hole = i;
+        }
+        i = (i + 1u) & mask;
+    }
+    map->keys[hole] = 0;
+    map->length--;
+    return DC_OK;
+}
+
+size_t dc_snowflake_map_length(const dc_snowflake_map_t* map) {
+    return map ? map->length : 0;
+}
+
+int dc_snowflake_map_next(const dc_snowflake_map_t* map, size_t* cursor,
+                          dc_snowflake_t* out_key, void** out_value) {
+    if (!map || !cursor) return 0;
+    while (*cursor < map->capacity) {
+        size_t i = (*cursor)++;
+        if (map->keys[i] == 0) continue;
+        if (out_key) *out_key = map->keys[i];
+        if (out_value) *out_value = dc_snowflake_map_slot(map, i);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,136 @@
+#ifndef DC_SNOWFLAKE_MAP_H
+#define DC_SNOWFLAKE_MAP_H
+
+/**
+ * @file dc_snowflake_map.h
+ * @brief Open-addressing hash table keyed by snowflake IDs
+ *
+ * Values are stored inline with a fixed element size (like dc_vec_t), so
+ * small per-ID records (status bytes, counters, indices) need no per-entry
+ * allocation. Snowflake 0 is reserved as the empty-slot marker and cannot
+ * be used as a key.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include "dc_status.h"
+#include "dc_snowflake.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Snowflake-keyed hash map
+ */
+typedef struct {
+    dc_snowflake_t* keys;     /**< Key slots (0 = empty) */
+    unsigned char* values;    /**< Value slots, element_size bytes each */
+    size_t length;            /**< Number of occupied slots */
+    size_t capacity;          /**< Number of slots (power of two or 0) */
+    size_t element_size;      /**< Size of each value */
+} dc_snowflake_map_t;
+
+/**
+ * @brief Initialize empty map
+ * @param map Pointer to map structure
+ * @param element_size Size of each value (must be non-zero)
+ * @return DC_OK on success, error code on failure
+ */
+dc_status_t dc_snowflake_map_init(dc_snowflake_map_t* map, size_t element_size);
+
+/**
+ * @brief Free map resources
+ * @param map Pointer to map structure
+ */
+void dc_snowflake_map_free(dc_snowflake_map_t* map);
+
+/**
+ * @brief Remove all entries (keep capacity)
+ * @param map Pointer to map structure
+ * @return DC_OK on success, error code on failure
+ */
+dc_status_t dc_snowflake_map_clear(dc_snowflake_map_t* map);
+
+/**
+ * @brief Reserve room for at least @p count entries without rehashing
+ * @param map Pointer to map structure
+ * @param count Number of entries to reserve
+ * @return DC_OK on success, error code on failure
+ */
+dc_status_t dc_snowflake_map_reserve(dc_snowflake_map_t* map, size_t count);
+
+/**
+ * @brief Insert or overwrite a value
+ * @param map Pointer to map structure
+ * @param key Snowflake key (non-zero)
+ * @param value Pointer to value to copy (NULL zero-fills)
+ * @return DC_OK on success, error code on failure
+ */
+dc_status_t dc_snowflake_map_put(dc_snowflake_map_t* map, dc_snowflake_t key, const void* value);
+
+/**
+ * @brief Find the value slot for a key, inserting a zeroed one if missing
+ * @param map Pointer to map structure
+ * @param key Snowflake key (non-zero)
+ * @param out_value Pointer to store value slot address
+ * @param out_inserted Optional; set to 1 if a new slot was created, 0 otherwise
+ * @return DC_OK on success, error code on failure
+ *
+ * @note The returned pointer is valid until the map is modified
+ */
+dc_status_t dc_snowflake_map_upsert(dc_snowflake_map_t* map, dc_snowflake_t key,
+                                    void** out_value, int* out_inserted);
+
+/**
+ * @brief Look up a value slot
+ * @param map Pointer to map structure
+ * @param key Snowflake key
+ * @return Pointer to value slot, or NULL if not present
+ *
+ * @note The returned pointer is valid until the map is modified
+ */
+void* dc_snowflake_map_get(const dc_snowflake_map_t* map, dc_snowflake_t key);
+
+/**
+ * @brief Check whether a key is present
+ * @param map Pointer to map structure
+ * @param key Snowflake key
+ * @return 1 if present, 0 otherwise
+ */
+int dc_snowflake_map_contains(const dc_snowflake_map_t* map, dc_snowflake_t key);
+
+/**
+ * @brief Remove a key
+ * @param map Pointer to map structure
+ * @param key Snowflake key
+ * @param out_value Optional pointer to receive a copy of the removed value
+ * @return DC_OK on success, DC_ERROR_NOT_FOUND if absent, error code on failure
+ */
+dc_status_t dc_snowflake_map_remove(dc_snowflake_map_t* map, dc_snowflake_t key, void* out_value);
+
+/**
+ * @brief Get number of entries
+ * @param map Pointer to map structure
+ * @return Number of entries or 0 if map is invalid
+ */
+size_t dc_snowflake_map_length(const dc_snowflake_map_t* map);
+
+/**
+ * @brief Iterate over entries
+ * @param map Pointer to map structure
+ * @param cursor Iteration cursor; set to 0 before the first call
+ * @param out_key Optional pointer to store the key
+ * @param out_value Optional pointer to store the value slot address
+ * @return 1 if an entry was produced, 0 when iteration is complete
+ *
+ * @note The map must not be modified during iteration.
+ */
+int dc_snowflake_map_next(const dc_snowflake_map_t* map, size_t* cursor,
+                          dc_snowflake_t* out_key, void** out_value);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DC_SNOWFLAKE_MAP_H */
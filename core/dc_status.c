@@ -33,6 +33,7 @@ const char* dc_status_string(dc_status_t status) {
         case DC_ERROR_SERVER:           return "Server error";
         case DC_ERROR_INVALID_STATE:    return "Invalid state";
         case DC_ERROR_TRY_AGAIN:        return "Try again";
+        case DC_ERROR_MISSING_PERMISSIONS: return "Missing permissions";
         default:                        return "Invalid status code";
     }
 }
@@ -39,7 +39,8 @@ typedef enum {
     DC_ERROR_UNAVAILABLE,          /**< HTTP 502/503 */
     DC_ERROR_SERVER,               /**< HTTP 5xx */
     DC_ERROR_INVALID_STATE,        /**< Invalid state */
-    DC_ERROR_TRY_AGAIN             /**< Temporary failure */
+    DC_ERROR_TRY_AGAIN,            /**< Temporary failure */
+    DC_ERROR_MISSING_PERMISSIONS   /**< Rejected locally: known permissions make it fail */
 } dc_status_t;
 
 /**
@@ -27,6 +27,7 @@ static void dc_secure_zero(void* ptr, size_t len) {
         p[i] = 0;
     }
 #endif
+}
 
 #if defined(__JEMALLOC__)
 __attribute__((weak))
@@ -336,3 +337,21 @@ int dc_string_compare(const dc_string_t* str1, const dc_string_t* str2) {
     const char* b = (str2 && str2->data) ? str2->data : "";
     return strcmp(a, b);
 }
+
+void dc_string_swap(dc_string_t* a, dc_string_t* b) {
+    if (!a || !b || a == b) return;
+    dc_string_t tmp = *a;
+    *a = *b;
+    *b = tmp;
+}
+
+dc_status_t dc_string_take(dc_string_t* dst, dc_string_t* src) {
+    if (!dst || !src) return DC_ERROR_NULL_POINTER;
+    if (dst == src) return DC_OK;
+    dc_string_free(dst);
+    *dst = *src;
+    src->data = NULL;
+    src->length = 0;
+    src->capacity = 0;
+    return DC_OK;
+}
@@ -216,6 +216,24 @@ int dc_string_compare_cstr(const dc_string_t* str, const char* cstr);
  */
 int dc_string_compare(const dc_string_t* str1, const dc_string_t* str2);
 
+/**
+ * @brief Exchange the contents of two strings (no copying)
+ * @param a First string
+ * @param b Second string
+ */
+void dc_string_swap(dc_string_t* a, dc_string_t* b);
+
+/**
+ * @brief Move @p src into @p dst without copying
+ *
+ * @p dst's previous buffer is freed; @p src is left empty and initialized.
+ *
+ * @param dst Destination string (initialized)
+ * @param src Source string
+ * @return DC_OK on success, error code on failure
+ */
+dc_status_t dc_string_take(dc_string_t* dst, dc_string_t* src);
+
 #ifdef __cplusplus
 }
 #endif
@@ -155,6 +155,113 @@ dc_status_t dc_iso8601_parse(const char* str, dc_iso8601_t* timestamp) {
     return dc_iso8601_validate(timestamp);
 }
 
+/* Little-endian load; compilers fold this into a single 8-byte load */
+static inline uint64_t dc_load_le64(const char* p) {
+    const unsigned char* u = (const unsigned char*)p;
+    return (uint64_t)u[0] | ((uint64_t)u[1] << 8) | ((uint64_t)u[2] << 16) | ((uint64_t)u[3] << 24) |
+           ((uint64_t)u[4] << 32) | ((uint64_t)u[5] << 40) | ((uint64_t)u[6] << 48) | ((uint64_t)u[7] << 56);
+}
+
+static inline uint64_t dc_load_le32(const char* p) {
+    const unsigned char* u = (const unsigned char*)p;
+    return (uint64_t)u[0] | ((uint64_t)u[1] << 8) | ((uint64_t)u[2] << 16) | ((uint64_t)u[3] << 24);
+}
+
+/*
+ * @p t is an 8-byte window XORed with its template ('0' at digit bytes, the
+ * literal at separator bytes), so digit bytes must be 0-9 and separator bytes
+ * 0. Returns non-zero if any byte selected by the masks is wrong.
+ */
+static inline uint64_t dc_iso8601_swar_bad(uint64_t t, uint64_t digits, uint64_t seps) {
+    const uint64_t over9 = (((t & 0x7F7F7F7F7F7F7F7FULL) + 0x7676767676767676ULL) | t) & 0x8080808080808080ULL;
+    return (over9 & digits) | (t & seps);
+}
+
+#define DC_ISO8601_BYTE(t, i) ((int)(((t) >> ((i) * 8)) & 0xFF))
+#define DC_ISO8601_DIGIT(s, i) ((unsigned)(unsigned char)(s)[i] - (unsigned)'0')
+
+dc_status_t dc_iso8601_parse_unix_ms(const char* str, size_t len, int64_t* unix_ms) {
+    if (!str || !unix_ms) return DC_ERROR_NULL_POINTER;
+
+    /* Fixed layouts: 19-byte date-time, optional ".fff"/".ffffff", then "Z" or "+hh:mm" */
+    const size_t tz_len = (len > 19 && str[len - 1] == 'Z') ? 1 : 6;
+    const size_t frac_len = len >= 19 + tz_len ? len - 19 - tz_len : (size_t)-1;
+    if (frac_len != 0 && frac_len != 4 && frac_len != 7) {
+        /* Uncommon layout: defer to the general parser */
+        char buf[64];
+        if (len >= sizeof(buf) || memchr(str, '\0', len)) return DC_ERROR_INVALID_FORMAT;
+        memcpy(buf, str, len);
+        buf[len] = '\0';
+        dc_iso8601_t ts;
+        dc_status_t status = dc_iso8601_parse(buf, &ts);
+        if (status != DC_OK) return status;
+        int64_t days = dc_days_from_civil(ts.year, (unsigned)ts.month, (unsigned)ts.day);
+        int64_t seconds = days * 86400 + ts.hour * 3600 + ts.minute * 60 + ts.second;
+        seconds -= (int64_t)(ts.is_utc ? 0 : ts.utc_offset_minutes) * 60;
+        *unix_ms = seconds * 1000 + ts.millisecond;
+        return DC_OK;
+    }
+
+    /* len >= 20 here, so windows at 0, 8 and 12 are in bounds */
+    const uint64_t a = dc_load_le64(str) ^ 0x2D30302D30303030ULL;       /* "0000-00-" */
+    const uint64_t b = dc_load_le64(str + 8) ^ 0x30303A3030543030ULL;   /* "00T00:00" */
+    const uint64_t c = dc_load_le64(str + 12) ^ 0x0030303A00000000ULL;  /* "....:00." */
+    uint64_t bad = dc_iso8601_swar_bad(a, 0x00FFFF00FFFFFFFFULL, 0xFF0000FF00000000ULL) |
+                   dc_iso8601_swar_bad(b, 0xFFFF00FFFF00FFFFULL, 0x0000FF0000FF0000ULL) |
+                   dc_iso8601_swar_bad(c, 0x00FFFF0000000000ULL, 0x000000FF00000000ULL);
+
+    int ms = 0;
+    if (frac_len) {
+        /* ".fff" or ".ffffff"; only the first three digits are kept */
+        const uint64_t f = (frac_len == 7 ? dc_load_le64(str + 19) & 0x00FFFFFFFFFFFFFFULL
+                                          : dc_load_le32(str + 19)) ^ 0x003030303030302EULL;  /* ".000000" */
+        const uint64_t digits = frac_len == 7 ? 0x00FFFFFFFFFFFF00ULL : 0x00000000FFFFFF00ULL;
+        bad |= dc_iso8601_swar_bad(f, digits, 0xFFULL);
+        ms = DC_ISO8601_BYTE(f, 1) * 100 + DC_ISO8601_BYTE(f, 2) * 10 + DC_ISO8601_BYTE(f, 3);
+    }
+
+    int offset = 0;
+    if (tz_len == 6) {
+        /* The last window ends with the offset; "+00:00" is all Discord sends */
+        const uint64_t tz = dc_load_le64(str + len - 8) ^ 0x30303A30302B0000ULL;
+        if (tz & 0xFFFFFFFFFFFF0000ULL) {
+            const uint64_t signed_tz = tz ^ (((uint64_t)(str[len - 6] == '-') * 0x06) << 16);
+            bad |= dc_iso8601_swar_bad(signed_tz, 0xFFFF00FFFF000000ULL, 0x0000FF0000FF0000ULL);
+            offset = (DC_ISO8601_BYTE(tz, 3) * 10 + DC_ISO8601_BYTE(tz, 4)) * 60 +
+                     DC_ISO8601_BYTE(tz, 6) * 10 + DC_ISO8601_BYTE(tz, 7);
+            if (str[len - 6] == '-') offset = -offset;
+        }
+    }
+    if (bad) return DC_ERROR_INVALID_FORMAT;
+
+    const int year = DC_ISO8601_BYTE(a, 0) * 1000 + DC_ISO8601_BYTE(a, 1) * 100 +
+                     DC_ISO8601_BYTE(a, 2) * 10 + DC_ISO8601_BYTE(a, 3);
+    const int month = DC_ISO8601_BYTE(a, 5) * 10 + DC_ISO8601_BYTE(a, 6);
+    const int day = DC_ISO8601_BYTE(b, 0) * 10 + DC_ISO8601_BYTE(b, 1);
+    const int hour = DC_ISO8601_BYTE(b, 3) * 10 + DC_ISO8601_BYTE(b, 4);
+    const int minute = DC_ISO8601_BYTE(b, 6) * 10 + DC_ISO8601_BYTE(b, 7);
+    const int second = DC_ISO8601_BYTE(c, 5) * 10 + DC_ISO8601_BYTE(c, 6);
+    if (month < 1 || month > 12) return DC_ERROR_INVALID_PARAM;
+    if (day < 1 || (day > 28 && day > dc_days_in_month(year, month))) return DC_ERROR_INVALID_PARAM;
+    if (hour > 23 || minute > 59 || second > 59) return DC_ERROR_INVALID_PARAM;
+    if (offset < -14 * 60 || offset > 14 * 60) return DC_ERROR_INVALID_PARAM;
+
+    /* dc_days_from_civil() for years 0-9999, shifted one era so the divisions stay unsigned */
+    const unsigned y = (unsigned)year + 400u - (month <= 2);
+    const unsigned era = y / 400u;
+    const unsigned yoe = y - era * 400u;
+    const unsigned doy = (153u * (unsigned)(month > 2 ? month - 3 : month + 9) + 2u) / 5u + (unsigned)day - 1u;
+    const unsigned doe = yoe * 365u + yoe / 4u - yoe / 100u + doy;
+    const int64_t days = (int64_t)era * 146097 + (int64_t)doe - 719468 - 146097;
+
+    int64_t seconds = days * 86400 + hour * 3600 + minute * 60 + second - (int64_t)offset * 60;
+    *unix_ms = seconds * 1000 + ms;
+    return DC_OK;
+}
+
+#undef DC_ISO8601_BYTE
+#undef DC_ISO8601_DIGIT
+
 dc_status_t dc_iso8601_format(const dc_iso8601_t* timestamp, dc_string_t* str) {
     if (!str) return DC_ERROR_NULL_POINTER;
     char buf[64];
@@ -123,6 +123,31 @@ typedef struct {
  */
 dc_status_t dc_iso8601_parse(const char* str, dc_iso8601_t* timestamp);
 
+/**
+ * @brief Parse an ISO 8601 string straight to signed Unix milliseconds.
+ *
+ * Fast path for bulk decoding. Discord's fixed layouts are dispatched on
+ * length and converted without building a dc_iso8601_t:
+ *   "2024-01-15T09:30:00+00:00"          (25)
+ *   "2024-01-15T09:30:00.123+00:00"      (29)
+ *   "2024-01-15T09:30:00.123456+00:00"   (32)
+ * and the same layouts with a 'Z' designator. Any other string accepted by
+ * dc_iso8601_parse() (1-2 or 4-5 fraction digits, for example) falls back
+ * to it, so both functions accept exactly the same inputs and return the
+ * same errors.
+ *
+ * The result is signed, so pre-epoch timestamps are valid here.
+ *
+ * @param str        ISO 8601 text. Need not be null-terminated. Must not be NULL.
+ * @param len        Length of str in bytes.
+ * @param unix_ms    Output: milliseconds since the Unix epoch, UTC. Must not be NULL.
+ * @return DC_OK on success.
+ * @return DC_ERROR_NULL_POINTER if str or unix_ms is NULL.
+ * @return DC_ERROR_INVALID_FORMAT if the string does not match the expected format.
+ * @return DC_ERROR_INVALID_PARAM if any parsed field is out of the valid range.
+ */
+dc_status_t dc_iso8601_parse_unix_ms(const char* str, size_t len, int64_t* unix_ms);
+
 /**
  * @brief Format a dc_iso8601_t timestamp into a dc_string_t.
  *
@@ -35,6 +35,8 @@ dc_gateway_event_kind_t dc_gateway_event_kind_from_name(const char* name) {
     if (strcmp(name, "MESSAGE_DELETE") == 0) return DC_GATEWAY_EVENT_MESSAGE_DELETE;
     if (strcmp(name, "MESSAGE_DELETE_BULK") == 0) return DC_GATEWAY_EVENT_MESSAGE_DELETE_BULK;
     if (strcmp(name, "INTERACTION_CREATE") == 0) return DC_GATEWAY_EVENT_INTERACTION_CREATE;
+    if (strcmp(name, "MESSAGE_POLL_VOTE_ADD") == 0) return DC_GATEWAY_EVENT_MESSAGE_POLL_VOTE_ADD;
+    if (strcmp(name, "MESSAGE_POLL_VOTE_REMOVE") == 0) return DC_GATEWAY_EVENT_MESSAGE_POLL_VOTE_REMOVE;
     return DC_GATEWAY_EVENT_UNKNOWN;
 }
 
@@ -124,8 +126,8 @@ static dc_status_t dc_gateway_copy_optional_iso8601_string(yyjson_val* obj,
     if (st != DC_OK) return st;
     if (!str_opt.is_set) return DC_OK;
 
-    dc_iso8601_t ts;
-    st = dc_iso8601_parse(str_opt.value, &ts);
+    int64_t ms = 0;
+    st = dc_iso8601_parse_unix_ms(str_opt.value, strlen(str_opt.value), &ms);
     if (st != DC_OK) return st;
 
     st = dc_string_set_cstr(&out->value, str_opt.value);
@@ -153,8 +155,8 @@ static dc_status_t dc_gateway_copy_present_nullable_iso8601_string(yyjson_val* o
     const char* str = yyjson_get_str(field);
     if (!str) return DC_ERROR_INVALID_FORMAT;
 
-    dc_iso8601_t ts;
-    dc_status_t st = dc_iso8601_parse(str, &ts);
+    int64_t ms = 0;
+    dc_status_t st = dc_iso8601_parse_unix_ms(str, yyjson_get_len(field), &ms);
     if (st != DC_OK) return st;
 
     st = dc_string_set_cstr(&out->value, str);
@@ -1223,8 +1225,10 @@ dc_status_t dc_gateway_event_parse_message_update(const char* event_data,
         tmp.flags.value = flags_u32;
     }
 
-    st = dc_gateway_copy_raw_json(doc.root, &tmp.raw_json);
-    if (st != DC_OK) goto fail;
+    if (dc_json_model_raw_capture_enabled(DC_JSON_RAW_CAPTURE_MESSAGE_UPDATE)) {
+        st = dc_gateway_copy_raw_json(doc.root, &tmp.raw_json);
+        if (st != DC_OK) goto fail;
+    }
 
     dc_json_doc_free(&doc);
     *update = tmp;
@@ -1284,6 +1288,67 @@ fail:
     return st;
 }
 
+dc_status_t dc_gateway_message_poll_vote_init(dc_gateway_message_poll_vote_t* vote) {
+    if (!vote) return DC_ERROR_NULL_POINTER;
+    memset(vote, 0, sizeof(*vote));
+    return DC_OK;
+}
+
+void dc_gateway_message_poll_vote_free(dc_gateway_message_poll_vote_t* vote) {
+    if (!vote) return;
+    memset(vote, 0, sizeof(*vote));
+}
+
+dc_status_t dc_gateway_event_parse_message_poll_vote(const char* event_data,
+                                                     dc_gateway_message_poll_vote_t* vote) {
+    if (!event_data || !vote) return DC_ERROR_NULL_POINTER;
+
+    dc_json_doc_t doc;
+    dc_status_t st = dc_json_parse(event_data, &doc);
+    if (st != DC_OK) return st;
+
+    dc_gateway_message_poll_vote_t tmp;
+    st = dc_gateway_message_poll_vote_init(&tmp);
+    if (st != DC_OK) {
+        dc_json_doc_free(&doc);
+        return st;
+    }
+
+    uint64_t sf = 0;
+    st = dc_json_get_snowflake(doc.root, "user_id", &sf);
+    if (st != DC_OK) goto fail;
+    tmp.user_id = (dc_snowflake_t)sf;
+
+    st = dc_json_get_snowflake(doc.root, "channel_id", &sf);
+    if (st != DC_OK) goto fail;
+    tmp.channel_id = (dc_snowflake_t)sf;
+
+    st = dc_json_get_snowflake(doc.root, "message_id", &sf);
+    if (st != DC_OK) goto fail;
+    tmp.message_id = (dc_snowflake_t)sf;
+
+    st = dc_gateway_parse_optional_snowflake(doc.root, "guild_id", &tmp.guild_id);
+    if (st != DC_OK) goto fail;
+
+    int64_t answer_id = 0;
+    st = dc_json_get_int64(doc.root, "answer_id", &answer_id);
+    if (st != DC_OK) goto fail;
+    if (answer_id <= 0 || answer_id > UINT32_MAX) {
+        st = DC_ERROR_INVALID_FORMAT;
+        goto fail;
+    }
+    tmp.answer_id = (uint32_t)answer_id;
+
+    dc_json_doc_free(&doc);
+    *vote = tmp;
+    return DC_OK;
+
+fail:
+    dc_json_doc_free(&doc);
+    dc_gateway_message_poll_vote_free(&tmp);
+    return st;
+}
+
 dc_status_t dc_gateway_message_delete_bulk_init(dc_gateway_message_delete_bulk_t* bulk_delete) {
     if (!bulk_delete) return DC_ERROR_NULL_POINTER;
     memset(bulk_delete, 0, sizeof(*bulk_delete));
@@ -44,7 +44,9 @@ typedef enum {
     DC_GATEWAY_EVENT_MESSAGE_UPDATE,
     DC_GATEWAY_EVENT_MESSAGE_DELETE,
     DC_GATEWAY_EVENT_MESSAGE_DELETE_BULK,
-    DC_GATEWAY_EVENT_INTERACTION_CREATE
+    DC_GATEWAY_EVENT_INTERACTION_CREATE,
+    DC_GATEWAY_EVENT_MESSAGE_POLL_VOTE_ADD,
+    DC_GATEWAY_EVENT_MESSAGE_POLL_VOTE_REMOVE
 } dc_gateway_event_kind_t;
 
 dc_gateway_event_kind_t dc_gateway_event_kind_from_name(const char* name);
@@ -170,7 +172,7 @@ typedef struct {
     dc_optional_u64_field_t flags;       /**< Message flags when present */
     int has_member;                      /**< Whether member is present */
     dc_guild_member_t member;            /**< Partial guild member when present */
-    dc_string_t raw_json;                /**< Raw MESSAGE_UPDATE payload JSON */
+    dc_string_t raw_json;                /**< Raw MESSAGE_UPDATE payload JSON (see dc_json_model_set_raw_capture) */
 } dc_gateway_message_update_t;
 
 dc_status_t dc_gateway_message_update_init(dc_gateway_message_update_t* update);
@@ -200,6 +202,31 @@ void dc_gateway_message_delete_bulk_free(dc_gateway_message_delete_bulk_t* bulk_
 dc_status_t dc_gateway_event_parse_message_delete_bulk(const char* event_data,
                                                        dc_gateway_message_delete_bulk_t* bulk_delete);
 
+/**
+ * @brief Gateway MESSAGE_POLL_VOTE_ADD/MESSAGE_POLL_VOTE_REMOVE event data
+ *
+ * Needs the GUILD_MESSAGE_POLLS or DIRECT_MESSAGE_POLLS intent.
+ */
+typedef struct {
+    dc_snowflake_t user_id;           /**< Voter */
+    dc_snowflake_t channel_id;        /**< Channel ID */
+    dc_snowflake_t message_id;        /**< Poll message ID */
+    dc_optional_snowflake_t guild_id; /**< Guild ID when present */
+    uint32_t answer_id;               /**< Answer voted for (1-based) */
+} dc_gateway_message_poll_vote_t;
+
+dc_status_t dc_gateway_message_poll_vote_init(dc_gateway_message_poll_vote_t* vote);
+void dc_gateway_message_poll_vote_free(dc_gateway_message_poll_vote_t* vote);
+
+/**
+ * @brief Parse MESSAGE_POLL_VOTE_ADD or MESSAGE_POLL_VOTE_REMOVE payload
+ * @param event_data JSON payload (event "d" object)
+ * @param vote Output vote (replaces contents on success)
+ * @return DC_OK on success, error code on failure
+ */
+dc_status_t dc_gateway_event_parse_message_poll_vote(const char* event_data,
+                                                     dc_gateway_message_poll_vote_t* vote);
+
 /**
  * @brief Parse INTERACTION_CREATE event payload
  * @param event_data JSON payload (event "d" object)
@@ -8,6 +8,7 @@
 #include "core/dc_platform.h"
 #include "core/dc_vec.h"
 #include "http/dc_http_compliance.h"
+#include "http/dc_tls_sessions.h"
 #include "json/dc_json.h"
 #include <libwebsockets.h>
 #include <yyjson.h>
@@ -17,6 +18,11 @@
 #include <time.h>
 #include <zlib.h>
 
+/* lws hands out OpenSSL objects (SSL_CTX, SSL) only on its OpenSSL backend. */
+#if defined(DC_HAVE_OPENSSL) && defined(LWS_WITH_TLS) && !defined(LWS_WITH_MBEDTLS)
+#define DC_GATEWAY_LWS_OPENSSL 1
+#endif
+
 #define DC_GATEWAY_API_VERSION 10
 #define DC_GATEWAY_ENCODING "json"
 #define DC_GATEWAY_COMPRESS_QUERY "compress=zlib-stream"
@@ -43,6 +49,7 @@ typedef struct {
 struct dc_gateway_client {
     dc_string_t token;
     dc_string_t user_agent;
+    dc_string_t extra_ca_pem;
     uint32_t intents;
     uint32_t shard_id;
     uint32_t shard_count;
@@ -58,6 +65,8 @@ struct dc_gateway_client {
 
     struct lws_context* context;
     struct lws* wsi;
+    const char* tls_host;   /* Points into connect_url; NULL for plain ws */
+    int tls_port;
 
     dc_string_t base_url;
     dc_string_t connect_url;
@@ -864,14 +873,80 @@ static dc_status_t dc_gateway_inflate(dc_gateway_client_t* client, dc_string_t*
     return DC_OK;
 }
 
+#if defined(LWS_WITH_TLS_SESSIONS)
+static dc_status_t dc_gateway_tls_load_visit(void* ctx, const dc_tls_session_t* session) {
+    struct lws_tls_session_dump* info = (struct lws_tls_session_dump*)ctx;
+    if (info->blob || !session->data || session->data_len == 0) return DC_ERROR_INVALID_PARAM;
+    /* lws releases the blob with free(). */
+    info->blob = malloc(session->data_len);
+    if (!info->blob) return DC_ERROR_OUT_OF_MEMORY;
+    memcpy(info->blob, session->data, session->data_len);
+    info->blob_len = session->data_len;
+    return DC_OK;
+}
+
+static int dc_gateway_tls_load_cb(struct lws_context* cx, struct lws_tls_session_dump* info) {
+    (void)cx;
+    info->blob = NULL;
+    info->blob_len = 0;
+    (void)dc_tls_sessions_store_load(DC_TLS_SESSION_SOURCE_GATEWAY, info->tag,
+                                     dc_gateway_tls_load_visit, info);
+    return info->blob ? 0 : 1;
+}
+
+static int dc_gateway_tls_save_cb(struct lws_context* cx, struct lws_tls_session_dump* info) {
+    (void)cx;
+    dc_tls_session_t session;
+    memset(&session, 0, sizeof(session));
+    session.source = DC_TLS_SESSION_SOURCE_GATEWAY;
+    session.key = info->tag;
+    session.data = (const unsigned char*)info->blob;
+    session.data_len = info->blob_len;
+    return dc_tls_sessions_store_save(&session) == DC_OK ? 0 : 1;
+}
+#endif
+
+static void dc_gateway_tls_established(dc_gateway_client_t* client, struct lws* wsi) {
+    if (!client->tls_host) return;
+    void* ssl = NULL;
+#if defined(DC_GATEWAY_LWS_OPENSSL)
+    ssl = lws_get_ssl(wsi);
+#endif
+#if defined(LWS_WITH_TLS_SESSIONS)
+    int reused = lws_tls_session_is_reused(wsi);
+    dc_tls_sessions_record_gateway(reused ? 1 : 0, ssl);
+    if (!reused && dc_tls_sessions_has_store()) {
+        (void)lws_tls_session_dump_save(lws_get_vhost(wsi), client->tls_host,
+                                        (uint16_t)client->tls_port, dc_gateway_tls_save_cb, NULL);
+    }
+#else
+    (void)wsi;
+    dc_tls_sessions_record_gateway(-1, ssl);
+#endif
+}
+
 static int dc_gateway_lws_callback(struct lws* wsi, enum lws_callback_reasons reason,
                                    void* user, void* in, size_t len) {
+#if defined(DC_GATEWAY_LWS_OPENSSL)
+    /* Fired once per context while its client SSL_CTX is set up. */
+    if (reason == LWS_CALLBACK_OPENSSL_LOAD_EXTRA_CLIENT_VERIFY_CERTS) {
+        dc_tls_configure_ssl_ctx(user);
+        /* The context, not the (fake) wsi, knows which client it belongs to. */
+        dc_gateway_client_t* owner = wsi ? (dc_gateway_client_t*)lws_context_user(lws_get_context(wsi)) : NULL;
+        if (owner && !dc_string_is_empty(&owner->extra_ca_pem) &&
+            dc_tls_ssl_ctx_add_ca_pem(user, dc_string_cstr(&owner->extra_ca_pem)) != DC_OK) {
+            return 1;
+        }
+        return 0;
+    }
+#endif
     (void)user;
     dc_gateway_client_t* client = (dc_gateway_client_t*)lws_wsi_user(wsi);
     if (!client) return 0;
 
     switch (reason) {
         case LWS_CALLBACK_CLIENT_ESTABLISHED:
+            dc_gateway_tls_established(client, wsi);
             dc_gateway_set_state(client, DC_GATEWAY_CONNECTED);
             client->reconnect_requested = 0;
             client->reconnect_backoff_ms = 0;
@@ -1012,6 +1087,7 @@ static dc_status_t dc_gateway_context_ensure(dc_gateway_client_t* client) {
     info.port = CONTEXT_PORT_NO_LISTEN;
     info.protocols = dc_gateway_protocols;
     info.options = LWS_SERVER_OPTION_DO_SSL_GLOBAL_INIT;
+    info.user = client;
     client->context = lws_create_context(&info);
     if (!client->context) return DC_ERROR_WEBSOCKET;
     return DC_OK;
@@ -1039,6 +1115,18 @@ static dc_status_t dc_gateway_connect_url(dc_gateway_client_t* client, const cha
     info.host = address;
     info.origin = address;
     info.ssl_connection = strcmp(proto, "wss") == 0 ? LCCSCF_USE_SSL : 0;
+    client->tls_host = info.ssl_connection ? address : NULL;
+    client->tls_port = port;
+#if defined(LWS_WITH_TLS_SESSIONS)
+    /* The context outlives reconnects, so this only fills a cold cache. */
+    if (client->tls_host && dc_tls_sessions_has_store()) {
+        struct lws_vhost* vhost = lws_get_vhost_by_name(client->context, "default");
+        if (vhost) {
+            (void)lws_tls_session_dump_load(vhost, address, (uint16_t)port,
+                                            dc_gateway_tls_load_cb, NULL);
+        }
+    }
+#endif
     info.protocol = dc_gateway_protocols[0].name;
     info.pwsi = &client->wsi;
     info.userdata = client;
@@ -1073,6 +1161,12 @@ dc_status_t dc_gateway_client_create(const dc_gateway_config_t* config, dc_gatew
             return DC_ERROR_INVALID_PARAM;
         }
     }
+    if (config->extra_ca_pem) {
+        if (config->extra_ca_pem[0] == '\0') return DC_ERROR_INVALID_PARAM;
+#if !defined(DC_GATEWAY_LWS_OPENSSL)
+        return DC_ERROR_NOT_IMPLEMENTED;
+#endif
+    }
 
     *client = NULL;
     dc_gateway_client_t* c = (dc_gateway_client_t*)dc_alloc(sizeof(dc_gateway_client_t));
@@ -1113,6 +1207,7 @@ dc_status_t dc_gateway_client_create(const dc_gateway_config_t* config, dc_gatew
     c->enable_payload_compression = config->enable_payload_compression ? 1 : 0;
     c->state = DC_GATEWAY_DISCONNECTED;
 
+    dc_string_init(&c->extra_ca_pem);
     dc_string_init(&c->base_url);
     dc_string_init(&c->connect_url);
     dc_string_init(&c->resume_url);
@@ -1121,6 +1216,14 @@ dc_status_t dc_gateway_client_create(const dc_gateway_config_t* config, dc_gatew
     dc_string_init(&c->compressed_buf);
     dc_string_init(&c->event_buf);
 
+    if (config->extra_ca_pem) {
+        st = dc_string_set_cstr(&c->extra_ca_pem, config->extra_ca_pem);
+        if (st != DC_OK) {
+            dc_gateway_client_free(c);
+            return st;
+        }
+    }
+
     st = dc_string_reserve(&c->rx_buf, DC_GATEWAY_RX_INITIAL_CAP);
     if (st != DC_OK) {
         dc_gateway_client_free(c);
@@ -1183,6 +1286,7 @@ void dc_gateway_client_free(dc_gateway_client_t* client) {
     dc_string_free(&client->resume_url);
     dc_string_free(&client->connect_url);
     dc_string_free(&client->base_url);
+    dc_string_free(&client->extra_ca_pem);
     dc_string_free(&client->user_agent);
     dc_string_free(&client->token);
     dc_free(client);
@@ -51,7 +51,9 @@ typedef enum {
     DC_INTENT_MESSAGE_CONTENT           = 1 << 15,
     DC_INTENT_GUILD_SCHEDULED_EVENTS    = 1 << 16,
     DC_INTENT_AUTO_MODERATION_CONFIG    = 1 << 20,
-    DC_INTENT_AUTO_MODERATION_EXECUTION = 1 << 21
+    DC_INTENT_AUTO_MODERATION_EXECUTION = 1 << 21,
+    DC_INTENT_GUILD_MESSAGE_POLLS       = 1 << 24,
+    DC_INTENT_DIRECT_MESSAGE_POLLS      = 1 << 25
 } dc_gateway_intent_t;
 
 /**
@@ -151,6 +153,8 @@ typedef struct {
     uint32_t connect_timeout_ms;                /**< Connection timeout */
     int enable_compression;                     /**< Enable zlib-stream transport compression (JSON only) */
     int enable_payload_compression;             /**< Enable Identify payload compression (JSON only) */
+    const char* extra_ca_pem;                   /**< Extra PEM CAs trusted on top of the system store, e.g. for a
+                                                     local proxy (optional; needs libwebsockets on OpenSSL) */
 } dc_gateway_config_t;
 
 /**
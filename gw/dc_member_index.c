@@ -0,0 +1,777 @@
+/**
+ * @file dc_member_index.c
+ * @brief Local per-guild member name index
+ */
+
+#include "dc_member_index.h"
+#include "core/dc_alloc.h"
+#include "core/dc_vec.h"
+#include "json/dc_json.h"
+#include <string.h>
+#include <stdlib.h>
+#include <yyjson.h>
+
+/* Name slots, in resolve priority order. */
+#define DC_MEMBER_NAME_NICK 0
+#define DC_MEMBER_NAME_GLOBAL 1
+#define DC_MEMBER_NAME_USERNAME 2
+#define DC_MEMBER_NAME_COUNT 3
+
+#define DC_MEMBER_INDEX_MAX_NAME 128
+
+typedef struct {
+    dc_snowflake_t user_id;                 /* 0 = free slot */
+    char* names[DC_MEMBER_NAME_COUNT];      /* folded, NULL if absent */
+} dc_member_record_t;
+
+typedef struct {
+    const char* name;       /* borrowed from the record */
+    uint32_t record;
+    uint32_t kind;
+} dc_member_name_ref_t;
+
+typedef struct {
+    dc_snowflake_map_t members;   /* user_id -> uint32_t record index */
+    dc_vec_t records;             /* dc_member_record_t */
+    dc_vec_t free_records;        /* uint32_t */
+    dc_vec_t sorted;              /* dc_member_name_ref_t, by (name, kind, record) */
+    size_t sorted_length;         /* sorted prefix; the tail holds refs not yet merged */
+    dc_snowflake_map_t trigrams;  /* packed trigram -> dc_vec_t of uint32_t record */
+} dc_member_guild_index_t;
+
+typedef struct {
+    uint32_t record;
+    uint32_t shared;
+    size_t best_len;
+} dc_member_candidate_t;
+
+static size_t dc_member_fold(const char* in, char* out, size_t out_size) {
+    size_t n = 0;
+    if (!in || out_size == 0) return 0;
+    for (; in[n] && n + 1 < out_size; n++) {
+        unsigned char c = (unsigned char)in[n];
+        out[n] = (c >= 'A' && c <= 'Z') ? (char)(c + ('a' - 'A')) : (char)c;
+    }
+    out[n] = '\0';
+    return n;
+}
+
+static dc_snowflake_t dc_member_trigram_key(unsigned char a, unsigned char b, unsigned char c) {
+    return ((dc_snowflake_t)a << 16) | ((dc_snowflake_t)b << 8) | (dc_snowflake_t)c;
+}
+
+/* Padded as "  name " so short names and word starts still produce trigrams. */
+static size_t dc_member_trigrams(const char* folded, dc_snowflake_t* out, size_t out_cap) {
+    size_t len = strlen(folded);
+    size_t count = 0;
+    for (size_t i = 0; i < len + 1 && count < out_cap; i++) {
+        unsigned char w[3];
+        for (size_t k = 0; k < 3; k++) {
+            size_t pos = i + k;
+            if (pos < 2) {
+                w[k] = ' ';
+            } else if (pos - 2 < len) {
+                w[k] = (unsigned char)folded[pos - 2];
+            } else {
+                w[k] = ' ';
+            }
+        }
+        out[count++] = dc_member_trigram_key(w[0], w[1], w[2]);
+    }
+    return count;
+}
+
+static int dc_member_name_has_trigram(const char* folded, dc_snowflake_t key) {
+    dc_snowflake_t grams[DC_MEMBER_INDEX_MAX_NAME + 1];
+    size_t n = dc_member_trigrams(folded, grams, DC_MEMBER_INDEX_MAX_NAME + 1);
+    for (size_t i = 0; i < n; i++) {
+        if (grams[i] == key) return 1;
+    }
+    return 0;
+}
+
+static int dc_member_name_ref_cmp(const dc_member_name_ref_t* a, const dc_member_name_ref_t* b) {
+    int c = strcmp(a->name, b->name);
+    if (c != 0) return c;
+    if (a->kind != b->kind) return a->kind < b->kind ? -1 : 1;
+    if (a->record != b->record) return a->record < b->record ? -1 : 1;
+    return 0;
+}
+
+static size_t dc_member_lower_bound(const dc_member_guild_index_t* g, const dc_member_name_ref_t* key) {
+    size_t lo = 0;
+    size_t hi = g->sorted_length;
+    const dc_member_name_ref_t* refs = (const dc_member_name_ref_t*)g->sorted.data;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2u;
+        if (dc_member_name_ref_cmp(&refs[mid], key) < 0) {
+            lo = mid + 1u;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+static size_t dc_member_lower_bound_name(const dc_member_guild_index_t* g, const char* name) {
+    size_t lo = 0;
+    size_t hi = g->sorted_length;
+    const dc_member_name_ref_t* refs = (const dc_member_name_ref_t*)g->sorted.data;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2u;
+        if (strcmp(refs[mid].name, name) < 0) {
+            lo = mid + 1u;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+static dc_status_t dc_member_guild_init(dc_member_guild_index_t* g) {
+    memset(g, 0, sizeof(*g));
+    dc_status_t st = dc_snowflake_map_init(&g->members, sizeof(uint32_t));
+    if (st == DC_OK) st = dc_vec_init(&g->records, sizeof(dc_member_record_t));
+    if (st == DC_OK) st = dc_vec_init(&g->free_records, sizeof(uint32_t));
+    if (st == DC_OK) st = dc_vec_init(&g->sorted, sizeof(dc_member_name_ref_t));
+    if (st == DC_OK) st = dc_snowflake_map_init(&g->trigrams, sizeof(dc_vec_t));
+    return st;
+}
+
+static void dc_member_guild_free(dc_member_guild_index_t* g) {
+    for (size_t i = 0; i < dc_vec_length(&g->records); i++) {
+        dc_member_record_t* rec = (dc_member_record_t*)dc_vec_at(&g->records, i);
+        for (size_t k = 0; k < DC_MEMBER_NAME_COUNT; k++) dc_free(rec->names[k]);
+    }
+    size_t cursor = 0;
+    void* slot = NULL;
+    while (dc_snowflake_map_next(&g->trigrams, &cursor, NULL, &slot)) {
+        dc_vec_free((dc_vec_t*)slot);
+    }
+    dc_snowflake_map_free(&g->trigrams);
+    dc_vec_free(&g->sorted);
+    dc_vec_free(&g->free_records);
+    dc_vec_free(&g->records);
+    dc_snowflake_map_free(&g->members);
+    memset(g, 0, sizeof(*g));
+}
+
+static int dc_member_trigram_cmp(const void* a, const void* b) {
+    dc_snowflake_t x = *(const dc_snowflake_t*)a;
+    dc_snowflake_t y = *(const dc_snowflake_t*)b;
+    return (x > y) - (x < y);
+}
+
+static size_t dc_member_trigrams_unique(dc_snowflake_t* grams, size_t count) {
+    if (count < 2) return count;
+    qsort(grams, count, sizeof(dc_snowflake_t), dc_member_trigram_cmp);
+    size_t out = 1;
+    for (size_t i = 1; i < count; i++) {
+        if (grams[i] != grams[out - 1]) grams[out++] = grams[i];
+    }
+    return out;
+}
+
+/* Distinct trigrams across all of a record's names. */
+static size_t dc_member_record_trigrams(const dc_member_record_t* rec, dc_snowflake_t* out, size_t out_cap) {
+    size_t count = 0;
+    for (size_t k = 0; k < DC_MEMBER_NAME_COUNT; k++) {
+        if (!rec->names[k] || count >= out_cap) continue;
+        count += dc_member_trigrams(rec->names[k], out + count, out_cap - count);
+    }
+    return dc_member_trigrams_unique(out, count);
+}
+
+static void dc_member_unlink_record(dc_member_guild_index_t* g, uint32_t record) {
+    dc_member_record_t* rec = (dc_member_record_t*)dc_vec_at(&g->records, record);
+    if (!rec) return;
+
+    for (uint32_t k = 0; k < DC_MEMBER_NAME_COUNT; k++) {
+        if (!rec->names[k]) continue;
+        dc_member_name_ref_t key = { rec->names[k], record, k };
+        size_t pos = dc_member_lower_bound(g, &key);
+        const dc_member_name_ref_t* refs = (const dc_member_name_ref_t*)g->sorted.data;
+        if (pos < g->sorted_length && dc_member_name_ref_cmp(&refs[pos], &key) == 0) {
+            (void)dc_vec_remove(&g->sorted, pos, NULL);
+            g->sorted_length--;
+            continue;
+        }
+        for (size_t i = g->sorted_length; i < g->sorted.length; i++) {
+            if (refs[i].record == record && refs[i].kind == k) {
+                (void)dc_vec_swap_remove(&g->sorted, i, NULL);
+                break;
+            }
+        }
+    }
+
+    dc_snowflake_t grams[DC_MEMBER_NAME_COUNT * (DC_MEMBER_INDEX_MAX_NAME + 1)];
+    size_t n = dc_member_record_trigrams(rec, grams, sizeof(grams) / sizeof(grams[0]));
+    for (size_t i = 0; i < n; i++) {
+        dc_vec_t* posting = (dc_vec_t*)dc_snowflake_map_get(&g->trigrams, grams[i]);
+        if (!posting) continue;
+        const uint32_t* ids = (const uint32_t*)posting->data;
+        for (size_t j = 0; j < posting->length; j++) {
+            if (ids[j] == record) {
+                (void)dc_vec_swap_remove(posting, j, NULL);
+                break;
+            }
+        }
+        if (posting->length == 0) {
+            dc_vec_free(posting);
+            (void)dc_snowflake_map_remove(&g->trigrams, grams[i], NULL);
+        }
+    }
+
+    for (size_t k = 0; k < DC_MEMBER_NAME_COUNT; k++) {
+        dc_free(rec->names[k]);
+        rec->names[k] = NULL;
+    }
+}
+
+static dc_status_t dc_member_link_record(dc_member_guild_index_t* g, uint32_t record) {
+    dc_member_record_t* rec = (dc_member_record_t*)dc_vec_at(&g->records, record);
+    if (!rec) return DC_ERROR_INVALID_STATE;
+
+    for (uint32_t k = 0; k < DC_MEMBER_NAME_COUNT; k++) {
+        if (!rec->names[k]) continue;
+        dc_member_name_ref_t ref = { rec->names[k], record, k };
+        dc_status_t st = dc_vec_push(&g->sorted, &ref);
+        if (st != DC_OK) return st;
+    }
+
+    dc_snowflake_t grams[DC_MEMBER_NAME_COUNT * (DC_MEMBER_INDEX_MAX_NAME + 1)];
+    size_t n = dc_member_record_trigrams(rec, grams, sizeof(grams) / sizeof(grams[0]));
+    for (size_t i = 0; i < n; i++) {
+        void* slot = NULL;
+        int inserted = 0;
+        dc_status_t st = dc_snowflake_map_upsert(&g->trigrams, grams[i], &slot, &inserted);
+        if (st != DC_OK) return st;
+        dc_vec_t* posting = (dc_vec_t*)slot;
+        if (inserted) {
+            st = dc_vec_init(posting, sizeof(uint32_t));
+            if (st != DC_OK) {
+                (void)dc_snowflake_map_remove(&g->trigrams, grams[i], NULL);
+                return st;
+            }
+        }
+        st = dc_vec_push(posting, &record);
+        if (st != DC_OK) return st;
+    }
+    return DC_OK;
+}
+
+static int dc_member_name_ref_qsort_cmp(const void* a, const void* b) {
+    return dc_member_name_ref_cmp((const dc_member_name_ref_t*)a, (const dc_member_name_ref_t*)b);
+}
+
+/*
+ * Sort pending refs and merge them into the sorted prefix from the back,
+ * binary-searching each pending ref's slot so every prefix element moves at
+ * most once. Batches (GUILD_CREATE, member chunks) commit once.
+ */
+static dc_status_t dc_member_guild_commit(dc_member_guild_index_t* g) {
+    size_t total = g->sorted.length;
+    size_t head = g->sorted_length;
+    if (head == total) return DC_OK;
+
+    dc_member_name_ref_t* refs = (dc_member_name_ref_t*)g->sorted.data;
+    size_t pending = total - head;
+    qsort(refs + head, pending, sizeof(dc_member_name_ref_t), dc_member_name_ref_qsort_cmp);
+    if (head > 0) {
+        dc_member_name_ref_t* tail = (dc_member_name_ref_t*)dc_calloc(pending, sizeof(dc_member_name_ref_t));
+        if (!tail) return DC_ERROR_OUT_OF_MEMORY;
+        memcpy(tail, refs + head, pending * sizeof(dc_member_name_ref_t));
+        size_t end = head;
+        size_t out = total;
+        for (size_t j = pending; j-- > 0;) {
+            size_t lo = 0;
+            size_t hi = end;
+            while (lo < hi) {
+                size_t mid = lo + (hi - lo) / 2u;
+                if (dc_member_name_ref_cmp(&refs[mid], &tail[j]) <= 0) {
+                    lo = mid + 1u;
+                } else {
+                    hi = mid;
+                }
+            }
+            size_t moved = end - lo;
+            out -= moved;
+            memmove(refs + out, refs + lo, moved * sizeof(dc_member_name_ref_t));
+            end = lo;
+            refs[--out] = tail[j];
+        }
+        dc_free(tail);
+    }
+    g->sorted_length = total;
+    return DC_OK;
+}
+
+static int dc_member_names_equal(const dc_member_record_t* rec, char* const* names) {
+    for (size_t k = 0; k < DC_MEMBER_NAME_COUNT; k++) {
+        const char* a = rec->names[k];
+        const char* b = names[k];
+        if (!a != !b) return 0;
+        if (a && strcmp(a, b) != 0) return 0;
+    }
+    return 1;
+}
+
+static dc_status_t dc_member_get_guild(dc_member_index_t* index, dc_snowflake_t guild_id,
+                                       dc_member_guild_index_t** out) {
+    void* slot = NULL;
+    int inserted = 0;
+    dc_status_t st = dc_snowflake_map_upsert(&index->guilds, guild_id, &slot, &inserted);
+    if (st != DC_OK) return st;
+    dc_member_guild_index_t* g = (dc_member_guild_index_t*)slot;
+    if (inserted) {
+        st = dc_member_guild_init(g);
+        if (st != DC_OK) {
+            dc_member_guild_free(g);
+            (void)dc_snowflake_map_remove(&index->guilds, guild_id, NULL);
+            return st;
+        }
+    }
+    *out = g;
+    return DC_OK;
+}
+
+dc_status_t dc_member_index_init(dc_member_index_t* index) {
+    if (!index) return DC_ERROR_NULL_POINTER;
+    memset(index, 0, sizeof(*index));
+    return dc_snowflake_map_init(&index->guilds, sizeof(dc_member_guild_index_t));
+}
+
+void dc_member_index_free(dc_member_index_t* index) {
+    if (!index) return;
+    size_t cursor = 0;
+    void* slot = NULL;
+    while (dc_snowflake_map_next(&index->guilds, &cursor, NULL, &slot)) {
+        dc_member_guild_free((dc_member_guild_index_t*)slot);
+    }
+    dc_snowflake_map_free(&index->guilds);
+    memset(index, 0, sizeof(*index));
+}
+
+/* Updates records and posting lists; name refs stay pending until commit. */
+static dc_status_t dc_member_guild_upsert(dc_member_guild_index_t* g, dc_snowflake_t user_id,
+                                          const char* username, const char* global_name,
+                                          const char* nick) {
+    if (!dc_snowflake_is_valid(user_id)) return DC_ERROR_INVALID_PARAM;
+
+    const char* raw[DC_MEMBER_NAME_COUNT];
+    raw[DC_MEMBER_NAME_NICK] = nick;
+    raw[DC_MEMBER_NAME_GLOBAL] = global_name;
+    raw[DC_MEMBER_NAME_USERNAME] = username;
+
+    char* names[DC_MEMBER_NAME_COUNT] = { NULL, NULL, NULL };
+    dc_member_record_t* rec = NULL;
+    uint32_t record = 0;
+    dc_status_t st = DC_OK;
+    for (size_t k = 0; k < DC_MEMBER_NAME_COUNT; k++) {
+        if (!raw[k] || raw[k][0] == '\0') continue;
+        char folded[DC_MEMBER_INDEX_MAX_NAME + 1];
+        dc_member_fold(raw[k], folded, sizeof(folded));
+        names[k] = dc_strdup(folded);
+        if (!names[k]) {
+            st = DC_ERROR_OUT_OF_MEMORY;
+            goto fail;
+        }
+    }
+
+    const uint32_t* existing = (const uint32_t*)dc_snowflake_map_get(&g->members, user_id);
+    if (existing) {
+        record = *existing;
+        rec = (dc_member_record_t*)dc_vec_at(&g->records, record);
+        if (dc_member_names_equal(rec, names)) {
+            for (size_t k = 0; k < DC_MEMBER_NAME_COUNT; k++) dc_free(names[k]);
+            return DC_OK;
+        }
+        dc_member_unlink_record(g, record);
+    } else {
+        if (dc_vec_length(&g->free_records) > 0) {
+            st = dc_vec_pop(&g->free_records, &record);
+            if (st != DC_OK) goto fail;
+        } else {
+            if (dc_vec_length(&g->records) >= UINT32_MAX) {
+                st = DC_ERROR_INVALID_STATE;
+                goto fail;
+            }
+            dc_member_record_t blank;
+            memset(&blank, 0, sizeof(blank));
+            record = (uint32_t)dc_vec_length(&g->records);
+            st = dc_vec_push(&g->records, &blank);
+            if (st != DC_OK) goto fail;
+        }
+        st = dc_snowflake_map_put(&g->members, user_id, &record);
+        if (st != DC_OK) {
+            (void)dc_vec_push(&g->free_records, &record);
+            goto fail;
+        }
+    }
+
+    rec = (dc_member_record_t*)dc_vec_at(&g->records, record);
+    rec->user_id = user_id;
+    for (size_t k = 0; k < DC_MEMBER_NAME_COUNT; k++) rec->names[k] = names[k];
+
+    st = dc_member_link_record(g, record);
+    if (st != DC_OK) {
+        /* Leave the member out rather than half-indexed. */
+        dc_member_unlink_record(g, record);
+        rec->user_id = 0;
+        (void)dc_snowflake_map_remove(&g->members, user_id, NULL);
+        (void)dc_vec_push(&g->free_records, &record);
+    }
+    return st;
+
+fail:
+    for (size_t k = 0; k < DC_MEMBER_NAME_COUNT; k++) dc_free(names[k]);
+    return st;
+}
+
+dc_status_t dc_member_index_upsert(dc_member_index_t* index, dc_snowflake_t guild_id,
+                                   dc_snowflake_t user_id, const char* username,
+                                   const char* global_name, const char* nick) {
+    if (!index) return DC_ERROR_NULL_POINTER;
+    if (!dc_snowflake_is_valid(guild_id) || !dc_snowflake_is_valid(user_id)) return DC_ERROR_INVALID_PARAM;
+
+    dc_member_guild_index_t* g = NULL;
+    dc_status_t st = dc_member_get_guild(index, guild_id, &g);
+    if (st != DC_OK) return st;
+    st = dc_member_guild_upsert(g, user_id, username, global_name, nick);
+    dc_status_t commit_st = dc_member_guild_commit(g);
+    return (st != DC_OK) ? st : commit_st;
+}
+
+static dc_status_t dc_member_guild_upsert_model(dc_member_guild_index_t* g, const dc_guild_member_t* member) {
+    if (!member->has_user) return DC_ERROR_INVALID_PARAM;
+    const char* nick = member->nick.is_null ? NULL : dc_string_cstr(&member->nick.value);
+    return dc_member_guild_upsert(g, member->user.id,
+                                  dc_string_cstr(&member->user.username),
+                                  dc_string_cstr(&member->user.global_name), nick);
+}
+
+dc_status_t dc_member_index_upsert_member(dc_member_index_t* index, dc_snowflake_t guild_id,
+                                          const dc_guild_member_t* member) {
+    if (!index || !member) return DC_ERROR_NULL_POINTER;
+    if (!dc_snowflake_is_valid(guild_id)) return DC_ERROR_INVALID_PARAM;
+
+    dc_member_guild_index_t* g = NULL;
+    dc_status_t st = dc_member_get_guild(index, guild_id, &g);
+    if (st != DC_OK) return st;
+    st = dc_member_guild_upsert_model(g, member);
+    dc_status_t commit_st = dc_member_guild_commit(g);
+    return (st != DC_OK) ? st : commit_st;
+}
+
+dc_status_t dc_member_index_upsert_members(dc_member_index_t* index, dc_snowflake_t guild_id,
+                                           const dc_guild_member_list_t* members) {
+    if (!index || !members) return DC_ERROR_NULL_POINTER;
+    if (!dc_snowflake_is_valid(guild_id)) return DC_ERROR_INVALID_PARAM;
+
+    dc_member_guild_index_t* g = NULL;
+    dc_status_t st = dc_member_get_guild(index, guild_id, &g);
+    if (st != DC_OK) return st;
+    for (size_t i = 0; i < dc_vec_length(&members->items) && st == DC_OK; i++) {
+        st = dc_member_guild_upsert_model(g, (const dc_guild_member_t*)dc_vec_at(&members->items, i));
+    }
+    dc_status_t commit_st = dc_member_guild_commit(g);
+    return (st != DC_OK) ? st : commit_st;
+}
+
+dc_status_t dc_member_index_remove(dc_member_index_t* index, dc_snowflake_t guild_id,
+                                   dc_snowflake_t user_id) {
+    if (!index) return DC_ERROR_NULL_POINTER;
+    dc_member_guild_index_t* g = (dc_member_guild_index_t*)dc_snowflake_map_get(&index->guilds, guild_id);
+    if (!g) return DC_OK;
+    uint32_t record = 0;
+    if (dc_snowflake_map_remove(&g->members, user_id, &record) != DC_OK) return DC_OK;
+    dc_member_unlink_record(g, record);
+    dc_member_record_t* rec = (dc_member_record_t*)dc_vec_at(&g->records, record);
+    if (rec) rec->user_id = 0;
+    return dc_vec_push(&g->free_records, &record);
+}
+
+dc_status_t dc_member_index_remove_guild(dc_member_index_t* index, dc_snowflake_t guild_id) {
+    if (!index) return DC_ERROR_NULL_POINTER;
+    dc_member_guild_index_t g;
+    if (dc_snowflake_map_remove(&index->guilds, guild_id, &g) == DC_OK) {
+        dc_member_guild_free(&g);
+    }
+    return DC_OK;
+}
+
+size_t dc_member_index_count(const dc_member_index_t* index, dc_snowflake_t guild_id) {
+    if (!index) return 0;
+    const dc_member_guild_index_t* g =
+        (const dc_member_guild_index_t*)dc_snowflake_map_get(&index->guilds, guild_id);
+    return g ? dc_snowflake_map_length(&g->members) : 0;
+}
+
+static int dc_member_ids_contain(const dc_snowflake_t* ids, size_t count, dc_snowflake_t id) {
+    for (size_t i = 0; i < count; i++) {
+        if (ids[i] == id) return 1;
+    }
+    return 0;
+}
+
+dc_status_t dc_member_index_search_prefix(const dc_member_index_t* index, dc_snowflake_t guild_id,
+                                          const char* prefix, dc_snowflake_t* out_ids,
+                                          size_t max_ids, size_t* out_count) {
+    if (!index || !prefix || !out_count) return DC_ERROR_NULL_POINTER;
+    if (!out_ids && max_ids > 0) return DC_ERROR_NULL_POINTER;
+    *out_count = 0;
+    const dc_member_guild_index_t* g =
+        (const dc_member_guild_index_t*)dc_snowflake_map_get(&index->guilds, guild_id);
+    if (!g || max_ids == 0) return DC_OK;
+
+    char folded[DC_MEMBER_INDEX_MAX_NAME + 1];
+    size_t plen = dc_member_fold(prefix, folded, sizeof(folded));
+    const dc_member_name_ref_t* refs = (const dc_member_name_ref_t*)g->sorted.data;
+    size_t total = g->sorted_length;
+    size_t count = 0;
+    for (size_t i = dc_member_lower_bound_name(g, folded); i < total && count < max_ids; i++) {
+        if (strncmp(refs[i].name, folded, plen) != 0) break;
+        const dc_member_record_t* rec = (const dc_member_record_t*)dc_vec_at(&g->records, refs[i].record);
+        if (!dc_member_ids_contain(out_ids, count, rec->user_id)) {
+            out_ids[count++] = rec->user_id;
+        }
+    }
+    *out_count = count;
+    return DC_OK;
+}
+
+static int dc_member_candidate_cmp(const void* a, const void* b) {
+    const dc_member_candidate_t* ca = (const dc_member_candidate_t*)a;
+    const dc_member_candidate_t* cb = (const dc_member_candidate_t*)b;
+    if (ca->shared != cb->shared) return ca->shared > cb->shared ? -1 : 1;
+    if (ca->best_len != cb->best_len) return ca->best_len < cb->best_len ? -1 : 1;
+    if (ca->record != cb->record) return ca->record < cb->record ? -1 : 1;
+    return 0;
+}
+
+dc_status_t dc_member_index_search_fuzzy(const dc_member_index_t* index, dc_snowflake_t guild_id,
+                                         const char* query, dc_snowflake_t* out_ids,
+                                         size_t max_ids, size_t* out_count) {
+    if (!index || !query || !out_count) return DC_ERROR_NULL_POINTER;
+    if (!out_ids && max_ids > 0) return DC_ERROR_NULL_POINTER;
+    *out_count = 0;
+    const dc_member_guild_index_t* g =
+        (const dc_member_guild_index_t*)dc_snowflake_map_get(&index->guilds, guild_id);
+    if (!g || max_ids == 0 || query[0] == '\0') return DC_OK;
+
+    char folded[DC_MEMBER_INDEX_MAX_NAME + 1];
+    dc_member_fold(query, folded, sizeof(folded));
+    dc_snowflake_t grams[DC_MEMBER_INDEX_MAX_NAME + 1];
+    size_t distinct = dc_member_trigrams_unique(grams, dc_member_trigrams(folded, grams, DC_MEMBER_INDEX_MAX_NAME + 1));
+    if (distinct == 0) return DC_OK;
+
+    /*
+     * A member sharing need = ceil(distinct / 3) trigrams must appear in at
+     * least one of any (distinct - need + 1) postings, so only the shortest
+     * ones are scanned for candidates; the longest need - 1 are probed per
+     * candidate instead of walked.
+     */
+    size_t need = (distinct + 2u) / 3u;
+    size_t scan = distinct - need + 1u;
+    const dc_vec_t* postings[DC_MEMBER_INDEX_MAX_NAME + 1];
+    for (size_t i = 0; i < distinct; i++) {
+        postings[i] = (const dc_vec_t*)dc_snowflake_map_get(&g->trigrams, grams[i]);
+    }
+    for (size_t i = 1; i < distinct; i++) {
+        const dc_vec_t* p = postings[i];
+        dc_snowflake_t gram = grams[i];
+        size_t len = p ? p->length : 0;
+        size_t j = i;
+        while (j > 0 && (postings[j - 1] ? postings[j - 1]->length : 0) > len) {
+            postings[j] = postings[j - 1];
+            grams[j] = grams[j - 1];
+            j--;
+        }
+        postings[j] = p;
+        grams[j] = gram;
+    }
+
+    /* Dense per-record counts; touched lists the records seen at least once. */
+    size_t record_count = g->records.length;
+    uint8_t* counts = (uint8_t*)dc_calloc(record_count ? record_count : 1u, sizeof(uint8_t));
+    if (!counts) return DC_ERROR_OUT_OF_MEMORY;
+    dc_vec_t touched;
+    dc_vec_t candidates;
+    dc_status_t st = dc_vec_init(&touched, sizeof(uint32_t));
+    if (st == DC_OK) st = dc_vec_init(&candidates, sizeof(dc_member_candidate_t));
+    if (st != DC_OK) {
+        dc_vec_free(&touched);
+        dc_free(counts);
+        return st;
+    }
+
+    for (size_t i = 0; i < scan; i++) {
+        if (!postings[i]) continue;
+        const uint32_t* ids = (const uint32_t*)postings[i]->data;
+        for (size_t j = 0; j < postings[i]->length; j++) {
+            if (counts[ids[j]]++ == 0) {
+                st = dc_vec_push(&touched, &ids[j]);
+                if (st != DC_OK) goto cleanup;
+            }
+        }
+    }
+
+    /* candidates holds the best max_ids so far, best first; once full, its
+     * last entry raises the bar a new candidate has to clear. */
+    size_t min_shared = need;
+    const uint32_t* hits = (const uint32_t*)touched.data;
+    for (size_t t = 0; t < touched.length; t++) {
+        dc_member_candidate_t cand;
+        cand.record = hits[t];
+        cand.shared = counts[hits[t]];
+        const dc_member_record_t* rec = (const dc_member_record_t*)dc_vec_at(&g->records, cand.record);
+        for (size_t i = scan; i < distinct; i++) {
+            if ((size_t)cand.shared + (distinct - i) < min_shared) break;
+            for (size_t k = 0; k < DC_MEMBER_NAME_COUNT; k++) {
+                if (rec->names[k] && dc_member_name_has_trigram(rec->names[k], grams[i])) {
+                    cand.shared++;
+                    break;
+                }
+            }
+        }
+        if ((size_t)cand.shared < min_shared) continue;
+
+        cand.best_len = SIZE_MAX;
+        for (size_t k = 0; k < DC_MEMBER_NAME_COUNT; k++) {
+            if (rec->names[k]) {
+                size_t len = strlen(rec->names[k]);
+                if (len < cand.best_len) cand.best_len = len;
+            }
+        }
+
+        size_t pos = candidates.length;
+        while (pos > 0 &&
+               dc_member_candidate_cmp(&cand, dc_vec_at(&candidates, pos - 1u)) < 0) {
+            pos--;
+        }
+        if (pos >= max_ids) continue;
+        if (candidates.length == max_ids) (void)dc_vec_pop(&candidates, NULL);
+        st = dc_vec_insert(&candidates, pos, &cand);
+        if (st != DC_OK) goto cleanup;
+        if (candidates.length == max_ids) {
+            const dc_member_candidate_t* worst =
+                (const dc_member_candidate_t*)dc_vec_at(&candidates, candidates.length - 1u);
+            if (worst->shared > min_shared) min_shared = worst->shared;
+        }
+    }
+
+    size_t count = 0;
+    for (size_t i = 0; i < candidates.length; i++) {
+        const dc_member_candidate_t* cand = (const dc_member_candidate_t*)dc_vec_at(&candidates, i);
+        const dc_member_record_t* rec = (const dc_member_record_t*)dc_vec_at(&g->records, cand->record);
+        out_ids[count++] = rec->user_id;
+    }
+    *out_count = count;
+
+cleanup:
+    dc_vec_free(&candidates);
+    dc_vec_free(&touched);
+    dc_free(counts);
+    return st;
+}
+
+dc_status_t dc_member_index_resolve(const dc_member_index_t* index, dc_snowflake_t guild_id,
+                                    const char* name, dc_snowflake_t* out_user_id) {
+    if (!index || !name || !out_user_id) return DC_ERROR_NULL_POINTER;
+    if (name[0] == '@') name++;
+    const dc_member_guild_index_t* g =
+        (const dc_member_guild_index_t*)dc_snowflake_map_get(&index->guilds, guild_id);
+    if (!g || name[0] == '\0') return DC_ERROR_NOT_FOUND;
+
+    char folded[DC_MEMBER_INDEX_MAX_NAME + 1];
+    dc_member_fold(name, folded, sizeof(folded));
+    size_t pos = dc_member_lower_bound_name(g, folded);
+    if (pos >= g->sorted_length) return DC_ERROR_NOT_FOUND;
+    const dc_member_name_ref_t* ref = (const dc_member_name_ref_t*)dc_vec_at(&g->sorted, pos);
+    if (strcmp(ref->name, folded) != 0) return DC_ERROR_NOT_FOUND;
+    const dc_member_record_t* rec = (const dc_member_record_t*)dc_vec_at(&g->records, ref->record);
+    *out_user_id = rec->user_id;
+    return DC_OK;
+}
+
+static const char* dc_member_json_str(yyjson_val* obj, const char* key) {
+    yyjson_val* v = yyjson_obj_get(obj, key);
+    return yyjson_is_str(v) ? yyjson_get_str(v) : NULL;
+}
+
+/* Reads only user.id/username/global_name and nick from a member object. */
+static dc_status_t dc_member_guild_apply_member_val(dc_member_guild_index_t* g, yyjson_val* member) {
+    if (!yyjson_is_obj(member)) return DC_ERROR_INVALID_FORMAT;
+    yyjson_val* user = yyjson_obj_get(member, "user");
+    if (!yyjson_is_obj(user)) return DC_ERROR_INVALID_FORMAT;
+    dc_snowflake_t user_id = 0;
+    dc_status_t st = dc_json_get_snowflake(user, "id", &user_id);
+    if (st != DC_OK) return st;
+    return dc_member_guild_upsert(g, user_id,
+                                  dc_member_json_str(user, "username"),
+                                  dc_member_json_str(user, "global_name"),
+                                  dc_member_json_str(member, "nick"));
+}
+
+static dc_status_t dc_member_index_apply_members(dc_member_index_t* index, dc_snowflake_t guild_id,
+                                                 yyjson_val* members, int single) {
+    if (!single && (!members || yyjson_is_null(members))) return DC_OK;
+    if (!single && !yyjson_is_arr(members)) return DC_ERROR_INVALID_FORMAT;
+
+    dc_member_guild_index_t* g = NULL;
+    dc_status_t st = dc_member_get_guild(index, guild_id, &g);
+    if (st != DC_OK) return st;
+    if (single) {
+        st = dc_member_guild_apply_member_val(g, members);
+    } else {
+        size_t idx, max;
+        yyjson_val* item = NULL;
+        yyjson_arr_foreach(members, idx, max, item) {
+            st = dc_member_guild_apply_member_val(g, item);
+            if (st != DC_OK) break;
+        }
+    }
+    dc_status_t commit_st = dc_member_guild_commit(g);
+    return (st != DC_OK) ? st : commit_st;
+}
+
+dc_status_t dc_member_index_process_event(dc_member_index_t* index, const char* event_name,
+                                          const char* event_data) {
+    if (!index || !event_name || !event_data) return DC_ERROR_NULL_POINTER;
+
+    int is_create = strcmp(event_name, "GUILD_CREATE") == 0;
+    int is_delete = strcmp(event_name, "GUILD_DELETE") == 0;
+    int is_chunk = strcmp(event_name, "GUILD_MEMBERS_CHUNK") == 0;
+    int is_add = strcmp(event_name, "GUILD_MEMBER_ADD") == 0;
+    int is_update = strcmp(event_name, "GUILD_MEMBER_UPDATE") == 0;
+    int is_remove = strcmp(event_name, "GUILD_MEMBER_REMOVE") == 0;
+    if (!is_create && !is_delete && !is_chunk && !is_add && !is_update && !is_remove) return DC_OK;
+
+    dc_json_doc_t doc;
+    dc_status_t st = dc_json_parse(event_data, &doc);
+    if (st != DC_OK) return st;
+
+    dc_snowflake_t guild_id = 0;
+    st = dc_json_get_snowflake(doc.root, (is_create || is_delete) ? "id" : "guild_id", &guild_id);
+    if (st != DC_OK) goto cleanup;
+
+    if (is_create) {
+        st = dc_member_index_remove_guild(index, guild_id);
+        if (st == DC_OK) st = dc_member_index_apply_members(index, guild_id, yyjson_obj_get(doc.root, "members"), 0);
+    } else if (is_delete) {
+        st = dc_member_index_remove_guild(index, guild_id);
+    } else if (is_chunk) {
+        st = dc_member_index_apply_members(index, guild_id, yyjson_obj_get(doc.root, "members"), 0);
+    } else if (is_add || is_update) {
+        st = dc_member_index_apply_members(index, guild_id, doc.root, 1);
+    } else {
+        yyjson_val* user = yyjson_obj_get(doc.root, "user");
+        dc_snowflake_t user_id = 0;
+        st = yyjson_is_obj(user) ? dc_json_get_snowflake(user, "id", &user_id) : DC_ERROR_INVALID_FORMAT;
+        if (st == DC_OK) st = dc_member_index_remove(index, guild_id, user_id);
+    }
+
+cleanup:
+    dc_json_doc_free(&doc);
+    return st;
+}
@@ -0,0 +1,169 @@
+#ifndef DC_MEMBER_INDEX_H
+#define DC_MEMBER_INDEX_H
+
+/**
+ * @file dc_member_index.h
+ * @brief Local per-guild member name index (prefix and fuzzy search)
+ *
+ * Indexes username, global_name and nick of each member, case-folded
+ * (ASCII). Prefix search binary-searches a sorted name array; fuzzy search
+ * ranks members by shared trigrams. Fed from GUILD_CREATE, GUILD_MEMBERS_CHUNK
+ * and GUILD_MEMBER_ADD/UPDATE/REMOVE payloads, or from typed member models
+ * (e.g. dc_client_list_guild_members() pages).
+ *
+ * Not thread-safe: feed and query from the gateway thread or guard externally.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include "core/dc_status.h"
+#include "core/dc_snowflake.h"
+#include "core/dc_snowflake_map.h"
+#include "model/dc_guild_member.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Member name index state
+ */
+typedef struct {
+    dc_snowflake_map_t guilds;  /**< guild_id -> per-guild index */
+} dc_member_index_t;
+
+/**
+ * @brief Initialize index
+ * @param index Index to initialize
+ * @return DC_OK on success, error code on failure
+ */
+dc_status_t dc_member_index_init(dc_member_index_t* index);
+
+/**
+ * @brief Free index
+ * @param index Index to free
+ */
+void dc_member_index_free(dc_member_index_t* index);
+
+/**
+ * @brief Insert or update a member's names
+ * @param index Index
+ * @param guild_id Guild ID
+ * @param user_id User ID
+ * @param username Username (may be NULL)
+ * @param global_name Global display name (may be NULL)
+ * @param nick Guild nickname (may be NULL)
+ * @return DC_OK on success, error code on failure
+ */
+dc_status_t dc_member_index_upsert(dc_member_index_t* index, dc_snowflake_t guild_id,
+                                   dc_snowflake_t user_id, const char* username,
+                                   const char* global_name, const char* nick);
+
+/**
+ * @brief Insert or update a member from a typed model
+ * @param index Index
+ * @param guild_id Guild ID
+ * @param member Member model (must carry a user)
+ * @return DC_OK on success, error code on failure
+ */
+dc_status_t dc_member_index_upsert_member(dc_member_index_t* index, dc_snowflake_t guild_id,
+                                          const dc_guild_member_t* member);
+
+/**
+ * @brief Insert or update a batch of members (e.g. a list-members page)
+ * @param index Index
+ * @param guild_id Guild ID
+ * @param members Member list
+ * @return DC_OK on success, error code on failure
+ */
+dc_status_t dc_member_index_upsert_members(dc_member_index_t* index, dc_snowflake_t guild_id,
+                                           const dc_guild_member_list_t* members);
+
+/**
+ * @brief Remove a member
+ * @param index Index
+ * @param guild_id Guild ID
+ * @param user_id User ID
+ * @return DC_OK on success (also when not indexed), error code on failure
+ */
+dc_status_t dc_member_index_remove(dc_member_index_t* index, dc_snowflake_t guild_id,
+                                   dc_snowflake_t user_id);
+
+/**
+ * @brief Remove a guild and all its members
+ * @param index Index
+ * @param guild_id Guild ID
+ * @return DC_OK on success (also when not indexed), error code on failure
+ */
+dc_status_t dc_member_index_remove_guild(dc_member_index_t* index, dc_snowflake_t guild_id);
+
+/**
+ * @brief Number of indexed members in a guild
+ * @param index Index
+ * @param guild_id Guild ID
+ * @return Member count, 0 for unknown guilds
+ */
+size_t dc_member_index_count(const dc_member_index_t* index, dc_snowflake_t guild_id);
+
+/**
+ * @brief Find members whose username, global_name or nick starts with @p prefix
+ * @param index Index
+ * @param guild_id Guild ID
+ * @param prefix Prefix (case-insensitive; empty matches everyone)
+ * @param out_ids Output user IDs, in name order, without duplicates
+ * @param max_ids Capacity of @p out_ids
+ * @param out_count Number of IDs written
+ * @return DC_OK on success, error code on failure
+ */
+dc_status_t dc_member_index_search_prefix(const dc_member_index_t* index, dc_snowflake_t guild_id,
+                                          const char* prefix, dc_snowflake_t* out_ids,
+                                          size_t max_ids, size_t* out_count);
+
+/**
+ * @brief Fuzzy search by trigram similarity
+ *
+ * Members sharing at least a third of the query's trigrams with any of their
+ * names are returned, best match first.
+ *
+ * @param index Index
+ * @param guild_id Guild ID
+ * @param query Query text (case-insensitive)
+ * @param out_ids Output user IDs
+ * @param max_ids Capacity of @p out_ids
+ * @param out_count Number of IDs written
+ * @return DC_OK on success, error code on failure
+ */
+dc_status_t dc_member_index_search_fuzzy(const dc_member_index_t* index, dc_snowflake_t guild_id,
+                                         const char* query, dc_snowflake_t* out_ids,
+                                         size_t max_ids, size_t* out_count);
+
+/**
+ * @brief Resolve an exact (case-insensitive) name, e.g. for "@name" mentions
+ * @param index Index
+ * @param guild_id Guild ID
+ * @param name Name to resolve (a leading '@' is ignored)
+ * @param out_user_id Output user ID; nick matches win over global_name, then username
+ * @return DC_OK on success, DC_ERROR_NOT_FOUND if nothing matches, error code on failure
+ */
+dc_status_t dc_member_index_resolve(const dc_member_index_t* index, dc_snowflake_t guild_id,
+                                    const char* name, dc_snowflake_t* out_user_id);
+
+/**
+ * @brief Route a gateway dispatch to the index
+ *
+ * Handles GUILD_CREATE, GUILD_DELETE, GUILD_MEMBERS_CHUNK, GUILD_MEMBER_ADD,
+ * GUILD_MEMBER_UPDATE and GUILD_MEMBER_REMOVE; other events are ignored.
+ *
+ * @param index Index
+ * @param event_name Dispatch event name
+ * @param event_data Dispatch event JSON data
+ * @return DC_OK on success or for ignored events, error code on failure
+ */
+dc_status_t dc_member_index_process_event(dc_member_index_t* index, const char* event_name,
+                                          const char* event_data);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DC_MEMBER_INDEX_H */
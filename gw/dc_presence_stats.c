@@ -0,0 +1,279 @@
+/**
+ * @file dc_presence_stats.c
+ * @brief Incremental per-guild presence counters
+ */
+
+#include "dc_presence_stats.h"
+#include "json/dc_json.h"
+#include <string.h>
+#include <yyjson.h>
+
+typedef struct {
+    dc_presence_counts_t counts;
+    dc_snowflake_map_t users;   /* user_id -> uint8_t status (never OFFLINE) */
+} dc_presence_guild_entry_t;
+
+static void dc_presence_counts_adjust(dc_presence_counts_t* counts, uint8_t status, int delta) {
+    uint32_t* slot = NULL;
+    switch ((dc_presence_status_t)status) {
+        case DC_PRESENCE_STATUS_ONLINE: slot = &counts->online; break;
+        case DC_PRESENCE_STATUS_IDLE: slot = &counts->idle; break;
+        case DC_PRESENCE_STATUS_DND: slot = &counts->dnd; break;
+        default: return;
+    }
+    if (delta > 0) {
+        (*slot)++;
+    } else if (*slot > 0) {
+        (*slot)--;
+    }
+}
+
+static void dc_presence_guild_entry_free(dc_presence_guild_entry_t* entry) {
+    if (!entry) return;
+    dc_snowflake_map_free(&entry->users);
+    memset(&entry->counts, 0, sizeof(entry->counts));
+}
+
+static dc_status_t dc_presence_stats_get_guild(dc_presence_stats_t* stats, dc_snowflake_t guild_id,
+                                               dc_presence_guild_entry_t** out) {
+    void* slot = NULL;
+    int inserted = 0;
+    dc_status_t st = dc_snowflake_map_upsert(&stats->guilds, guild_id, &slot, &inserted);
+    if (st != DC_OK) return st;
+    dc_presence_guild_entry_t* entry = (dc_presence_guild_entry_t*)slot;
+    if (inserted) {
+        st = dc_snowflake_map_init(&entry->users, sizeof(uint8_t));
+        if (st != DC_OK) {
+            (void)dc_snowflake_map_remove(&stats->guilds, guild_id, NULL);
+            return st;
+        }
+    }
+    *out = entry;
+    return DC_OK;
+}
+
+static dc_status_t dc_presence_guild_entry_set(dc_presence_guild_entry_t* entry, dc_snowflake_t user_id,
+                                               dc_presence_status_t status) {
+    if (status == DC_PRESENCE_STATUS_OFFLINE) {
+        uint8_t old = 0;
+        if (dc_snowflake_map_remove(&entry->users, user_id, &old) == DC_OK) {
+            dc_presence_counts_adjust(&entry->counts, old, -1);
+        }
+        return DC_OK;
+    }
+
+    void* slot = NULL;
+    int inserted = 0;
+    dc_status_t st = dc_snowflake_map_upsert(&entry->users, user_id, &slot, &inserted);
+    if (st != DC_OK) return st;
+    uint8_t* byte = (uint8_t*)slot;
+    if (!inserted) {
+        if (*byte == (uint8_t)status) return DC_OK;
+        dc_presence_counts_adjust(&entry->counts, *byte, -1);
+    }
+    *byte = (uint8_t)status;
+    dc_presence_counts_adjust(&entry->counts, *byte, 1);
+    return DC_OK;
+}
+
+static dc_status_t dc_presence_stats_read_status(yyjson_val* obj, dc_snowflake_t* user_id,
+                                                 dc_presence_status_t* status) {
+    yyjson_val* user_val = yyjson_obj_get(obj, "user");
+    if (!user_val || !yyjson_is_obj(user_val)) return DC_ERROR_INVALID_FORMAT;
+    dc_status_t st = dc_json_get_snowflake(user_val, "id", user_id);
+    if (st != DC_OK) return st;
+    yyjson_val* status_val = yyjson_obj_get(obj, "status");
+    *status = dc_presence_status_from_string(yyjson_is_str(status_val) ? yyjson_get_str(status_val) : NULL);
+    return DC_OK;
+}
+
+dc_status_t dc_presence_stats_init(dc_presence_stats_t* stats) {
+    if (!stats) return DC_ERROR_NULL_POINTER;
+    memset(stats, 0, sizeof(*stats));
+    return dc_snowflake_map_init(&stats->guilds, sizeof(dc_presence_guild_entry_t));
+}
+
+void dc_presence_stats_free(dc_presence_stats_t* stats) {
+    if (!stats) return;
+    size_t cursor = 0;
+    void* slot = NULL;
+    while (dc_snowflake_map_next(&stats->guilds, &cursor, NULL, &slot)) {
+        dc_presence_guild_entry_free((dc_presence_guild_entry_t*)slot);
+    }
+    dc_snowflake_map_free(&stats->guilds);
+    memset(stats, 0, sizeof(*stats));
+}
+
+dc_status_t dc_presence_stats_set(dc_presence_stats_t* stats, dc_snowflake_t guild_id,
+                                  dc_snowflake_t user_id, dc_presence_status_t status) {
+    if (!stats) return DC_ERROR_NULL_POINTER;
+    if (!dc_snowflake_is_valid(guild_id) || !dc_snowflake_is_valid(user_id)) return DC_ERROR_INVALID_PARAM;
+    if (status > DC_PRESENCE_STATUS_OFFLINE) return DC_ERROR_INVALID_PARAM;
+
+    dc_presence_guild_entry_t* entry = NULL;
+    if (status == DC_PRESENCE_STATUS_OFFLINE) {
+        entry = (dc_presence_guild_entry_t*)dc_snowflake_map_get(&stats->guilds, guild_id);
+        if (!entry) return DC_OK;
+    } else {
+        dc_status_t st = dc_presence_stats_get_guild(stats, guild_id, &entry);
+        if (st != DC_OK) return st;
+    }
+    return dc_presence_guild_entry_set(entry, user_id, status);
+}
+
+dc_status_t dc_presence_stats_remove_member(dc_presence_stats_t* stats, dc_snowflake_t guild_id,
+                                            dc_snowflake_t user_id) {
+    return dc_presence_stats_set(stats, guild_id, user_id, DC_PRESENCE_STATUS_OFFLINE);
+}
+
+dc_status_t dc_presence_stats_remove_guild(dc_presence_stats_t* stats, dc_snowflake_t guild_id) {
+    if (!stats) return DC_ERROR_NULL_POINTER;
+    dc_presence_guild_entry_t entry;
+    if (dc_snowflake_map_remove(&stats->guilds, guild_id, &entry) == DC_OK) {
+        dc_presence_guild_entry_free(&entry);
+    }
+    return DC_OK;
+}
+
+dc_status_t dc_presence_stats_get_counts(const dc_presence_stats_t* stats, dc_snowflake_t guild_id,
+                                         dc_presence_counts_t* out) {
+    if (!stats || !out) return DC_ERROR_NULL_POINTER;
+    memset(out, 0, sizeof(*out));
+    const dc_presence_guild_entry_t* entry =
+        (const dc_presence_guild_entry_t*)dc_snowflake_map_get(&stats->guilds, guild_id);
+    if (!entry) return DC_ERROR_NOT_FOUND;
+    *out = entry->counts;
+    return DC_OK;
+}
+
+dc_status_t dc_presence_stats_get_status(const dc_presence_stats_t* stats, dc_snowflake_t guild_id,
+                                         dc_snowflake_t user_id, dc_presence_status_t* out) {
+    if (!stats || !out) return DC_ERROR_NULL_POINTER;
+    *out = DC_PRESENCE_STATUS_OFFLINE;
+    const dc_presence_guild_entry_t* entry =
+        (const dc_presence_guild_entry_t*)dc_snowflake_map_get(&stats->guilds, guild_id);
+    if (!entry) return DC_OK;
+    const uint8_t* byte = (const uint8_t*)dc_snowflake_map_get(&entry->users, user_id);
+    if (byte) *out = (dc_presence_status_t)*byte;
+    return DC_OK;
+}
+
+dc_status_t dc_presence_stats_parse_update(const char* event_data, dc_snowflake_t* guild_id,
+                                           dc_snowflake_t* user_id, dc_presence_status_t* status) {
+    if (!event_data || !guild_id || !user_id || !status) return DC_ERROR_NULL_POINTER;
+
+    dc_json_doc_t doc;
+    dc_status_t st = dc_json_parse(event_data, &doc);
+    if (st != DC_OK) return st;
+
+    dc_snowflake_t gid = 0;
+    dc_snowflake_t uid = 0;
+    dc_presence_status_t s = DC_PRESENCE_STATUS_OFFLINE;
+    st = dc_json_get_snowflake(doc.root, "guild_id", &gid);
+    if (st == DC_OK) st = dc_presence_stats_read_status(doc.root, &uid, &s);
+    dc_json_doc_free(&doc);
+    if (st != DC_OK) return st;
+
+    *guild_id = gid;
+    *user_id = uid;
+    *status = s;
+    return DC_OK;
+}
+
+dc_status_t dc_presence_stats_apply_presence_update(dc_presence_stats_t* stats, const char* event_data) {
+    if (!stats || !event_data) return DC_ERROR_NULL_POINTER;
+    dc_snowflake_t guild_id = 0;
+    dc_snowflake_t user_id = 0;
+    dc_presence_status_t status = DC_PRESENCE_STATUS_OFFLINE;
+    dc_status_t st = dc_presence_stats_parse_update(event_data, &guild_id, &user_id, &status);
+    if (st != DC_OK) return st;
+    return dc_presence_stats_set(stats, guild_id, user_id, status);
+}
+
+dc_status_t dc_presence_stats_apply_guild_create(dc_presence_stats_t* stats, const char* event_data) {
+    if (!stats || !event_data) return DC_ERROR_NULL_POINTER;
+
+    dc_json_doc_t doc;
+    dc_status_t st = dc_json_parse(event_data, &doc);
+    if (st != DC_OK) return st;
+
+    dc_snowflake_t guild_id = 0;
+    dc_presence_guild_entry_t* entry = NULL;
+    yyjson_val* presences = NULL;
+    st = dc_json_get_snowflake(doc.root, "id", &guild_id);
+    if (st != DC_OK) goto cleanup;
+
+    /* GUILD_CREATE is a full snapshot: drop anything tracked before. */
+    st = dc_presence_stats_remove_guild(stats, guild_id);
+    if (st != DC_OK) goto cleanup;
+    st = dc_presence_stats_get_guild(stats, guild_id, &entry);
+    if (st != DC_OK) goto cleanup;
+
+    presences = yyjson_obj_get(doc.root, "presences");
+    if (!presences || yyjson_is_null(presences)) goto cleanup;
+    if (!yyjson_is_arr(presences)) {
+        st = DC_ERROR_INVALID_FORMAT;
+        goto cleanup;
+    }
+    st = dc_snowflake_map_reserve(&entry->users, yyjson_arr_size(presences));
+    if (st != DC_OK) goto cleanup;
+
+    size_t idx, max;
+    yyjson_val* item = NULL;
+    yyjson_arr_foreach(presences, idx, max, item) {
+        if (!yyjson_is_obj(item)) continue;
+        dc_snowflake_t user_id = 0;
+        dc_presence_status_t status = DC_PRESENCE_STATUS_OFFLINE;
+        st = dc_presence_stats_read_status(item, &user_id, &status);
+        if (st != DC_OK) goto cleanup;
+        st = dc_presence_guild_entry_set(entry, user_id, status);
+        if (st != DC_OK) goto cleanup;
+    }
+
+cleanup:
+    dc_json_doc_free(&doc);
+    return st;
+}
+
+static dc_status_t dc_presence_stats_apply_ids(dc_presence_stats_t* stats, const char* event_data,
+                                               int member_remove) {
+    dc_json_doc_t doc;
+    dc_status_t st = dc_json_parse(event_data, &doc);
+    if (st != DC_OK) return st;
+
+    dc_snowflake_t guild_id = 0;
+    if (member_remove) {
+        st = dc_json_get_snowflake(doc.root, "guild_id", &guild_id);
+        if (st == DC_OK) {
+            yyjson_val* user_val = yyjson_obj_get(doc.root, "user");
+            dc_snowflake_t user_id = 0;
+            st = yyjson_is_obj(user_val) ? dc_json_get_snowflake(user_val, "id", &user_id)
+                                         : DC_ERROR_INVALID_FORMAT;
+            if (st == DC_OK) st = dc_presence_stats_remove_member(stats, guild_id, user_id);
+        }
+    } else {
+        st = dc_json_get_snowflake(doc.root, "id", &guild_id);
+        if (st == DC_OK) st = dc_presence_stats_remove_guild(stats, guild_id);
+    }
+
+    dc_json_doc_free(&doc);
+    return st;
+}
+
+dc_status_t dc_presence_stats_process_event(dc_presence_stats_t* stats, const char* event_name,
+                                            const char* event_data) {
+    if (!stats || !event_name || !event_data) return DC_ERROR_NULL_POINTER;
+    if (strcmp(event_name, "PRESENCE_UPDATE") == 0) {
+        return dc_presence_stats_apply_presence_update(stats, event_data);
+    }
+    if (strcmp(event_name, "GUILD_CREATE") == 0) {
+        return dc_presence_stats_apply_guild_create(stats, event_data);
+    }
+    if (strcmp(event_name, "GUILD_DELETE") == 0) {
+        return dc_presence_stats_apply_ids(stats, event_data, 0);
+    }
+    if (strcmp(event_name, "GUILD_MEMBER_REMOVE") == 0) {
+        return dc_presence_stats_apply_ids(stats, event_data, 1);
+    }
+    return DC_OK;
+}
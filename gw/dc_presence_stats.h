@@ -0,0 +1,152 @@
+#ifndef DC_PRESENCE_STATS_H
+#define DC_PRESENCE_STATS_H
+
+/**
+ * @file dc_presence_stats.h
+ * @brief Incremental per-guild presence counters
+ *
+ * Keeps one status byte per non-offline member plus online/idle/dnd counters
+ * per guild, fed directly from GUILD_CREATE and PRESENCE_UPDATE payloads.
+ * The decoder reads only user.id, guild_id and status; activities and
+ * client_status are never copied. Use dc_gateway_event_parse_guild_create()
+ * when full dc_presence_t objects are needed.
+ *
+ * Not thread-safe: feed and query from the gateway thread or guard externally.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include "core/dc_status.h"
+#include "core/dc_snowflake.h"
+#include "core/dc_snowflake_map.h"
+#include "model/dc_presence.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Status counters for a single guild
+ */
+typedef struct {
+    uint32_t online;    /**< Members with status "online" */
+    uint32_t idle;      /**< Members with status "idle" */
+    uint32_t dnd;       /**< Members with status "dnd" */
+} dc_presence_counts_t;
+
+/**
+ * @brief Presence aggregator state
+ */
+typedef struct {
+    dc_snowflake_map_t guilds;  /**< guild_id -> per-guild counters and user table */
+} dc_presence_stats_t;
+
+/**
+ * @brief Initialize aggregator
+ * @param stats Aggregator to initialize
+ * @return DC_OK on success, error code on failure
+ */
+dc_status_t dc_presence_stats_init(dc_presence_stats_t* stats);
+
+/**
+ * @brief Free aggregator
+ * @param stats Aggregator to free
+ */
+void dc_presence_stats_free(dc_presence_stats_t* stats);
+
+/**
+ * @brief Set a member's status in a guild
+ * @param stats Aggregator
+ * @param guild_id Guild ID
+ * @param user_id User ID
+ * @param status New status (DC_PRESENCE_STATUS_OFFLINE drops the member from the table)
+ * @return DC_OK on success, error code on failure
+ */
+dc_status_t dc_presence_stats_set(dc_presence_stats_t* stats, dc_snowflake_t guild_id,
+                                  dc_snowflake_t user_id, dc_presence_status_t status);
+
+/**
+ * @brief Forget a member (e.g. GUILD_MEMBER_REMOVE)
+ * @param stats Aggregator
+ * @param guild_id Guild ID
+ * @param user_id User ID
+ * @return DC_OK on success (also when the member was not tracked), error code on failure
+ */
+dc_status_t dc_presence_stats_remove_member(dc_presence_stats_t* stats, dc_snowflake_t guild_id,
+                                            dc_snowflake_t user_id);
+
+/**
+ * @brief Forget a guild and all its members (e.g. GUILD_DELETE)
+ * @param stats Aggregator
+ * @param guild_id Guild ID
+ * @return DC_OK on success (also when the guild was not tracked), error code on failure
+ */
+dc_status_t dc_presence_stats_remove_guild(dc_presence_stats_t* stats, dc_snowflake_t guild_id);
+
+/**
+ * @brief Get status counters for a guild
+ * @param stats Aggregator
+ * @param guild_id Guild ID
+ * @param out Counters to populate (zeroed for unknown guilds)
+ * @return DC_OK on success, DC_ERROR_NOT_FOUND if the guild is not tracked
+ */
+dc_status_t dc_presence_stats_get_counts(const dc_presence_stats_t* stats, dc_snowflake_t guild_id,
+                                         dc_presence_counts_t* out);
+
+/**
+ * @brief Get a member's status in a guild
+ * @param stats Aggregator
+ * @param guild_id Guild ID
+ * @param user_id User ID
+ * @param out Status; DC_PRESENCE_STATUS_OFFLINE for members not in the table
+ * @return DC_OK on success, error code on failure
+ */
+dc_status_t dc_presence_stats_get_status(const dc_presence_stats_t* stats, dc_snowflake_t guild_id,
+                                         dc_snowflake_t user_id, dc_presence_status_t* out);
+
+/**
+ * @brief Minimal PRESENCE_UPDATE decoder (user.id, guild_id, status only)
+ * @param event_data PRESENCE_UPDATE JSON data
+ * @param guild_id Output guild ID
+ * @param user_id Output user ID
+ * @param status Output status
+ * @return DC_OK on success, error code on failure
+ */
+dc_status_t dc_presence_stats_parse_update(const char* event_data, dc_snowflake_t* guild_id,
+                                           dc_snowflake_t* user_id, dc_presence_status_t* status);
+
+/**
+ * @brief Apply a PRESENCE_UPDATE payload
+ * @param stats Aggregator
+ * @param event_data PRESENCE_UPDATE JSON data
+ * @return DC_OK on success, error code on failure
+ */
+dc_status_t dc_presence_stats_apply_presence_update(dc_presence_stats_t* stats, const char* event_data);
+
+/**
+ * @brief Replace a guild's table from a GUILD_CREATE payload's presences array
+ * @param stats Aggregator
+ * @param event_data GUILD_CREATE JSON data
+ * @return DC_OK on success, error code on failure
+ */
+dc_status_t dc_presence_stats_apply_guild_create(dc_presence_stats_t* stats, const char* event_data);
+
+/**
+ * @brief Route a gateway dispatch to the aggregator
+ *
+ * Handles GUILD_CREATE, GUILD_DELETE, GUILD_MEMBER_REMOVE and PRESENCE_UPDATE;
+ * other events are ignored. Suitable for calling from dc_gateway_event_callback_t.
+ *
+ * @param stats Aggregator
+ * @param event_name Dispatch event name
+ * @param event_data Dispatch event JSON data
+ * @return DC_OK on success or for ignored events, error code on failure
+ */
+dc_status_t dc_presence_stats_process_event(dc_presence_stats_t* stats, const char* event_name,
+                                            const char* event_data);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DC_PRESENCE_STATS_H */
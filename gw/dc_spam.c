@@ -0,0 +1,329 @@
+/**
+ * @file dc_spam.c
+ * @brief Per-user spam and near-duplicate detection
+ */
+
+#include "dc_spam.h"
+#include "json/dc_json.h"
+#include <string.h>
+#include <yyjson.h>
+
+#define DC_SPAM_SLOTS 8u            /* window buckets */
+#define DC_SPAM_HISTORY 4u          /* signatures kept per user */
+#define DC_SPAM_MINHASH 8u          /* MinHash slots per signature */
+#define DC_SPAM_MAX_SIGNED 2000u    /* content bytes fed into a signature */
+#define DC_SPAM_SWEEP_STEP 2u       /* records examined per observed message */
+
+typedef struct {
+    uint64_t time_ms;
+    dc_snowflake_t channel_id;
+    uint32_t minhash[DC_SPAM_MINHASH];
+} dc_spam_signature_t;
+
+typedef struct {
+    uint64_t last_seen_ms;
+    uint64_t slot;                              /* index of the newest bucket */
+    uint16_t messages[DC_SPAM_SLOTS];
+    uint16_t mentions[DC_SPAM_SLOTS];
+    uint16_t attachments[DC_SPAM_SLOTS];
+    dc_spam_signature_t history[DC_SPAM_HISTORY];
+    uint32_t history_next;
+    uint32_t history_used;
+} dc_spam_user_t;
+
+/* Odd multipliers for multiply-shift hashing, one per MinHash slot. */
+static const uint64_t dc_spam_minhash_mul[DC_SPAM_MINHASH] = {
+    0x9E3779B97F4A7C15ULL, 0xC2B2AE3D27D4EB4FULL, 0x165667B19E3779F9ULL, 0xD6E8FEB86659FD93ULL,
+    0xFF51AFD7ED558CCDULL, 0xC4CEB9FE1A85EC53ULL, 0x94D049BB133111EBULL, 0xBF58476D1CE4E5B9ULL
+};
+
+void dc_spam_config_init(dc_spam_config_t* config) {
+    if (!config) return;
+    memset(config, 0, sizeof(*config));
+    config->window_ms = 5000;
+    config->max_messages = 5;
+    config->max_mentions = 10;
+    config->max_attachments = 10;
+    config->duplicate_window_ms = 60000;
+    config->duplicate_similarity = 75;
+    config->max_duplicates = 2;
+    config->max_duplicate_channels = 2;
+    config->expire_ms = 120000;
+    config->ignore_bots = 1;
+}
+
+dc_status_t dc_spam_engine_init(dc_spam_engine_t* engine, const dc_spam_config_t* config) {
+    if (!engine) return DC_ERROR_NULL_POINTER;
+    memset(engine, 0, sizeof(*engine));
+    if (config) {
+        if (config->duplicate_similarity == 0 || config->duplicate_similarity > 100) {
+            return DC_ERROR_INVALID_PARAM;
+        }
+        engine->config = *config;
+    } else {
+        dc_spam_config_init(&engine->config);
+    }
+    if (engine->config.window_ms < DC_SPAM_SLOTS) engine->config.window_ms = DC_SPAM_SLOTS;
+    return dc_snowflake_map_init(&engine->users, sizeof(dc_spam_user_t));
+}
+
+void dc_spam_engine_free(dc_spam_engine_t* engine) {
+    if (!engine) return;
+    dc_snowflake_map_free(&engine->users);
+    memset(engine, 0, sizeof(*engine));
+}
+
+static uint64_t dc_spam_mix64(uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xBF58476D1CE4E5B9ULL;
+    x ^= x >> 27;
+    x *= 0x94D049BB133111EBULL;
+    x ^= x >> 31;
+    return x;
+}
+
+/*
+ * MinHash over 4-byte shingles of the case-folded, whitespace-collapsed
+ * content. The shingle is kept as a rolling 32-bit window, so each byte costs
+ * one shift plus DC_SPAM_MINHASH multiply-shifts. Returns 0 for empty content.
+ */
+static int dc_spam_sign(const char* content, uint32_t* minhash) {
+    for (size_t k = 0; k < DC_SPAM_MINHASH; k++) minhash[k] = UINT32_MAX;
+    if (!content) return 0;
+
+    uint32_t window = 0;
+    size_t taken = 0;
+    int last_space = 1;
+    for (size_t i = 0; content[i] && i < DC_SPAM_MAX_SIGNED; i++) {
+        unsigned char c = (unsigned char)content[i];
+        if (c == ' ' || c == '\t' || c == '\n' || c == '\r') {
+            if (last_space) continue;
+            c = ' ';
+            last_space = 1;
+        } else {
+            if (c >= 'A' && c <= 'Z') c = (unsigned char)(c + ('a' - 'A'));
+            last_space = 0;
+        }
+        window = (window << 8) | c;
+        taken++;
+        if (taken < 4) continue;
+        uint64_t h = dc_spam_mix64(window);
+        for (size_t k = 0; k < DC_SPAM_MINHASH; k++) {
+            uint32_t v = (uint32_t)((h * dc_spam_minhash_mul[k]) >> 32);
+            if (v < minhash[k]) minhash[k] = v;
+        }
+    }
+    if (taken == 0) return 0;
+    if (taken < 4) {
+        /* Too short for a shingle: hash the whole thing as one. */
+        uint64_t h = dc_spam_mix64(((uint64_t)taken << 32) | window);
+        for (size_t k = 0; k < DC_SPAM_MINHASH; k++) {
+            minhash[k] = (uint32_t)((h * dc_spam_minhash_mul[k]) >> 32);
+        }
+    }
+    return 1;
+}
+
+static uint16_t dc_spam_add_u16(uint16_t a, uint32_t b) {
+    uint32_t sum = (uint32_t)a + b;
+    return (uint16_t)(sum > UINT16_MAX ? UINT16_MAX : sum);
+}
+
+/* Zero the buckets that slid out of the window since the last message. */
+static void dc_spam_user_advance(dc_spam_user_t* user, uint64_t slot) {
+    if (slot <= user->slot) return;
+    uint64_t steps = slot - user->slot;
+    if (steps > DC_SPAM_SLOTS) steps = DC_SPAM_SLOTS;
+    for (uint64_t s = 1; s <= steps; s++) {
+        size_t b = (size_t)((user->slot + s) % DC_SPAM_SLOTS);
+        user->messages[b] = 0;
+        user->mentions[b] = 0;
+        user->attachments[b] = 0;
+    }
+    user->slot = slot;
+}
+
+static int dc_spam_user_expired(const dc_spam_engine_t* engine, const dc_spam_user_t* user, uint64_t now_ms) {
+    return now_ms > user->last_seen_ms && now_ms - user->last_seen_ms > engine->config.expire_ms;
+}
+
+static size_t dc_spam_engine_sweep_some(dc_spam_engine_t* engine, uint64_t now_ms, size_t budget) {
+    size_t dropped = 0;
+    for (size_t n = 0; n < budget; n++) {
+        dc_snowflake_t key = 0;
+        void* slot = NULL;
+        if (!dc_snowflake_map_next(&engine->users, &engine->sweep_cursor, &key, &slot)) {
+            engine->sweep_cursor = 0;
+            break;
+        }
+        if (dc_spam_user_expired(engine, (const dc_spam_user_t*)slot, now_ms)) {
+            (void)dc_snowflake_map_remove(&engine->users, key, NULL);
+            /* Backward-shift deletion may have moved a later entry into this slot. */
+            engine->sweep_cursor--;
+            dropped++;
+        }
+    }
+    return dropped;
+}
+
+dc_status_t dc_spam_engine_observe(dc_spam_engine_t* engine, dc_snowflake_t user_id,
+                                   dc_snowflake_t channel_id, const char* content,
+                                   uint32_t mentions, uint32_t attachments,
+                                   uint64_t now_ms, dc_spam_verdict_t* out) {
+    if (!engine) return DC_ERROR_NULL_POINTER;
+    if (out) memset(out, 0, sizeof(*out));
+    if (!dc_snowflake_is_valid(user_id)) return DC_ERROR_INVALID_PARAM;
+
+    (void)dc_spam_engine_sweep_some(engine, now_ms, DC_SPAM_SWEEP_STEP);
+
+    void* slot = NULL;
+    int inserted = 0;
+    dc_status_t st = dc_snowflake_map_upsert(&engine->users, user_id, &slot, &inserted);
+    if (st != DC_OK) return st;
+    dc_spam_user_t* user = (dc_spam_user_t*)slot;
+    const dc_spam_config_t* cfg = &engine->config;
+
+    /* Out-of-order deliveries count towards the newest bucket. */
+    uint64_t bucket_ms = cfg->window_ms / DC_SPAM_SLOTS;
+    if (inserted || dc_spam_user_expired(engine, user, now_ms)) {
+        memset(user, 0, sizeof(*user));
+        user->slot = now_ms / bucket_ms;
+    } else if (now_ms < user->last_seen_ms) {
+        now_ms = user->last_seen_ms;
+    }
+    dc_spam_user_advance(user, now_ms / bucket_ms);
+    user->last_seen_ms = now_ms;
+
+    size_t b = (size_t)(user->slot % DC_SPAM_SLOTS);
+    user->messages[b] = dc_spam_add_u16(user->messages[b], 1);
+    user->mentions[b] = dc_spam_add_u16(user->mentions[b], mentions);
+    user->attachments[b] = dc_spam_add_u16(user->attachments[b], attachments);
+
+    dc_spam_verdict_t v;
+    memset(&v, 0, sizeof(v));
+    for (size_t i = 0; i < DC_SPAM_SLOTS; i++) {
+        v.messages += user->messages[i];
+        v.mentions += user->mentions[i];
+        v.attachments += user->attachments[i];
+    }
+
+    dc_spam_signature_t sig;
+    memset(&sig, 0, sizeof(sig));
+    if (dc_spam_sign(content, sig.minhash)) {
+        sig.time_ms = now_ms;
+        sig.channel_id = channel_id;
+        dc_snowflake_t channels[DC_SPAM_HISTORY + 1];
+        size_t channel_count = 0;
+        channels[channel_count++] = channel_id;
+        for (size_t h = 0; h < user->history_used; h++) {
+            const dc_spam_signature_t* prev = &user->history[h];
+            if (now_ms - prev->time_ms > cfg->duplicate_window_ms) continue;
+            uint32_t equal = 0;
+            for (size_t k = 0; k < DC_SPAM_MINHASH; k++) {
+                if (prev->minhash[k] == sig.minhash[k]) equal++;
+            }
+            if (equal * 100u < cfg->duplicate_similarity * DC_SPAM_MINHASH) continue;
+            v.duplicates++;
+            size_t c = 0;
+            while (c < channel_count && channels[c] != prev->channel_id) c++;
+            if (c == channel_count) channels[channel_count++] = prev->channel_id;
+        }
+        v.duplicate_channels = v.duplicates > 0 ? (uint32_t)channel_count : 0;
+
+        user->history[user->history_next] = sig;
+        user->history_next = (user->history_next + 1u) % DC_SPAM_HISTORY;
+        if (user->history_used < DC_SPAM_HISTORY) user->history_used++;
+    }
+
+    if (v.messages > cfg->max_messages) v.flags |= DC_SPAM_FLAG_RATE;
+    if (v.mentions > cfg->max_mentions) v.flags |= DC_SPAM_FLAG_MENTIONS;
+    if (v.attachments > cfg->max_attachments) v.flags |= DC_SPAM_FLAG_ATTACHMENTS;
+    if (v.duplicates > cfg->max_duplicates) v.flags |= DC_SPAM_FLAG_DUPLICATE;
+    if (v.duplicate_channels > cfg->max_duplicate_channels) v.flags |= DC_SPAM_FLAG_CROSS_CHANNEL;
+
+    if (out) *out = v;
+    return DC_OK;
+}
+
+static uint64_t dc_spam_message_time(dc_snowflake_t message_id, uint64_t now_ms) {
+    if (now_ms != 0) return now_ms;
+    uint64_t ts = 0;
+    if (dc_snowflake_unix_timestamp_ms(message_id, &ts) != DC_OK) return 0;
+    return ts;
+}
+
+dc_status_t dc_spam_engine_observe_message(dc_spam_engine_t* engine, const dc_message_t* message,
+                                           uint64_t now_ms, dc_spam_verdict_t* out) {
+    if (!engine || !message) return DC_ERROR_NULL_POINTER;
+    uint32_t mentions = (uint32_t)(message->mentions.length + message->mention_roles.length);
+    if (message->mention_everyone) mentions++;
+    return dc_spam_engine_observe(engine, message->author.id, message->channel_id,
+                                  dc_string_cstr(&message->content), mentions,
+                                  (uint32_t)message->attachments.length,
+                                  dc_spam_message_time(message->id, now_ms), out);
+}
+
+static uint32_t dc_spam_json_arr_size(yyjson_val* obj, const char* key) {
+    yyjson_val* arr = yyjson_obj_get(obj, key);
+    return yyjson_is_arr(arr) ? (uint32_t)yyjson_arr_size(arr) : 0u;
+}
+
+dc_status_t dc_spam_engine_process_event(dc_spam_engine_t* engine, const char* event_name,
+                                         const char* event_data, uint64_t now_ms,
+                                         dc_spam_verdict_t* out) {
+    if (!engine || !event_name || !event_data) return DC_ERROR_NULL_POINTER;
+    if (out) memset(out, 0, sizeof(*out));
+    if (strcmp(event_name, "MESSAGE_CREATE") != 0) return DC_OK;
+
+    dc_json_doc_t doc;
+    dc_status_t st = dc_json_parse(event_data, &doc);
+    if (st != DC_OK) return st;
+
+    yyjson_val* author = yyjson_obj_get(doc.root, "author");
+    dc_snowflake_t message_id = 0;
+    dc_snowflake_t channel_id = 0;
+    dc_snowflake_t user_id = 0;
+    int bot = 0;
+    int everyone = 0;
+    if (!yyjson_is_obj(author)) {
+        st = DC_ERROR_INVALID_FORMAT;
+        goto cleanup;
+    }
+    st = dc_json_get_snowflake(author, "id", &user_id);
+    if (st == DC_OK) st = dc_json_get_snowflake(doc.root, "id", &message_id);
+    if (st == DC_OK) st = dc_json_get_snowflake(doc.root, "channel_id", &channel_id);
+    if (st == DC_OK) st = dc_json_get_bool_opt(author, "bot", &bot, 0);
+    if (st != DC_OK) goto cleanup;
+    if (bot && engine->config.ignore_bots) goto cleanup;
+
+    (void)dc_json_get_bool_opt(doc.root, "mention_everyone", &everyone, 0);
+    yyjson_val* content = yyjson_obj_get(doc.root, "content");
+    uint32_t mentions = dc_spam_json_arr_size(doc.root, "mentions") +
+                        dc_spam_json_arr_size(doc.root, "mention_roles") + (everyone ? 1u : 0u);
+    st = dc_spam_engine_observe(engine, user_id, channel_id,
+                                yyjson_is_str(content) ? yyjson_get_str(content) : NULL,
+                                mentions, dc_spam_json_arr_size(doc.root, "attachments"),
+                                dc_spam_message_time(message_id, now_ms), out);
+
+cleanup:
+    dc_json_doc_free(&doc);
+    return st;
+}
+
+dc_status_t dc_spam_engine_forget(dc_spam_engine_t* engine, dc_snowflake_t user_id) {
+    if (!engine) return DC_ERROR_NULL_POINTER;
+    (void)dc_snowflake_map_remove(&engine->users, user_id, NULL);
+    return DC_OK;
+}
+
+size_t dc_spam_engine_sweep(dc_spam_engine_t* engine, uint64_t now_ms) {
+    if (!engine) return 0;
+    engine->sweep_cursor = 0;
+    size_t dropped = dc_spam_engine_sweep_some(engine, now_ms, SIZE_MAX);
+    engine->sweep_cursor = 0;
+    return dropped;
+}
+
+size_t dc_spam_engine_count(const dc_spam_engine_t* engine) {
+    return engine ? dc_snowflake_map_length(&engine->users) : 0;
+}
@@ -0,0 +1,176 @@
+#ifndef DC_SPAM_H
+#define DC_SPAM_H
+
+/**
+ * @file dc_spam.h
+ * @brief Per-user spam and near-duplicate detection
+ *
+ * Keeps a fixed-size record per author: bucketed sliding-window counters for
+ * messages, mentions and attachments, plus MinHash signatures of the last
+ * few messages. Each observed message costs O(content length) to sign and
+ * O(1) to score, independent of how many messages the user sent before.
+ * Records idle for longer than expire_ms are dropped incrementally.
+ *
+ * Not thread-safe: feed and query from the gateway thread or guard externally.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include "core/dc_status.h"
+#include "core/dc_snowflake.h"
+#include "core/dc_snowflake_map.h"
+#include "model/dc_message.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define DC_SPAM_FLAG_RATE          (1u << 0)  /**< Too many messages in the window */
+#define DC_SPAM_FLAG_MENTIONS      (1u << 1)  /**< Too many mentions in the window */
+#define DC_SPAM_FLAG_ATTACHMENTS   (1u << 2)  /**< Too many attachments in the window */
+#define DC_SPAM_FLAG_DUPLICATE     (1u << 3)  /**< Repeated near-identical content */
+#define DC_SPAM_FLAG_CROSS_CHANNEL (1u << 4)  /**< Near-identical content posted across channels */
+
+/**
+ * @brief Spam engine thresholds
+ */
+typedef struct {
+    uint32_t window_ms;                 /**< Rate/mention/attachment window */
+    uint32_t max_messages;              /**< Messages allowed per window */
+    uint32_t max_mentions;              /**< Mentions allowed per window */
+    uint32_t max_attachments;           /**< Attachments allowed per window */
+    uint32_t duplicate_window_ms;       /**< How long signatures are compared against */
+    uint32_t duplicate_similarity;      /**< Estimated Jaccard similarity, percent (1-100) */
+    uint32_t max_duplicates;            /**< Earlier near-duplicates allowed before flagging */
+    uint32_t max_duplicate_channels;    /**< Distinct channels allowed for one near-duplicate */
+    uint32_t expire_ms;                 /**< Idle time after which a user record is dropped */
+    int ignore_bots;                    /**< Skip bot authors in dc_spam_engine_process_event() */
+} dc_spam_config_t;
+
+/**
+ * @brief Result for one observed message
+ */
+typedef struct {
+    uint32_t flags;                 /**< DC_SPAM_FLAG_* bits, 0 when clean */
+    uint32_t messages;              /**< Messages in the window, including this one */
+    uint32_t mentions;              /**< Mentions in the window, including this one */
+    uint32_t attachments;           /**< Attachments in the window, including this one */
+    uint32_t duplicates;            /**< Earlier near-duplicates still within duplicate_window_ms */
+    uint32_t duplicate_channels;    /**< Distinct channels among those and this message */
+} dc_spam_verdict_t;
+
+/**
+ * @brief Spam engine state
+ */
+typedef struct {
+    dc_spam_config_t config;
+    dc_snowflake_map_t users;   /**< user_id -> fixed-size per-user record */
+    size_t sweep_cursor;        /**< Incremental expiry position */
+} dc_spam_engine_t;
+
+/**
+ * @brief Initialize configuration with defaults
+ *
+ * Defaults:
+ * - window_ms: 5000, max_messages: 5, max_mentions: 10, max_attachments: 10
+ * - duplicate_window_ms: 60000, duplicate_similarity: 75
+ * - max_duplicates: 2, max_duplicate_channels: 2
+ * - expire_ms: 120000, ignore_bots: 1
+ */
+void dc_spam_config_init(dc_spam_config_t* config);
+
+/**
+ * @brief Initialize engine
+ * @param engine Engine to initialize
+ * @param config Thresholds (NULL for defaults)
+ * @return DC_OK on success, error code on failure
+ */
+dc_status_t dc_spam_engine_init(dc_spam_engine_t* engine, const dc_spam_config_t* config);
+
+/**
+ * @brief Free engine
+ * @param engine Engine to free
+ */
+void dc_spam_engine_free(dc_spam_engine_t* engine);
+
+/**
+ * @brief Observe one message
+ * @param engine Engine
+ * @param user_id Author ID
+ * @param channel_id Channel ID
+ * @param content Message content (may be NULL; only the first 2000 bytes are signed)
+ * @param mentions Number of mentions in the message
+ * @param attachments Number of attachments in the message
+ * @param now_ms Message time in milliseconds (monotonic or unix, but consistent)
+ * @param out Verdict (may be NULL)
+ * @return DC_OK on success, error code on failure
+ */
+dc_status_t dc_spam_engine_observe(dc_spam_engine_t* engine, dc_snowflake_t user_id,
+                                   dc_snowflake_t channel_id, const char* content,
+                                   uint32_t mentions, uint32_t attachments,
+                                   uint64_t now_ms, dc_spam_verdict_t* out);
+
+/**
+ * @brief Observe a parsed message
+ *
+ * Mentions count users, roles and @everyone/@here.
+ *
+ * @param engine Engine
+ * @param message Message
+ * @param now_ms Message time in ms, or 0 to use the message ID's unix timestamp
+ * @param out Verdict (may be NULL)
+ * @return DC_OK on success, error code on failure
+ */
+dc_status_t dc_spam_engine_observe_message(dc_spam_engine_t* engine, const dc_message_t* message,
+                                           uint64_t now_ms, dc_spam_verdict_t* out);
+
+/**
+ * @brief Route a gateway dispatch to the engine
+ *
+ * Observes MESSAGE_CREATE without building a dc_message_t: only author,
+ * channel_id, content and the mention/attachment array sizes are read.
+ * Other events (and ignored bot authors) leave @p out zeroed.
+ *
+ * @param engine Engine
+ * @param event_name Dispatch event name
+ * @param event_data Dispatch event JSON data
+ * @param now_ms Message time in ms, or 0 to use the message ID's unix timestamp
+ * @param out Verdict (may be NULL)
+ * @return DC_OK on success or for ignored events, error code on failure
+ */
+dc_status_t dc_spam_engine_process_event(dc_spam_engine_t* engine, const char* event_name,
+                                         const char* event_data, uint64_t now_ms,
+                                         dc_spam_verdict_t* out);
+
+/**
+ * @brief Drop a user's record (e.g. after acting on a verdict)
+ * @param engine Engine
+ * @param user_id User ID
+ * @return DC_OK on success (also when not tracked), error code on failure
+ */
+dc_status_t dc_spam_engine_forget(dc_spam_engine_t* engine, dc_snowflake_t user_id);
+
+/**
+ * @brief Drop every record idle for longer than expire_ms
+ *
+ * Observing messages already expires records a few at a time; call this
+ * for a full pass (e.g. from a periodic timer).
+ *
+ * @param engine Engine
+ * @param now_ms Current time in the same clock as observed messages
+ * @return Number of records dropped
+ */
+size_t dc_spam_engine_sweep(dc_spam_engine_t* engine, uint64_t now_ms);
+
+/**
+ * @brief Number of tracked users
+ * @param engine Engine
+ * @return Tracked user count
+ */
+size_t dc_spam_engine_count(const dc_spam_engine_t* engine);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DC_SPAM_H */
@@ -0,0 +1,509 @@
+/**
+ * @file dc_download.c
+ * @brief Parallel ranged downloader on the libcurl multi interface
+ */
+
+#include "dc_download.h"
+#include "http/dc_http_compliance.h"
+#include "http/dc_transfer.h"
+#include "core/dc_alloc.h"
+#include "core/dc_sha256.h"
+#include "core/dc_string.h"
+#include <curl/curl.h>
+#include <stdio.h>
+#include <string.h>
+
+#define DC_DOWNLOAD_OPEN_END UINT64_MAX
+
+struct dc_downloader {
+    CURLM* multi;
+};
+
+typedef struct dc_download_job dc_download_job_t;
+
+typedef struct {
+    dc_download_job_t* job;
+    CURL* easy;
+    uint64_t offset;        /* next byte to write */
+    uint64_t end;           /* exclusive end, DC_DOWNLOAD_OPEN_END while unknown */
+    uint32_t attempts;
+    dc_status_t failed;     /* 5xx that ended this attempt; retried like a transfer error */
+    int checked;            /* response status/headers validated */
+    int discard;            /* body is not file content (satisfied 416) */
+    int done;
+    int has_range;
+    int range_total_known;
+    uint64_t range_first;
+    uint64_t range_last;
+    uint64_t range_total;
+} dc_download_part_t;
+
+struct dc_download_job {
+    dc_downloader_t* downloader;
+    const dc_download_options_t* options;
+    const char* url;
+    int fd;
+    uint64_t start;
+    uint64_t total;         /* 0 while unknown */
+    int total_known;
+    int ranged;
+    dc_download_part_t probe;
+    dc_download_part_t* parts;
+    size_t part_count;
+    size_t next_part;
+    uint32_t active;
+    uint64_t written;
+    uint32_t requests;
+    dc_status_t error;
+    dc_string_t user_agent;
+};
+
+/* ---- file helpers ---- */
+
+static dc_status_t dc_download_verify_sha256(int fd, uint64_t total, const char* expected) {
+    char buf[65536];
+    dc_sha256_t ctx;
+    uint8_t digest[DC_SHA256_DIGEST_SIZE];
+    dc_sha256_init(&ctx);
+    uint64_t offset = 0;
+    while (offset < total) {
+        size_t want = sizeof(buf);
+        if (total - offset < want) want = (size_t)(total - offset);
+        size_t n = 0;
+        if (!dc_transfer_pread_some(fd, buf, want, offset, &n)) return DC_ERROR_UNKNOWN;
+        dc_sha256_update(&ctx, buf, n);
+        offset += n;
+    }
+    dc_sha256_final(&ctx, digest);
+    return dc_sha256_compare_hex(digest, expected);
+}
+
+/* ---- response parsing ---- */
+
+static int dc_download_parse_u64(const char** p, uint64_t* out) {
+    const char* s = *p;
+    uint64_t v = 0;
+    if (*s < '0' || *s > '9') return 0;
+    while (*s >= '0' && *s <= '9') {
+        uint64_t d = (uint64_t)(*s - '0');
+        if (v > (UINT64_MAX - d) / 10u) return 0;
+        v = v * 10u + d;
+        s++;
+    }
+    *p = s;
+    *out = v;
+    return 1;
+}
+
+/* "bytes a-b/total"; a total of "*" leaves range_total_known unset */
+static void dc_download_parse_content_range(dc_download_part_t* part, const char* value) {
+    const char* p = value;
+    part->has_range = 0;
+    part->range_total_known = 0;
+    if (strncmp(p, "bytes ", 6) != 0) return;
+    p += 6;
+    if (!dc_download_parse_u64(&p, &part->range_first) || *p++ != '-') return;
+    if (!dc_download_parse_u64(&p, &part->range_last) || *p++ != '/') return;
+    part->has_range = 1;
+    if (dc_download_parse_u64(&p, &part->range_total)) part->range_total_known = 1;
+}
+
+static size_t dc_download_header_cb(char* buffer, size_t size, size_t nitems, void* userdata) {
+    dc_download_part_t* part = (dc_download_part_t*)userdata;
+    size_t len = size * nitems;
+    if (len >= 5 && strncmp(buffer, "HTTP/", 5) == 0) {
+        /* New response (redirect or retry): forget earlier headers. */
+        part->has_range = 0;
+        part->range_total_known = 0;
+        return len;
+    }
+    static const char name[] = "content-range:";
+    const size_t name_len = sizeof(name) - 1;
+    if (len <= name_len) return len;
+    for (size_t i = 0; i < name_len; i++) {
+        char c = buffer[i];
+        if (c >= 'A' && c <= 'Z') c = (char)(c + ('a' - 'A'));
+        if (c != name[i]) return len;
+    }
+    char value[128];
+    size_t start = name_len;
+    while (start < len && (buffer[start] == ' ' || buffer[start] == '\t')) start++;
+    size_t end = len;
+    while (end > start && (buffer[end - 1] == '\r' || buffer[end - 1] == '\n' ||
+                           buffer[end - 1] == ' ')) {
+        end--;
+    }
+    if (end - start >= sizeof(value)) return len;
+    memcpy(value, buffer + start, end - start);
+    value[end - start] = '\0';
+    if (strncmp(value, "bytes */", 8) == 0) {
+        /* Unsatisfiable-range form: only the total is meaningful. */
+        const char* p = value + 8;
+        part->has_range = 0;
+        part->range_total_known = dc_download_parse_u64(&p, &part->range_total);
+        return len;
+    }
+    dc_download_parse_content_range(part, value);
+    return len;
+}
+
+static dc_status_t dc_download_check_response(dc_download_part_t* part) {
+    dc_download_job_t* job = part->job;
+    long status = 0;
+    curl_easy_getinfo(part->easy, CURLINFO_RESPONSE_CODE, &status);
+    part->checked = 1;
+
+    if (status == 206) {
+        if (!part->has_range || part->range_first != part->offset ||
+            part->range_last < part->range_first || !part->range_total_known ||
+            part->range_last >= part->range_total) {
+            return DC_ERROR_INVALID_FORMAT;
+        }
+        if (part == &job->probe) {
+            job->total = part->range_total;
+            job->total_known = 1;
+            job->ranged = 1;
+            if (part->end > job->total) part->end = job->total;
+        } else if (part->range_total != job->total) {
+            return DC_ERROR_INVALID_FORMAT;
+        }
+        if (part->range_last + 1u > part->end) return DC_ERROR_INVALID_FORMAT;
+        return DC_OK;
+    }
+
+    if (status == 200 && part == &job->probe) {
+        job->ranged = 0;
+        if (job->start > 0) {
+            if (!dc_transfer_truncate(job->fd, 0)) return DC_ERROR_UNKNOWN;
+            job->start = 0;
+        }
+        part->offset = 0;
+        part->end = DC_DOWNLOAD_OPEN_END;
+        curl_off_t length = -1;
+        if (curl_easy_getinfo(part->easy, CURLINFO_CONTENT_LENGTH_DOWNLOAD_T, &length) == CURLE_OK &&
+            length >= 0) {
+            job->total = (uint64_t)length;
+            job->total_known = 1;
+            part->end = job->total;
+        }
+        return DC_OK;
+    }
+
+    if (status == 416 && part == &job->probe && part->range_total_known &&
+        part->range_total == job->start) {
+        /* Resumed a file that was already complete. */
+        job->total = job->start;
+        job->total_known = 1;
+        job->ranged = 1;
+        part->end = part->offset;
+        part->discard = 1;
+        return DC_OK;
+    }
+
+    if (status >= 500) {
+        part->failed = dc_status_from_http(status);
+        return part->failed;
+    }
+    if (status >= 400) return dc_status_from_http(status);
+    return DC_ERROR_HTTP;
+}
+
+static size_t dc_download_write_cb(char* ptr, size_t size, size_t nmemb, void* userdata) {
+    dc_download_part_t* part = (dc_download_part_t*)userdata;
+    dc_download_job_t* job = part->job;
+    size_t len = size * nmemb;
+
+    if (!part->checked) {
+        dc_status_t st = dc_download_check_response(part);
+        if (st != DC_OK) {
+            if (part->failed == DC_OK && job->error == DC_OK) job->error = st;
+            return 0;
+        }
+    }
+    if (part->discard) return len;
+    if (part->end != DC_DOWNLOAD_OPEN_END && (uint64_t)len > part->end - part->offset) {
+        if (job->error == DC_OK) job->error = DC_ERROR_INVALID_FORMAT;
+        return 0;
+    }
+    if (!dc_transfer_pwrite_all(job->fd, ptr, len, part->offset)) {
+        if (job->error == DC_OK) job->error = DC_ERROR_UNKNOWN;
+        return 0;
+    }
+    part->offset += len;
+    job->written += len;
+    if (job->options->progress) {
+        job->options->progress(job->start + job->written, job->total_known ? job->total : 0,
+                               job->options->user_data);
+    }
+    return len;
+}
+
+/* ---- transfers ---- */
+
+static dc_status_t dc_download_start_part(dc_download_job_t* job, dc_download_part_t* part) {
+    const dc_download_options_t* opt = job->options;
+    char range[64];
+    if (part->end == DC_DOWNLOAD_OPEN_END) {
+        snprintf(range, sizeof(range), "%llu-", (unsigned long long)part->offset);
+    } else {
+        snprintf(range, sizeof(range), "%llu-%llu", (unsigned long long)part->offset,
+                 (unsigned long long)(part->end - 1u));
+    }
+
+    if (!part->easy) {
+        part->easy = curl_easy_init();
+        if (!part->easy) return DC_ERROR_OUT_OF_MEMORY;
+    } else {
+        curl_easy_reset(part->easy);
+    }
+    part->failed = DC_OK;
+    part->checked = 0;
+    part->discard = 0;
+    part->has_range = 0;
+    part->range_total_known = 0;
+
+    CURL* easy = part->easy;
+    curl_easy_setopt(easy, CURLOPT_URL, job->url);
+    curl_easy_setopt(easy, CURLOPT_HTTPGET, 1L);
+    curl_easy_setopt(easy, CURLOPT_FOLLOWLOCATION, 1L);
+    curl_easy_setopt(easy, CURLOPT_MAXREDIRS, 5L);
+    curl_easy_setopt(easy, CURLOPT_SSL_VERIFYPEER, 1L);
+    curl_easy_setopt(easy, CURLOPT_SSL_VERIFYHOST, 2L);
+    curl_easy_setopt(easy, CURLOPT_HTTP_VERSION, (long)CURL_HTTP_VERSION_1_1);
+    curl_easy_setopt(easy, CURLOPT_RANGE, range);
+    curl_easy_setopt(easy, CURLOPT_USERAGENT, dc_string_cstr(&job->user_agent));
+    curl_easy_setopt(easy, CURLOPT_WRITEFUNCTION, dc_download_write_cb);
+    curl_easy_setopt(easy, CURLOPT_WRITEDATA, part);
+    curl_easy_setopt(easy, CURLOPT_HEADERFUNCTION, dc_download_header_cb);
+    curl_easy_setopt(easy, CURLOPT_HEADERDATA, part);
+    curl_easy_setopt(easy, CURLOPT_PRIVATE, part);
+    if (opt->connect_timeout_ms > 0) {
+        curl_easy_setopt(easy, CURLOPT_CONNECTTIMEOUT_MS, (long)opt->connect_timeout_ms);
+    }
+    if (opt->stall_timeout_ms > 0) {
+        long seconds = (long)((opt->stall_timeout_ms + 999u) / 1000u);
+        curl_easy_setopt(easy, CURLOPT_LOW_SPEED_LIMIT, 1L);
+        curl_easy_setopt(easy, CURLOPT_LOW_SPEED_TIME, seconds);
+    }
+
+    if (curl_multi_add_handle(job->downloader->multi, easy) != CURLM_OK) {
+        return DC_ERROR_NETWORK;
+    }
+    job->active++;
+    job->requests++;
+    return DC_OK;
+}
+
+/* Once the probe proves range support, split the rest of the file into parts. */
+static dc_status_t dc_download_plan_parts(dc_download_job_t* job) {
+    uint64_t from = job->probe.end;
+    if (from >= job->total) return DC_OK;
+    uint64_t chunk = (uint64_t)job->options->chunk_size;
+    uint64_t count = (job->total - from + chunk - 1u) / chunk;
+    if (count > SIZE_MAX / sizeof(dc_download_part_t)) return DC_ERROR_OUT_OF_MEMORY;
+    job->parts = (dc_download_part_t*)dc_calloc((size_t)count, sizeof(dc_download_part_t));
+    if (!job->parts) return DC_ERROR_OUT_OF_MEMORY;
+    job->part_count = (size_t)count;
+    for (size_t i = 0; i < job->part_count; i++) {
+        dc_download_part_t* part = &job->parts[i];
+        part->job = job;
+        part->offset = from + (uint64_t)i * chunk;
+        part->end = part->offset + chunk;
+        if (part->end > job->total) part->end = job->total;
+    }
+    return DC_OK;
+}
+
+static dc_status_t dc_download_fill(void* ctx) {
+    dc_download_job_t* job = (dc_download_job_t*)ctx;
+    if (job->error != DC_OK) return job->error;
+    if (!job->probe.checked || !job->ranged) return DC_OK;
+    if (!job->parts) {
+        dc_status_t st = dc_download_plan_parts(job);
+        if (st != DC_OK) return st;
+    }
+    while (job->next_part < job->part_count && job->active < job->options->max_connections) {
+        dc_status_t st = dc_download_start_part(job, &job->parts[job->next_part]);
+        if (st != DC_OK) return st;
+        job->next_part++;
+    }
+    return DC_OK;
+}
+
+static dc_status_t dc_download_finish_part(void* ctx, void* priv, CURLcode code) {
+    dc_download_job_t* job = (dc_download_job_t*)ctx;
+    dc_download_part_t* part = (dc_download_part_t*)priv;
+    curl_multi_remove_handle(job->downloader->multi, part->easy);
+    job->active--;
+    if (job->error != DC_OK) return job->error;
+
+    if (code == CURLE_OK && !part->checked) {
+        /* Empty body: nothing went through the write callback. */
+        dc_status_t st = dc_download_check_response(part);
+        if (st != DC_OK && part->failed == DC_OK) return st;
+    }
+    if (code == CURLE_OK && part->failed == DC_OK) {
+        if (part->end == DC_DOWNLOAD_OPEN_END) {
+            job->total = part->offset;
+            job->total_known = 1;
+            part->end = part->offset;
+        }
+        if (part->offset >= part->end) {
+            part->done = 1;
+            return DC_OK;
+        }
+        /*
+         * Server answered a shorter range than asked; continue from where it
+         * stopped. Counted like a retry so a server that keeps doing it ends.
+         */
+        if (!job->ranged || part->attempts >= job->options->max_retries) return DC_ERROR_NETWORK;
+        part->attempts++;
+        return dc_download_start_part(job, part);
+    }
+
+    /* Transfer error or 5xx: retry the unfinished tail of this part. */
+    dc_status_t failure = (part->failed != DC_OK) ? part->failed : DC_ERROR_NETWORK;
+    if (part->attempts >= job->options->max_retries) return failure;
+    if (part == &job->probe && (!part->checked || part->failed != DC_OK)) {
+        /* Nothing known yet; start over. */
+    } else if (!job->ranged) {
+        return failure;
+    }
+    part->attempts++;
+    return dc_download_start_part(job, part);
+}
+
+static uint64_t dc_download_committed(const dc_download_job_t* job) {
+    const dc_download_part_t* probe = &job->probe;
+    if (!probe->checked && !probe->done) return job->start;
+    if (!probe->done) return probe->offset;
+    uint64_t committed = probe->offset;
+    for (size_t i = 0; i < job->part_count; i++) {
+        const dc_download_part_t* part = &job->parts[i];
+        if (i >= job->next_part) break;
+        committed = part->offset;
+        if (!part->done) break;
+    }
+    return committed;
+}
+
+static void dc_download_job_release(dc_download_job_t* job) {
+    CURLM* multi = job->downloader->multi;
+    if (job->probe.easy) {
+        curl_multi_remove_handle(multi, job->probe.easy);
+        curl_easy_cleanup(job->probe.easy);
+    }
+    for (size_t i = 0; i < job->part_count; i++) {
+        if (job->parts[i].easy) {
+            curl_multi_remove_handle(multi, job->parts[i].easy);
+            curl_easy_cleanup(job->parts[i].easy);
+        }
+    }
+    dc_free(job->parts);
+    job->parts = NULL;
+    dc_string_free(&job->user_agent);
+}
+
+static dc_status_t dc_download_run(dc_download_job_t* job) {
+    dc_status_t st = dc_download_start_part(job, &job->probe);
+    if (st != DC_OK) return st;
+    st = dc_transfer_multi_run(job->downloader->multi, &job->active, dc_download_finish_part,
+                               dc_download_fill, job);
+    return (st != DC_OK) ? st : job->error;
+}
+
+void dc_download_options_init(dc_download_options_t* options) {
+    if (!options) return;
+    memset(options, 0, sizeof(*options));
+    options->max_connections = 4;
+    options->chunk_size = 8u * 1024u * 1024u;
+    options->connect_timeout_ms = 10000;
+    options->stall_timeout_ms = 30000;
+    options->max_retries = 2;
+}
+
+dc_status_t dc_downloader_create(dc_downloader_t** out) {
+    if (!out) return DC_ERROR_NULL_POINTER;
+    *out = NULL;
+    dc_downloader_t* downloader = (dc_downloader_t*)dc_calloc(1, sizeof(*downloader));
+    if (!downloader) return DC_ERROR_OUT_OF_MEMORY;
+    dc_status_t st = dc_transfer_multi_create(&downloader->multi);
+    if (st != DC_OK) {
+        dc_free(downloader);
+        return st;
+    }
+    *out = downloader;
+    return DC_OK;
+}
+
+void dc_downloader_free(dc_downloader_t* downloader) {
+    if (!downloader) return;
+    dc_transfer_multi_free(downloader->multi);
+    dc_free(downloader);
+}
+
+dc_status_t dc_download_to_fd(dc_downloader_t* downloader, const char* url, int fd,
+                              const dc_download_options_t* options,
+                              dc_download_result_t* result) {
+    if (!downloader || !url) return DC_ERROR_NULL_POINTER;
+    if (url[0] == '\0' || fd < 0) return DC_ERROR_INVALID_PARAM;
+
+    dc_download_options_t defaults;
+    dc_download_options_init(&defaults);
+    dc_download_options_t opt = options ? *options : defaults;
+    if (opt.max_connections == 0) opt.max_connections = defaults.max_connections;
+    if (opt.chunk_size == 0) opt.chunk_size = defaults.chunk_size;
+    if (result) memset(result, 0, sizeof(*result));
+
+    dc_download_job_t job;
+    memset(&job, 0, sizeof(job));
+    job.downloader = downloader;
+    job.options = &opt;
+    job.url = url;
+    job.fd = fd;
+    job.error = DC_OK;
+    job.probe.job = &job;
+
+    if (opt.resume) {
+        if (!dc_transfer_file_size(fd, &job.start)) return DC_ERROR_INVALID_PARAM;
+    } else if (!dc_transfer_truncate(fd, 0)) {
+        return DC_ERROR_INVALID_PARAM;
+    }
+    job.probe.offset = job.start;
+    job.probe.end = job.start + (uint64_t)opt.chunk_size;
+
+    dc_status_t st = dc_string_init(&job.user_agent);
+    if (st != DC_OK) return st;
+    if (opt.user_agent && opt.user_agent[0] != '\0') {
+        st = dc_string_set_cstr(&job.user_agent, opt.user_agent);
+    } else {
+        st = dc_http_format_default_user_agent(&job.user_agent);
+    }
+    if (st != DC_OK) {
+        dc_string_free(&job.user_agent);
+        return st;
+    }
+    curl_multi_setopt(downloader->multi, CURLMOPT_MAX_HOST_CONNECTIONS, (long)opt.max_connections);
+
+    uint64_t resumed_from = job.start;
+    st = dc_download_run(&job);
+    if (!job.ranged && job.probe.checked) resumed_from = 0;
+
+    uint64_t committed = (st == DC_OK) ? job.total : dc_download_committed(&job);
+    if (st != DC_OK) {
+        /* Drop anything past the contiguous prefix so a resume is exact. */
+        dc_transfer_truncate(fd, committed);
+    } else if (opt.expected_sha256) {
+        st = dc_download_verify_sha256(fd, job.total, opt.expected_sha256);
+    }
+
+    if (result) {
+        result->total_bytes = job.total_known ? job.total : 0;
+        result->committed_bytes = committed;
+        result->resumed_from = resumed_from;
+        result->requests = job.requests;
+        result->ranged = job.ranged;
+    }
+    dc_download_job_release(&job);
+    return st;
+}
@@ -0,0 +1,122 @@
+#ifndef DC_DOWNLOAD_H
+#define DC_DOWNLOAD_H
+
+/**
+ * @file dc_download.h
+ * @brief Parallel ranged downloads for attachments and other CDN files
+ *
+ * Streams a URL (typically dc_attachment_t.url) straight into a file
+ * descriptor. The first request asks for one chunk with a Range header; if
+ * the server answers 206, the rest of the file is fetched as further range
+ * requests over up to max_connections parallel connections, each written at
+ * its own offset with pwrite(). Nothing is buffered beyond libcurl's receive
+ * buffers, so memory stays bounded regardless of file size. Servers that
+ * ignore Range get a single streamed request.
+ *
+ * A downloader keeps its connection cache between calls; reuse one for many
+ * files from the same host. A downloader is not thread-safe, but separate
+ * downloaders can run on separate threads.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include "core/dc_status.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Progress callback
+ * @param present_bytes Bytes of the file written so far (including resumed bytes)
+ * @param total_bytes Size of the file, 0 while unknown
+ * @param user_data User data from the options
+ */
+typedef void (*dc_download_progress_fn)(uint64_t present_bytes, uint64_t total_bytes,
+                                        void* user_data);
+
+/**
+ * @brief Per-download options
+ */
+typedef struct {
+    uint32_t max_connections;           /**< Parallel range requests */
+    size_t chunk_size;                  /**< Bytes per range request */
+    uint32_t connect_timeout_ms;        /**< Connection timeout (0 = libcurl default) */
+    uint32_t stall_timeout_ms;          /**< Abort a request receiving nothing for this long (0 = off) */
+    uint32_t max_retries;               /**< Retries per range after a transfer error, 5xx or short response */
+    int resume;                         /**< Keep the bytes already in the file and fetch the rest */
+    const char* expected_sha256;        /**< Hex digest of the complete file (NULL = no check) */
+    const char* user_agent;             /**< User-Agent (NULL = library default) */
+    dc_download_progress_fn progress;   /**< Optional progress callback */
+    void* user_data;                    /**< Passed to progress */
+} dc_download_options_t;
+
+/**
+ * @brief Download outcome (filled on success and on failure)
+ */
+typedef struct {
+    uint64_t total_bytes;       /**< Size of the complete file, 0 if never learned */
+    uint64_t committed_bytes;   /**< Contiguous bytes at the start of the file; resume point */
+    uint64_t resumed_from;      /**< Bytes that were already present and kept */
+    uint32_t requests;          /**< HTTP requests issued, retries included */
+    int ranged;                 /**< Server honored range requests */
+} dc_download_result_t;
+
+/**
+ * @brief Downloader (opaque)
+ */
+typedef struct dc_downloader dc_downloader_t;
+
+/**
+ * @brief Initialize options with defaults
+ *
+ * Defaults:
+ * - max_connections: 4, chunk_size: 8 MiB, max_retries: 2
+ * - connect_timeout_ms: 10000, stall_timeout_ms: 30000
+ * - resume: 0, expected_sha256: NULL
+ */
+void dc_download_options_init(dc_download_options_t* options);
+
+/**
+ * @brief Create a downloader
+ * @param out Pointer to store created downloader
+ * @return DC_OK on success, error code on failure
+ */
+dc_status_t dc_downloader_create(dc_downloader_t** out);
+
+/**
+ * @brief Free a downloader and its cached connections
+ * @param downloader Downloader to free
+ */
+void dc_downloader_free(dc_downloader_t* downloader);
+
+/**
+ * @brief Download @p url into @p fd
+ *
+ * Without options->resume the file is truncated first. With it, the current
+ * file size is taken as already downloaded and only the remainder is
+ * requested (a server without range support restarts from zero).
+ *
+ * On failure the file is truncated to result->committed_bytes, so calling
+ * again with resume set continues where this call stopped. On a checksum
+ * mismatch the complete file is left in place.
+ *
+ * @param downloader Downloader
+ * @param url http(s) URL
+ * @param fd Writable, seekable file descriptor
+ * @param options Options (NULL for defaults)
+ * @param result Optional outcome
+ * @return DC_OK on success, DC_ERROR_NETWORK on transfer failure, the mapped
+ *         HTTP status for error responses, DC_ERROR_INVALID_FORMAT for
+ *         inconsistent range responses, DC_ERROR_INVALID_STATE on checksum
+ *         mismatch
+ */
+dc_status_t dc_download_to_fd(dc_downloader_t* downloader, const char* url, int fd,
+                              const dc_download_options_t* options,
+                              dc_download_result_t* result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DC_DOWNLOAD_H */
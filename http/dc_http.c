@@ -5,34 +5,76 @@
 
 #include "dc_http.h"
 #include "http/dc_http_compliance.h"
+#include "http/dc_tls_sessions.h"
 #include "core/dc_alloc.h"
+#include "core/dc_platform.h"
 #include <curl/curl.h>
+#include <stdatomic.h>
 #include <string.h>
 #include <ctype.h>
 
+/* Largest Content-Length trusted to pre-size a response body. */
+#define DC_HTTP_BODY_RESERVE_MAX (64u * 1024u * 1024u)
+
+/* curl_multi_poll + curl_multi_wakeup let a fired token interrupt the wait. */
+#if LIBCURL_VERSION_NUM >= 0x074400
+#define DC_HTTP_HAVE_MULTI_WAKEUP 1
+#endif
+
 struct dc_http_client {
     CURL* curl;
+#ifdef DC_HTTP_HAVE_MULTI_WAKEUP
+    CURLM* multi;           /* drives every transfer, so the connection cache stays in one place */
+#endif
+    dc_tls_curl_probe_t tls_probe;
 };
 
-static int g_curl_refcount = 0;
+struct dc_http_cancel {
+    atomic_int fired;
+    dc_platform_mutex_t lock;
+#ifdef DC_HTTP_HAVE_MULTI_WAKEUP
+    CURLM* waiting;         /* multi handle of the transfer using the token, guarded by lock */
+#endif
+};
 
-static dc_status_t dc_curl_global_acquire(void) {
-    if (g_curl_refcount == 0) {
-        if (curl_global_init((long)CURL_GLOBAL_DEFAULT) != 0) {
-            return DC_ERROR_NETWORK;
-        }
-    }
-    g_curl_refcount++;
-    return DC_OK;
-}
+static int g_curl_refcount = 0;
+/* REST clients create handles on demand from any thread. */
+static dc_platform_mutex_t g_curl_lock = DC_PLATFORM_MUTEX_INITIALIZER;
 
-static void dc_curl_global_release(void) {
+static void dc_curl_global_drop(void) {
+    if (!dc_platform_mutex_lock(&g_curl_lock)) return;
     if (g_curl_refcount > 0) {
         g_curl_refcount--;
         if (g_curl_refcount == 0) {
             curl_global_cleanup();
         }
     }
+    (void)dc_platform_mutex_unlock(&g_curl_lock);
+}
+
+dc_status_t dc_http_global_acquire(void) {
+    dc_status_t st = DC_OK;
+    if (!dc_platform_mutex_lock(&g_curl_lock)) return DC_ERROR_INVALID_STATE;
+    if (g_curl_refcount == 0 && curl_global_init((long)CURL_GLOBAL_DEFAULT) != 0) {
+        st = DC_ERROR_NETWORK;
+    } else {
+        g_curl_refcount++;
+    }
+    (void)dc_platform_mutex_unlock(&g_curl_lock);
+    if (st != DC_OK) return st;
+
+    /*
+     * One TLS session cache for every handle in the process. Taken outside
+     * g_curl_lock, since filling it from the session store runs user code.
+     */
+    st = dc_tls_sessions_acquire();
+    if (st != DC_OK) dc_curl_global_drop();
+    return st;
+}
+
+void dc_http_global_release(void) {
+    dc_tls_sessions_release();
+    dc_curl_global_drop();
 }
 
 static int dc_ascii_tolower_int(int c) {
@@ -52,6 +94,15 @@ static int dc_ascii_strcaseeq(const char* a, const char* b) {
     return *a == '\0' && *b == '\0';
 }
 
+static int dc_ascii_strncaseeq(const char* a, const char* b, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        if (dc_ascii_tolower_int((unsigned char)a[i]) != dc_ascii_tolower_int((unsigned char)b[i])) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
 static int dc_http_header_value_valid(const char* value) {
     if (!value) return 0;
     for (const char* p = value; *p; p++) {
@@ -139,20 +190,31 @@ dc_status_t dc_http_client_create(dc_http_client_t** client) {
     if (!client) return DC_ERROR_NULL_POINTER;
     *client = NULL;
 
-    dc_status_t st = dc_curl_global_acquire();
+    dc_status_t st = dc_http_global_acquire();
     if (st != DC_OK) return st;
 
     dc_http_client_t* c = (dc_http_client_t*)dc_alloc(sizeof(dc_http_client_t));
     if (!c) {
-        dc_curl_global_release();
+        dc_http_global_release();
         return DC_ERROR_OUT_OF_MEMORY;
     }
     c->curl = curl_easy_init();
     if (!c->curl) {
         dc_free(c);
-        dc_curl_global_release();
+        dc_http_global_release();
         return DC_ERROR_NETWORK;
     }
+#ifdef DC_HTTP_HAVE_MULTI_WAKEUP
+    c->multi = curl_multi_init();
+    if (!c->multi) {
+        curl_easy_cleanup(c->curl);
+        dc_free(c);
+        dc_http_global_release();
+        return DC_ERROR_NETWORK;
+    }
+#endif
+    dc_tls_sessions_attach_curl(c->curl);
+    c->tls_probe.easy = c->curl;
 
     *client = c;
     return DC_OK;
@@ -160,18 +222,25 @@ dc_status_t dc_http_client_create(dc_http_client_t** client) {
 
 void dc_http_client_free(dc_http_client_t* client) {
     if (!client) return;
+#ifdef DC_HTTP_HAVE_MULTI_WAKEUP
+    if (client->multi) {
+        curl_multi_cleanup(client->multi);
+        client->multi = NULL;
+    }
+#endif
     if (client->curl) {
         curl_easy_cleanup(client->curl);
         client->curl = NULL;
     }
     dc_free(client);
-    dc_curl_global_release();
+    dc_http_global_release();
 }
 
 dc_status_t dc_http_request_init(dc_http_request_t* request) {
     if (!request) return DC_ERROR_NULL_POINTER;
     request->method = DC_HTTP_GET;
     request->timeout_ms = 0;
+    request->cancel = NULL;
     dc_status_t st = dc_string_init(&request->url);
     if (st != DC_OK) return st;
     st = dc_vec_init(&request->headers, sizeof(dc_http_header_t));
@@ -196,6 +265,7 @@ void dc_http_request_free(dc_http_request_t* request) {
     dc_string_free(&request->body);
     request->method = DC_HTTP_GET;
     request->timeout_ms = 0;
+    request->cancel = NULL;
 }
 
 dc_status_t dc_http_response_init(dc_http_response_t* response) {
@@ -321,6 +391,21 @@ static size_t dc_http_header_cb(char* buffer, size_t size, size_t nitems, void*
         value_len--;
     }
 
+    /* Size the body once up front instead of growing it chunk by chunk. */
+    if (name_len == sizeof("Content-Length") - 1u &&
+        dc_ascii_strncaseeq(buffer, "Content-Length", name_len)) {
+        uint64_t length = 0;
+        size_t i = 0;
+        for (; i < value_len && value_start[i] >= '0' && value_start[i] <= '9' &&
+               length <= DC_HTTP_BODY_RESERVE_MAX; i++) {
+            length = length * 10u + (uint64_t)(value_start[i] - '0');
+        }
+        if (i == value_len && length > 0 && length <= DC_HTTP_BODY_RESERVE_MAX) {
+            (void)dc_string_reserve(&response->body,
+                                    dc_string_length(&response->body) + (size_t)length + 1u);
+        }
+    }
+
     char name_buf[256];
     char* name_ptr = name_buf;
     if (name_len == 0) return total;
@@ -351,6 +436,102 @@ static size_t dc_http_header_cb(char* buffer, size_t size, size_t nitems, void*
     return total;
 }
 
+dc_status_t dc_http_cancel_create(dc_http_cancel_t** cancel) {
+    if (!cancel) return DC_ERROR_NULL_POINTER;
+    *cancel = NULL;
+    dc_http_cancel_t* c = (dc_http_cancel_t*)dc_calloc(1, sizeof(*c));
+    if (!c) return DC_ERROR_OUT_OF_MEMORY;
+    if (!dc_platform_mutex_init(&c->lock)) {
+        dc_free(c);
+        return DC_ERROR_INVALID_STATE;
+    }
+    atomic_init(&c->fired, 0);
+    *cancel = c;
+    return DC_OK;
+}
+
+void dc_http_cancel_free(dc_http_cancel_t* cancel) {
+    if (!cancel) return;
+    dc_platform_mutex_destroy(&cancel->lock);
+    dc_free(cancel);
+}
+
+void dc_http_cancel_fire(dc_http_cancel_t* cancel) {
+    if (!cancel) return;
+    atomic_store(&cancel->fired, 1);
+#ifdef DC_HTTP_HAVE_MULTI_WAKEUP
+    if (!dc_platform_mutex_lock(&cancel->lock)) return;
+    if (cancel->waiting) (void)curl_multi_wakeup(cancel->waiting);
+    (void)dc_platform_mutex_unlock(&cancel->lock);
+#endif
+}
+
+int dc_http_cancel_fired(const dc_http_cancel_t* cancel) {
+    if (!cancel) return 0;
+    return atomic_load(&cancel->fired) != 0;
+}
+
+#ifdef DC_HTTP_HAVE_MULTI_WAKEUP
+/* Publishes the multi handle to wake; 0 if the token already fired. */
+static int dc_http_cancel_watch(dc_http_cancel_t* cancel, CURLM* multi) {
+    if (!cancel) return 1;
+    if (!dc_platform_mutex_lock(&cancel->lock)) return 0;
+    int fired = dc_http_cancel_fired(cancel);
+    if (!fired) cancel->waiting = multi;
+    (void)dc_platform_mutex_unlock(&cancel->lock);
+    return !fired;
+}
+
+/* After this returns, dc_http_cancel_fire no longer touches the multi handle. */
+static void dc_http_cancel_unwatch(dc_http_cancel_t* cancel) {
+    if (!cancel) return;
+    if (!dc_platform_mutex_lock(&cancel->lock)) return;
+    cancel->waiting = NULL;
+    (void)dc_platform_mutex_unlock(&cancel->lock);
+}
+
+static CURLcode dc_http_perform(dc_http_client_t* client, dc_http_cancel_t* cancel) {
+    if (curl_multi_add_handle(client->multi, client->curl) != CURLM_OK) return CURLE_FAILED_INIT;
+    if (!dc_http_cancel_watch(cancel, client->multi)) {
+        (void)curl_multi_remove_handle(client->multi, client->curl);
+        return CURLE_ABORTED_BY_CALLBACK;
+    }
+
+    CURLcode res = CURLE_OK;
+    for (;;) {
+        int running = 0;
+        if (curl_multi_perform(client->multi, &running) != CURLM_OK) {
+            res = CURLE_FAILED_INIT;
+            break;
+        }
+        if (running == 0) {
+            int queued = 0;
+            CURLMsg* msg = curl_multi_info_read(client->multi, &queued);
+            res = (msg && msg->msg == CURLMSG_DONE) ? msg->data.result : CURLE_FAILED_INIT;
+            break;
+        }
+        if (dc_http_cancel_fired(cancel)) {
+            res = CURLE_ABORTED_BY_CALLBACK;
+            break;
+        }
+        if (curl_multi_poll(client->multi, NULL, 0, 1000, NULL) != CURLM_OK) {
+            res = CURLE_FAILED_INIT;
+            break;
+        }
+    }
+
+    dc_http_cancel_unwatch(cancel);
+    (void)curl_multi_remove_handle(client->multi, client->curl);
+    return res;
+}
+#else
+/* Without curl_multi_wakeup a token only stops transfers that have not started. */
+static CURLcode dc_http_perform(dc_http_client_t* client, dc_http_cancel_t* cancel) {
+    if (dc_http_cancel_fired(cancel)) return CURLE_ABORTED_BY_CALLBACK;
+    return curl_easy_perform(client->curl);
+}
+#endif
+
 dc_status_t dc_http_client_execute(dc_http_client_t* client,
                                    const dc_http_request_t* request,
                                    dc_http_response_t* response) {
@@ -375,7 +556,9 @@ dc_status_t dc_http_client_execute(dc_http_client_t* client,
     response->status_code = 0;
     response->total_time = 0.0;
 
+    /* The reset keeps the share, so the next connection can still resume. */
     curl_easy_reset(client->curl);
+    dc_tls_sessions_probe_curl(&client->tls_probe);
     curl_easy_setopt(client->curl, CURLOPT_URL, dc_string_cstr(&request->url));
     curl_easy_setopt(client->curl, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2TLS);
     curl_easy_setopt(client->curl, CURLOPT_SSL_VERIFYPEER, 1L);
@@ -464,13 +647,14 @@ dc_status_t dc_http_client_execute(dc_http_client_t* client,
         curl_easy_setopt(client->curl, CURLOPT_HTTPHEADER, header_list);
     }
 
-    CURLcode res = curl_easy_perform(client->curl);
+    CURLcode res = dc_http_perform(client, request->cancel);
     if (header_list) curl_slist_free_all(header_list);
     if (!has_ua) dc_string_free(&ua);
 
     if (res != CURLE_OK) {
         return DC_ERROR_NETWORK;
     }
+    dc_tls_sessions_record_curl(&client->tls_probe);
 
     curl_easy_getinfo(client->curl, CURLINFO_RESPONSE_CODE, &response->status_code);
     curl_easy_getinfo(client->curl, CURLINFO_TOTAL_TIME, &response->total_time);
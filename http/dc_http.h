@@ -40,6 +40,11 @@ typedef struct {
     dc_string_t value;  /**< Header value */
 } dc_http_header_t;
 
+/**
+ * @brief Cancellation token for an HTTP transfer
+ */
+typedef struct dc_http_cancel dc_http_cancel_t;
+
 /**
  * @brief HTTP request structure
  */
@@ -49,6 +54,7 @@ typedef struct {
     dc_vec_t headers;           /**< Headers (dc_http_header_t) */
     dc_string_t body;           /**< Request body */
     uint32_t timeout_ms;        /**< Timeout in milliseconds */
+    dc_http_cancel_t* cancel;   /**< Optional, not owned: firing it abandons the transfer */
 } dc_http_request_t;
 
 /**
@@ -66,6 +72,22 @@ typedef struct {
  */
 typedef struct dc_http_client dc_http_client_t;
 
+/**
+ * @brief Take a reference on libcurl's process-wide state
+ *
+ * Serializes curl_global_init() against every other user in the process and
+ * sets up the shared TLS session cache. Modules driving their own curl
+ * handles call this instead of curl_global_init(); HTTP clients do it
+ * themselves.
+ * @return DC_OK on success, error code on failure
+ */
+dc_status_t dc_http_global_acquire(void);
+
+/**
+ * @brief Drop a reference taken with dc_http_global_acquire()
+ */
+void dc_http_global_release(void);
+
 /**
  * @brief Create HTTP client
  * @param client Pointer to store created client
@@ -163,6 +185,36 @@ dc_status_t dc_http_request_set_json_body(dc_http_request_t* request, const char
  */
 dc_status_t dc_http_request_set_timeout(dc_http_request_t* request, uint32_t timeout_ms);
 
+/**
+ * @brief Create a cancellation token
+ * @param cancel Pointer to store created token
+ * @return DC_OK on success, error code on failure
+ */
+dc_status_t dc_http_cancel_create(dc_http_cancel_t** cancel);
+
+/**
+ * @brief Free a cancellation token; no transfer may still be using it
+ * @param cancel Token to free
+ */
+void dc_http_cancel_free(dc_http_cancel_t* cancel);
+
+/**
+ * @brief Fire a token from any thread
+ *
+ * A transfer using it stops waiting at once and fails with DC_ERROR_NETWORK.
+ * The request may already have reached the server. Custom REST transports
+ * should poll dc_http_cancel_fired() to honour it.
+ * @param cancel Token to fire
+ */
+void dc_http_cancel_fire(dc_http_cancel_t* cancel);
+
+/**
+ * @brief Check whether a token was fired
+ * @param cancel Token, may be NULL
+ * @return 1 if fired, 0 otherwise
+ */
+int dc_http_cancel_fired(const dc_http_cancel_t* cancel);
+
 /**
  * @brief Execute HTTP request
  * @param client HTTP client
@@ -4,7 +4,6 @@
  */
 
 #include "dc_http_compliance.h"
-#include "core/dc_alloc.h"
 #include "json/dc_json.h"
 #include <string.h>
 #include <ctype.h>
@@ -211,93 +210,142 @@ void dc_http_error_free(dc_http_error_t* err) {
     err->code = 0;
 }
 
-dc_status_t dc_http_error_parse(const char* body, size_t body_len, dc_http_error_t* err) {
-    if (!body || !err) return DC_ERROR_NULL_POINTER;
+/* yyjson_read() never reads in situ, so bodies are parsed without a copy or a cast. */
+static dc_status_t dc_http_read_json(const char* body, size_t body_len, yyjson_doc** out) {
     if (body_len == 0) body_len = strlen(body);
     if (body_len == 0) return DC_ERROR_INVALID_FORMAT;
+    *out = yyjson_read(body, body_len, 0);
+    return *out ? DC_OK : DC_ERROR_JSON;
+}
 
-    char* mutable_body = (char*)dc_alloc(body_len + 1);
-    if (!mutable_body) return DC_ERROR_OUT_OF_MEMORY;
-    memcpy(mutable_body, body, body_len);
-    mutable_body[body_len] = '\0';
-
-    yyjson_doc* doc = yyjson_read_opts(mutable_body, body_len, 0, NULL, NULL);
-    if (!doc) {
-        dc_free(mutable_body);
-        return DC_ERROR_JSON;
-    }
-
-    yyjson_val* root = yyjson_doc_get_root(doc);
-    if (!root || !yyjson_is_obj(root)) {
-        yyjson_doc_free(doc);
-        dc_free(mutable_body);
+static dc_status_t dc_http_read_json_object(const char* body, size_t body_len,
+                                            yyjson_doc** out_doc, yyjson_val** out_root) {
+    dc_status_t st = dc_http_read_json(body, body_len, out_doc);
+    if (st != DC_OK) return st;
+    *out_root = yyjson_doc_get_root(*out_doc);
+    if (!*out_root || !yyjson_is_obj(*out_root)) {
+        yyjson_doc_free(*out_doc);
+        *out_doc = NULL;
         return DC_ERROR_INVALID_FORMAT;
     }
+    return DC_OK;
+}
 
+static dc_status_t dc_http_error_fill(yyjson_val* root, dc_http_error_t* err,
+                                      dc_http_rate_limit_response_t* rl) {
+    /* A malformed "code" fails the error but not the 429 retry fields. */
+    int code = 0;
     yyjson_val* code_val = yyjson_obj_get(root, "code");
-    if (code_val && yyjson_is_int(code_val)) {
-        err->code = (int)yyjson_get_int(code_val);
-    } else if (code_val) {
-        yyjson_doc_free(doc);
-        dc_free(mutable_body);
-        return DC_ERROR_INVALID_FORMAT;
-    } else {
-        err->code = 0;
-    }
+    int code_ok = !code_val || yyjson_is_int(code_val);
+    if (code_val && code_ok) code = (int)yyjson_get_int(code_val);
 
     yyjson_val* msg_val = yyjson_obj_get(root, "message");
-    if (!msg_val || !yyjson_is_str(msg_val)) {
-        yyjson_doc_free(doc);
-        dc_free(mutable_body);
-        return DC_ERROR_INVALID_FORMAT;
+    const char* msg = (msg_val && yyjson_is_str(msg_val)) ? yyjson_get_str(msg_val) : NULL;
+    if (!msg) return DC_ERROR_INVALID_FORMAT;
+
+    if (rl) {
+        yyjson_val* retry_val = yyjson_obj_get(root, "retry_after");
+        if (retry_val && yyjson_is_num(retry_val)) {
+            rl->retry_after = yyjson_get_num(retry_val);
+        } else if (retry_val) {
+            return DC_ERROR_INVALID_FORMAT;
+        }
+        yyjson_val* global_val = yyjson_obj_get(root, "global");
+        if (global_val && yyjson_is_bool(global_val)) {
+            rl->global = yyjson_get_bool(global_val) ? 1 : 0;
+        } else if (global_val) {
+            return DC_ERROR_INVALID_FORMAT;
+        }
+        rl->code = code;
+        if (dc_string_set_cstr(&rl->message, msg) != DC_OK) return DC_ERROR_OUT_OF_MEMORY;
+    }
+
+    if (err) {
+        if (!code_ok) return DC_ERROR_INVALID_FORMAT;
+        err->code = code;
+        if (dc_string_set_cstr(&err->message, msg) != DC_OK) return DC_ERROR_OUT_OF_MEMORY;
+        yyjson_val* errors_val = yyjson_obj_get(root, "errors");
+        if (errors_val) {
+            dc_status_t st = dc_json_write_value_to_string(errors_val, 0u, &err->errors);
+            if (st != DC_OK) return st;
+        } else {
+            dc_string_clear(&err->errors);
+        }
     }
+    return DC_OK;
+}
 
-    const char* msg = yyjson_get_str(msg_val);
-    if (!msg) {
-        yyjson_doc_free(doc);
-        dc_free(mutable_body);
-        return DC_ERROR_INVALID_FORMAT;
-    }
-    if (dc_string_set_cstr(&err->message, msg) != DC_OK) {
-        yyjson_doc_free(doc);
-        dc_free(mutable_body);
-        return DC_ERROR_OUT_OF_MEMORY;
-    }
+dc_status_t dc_http_error_parse(const char* body, size_t body_len, dc_http_error_t* err) {
+    return dc_http_error_decode(body, body_len, err, NULL);
+}
+
+dc_status_t dc_http_error_decode(const char* body, size_t body_len, dc_http_error_t* err,
+                                 dc_http_rate_limit_response_t* rl) {
+    if (!body || (!err && !rl)) return DC_ERROR_NULL_POINTER;
+    yyjson_doc* doc = NULL;
+    yyjson_val* root = NULL;
+    dc_status_t st = dc_http_read_json_object(body, body_len, &doc, &root);
+    if (st != DC_OK) return st;
+    st = dc_http_error_fill(root, err, rl);
+    yyjson_doc_free(doc);
+    return st;
+}
 
-    yyjson_val* errors_val = yyjson_obj_get(root, "errors");
-    if (errors_val) {
-        dc_status_t st = dc_json_write_value_to_string(errors_val, 0u, &err->errors);
-        if (st != DC_OK) {
-            yyjson_doc_free(doc);
-            dc_free(mutable_body);
-            return st;
+static dc_status_t dc_http_field_errors_walk(yyjson_val* obj, char* path, size_t path_len,
+                                             dc_http_field_error_fn visit, void* ctx) {
+    size_t idx, max;
+    yyjson_val* key;
+    yyjson_val* val;
+    yyjson_obj_foreach(obj, idx, max, key, val) {
+        const char* name = yyjson_get_str(key);
+        if (!name) continue;
+        if (strcmp(name, "_errors") == 0) {
+            if (!yyjson_is_arr(val)) continue;
+            size_t i, n;
+            yyjson_val* item;
+            yyjson_arr_foreach(val, i, n, item) {
+                const char* code = yyjson_get_str(yyjson_obj_get(item, "code"));
+                const char* message = yyjson_get_str(yyjson_obj_get(item, "message"));
+                dc_status_t st = visit(ctx, path, code ? code : "", message ? message : "");
+                if (st != DC_OK) return st;
+            }
+            continue;
         }
-    } else {
-        dc_string_clear(&err->errors);
+        if (!yyjson_is_obj(val)) continue;
+        size_t name_len = strlen(name);
+        size_t sep = (path_len > 0) ? 1u : 0u;
+        if (path_len + sep + name_len >= DC_HTTP_FIELD_ERROR_PATH_MAX) return DC_ERROR_BUFFER_TOO_SMALL;
+        if (sep) path[path_len] = '.';
+        memcpy(path + path_len + sep, name, name_len + 1);
+        dc_status_t st = dc_http_field_errors_walk(val, path, path_len + sep + name_len, visit, ctx);
+        path[path_len] = '\0';
+        if (st != DC_OK) return st;
     }
+    return DC_OK;
+}
 
+dc_status_t dc_http_error_foreach_field_error(const dc_http_error_t* err,
+                                              dc_http_field_error_fn visit, void* ctx) {
+    if (!err || !visit) return DC_ERROR_NULL_POINTER;
+    if (dc_string_is_empty(&err->errors)) return DC_OK;
+    yyjson_doc* doc = NULL;
+    yyjson_val* root = NULL;
+    dc_status_t st = dc_http_read_json_object(dc_string_cstr(&err->errors),
+                                              dc_string_length(&err->errors), &doc, &root);
+    if (st != DC_OK) return st;
+    char path[DC_HTTP_FIELD_ERROR_PATH_MAX];
+    path[0] = '\0';
+    st = dc_http_field_errors_walk(root, path, 0, visit, ctx);
     yyjson_doc_free(doc);
-    dc_free(mutable_body);
-    return DC_OK;
+    return st;
 }
 
 dc_status_t dc_http_validate_json_body(const char* body, size_t body_len) {
     if (!body) return DC_ERROR_NULL_POINTER;
-    if (body_len == 0) body_len = strlen(body);
-    if (body_len == 0) return DC_ERROR_INVALID_FORMAT;
-
-    char* mutable_body = (char*)dc_alloc(body_len + 1);
-    if (!mutable_body) return DC_ERROR_OUT_OF_MEMORY;
-    memcpy(mutable_body, body, body_len);
-    mutable_body[body_len] = '\0';
-
-    yyjson_doc* doc = yyjson_read_opts(mutable_body, body_len, 0, NULL, NULL);
-    if (!doc) {
-        dc_free(mutable_body);
-        return DC_ERROR_JSON;
-    }
+    yyjson_doc* doc = NULL;
+    dc_status_t st = dc_http_read_json(body, body_len, &doc);
+    if (st != DC_OK) return st;
     yyjson_doc_free(doc);
-    dc_free(mutable_body);
     return DC_OK;
 }
 
@@ -419,74 +467,5 @@ void dc_http_rate_limit_response_free(dc_http_rate_limit_response_t* rl) {
 
 dc_status_t dc_http_rate_limit_response_parse(const char* body, size_t body_len,
                                               dc_http_rate_limit_response_t* rl) {
-    if (!body || !rl) return DC_ERROR_NULL_POINTER;
-    if (body_len == 0) body_len = strlen(body);
-    if (body_len == 0) return DC_ERROR_INVALID_FORMAT;
-
-    char* mutable_body = (char*)dc_alloc(body_len + 1);
-    if (!mutable_body) return DC_ERROR_OUT_OF_MEMORY;
-    memcpy(mutable_body, body, body_len);
-    mutable_body[body_len] = '\0';
-
-    yyjson_doc* doc = yyjson_read_opts(mutable_body, body_len, 0, NULL, NULL);
-    if (!doc) {
-        dc_free(mutable_body);
-        return DC_ERROR_JSON;
-    }
-
-    yyjson_val* root = yyjson_doc_get_root(doc);
-    if (!root || !yyjson_is_obj(root)) {
-        yyjson_doc_free(doc);
-        dc_free(mutable_body);
-        return DC_ERROR_INVALID_FORMAT;
-    }
-
-    yyjson_val* msg_val = yyjson_obj_get(root, "message");
-    if (!msg_val || !yyjson_is_str(msg_val)) {
-        yyjson_doc_free(doc);
-        dc_free(mutable_body);
-        return DC_ERROR_INVALID_FORMAT;
-    }
-    const char* msg = yyjson_get_str(msg_val);
-    if (!msg) {
-        yyjson_doc_free(doc);
-        dc_free(mutable_body);
-        return DC_ERROR_INVALID_FORMAT;
-    }
-    if (dc_string_set_cstr(&rl->message, msg) != DC_OK) {
-        yyjson_doc_free(doc);
-        dc_free(mutable_body);
-        return DC_ERROR_OUT_OF_MEMORY;
-    }
-
-    yyjson_val* retry_val = yyjson_obj_get(root, "retry_after");
-    if (retry_val && yyjson_is_num(retry_val)) {
-        rl->retry_after = yyjson_get_num(retry_val);
-    } else if (retry_val) {
-        yyjson_doc_free(doc);
-        dc_free(mutable_body);
-        return DC_ERROR_INVALID_FORMAT;
-    }
-
-    yyjson_val* global_val = yyjson_obj_get(root, "global");
-    if (global_val && yyjson_is_bool(global_val)) {
-        rl->global = yyjson_get_bool(global_val) ? 1 : 0;
-    } else if (global_val) {
-        yyjson_doc_free(doc);
-        dc_free(mutable_body);
-        return DC_ERROR_INVALID_FORMAT;
-    }
-
-    yyjson_val* code_val = yyjson_obj_get(root, "code");
-    if (code_val && yyjson_is_int(code_val)) {
-        rl->code = (int)yyjson_get_int(code_val);
-    } else if (code_val) {
-        yyjson_doc_free(doc);
-        dc_free(mutable_body);
-        return DC_ERROR_INVALID_FORMAT;
-    }
-
-    yyjson_doc_free(doc);
-    dc_free(mutable_body);
-    return DC_OK;
+    return dc_http_error_decode(body, body_len, NULL, rl);
 }
@@ -256,6 +256,58 @@ void dc_http_rate_limit_response_free(dc_http_rate_limit_response_t* rl);
 dc_status_t dc_http_rate_limit_response_parse(const char* body, size_t body_len,
                                               dc_http_rate_limit_response_t* rl);
 
+/**
+ * @brief Decode a 4xx body once into the error and/or 429 fields
+ *
+ * Parses the body in place (no copy) and fills whichever outputs are given.
+ * "code" and "message" go to both; "retry_after" and "global" only to @p rl.
+ * Pass @p rl only for 429 responses, since other errors have no retry fields.
+ * A "code" that is not an integer fails @p err but leaves rl->code at 0 and
+ * still fills the other rate-limit fields.
+ * Nested field errors stay as raw JSON in err->errors until
+ * dc_http_error_foreach_field_error() walks them.
+ *
+ * @param body JSON body
+ * @param body_len Length of body (0 to auto-calc)
+ * @param err Error struct to populate (may be NULL)
+ * @param rl Rate limit response struct to populate (may be NULL)
+ * @return DC_OK on success, DC_ERROR_NULL_POINTER if both outputs are NULL,
+ *         DC_ERROR_JSON or DC_ERROR_INVALID_FORMAT for malformed bodies
+ */
+dc_status_t dc_http_error_decode(const char* body, size_t body_len, dc_http_error_t* err,
+                                 dc_http_rate_limit_response_t* rl);
+
+/** Longest dotted field path reported by dc_http_error_foreach_field_error() */
+#define DC_HTTP_FIELD_ERROR_PATH_MAX 256
+
+/**
+ * @brief Called once per nested field error
+ * @param ctx User context
+ * @param path Dotted field path (e.g. "embeds.0.title"), "" for body-level errors
+ * @param code Error code string (e.g. "BASE_TYPE_REQUIRED"), "" if absent
+ * @param message Error message, "" if absent
+ * @return DC_OK to continue, anything else stops the walk and is returned
+ */
+typedef dc_status_t (*dc_http_field_error_fn)(void* ctx, const char* path,
+                                              const char* code, const char* message);
+
+/**
+ * @brief Visit every field error in err->errors
+ *
+ * Discord nests field errors as objects keyed by field name or array index,
+ * with an "_errors" array at each failing field. The errors JSON is only
+ * parsed when this is called.
+ *
+ * @param err Decoded error
+ * @param visit Callback
+ * @param ctx User context for visit
+ * @return DC_OK when all were visited (or none exist), the callback's status
+ *         if it stopped the walk, DC_ERROR_BUFFER_TOO_SMALL for paths longer
+ *         than DC_HTTP_FIELD_ERROR_PATH_MAX
+ */
+dc_status_t dc_http_error_foreach_field_error(const dc_http_error_t* err,
+                                              dc_http_field_error_fn visit, void* ctx);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,1045 @@
+/**
+ * @file dc_interactions_server.c
+ * @brief HTTP interactions endpoint (outgoing webhook delivery)
+ */
+
+#include "dc_interactions_server.h"
+#include "core/dc_alloc.h"
+#include "core/dc_ed25519.h"
+#include "core/dc_platform.h"
+#include "gw/dc_events.h"
+#include <stdio.h>
+#include <string.h>
+
+void dc_interactions_server_config_init(dc_interactions_server_config_t* config) {
+    if (!config) return;
+    memset(config, 0, sizeof(*config));
+    config->host = "127.0.0.1";
+    config->port = 0;
+    config->path = "/interactions";
+    config->worker_count = 4;
+    config->queue_capacity = 256;
+    config->max_connections = 1024;
+    config->max_body_bytes = 1024u * 1024u;
+    config->idle_timeout_ms = 60000;
+    config->max_timestamp_skew_s = 0;
+}
+
+dc_status_t dc_interactions_response_set(dc_string_t* response_json, int type,
+                                         const char* data_json) {
+    if (!response_json) return DC_ERROR_NULL_POINTER;
+    if (type <= 0) return DC_ERROR_INVALID_PARAM;
+    if (data_json && data_json[0] != '\0') {
+        return dc_string_printf(response_json, "{\"type\":%d,\"data\":%s}", type, data_json);
+    }
+    return dc_string_printf(response_json, "{\"type\":%d}", type);
+}
+
+#if defined(__linux__)
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <strings.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+
+#define DC_IXS_MAX_HEADER_BYTES 16384u
+#define DC_IXS_READ_CHUNK 4096u
+#define DC_IXS_MAX_EVENTS 64
+#define DC_IXS_SWEEP_INTERVAL_MS 1000u
+
+typedef struct dc_ixs_conn {
+    int fd;                     /**< -1 once closed (struct may outlive it while in flight) */
+    int in_flight;              /**< Request handed to a worker */
+    int keep_alive;             /**< Keep the connection after the pending response */
+    int sent_continue;          /**< 100 Continue already sent for the current request */
+    char* in;
+    size_t in_len;
+    size_t in_cap;
+    char* out;
+    size_t out_len;
+    size_t out_off;
+    size_t out_cap;
+    uint64_t last_active_ms;
+    struct dc_ixs_conn* prev;
+    struct dc_ixs_conn* next;
+} dc_ixs_conn_t;
+
+typedef struct dc_ixs_job {
+    dc_ixs_conn_t* conn;
+    char* body;
+    size_t body_len;
+    char timestamp[32];
+    size_t timestamp_len;
+    uint8_t signature[DC_ED25519_SIGNATURE_SIZE];
+    int keep_alive;
+    dc_string_t response;       /**< Full HTTP response, filled by the worker */
+    struct dc_ixs_job* next;
+} dc_ixs_job_t;
+
+struct dc_interactions_server {
+    dc_interactions_server_config_t config;
+    char* host;
+    char* path;
+    uint8_t public_key[DC_ED25519_PUBLIC_KEY_SIZE];
+
+    int listen_fd;
+    int epoll_fd;
+    int event_fd;
+    uint16_t port;
+
+    int running;
+    atomic_int stopping;
+    dc_platform_thread_t io_thread;
+    dc_platform_thread_t* workers;
+    uint32_t workers_started;
+
+    dc_platform_mutex_t lock;   /**< Guards queue, done list and workers_stop */
+    dc_platform_cond_t cond;
+    int workers_stop;
+    dc_ixs_job_t** queue;
+    size_t queue_head;
+    size_t queue_count;
+    dc_ixs_job_t* done_head;
+    dc_ixs_job_t* done_tail;
+
+    /* I/O thread only */
+    dc_ixs_conn_t* conns;
+    size_t conn_count;
+    dc_ixs_conn_t* graveyard;
+
+    atomic_uint_fast64_t connections;
+    atomic_uint_fast64_t requests;
+    atomic_uint_fast64_t pings;
+    atomic_uint_fast64_t dispatched;
+    atomic_uint_fast64_t signature_failures;
+    atomic_uint_fast64_t rejected_busy;
+    atomic_uint_fast64_t bad_requests;
+    atomic_uint_fast64_t handler_errors;
+};
+
+static uint64_t dc_ixs_now_ms(void) {
+    uint64_t now = 0;
+    (void)dc_platform_now_monotonic_ms(&now);
+    return now;
+}
+
+static const char* dc_ixs_reason(int status) {
+    switch (status) {
+        case 100: return "Continue";
+        case 200: return "OK";
+        case 400: return "Bad Request";
+        case 401: return "Unauthorized";
+        case 404: return "Not Found";
+        case 405: return "Method Not Allowed";
+        case 411: return "Length Required";
+        case 413: return "Payload Too Large";
+        case 431: return "Request Header Fields Too Large";
+        case 500: return "Internal Server Error";
+        case 503: return "Service Unavailable";
+        default: return "Error";
+    }
+}
+
+static dc_status_t dc_ixs_format_response(dc_string_t* out, int status, const char* content_type,
+                                          const char* body, size_t body_len, int keep_alive,
+                                          const char* extra_headers) {
+    dc_status_t st = dc_string_printf(out,
+                                      "HTTP/1.1 %d %s\r\n"
+                                      "Content-Type: %s\r\n"
+                                      "Content-Length: %zu\r\n"
+                                      "Connection: %s\r\n"
+                                      "%s\r\n",
+                                      status, dc_ixs_reason(status), content_type, body_len,
+                                      keep_alive ? "keep-alive" : "close",
+                                      extra_headers ? extra_headers : "");
+    if (st != DC_OK) return st;
+    if (body_len == 0) return DC_OK;
+    return dc_string_append_buffer(out, body, body_len);
+}
+
+static dc_status_t dc_ixs_format_error(dc_string_t* out, int status, const char* message,
+                                       int keep_alive, const char* extra_headers) {
+    return dc_ixs_format_response(out, status, "text/plain; charset=utf-8", message,
+                                  strlen(message), keep_alive, extra_headers);
+}
+
+/* ---------------------------------------------------------------------------
+ * Workers
+ * ------------------------------------------------------------------------- */
+
+static int dc_ixs_timestamp_ok(const dc_interactions_server_t* server, const dc_ixs_job_t* job) {
+    if (server->config.max_timestamp_skew_s == 0) return 1;
+    uint64_t ts = 0;
+    for (size_t i = 0; i < job->timestamp_len; i++) {
+        char c = job->timestamp[i];
+        if (c < '0' || c > '9' || ts > UINT64_MAX / 10u) return 0;
+        ts = ts * 10u + (uint64_t)(c - '0');
+    }
+    uint64_t now_ms = 0;
+    if (dc_platform_now_epoch_ms(&now_ms) != 0) return 1;
+    uint64_t now = now_ms / 1000u;
+    uint64_t skew = now > ts ? now - ts : ts - now;
+    return skew <= server->config.max_timestamp_skew_s;
+}
+
+static const char* dc_ixs_default_response(dc_interaction_type_t type) {
+    switch (type) {
+        case DC_INTERACTION_TYPE_MESSAGE_COMPONENT:
+            return "{\"type\":6}";
+        case DC_INTERACTION_TYPE_APPLICATION_COMMAND_AUTOCOMPLETE:
+            return "{\"type\":8,\"data\":{\"choices\":[]}}";
+        case DC_INTERACTION_TYPE_APPLICATION_COMMAND:
+        case DC_INTERACTION_TYPE_MODAL_SUBMIT:
+        case DC_INTERACTION_TYPE_PING:
+        default:
+            return "{\"type\":5}";
+    }
+}
+
+static dc_status_t dc_ixs_process_job(dc_interactions_server_t* server, dc_ixs_job_t* job) {
+    if (dc_ed25519_verify_prefixed(server->public_key, job->signature, job->timestamp,
+                                   job->timestamp_len, job->body, job->body_len) != DC_OK ||
+        !dc_ixs_timestamp_ok(server, job)) {
+        atomic_fetch_add(&server->signature_failures, 1);
+        return dc_ixs_format_error(&job->response, 401, "invalid request signature",
+                                   job->keep_alive, NULL);
+    }
+
+    dc_interaction_t interaction;
+    if (dc_gateway_event_parse_interaction_create(job->body, &interaction) != DC_OK) {
+        atomic_fetch_add(&server->bad_requests, 1);
+        return dc_ixs_format_error(&job->response, 400, "malformed interaction",
+                                   job->keep_alive, NULL);
+    }
+
+    dc_status_t st;
+    if (interaction.type == DC_INTERACTION_TYPE_PING) {
+        atomic_fetch_add(&server->pings, 1);
+        st = dc_ixs_format_response(&job->response, 200, "application/json", "{\"type\":1}", 10,
+                                    job->keep_alive, NULL);
+        dc_interaction_free(&interaction);
+        return st;
+    }
+
+    atomic_fetch_add(&server->dispatched, 1);
+    dc_string_t body;
+    st = dc_string_init(&body);
+    if (st == DC_OK) {
+        st = server->config.handler(&interaction, job->body, &body, server->config.user_data);
+        if (st != DC_OK) {
+            atomic_fetch_add(&server->handler_errors, 1);
+            st = dc_ixs_format_error(&job->response, 500, "handler failed", job->keep_alive, NULL);
+        } else {
+            if (dc_string_is_empty(&body)) st = dc_string_set_cstr(&body, dc_ixs_default_response(interaction.type));
+            if (st == DC_OK) {
+                st = dc_ixs_format_response(&job->response, 200, "application/json",
+                                            dc_string_cstr(&body), dc_string_length(&body),
+                                            job->keep_alive, NULL);
+            }
+        }
+        dc_string_free(&body);
+    }
+    dc_interaction_free(&interaction);
+    return st;
+}
+
+static void dc_ixs_worker_main(void* arg) {
+    dc_interactions_server_t* server = (dc_interactions_server_t*)arg;
+    for (;;) {
+        (void)dc_platform_mutex_lock(&server->lock);
+        while (server->queue_count == 0 && !server->workers_stop) {
+            (void)dc_platform_cond_wait(&server->cond, &server->lock);
+        }
+        if (server->workers_stop) {
+            dc_platform_mutex_unlock(&server->lock);
+            break;
+        }
+        dc_ixs_job_t* job = server->queue[server->queue_head];
+        server->queue_head = (server->queue_head + 1u) % server->config.queue_capacity;
+        server->queue_count--;
+        dc_platform_mutex_unlock(&server->lock);
+
+        if (dc_ixs_process_job(server, job) != DC_OK) {
+            /* Out of memory while formatting: drop the connection rather than hang it. */
+            job->keep_alive = 0;
+            (void)dc_string_clear(&job->response);
+        }
+
+        (void)dc_platform_mutex_lock(&server->lock);
+        job->next = NULL;
+        if (server->done_tail) {
+            server->done_tail->next = job;
+        } else {
+            server->done_head = job;
+        }
+        server->done_tail = job;
+        dc_platform_mutex_unlock(&server->lock);
+
+        uint64_t one = 1;
+        ssize_t wr = write(server->event_fd, &one, sizeof(one));
+        (void)wr;
+    }
+}
+
+static void dc_ixs_job_free(dc_ixs_job_t* job) {
+    if (!job) return;
+    dc_free(job->body);
+    dc_string_free(&job->response);
+    dc_free(job);
+}
+
+/* ---------------------------------------------------------------------------
+ * Connections (I/O thread)
+ * ------------------------------------------------------------------------- */
+
+static void dc_ixs_conn_set_events(dc_interactions_server_t* server, dc_ixs_conn_t* conn) {
+    if (conn->fd < 0) return;
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    if (conn->out_off < conn->out_len) {
+        ev.events = EPOLLOUT;
+    } else if (!conn->in_flight) {
+        ev.events = EPOLLIN;
+    }
+    ev.data.ptr = conn;
+    (void)epoll_ctl(server->epoll_fd, EPOLL_CTL_MOD, conn->fd, &ev);
+}
+
+/* Close the socket now; the struct is freed at the end of the loop iteration
+ * (or when its in-flight job completes) so pending events never dangle. */
+static void dc_ixs_conn_close(dc_interactions_server_t* server, dc_ixs_conn_t* conn) {
+    if (conn->fd >= 0) {
+        (void)epoll_ctl(server->epoll_fd, EPOLL_CTL_DEL, conn->fd, NULL);
+        close(conn->fd);
+        conn->fd = -1;
+    }
+    if (conn->prev) {
+        conn->prev->next = conn->next;
+    } else if (server->conns == conn) {
+        server->conns = conn->next;
+    } else {
+        return; /* already unlinked */
+    }
+    if (conn->next) conn->next->prev = conn->prev;
+    server->conn_count--;
+    conn->prev = NULL;
+    conn->next = NULL;
+    if (!conn->in_flight) {
+        conn->next = server->graveyard;
+        server->graveyard = conn;
+    }
+}
+
+static void dc_ixs_conn_destroy(dc_ixs_conn_t* conn) {
+    dc_free(conn->in);
+    dc_free(conn->out);
+    dc_free(conn);
+}
+
+static void dc_ixs_bury(dc_interactions_server_t* server) {
+    while (server->graveyard) {
+        dc_ixs_conn_t* conn = server->graveyard;
+        server->graveyard = conn->next;
+        dc_ixs_conn_destroy(conn);
+    }
+}
+
+static int dc_ixs_conn_queue_output(dc_ixs_conn_t* conn, const char* data, size_t len) {
+    if (conn->out_off == conn->out_len) {
+        conn->out_off = 0;
+        conn->out_len = 0;
+    }
+    if (conn->out_len + len > conn->out_cap) {
+        size_t cap = conn->out_cap ? conn->out_cap : 1024u;
+        while (cap < conn->out_len + len) cap *= 2u;
+        char* grown = (char*)dc_realloc(conn->out, cap);
+        if (!grown) return 0;
+        conn->out = grown;
+        conn->out_cap = cap;
+    }
+    memcpy(conn->out + conn->out_len, data, len);
+    conn->out_len += len;
+    return 1;
+}
+
+/* Returns 1 when everything was written, 0 when EPOLLOUT is needed, -1 on error. */
+static int dc_ixs_conn_flush(dc_ixs_conn_t* conn) {
+    while (conn->out_off < conn->out_len) {
+        ssize_t n = send(conn->fd, conn->out + conn->out_off, conn->out_len - conn->out_off,
+                         MSG_NOSIGNAL);
+        if (n > 0) {
+            conn->out_off += (size_t)n;
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && errno == EAGAIN) return 0;
+        return -1;
+    }
+    conn->out_off = 0;
+    conn->out_len = 0;
+    return 1;
+}
+
+/* Queue a complete response and write as much as possible. */
+static void dc_ixs_conn_respond(dc_interactions_server_t* server, dc_ixs_conn_t* conn,
+                                const char* data, size_t len, int keep_alive) {
+    conn->keep_alive = keep_alive;
+    if (len == 0 || !dc_ixs_conn_queue_output(conn, data, len)) {
+        dc_ixs_conn_close(server, conn);
+        return;
+    }
+    int flushed = dc_ixs_conn_flush(conn);
+    if (flushed < 0 || (flushed > 0 && !keep_alive)) {
+        dc_ixs_conn_close(server, conn);
+        return;
+    }
+    dc_ixs_conn_set_events(server, conn);
+}
+
+static void dc_ixs_conn_reject(dc_interactions_server_t* server, dc_ixs_conn_t* conn, int status,
+                               const char* message, int keep_alive, const char* extra_headers) {
+    dc_string_t response;
+    if (dc_string_init(&response) != DC_OK ||
+        dc_ixs_format_error(&response, status, message, keep_alive, extra_headers) != DC_OK) {
+        dc_string_free(&response);
+        dc_ixs_conn_close(server, conn);
+        return;
+    }
+    dc_ixs_conn_respond(server, conn, dc_string_cstr(&response), dc_string_length(&response),
+                        keep_alive);
+    dc_string_free(&response);
+}
+
+static void dc_ixs_conn_consume(dc_ixs_conn_t* conn, size_t len) {
+    memmove(conn->in, conn->in + len, conn->in_len - len);
+    conn->in_len -= len;
+    conn->sent_continue = 0;
+}
+
+static const char* dc_ixs_find_header_end(const char* data, size_t len) {
+    for (size_t i = 3; i < len; i++) {
+        if (data[i] == '\n' && data[i - 1] == '\r' && data[i - 2] == '\n' && data[i - 3] == '\r') {
+            return data + i + 1;
+        }
+    }
+    return NULL;
+}
+
+static int dc_ixs_token_equals(const char* p, size_t len, const char* lit) {
+    size_t n = strlen(lit);
+    return len == n && strncasecmp(p, lit, n) == 0;
+}
+
+typedef struct {
+    const char* method;
+    size_t method_len;
+    const char* target;
+    size_t target_len;
+    int http10;
+    int has_length;
+    size_t content_length;
+    int chunked;
+    int connection_close;
+    int connection_keep_alive;
+    int expect_continue;
+    const char* signature;
+    size_t signature_len;
+    const char* timestamp;
+    size_t timestamp_len;
+} dc_ixs_request_t;
+
+/* Parse the request line and headers in [data, end). Returns 0 on malformed input. */
+static int dc_ixs_parse_head(const char* data, const char* end, dc_ixs_request_t* req) {
+    memset(req, 0, sizeof(*req));
+    const char* line_end = memchr(data, '\r', (size_t)(end - data));
+    if (!line_end) return 0;
+    const char* sp1 = memchr(data, ' ', (size_t)(line_end - data));
+    if (!sp1) return 0;
+    const char* sp2 = memchr(sp1 + 1, ' ', (size_t)(line_end - sp1 - 1));
+    if (!sp2) return 0;
+    req->method = data;
+    req->method_len = (size_t)(sp1 - data);
+    req->target = sp1 + 1;
+    req->target_len = (size_t)(sp2 - sp1 - 1);
+    size_t version_len = (size_t)(line_end - sp2 - 1);
+    if (dc_ixs_token_equals(sp2 + 1, version_len, "HTTP/1.0")) {
+        req->http10 = 1;
+    } else if (!dc_ixs_token_equals(sp2 + 1, version_len, "HTTP/1.1")) {
+        return 0;
+    }
+
+    const char* p = line_end + 2;
+    while (p < end - 2) {
+        const char* eol = memchr(p, '\r', (size_t)(end - p));
+        if (!eol || eol == p) break;
+        const char* colon = memchr(p, ':', (size_t)(eol - p));
+        if (!colon) return 0;
+        size_t name_len = (size_t)(colon - p);
+        const char* v = colon + 1;
+        while (v < eol && (*v == ' ' || *v == '\t')) v++;
+        const char* v_end = eol;
+        while (v_end > v && (v_end[-1] == ' ' || v_end[-1] == '\t')) v_end--;
+        size_t v_len = (size_t)(v_end - v);
+
+        if (dc_ixs_token_equals(p, name_len, "content-length")) {
+            if (v_len == 0 || req->has_length) return 0;
+            size_t n = 0;
+            for (size_t i = 0; i < v_len; i++) {
+                if (v[i] < '0' || v[i] > '9' || n > (SIZE_MAX - 9u) / 10u) return 0;
+                n = n * 10u + (size_t)(v[i] - '0');
+            }
+            req->has_length = 1;
+            req->content_length = n;
+        } else if (dc_ixs_token_equals(p, name_len, "transfer-encoding")) {
+            req->chunked = 1;
+        } else if (dc_ixs_token_equals(p, name_len, "connection")) {
+            if (dc_ixs_token_equals(v, v_len, "close")) req->connection_close = 1;
+            if (dc_ixs_token_equals(v, v_len, "keep-alive")) req->connection_keep_alive = 1;
+        } else if (dc_ixs_token_equals(p, name_len, "expect")) {
+            if (dc_ixs_token_equals(v, v_len, "100-continue")) req->expect_continue = 1;
+        } else if (dc_ixs_token_equals(p, name_len, "x-signature-ed25519")) {
+            req->signature = v;
+            req->signature_len = v_len;
+        } else if (dc_ixs_token_equals(p, name_len, "x-signature-timestamp")) {
+            req->timestamp = v;
+            req->timestamp_len = v_len;
+        }
+        p = eol + 2;
+    }
+    return 1;
+}
+
+static int dc_ixs_path_matches(const dc_interactions_server_t* server, const dc_ixs_request_t* req) {
+    size_t len = req->target_len;
+    const char* q = memchr(req->target, '?', len);
+    if (q) len = (size_t)(q - req->target);
+    return len == strlen(server->path) && memcmp(req->target, server->path, len) == 0;
+}
+
+static int dc_ixs_enqueue(dc_interactions_server_t* server, dc_ixs_job_t* job) {
+    int queued = 0;
+    (void)dc_platform_mutex_lock(&server->lock);
+    if (server->queue_count < server->config.queue_capacity) {
+        size_t tail = (server->queue_head + server->queue_count) % server->config.queue_capacity;
+        server->queue[tail] = job;
+        server->queue_count++;
+        queued = 1;
+        dc_platform_cond_signal(&server->cond);
+    }
+    dc_platform_mutex_unlock(&server->lock);
+    return queued;
+}
+
+/* Handle one complete request: answer it directly or hand it to a worker. */
+static void dc_ixs_conn_handle(dc_interactions_server_t* server, dc_ixs_conn_t* conn,
+                              const dc_ixs_request_t* req, size_t head_len) {
+    int keep_alive = req->http10 ? req->connection_keep_alive : !req->connection_close;
+    const char* body = conn->in + head_len;
+    size_t body_len = req->content_length;
+    atomic_fetch_add(&server->requests, 1);
+
+    if (!dc_ixs_path_matches(server, req)) {
+        atomic_fetch_add(&server->bad_requests, 1);
+        dc_ixs_conn_consume(conn, head_len + body_len);
+        dc_ixs_conn_reject(server, conn, 404, "not found", keep_alive, NULL);
+        return;
+    }
+    if (!dc_ixs_token_equals(req->method, req->method_len, "POST")) {
+        atomic_fetch_add(&server->bad_requests, 1);
+        dc_ixs_conn_consume(conn, head_len + body_len);
+        dc_ixs_conn_reject(server, conn, 405, "method not allowed", keep_alive, "Allow: POST\r\n");
+        return;
+    }
+
+    dc_ixs_job_t* job = (dc_ixs_job_t*)dc_calloc(1, sizeof(*job));
+    if (!job || dc_string_init(&job->response) != DC_OK) {
+        dc_free(job);
+        dc_ixs_conn_close(server, conn);
+        return;
+    }
+    if (req->signature_len != 2u * DC_ED25519_SIGNATURE_SIZE || req->timestamp_len == 0 ||
+        req->timestamp_len >= sizeof(job->timestamp)) {
+        dc_ixs_job_free(job);
+        atomic_fetch_add(&server->signature_failures, 1);
+        dc_ixs_conn_consume(conn, head_len + body_len);
+        dc_ixs_conn_reject(server, conn, 401, "invalid request signature", keep_alive, NULL);
+        return;
+    }
+    char hex[2u * DC_ED25519_SIGNATURE_SIZE + 1u];
+    memcpy(hex, req->signature, req->signature_len);
+    hex[req->signature_len] = '\0';
+    if (dc_ed25519_decode_hex(hex, job->signature, sizeof(job->signature)) != DC_OK) {
+        dc_ixs_job_free(job);
+        atomic_fetch_add(&server->signature_failures, 1);
+        dc_ixs_conn_consume(conn, head_len + body_len);
+        dc_ixs_conn_reject(server, conn, 401, "invalid request signature", keep_alive, NULL);
+        return;
+    }
+    memcpy(job->timestamp, req->timestamp, req->timestamp_len);
+    job->timestamp_len = req->timestamp_len;
+    job->body = (char*)dc_alloc(body_len + 1u);
+    if (!job->body) {
+        dc_ixs_job_free(job);
+        dc_ixs_conn_close(server, conn);
+        return;
+    }
+    memcpy(job->body, body, body_len);
+    job->body[body_len] = '\0';
+    job->body_len = body_len;
+    job->keep_alive = keep_alive;
+    job->conn = conn;
+    dc_ixs_conn_consume(conn, head_len + body_len);
+
+    if (!dc_ixs_enqueue(server, job)) {
+        dc_ixs_job_free(job);
+        atomic_fetch_add(&server->rejected_busy, 1);
+        dc_ixs_conn_reject(server, conn, 503, "server busy", keep_alive, "Retry-After: 1\r\n");
+        return;
+    }
+    conn->in_flight = 1;
+    dc_ixs_conn_set_events(server, conn);
+}
+
+/* Parse buffered requests while the connection is idle (handles pipelining). */
+static void dc_ixs_conn_process(dc_interactions_server_t* server, dc_ixs_conn_t* conn) {
+    while (conn->fd >= 0 && !conn->in_flight && conn->out_len == 0 && conn->in_len > 0) {
+        const char* head_end = dc_ixs_find_header_end(conn->in, conn->in_len);
+        if (!head_end) {
+            if (conn->in_len > DC_IXS_MAX_HEADER_BYTES) {
+                atomic_fetch_add(&server->bad_requests, 1);
+                dc_ixs_conn_reject(server, conn, 431, "headers too large", 0, NULL);
+            }
+            return;
+        }
+        size_t head_len = (size_t)(head_end - conn->in);
+        dc_ixs_request_t req;
+        if (!dc_ixs_parse_head(conn->in, head_end, &req)) {
+            atomic_fetch_add(&server->bad_requests, 1);
+            dc_ixs_conn_reject(server, conn, 400, "malformed request", 0, NULL);
+            return;
+        }
+        if (req.chunked) {
+            atomic_fetch_add(&server->bad_requests, 1);
+            dc_ixs_conn_reject(server, conn, 411, "content-length required", 0, NULL);
+            return;
+        }
+        if (req.content_length > server->config.max_body_bytes) {
+            atomic_fetch_add(&server->bad_requests, 1);
+            dc_ixs_conn_reject(server, conn, 413, "body too large", 0, NULL);
+            return;
+        }
+        if (conn->in_len - head_len < req.content_length) {
+            if (req.expect_continue && !conn->sent_continue) {
+                static const char cont[] = "HTTP/1.1 100 Continue\r\n\r\n";
+                conn->sent_continue = 1;
+                if (!dc_ixs_conn_queue_output(conn, cont, sizeof(cont) - 1u) ||
+                    dc_ixs_conn_flush(conn) < 0) {
+                    dc_ixs_conn_close(server, conn);
+                    return;
+                }
+                dc_ixs_conn_set_events(server, conn);
+            }
+            return;
+        }
+        dc_ixs_conn_handle(server, conn, &req, head_len);
+    }
+}
+
+static void dc_ixs_conn_read(dc_interactions_server_t* server, dc_ixs_conn_t* conn) {
+    size_t limit = DC_IXS_MAX_HEADER_BYTES + server->config.max_body_bytes + DC_IXS_READ_CHUNK;
+    for (;;) {
+        if (conn->in_cap - conn->in_len < DC_IXS_READ_CHUNK) {
+            if (conn->in_cap >= limit) break;
+            size_t cap = conn->in_cap ? conn->in_cap * 2u : 2u * DC_IXS_READ_CHUNK;
+            if (cap > limit) cap = limit;
+            char* grown = (char*)dc_realloc(conn->in, cap);
+            if (!grown) {
+                dc_ixs_conn_close(server, conn);
+                return;
+            }
+            conn->in = grown;
+            conn->in_cap = cap;
+        }
+        ssize_t n = recv(conn->fd, conn->in + conn->in_len, conn->in_cap - conn->in_len, 0);
+        if (n > 0) {
+            conn->in_len += (size_t)n;
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && errno == EAGAIN) break;
+        dc_ixs_conn_close(server, conn);
+        return;
+    }
+    conn->last_active_ms = dc_ixs_now_ms();
+    dc_ixs_conn_process(server, conn);
+}
+
+static void dc_ixs_accept(dc_interactions_server_t* server) {
+    for (;;) {
+        int fd = accept(server->listen_fd, NULL, NULL);
+        if (fd < 0) {
+            if (errno == EINTR) continue;
+            return;
+        }
+        if (server->conn_count >= server->config.max_connections) {
+            close(fd);
+            continue;
+        }
+        int flags = fcntl(fd, F_GETFL, 0);
+        int one = 1;
+        (void)fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+        (void)setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+        dc_ixs_conn_t* conn = (dc_ixs_conn_t*)dc_calloc(1, sizeof(*conn));
+        if (!conn) {
+            close(fd);
+            continue;
+        }
+        conn->fd = fd;
+        conn->last_active_ms = dc_ixs_now_ms();
+        struct epoll_event ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN;
+        ev.data.ptr = conn;
+        if (epoll_ctl(server->epoll_fd, EPOLL_CTL_ADD, fd, &ev) != 0) {
+            close(fd);
+            dc_free(conn);
+            continue;
+        }
+        conn->next = server->conns;
+        if (server->conns) server->conns->prev = conn;
+        server->conns = conn;
+        server->conn_count++;
+        atomic_fetch_add(&server->connections, 1);
+    }
+}
+
+static void dc_ixs_drain_completions(dc_interactions_server_t* server) {
+    uint64_t counter = 0;
+    ssize_t rd = read(server->event_fd, &counter, sizeof(counter));
+    (void)rd;
+
+    (void)dc_platform_mutex_lock(&server->lock);
+    dc_ixs_job_t* job = server->done_head;
+    server->done_head = NULL;
+    server->done_tail = NULL;
+    dc_platform_mutex_unlock(&server->lock);
+
+    while (job) {
+        dc_ixs_job_t* next = job->next;
+        dc_ixs_conn_t* conn = job->conn;
+        conn->in_flight = 0;
+        if (conn->fd < 0) {
+            dc_ixs_conn_destroy(conn);
+        } else {
+            conn->last_active_ms = dc_ixs_now_ms();
+            dc_ixs_conn_respond(server, conn, dc_string_cstr(&job->response),
+                                dc_string_length(&job->response), job->keep_alive);
+            dc_ixs_conn_process(server, conn);
+        }
+        dc_ixs_job_free(job);
+        job = next;
+    }
+}
+
+static void dc_ixs_sweep_idle(dc_interactions_server_t* server, uint64_t now) {
+    dc_ixs_conn_t* conn = server->conns;
+    while (conn) {
+        dc_ixs_conn_t* next = conn->next;
+        if (!conn->in_flight && now - conn->last_active_ms >= server->config.idle_timeout_ms) {
+            dc_ixs_conn_close(server, conn);
+        }
+        conn = next;
+    }
+}
+
+static void dc_ixs_io_main(void* arg) {
+    dc_interactions_server_t* server = (dc_interactions_server_t*)arg;
+    struct epoll_event events[DC_IXS_MAX_EVENTS];
+    uint64_t last_sweep = dc_ixs_now_ms();
+
+    while (!atomic_load(&server->stopping)) {
+        int n = epoll_wait(server->epoll_fd, events, DC_IXS_MAX_EVENTS, (int)DC_IXS_SWEEP_INTERVAL_MS);
+        if (n < 0 && errno != EINTR) break;
+        for (int i = 0; i < n; i++) {
+            void* tag = events[i].data.ptr;
+            if (tag == &server->listen_fd) {
+                dc_ixs_accept(server);
+            } else if (tag == &server->event_fd) {
+                dc_ixs_drain_completions(server);
+            } else {
+                dc_ixs_conn_t* conn = (dc_ixs_conn_t*)tag;
+                if (conn->fd < 0) continue;
+                if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+                    if (conn->in_flight) {
+                        dc_ixs_conn_close(server, conn);
+                        continue;
+                    }
+                }
+                if (events[i].events & EPOLLOUT) {
+                    int flushed = dc_ixs_conn_flush(conn);
+                    if (flushed < 0 || (flushed > 0 && !conn->keep_alive)) {
+                        dc_ixs_conn_close(server, conn);
+                        continue;
+                    }
+                    if (flushed > 0) {
+                        dc_ixs_conn_set_events(server, conn);
+                        dc_ixs_conn_process(server, conn);
+                    }
+                }
+                if (conn->fd >= 0 && (events[i].events & (EPOLLIN | EPOLLERR | EPOLLHUP))) {
+                    dc_ixs_conn_read(server, conn);
+                }
+            }
+        }
+        dc_ixs_bury(server);
+
+        uint64_t now = dc_ixs_now_ms();
+        if (now - last_sweep >= DC_IXS_SWEEP_INTERVAL_MS) {
+            last_sweep = now;
+            dc_ixs_sweep_idle(server, now);
+            dc_ixs_bury(server);
+        }
+    }
+}
+
+/* ---------------------------------------------------------------------------
+ * Lifecycle
+ * ------------------------------------------------------------------------- */
+
+static dc_status_t dc_ixs_listen(dc_interactions_server_t* server) {
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(server->config.port);
+    if (inet_pton(AF_INET, server->host, &addr.sin_addr) != 1) return DC_ERROR_INVALID_PARAM;
+
+    server->listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (server->listen_fd < 0) return DC_ERROR_NETWORK;
+    int one = 1;
+    (void)setsockopt(server->listen_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    int flags = fcntl(server->listen_fd, F_GETFL, 0);
+    if (flags < 0 || fcntl(server->listen_fd, F_SETFL, flags | O_NONBLOCK) != 0) return DC_ERROR_NETWORK;
+    if (bind(server->listen_fd, (const struct sockaddr*)&addr, sizeof(addr)) != 0) return DC_ERROR_NETWORK;
+    if (listen(server->listen_fd, SOMAXCONN) != 0) return DC_ERROR_NETWORK;
+
+    socklen_t len = sizeof(addr);
+    if (getsockname(server->listen_fd, (struct sockaddr*)&addr, &len) != 0) return DC_ERROR_NETWORK;
+    server->port = ntohs(addr.sin_port);
+
+    server->epoll_fd = epoll_create1(0);
+    server->event_fd = eventfd(0, EFD_NONBLOCK);
+    if (server->epoll_fd < 0 || server->event_fd < 0) return DC_ERROR_NETWORK;
+
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.ptr = &server->listen_fd;
+    if (epoll_ctl(server->epoll_fd, EPOLL_CTL_ADD, server->listen_fd, &ev) != 0) return DC_ERROR_NETWORK;
+    ev.data.ptr = &server->event_fd;
+    if (epoll_ctl(server->epoll_fd, EPOLL_CTL_ADD, server->event_fd, &ev) != 0) return DC_ERROR_NETWORK;
+    return DC_OK;
+}
+
+dc_status_t dc_interactions_server_create(const dc_interactions_server_config_t* config,
+                                          dc_interactions_server_t** out) {
+    if (!config || !out) return DC_ERROR_NULL_POINTER;
+    *out = NULL;
+    if (!config->public_key_hex || !config->handler || !config->host || !config->path) {
+        return DC_ERROR_NULL_POINTER;
+    }
+    if (config->path[0] != '/' || config->worker_count == 0 || config->queue_capacity == 0 ||
+        config->max_connections == 0 || config->max_body_bytes == 0) {
+        return DC_ERROR_INVALID_PARAM;
+    }
+
+    dc_interactions_server_t* server = (dc_interactions_server_t*)dc_calloc(1, sizeof(*server));
+    if (!server) return DC_ERROR_OUT_OF_MEMORY;
+    if (!dc_platform_mutex_init(&server->lock)) {
+        dc_free(server);
+        return DC_ERROR_UNKNOWN;
+    }
+    if (!dc_platform_cond_init(&server->cond)) {
+        dc_platform_mutex_destroy(&server->lock);
+        dc_free(server);
+        return DC_ERROR_UNKNOWN;
+    }
+    server->config = *config;
+    server->config.public_key_hex = NULL;
+    server->listen_fd = -1;
+    server->epoll_fd = -1;
+    server->event_fd = -1;
+    atomic_init(&server->stopping, 0);
+
+    dc_status_t st = dc_ed25519_decode_hex(config->public_key_hex, server->public_key,
+                                           sizeof(server->public_key));
+    if (st != DC_OK) {
+        dc_interactions_server_free(server);
+        return st;
+    }
+
+    server->host = dc_strdup(config->host);
+    server->path = dc_strdup(config->path);
+    server->queue = (dc_ixs_job_t**)dc_calloc(config->queue_capacity, sizeof(*server->queue));
+    server->workers = (dc_platform_thread_t*)dc_calloc(config->worker_count, sizeof(*server->workers));
+    if (!server->host || !server->path || !server->queue || !server->workers) {
+        dc_interactions_server_free(server);
+        return DC_ERROR_OUT_OF_MEMORY;
+    }
+    server->config.host = server->host;
+    server->config.path = server->path;
+
+    st = dc_ixs_listen(server);
+    if (st != DC_OK) {
+        dc_interactions_server_free(server);
+        return st;
+    }
+    *out = server;
+    return DC_OK;
+}
+
+dc_status_t dc_interactions_server_start(dc_interactions_server_t* server) {
+    if (!server) return DC_ERROR_NULL_POINTER;
+    if (server->running) return DC_ERROR_INVALID_STATE;
+    atomic_store(&server->stopping, 0);
+    server->workers_stop = 0;
+    server->workers_started = 0;
+    for (uint32_t i = 0; i < server->config.worker_count; i++) {
+        if (!dc_platform_thread_create(&server->workers[i], dc_ixs_worker_main, server)) break;
+        server->workers_started++;
+    }
+    if (server->workers_started == 0 ||
+        !dc_platform_thread_create(&server->io_thread, dc_ixs_io_main, server)) {
+        (void)dc_platform_mutex_lock(&server->lock);
+        server->workers_stop = 1;
+        dc_platform_cond_broadcast(&server->cond);
+        dc_platform_mutex_unlock(&server->lock);
+        for (uint32_t i = 0; i < server->workers_started; i++) (void)dc_platform_thread_join(server->workers[i]);
+        server->workers_started = 0;
+        return DC_ERROR_UNKNOWN;
+    }
+    server->running = 1;
+    return DC_OK;
+}
+
+uint16_t dc_interactions_server_port(const dc_interactions_server_t* server) {
+    return server ? server->port : 0;
+}
+
+dc_status_t dc_interactions_server_stop(dc_interactions_server_t* server) {
+    if (!server) return DC_ERROR_NULL_POINTER;
+    if (!server->running) return DC_OK;
+
+    atomic_store(&server->stopping, 1);
+    uint64_t one = 1;
+    ssize_t wr = write(server->event_fd, &one, sizeof(one));
+    (void)wr;
+    (void)dc_platform_thread_join(server->io_thread);
+
+    (void)dc_platform_mutex_lock(&server->lock);
+    server->workers_stop = 1;
+    dc_platform_cond_broadcast(&server->cond);
+    dc_platform_mutex_unlock(&server->lock);
+    for (uint32_t i = 0; i < server->workers_started; i++) (void)dc_platform_thread_join(server->workers[i]);
+    server->workers_started = 0;
+
+    /* Threads are gone: drop queued and completed jobs, then every connection. */
+    while (server->queue_count > 0) {
+        dc_ixs_job_t* job = server->queue[server->queue_head];
+        job->conn->in_flight = 0;
+        if (job->conn->fd < 0) dc_ixs_conn_destroy(job->conn);
+        dc_ixs_job_free(job);
+        server->queue_head = (server->queue_head + 1u) % server->config.queue_capacity;
+        server->queue_count--;
+    }
+    server->queue_head = 0;
+    while (server->done_head) {
+        dc_ixs_job_t* job = server->done_head;
+        server->done_head = job->next;
+        job->conn->in_flight = 0;
+        if (job->conn->fd < 0) dc_ixs_conn_destroy(job->conn);
+        dc_ixs_job_free(job);
+    }
+    server->done_tail = NULL;
+    while (server->conns) {
+        dc_ixs_conn_t* conn = server->conns;
+        conn->in_flight = 0;
+        dc_ixs_conn_close(server, conn);
+    }
+    dc_ixs_bury(server);
+    server->running = 0;
+    return DC_OK;
+}
+
+void dc_interactions_server_free(dc_interactions_server_t* server) {
+    if (!server) return;
+    if (server->running) {
+        (void)dc_interactions_server_stop(server);
+    }
+    if (server->listen_fd >= 0) close(server->listen_fd);
+    if (server->epoll_fd >= 0) close(server->epoll_fd);
+    if (server->event_fd >= 0) close(server->event_fd);
+    dc_platform_cond_destroy(&server->cond);
+    dc_platform_mutex_destroy(&server->lock);
+    dc_free(server->host);
+    dc_free(server->path);
+    dc_free(server->queue);
+    dc_free(server->workers);
+    dc_free(server);
+}
+
+dc_status_t dc_interactions_server_get_stats(const dc_interactions_server_t* server,
+                                             dc_interactions_server_stats_t* out) {
+    if (!server || !out) return DC_ERROR_NULL_POINTER;
+    out->connections = atomic_load(&server->connections);
+    out->requests = atomic_load(&server->requests);
+    out->pings = atomic_load(&server->pings);
+    out->dispatched = atomic_load(&server->dispatched);
+    out->signature_failures = atomic_load(&server->signature_failures);
+    out->rejected_busy = atomic_load(&server->rejected_busy);
+    out->bad_requests = atomic_load(&server->bad_requests);
+    out->handler_errors = atomic_load(&server->handler_errors);
+    return DC_OK;
+}
+
+#else /* !__linux__ */
+
+dc_status_t dc_interactions_server_create(const dc_interactions_server_config_t* config,
+                                          dc_interactions_server_t** out) {
+    if (!config || !out) return DC_ERROR_NULL_POINTER;
+    *out = NULL;
+    return DC_ERROR_NOT_IMPLEMENTED;
+}
+
+dc_status_t dc_interactions_server_start(dc_interactions_server_t* server) {
+    return server ? DC_ERROR_NOT_IMPLEMENTED : DC_ERROR_NULL_POINTER;
+}
+
+uint16_t dc_interactions_server_port(const dc_interactions_server_t* server) {
+    (void)server;
+    return 0;
+}
+
+dc_status_t dc_interactions_server_stop(dc_interactions_server_t* server) {
+    return server ? DC_ERROR_NOT_IMPLEMENTED : DC_ERROR_NULL_POINTER;
+}
+
+void dc_interactions_server_free(dc_interactions_server_t* server) {
+    (void)server;
+}
+
+dc_status_t dc_interactions_server_get_stats(const dc_interactions_server_t* server,
+                                             dc_interactions_server_stats_t* out) {
+    if (!server || !out) return DC_ERROR_NULL_POINTER;
+    return DC_ERROR_NOT_IMPLEMENTED;
+}
+
+#endif
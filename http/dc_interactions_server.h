@@ -0,0 +1,163 @@
+#ifndef DC_INTERACTIONS_SERVER_H
+#define DC_INTERACTIONS_SERVER_H
+
+/**
+ * @file dc_interactions_server.h
+ * @brief HTTP interactions endpoint (outgoing webhook delivery)
+ *
+ * Minimal HTTP/1.1 server for Discord's "Interactions Endpoint URL": one
+ * epoll I/O thread handles accept, keep-alive and buffering, and a bounded
+ * pool of worker threads verifies X-Signature-Ed25519 over
+ * X-Signature-Timestamp + body, answers PINGs and dispatches every other
+ * interaction to a handler. The handler writes the interaction response
+ * JSON straight into the HTTP response body, so no REST callback round trip
+ * is needed. Run it behind a TLS-terminating reverse proxy.
+ *
+ * Linux only; elsewhere dc_interactions_server_create() returns
+ * DC_ERROR_NOT_IMPLEMENTED.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include "core/dc_status.h"
+#include "core/dc_string.h"
+#include "model/dc_interaction.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Interaction handler, called on a worker thread
+ *
+ * Write a complete interaction response object (e.g.
+ * {"type":4,"data":{"content":"hi"}}) into @p response_json, for instance
+ * with dc_interactions_response_set(). Leaving it empty sends a deferred
+ * acknowledgement instead: type 5 for commands and modal submits, type 6 for
+ * components, and an empty choice list for autocomplete. Returning an error
+ * answers HTTP 500.
+ *
+ * Handlers may run concurrently on several workers.
+ *
+ * @param interaction Decoded interaction (owned by the server, valid for the call)
+ * @param raw_body Verified request body JSON
+ * @param response_json Response body to fill (initially empty)
+ * @param user_data User data from the config
+ * @return DC_OK on success, error code on failure
+ */
+typedef dc_status_t (*dc_interactions_handler_fn)(const dc_interaction_t* interaction,
+                                                  const char* raw_body,
+                                                  dc_string_t* response_json,
+                                                  void* user_data);
+
+/**
+ * @brief Interactions server configuration
+ */
+typedef struct {
+    const char* host;                   /**< Bind address (IPv4 literal) */
+    uint16_t port;                      /**< Bind port (0 picks an ephemeral port) */
+    const char* path;                   /**< Request path to serve */
+    const char* public_key_hex;         /**< Application public key, 64 hex characters */
+    uint32_t worker_count;              /**< Worker threads */
+    uint32_t queue_capacity;            /**< Requests waiting for a worker before 503 */
+    uint32_t max_connections;           /**< Open connections before new ones are refused */
+    size_t max_body_bytes;              /**< Larger bodies get 413 */
+    uint32_t idle_timeout_ms;           /**< Idle keep-alive connections are closed after this */
+    uint32_t max_timestamp_skew_s;      /**< Reject timestamps further than this from now (0 = off) */
+    dc_interactions_handler_fn handler; /**< Handler for non-PING interactions */
+    void* user_data;                    /**< Passed to the handler */
+} dc_interactions_server_config_t;
+
+/**
+ * @brief Server counters (monotonic since create)
+ */
+typedef struct {
+    uint64_t connections;           /**< Accepted connections */
+    uint64_t requests;              /**< Complete requests received */
+    uint64_t pings;                 /**< Verified PINGs answered */
+    uint64_t dispatched;            /**< Interactions passed to the handler */
+    uint64_t signature_failures;    /**< Requests rejected with 401 */
+    uint64_t rejected_busy;         /**< Requests rejected with 503 (queue full) */
+    uint64_t bad_requests;          /**< Other 4xx responses */
+    uint64_t handler_errors;        /**< Handler failures (500) */
+} dc_interactions_server_stats_t;
+
+/**
+ * @brief Interactions server (opaque)
+ */
+typedef struct dc_interactions_server dc_interactions_server_t;
+
+/**
+ * @brief Initialize configuration with defaults
+ *
+ * Defaults:
+ * - host: "127.0.0.1", port: 0, path: "/interactions"
+ * - worker_count: 4, queue_capacity: 256, max_connections: 1024
+ * - max_body_bytes: 1 MiB, idle_timeout_ms: 60000, max_timestamp_skew_s: 0
+ */
+void dc_interactions_server_config_init(dc_interactions_server_config_t* config);
+
+/**
+ * @brief Create a server and bind its listening socket
+ * @param config Configuration (public_key_hex and handler are required)
+ * @param out Pointer to store created server
+ * @return DC_OK on success, DC_ERROR_INVALID_FORMAT for a malformed key,
+ *         DC_ERROR_NETWORK if binding fails, DC_ERROR_NOT_IMPLEMENTED off Linux
+ */
+dc_status_t dc_interactions_server_create(const dc_interactions_server_config_t* config,
+                                          dc_interactions_server_t** out);
+
+/**
+ * @brief Start the I/O thread and workers
+ * @param server Server
+ * @return DC_OK on success, DC_ERROR_INVALID_STATE if already running
+ */
+dc_status_t dc_interactions_server_start(dc_interactions_server_t* server);
+
+/**
+ * @brief Bound port (useful with port 0)
+ * @param server Server
+ * @return Port number, 0 on NULL
+ */
+uint16_t dc_interactions_server_port(const dc_interactions_server_t* server);
+
+/**
+ * @brief Stop accepting, close connections and join all threads
+ *
+ * Requests already queued are dropped without a response.
+ *
+ * @param server Server
+ * @return DC_OK on success (also when not running)
+ */
+dc_status_t dc_interactions_server_stop(dc_interactions_server_t* server);
+
+/**
+ * @brief Stop (if running) and free a server
+ * @param server Server to free
+ */
+void dc_interactions_server_free(dc_interactions_server_t* server);
+
+/**
+ * @brief Snapshot counters
+ * @param server Server
+ * @param out Output counters
+ * @return DC_OK on success, error code on failure
+ */
+dc_status_t dc_interactions_server_get_stats(const dc_interactions_server_t* server,
+                                             dc_interactions_server_stats_t* out);
+
+/**
+ * @brief Write {"type":type,"data":data_json} into a handler response
+ * @param response_json Response body (replaced)
+ * @param type Interaction callback type (see dc_interaction_callback_type_t)
+ * @param data_json JSON object for "data" (NULL to omit)
+ * @return DC_OK on success, error code on failure
+ */
+dc_status_t dc_interactions_response_set(dc_string_t* response_json, int type,
+                                         const char* data_json);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DC_INTERACTIONS_SERVER_H */
@@ -8,44 +8,90 @@
 #include "core/dc_alloc.h"
 #include "core/dc_platform.h"
 #include "core/dc_status.h"
+#include <stdatomic.h>
+#include <stdlib.h>
 #include <string.h>
 
+/* Power of two; the bucket index is striped across this many locks. */
+#define DC_REST_BUCKET_SHARDS 16u
+
+/* Hedging: latency window, samples needed before hedging, recompute cadence. */
+#define DC_REST_HEDGE_WINDOW 256u
+#define DC_REST_HEDGE_MIN_SAMPLES 32u
+#define DC_REST_HEDGE_RECOMPUTE 16u
+
+/* Heap-allocated so index entries in any shard can point at it; guarded by its own lock. */
 typedef struct {
     dc_string_t route_key;
     dc_string_t major;
     dc_http_rate_limit_t rl;
     uint64_t reset_at_ms;
+    dc_platform_mutex_t lock;
 } dc_rest_bucket_t;
 
+/* Index entry: (route key or bucket id, major) -> bucket. Route entries own their bucket. */
+typedef struct {
+    uint64_t hash;
+    int by_id;
+    dc_string_t key;
+    dc_string_t major;
+    dc_rest_bucket_t* bucket;
+} dc_rest_bucket_ref_t;
+
 typedef struct {
+    uint64_t hash;
     dc_string_t route_key;
     dc_string_t bucket;
 } dc_rest_bucket_key_t;
 
+typedef struct {
+    dc_platform_mutex_t lock;
+    dc_vec_t refs;         /* dc_rest_bucket_ref_t */
+    dc_vec_t bucket_keys;  /* dc_rest_bucket_key_t */
+} dc_rest_bucket_shard_t;
+
+typedef struct dc_rest_hedge_call dc_rest_hedge_call_t;
+
 struct dc_rest_client {
-    dc_http_client_t* http;
+    dc_platform_mutex_t pool_lock;
+    dc_vec_t idle_http;            /* dc_http_client_t*, one per request in flight at peak */
     dc_string_t token;
     dc_http_auth_type_t auth_type;
     dc_string_t user_agent;
     uint32_t timeout_ms;
     uint32_t max_retries;
-    uint32_t global_rate_limit;
-    uint32_t global_window_ms;
     uint32_t invalid_limit;
     uint32_t invalid_window_ms;
     uint64_t epoch_offset_ms;
-    uint64_t global_window_start_ms;
-    uint32_t global_window_count;
-    uint64_t global_block_until_ms;
-    uint64_t invalid_window_start_ms;
-    uint32_t invalid_count;
-    uint64_t invalid_block_until_ms;
-    dc_vec_t buckets;      /* dc_rest_bucket_t */
-    dc_vec_t bucket_keys;  /* dc_rest_bucket_key_t */
+    uint64_t global_interval_us;   /* GCRA emission interval */
+    uint64_t global_tolerance_us;  /* GCRA burst tolerance */
+    atomic_uint_fast64_t global_tat_us;
+    atomic_uint_fast64_t global_block_until_ms;
+    atomic_uint_fast64_t invalid_window_start_ms;
+    atomic_uint_fast32_t invalid_count;
+    atomic_uint_fast64_t invalid_block_until_ms;
+    dc_rest_bucket_shard_t shards[DC_REST_BUCKET_SHARDS];
+    size_t shards_inited;
     dc_rest_transport_fn transport;
     void* transport_userdata;
-    dc_platform_mutex_t lock;
-    int lock_inited;
+    dc_rest_preflight_fn preflight;
+    void* preflight_userdata;
+    uint32_t hedge_percentile;
+    uint32_t hedge_min_delay_ms;
+    dc_platform_mutex_t hedge_lock;
+    uint32_t hedge_samples[DC_REST_HEDGE_WINDOW];
+    size_t hedge_sample_count;
+    size_t hedge_sample_next;
+    size_t hedge_since_recompute;
+    dc_rest_hedge_stats_t hedge_stats;
+    /* The rest of the hedge state is also guarded by hedge_lock. */
+    dc_vec_t hedge_pending;               /* dc_rest_hedge_call_t*, primaries not hedged yet */
+    dc_platform_cond_t hedge_wake;        /* timer: pending calls changed or stopping */
+    dc_platform_cond_t hedge_idle;        /* free: last hedge attempt finished */
+    dc_platform_thread_t hedge_timer;
+    int hedge_timer_running;
+    int hedge_stopping;
+    uint32_t hedge_workers;               /* hedge attempts still running */
 };
 
 static uint64_t dc_rest_now_ms(void) {
@@ -295,33 +341,27 @@ static dc_status_t dc_rest_build_route_key(dc_http_method_t method, const char*
     return DC_OK;
 }
 
-static dc_status_t dc_rest_bucket_init(dc_rest_bucket_t* bucket, const char* route_key,
-                                       const char* major, const char* bucket_id) {
-    if (!bucket || !route_key || !major) return DC_ERROR_NULL_POINTER;
-    dc_status_t st = dc_string_init_from_cstr(&bucket->route_key, route_key);
-    if (st != DC_OK) return st;
-    st = dc_string_init_from_cstr(&bucket->major, major);
-    if (st != DC_OK) {
-        dc_string_free(&bucket->route_key);
-        return st;
-    }
-    st = dc_http_rate_limit_init(&bucket->rl);
-    if (st != DC_OK) {
-        dc_string_free(&bucket->route_key);
-        dc_string_free(&bucket->major);
-        return st;
+static uint64_t dc_rest_hash(int kind, const char* key, const char* major) {
+    uint64_t h = 1469598103934665603ull;
+    h ^= (uint8_t)kind;
+    h *= 1099511628211ull;
+    for (const unsigned char* p = (const unsigned char*)key; *p; p++) {
+        h ^= *p;
+        h *= 1099511628211ull;
     }
-    if (bucket_id && bucket_id[0] != '\0') {
-        st = dc_string_set_cstr(&bucket->rl.bucket, bucket_id);
-        if (st != DC_OK) {
-            dc_http_rate_limit_free(&bucket->rl);
-            dc_string_free(&bucket->route_key);
-            dc_string_free(&bucket->major);
-            return st;
+    if (major) {
+        h ^= 0xffu;
+        h *= 1099511628211ull;
+        for (const unsigned char* p = (const unsigned char*)major; *p; p++) {
+            h ^= *p;
+            h *= 1099511628211ull;
         }
     }
-    bucket->reset_at_ms = 0;
-    return DC_OK;
+    return h;
+}
+
+static dc_rest_bucket_shard_t* dc_rest_shard_for(dc_rest_client_t* client, uint64_t hash) {
+    return &client->shards[(hash ^ (hash >> 32)) & (DC_REST_BUCKET_SHARDS - 1u)];
 }
 
 static void dc_rest_bucket_free(dc_rest_bucket_t* bucket) {
@@ -329,12 +369,62 @@ static void dc_rest_bucket_free(dc_rest_bucket_t* bucket) {
     dc_string_free(&bucket->route_key);
     dc_string_free(&bucket->major);
     dc_http_rate_limit_free(&bucket->rl);
-    bucket->reset_at_ms = 0;
+    dc_platform_mutex_destroy(&bucket->lock);
+    dc_free(bucket);
 }
 
-static dc_status_t dc_rest_bucket_key_init(dc_rest_bucket_key_t* key, const char* route_key,
-                                           const char* bucket_id) {
+static dc_status_t dc_rest_bucket_create(const char* route_key, const char* major,
+                                         const char* bucket_id, dc_rest_bucket_t** out) {
+    if (!route_key || !major || !out) return DC_ERROR_NULL_POINTER;
+    *out = NULL;
+    dc_rest_bucket_t* bucket = (dc_rest_bucket_t*)dc_calloc(1, sizeof(*bucket));
+    if (!bucket) return DC_ERROR_OUT_OF_MEMORY;
+    if (!dc_platform_mutex_init(&bucket->lock)) {
+        dc_free(bucket);
+        return DC_ERROR_INVALID_STATE;
+    }
+    dc_status_t st = dc_string_init_from_cstr(&bucket->route_key, route_key);
+    if (st == DC_OK) st = dc_string_init_from_cstr(&bucket->major, major);
+    if (st == DC_OK) st = dc_http_rate_limit_init(&bucket->rl);
+    if (st == DC_OK && bucket_id && bucket_id[0] != '\0') {
+        st = dc_string_set_cstr(&bucket->rl.bucket, bucket_id);
+    }
+    if (st != DC_OK) {
+        dc_rest_bucket_free(bucket);
+        return st;
+    }
+    *out = bucket;
+    return DC_OK;
+}
+
+static void dc_rest_bucket_ref_free(dc_rest_bucket_ref_t* ref) {
+    if (!ref) return;
+    dc_string_free(&ref->key);
+    dc_string_free(&ref->major);
+    if (!ref->by_id) dc_rest_bucket_free(ref->bucket);
+    ref->bucket = NULL;
+}
+
+static dc_status_t dc_rest_bucket_ref_init(dc_rest_bucket_ref_t* ref, uint64_t hash, int by_id,
+                                           const char* key, const char* major,
+                                           dc_rest_bucket_t* bucket) {
+    ref->hash = hash;
+    ref->by_id = by_id;
+    ref->bucket = bucket;
+    dc_status_t st = dc_string_init_from_cstr(&ref->key, key);
+    if (st != DC_OK) return st;
+    st = dc_string_init_from_cstr(&ref->major, major);
+    if (st != DC_OK) {
+        dc_string_free(&ref->key);
+        return st;
+    }
+    return DC_OK;
+}
+
+static dc_status_t dc_rest_bucket_key_init(dc_rest_bucket_key_t* key, uint64_t hash,
+                                           const char* route_key, const char* bucket_id) {
     if (!key || !route_key || !bucket_id) return DC_ERROR_NULL_POINTER;
+    key->hash = hash;
     dc_status_t st = dc_string_init_from_cstr(&key->route_key, route_key);
     if (st != DC_OK) return st;
     st = dc_string_init_from_cstr(&key->bucket, bucket_id);
@@ -351,65 +441,152 @@ static void dc_rest_bucket_key_free(dc_rest_bucket_key_t* key) {
     dc_string_free(&key->bucket);
 }
 
-static dc_rest_bucket_t* dc_rest_find_bucket_by_id(dc_rest_client_t* client,
-                                                   const char* bucket_id, const char* major) {
-    if (!client || !bucket_id || !major) return NULL;
-    for (size_t i = 0; i < client->buckets.length; i++) {
-        dc_rest_bucket_t* bucket = (dc_rest_bucket_t*)dc_vec_at(&client->buckets, i);
-        if (!bucket) continue;
-        if (dc_string_compare_cstr(&bucket->rl.bucket, bucket_id) == 0 &&
-            dc_string_compare_cstr(&bucket->major, major) == 0) {
-            return bucket;
+/* Caller holds shard->lock. */
+static dc_rest_bucket_t* dc_rest_shard_find_ref(dc_rest_bucket_shard_t* shard, uint64_t hash,
+                                                int by_id, const char* key, const char* major) {
+    for (size_t i = 0; i < shard->refs.length; i++) {
+        dc_rest_bucket_ref_t* ref = (dc_rest_bucket_ref_t*)dc_vec_at(&shard->refs, i);
+        if (!ref || ref->hash != hash || ref->by_id != by_id) continue;
+        if (dc_string_compare_cstr(&ref->key, key) == 0 &&
+            dc_string_compare_cstr(&ref->major, major) == 0) {
+            return ref->bucket;
         }
     }
     return NULL;
 }
 
-static dc_rest_bucket_t* dc_rest_find_bucket_by_route(dc_rest_client_t* client,
-                                                      const char* route_key, const char* major) {
-    if (!client || !route_key || !major) return NULL;
-    for (size_t i = 0; i < client->buckets.length; i++) {
-        dc_rest_bucket_t* bucket = (dc_rest_bucket_t*)dc_vec_at(&client->buckets, i);
-        if (!bucket) continue;
-        if (dc_string_compare_cstr(&bucket->route_key, route_key) == 0 &&
-            dc_string_compare_cstr(&bucket->major, major) == 0) {
-            return bucket;
+static dc_status_t dc_rest_find_bucket_by_id(dc_rest_client_t* client, const char* bucket_id,
+                                             const char* major, dc_rest_bucket_t** out) {
+    uint64_t hash = dc_rest_hash(1, bucket_id, major);
+    dc_rest_bucket_shard_t* shard = dc_rest_shard_for(client, hash);
+    if (!dc_platform_mutex_lock(&shard->lock)) return DC_ERROR_INVALID_STATE;
+    *out = dc_rest_shard_find_ref(shard, hash, 1, bucket_id, major);
+    dc_platform_mutex_unlock(&shard->lock);
+    return DC_OK;
+}
+
+/* Find the bucket keyed by route, creating it (tagged with bucket_id) if missing. */
+static dc_status_t dc_rest_get_route_bucket(dc_rest_client_t* client, const char* route_key,
+                                            const char* major, const char* bucket_id,
+                                            dc_rest_bucket_t** out, int* created) {
+    uint64_t hash = dc_rest_hash(0, route_key, major);
+    dc_rest_bucket_shard_t* shard = dc_rest_shard_for(client, hash);
+    *created = 0;
+    if (!dc_platform_mutex_lock(&shard->lock)) return DC_ERROR_INVALID_STATE;
+    dc_status_t st = DC_OK;
+    dc_rest_bucket_t* bucket = dc_rest_shard_find_ref(shard, hash, 0, route_key, major);
+    if (!bucket) {
+        dc_rest_bucket_ref_t ref;
+        st = dc_rest_bucket_create(route_key, major, bucket_id, &bucket);
+        if (st == DC_OK) {
+            st = dc_rest_bucket_ref_init(&ref, hash, 0, route_key, major, bucket);
+            if (st != DC_OK) dc_rest_bucket_free(bucket);
+        }
+        if (st == DC_OK) {
+            st = dc_vec_push(&shard->refs, &ref);
+            if (st != DC_OK) dc_rest_bucket_ref_free(&ref);
         }
+        if (st != DC_OK) bucket = NULL;
+        else *created = 1;
     }
-    return NULL;
+    dc_platform_mutex_unlock(&shard->lock);
+    *out = bucket;
+    return st;
+}
+
+/* Make bucket reachable by (bucket_id, major) unless another bucket already is. */
+static dc_status_t dc_rest_alias_bucket(dc_rest_client_t* client, const char* bucket_id,
+                                        const char* major, dc_rest_bucket_t* bucket) {
+    uint64_t hash = dc_rest_hash(1, bucket_id, major);
+    dc_rest_bucket_shard_t* shard = dc_rest_shard_for(client, hash);
+    if (!dc_platform_mutex_lock(&shard->lock)) return DC_ERROR_INVALID_STATE;
+    dc_status_t st = DC_OK;
+    if (!dc_rest_shard_find_ref(shard, hash, 1, bucket_id, major)) {
+        dc_rest_bucket_ref_t ref;
+        st = dc_rest_bucket_ref_init(&ref, hash, 1, bucket_id, major, bucket);
+        if (st == DC_OK) {
+            st = dc_vec_push(&shard->refs, &ref);
+            if (st != DC_OK) dc_rest_bucket_ref_free(&ref);
+        }
+    }
+    dc_platform_mutex_unlock(&shard->lock);
+    return st;
 }
 
-static const char* dc_rest_find_bucket_id(dc_rest_client_t* client, const char* route_key) {
-    if (!client || !route_key) return NULL;
-    for (size_t i = 0; i < client->bucket_keys.length; i++) {
-        dc_rest_bucket_key_t* key = (dc_rest_bucket_key_t*)dc_vec_at(&client->bucket_keys, i);
-        if (!key) continue;
+static dc_status_t dc_rest_find_bucket_id(dc_rest_client_t* client, const char* route_key,
+                                          dc_string_t* out_id) {
+    uint64_t hash = dc_rest_hash(2, route_key, NULL);
+    dc_rest_bucket_shard_t* shard = dc_rest_shard_for(client, hash);
+    if (!dc_platform_mutex_lock(&shard->lock)) return DC_ERROR_INVALID_STATE;
+    dc_status_t st = DC_OK;
+    for (size_t i = 0; i < shard->bucket_keys.length; i++) {
+        dc_rest_bucket_key_t* key = (dc_rest_bucket_key_t*)dc_vec_at(&shard->bucket_keys, i);
+        if (!key || key->hash != hash) continue;
         if (dc_string_compare_cstr(&key->route_key, route_key) == 0) {
-            return dc_string_cstr(&key->bucket);
+            st = dc_string_set_cstr(out_id, dc_string_cstr(&key->bucket));
+            break;
         }
     }
-    return NULL;
+    dc_platform_mutex_unlock(&shard->lock);
+    return st;
 }
 
 static dc_status_t dc_rest_store_bucket_id(dc_rest_client_t* client, const char* route_key,
                                            const char* bucket_id) {
     if (!client || !route_key || !bucket_id) return DC_ERROR_NULL_POINTER;
-    for (size_t i = 0; i < client->bucket_keys.length; i++) {
-        dc_rest_bucket_key_t* key = (dc_rest_bucket_key_t*)dc_vec_at(&client->bucket_keys, i);
-        if (!key) continue;
+    uint64_t hash = dc_rest_hash(2, route_key, NULL);
+    dc_rest_bucket_shard_t* shard = dc_rest_shard_for(client, hash);
+    if (!dc_platform_mutex_lock(&shard->lock)) return DC_ERROR_INVALID_STATE;
+    dc_status_t st = DC_OK;
+    int found = 0;
+    for (size_t i = 0; i < shard->bucket_keys.length; i++) {
+        dc_rest_bucket_key_t* key = (dc_rest_bucket_key_t*)dc_vec_at(&shard->bucket_keys, i);
+        if (!key || key->hash != hash) continue;
         if (dc_string_compare_cstr(&key->route_key, route_key) == 0) {
-            return dc_string_set_cstr(&key->bucket, bucket_id);
+            if (dc_string_compare_cstr(&key->bucket, bucket_id) != 0) {
+                st = dc_string_set_cstr(&key->bucket, bucket_id);
+            }
+            found = 1;
+            break;
+        }
+    }
+    if (!found) {
+        dc_rest_bucket_key_t new_key;
+        st = dc_rest_bucket_key_init(&new_key, hash, route_key, bucket_id);
+        if (st == DC_OK) {
+            st = dc_vec_push(&shard->bucket_keys, &new_key);
+            if (st != DC_OK) dc_rest_bucket_key_free(&new_key);
         }
     }
-    dc_rest_bucket_key_t new_key;
-    dc_status_t st = dc_rest_bucket_key_init(&new_key, route_key, bucket_id);
+    dc_platform_mutex_unlock(&shard->lock);
+    return st;
+}
+
+/*
+ * Resolve the bucket for a route: the shared bucket if the route's
+ * X-RateLimit-Bucket is known, otherwise the per-route bucket. Buckets live
+ * until the client is freed, so the pointer stays valid without a shard lock.
+ */
+static dc_status_t dc_rest_resolve_bucket(dc_rest_client_t* client, const char* route_key,
+                                          const char* major, dc_rest_bucket_t** out) {
+    *out = NULL;
+    dc_string_t bucket_id;
+    dc_status_t st = dc_string_init(&bucket_id);
     if (st != DC_OK) return st;
-    st = dc_vec_push(&client->bucket_keys, &new_key);
-    if (st != DC_OK) {
-        dc_rest_bucket_key_free(&new_key);
-        return st;
+    st = dc_rest_find_bucket_id(client, route_key, &bucket_id);
+    if (st == DC_OK && !dc_string_is_empty(&bucket_id)) {
+        st = dc_rest_find_bucket_by_id(client, dc_string_cstr(&bucket_id), major, out);
     }
-    return DC_OK;
+    if (st == DC_OK && !*out) {
+        int created = 0;
+        st = dc_rest_get_route_bucket(client, route_key, major, dc_string_cstr(&bucket_id),
+                                      out, &created);
+        if (st == DC_OK && created && !dc_string_is_empty(&bucket_id)) {
+            st = dc_rest_alias_bucket(client, dc_string_cstr(&bucket_id), major, *out);
+        }
+    }
+    dc_string_free(&bucket_id);
+    return st;
 }
 
 static uint64_t dc_rest_epoch_to_monotonic(dc_rest_client_t* client, double epoch_seconds) {
@@ -419,9 +596,10 @@ static uint64_t dc_rest_epoch_to_monotonic(dc_rest_client_t* client, double epoc
     return epoch_ms - (uint64_t)client->epoch_offset_ms;
 }
 
-static void dc_rest_update_bucket(dc_rest_client_t* client, dc_rest_bucket_t* bucket,
-                                  const dc_http_rate_limit_t* rl, uint64_t now_ms) {
-    if (!client || !bucket || !rl) return;
+static dc_status_t dc_rest_update_bucket(dc_rest_client_t* client, dc_rest_bucket_t* bucket,
+                                         const dc_http_rate_limit_t* rl, uint64_t now_ms) {
+    if (!client || !bucket || !rl) return DC_ERROR_NULL_POINTER;
+    if (!dc_platform_mutex_lock(&bucket->lock)) return DC_ERROR_INVALID_STATE;
     bucket->rl.limit = rl->limit;
     bucket->rl.remaining = rl->remaining;
     bucket->rl.reset = rl->reset;
@@ -437,6 +615,60 @@ static void dc_rest_update_bucket(dc_rest_client_t* client, dc_rest_bucket_t* bu
     } else if (rl->reset > 0.0) {
         bucket->reset_at_ms = dc_rest_epoch_to_monotonic(client, rl->reset);
     }
+    dc_platform_mutex_unlock(&bucket->lock);
+    return DC_OK;
+}
+
+static dc_status_t dc_rest_bucket_wait_ms(dc_rest_bucket_t* bucket, uint64_t now_ms,
+                                          uint64_t* out_wait_ms) {
+    *out_wait_ms = 0;
+    if (!dc_platform_mutex_lock(&bucket->lock)) return DC_ERROR_INVALID_STATE;
+    if (bucket->rl.remaining == 0 && bucket->reset_at_ms > now_ms) {
+        *out_wait_ms = bucket->reset_at_ms - now_ms;
+    }
+    dc_platform_mutex_unlock(&bucket->lock);
+    return DC_OK;
+}
+
+static void dc_rest_shards_free(dc_rest_client_t* client) {
+    for (size_t s = 0; s < client->shards_inited; s++) {
+        dc_rest_bucket_shard_t* shard = &client->shards[s];
+        for (size_t i = 0; i < shard->refs.length; i++) {
+            dc_rest_bucket_ref_free((dc_rest_bucket_ref_t*)dc_vec_at(&shard->refs, i));
+        }
+        for (size_t i = 0; i < shard->bucket_keys.length; i++) {
+            dc_rest_bucket_key_free((dc_rest_bucket_key_t*)dc_vec_at(&shard->bucket_keys, i));
+        }
+        dc_vec_free(&shard->refs);
+        dc_vec_free(&shard->bucket_keys);
+        dc_platform_mutex_destroy(&shard->lock);
+    }
+    client->shards_inited = 0;
+}
+
+static dc_status_t dc_rest_shards_init(dc_rest_client_t* client) {
+    for (size_t s = 0; s < DC_REST_BUCKET_SHARDS; s++) {
+        dc_rest_bucket_shard_t* shard = &client->shards[s];
+        dc_status_t st = dc_vec_init(&shard->refs, sizeof(dc_rest_bucket_ref_t));
+        if (st != DC_OK) {
+            dc_rest_shards_free(client);
+            return st;
+        }
+        st = dc_vec_init(&shard->bucket_keys, sizeof(dc_rest_bucket_key_t));
+        if (st != DC_OK) {
+            dc_vec_free(&shard->refs);
+            dc_rest_shards_free(client);
+            return st;
+        }
+        if (!dc_platform_mutex_init(&shard->lock)) {
+            dc_vec_free(&shard->bucket_keys);
+            dc_vec_free(&shard->refs);
+            dc_rest_shards_free(client);
+            return DC_ERROR_INVALID_STATE;
+        }
+        client->shards_inited = s + 1;
+    }
+    return DC_OK;
 }
 
 static dc_status_t dc_rest_request_copy_headers(dc_http_request_t* http_req,
@@ -451,6 +683,78 @@ static dc_status_t dc_rest_request_copy_headers(dc_http_request_t* http_req,
     return DC_OK;
 }
 
+static void dc_rest_pool_free(dc_rest_client_t* client) {
+    for (size_t i = 0; i < client->idle_http.length; i++) {
+        dc_http_client_t** http = (dc_http_client_t**)dc_vec_at(&client->idle_http, i);
+        if (http && *http) dc_http_client_free(*http);
+    }
+    dc_vec_free(&client->idle_http);
+    dc_vec_free(&client->hedge_pending);
+    dc_platform_cond_destroy(&client->hedge_idle);
+    dc_platform_cond_destroy(&client->hedge_wake);
+    dc_platform_mutex_destroy(&client->hedge_lock);
+    dc_platform_mutex_destroy(&client->pool_lock);
+}
+
+static dc_status_t dc_rest_pool_init(dc_rest_client_t* client) {
+    dc_status_t st = dc_vec_init(&client->idle_http, sizeof(dc_http_client_t*));
+    if (st != DC_OK) return st;
+    if (!dc_platform_mutex_init(&client->pool_lock)) {
+        dc_vec_free(&client->idle_http);
+        return DC_ERROR_INVALID_STATE;
+    }
+    if (!dc_platform_mutex_init(&client->hedge_lock)) {
+        dc_platform_mutex_destroy(&client->pool_lock);
+        dc_vec_free(&client->idle_http);
+        return DC_ERROR_INVALID_STATE;
+    }
+    int wake_ok = dc_platform_cond_init(&client->hedge_wake);
+    int idle_ok = dc_platform_cond_init(&client->hedge_idle);
+    st = dc_vec_init(&client->hedge_pending, sizeof(dc_rest_hedge_call_t*));
+    if (!wake_ok || !idle_ok || st != DC_OK) {
+        if (st == DC_OK) dc_vec_free(&client->hedge_pending);
+        if (idle_ok) dc_platform_cond_destroy(&client->hedge_idle);
+        if (wake_ok) dc_platform_cond_destroy(&client->hedge_wake);
+        dc_platform_mutex_destroy(&client->hedge_lock);
+        dc_platform_mutex_destroy(&client->pool_lock);
+        dc_vec_free(&client->idle_http);
+        return (st != DC_OK) ? st : DC_ERROR_INVALID_STATE;
+    }
+    if (client->transport) return DC_OK;
+
+    /* Open the first connection now so an unusable libcurl fails creation. */
+    dc_http_client_t* http = NULL;
+    st = dc_http_client_create(&http);
+    if (st == DC_OK) {
+        st = dc_vec_push(&client->idle_http, &http);
+        if (st != DC_OK) dc_http_client_free(http);
+    }
+    if (st != DC_OK) dc_rest_pool_free(client);
+    return st;
+}
+
+/* Borrow a connection for one request; with a transport override there is none. */
+static dc_status_t dc_rest_http_acquire(dc_rest_client_t* client, dc_http_client_t** out) {
+    *out = NULL;
+    if (client->transport) return DC_OK;
+    if (!dc_platform_mutex_lock(&client->pool_lock)) return DC_ERROR_INVALID_STATE;
+    dc_status_t st = DC_OK;
+    if (client->idle_http.length > 0) st = dc_vec_pop(&client->idle_http, out);
+    dc_platform_mutex_unlock(&client->pool_lock);
+    if (st == DC_OK && !*out) st = dc_http_client_create(out);
+    return st;
+}
+
+static void dc_rest_http_release(dc_rest_client_t* client, dc_http_client_t* http) {
+    if (!http) return;
+    int kept = 0;
+    if (dc_platform_mutex_lock(&client->pool_lock)) {
+        kept = (dc_vec_push(&client->idle_http, &http) == DC_OK);
+        dc_platform_mutex_unlock(&client->pool_lock);
+    }
+    if (!kept) dc_http_client_free(http);
+}
+
 dc_status_t dc_rest_client_create(const dc_rest_client_config_t* config, dc_rest_client_t** out_client) {
     if (!config || !out_client) return DC_ERROR_NULL_POINTER;
     if (!config->token || config->token[0] == '\0') return DC_ERROR_INVALID_PARAM;
@@ -469,12 +773,20 @@ dc_status_t dc_rest_client_create(const dc_rest_client_config_t* config, dc_rest
     client->auth_type = config->auth_type;
     client->timeout_ms = config->timeout_ms;
     client->max_retries = (config->max_retries == 0) ? 1u : config->max_retries;
-    client->global_rate_limit = (config->global_rate_limit_per_sec == 0) ? 50u : config->global_rate_limit_per_sec;
-    client->global_window_ms = (config->global_window_ms == 0) ? 1000u : config->global_window_ms;
+    uint32_t global_rate_limit = (config->global_rate_limit_per_sec == 0) ? 50u : config->global_rate_limit_per_sec;
+    uint32_t global_window_ms = (config->global_window_ms == 0) ? 1000u : config->global_window_ms;
+    client->global_interval_us = ((uint64_t)global_window_ms * 1000u) / global_rate_limit;
+    if (client->global_interval_us == 0) client->global_interval_us = 1;
+    client->global_tolerance_us = client->global_interval_us * (uint64_t)(global_rate_limit - 1u);
     client->invalid_limit = (config->invalid_request_limit == 0) ? 10000u : config->invalid_request_limit;
     client->invalid_window_ms = (config->invalid_request_window_ms == 0) ? 600000u : config->invalid_request_window_ms;
     client->transport = config->transport;
     client->transport_userdata = config->transport_userdata;
+    client->preflight = config->preflight;
+    client->preflight_userdata = config->preflight_userdata;
+    client->hedge_percentile = (config->hedge_percentile == 0 || config->hedge_percentile > 99)
+                                   ? 95u : config->hedge_percentile;
+    client->hedge_min_delay_ms = (config->hedge_min_delay_ms == 0) ? 20u : config->hedge_min_delay_ms;
 
     st = dc_string_init(&client->user_agent);
     if (st != DC_OK) {
@@ -498,48 +810,23 @@ dc_status_t dc_rest_client_create(const dc_rest_client_config_t* config, dc_rest
         }
     }
 
-    st = dc_vec_init(&client->buckets, sizeof(dc_rest_bucket_t));
+    st = dc_rest_shards_init(client);
     if (st != DC_OK) {
         dc_string_free(&client->user_agent);
         dc_string_free(&client->token);
         dc_free(client);
         return st;
     }
-    st = dc_vec_init(&client->bucket_keys, sizeof(dc_rest_bucket_key_t));
+
+    st = dc_rest_pool_init(client);
     if (st != DC_OK) {
-        dc_vec_free(&client->buckets);
+        dc_rest_shards_free(client);
         dc_string_free(&client->user_agent);
         dc_string_free(&client->token);
         dc_free(client);
         return st;
     }
 
-    if (!client->transport) {
-        st = dc_http_client_create(&client->http);
-        if (st != DC_OK) {
-            dc_vec_free(&client->bucket_keys);
-            dc_vec_free(&client->buckets);
-            dc_string_free(&client->user_agent);
-            dc_string_free(&client->token);
-            dc_free(client);
-            return st;
-        }
-    }
-
-    if (!dc_platform_mutex_init(&client->lock)) {
-        if (client->http) {
-            dc_http_client_free(client->http);
-            client->http = NULL;
-        }
-        dc_vec_free(&client->bucket_keys);
-        dc_vec_free(&client->buckets);
-        dc_string_free(&client->user_agent);
-        dc_string_free(&client->token);
-        dc_free(client);
-        return DC_ERROR_INVALID_STATE;
-    }
-    client->lock_inited = 1;
-
     uint64_t mono_ms = dc_rest_now_ms();
     uint64_t epoch_ms = dc_rest_epoch_ms();
     if (epoch_ms > mono_ms) {
@@ -548,32 +835,38 @@ dc_status_t dc_rest_client_create(const dc_rest_client_config_t* config, dc_rest
         client->epoch_offset_ms = 0;
     }
 
-    client->global_window_start_ms = mono_ms;
-    client->invalid_window_start_ms = mono_ms;
+    atomic_init(&client->global_tat_us, 0);
+    atomic_init(&client->global_block_until_ms, 0);
+    atomic_init(&client->invalid_window_start_ms, mono_ms);
+    atomic_init(&client->invalid_count, 0);
+    atomic_init(&client->invalid_block_until_ms, 0);
 
     *out_client = client;
     return DC_OK;
 }
 
+/* Stops the hedge timer and waits for hedge attempts still running. */
+static void dc_rest_hedge_shutdown(dc_rest_client_t* client) {
+    if (!dc_platform_mutex_lock(&client->hedge_lock)) return;
+    client->hedge_stopping = 1;
+    int timer_running = client->hedge_timer_running;
+    client->hedge_timer_running = 0;
+    dc_platform_cond_broadcast(&client->hedge_wake);
+    (void)dc_platform_mutex_unlock(&client->hedge_lock);
+    if (timer_running) (void)dc_platform_thread_join(client->hedge_timer);
+
+    (void)dc_platform_mutex_lock(&client->hedge_lock);
+    while (client->hedge_workers > 0) {
+        (void)dc_platform_cond_wait(&client->hedge_idle, &client->hedge_lock);
+    }
+    (void)dc_platform_mutex_unlock(&client->hedge_lock);
+}
+
 void dc_rest_client_free(dc_rest_client_t* client) {
     if (!client) return;
-    if (client->http) {
-        dc_http_client_free(client->http);
-    }
-    if (client->lock_inited) {
-        dc_platform_mutex_destroy(&client->lock);
-        client->lock_inited = 0;
-    }
-    for (size_t i = 0; i < client->buckets.length; i++) {
-        dc_rest_bucket_t* bucket = (dc_rest_bucket_t*)dc_vec_at(&client->buckets, i);
-        dc_rest_bucket_free(bucket);
-    }
-    for (size_t i = 0; i < client->bucket_keys.length; i++) {
-        dc_rest_bucket_key_t* key = (dc_rest_bucket_key_t*)dc_vec_at(&client->bucket_keys, i);
-        dc_rest_bucket_key_free(key);
-    }
-    dc_vec_free(&client->buckets);
-    dc_vec_free(&client->bucket_keys);
+    dc_rest_hedge_shutdown(client);
+    dc_rest_pool_free(client);
+    dc_rest_shards_free(client);
     dc_string_free(&client->user_agent);
     dc_string_free(&client->token);
     dc_free(client);
@@ -711,14 +1004,59 @@ void dc_rest_response_free(dc_rest_response_t* response) {
     memset(response, 0, sizeof(*response));
 }
 
+dc_status_t dc_rest_response_take_body(dc_rest_response_t* response, dc_string_t* out) {
+    if (!response || !out) return DC_ERROR_NULL_POINTER;
+    return dc_string_take(out, &response->http.body);
+}
+
+/* Keeps the body buffer, so retries (and a lent caller buffer) reuse its capacity. */
 static dc_status_t dc_rest_response_reset(dc_rest_response_t* response) {
     if (!response) return DC_ERROR_NULL_POINTER;
+    dc_string_t body = response->http.body;
+    response->http.body.data = NULL;
+    response->http.body.length = 0;
+    response->http.body.capacity = 0;
     dc_http_rate_limit_response_free(&response->rate_limit_response);
     dc_http_rate_limit_free(&response->rate_limit);
     dc_http_error_free(&response->error);
     dc_http_response_free(&response->http);
     dc_status_t st = dc_rest_response_init(response);
-    return st;
+    if (st != DC_OK) {
+        dc_string_free(&body);
+        return st;
+    }
+    dc_string_free(&response->http.body);
+    response->http.body = body;
+    return dc_string_clear(&response->http.body);
+}
+
+static void dc_rest_atomic_max(atomic_uint_fast64_t* target, uint64_t value) {
+    uint_fast64_t cur = atomic_load(target);
+    while (cur < value && !atomic_compare_exchange_weak(target, &cur, value)) {
+    }
+}
+
+/*
+ * GCRA: each request pushes the theoretical arrival time (TAT) forward by one
+ * emission interval; a request is admitted while TAT - now stays within the
+ * burst tolerance. Up to global_rate_limit_per_sec requests can go back to
+ * back after an idle period, and no window boundary doubles that. Returns the
+ * milliseconds to wait, 0 when a slot was taken.
+ */
+static uint64_t dc_rest_global_acquire(dc_rest_client_t* client, uint64_t now_ms) {
+    uint64_t now_us = now_ms * 1000u;
+    uint_fast64_t tat = atomic_load(&client->global_tat_us);
+    for (;;) {
+        uint64_t base = (tat > now_us) ? tat : now_us;
+        if (base - now_us > client->global_tolerance_us) {
+            uint64_t wait_us = base - now_us - client->global_tolerance_us;
+            return (wait_us + 999u) / 1000u;
+        }
+        if (atomic_compare_exchange_weak(&client->global_tat_us, &tat,
+                                         base + client->global_interval_us)) {
+            return 0;
+        }
+    }
 }
 
 static void dc_rest_update_global_limit(dc_rest_client_t* client, const dc_http_rate_limit_t* rl,
@@ -729,30 +1067,42 @@ static void dc_rest_update_global_limit(dc_rest_client_t* client, const dc_http_
     if (body_rl && body_rl->retry_after > 0.0) retry_after = body_rl->retry_after;
     if (retry_after <= 0.0) return;
     uint64_t wait_ms = (uint64_t)(retry_after * 1000.0);
-    client->global_block_until_ms = now_ms + wait_ms;
+    dc_rest_atomic_max(&client->global_block_until_ms, now_ms + wait_ms);
 }
 
+/* Fixed window like Discord's own counter; racing resets may drop a few counts. */
 static void dc_rest_handle_invalid_request(dc_rest_client_t* client, uint64_t now_ms) {
     if (!client) return;
-    if (now_ms - client->invalid_window_start_ms >= (uint64_t)client->invalid_window_ms) {
-        client->invalid_window_start_ms = now_ms;
-        client->invalid_count = 0;
+    uint_fast64_t start = atomic_load(&client->invalid_window_start_ms);
+    if (now_ms > start && now_ms - start >= (uint64_t)client->invalid_window_ms) {
+        if (atomic_compare_exchange_strong(&client->invalid_window_start_ms, &start, now_ms)) {
+            atomic_store(&client->invalid_count, 0);
+            start = now_ms;
+        }
     }
-    client->invalid_count++;
-    if (client->invalid_count >= client->invalid_limit) {
-        client->invalid_block_until_ms = client->invalid_window_start_ms + client->invalid_window_ms;
+    uint_fast32_t count = atomic_fetch_add(&client->invalid_count, 1) + 1u;
+    if (count >= client->invalid_limit) {
+        dc_rest_atomic_max(&client->invalid_block_until_ms, start + client->invalid_window_ms);
     }
 }
 
-dc_status_t dc_rest_execute(dc_rest_client_t* client, const dc_rest_request_t* request,
-                            dc_rest_response_t* response) {
-    if (!client || !request || !response) return DC_ERROR_NULL_POINTER;
-    if (dc_string_is_empty(&request->path)) return DC_ERROR_INVALID_PARAM;
+static dc_status_t dc_rest_preflight(dc_rest_client_t* client, const dc_rest_request_t* request) {
+    if (!client->preflight) return DC_OK;
+    return client->preflight(client->preflight_userdata, request->method, dc_string_cstr(&request->path));
+}
+
+/*
+ * Sends without the preflight; hedge attempts come here after the caller ran
+ * it once. A fired cancel abandons the attempt with DC_ERROR_NETWORK.
+ */
+static dc_status_t dc_rest_execute_send(dc_rest_client_t* client, const dc_rest_request_t* request,
+                                        dc_rest_response_t* response, dc_http_cancel_t* cancel) {
 
     uint32_t attempts = 0;
     dc_status_t st = DC_OK;
 
     while (attempts <= client->max_retries) {
+        if (dc_http_cancel_fired(cancel)) return DC_ERROR_NETWORK;
         attempts++;
         int retry_request = 0;
 
@@ -761,13 +1111,11 @@ dc_status_t dc_rest_execute(dc_rest_client_t* client, const dc_rest_request_t* r
         dc_string_t major;
         dc_http_request_t http_req;
         dc_http_rate_limit_t parsed_rl;
-        dc_http_rate_limit_response_t parsed_body_rl;
         int path_inited = 0;
         int route_key_inited = 0;
         int major_inited = 0;
         int http_req_inited = 0;
         int parsed_rl_inited = 0;
-        int parsed_body_rl_inited = 0;
         uint64_t now_ms = dc_rest_now_ms();
 
         st = dc_string_init(&path);
@@ -793,67 +1141,30 @@ dc_status_t dc_rest_execute(dc_rest_client_t* client, const dc_rest_request_t* r
 
         for (;;) {
             uint64_t sleep_ms = 0;
-            const char* mapped_bucket_id = NULL;
             dc_rest_bucket_t* bucket = NULL;
 
-            if (client->lock_inited && !dc_platform_mutex_lock(&client->lock)) {
-                st = DC_ERROR_INVALID_STATE;
-                goto cleanup_iteration;
-            }
-
             now_ms = dc_rest_now_ms();
-            if (client->invalid_block_until_ms > now_ms) {
-                if (client->lock_inited) dc_platform_mutex_unlock(&client->lock);
+            if (atomic_load(&client->invalid_block_until_ms) > now_ms) {
                 st = DC_ERROR_INVALID_STATE;
                 goto cleanup_iteration;
             }
 
             if (!is_interaction) {
-                if (client->global_block_until_ms > now_ms) {
-                    sleep_ms = client->global_block_until_ms - now_ms;
-                } else {
-                    if (now_ms - client->global_window_start_ms >= client->global_window_ms) {
-                        client->global_window_start_ms = now_ms;
-                        client->global_window_count = 0;
-                    }
-                    if (client->global_window_count >= client->global_rate_limit) {
-                        sleep_ms = client->global_window_ms - (now_ms - client->global_window_start_ms);
-                    }
-                }
+                uint64_t block_until_ms = atomic_load(&client->global_block_until_ms);
+                if (block_until_ms > now_ms) sleep_ms = block_until_ms - now_ms;
             }
 
             if (sleep_ms == 0) {
-                mapped_bucket_id = dc_rest_find_bucket_id(client, dc_string_cstr(&route_key));
-                if (mapped_bucket_id && mapped_bucket_id[0] != '\0') {
-                    bucket = dc_rest_find_bucket_by_id(client, mapped_bucket_id, dc_string_cstr(&major));
-                }
-                if (!bucket) {
-                    bucket = dc_rest_find_bucket_by_route(client, dc_string_cstr(&route_key), dc_string_cstr(&major));
-                }
-                if (!bucket) {
-                    dc_rest_bucket_t new_bucket;
-                    st = dc_rest_bucket_init(&new_bucket, dc_string_cstr(&route_key),
-                                             dc_string_cstr(&major),
-                                             mapped_bucket_id ? mapped_bucket_id : "");
-                    if (st != DC_OK) {
-                        if (client->lock_inited) dc_platform_mutex_unlock(&client->lock);
-                        goto cleanup_iteration;
-                    }
-                    st = dc_vec_push(&client->buckets, &new_bucket);
-                    if (st != DC_OK) {
-                        dc_rest_bucket_free(&new_bucket);
-                        if (client->lock_inited) dc_platform_mutex_unlock(&client->lock);
-                        goto cleanup_iteration;
-                    }
-                    bucket = (dc_rest_bucket_t*)dc_vec_at(&client->buckets, client->buckets.length - 1);
-                }
-
-                if (bucket && bucket->rl.remaining == 0 && bucket->reset_at_ms > now_ms) {
-                    sleep_ms = bucket->reset_at_ms - now_ms;
-                }
+                st = dc_rest_resolve_bucket(client, dc_string_cstr(&route_key),
+                                            dc_string_cstr(&major), &bucket);
+                if (st != DC_OK) goto cleanup_iteration;
+                st = dc_rest_bucket_wait_ms(bucket, now_ms, &sleep_ms);
+                if (st != DC_OK) goto cleanup_iteration;
             }
 
-            if (client->lock_inited) dc_platform_mutex_unlock(&client->lock);
+            if (sleep_ms == 0 && !is_interaction) {
+                sleep_ms = dc_rest_global_acquire(client, now_ms);
+            }
 
             if (sleep_ms == 0) break;
             dc_rest_sleep_ms(sleep_ms);
@@ -862,6 +1173,7 @@ dc_status_t dc_rest_execute(dc_rest_client_t* client, const dc_rest_request_t* r
         st = dc_http_request_init(&http_req);
         if (st != DC_OK) goto cleanup_iteration;
         http_req_inited = 1;
+        http_req.cancel = cancel;
         st = dc_http_request_set_method(&http_req, request->method);
         if (st != DC_OK) goto cleanup_iteration;
         st = dc_http_request_set_url(&http_req, dc_string_cstr(&request->path));
@@ -914,7 +1226,12 @@ dc_status_t dc_rest_execute(dc_rest_client_t* client, const dc_rest_request_t* r
         if (st != DC_OK) goto cleanup_iteration;
 
         if (!client->transport) {
-            st = dc_http_client_execute(client->http, &http_req, &response->http);
+            dc_http_client_t* http = NULL;
+            st = dc_rest_http_acquire(client, &http);
+            if (st == DC_OK) {
+                st = dc_http_client_execute(http, &http_req, &response->http);
+                dc_rest_http_release(client, http);
+            }
         } else {
             st = client->transport(client->transport_userdata, &http_req, &response->http);
         }
@@ -924,16 +1241,13 @@ dc_status_t dc_rest_execute(dc_rest_client_t* client, const dc_rest_request_t* r
         if (st != DC_OK) goto cleanup_iteration;
         parsed_rl_inited = 1;
         dc_http_response_parse_rate_limit(&response->http, &parsed_rl);
-        st = dc_http_rate_limit_response_init(&parsed_body_rl);
-        if (st != DC_OK) {
-            goto cleanup_iteration;
-        }
-        parsed_body_rl_inited = 1;
 
-        if (response->http.status_code == 429) {
-            dc_http_rate_limit_response_parse(dc_string_cstr(&response->http.body),
-                                              dc_string_length(&response->http.body),
-                                              &parsed_body_rl);
+        /* One parse fills the error and, for 429s, the retry fields */
+        if (response->http.status_code >= 400) {
+            dc_http_error_decode(dc_string_cstr(&response->http.body),
+                                 dc_string_length(&response->http.body),
+                                 &response->error,
+                                 response->http.status_code == 429 ? &response->rate_limit_response : NULL);
         }
 
         response->rate_limit.limit = parsed_rl.limit;
@@ -945,64 +1259,20 @@ dc_status_t dc_rest_execute(dc_rest_client_t* client, const dc_rest_request_t* r
         response->rate_limit.scope = parsed_rl.scope;
         dc_string_set_cstr(&response->rate_limit.bucket, dc_string_cstr(&parsed_rl.bucket));
 
-        response->rate_limit_response.retry_after = parsed_body_rl.retry_after;
-        response->rate_limit_response.global = parsed_body_rl.global;
-        response->rate_limit_response.code = parsed_body_rl.code;
-        dc_string_set_cstr(&response->rate_limit_response.message,
-                           dc_string_cstr(&parsed_body_rl.message));
-
-        if (response->http.status_code >= 400) {
-            dc_http_error_parse(dc_string_cstr(&response->http.body),
-                                dc_string_length(&response->http.body),
-                                &response->error);
-        }
-
-        if (client->lock_inited && !dc_platform_mutex_lock(&client->lock)) {
-            st = DC_ERROR_INVALID_STATE;
-            goto cleanup_iteration;
-        }
-
         now_ms = dc_rest_now_ms();
-        if (!is_interaction) {
-            if (now_ms - client->global_window_start_ms >= client->global_window_ms) {
-                client->global_window_start_ms = now_ms;
-                client->global_window_count = 0;
-            }
-            client->global_window_count++;
-        }
-
-        const char* mapped_bucket_id = dc_rest_find_bucket_id(client, dc_string_cstr(&route_key));
         dc_rest_bucket_t* bucket = NULL;
-        if (mapped_bucket_id && mapped_bucket_id[0] != '\0') {
-            bucket = dc_rest_find_bucket_by_id(client, mapped_bucket_id, dc_string_cstr(&major));
-        }
-        if (!bucket) {
-            bucket = dc_rest_find_bucket_by_route(client, dc_string_cstr(&route_key), dc_string_cstr(&major));
-        }
-        if (!bucket) {
-            dc_rest_bucket_t new_bucket;
-            st = dc_rest_bucket_init(&new_bucket, dc_string_cstr(&route_key),
-                                     dc_string_cstr(&major),
-                                     mapped_bucket_id ? mapped_bucket_id : "");
-            if (st != DC_OK) {
-                if (client->lock_inited) dc_platform_mutex_unlock(&client->lock);
-                goto cleanup_iteration;
-            }
-            st = dc_vec_push(&client->buckets, &new_bucket);
-            if (st != DC_OK) {
-                dc_rest_bucket_free(&new_bucket);
-                if (client->lock_inited) dc_platform_mutex_unlock(&client->lock);
-                goto cleanup_iteration;
-            }
-            bucket = (dc_rest_bucket_t*)dc_vec_at(&client->buckets, client->buckets.length - 1);
-        }
-
-        if (bucket) {
-            dc_rest_update_bucket(client, bucket, &parsed_rl, now_ms);
-            if (!dc_string_is_empty(&parsed_rl.bucket)) {
-                dc_rest_store_bucket_id(client, dc_string_cstr(&route_key),
-                                        dc_string_cstr(&parsed_rl.bucket));
+        st = dc_rest_resolve_bucket(client, dc_string_cstr(&route_key), dc_string_cstr(&major), &bucket);
+        if (st != DC_OK) goto cleanup_iteration;
+        st = dc_rest_update_bucket(client, bucket, &parsed_rl, now_ms);
+        if (st != DC_OK) goto cleanup_iteration;
+        if (!dc_string_is_empty(&parsed_rl.bucket)) {
+            st = dc_rest_store_bucket_id(client, dc_string_cstr(&route_key),
+                                         dc_string_cstr(&parsed_rl.bucket));
+            if (st == DC_OK) {
+                st = dc_rest_alias_bucket(client, dc_string_cstr(&parsed_rl.bucket),
+                                          dc_string_cstr(&major), bucket);
             }
+            if (st != DC_OK) goto cleanup_iteration;
         }
 
         if (response->http.status_code == 401 ||
@@ -1012,15 +1282,13 @@ dc_status_t dc_rest_execute(dc_rest_client_t* client, const dc_rest_request_t* r
         }
 
         if (response->http.status_code == 429 &&
-            (parsed_rl.global || parsed_body_rl.global)) {
-            dc_rest_update_global_limit(client, &parsed_rl, &parsed_body_rl, now_ms);
+            (parsed_rl.global || response->rate_limit_response.global)) {
+            dc_rest_update_global_limit(client, &parsed_rl, &response->rate_limit_response, now_ms);
         }
 
-        if (client->lock_inited) dc_platform_mutex_unlock(&client->lock);
-
         if (response->http.status_code == 429) {
-            double retry_after = parsed_rl.retry_after > 0.0 ? parsed_rl.retry_after : parsed_body_rl.retry_after;
-            if (retry_after > 0.0 && attempts <= client->max_retries) {
+            double retry_after = parsed_rl.retry_after > 0.0 ? parsed_rl.retry_after : response->rate_limit_response.retry_after;
+            if (retry_after > 0.0 && attempts <= client->max_retries && !dc_http_cancel_fired(cancel)) {
                 dc_rest_sleep_ms((uint64_t)(retry_after * 1000.0));
                 retry_request = 1;
                 st = DC_OK;
@@ -1032,9 +1300,6 @@ dc_status_t dc_rest_execute(dc_rest_client_t* client, const dc_rest_request_t* r
         goto cleanup_iteration;
 
         cleanup_iteration:
-        if (parsed_body_rl_inited) {
-            dc_http_rate_limit_response_free(&parsed_body_rl);
-        }
         if (parsed_rl_inited) {
             dc_http_rate_limit_free(&parsed_rl);
         }
@@ -1058,3 +1323,410 @@ dc_status_t dc_rest_execute(dc_rest_client_t* client, const dc_rest_request_t* r
 
     return DC_ERROR_TRY_AGAIN;
 }
+
+dc_status_t dc_rest_get_route_budget(dc_rest_client_t* client, dc_http_method_t method,
+                                     const char* path, dc_rest_route_budget_t* out) {
+    if (!client || !path || !out) return DC_ERROR_NULL_POINTER;
+    memset(out, 0, sizeof(*out));
+
+    dc_string_t route_path;
+    dc_string_t route_key;
+    dc_string_t major;
+    dc_status_t st = dc_string_init(&route_path);
+    if (st != DC_OK) return st;
+    st = dc_string_init(&route_key);
+    if (st != DC_OK) {
+        dc_string_free(&route_path);
+        return st;
+    }
+    st = dc_string_init(&major);
+    if (st != DC_OK) {
+        dc_string_free(&route_key);
+        dc_string_free(&route_path);
+        return st;
+    }
+
+    dc_rest_bucket_t* bucket = NULL;
+    st = dc_rest_extract_path(path, &route_path);
+    if (st == DC_OK) {
+        st = dc_rest_build_route_key(method, dc_string_cstr(&route_path), &route_key, &major);
+    }
+    if (st == DC_OK) {
+        st = dc_rest_resolve_bucket(client, dc_string_cstr(&route_key), dc_string_cstr(&major), &bucket);
+    }
+    if (st == DC_OK && bucket) {
+        if (dc_platform_mutex_lock(&bucket->lock)) {
+            uint64_t now_ms = dc_rest_now_ms();
+            if (bucket->rl.limit > 0) {
+                out->known = 1;
+                out->limit = (uint32_t)bucket->rl.limit;
+                if (bucket->reset_at_ms > now_ms) {
+                    out->remaining = (bucket->rl.remaining > 0) ? (uint32_t)bucket->rl.remaining : 0u;
+                    out->reset_in_ms = bucket->reset_at_ms - now_ms;
+                } else if (bucket->reset_at_ms > 0) {
+                    out->remaining = out->limit;
+                } else {
+                    out->remaining = (bucket->rl.remaining > 0) ? (uint32_t)bucket->rl.remaining : 0u;
+                }
+            }
+            dc_platform_mutex_unlock(&bucket->lock);
+        } else {
+            st = DC_ERROR_INVALID_STATE;
+        }
+    }
+
+    dc_string_free(&major);
+    dc_string_free(&route_key);
+    dc_string_free(&route_path);
+    return st;
+}
+
+dc_status_t dc_rest_execute(dc_rest_client_t* client, const dc_rest_request_t* request,
+                            dc_rest_response_t* response) {
+    if (!client || !request || !response) return DC_ERROR_NULL_POINTER;
+    if (dc_string_is_empty(&request->path)) return DC_ERROR_INVALID_PARAM;
+
+    dc_status_t st = dc_rest_preflight(client, request);
+    if (st != DC_OK) return st;
+    return dc_rest_execute_send(client, request, response, NULL);
+}
+
+/* ---- hedged execution ---- */
+
+static int dc_rest_u32_cmp(const void* a, const void* b) {
+    uint32_t x = *(const uint32_t*)a;
+    uint32_t y = *(const uint32_t*)b;
+    return (x > y) - (x < y);
+}
+
+static void dc_rest_hedge_record(dc_rest_client_t* client, uint64_t latency_ms) {
+    uint32_t sample = (latency_ms > UINT32_MAX) ? UINT32_MAX : (uint32_t)latency_ms;
+    if (!dc_platform_mutex_lock(&client->hedge_lock)) return;
+    client->hedge_samples[client->hedge_sample_next] = sample;
+    client->hedge_sample_next = (client->hedge_sample_next + 1u) % DC_REST_HEDGE_WINDOW;
+    if (client->hedge_sample_count < DC_REST_HEDGE_WINDOW) client->hedge_sample_count++;
+    client->hedge_since_recompute++;
+    if (client->hedge_sample_count >= DC_REST_HEDGE_MIN_SAMPLES &&
+        client->hedge_since_recompute >= DC_REST_HEDGE_RECOMPUTE) {
+        uint32_t sorted[DC_REST_HEDGE_WINDOW];
+        size_t n = client->hedge_sample_count;
+        memcpy(sorted, client->hedge_samples, n * sizeof(sorted[0]));
+        qsort(sorted, n, sizeof(sorted[0]), dc_rest_u32_cmp);
+        size_t idx = (n * client->hedge_percentile) / 100u;
+        if (idx >= n) idx = n - 1u;
+        uint32_t threshold = sorted[idx];
+        if (threshold < client->hedge_min_delay_ms) threshold = client->hedge_min_delay_ms;
+        client->hedge_stats.threshold_ms = threshold;
+        client->hedge_since_recompute = 0;
+    }
+    dc_platform_mutex_unlock(&client->hedge_lock);
+}
+
+dc_status_t dc_rest_get_hedge_stats(dc_rest_client_t* client, dc_rest_hedge_stats_t* out) {
+    if (!client || !out) return DC_ERROR_NULL_POINTER;
+    if (!dc_platform_mutex_lock(&client->hedge_lock)) return DC_ERROR_INVALID_STATE;
+    *out = client->hedge_stats;
+    dc_platform_mutex_unlock(&client->hedge_lock);
+    return DC_OK;
+}
+
+/*
+ * A hedge spends one more request from the route's bucket while the first is
+ * still uncounted, so it needs the last response to have left at least two.
+ * Buckets never seen, or blocked globally, are not hedged.
+ */
+static int dc_rest_hedge_has_budget(dc_rest_client_t* client, const dc_rest_request_t* request) {
+    uint64_t now_ms = dc_rest_now_ms();
+    if (atomic_load(&client->invalid_block_until_ms) > now_ms) return 0;
+    if (!request->is_interaction) {
+        if (atomic_load(&client->global_block_until_ms) > now_ms) return 0;
+        if (atomic_load(&client->global_tat_us) > now_ms * 1000u + client->global_tolerance_us) {
+            return 0;
+        }
+    }
+
+    dc_rest_route_budget_t budget;
+    if (dc_rest_get_route_budget(client, request->method, dc_string_cstr(&request->path),
+                                 &budget) != DC_OK) {
+        return 0;
+    }
+    return budget.known && budget.remaining >= 2;
+}
+
+static dc_status_t dc_rest_request_clone(const dc_rest_request_t* src, dc_rest_request_t* dst) {
+    dc_status_t st = dc_rest_request_init(dst);
+    if (st != DC_OK) return st;
+    dst->method = src->method;
+    dst->timeout_ms = src->timeout_ms;
+    dst->body_is_json = src->body_is_json;
+    dst->is_interaction = src->is_interaction;
+    st = dc_string_set_cstr(&dst->path, dc_string_cstr(&src->path));
+    if (st == DC_OK && !dc_string_is_empty(&src->body)) {
+        st = dc_string_set_buffer(&dst->body, dc_string_cstr(&src->body),
+                                  dc_string_length(&src->body));
+    }
+    for (size_t i = 0; st == DC_OK && i < src->headers.length; i++) {
+        const dc_http_header_t* h = (const dc_http_header_t*)dc_vec_at(&src->headers, i);
+        if (!h) continue;
+        st = dc_rest_headers_add_or_replace(&dst->headers, dc_string_cstr(&h->name),
+                                            dc_string_cstr(&h->value));
+    }
+    if (st != DC_OK) dc_rest_request_free(dst);
+    return st;
+}
+
+typedef struct {
+    dc_rest_response_t* response;
+    dc_http_cancel_t* cancel;
+    dc_status_t status;
+    int started;
+    int done;
+} dc_rest_hedge_attempt_t;
+
+/*
+ * Attempt 0 runs on the caller's thread into the caller's response; attempt 1
+ * is the hedge. Shared by the caller and the hedge; the last one out frees it.
+ */
+struct dc_rest_hedge_call {
+    dc_rest_client_t* client;
+    const dc_rest_request_t* source;    /* caller's request, valid while pending */
+    dc_rest_request_t request;          /* copy sent by the hedge */
+    int request_inited;
+    dc_rest_response_t hedge_response;
+    int hedge_response_taken;
+    uint64_t hedge_at_ms;
+    dc_platform_mutex_t lock;
+    dc_platform_cond_t done;
+    int refs;
+    int winner;                         /* attempt index, -1 while undecided */
+    dc_rest_hedge_attempt_t attempts[2];
+};
+
+static void dc_rest_hedge_call_free(dc_rest_hedge_call_t* call) {
+    for (size_t i = 0; i < 2; i++) {
+        dc_http_cancel_free(call->attempts[i].cancel);
+    }
+    if (!call->hedge_response_taken) dc_rest_response_free(&call->hedge_response);
+    if (call->request_inited) dc_rest_request_free(&call->request);
+    dc_platform_cond_destroy(&call->done);
+    dc_platform_mutex_destroy(&call->lock);
+    dc_free(call);
+}
+
+static dc_rest_hedge_call_t* dc_rest_hedge_call_create(dc_rest_client_t* client,
+                                                       const dc_rest_request_t* request,
+                                                       dc_rest_response_t* response) {
+    dc_rest_hedge_call_t* call = (dc_rest_hedge_call_t*)dc_calloc(1, sizeof(*call));
+    if (!call) return NULL;
+    call->client = client;
+    call->source = request;
+    call->winner = -1;
+    call->refs = 1;
+    if (!dc_platform_mutex_init(&call->lock)) {
+        dc_free(call);
+        return NULL;
+    }
+    if (!dc_platform_cond_init(&call->done)) {
+        dc_platform_mutex_destroy(&call->lock);
+        dc_free(call);
+        return NULL;
+    }
+    if (dc_rest_response_init(&call->hedge_response) != DC_OK) {
+        call->hedge_response_taken = 1;
+        dc_rest_hedge_call_free(call);
+        return NULL;
+    }
+    call->attempts[0].response = response;
+    call->attempts[1].response = &call->hedge_response;
+    for (size_t i = 0; i < 2; i++) {
+        if (dc_http_cancel_create(&call->attempts[i].cancel) != DC_OK) {
+            dc_rest_hedge_call_free(call);
+            return NULL;
+        }
+    }
+    return call;
+}
+
+/* Called with call->lock held once the attempt finished; an HTTP answer wins. */
+static void dc_rest_hedge_settle(dc_rest_hedge_call_t* call, size_t index) {
+    dc_rest_hedge_attempt_t* attempt = &call->attempts[index];
+    dc_rest_hedge_attempt_t* other = &call->attempts[1u - index];
+    if (call->winner >= 0) return;
+    if (attempt->response->http.status_code > 0) {
+        call->winner = (int)index;
+        if (other->started && !other->done) dc_http_cancel_fire(other->cancel);
+    } else if (!other->started || other->done) {
+        /* A transport failure only wins once nothing else can. */
+        call->winner = 0;
+    }
+    if (call->winner >= 0) dc_platform_cond_broadcast(&call->done);
+}
+
+static void dc_rest_hedge_worker(void* arg) {
+    dc_rest_hedge_call_t* call = (dc_rest_hedge_call_t*)arg;
+    dc_rest_client_t* client = call->client;
+    dc_rest_hedge_attempt_t* attempt = &call->attempts[1];
+
+    uint64_t start_ms = dc_rest_now_ms();
+    dc_status_t st = dc_rest_execute_send(client, &call->request, attempt->response, attempt->cancel);
+    dc_rest_hedge_record(client, dc_rest_now_ms() - start_ms);
+
+    (void)dc_platform_mutex_lock(&call->lock);
+    attempt->status = st;
+    attempt->done = 1;
+    dc_rest_hedge_settle(call, 1);
+    int last = (--call->refs == 0);
+    (void)dc_platform_mutex_unlock(&call->lock);
+    if (last) dc_rest_hedge_call_free(call);
+
+    /* The client may be freed as soon as this unlocks. */
+    (void)dc_platform_mutex_lock(&client->hedge_lock);
+    if (--client->hedge_workers == 0) dc_platform_cond_broadcast(&client->hedge_idle);
+    (void)dc_platform_mutex_unlock(&client->hedge_lock);
+}
+
+/* Called with hedge_lock held; the call has just left the pending list. */
+static int dc_rest_hedge_start(dc_rest_client_t* client, dc_rest_hedge_call_t* call) {
+    if (!dc_rest_hedge_has_budget(client, call->source)) return 0;
+    if (dc_rest_request_clone(call->source, &call->request) != DC_OK) return 0;
+    call->request_inited = 1;
+
+    (void)dc_platform_mutex_lock(&call->lock);
+    call->refs++;
+    call->attempts[1].started = 1;
+    (void)dc_platform_mutex_unlock(&call->lock);
+    client->hedge_workers++;
+
+    dc_platform_thread_t thread;
+    if (!dc_platform_thread_create(&thread, dc_rest_hedge_worker, call)) {
+        client->hedge_workers--;
+        (void)dc_platform_mutex_lock(&call->lock);
+        call->refs--;
+        call->attempts[1].started = 0;
+        (void)dc_platform_mutex_unlock(&call->lock);
+        return 0;
+    }
+    (void)dc_platform_thread_detach(thread);
+    return 1;
+}
+
+/* One per client, started by the first hedged call past the sampling phase. */
+static void dc_rest_hedge_timer_main(void* arg) {
+    dc_rest_client_t* client = (dc_rest_client_t*)arg;
+    (void)dc_platform_mutex_lock(&client->hedge_lock);
+    while (!client->hedge_stopping) {
+        size_t due = SIZE_MAX;
+        uint64_t next_ms = UINT64_MAX;
+        for (size_t i = 0; i < client->hedge_pending.length; i++) {
+            dc_rest_hedge_call_t** call = (dc_rest_hedge_call_t**)dc_vec_at(&client->hedge_pending, i);
+            if (call && *call && (*call)->hedge_at_ms < next_ms) {
+                next_ms = (*call)->hedge_at_ms;
+                due = i;
+            }
+        }
+        if (due == SIZE_MAX) {
+            (void)dc_platform_cond_wait(&client->hedge_wake, &client->hedge_lock);
+            continue;
+        }
+        uint64_t now_ms = dc_rest_now_ms();
+        if (next_ms > now_ms) {
+            (void)dc_platform_cond_timedwait_ms(&client->hedge_wake, &client->hedge_lock, next_ms - now_ms);
+            continue;
+        }
+
+        dc_rest_hedge_call_t* call = NULL;
+        (void)dc_vec_swap_remove(&client->hedge_pending, due, &call);
+        if (dc_rest_hedge_start(client, call)) client->hedge_stats.hedges_sent++;
+        else client->hedge_stats.hedges_skipped++;
+    }
+    (void)dc_platform_mutex_unlock(&client->hedge_lock);
+}
+
+/* Queues the call for the timer; 0 when no hedge can be scheduled. */
+static int dc_rest_hedge_schedule(dc_rest_client_t* client, dc_rest_hedge_call_t* call) {
+    if (!dc_platform_mutex_lock(&client->hedge_lock)) return 0;
+    int ok = !client->hedge_stopping;
+    if (ok && !client->hedge_timer_running) {
+        ok = dc_platform_thread_create(&client->hedge_timer, dc_rest_hedge_timer_main, client);
+        client->hedge_timer_running = ok;
+    }
+    if (ok) ok = (dc_vec_push(&client->hedge_pending, &call) == DC_OK);
+    if (ok) dc_platform_cond_signal(&client->hedge_wake);
+    (void)dc_platform_mutex_unlock(&client->hedge_lock);
+    return ok;
+}
+
+/* Takes the call back from the timer; after this no hedge can start for it. */
+static void dc_rest_hedge_unschedule(dc_rest_client_t* client, dc_rest_hedge_call_t* call) {
+    (void)dc_platform_mutex_lock(&client->hedge_lock);
+    for (size_t i = 0; i < client->hedge_pending.length; i++) {
+        dc_rest_hedge_call_t** pending = (dc_rest_hedge_call_t**)dc_vec_at(&client->hedge_pending, i);
+        if (pending && *pending == call) {
+            (void)dc_vec_swap_remove(&client->hedge_pending, i, NULL);
+            break;
+        }
+    }
+    (void)dc_platform_mutex_unlock(&client->hedge_lock);
+}
+
+dc_status_t dc_rest_execute_hedged(dc_rest_client_t* client, const dc_rest_request_t* request,
+                                   dc_rest_response_t* response) {
+    if (!client || !request || !response) return DC_ERROR_NULL_POINTER;
+    if (dc_string_is_empty(&request->path)) return DC_ERROR_INVALID_PARAM;
+    dc_status_t preflight_st = dc_rest_preflight(client, request);
+    if (preflight_st != DC_OK) return preflight_st;
+
+    uint32_t threshold_ms = 0;
+    if (!dc_platform_mutex_lock(&client->hedge_lock)) return DC_ERROR_INVALID_STATE;
+    client->hedge_stats.requests++;
+    threshold_ms = client->hedge_stats.threshold_ms;
+    dc_platform_mutex_unlock(&client->hedge_lock);
+
+    uint64_t start_ms = dc_rest_now_ms();
+    dc_rest_hedge_call_t* call = NULL;
+    if (threshold_ms > 0) {
+        call = dc_rest_hedge_call_create(client, request, response);
+        if (call) {
+            call->hedge_at_ms = start_ms + threshold_ms;
+            if (!dc_rest_hedge_schedule(client, call)) {
+                dc_rest_hedge_call_free(call);
+                call = NULL;
+            }
+        }
+    }
+    if (!call) {
+        dc_status_t st = dc_rest_execute_send(client, request, response, NULL);
+        dc_rest_hedge_record(client, dc_rest_now_ms() - start_ms);
+        return st;
+    }
+
+    dc_rest_hedge_attempt_t* primary = &call->attempts[0];
+    primary->started = 1;
+    dc_status_t primary_st = dc_rest_execute_send(client, request, response, primary->cancel);
+    dc_rest_hedge_record(client, dc_rest_now_ms() - start_ms);
+    dc_rest_hedge_unschedule(client, call);
+
+    (void)dc_platform_mutex_lock(&call->lock);
+    primary->status = primary_st;
+    primary->done = 1;
+    dc_rest_hedge_settle(call, 0);
+    while (call->winner < 0) {
+        (void)dc_platform_cond_wait(&call->done, &call->lock);
+    }
+    dc_status_t st = call->attempts[call->winner].status;
+    int hedge_won = (call->winner == 1);
+    if (hedge_won) {
+        dc_rest_response_free(response);
+        *response = call->hedge_response;
+        call->hedge_response_taken = 1;
+    }
+    int last = (--call->refs == 0);
+    (void)dc_platform_mutex_unlock(&call->lock);
+    if (last) dc_rest_hedge_call_free(call);
+
+    if (hedge_won && dc_platform_mutex_lock(&client->hedge_lock)) {
+        client->hedge_stats.hedges_won++;
+        dc_platform_mutex_unlock(&client->hedge_lock);
+    }
+    return st;
+}
@@ -4,6 +4,16 @@
 /**
  * @file dc_rest.h
  * @brief REST client with rate limit handling
+ *
+ * A client may be shared between threads. Per-route buckets sit behind
+ * striped locks and the global limit is a lock-free GCRA, so requests on
+ * different buckets do not serialize on the client. Each request in flight
+ * borrows its own connection from a small pool.
+ *
+ * dc_rest_execute_hedged() sends a second identical request when the first
+ * is slower than a latency percentile of recent hedged calls, and returns
+ * whichever answers first. Only use it for requests the server deduplicates
+ * (e.g. message creates with nonce + enforce_nonce).
  */
 
 #include <stdint.h>
@@ -23,18 +33,32 @@ typedef dc_status_t (*dc_rest_transport_fn)(void* userdata,
                                             const dc_http_request_t* request,
                                             dc_http_response_t* response);
 
+/**
+ * @brief Check run before a request is sent
+ *
+ * Return DC_OK to send, anything else to fail the request with that status
+ * without touching the network or the rate limit state. Called from every
+ * thread that executes requests.
+ */
+typedef dc_status_t (*dc_rest_preflight_fn)(void* userdata, dc_http_method_t method,
+                                            const char* path);
+
 typedef struct {
     const char* token;                  /**< Bot token */
     dc_http_auth_type_t auth_type;      /**< Bot/Bearer */
     const char* user_agent;             /**< Optional explicit User-Agent */
     uint32_t timeout_ms;                /**< Default request timeout */
     uint32_t max_retries;               /**< Retries for 429 responses (default 1) */
-    uint32_t global_rate_limit_per_sec; /**< Global limit guard (default 50) */
-    uint32_t global_window_ms;          /**< Global limit window (default 1000ms) */
+    uint32_t global_rate_limit_per_sec; /**< Global limit guard, also the max burst (default 50) */
+    uint32_t global_window_ms;          /**< Period the global limit applies to (default 1000ms) */
     uint32_t invalid_request_limit;     /**< Invalid request threshold (default 10000) */
     uint32_t invalid_request_window_ms; /**< Invalid request window (default 600000ms) */
+    uint32_t hedge_percentile;          /**< Latency percentile that triggers a hedge (default 95) */
+    uint32_t hedge_min_delay_ms;        /**< Lower bound on the hedge delay (default 20ms) */
     dc_rest_transport_fn transport;     /**< Optional transport override */
     void* transport_userdata;           /**< Transport user data */
+    dc_rest_preflight_fn preflight;     /**< Optional check before each request */
+    void* preflight_userdata;           /**< Preflight user data */
 } dc_rest_client_config_t;
 
 typedef struct {
@@ -71,9 +95,85 @@ dc_status_t dc_rest_request_set_interaction(dc_rest_request_t* request, int is_i
 dc_status_t dc_rest_response_init(dc_rest_response_t* response);
 void dc_rest_response_free(dc_rest_response_t* response);
 
+/**
+ * @brief Move the response body into @p out without copying
+ *
+ * @p out's previous buffer is freed and the response body is left empty.
+ * Conversely, swapping an empty caller string into response->http.body
+ * before dc_rest_execute lends its capacity to the transfer: the body is
+ * written straight into it and kept across retries.
+ *
+ * @param response Executed response
+ * @param out Destination string (initialized)
+ * @return DC_OK on success, error code on failure
+ */
+dc_status_t dc_rest_response_take_body(dc_rest_response_t* response, dc_string_t* out);
+
 dc_status_t dc_rest_execute(dc_rest_client_t* client, const dc_rest_request_t* request,
                             dc_rest_response_t* response);
 
+/**
+ * @brief Rate limit budget of a route's bucket (see dc_rest_get_route_budget)
+ */
+typedef struct {
+    int known;              /**< A response from the bucket has been seen */
+    uint32_t limit;         /**< Requests per window */
+    uint32_t remaining;     /**< Requests left in the window (the full limit once it has reset) */
+    uint64_t reset_in_ms;   /**< Time until the window resets (0 if it has, or is unknown) */
+} dc_rest_route_budget_t;
+
+/**
+ * @brief Read the rate limit budget of the bucket a request would use
+ *
+ * Reflects the last response from that bucket (routes sharing an
+ * X-RateLimit-Bucket report the same budget); requests still in flight are
+ * not subtracted.
+ *
+ * @param client REST client
+ * @param method Request method
+ * @param path Request path, as passed to dc_rest_request_set_path
+ * @param out Receives the budget
+ * @return DC_OK on success, error code on failure
+ */
+dc_status_t dc_rest_get_route_budget(dc_rest_client_t* client, dc_http_method_t method,
+                                     const char* path, dc_rest_route_budget_t* out);
+
+/**
+ * @brief Hedging counters (see dc_rest_execute_hedged)
+ */
+typedef struct {
+    uint64_t requests;          /**< dc_rest_execute_hedged calls */
+    uint64_t hedges_sent;       /**< Second attempts issued */
+    uint64_t hedges_won;        /**< Calls answered by the second attempt */
+    uint64_t hedges_skipped;    /**< Over the threshold, but the bucket had no spare request */
+    uint32_t threshold_ms;      /**< Current hedge delay, 0 while still sampling */
+} dc_rest_hedge_stats_t;
+
+/**
+ * @brief Execute a request, hedging it with a second attempt when slow
+ *
+ * Latencies of hedged calls feed a sliding window; once it holds enough
+ * samples, a call still unanswered after the configured percentile (and at
+ * least hedge_min_delay_ms) sends the same request again on another
+ * connection, provided the route's bucket has a request to spare beyond the
+ * one in flight. The first attempt runs on the calling thread; a per-client
+ * timer thread starts the hedge on its own thread only once the delay
+ * expires. The first attempt to get an HTTP response wins and fires the
+ * other's dc_http_request_t.cancel, so the caller returns without waiting
+ * for the loser.
+ *
+ * A transport override must be thread-safe to be used with this call, and
+ * should poll dc_http_cancel_fired(request->cancel) while it blocks;
+ * otherwise the caller still waits for its own first attempt to return.
+ */
+dc_status_t dc_rest_execute_hedged(dc_rest_client_t* client, const dc_rest_request_t* request,
+                                   dc_rest_response_t* response);
+
+/**
+ * @brief Read hedging counters
+ */
+dc_status_t dc_rest_get_hedge_stats(dc_rest_client_t* client, dc_rest_hedge_stats_t* out);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,715 @@
+/**
+ * @file dc_tls_sessions.c
+ * @brief Shared TLS session cache, pluggable store, handshake counters and kernel offload
+ */
+
+#include "dc_tls_sessions.h"
+#include "core/dc_alloc.h"
+#include "core/dc_platform.h"
+#include "core/dc_string.h"
+#include "core/dc_vec.h"
+#include <curl/curl.h>
+#include <stdatomic.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(DC_HAVE_OPENSSL)
+#include <openssl/bio.h>
+#include <openssl/err.h>
+#include <openssl/pem.h>
+#include <openssl/ssl.h>
+#include <openssl/x509.h>
+#endif
+
+/* SSL_OP_ENABLE_KTLS appeared in OpenSSL 3.0; offload itself is Linux-only here. */
+#if defined(DC_HAVE_OPENSSL) && defined(__linux__) && defined(SSL_OP_ENABLE_KTLS)
+#define DC_TLS_HAS_KTLS 1
+#endif
+
+/* curl_easy_ssls_import/export appeared in 8.12.0. */
+#if defined(LIBCURL_VERSION_NUM) && LIBCURL_VERSION_NUM >= 0x080c00
+#define DC_TLS_CURL_HAS_SSLS 1
+#endif
+
+typedef struct {
+    atomic_uint_fast64_t full;
+    atomic_uint_fast64_t resumed;
+    atomic_uint_fast64_t unclassified;
+    atomic_uint_fast64_t reused;
+    atomic_uint_fast64_t saved;
+    atomic_uint_fast64_t loaded;
+    atomic_uint_fast64_t ktls_tx;
+    atomic_uint_fast64_t ktls_rx;
+} dc_tls_counters_t;
+
+static dc_tls_counters_t g_http_counters;
+static dc_tls_counters_t g_gateway_counters;
+static atomic_int g_ktls_enabled;
+
+/* Store callbacks are copied out under the lock and invoked outside it. */
+static dc_platform_mutex_t g_store_lock = DC_PLATFORM_MUTEX_INITIALIZER;
+static dc_tls_session_store_t g_store;
+static int g_store_set = 0;
+
+/*
+ * Shared REST cache; created and destroyed under g_share_lock. Sessions move
+ * between the cache and the store as owned copies, so the store callbacks
+ * never run under this lock.
+ */
+static dc_platform_mutex_t g_share_lock = DC_PLATFORM_MUTEX_INITIALIZER;
+static CURLSH* g_share = NULL;
+static int g_share_refs = 0;
+static dc_platform_mutex_t g_share_mutexes[CURL_LOCK_DATA_LAST];
+
+/* Owned copy of a dc_tls_session_t (cache <-> store transfers, memory store). */
+typedef struct {
+    dc_tls_session_source_t source;
+    int has_key;
+    dc_string_t key;
+    unsigned char* shmac;
+    size_t shmac_len;
+    unsigned char* data;
+    size_t data_len;
+    int64_t valid_until;
+} dc_tls_session_copy_t;
+
+static void dc_tls_session_copy_free(dc_tls_session_copy_t* c) {
+    dc_string_free(&c->key);
+    dc_free(c->shmac);
+    dc_free(c->data);
+    c->shmac = NULL;
+    c->data = NULL;
+}
+
+static unsigned char* dc_tls_memdup(const unsigned char* src, size_t len) {
+    if (!src || len == 0) return NULL;
+    unsigned char* out = (unsigned char*)dc_alloc(len);
+    if (out) memcpy(out, src, len);
+    return out;
+}
+
+static dc_status_t dc_tls_session_copy_init(dc_tls_session_copy_t* c, const dc_tls_session_t* session) {
+    if (!session->data || session->data_len == 0) return DC_ERROR_INVALID_PARAM;
+    if (!session->key && (!session->shmac || session->shmac_len == 0)) return DC_ERROR_INVALID_PARAM;
+    memset(c, 0, sizeof(*c));
+    c->source = session->source;
+    c->valid_until = session->valid_until;
+    dc_status_t st = dc_string_init(&c->key);
+    if (st != DC_OK) return st;
+    if (session->key) {
+        c->has_key = 1;
+        st = dc_string_set_cstr(&c->key, session->key);
+    }
+    c->data = dc_tls_memdup(session->data, session->data_len);
+    c->data_len = session->data_len;
+    if (session->shmac_len > 0) {
+        c->shmac = dc_tls_memdup(session->shmac, session->shmac_len);
+        c->shmac_len = session->shmac_len;
+    }
+    if (st == DC_OK && (!c->data || (session->shmac_len > 0 && !c->shmac))) {
+        st = DC_ERROR_OUT_OF_MEMORY;
+    }
+    if (st != DC_OK) dc_tls_session_copy_free(c);
+    return st;
+}
+
+/* Borrowed view; valid while the copy is. */
+static void dc_tls_session_copy_view(const dc_tls_session_copy_t* c, dc_tls_session_t* out) {
+    memset(out, 0, sizeof(*out));
+    out->source = c->source;
+    out->key = c->has_key ? dc_string_cstr(&c->key) : NULL;
+    out->shmac = c->shmac;
+    out->shmac_len = c->shmac_len;
+    out->data = c->data;
+    out->data_len = c->data_len;
+    out->valid_until = c->valid_until;
+}
+
+static void dc_tls_session_copies_free(dc_vec_t* copies) {
+    for (size_t i = 0; i < copies->length; i++) {
+        dc_tls_session_copy_free((dc_tls_session_copy_t*)dc_vec_at(copies, i));
+    }
+    dc_vec_free(copies);
+}
+
+static dc_tls_counters_t* dc_tls_counters_for(dc_tls_session_source_t source) {
+    return source == DC_TLS_SESSION_SOURCE_GATEWAY ? &g_gateway_counters : &g_http_counters;
+}
+
+static int dc_tls_store_get(dc_tls_session_store_t* out) {
+    if (!dc_platform_mutex_lock(&g_store_lock)) return 0;
+    int set = g_store_set;
+    if (set) *out = g_store;
+    dc_platform_mutex_unlock(&g_store_lock);
+    return set;
+}
+
+int dc_tls_sessions_has_store(void) {
+    dc_tls_session_store_t store;
+    return dc_tls_store_get(&store);
+}
+
+dc_status_t dc_tls_sessions_store_save(const dc_tls_session_t* session) {
+    if (!session) return DC_ERROR_NULL_POINTER;
+    dc_tls_session_store_t store;
+    if (!dc_tls_store_get(&store)) return DC_ERROR_NOT_FOUND;
+    dc_status_t st = store.save(store.userdata, session);
+    if (st == DC_OK) {
+        atomic_fetch_add(&dc_tls_counters_for(session->source)->saved, 1);
+    }
+    return st;
+}
+
+typedef struct {
+    dc_tls_session_visit_fn visit;
+    void* visit_ctx;
+    dc_tls_session_source_t source;
+} dc_tls_load_ctx_t;
+
+static dc_status_t dc_tls_load_count_visit(void* ctx, const dc_tls_session_t* session) {
+    dc_tls_load_ctx_t* load = (dc_tls_load_ctx_t*)ctx;
+    dc_status_t st = load->visit(load->visit_ctx, session);
+    if (st == DC_OK) {
+        atomic_fetch_add(&dc_tls_counters_for(load->source)->loaded, 1);
+    }
+    return st;
+}
+
+dc_status_t dc_tls_sessions_store_load(dc_tls_session_source_t source, const char* key,
+                                       dc_tls_session_visit_fn visit, void* visit_ctx) {
+    if (!visit) return DC_ERROR_NULL_POINTER;
+    dc_tls_session_store_t store;
+    if (!dc_tls_store_get(&store)) return DC_ERROR_NOT_FOUND;
+    dc_tls_load_ctx_t load = { visit, visit_ctx, source };
+    return store.load(store.userdata, source, key, dc_tls_load_count_visit, &load);
+}
+
+/* ------------------------------------------------------------------------ */
+/* Shared libcurl cache                                                      */
+/* ------------------------------------------------------------------------ */
+
+static void dc_tls_share_lock_cb(CURL* handle, curl_lock_data data, curl_lock_access access,
+                                 void* userptr) {
+    (void)handle;
+    (void)access;
+    (void)userptr;
+    if ((int)data >= 0 && (int)data < (int)CURL_LOCK_DATA_LAST) {
+        (void)dc_platform_mutex_lock(&g_share_mutexes[data]);
+    }
+}
+
+static void dc_tls_share_unlock_cb(CURL* handle, curl_lock_data data, void* userptr) {
+    (void)handle;
+    (void)userptr;
+    if ((int)data >= 0 && (int)data < (int)CURL_LOCK_DATA_LAST) {
+        dc_platform_mutex_unlock(&g_share_mutexes[data]);
+    }
+}
+
+#if defined(DC_TLS_CURL_HAS_SSLS)
+/* Visitor that appends a copy to a dc_vec_t of dc_tls_session_copy_t. */
+static dc_status_t dc_tls_session_collect(void* ctx, const dc_tls_session_t* session) {
+    dc_tls_session_copy_t copy;
+    dc_status_t st = dc_tls_session_copy_init(&copy, session);
+    if (st != DC_OK) return st;
+    st = dc_vec_push((dc_vec_t*)ctx, &copy);
+    if (st != DC_OK) dc_tls_session_copy_free(&copy);
+    return st;
+}
+
+/* Runs under libcurl's share lock: only copies the session out. */
+static CURLcode dc_tls_curl_export_cb(CURL* handle, void* userptr, const char* session_key,
+                                      const unsigned char* shmac, size_t shmac_len,
+                                      const unsigned char* sdata, size_t sdata_len,
+                                      curl_off_t valid_until, int ietf_tls_id,
+                                      const char* alpn, size_t earlydata_max) {
+    (void)handle;
+    (void)ietf_tls_id;
+    (void)alpn;
+    (void)earlydata_max;
+    dc_tls_session_t session;
+    memset(&session, 0, sizeof(session));
+    session.source = DC_TLS_SESSION_SOURCE_HTTP;
+    session.key = session_key;
+    session.shmac = shmac;
+    session.shmac_len = shmac_len;
+    session.data = sdata;
+    session.data_len = sdata_len;
+    session.valid_until = (int64_t)valid_until;
+    (void)dc_tls_session_collect(userptr, &session);
+    return CURLE_OK;
+}
+#endif
+
+/* No lock held: hands exported copies to the store. */
+static void dc_tls_save_copies(dc_vec_t* copies) {
+    for (size_t i = 0; i < copies->length; i++) {
+        dc_tls_session_t session;
+        dc_tls_session_copy_view((const dc_tls_session_copy_t*)dc_vec_at(copies, i), &session);
+        (void)dc_tls_sessions_store_save(&session);
+    }
+}
+
+/* g_share_lock held: copies every cached session out through a throwaway handle. */
+static void dc_tls_share_export_locked(dc_vec_t* copies) {
+#if defined(DC_TLS_CURL_HAS_SSLS)
+    if (!g_share) return;
+    CURL* easy = curl_easy_init();
+    if (!easy) return;
+    curl_easy_setopt(easy, CURLOPT_SHARE, g_share);
+    (void)curl_easy_ssls_export(easy, dc_tls_curl_export_cb, copies);
+    curl_easy_cleanup(easy);
+#else
+    (void)copies;
+#endif
+}
+
+/* No lock held: loads the store's REST sessions, then imports them into the cache. */
+static void dc_tls_share_import(void) {
+#if defined(DC_TLS_CURL_HAS_SSLS)
+    dc_tls_session_store_t store;
+    if (!dc_tls_store_get(&store)) return;
+    dc_vec_t copies;
+    if (dc_vec_init(&copies, sizeof(dc_tls_session_copy_t)) != DC_OK) return;
+    (void)store.load(store.userdata, DC_TLS_SESSION_SOURCE_HTTP, NULL, dc_tls_session_collect, &copies);
+
+    if (copies.length > 0 && dc_platform_mutex_lock(&g_share_lock)) {
+        CURL* easy = g_share ? curl_easy_init() : NULL;
+        if (easy) {
+            curl_easy_setopt(easy, CURLOPT_SHARE, g_share);
+            for (size_t i = 0; i < copies.length; i++) {
+                const dc_tls_session_copy_t* c = (const dc_tls_session_copy_t*)dc_vec_at(&copies, i);
+                CURLcode rc = curl_easy_ssls_import(easy, c->has_key ? dc_string_cstr(&c->key) : NULL,
+                                                    c->shmac, c->shmac_len, c->data, c->data_len);
+                if (rc == CURLE_OK) atomic_fetch_add(&g_http_counters.loaded, 1);
+            }
+            curl_easy_cleanup(easy);
+        }
+        dc_platform_mutex_unlock(&g_share_lock);
+    }
+    dc_tls_session_copies_free(&copies);
+#endif
+}
+
+/* No lock held: copies the cache out under g_share_lock, then saves the copies. */
+static void dc_tls_share_export(void) {
+    dc_tls_session_store_t store;
+    if (!dc_tls_store_get(&store)) return;
+    dc_vec_t copies;
+    if (dc_vec_init(&copies, sizeof(dc_tls_session_copy_t)) != DC_OK) return;
+    if (dc_platform_mutex_lock(&g_share_lock)) {
+        dc_tls_share_export_locked(&copies);
+        dc_platform_mutex_unlock(&g_share_lock);
+    }
+    dc_tls_save_copies(&copies);
+    dc_tls_session_copies_free(&copies);
+}
+
+static void dc_tls_share_destroy(void) {
+    if (!g_share) return;
+    if (curl_share_cleanup(g_share) != CURLSHE_OK) {
+        /* Still attached to a live handle; leak rather than free under it. */
+        g_share = NULL;
+        return;
+    }
+    g_share = NULL;
+    for (int i = 0; i < (int)CURL_LOCK_DATA_LAST; i++) {
+        dc_platform_mutex_destroy(&g_share_mutexes[i]);
+    }
+}
+
+static dc_status_t dc_tls_share_create(void) {
+    int inited = 0;
+    for (; inited < (int)CURL_LOCK_DATA_LAST; inited++) {
+        if (!dc_platform_mutex_init(&g_share_mutexes[inited])) break;
+    }
+    if (inited < (int)CURL_LOCK_DATA_LAST) {
+        for (int i = 0; i < inited; i++) dc_platform_mutex_destroy(&g_share_mutexes[i]);
+        return DC_ERROR_INVALID_STATE;
+    }
+    CURLSH* share = curl_share_init();
+    if (!share ||
+        curl_share_setopt(share, CURLSHOPT_LOCKFUNC, dc_tls_share_lock_cb) != CURLSHE_OK ||
+        curl_share_setopt(share, CURLSHOPT_UNLOCKFUNC, dc_tls_share_unlock_cb) != CURLSHE_OK ||
+        curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION) != CURLSHE_OK) {
+        if (share) curl_share_cleanup(share);
+        for (int i = 0; i < (int)CURL_LOCK_DATA_LAST; i++) dc_platform_mutex_destroy(&g_share_mutexes[i]);
+        return DC_ERROR_NETWORK;
+    }
+    g_share = share;
+    return DC_OK;
+}
+
+dc_status_t dc_tls_sessions_acquire(void) {
+    dc_status_t st = DC_OK;
+    int created = 0;
+    if (!dc_platform_mutex_lock(&g_share_lock)) return DC_ERROR_INVALID_STATE;
+    if (g_share_refs == 0) {
+        st = dc_tls_share_create();
+        created = (st == DC_OK);
+    }
+    if (st == DC_OK) g_share_refs++;
+    dc_platform_mutex_unlock(&g_share_lock);
+    if (created) dc_tls_share_import();
+    return st;
+}
+
+void dc_tls_sessions_release(void) {
+    dc_vec_t copies;
+    if (dc_vec_init(&copies, sizeof(dc_tls_session_copy_t)) != DC_OK) return;
+    if (dc_platform_mutex_lock(&g_share_lock)) {
+        if (g_share_refs > 0) {
+            g_share_refs--;
+            if (g_share_refs == 0) {
+                if (dc_tls_sessions_has_store()) dc_tls_share_export_locked(&copies);
+                dc_tls_share_destroy();
+            }
+        }
+        dc_platform_mutex_unlock(&g_share_lock);
+    }
+    dc_tls_save_copies(&copies);
+    dc_tls_session_copies_free(&copies);
+}
+
+void dc_tls_sessions_attach_curl(void* easy) {
+    if (!easy || !dc_platform_mutex_lock(&g_share_lock)) return;
+    if (g_share) curl_easy_setopt((CURL*)easy, CURLOPT_SHARE, g_share);
+    dc_platform_mutex_unlock(&g_share_lock);
+}
+
+dc_status_t dc_tls_set_kernel_offload(int enabled) {
+#if defined(DC_TLS_HAS_KTLS)
+    atomic_store(&g_ktls_enabled, enabled ? 1 : 0);
+    return DC_OK;
+#else
+    if (enabled) return DC_ERROR_NOT_IMPLEMENTED;
+    atomic_store(&g_ktls_enabled, 0);
+    return DC_OK;
+#endif
+}
+
+int dc_tls_kernel_offload_enabled(void) {
+    return atomic_load(&g_ktls_enabled);
+}
+
+void dc_tls_configure_ssl_ctx(void* ssl_ctx) {
+#if defined(DC_TLS_HAS_KTLS)
+    if (ssl_ctx && atomic_load(&g_ktls_enabled)) {
+        (void)SSL_CTX_set_options((SSL_CTX*)ssl_ctx, SSL_OP_ENABLE_KTLS);
+    }
+#else
+    (void)ssl_ctx;
+#endif
+}
+
+dc_status_t dc_tls_ssl_ctx_add_ca_pem(void* ssl_ctx, const char* pem) {
+    if (!ssl_ctx || !pem) return DC_ERROR_NULL_POINTER;
+#if defined(DC_HAVE_OPENSSL)
+    X509_STORE* store = SSL_CTX_get_cert_store((SSL_CTX*)ssl_ctx);
+    BIO* bio = BIO_new_mem_buf(pem, -1);
+    if (!store || !bio) {
+        BIO_free(bio);
+        return DC_ERROR_OUT_OF_MEMORY;
+    }
+    size_t added = 0;
+    X509* cert = NULL;
+    while ((cert = PEM_read_bio_X509(bio, NULL, NULL, NULL)) != NULL) {
+        /* A certificate the store already holds still counts. */
+        (void)X509_STORE_add_cert(store, cert);
+        X509_free(cert);
+        added++;
+    }
+    BIO_free(bio);
+    /* The read that ends the loop leaves a "no start line" error behind. */
+    ERR_clear_error();
+    return added > 0 ? DC_OK : DC_ERROR_INVALID_FORMAT;
+#else
+    return DC_ERROR_NOT_IMPLEMENTED;
+#endif
+}
+
+void dc_tls_ktls_status(void* ssl, int* tx, int* rx) {
+    if (tx) *tx = 0;
+    if (rx) *rx = 0;
+#if defined(DC_TLS_HAS_KTLS)
+    if (!ssl) return;
+    if (tx) *tx = BIO_get_ktls_send(SSL_get_wbio((SSL*)ssl)) ? 1 : 0;
+    if (rx) *rx = BIO_get_ktls_recv(SSL_get_rbio((SSL*)ssl)) ? 1 : 0;
+#else
+    (void)ssl;
+#endif
+}
+
+#if defined(DC_TLS_HAS_KTLS)
+/* CURLOPT_SSL_CTX_FUNCTION hands over an SSL_CTX only on the OpenSSL backend. */
+static int dc_tls_curl_is_openssl(void) {
+    static atomic_int cached = -1;
+    int v = atomic_load(&cached);
+    if (v < 0) {
+        const curl_version_info_data* info = curl_version_info(CURLVERSION_NOW);
+        v = (info && info->ssl_version && strncmp(info->ssl_version, "OpenSSL/", 8) == 0) ? 1 : 0;
+        atomic_store(&cached, v);
+    }
+    return v;
+}
+
+static CURLcode dc_tls_curl_ssl_ctx_cb(CURL* curl, void* ssl_ctx, void* userptr) {
+    (void)curl;
+    (void)userptr;
+    dc_tls_configure_ssl_ctx(ssl_ctx);
+    return CURLE_OK;
+}
+#endif
+
+static int dc_tls_prereq_cb(void* clientp, char* conn_primary_ip, char* conn_local_ip,
+                            int conn_primary_port, int conn_local_port) {
+    (void)conn_primary_ip;
+    (void)conn_local_ip;
+    (void)conn_primary_port;
+    (void)conn_local_port;
+    dc_tls_curl_probe_t* probe = (dc_tls_curl_probe_t*)clientp;
+    /* The TLS object is only reachable while the connection is attached. */
+    struct curl_tlssessioninfo* info = NULL;
+    if (curl_easy_getinfo((CURL*)probe->easy, CURLINFO_TLS_SSL_PTR, &info) != CURLE_OK ||
+        !info || !info->internals) {
+        return CURL_PREREQFUNC_OK;
+    }
+#if defined(DC_HAVE_OPENSSL)
+    if (info->backend == CURLSSLBACKEND_OPENSSL) {
+        probe->classified = 1;
+        probe->resumed = SSL_session_reused((SSL*)info->internals) ? 1 : 0;
+        dc_tls_ktls_status(info->internals, &probe->ktls_tx, &probe->ktls_rx);
+    }
+#endif
+    return CURL_PREREQFUNC_OK;
+}
+
+void dc_tls_sessions_probe_curl(dc_tls_curl_probe_t* probe) {
+    if (!probe || !probe->easy) return;
+    probe->classified = 0;
+    probe->resumed = 0;
+    probe->ktls_tx = 0;
+    probe->ktls_rx = 0;
+    curl_easy_setopt((CURL*)probe->easy, CURLOPT_PREREQFUNCTION, dc_tls_prereq_cb);
+    curl_easy_setopt((CURL*)probe->easy, CURLOPT_PREREQDATA, probe);
+#if defined(DC_TLS_HAS_KTLS)
+    /* Only when enabled, so the default path leaves curl's TLS setup untouched. */
+    if (atomic_load(&g_ktls_enabled) && dc_tls_curl_is_openssl()) {
+        curl_easy_setopt((CURL*)probe->easy, CURLOPT_SSL_CTX_FUNCTION, dc_tls_curl_ssl_ctx_cb);
+    }
+#endif
+}
+
+void dc_tls_sessions_record_curl(dc_tls_curl_probe_t* probe) {
+    if (!probe || !probe->easy) return;
+    long connects = 0;
+    if (curl_easy_getinfo((CURL*)probe->easy, CURLINFO_NUM_CONNECTS, &connects) != CURLE_OK) return;
+    if (connects <= 0) {
+        atomic_fetch_add(&g_http_counters.reused, 1);
+        return;
+    }
+    if (probe->ktls_tx) atomic_fetch_add(&g_http_counters.ktls_tx, 1);
+    if (probe->ktls_rx) atomic_fetch_add(&g_http_counters.ktls_rx, 1);
+    if (!probe->classified) {
+        atomic_fetch_add(&g_http_counters.unclassified, 1);
+    } else if (probe->resumed) {
+        atomic_fetch_add(&g_http_counters.resumed, 1);
+        return;
+    } else {
+        atomic_fetch_add(&g_http_counters.full, 1);
+    }
+#if defined(DC_TLS_CURL_HAS_SSLS)
+    /* A new session may have been negotiated; copy it out, then hand it to the store. */
+    if (!dc_tls_sessions_has_store()) return;
+    dc_vec_t copies;
+    if (dc_vec_init(&copies, sizeof(dc_tls_session_copy_t)) != DC_OK) return;
+    (void)curl_easy_ssls_export((CURL*)probe->easy, dc_tls_curl_export_cb, &copies);
+    dc_tls_save_copies(&copies);
+    dc_tls_session_copies_free(&copies);
+#endif
+}
+
+void dc_tls_sessions_record_gateway(int resumed, void* ssl) {
+    int tx = 0;
+    int rx = 0;
+    dc_tls_ktls_status(ssl, &tx, &rx);
+    if (tx) atomic_fetch_add(&g_gateway_counters.ktls_tx, 1);
+    if (rx) atomic_fetch_add(&g_gateway_counters.ktls_rx, 1);
+    if (resumed > 0) {
+        atomic_fetch_add(&g_gateway_counters.resumed, 1);
+    } else if (resumed == 0) {
+        atomic_fetch_add(&g_gateway_counters.full, 1);
+    } else {
+        atomic_fetch_add(&g_gateway_counters.unclassified, 1);
+    }
+}
+
+/* ------------------------------------------------------------------------ */
+/* Public API                                                                */
+/* ------------------------------------------------------------------------ */
+
+dc_status_t dc_tls_sessions_set_store(const dc_tls_session_store_t* store) {
+    if (store && (!store->save || !store->load)) return DC_ERROR_INVALID_PARAM;
+    if (!dc_platform_mutex_lock(&g_store_lock)) return DC_ERROR_INVALID_STATE;
+    if (store) {
+        g_store = *store;
+        g_store_set = 1;
+    } else {
+        memset(&g_store, 0, sizeof(g_store));
+        g_store_set = 0;
+    }
+    dc_platform_mutex_unlock(&g_store_lock);
+
+    if (store) dc_tls_share_import();
+    return DC_OK;
+}
+
+dc_status_t dc_tls_sessions_flush(void) {
+    dc_tls_share_export();
+    return DC_OK;
+}
+
+static void dc_tls_counters_snapshot(dc_tls_counters_t* c, dc_tls_handshake_counters_t* out) {
+    out->full = (uint64_t)atomic_load(&c->full);
+    out->resumed = (uint64_t)atomic_load(&c->resumed);
+    out->unclassified = (uint64_t)atomic_load(&c->unclassified);
+    out->reused = (uint64_t)atomic_load(&c->reused);
+    out->saved = (uint64_t)atomic_load(&c->saved);
+    out->loaded = (uint64_t)atomic_load(&c->loaded);
+    out->ktls_tx = (uint64_t)atomic_load(&c->ktls_tx);
+    out->ktls_rx = (uint64_t)atomic_load(&c->ktls_rx);
+}
+
+static void dc_tls_counters_zero(dc_tls_counters_t* c) {
+    atomic_store(&c->full, 0);
+    atomic_store(&c->resumed, 0);
+    atomic_store(&c->unclassified, 0);
+    atomic_store(&c->reused, 0);
+    atomic_store(&c->saved, 0);
+    atomic_store(&c->loaded, 0);
+    atomic_store(&c->ktls_tx, 0);
+    atomic_store(&c->ktls_rx, 0);
+}
+
+void dc_tls_sessions_get_stats(dc_tls_session_stats_t* out) {
+    if (!out) return;
+    dc_tls_counters_snapshot(&g_http_counters, &out->http);
+    dc_tls_counters_snapshot(&g_gateway_counters, &out->gateway);
+}
+
+void dc_tls_sessions_reset_stats(void) {
+    dc_tls_counters_zero(&g_http_counters);
+    dc_tls_counters_zero(&g_gateway_counters);
+}
+
+/* ------------------------------------------------------------------------ */
+/* In-memory store                                                           */
+/* ------------------------------------------------------------------------ */
+
+struct dc_tls_memory_store {
+    dc_platform_mutex_t lock;
+    dc_vec_t entries;   /* dc_tls_session_copy_t */
+};
+
+static int dc_tls_memory_entry_matches(const dc_tls_session_copy_t* e, const dc_tls_session_t* s) {
+    if (e->source != s->source) return 0;
+    if (s->key) return e->has_key && strcmp(dc_string_cstr(&e->key), s->key) == 0;
+    return !e->has_key && e->shmac_len == s->shmac_len && s->shmac_len > 0 &&
+           memcmp(e->shmac, s->shmac, s->shmac_len) == 0;
+}
+
+static dc_status_t dc_tls_memory_save(void* userdata, const dc_tls_session_t* session) {
+    dc_tls_memory_store_t* ms = (dc_tls_memory_store_t*)userdata;
+    if (!ms || !session) return DC_ERROR_NULL_POINTER;
+
+    dc_tls_session_copy_t entry;
+    dc_status_t st = dc_tls_session_copy_init(&entry, session);
+    if (st != DC_OK) return st;
+
+    if (!dc_platform_mutex_lock(&ms->lock)) {
+        dc_tls_session_copy_free(&entry);
+        return DC_ERROR_INVALID_STATE;
+    }
+    dc_tls_session_copy_t* existing = NULL;
+    for (size_t i = 0; i < ms->entries.length; i++) {
+        dc_tls_session_copy_t* e = (dc_tls_session_copy_t*)dc_vec_at(&ms->entries, i);
+        if (dc_tls_memory_entry_matches(e, session)) {
+            existing = e;
+            break;
+        }
+    }
+    if (existing) {
+        dc_tls_session_copy_free(existing);
+        *existing = entry;
+    } else {
+        st = dc_vec_push(&ms->entries, &entry);
+        if (st != DC_OK) dc_tls_session_copy_free(&entry);
+    }
+    dc_platform_mutex_unlock(&ms->lock);
+    return st;
+}
+
+static dc_status_t dc_tls_memory_load(void* userdata, dc_tls_session_source_t source, const char* key,
+                                      dc_tls_session_visit_fn visit, void* visit_ctx) {
+    dc_tls_memory_store_t* ms = (dc_tls_memory_store_t*)userdata;
+    if (!ms || !visit) return DC_ERROR_NULL_POINTER;
+    int64_t now = (int64_t)time(NULL);
+    if (!dc_platform_mutex_lock(&ms->lock)) return DC_ERROR_INVALID_STATE;
+    for (size_t i = 0; i < ms->entries.length; i++) {
+        const dc_tls_session_copy_t* e = (const dc_tls_session_copy_t*)dc_vec_at(&ms->entries, i);
+        if (e->source != source) continue;
+        if (key && (!e->has_key || strcmp(dc_string_cstr(&e->key), key) != 0)) continue;
+        if (e->valid_until > 0 && e->valid_until <= now) continue;
+        dc_tls_session_t session;
+        dc_tls_session_copy_view(e, &session);
+        (void)visit(visit_ctx, &session);
+    }
+    dc_platform_mutex_unlock(&ms->lock);
+    return DC_OK;
+}
+
+dc_status_t dc_tls_memory_store_create(dc_tls_memory_store_t** store) {
+    if (!store) return DC_ERROR_NULL_POINTER;
+    *store = NULL;
+    dc_tls_memory_store_t* ms = (dc_tls_memory_store_t*)dc_alloc(sizeof(*ms));
+    if (!ms) return DC_ERROR_OUT_OF_MEMORY;
+    memset(ms, 0, sizeof(*ms));
+    dc_status_t st = dc_vec_init(&ms->entries, sizeof(dc_tls_session_copy_t));
+    if (st != DC_OK) {
+        dc_free(ms);
+        return st;
+    }
+    if (!dc_platform_mutex_init(&ms->lock)) {
+        dc_vec_free(&ms->entries);
+        dc_free(ms);
+        return DC_ERROR_INVALID_STATE;
+    }
+    *store = ms;
+    return DC_OK;
+}
+
+void dc_tls_memory_store_free(dc_tls_memory_store_t* store) {
+    if (!store) return;
+    for (size_t i = 0; i < store->entries.length; i++) {
+        dc_tls_session_copy_free((dc_tls_session_copy_t*)dc_vec_at(&store->entries, i));
+    }
+    dc_vec_free(&store->entries);
+    dc_platform_mutex_destroy(&store->lock);
+    dc_free(store);
+}
+
+dc_status_t dc_tls_memory_store_bind(dc_tls_memory_store_t* store, dc_tls_session_store_t* out) {
+    if (!store || !out) return DC_ERROR_NULL_POINTER;
+    out->save = dc_tls_memory_save;
+    out->load = dc_tls_memory_load;
+    out->userdata = store;
+    return DC_OK;
+}
+
+size_t dc_tls_memory_store_count(dc_tls_memory_store_t* store) {
+    if (!store) return 0;
+    if (!dc_platform_mutex_lock(&store->lock)) return 0;
+    size_t count = store->entries.length;
+    dc_platform_mutex_unlock(&store->lock);
+    return count;
+}
@@ -0,0 +1,291 @@
+#ifndef DC_TLS_SESSIONS_H
+#define DC_TLS_SESSIONS_H
+
+/**
+ * @file dc_tls_sessions.h
+ * @brief TLS session resumption and kernel offload for REST and gateway connections
+ *
+ * Every REST client in the process shares one libcurl TLS session cache, so
+ * a new connection from any client (or from a client whose handle was just
+ * reset) resumes the session a previous connection negotiated instead of
+ * paying a full handshake. The gateway's libwebsockets context is kept
+ * across reconnects and resumes from its own cache the same way.
+ *
+ * A pluggable store extends this across processes: sessions are saved to
+ * it after each full handshake and loaded from it when the cache starts
+ * empty (first REST client, gateway connect). Handshake counters report how
+ * many new connections resumed, for checking the resumption rate against a
+ * test server.
+ *
+ * Gateway resumption and persistence need libwebsockets built with
+ * LWS_WITH_TLS_SESSIONS; REST persistence needs libcurl 8.12 or newer built
+ * with the SSLS-EXPORT feature. Telling resumed handshakes from full ones on
+ * REST connections needs libcurl on OpenSSL and a build with OpenSSL found.
+ *
+ * On Linux, kernel TLS offload can be enabled as well: after the handshake
+ * OpenSSL hands record encryption to the kernel (or NIC), and reads and
+ * writes become plain socket calls.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include "core/dc_status.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Which connection layer a session belongs to
+ */
+typedef enum {
+    DC_TLS_SESSION_SOURCE_HTTP = 0,     /**< libcurl (REST) */
+    DC_TLS_SESSION_SOURCE_GATEWAY       /**< libwebsockets (gateway) */
+} dc_tls_session_source_t;
+
+/**
+ * @brief Serialized TLS session; all pointers are only valid during the call
+ */
+typedef struct {
+    dc_tls_session_source_t source;
+    const char* key;                /**< Peer key (NULL if the HTTP session is only identified by shmac) */
+    const unsigned char* shmac;     /**< Salted peer hash (HTTP only, may be NULL) */
+    size_t shmac_len;
+    const unsigned char* data;      /**< Opaque session/ticket data */
+    size_t data_len;
+    int64_t valid_until;            /**< Unix seconds, 0 if unknown */
+} dc_tls_session_t;
+
+/**
+ * @brief Called once per session produced by a store load
+ * @return DC_OK to continue
+ */
+typedef dc_status_t (*dc_tls_session_visit_fn)(void* ctx, const dc_tls_session_t* session);
+
+/**
+ * @brief Session store callbacks
+ *
+ * save replaces any session with the same source and key (or shmac when the
+ * key is NULL). load calls visit for every stored session of the source,
+ * or only for the one matching key when key is non-NULL; the session passed
+ * to visit only needs to stay valid for that call. Callbacks run on
+ * whichever thread completed the handshake and must be thread-safe. They
+ * are never called with a library lock held, so they may call back into
+ * dc_tls_sessions_* functions.
+ */
+typedef struct {
+    dc_status_t (*save)(void* userdata, const dc_tls_session_t* session);
+    dc_status_t (*load)(void* userdata, dc_tls_session_source_t source, const char* key,
+                        dc_tls_session_visit_fn visit, void* visit_ctx);
+    void* userdata;
+} dc_tls_session_store_t;
+
+/**
+ * @brief Handshake counters for one source
+ */
+typedef struct {
+    uint64_t full;          /**< New connections that negotiated a fresh session */
+    uint64_t resumed;       /**< New connections that resumed a cached session */
+    uint64_t unclassified;  /**< New connections whose TLS backend cannot report resumption */
+    uint64_t reused;        /**< Requests served on an already-open connection (no handshake) */
+    uint64_t saved;         /**< Sessions written to the store */
+    uint64_t loaded;        /**< Sessions loaded from the store */
+    uint64_t ktls_tx;       /**< New connections sending through kernel TLS */
+    uint64_t ktls_rx;       /**< New connections receiving through kernel TLS */
+} dc_tls_handshake_counters_t;
+
+/**
+ * @brief Process-wide handshake statistics
+ */
+typedef struct {
+    dc_tls_handshake_counters_t http;
+    dc_tls_handshake_counters_t gateway;
+} dc_tls_session_stats_t;
+
+/**
+ * @brief Install the process-wide session store
+ *
+ * The store is copied; its userdata must stay valid until the store is
+ * replaced or removed. Sessions already in the store are imported into the
+ * shared REST cache immediately if REST clients exist. Install it before
+ * creating clients so the first connections can resume.
+ *
+ * @param store Store callbacks, or NULL to stop persisting
+ * @return DC_OK on success, DC_ERROR_INVALID_PARAM if save or load is missing
+ */
+dc_status_t dc_tls_sessions_set_store(const dc_tls_session_store_t* store);
+
+/**
+ * @brief Write every session in the shared REST cache to the store
+ * @return DC_OK on success (also when no store or no REST client exists)
+ */
+dc_status_t dc_tls_sessions_flush(void);
+
+/**
+ * @brief Snapshot the handshake counters
+ * @param out Receives the counters
+ */
+void dc_tls_sessions_get_stats(dc_tls_session_stats_t* out);
+
+/**
+ * @brief Zero the handshake counters
+ */
+void dc_tls_sessions_reset_stats(void);
+
+/**
+ * @brief Enable or disable kernel TLS offload for new connections
+ *
+ * Applies to REST transfers started afterwards and to gateway clients whose
+ * connection context is created afterwards. A connection silently stays on
+ * userspace TLS when the kernel lacks the tls module, the negotiated cipher
+ * cannot be offloaded, or OpenSSL was built without kTLS; the ktls_tx and
+ * ktls_rx counters show what took effect. REST offload needs libcurl on
+ * OpenSSL; gateway offload needs libwebsockets on OpenSSL.
+ *
+ * Default: off.
+ *
+ * @param enabled Nonzero to enable
+ * @return DC_OK on success, DC_ERROR_NOT_IMPLEMENTED when enabling in a build
+ *         without Linux and OpenSSL kTLS support
+ */
+dc_status_t dc_tls_set_kernel_offload(int enabled);
+
+/**
+ * @brief Whether kernel TLS offload is enabled
+ * @return 1 if enabled, 0 otherwise
+ */
+int dc_tls_kernel_offload_enabled(void);
+
+/**
+ * @brief In-memory session store (thread-safe)
+ *
+ * Keeps the newest session per peer. Useful as a reference implementation
+ * and for sharing sessions between independent clients in one process.
+ */
+typedef struct dc_tls_memory_store dc_tls_memory_store_t;
+
+/**
+ * @brief Create an in-memory store
+ * @param store Pointer to store created store
+ * @return DC_OK on success, error code on failure
+ */
+dc_status_t dc_tls_memory_store_create(dc_tls_memory_store_t** store);
+
+/**
+ * @brief Free an in-memory store (uninstall it first)
+ * @param store Store to free
+ */
+void dc_tls_memory_store_free(dc_tls_memory_store_t* store);
+
+/**
+ * @brief Fill store callbacks backed by an in-memory store
+ * @param store In-memory store
+ * @param out Receives callbacks for dc_tls_sessions_set_store()
+ * @return DC_OK on success, error code on failure
+ */
+dc_status_t dc_tls_memory_store_bind(dc_tls_memory_store_t* store, dc_tls_session_store_t* out);
+
+/**
+ * @brief Number of sessions held
+ * @param store In-memory store
+ * @return Session count (0 for NULL)
+ */
+size_t dc_tls_memory_store_count(dc_tls_memory_store_t* store);
+
+/* Library-internal hooks used by dc_http.c and dc_gateway.c. */
+
+/**
+ * @brief Per-transfer resumption probe for a curl handle
+ */
+typedef struct {
+    void* easy;         /**< CURL handle */
+    int classified;     /**< Backend reported the resumption state */
+    int resumed;        /**< Connection resumed a session */
+    int ktls_tx;        /**< Kernel TLS active for sending */
+    int ktls_rx;        /**< Kernel TLS active for receiving */
+} dc_tls_curl_probe_t;
+
+/**
+ * @brief Take a reference on the shared REST cache (creates it on first use)
+ * @return DC_OK on success, error code on failure
+ */
+dc_status_t dc_tls_sessions_acquire(void);
+
+/**
+ * @brief Drop a reference; the last one saves the cache to the store and frees it
+ */
+void dc_tls_sessions_release(void);
+
+/**
+ * @brief Attach a curl handle to the shared cache (survives curl_easy_reset)
+ * @param easy CURL handle
+ */
+void dc_tls_sessions_attach_curl(void* easy);
+
+/**
+ * @brief Arm per-transfer TLS hooks (probe, kernel offload) after curl_easy_reset
+ * @param probe Probe; easy must be set
+ */
+void dc_tls_sessions_probe_curl(dc_tls_curl_probe_t* probe);
+
+/**
+ * @brief Count a completed transfer and save new sessions to the store
+ * @param probe Probe armed for the transfer
+ */
+void dc_tls_sessions_record_curl(dc_tls_curl_probe_t* probe);
+
+/**
+ * @brief Count a gateway handshake
+ * @param resumed 1 resumed, 0 full, -1 unknown
+ * @param ssl OpenSSL SSL object of the connection, or NULL
+ */
+void dc_tls_sessions_record_gateway(int resumed, void* ssl);
+
+/**
+ * @brief Apply process-wide TLS settings (kernel offload) to an OpenSSL SSL_CTX
+ * @param ssl_ctx OpenSSL SSL_CTX; ignored in builds without OpenSSL
+ */
+void dc_tls_configure_ssl_ctx(void* ssl_ctx);
+
+/**
+ * @brief Trust extra PEM certificates on an OpenSSL SSL_CTX, on top of its CA store
+ * @param ssl_ctx OpenSSL SSL_CTX
+ * @param pem One or more PEM certificates
+ * @return DC_OK on success, DC_ERROR_INVALID_FORMAT when no certificate parses,
+ *         DC_ERROR_NOT_IMPLEMENTED in builds without OpenSSL
+ */
+dc_status_t dc_tls_ssl_ctx_add_ca_pem(void* ssl_ctx, const char* pem);
+
+/**
+ * @brief Report whether kernel TLS is active on an OpenSSL connection
+ * @param ssl OpenSSL SSL object (may be NULL)
+ * @param tx Receives 1 if sends are offloaded (may be NULL)
+ * @param rx Receives 1 if receives are offloaded (may be NULL)
+ */
+void dc_tls_ktls_status(void* ssl, int* tx, int* rx);
+
+/**
+ * @brief Whether a store is installed
+ * @return 1 if installed, 0 otherwise
+ */
+int dc_tls_sessions_has_store(void);
+
+/**
+ * @brief Save a session to the installed store
+ * @param session Session to save
+ * @return DC_OK on success, DC_ERROR_NOT_FOUND if no store is installed
+ */
+dc_status_t dc_tls_sessions_store_save(const dc_tls_session_t* session);
+
+/**
+ * @brief Load sessions from the installed store
+ * @return DC_OK on success, DC_ERROR_NOT_FOUND if no store is installed
+ */
+dc_status_t dc_tls_sessions_store_load(dc_tls_session_source_t source, const char* key,
+                                       dc_tls_session_visit_fn visit, void* visit_ctx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DC_TLS_SESSIONS_H */
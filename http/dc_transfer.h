@@ -0,0 +1,87 @@
+#ifndef DC_TRANSFER_H
+#define DC_TRANSFER_H
+
+/**
+ * @file dc_transfer.h
+ * @brief Internal file I/O and curl-multi driver shared by dc_download and dc_upload
+ *
+ * Not installed and not part of the public API.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <curl/curl.h>
+#include "core/dc_status.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Current size of the file behind a descriptor
+ * @return 1 on success, 0 on failure
+ */
+int dc_transfer_file_size(int fd, uint64_t* out);
+
+/**
+ * @brief Truncate or extend a file to size bytes
+ * @return 1 on success, 0 on failure
+ */
+int dc_transfer_truncate(int fd, uint64_t size);
+
+/**
+ * @brief Write all of data at offset without moving a shared file position
+ *
+ * On Windows this seeks then writes; transfers are driven from one thread,
+ * so the two cannot interleave.
+ * @return 1 on success, 0 on failure
+ */
+int dc_transfer_pwrite_all(int fd, const char* data, size_t len, uint64_t offset);
+
+/**
+ * @brief Read up to len bytes at offset
+ * @param out_n Receives the number of bytes read
+ * @return 1 if at least one byte was read, 0 on error or end of file
+ */
+int dc_transfer_pread_some(int fd, char* buf, size_t len, uint64_t offset, size_t* out_n);
+
+/**
+ * @brief Called for each finished easy handle with its CURLOPT_PRIVATE pointer
+ * @return DC_OK to keep going, anything else stops the run with that status
+ */
+typedef dc_status_t (*dc_transfer_finish_fn)(void* ctx, void* priv, CURLcode code);
+
+/**
+ * @brief Called once per loop turn to start queued transfers
+ */
+typedef dc_status_t (*dc_transfer_fill_fn)(void* ctx);
+
+/**
+ * @brief Create a multi handle with one transfer per connection
+ *
+ * Takes a reference on libcurl's global state through
+ * dc_http_global_acquire(); dc_transfer_multi_free() drops it.
+ */
+dc_status_t dc_transfer_multi_create(CURLM** out);
+
+/**
+ * @brief Free a multi handle from dc_transfer_multi_create()
+ */
+void dc_transfer_multi_free(CURLM* multi);
+
+/**
+ * @brief Drive multi until *active drops to zero
+ *
+ * Each turn performs, hands finished transfers to finish, then calls fill.
+ * Both callbacks update *active as they add and remove handles.
+ * @return DC_OK once idle, or the first error from libcurl or a callback
+ */
+dc_status_t dc_transfer_multi_run(CURLM* multi, const uint32_t* active,
+                                  dc_transfer_finish_fn finish, dc_transfer_fill_fn fill,
+                                  void* ctx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DC_TRANSFER_H */
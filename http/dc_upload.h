@@ -0,0 +1,111 @@
+#ifndef DC_UPLOAD_H
+#define DC_UPLOAD_H
+
+/**
+ * @file dc_upload.h
+ * @brief Parallel streaming PUT uploads to pre-signed storage URLs
+ *
+ * Sends each file with a single PUT to its upload URL (as returned by
+ * POST /channels/{id}/attachments), reading the body from a file descriptor
+ * with pread() as libcurl asks for it. Up to max_connections files are in
+ * flight at once and nothing is buffered beyond libcurl's send buffers, so
+ * memory stays bounded regardless of file size.
+ *
+ * An uploader keeps its connection cache between calls. An uploader is not
+ * thread-safe, but separate uploaders can run on separate threads.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include "core/dc_status.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Progress callback
+ * @param sent_bytes Bytes handed to the network so far, across all files
+ * @param total_bytes Sum of all file sizes
+ * @param user_data User data from the options
+ */
+typedef void (*dc_upload_progress_fn)(uint64_t sent_bytes, uint64_t total_bytes,
+                                      void* user_data);
+
+/**
+ * @brief Per-call options
+ */
+typedef struct {
+    uint32_t max_connections;           /**< Files uploaded in parallel */
+    uint32_t connect_timeout_ms;        /**< Connection timeout (0 = libcurl default) */
+    uint32_t stall_timeout_ms;          /**< Abort a request making no progress for this long (0 = off) */
+    uint32_t max_retries;               /**< Retries per file after a transfer error or 5xx */
+    const char* user_agent;             /**< User-Agent (NULL = library default) */
+    dc_upload_progress_fn progress;     /**< Optional progress callback */
+    void* user_data;                    /**< Passed to progress */
+} dc_upload_options_t;
+
+/**
+ * @brief One file to upload
+ */
+typedef struct {
+    const char* url;            /**< Pre-signed upload URL */
+    int fd;                     /**< Readable, seekable source */
+    uint64_t offset;            /**< First byte of fd to send */
+    uint64_t size;              /**< Bytes to send */
+    const char* content_type;   /**< Content-Type (NULL = application/octet-stream) */
+    dc_status_t status;         /**< Out: DC_OK once stored, DC_ERROR_TRY_AGAIN if never finished */
+    uint32_t requests;          /**< Out: PUT requests issued, retries included */
+} dc_upload_item_t;
+
+/**
+ * @brief Uploader (opaque)
+ */
+typedef struct dc_uploader dc_uploader_t;
+
+/**
+ * @brief Initialize options with defaults
+ *
+ * Defaults:
+ * - max_connections: 4, max_retries: 2
+ * - connect_timeout_ms: 10000, stall_timeout_ms: 30000
+ */
+void dc_upload_options_init(dc_upload_options_t* options);
+
+/**
+ * @brief Create an uploader
+ * @param out Pointer to store created uploader
+ * @return DC_OK on success, error code on failure
+ */
+dc_status_t dc_uploader_create(dc_uploader_t** out);
+
+/**
+ * @brief Free an uploader and its cached connections
+ * @param uploader Uploader to free
+ */
+void dc_uploader_free(dc_uploader_t* uploader);
+
+/**
+ * @brief Upload @p count files in parallel
+ *
+ * A file whose transfer fails or which gets a 5xx/408/429 answer is sent
+ * again from its first byte, up to max_retries times. The first file that
+ * fails for good cancels the rest; each item's status tells which files
+ * made it.
+ *
+ * @param uploader Uploader
+ * @param items Files to upload (status and requests are written back)
+ * @param count Number of items
+ * @param options Options (NULL for defaults)
+ * @return DC_OK when every file is stored, otherwise the first failure:
+ *         DC_ERROR_NETWORK on transfer failure, the mapped HTTP status for
+ *         error responses, DC_ERROR_UNKNOWN when a file cannot be read
+ */
+dc_status_t dc_upload_files(dc_uploader_t* uploader, dc_upload_item_t* items, size_t count,
+                            const dc_upload_options_t* options);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DC_UPLOAD_H */
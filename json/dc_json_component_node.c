@@ -0,0 +1,650 @@
+/**
+ * @file dc_json_component_node.c
+ * @brief JSON decoding/encoding for compact component trees
+ */
+
+#include "dc_json_component_node.h"
+#include <string.h>
+#include <yyjson.h>
+
+/* ---- decoding ---- */
+
+static dc_status_t dc_node_get_str(yyjson_val* obj, const char* key, dc_arena_t* arena, const char** out) {
+    yyjson_val* field = yyjson_obj_get(obj, key);
+    *out = NULL;
+    if (!field || yyjson_is_null(field)) return DC_OK;
+    if (!yyjson_is_str(field)) return DC_ERROR_INVALID_FORMAT;
+    *out = dc_arena_strndup(arena, yyjson_get_str(field), yyjson_get_len(field));
+    return *out ? DC_OK : DC_ERROR_OUT_OF_MEMORY;
+}
+
+static dc_status_t dc_node_get_i32(yyjson_val* obj, const char* key, int32_t* out) {
+    yyjson_val* field = yyjson_obj_get(obj, key);
+    *out = DC_COMPONENT_UNSET;
+    if (!field || yyjson_is_null(field)) return DC_OK;
+    if (!yyjson_is_int(field)) return DC_ERROR_INVALID_FORMAT;
+    int64_t v = yyjson_get_sint(field);
+    /* INT32_MIN is the unset marker */
+    if (v <= INT32_MIN || v > INT32_MAX) return DC_ERROR_INVALID_FORMAT;
+    *out = (int32_t)v;
+    return DC_OK;
+}
+
+static dc_status_t dc_node_get_bool(yyjson_val* obj, const char* key, int8_t* out) {
+    yyjson_val* field = yyjson_obj_get(obj, key);
+    *out = DC_COMPONENT_BOOL_UNSET;
+    if (!field || yyjson_is_null(field)) return DC_OK;
+    if (!yyjson_is_bool(field)) return DC_ERROR_INVALID_FORMAT;
+    *out = yyjson_get_bool(field) ? 1 : 0;
+    return DC_OK;
+}
+
+static dc_status_t dc_node_get_array(yyjson_val* obj, const char* key, yyjson_val** out, size_t* count) {
+    yyjson_val* field = yyjson_obj_get(obj, key);
+    *out = NULL;
+    *count = 0;
+    if (!field || yyjson_is_null(field)) return DC_OK;
+    if (!yyjson_is_arr(field)) return DC_ERROR_INVALID_FORMAT;
+    *out = field;
+    *count = yyjson_arr_size(field);
+    return DC_OK;
+}
+
+static dc_status_t dc_node_get_emoji(yyjson_val* obj, const char* key, dc_arena_t* arena,
+                                     dc_component_emoji_t** out) {
+    yyjson_val* field = yyjson_obj_get(obj, key);
+    *out = NULL;
+    if (!field || yyjson_is_null(field)) return DC_OK;
+    if (!yyjson_is_obj(field)) return DC_ERROR_INVALID_FORMAT;
+    dc_component_emoji_t* emoji = (dc_component_emoji_t*)dc_arena_alloc(arena, sizeof(*emoji));
+    if (!emoji) return DC_ERROR_OUT_OF_MEMORY;
+    dc_status_t st = dc_json_get_snowflake_opt(field, "id", &emoji->id, 0);
+    if (st == DC_OK) st = dc_node_get_str(field, "name", arena, &emoji->name);
+    if (st == DC_OK) st = dc_node_get_bool(field, "animated", &emoji->animated);
+    if (st != DC_OK) return st;
+    *out = emoji;
+    return DC_OK;
+}
+
+static dc_status_t dc_node_get_media(yyjson_val* obj, const char* key, dc_arena_t* arena,
+                                     dc_component_media_t* media) {
+    dc_component_media_init(media);
+    yyjson_val* field = yyjson_obj_get(obj, key);
+    if (!field || yyjson_is_null(field)) return DC_OK;
+    if (!yyjson_is_obj(field)) return DC_ERROR_INVALID_FORMAT;
+    dc_status_t st = dc_node_get_str(field, "url", arena, &media->url);
+    if (st == DC_OK) st = dc_node_get_str(field, "proxy_url", arena, &media->proxy_url);
+    if (st == DC_OK) st = dc_node_get_str(field, "content_type", arena, &media->content_type);
+    if (st == DC_OK) st = dc_node_get_i32(field, "width", &media->width);
+    if (st == DC_OK) st = dc_node_get_i32(field, "height", &media->height);
+    if (st == DC_OK) st = dc_json_get_snowflake_opt(field, "attachment_id", &media->attachment_id, 0);
+    return st;
+}
+
+static dc_status_t dc_node_get_media_entry(yyjson_val* obj, dc_arena_t* arena,
+                                           dc_component_media_entry_t* entry) {
+    dc_status_t st = dc_node_get_media(obj, "media", arena, &entry->media);
+    if (st == DC_OK) st = dc_node_get_str(obj, "description", arena, &entry->description);
+    if (st == DC_OK) st = dc_node_get_bool(obj, "spoiler", &entry->spoiler);
+    return st;
+}
+
+static dc_status_t dc_node_get_options(yyjson_val* obj, dc_arena_t* arena, dc_component_select_t* select) {
+    yyjson_val* arr = NULL;
+    size_t count = 0;
+    dc_status_t st = dc_node_get_array(obj, "options", &arr, &count);
+    if (st != DC_OK || count == 0) return st;
+    select->options = (dc_component_option_t*)dc_arena_calloc(arena, count, sizeof(dc_component_option_t));
+    if (!select->options) return DC_ERROR_OUT_OF_MEMORY;
+
+    size_t idx = 0, max = 0;
+    yyjson_val* item = NULL;
+    yyjson_arr_foreach(arr, idx, max, item) {
+        if (!yyjson_is_obj(item)) return DC_ERROR_INVALID_FORMAT;
+        dc_component_option_t* option = &select->options[idx];
+        st = dc_node_get_str(item, "label", arena, &option->label);
+        if (st == DC_OK) st = dc_node_get_str(item, "value", arena, &option->value);
+        if (st == DC_OK) st = dc_node_get_str(item, "description", arena, &option->description);
+        if (st == DC_OK) st = dc_node_get_emoji(item, "emoji", arena, &option->emoji);
+        if (st == DC_OK) st = dc_node_get_bool(item, "default", &option->default_val);
+        if (st != DC_OK) return st;
+        if (!option->label || !option->value) return DC_ERROR_INVALID_FORMAT;
+    }
+    select->option_count = count;
+    return DC_OK;
+}
+
+static dc_status_t dc_node_get_default_values(yyjson_val* obj, dc_arena_t* arena, dc_component_select_t* select) {
+    yyjson_val* arr = NULL;
+    size_t count = 0;
+    dc_status_t st = dc_node_get_array(obj, "default_values", &arr, &count);
+    if (st != DC_OK || count == 0) return st;
+    select->default_values =
+        (dc_select_default_value_t*)dc_arena_calloc(arena, count, sizeof(dc_select_default_value_t));
+    if (!select->default_values) return DC_ERROR_OUT_OF_MEMORY;
+
+    size_t idx = 0, max = 0;
+    yyjson_val* item = NULL;
+    yyjson_arr_foreach(arr, idx, max, item) {
+        dc_select_default_value_t* dv = &select->default_values[idx];
+        const char* type = NULL;
+        st = dc_json_get_snowflake(item, "id", &dv->id);
+        if (st == DC_OK) st = dc_json_get_string(item, "type", &type);
+        if (st != DC_OK) return st;
+        if (strcmp(type, "user") == 0) {
+            dv->type = DC_SELECT_DEFAULT_VALUE_TYPE_USER;
+        } else if (strcmp(type, "role") == 0) {
+            dv->type = DC_SELECT_DEFAULT_VALUE_TYPE_ROLE;
+        } else if (strcmp(type, "channel") == 0) {
+            dv->type = DC_SELECT_DEFAULT_VALUE_TYPE_CHANNEL;
+        } else {
+            return DC_ERROR_INVALID_FORMAT;
+        }
+    }
+    select->default_value_count = count;
+    return DC_OK;
+}
+
+static dc_status_t dc_node_get_channel_types(yyjson_val* obj, dc_arena_t* arena, dc_component_select_t* select) {
+    yyjson_val* arr = NULL;
+    size_t count = 0;
+    dc_status_t st = dc_node_get_array(obj, "channel_types", &arr, &count);
+    if (st != DC_OK || count == 0) return st;
+    select->channel_types = (int32_t*)dc_arena_calloc(arena, count, sizeof(int32_t));
+    if (!select->channel_types) return DC_ERROR_OUT_OF_MEMORY;
+
+    size_t idx = 0, max = 0;
+    yyjson_val* item = NULL;
+    yyjson_arr_foreach(arr, idx, max, item) {
+        if (!yyjson_is_int(item)) return DC_ERROR_INVALID_FORMAT;
+        int64_t v = yyjson_get_sint(item);
+        if (v < 0 || v > INT32_MAX) return DC_ERROR_INVALID_FORMAT;
+        select->channel_types[idx] = (int32_t)v;
+    }
+    select->channel_type_count = count;
+    return DC_OK;
+}
+
+static dc_status_t dc_node_get_values(yyjson_val* obj, dc_arena_t* arena, dc_component_select_t* select) {
+    yyjson_val* arr = NULL;
+    size_t count = 0;
+    dc_status_t st = dc_node_get_array(obj, "values", &arr, &count);
+    if (st != DC_OK || !arr) return st;
+    select->has_values = 1;
+    if (count == 0) return DC_OK;
+    select->values = (const char**)dc_arena_calloc(arena, count, sizeof(const char*));
+    if (!select->values) return DC_ERROR_OUT_OF_MEMORY;
+
+    size_t idx = 0, max = 0;
+    yyjson_val* item = NULL;
+    yyjson_arr_foreach(arr, idx, max, item) {
+        if (!yyjson_is_str(item)) return DC_ERROR_INVALID_FORMAT;
+        select->values[idx] = dc_arena_strndup(arena, yyjson_get_str(item), yyjson_get_len(item));
+        if (!select->values[idx]) return DC_ERROR_OUT_OF_MEMORY;
+    }
+    select->value_count = count;
+    return DC_OK;
+}
+
+static dc_status_t dc_node_get_select(yyjson_val* obj, dc_arena_t* arena, dc_component_select_t* select) {
+    dc_status_t st = dc_node_get_str(obj, "custom_id", arena, &select->custom_id);
+    if (st == DC_OK) st = dc_node_get_str(obj, "placeholder", arena, &select->placeholder);
+    if (st == DC_OK) st = dc_node_get_i32(obj, "min_values", &select->min_values);
+    if (st == DC_OK) st = dc_node_get_i32(obj, "max_values", &select->max_values);
+    if (st == DC_OK) st = dc_node_get_bool(obj, "disabled", &select->disabled);
+    if (st == DC_OK) st = dc_node_get_bool(obj, "required", &select->required);
+    if (st == DC_OK) st = dc_node_get_options(obj, arena, select);
+    if (st == DC_OK) st = dc_node_get_default_values(obj, arena, select);
+    if (st == DC_OK) st = dc_node_get_channel_types(obj, arena, select);
+    if (st == DC_OK) st = dc_node_get_values(obj, arena, select);
+    return st;
+}
+
+static dc_status_t dc_node_get_child(yyjson_val* obj, const char* key, dc_arena_t* arena,
+                                     dc_component_node_t** out) {
+    yyjson_val* field = yyjson_obj_get(obj, key);
+    *out = NULL;
+    if (!field || yyjson_is_null(field)) return DC_OK;
+    return dc_json_component_node_from_val(field, arena, out);
+}
+
+static dc_status_t dc_node_get_children(yyjson_val* obj, dc_arena_t* arena, dc_component_children_t* out) {
+    yyjson_val* arr = NULL;
+    size_t count = 0;
+    dc_status_t st = dc_node_get_array(obj, "components", &arr, &count);
+    if (st != DC_OK || !arr) return st;
+    return dc_json_component_nodes_from_val(arr, arena, out);
+}
+
+static dc_status_t dc_node_get_gallery(yyjson_val* obj, dc_arena_t* arena, dc_component_node_t* node) {
+    yyjson_val* arr = NULL;
+    size_t count = 0;
+    dc_status_t st = dc_node_get_array(obj, "items", &arr, &count);
+    if (st != DC_OK || count == 0) return st;
+    dc_component_media_entry_t* items =
+        (dc_component_media_entry_t*)dc_arena_calloc(arena, count, sizeof(dc_component_media_entry_t));
+    if (!items) return DC_ERROR_OUT_OF_MEMORY;
+
+    size_t idx = 0, max = 0;
+    yyjson_val* item = NULL;
+    yyjson_arr_foreach(arr, idx, max, item) {
+        if (!yyjson_is_obj(item)) return DC_ERROR_INVALID_FORMAT;
+        st = dc_node_get_media_entry(item, arena, &items[idx]);
+        if (st != DC_OK) return st;
+    }
+    node->as.media_gallery.items = items;
+    node->as.media_gallery.item_count = count;
+    return DC_OK;
+}
+
+static dc_status_t dc_node_get_type(yyjson_val* val, dc_component_type_t* out, int* uses_component_type) {
+    yyjson_val* type_val = yyjson_obj_get(val, "type");
+    yyjson_val* component_type_val = yyjson_obj_get(val, "component_type");
+    if (type_val && yyjson_is_null(type_val)) type_val = NULL;
+    if (component_type_val && yyjson_is_null(component_type_val)) component_type_val = NULL;
+    if (!type_val && !component_type_val) return DC_ERROR_NOT_FOUND;
+    if ((type_val && !yyjson_is_int(type_val)) || (component_type_val && !yyjson_is_int(component_type_val))) {
+        return DC_ERROR_INVALID_FORMAT;
+    }
+
+    int64_t type = type_val ? yyjson_get_sint(type_val) : yyjson_get_sint(component_type_val);
+    if (type_val && component_type_val && yyjson_get_sint(component_type_val) != type) {
+        return DC_ERROR_INVALID_FORMAT;
+    }
+    if (type < 0 || type > INT32_MAX) return DC_ERROR_INVALID_FORMAT;
+    *out = (dc_component_type_t)type;
+    *uses_component_type = (type_val == NULL);
+    return DC_OK;
+}
+
+dc_status_t dc_json_component_node_from_val(yyjson_val* val, dc_arena_t* arena,
+                                            dc_component_node_t** out) {
+    if (!val || !arena || !out) return DC_ERROR_NULL_POINTER;
+    *out = NULL;
+    if (!yyjson_is_obj(val)) return DC_ERROR_INVALID_FORMAT;
+
+    dc_component_type_t type;
+    int uses_component_type = 0;
+    dc_status_t st = dc_node_get_type(val, &type, &uses_component_type);
+    if (st != DC_OK) return st;
+
+    dc_component_node_t* node = NULL;
+    st = dc_component_node_create(arena, type, &node);
+    if (st != DC_OK) return st;
+    node->uses_component_type = uses_component_type;
+    st = dc_node_get_i32(val, "id", &node->id);
+    if (st != DC_OK) return st;
+
+    switch (type) {
+        case DC_COMPONENT_TYPE_ACTION_ROW:
+            st = dc_node_get_children(val, arena, &node->as.action_row);
+            break;
+        case DC_COMPONENT_TYPE_BUTTON: {
+            dc_component_button_t* b = &node->as.button;
+            st = dc_node_get_i32(val, "style", &b->style);
+            if (st == DC_OK) st = dc_node_get_str(val, "custom_id", arena, &b->custom_id);
+            if (st == DC_OK) st = dc_node_get_str(val, "label", arena, &b->label);
+            if (st == DC_OK) st = dc_node_get_emoji(val, "emoji", arena, &b->emoji);
+            if (st == DC_OK) st = dc_node_get_str(val, "url", arena, &b->url);
+            if (st == DC_OK) st = dc_json_get_snowflake_opt(val, "sku_id", &b->sku_id, 0);
+            if (st == DC_OK) st = dc_node_get_bool(val, "disabled", &b->disabled);
+            break;
+        }
+        case DC_COMPONENT_TYPE_STRING_SELECT:
+        case DC_COMPONENT_TYPE_USER_SELECT:
+        case DC_COMPONENT_TYPE_ROLE_SELECT:
+        case DC_COMPONENT_TYPE_MENTIONABLE_SELECT:
+        case DC_COMPONENT_TYPE_CHANNEL_SELECT:
+        case DC_COMPONENT_TYPE_FILE_UPLOAD:
+        case DC_COMPONENT_TYPE_RADIO_GROUP:
+        case DC_COMPONENT_TYPE_CHECKBOX_GROUP:
+            st = dc_node_get_select(val, arena, &node->as.select);
+            break;
+        case DC_COMPONENT_TYPE_TEXT_INPUT: {
+            dc_component_text_input_t* t = &node->as.text_input;
+            st = dc_node_get_str(val, "custom_id", arena, &t->custom_id);
+            if (st == DC_OK) st = dc_node_get_i32(val, "style", &t->style);
+            if (st == DC_OK) st = dc_node_get_str(val, "label", arena, &t->label);
+            if (st == DC_OK) st = dc_node_get_i32(val, "min_length", &t->min_length);
+            if (st == DC_OK) st = dc_node_get_i32(val, "max_length", &t->max_length);
+            if (st == DC_OK) st = dc_node_get_bool(val, "required", &t->required);
+            if (st == DC_OK) st = dc_node_get_str(val, "value", arena, &t->value);
+            if (st == DC_OK) st = dc_node_get_str(val, "placeholder", arena, &t->placeholder);
+            break;
+        }
+        case DC_COMPONENT_TYPE_SECTION:
+            st = dc_node_get_children(val, arena, &node->as.section.components);
+            if (st == DC_OK) st = dc_node_get_child(val, "accessory", arena, &node->as.section.accessory);
+            break;
+        case DC_COMPONENT_TYPE_TEXT_DISPLAY:
+            st = dc_node_get_str(val, "content", arena, &node->as.text_display.content);
+            break;
+        case DC_COMPONENT_TYPE_THUMBNAIL:
+            st = dc_node_get_media_entry(val, arena, &node->as.thumbnail);
+            break;
+        case DC_COMPONENT_TYPE_MEDIA_GALLERY:
+            st = dc_node_get_gallery(val, arena, node);
+            break;
+        case DC_COMPONENT_TYPE_FILE: {
+            dc_component_file_t* f = &node->as.file;
+            st = dc_node_get_media(val, "file", arena, &f->file);
+            if (st == DC_OK) st = dc_node_get_bool(val, "spoiler", &f->spoiler);
+            if (st == DC_OK) st = dc_node_get_str(val, "name", arena, &f->name);
+            if (st == DC_OK) st = dc_node_get_i32(val, "size", &f->size);
+            break;
+        }
+        case DC_COMPONENT_TYPE_SEPARATOR:
+            st = dc_node_get_bool(val, "divider", &node->as.separator.divider);
+            if (st == DC_OK) st = dc_node_get_i32(val, "spacing", &node->as.separator.spacing);
+            break;
+        case DC_COMPONENT_TYPE_CONTAINER:
+            st = dc_node_get_children(val, arena, &node->as.container.components);
+            if (st == DC_OK) st = dc_node_get_i32(val, "accent_color", &node->as.container.accent_color);
+            if (st == DC_OK) st = dc_node_get_bool(val, "spoiler", &node->as.container.spoiler);
+            break;
+        case DC_COMPONENT_TYPE_LABEL:
+            st = dc_node_get_str(val, "label", arena, &node->as.label.label);
+            if (st == DC_OK) st = dc_node_get_str(val, "description", arena, &node->as.label.description);
+            if (st == DC_OK) st = dc_node_get_child(val, "component", arena, &node->as.label.component);
+            break;
+        case DC_COMPONENT_TYPE_CHECKBOX:
+            st = dc_node_get_str(val, "custom_id", arena, &node->as.checkbox.custom_id);
+            if (st == DC_OK) st = dc_node_get_bool(val, "default", &node->as.checkbox.default_val);
+            if (st == DC_OK) st = dc_node_get_bool(val, "value", &node->as.checkbox.value);
+            break;
+        default:
+            break;
+    }
+    if (st != DC_OK) return st;
+
+    *out = node;
+    return DC_OK;
+}
+
+dc_status_t dc_json_component_nodes_from_val(yyjson_val* arr, dc_arena_t* arena,
+                                             dc_component_children_t* out) {
+    if (!arr || !arena || !out) return DC_ERROR_NULL_POINTER;
+    if (!yyjson_is_arr(arr)) return DC_ERROR_INVALID_FORMAT;
+
+    size_t idx = 0, max = 0;
+    yyjson_val* item = NULL;
+    yyjson_arr_foreach(arr, idx, max, item) {
+        dc_component_node_t* node = NULL;
+        dc_status_t st = dc_json_component_node_from_val(item, arena, &node);
+        if (st != DC_OK) return st;
+        st = dc_component_children_append(out, node);
+        if (st != DC_OK) return st;
+    }
+    return DC_OK;
+}
+
+dc_status_t dc_json_component_nodes_parse(const char* json, dc_arena_t* arena,
+                                          dc_component_children_t* out) {
+    if (!json || !arena || !out) return DC_ERROR_NULL_POINTER;
+    dc_json_doc_t doc;
+    dc_status_t st = dc_json_parse(json, &doc);
+    if (st != DC_OK) return st;
+    st = dc_json_component_nodes_from_val(doc.root, arena, out);
+    dc_json_doc_free(&doc);
+    return st;
+}
+
+/* ---- encoding ---- */
+
+static dc_status_t dc_node_add_str(dc_json_mut_doc_t* doc, yyjson_mut_val* obj, const char* key,
+                                   const char* value) {
+    if (!value) return DC_OK;
+    return yyjson_mut_obj_add_str(doc->doc, obj, key, value) ? DC_OK : DC_ERROR_OUT_OF_MEMORY;
+}
+
+static dc_status_t dc_node_add_i32(dc_json_mut_doc_t* doc, yyjson_mut_val* obj, const char* key,
+                                   int32_t value) {
+    if (value == DC_COMPONENT_UNSET) return DC_OK;
+    return yyjson_mut_obj_add_int(doc->doc, obj, key, value) ? DC_OK : DC_ERROR_OUT_OF_MEMORY;
+}
+
+static dc_status_t dc_node_add_bool(dc_json_mut_doc_t* doc, yyjson_mut_val* obj, const char* key,
+                                    int8_t value) {
+    if (value == DC_COMPONENT_BOOL_UNSET) return DC_OK;
+    return yyjson_mut_obj_add_bool(doc->doc, obj, key, value != 0) ? DC_OK : DC_ERROR_OUT_OF_MEMORY;
+}
+
+static dc_status_t dc_node_add_snowflake(dc_json_mut_doc_t* doc, yyjson_mut_val* obj, const char* key,
+                                         dc_snowflake_t value) {
+    if (value == 0) return DC_OK;
+    return dc_json_mut_set_snowflake(doc, obj, key, value);
+}
+
+static dc_status_t dc_node_add_emoji(dc_json_mut_doc_t* doc, yyjson_mut_val* obj,
+                                     const dc_component_emoji_t* emoji) {
+    if (!emoji) return DC_OK;
+    yyjson_mut_val* emoji_obj = yyjson_mut_obj_add_obj(doc->doc, obj, "emoji");
+    if (!emoji_obj) return DC_ERROR_OUT_OF_MEMORY;
+    dc_status_t st = dc_node_add_snowflake(doc, emoji_obj, "id", emoji->id);
+    if (st == DC_OK) st = dc_node_add_str(doc, emoji_obj, "name", emoji->name);
+    if (st == DC_OK) st = dc_node_add_bool(doc, emoji_obj, "animated", emoji->animated);
+    return st;
+}
+
+static dc_status_t dc_node_add_media(dc_json_mut_doc_t* doc, yyjson_mut_val* obj, const char* key,
+                                     const dc_component_media_t* media) {
+    if (!media->url) return DC_OK;
+    yyjson_mut_val* media_obj = yyjson_mut_obj_add_obj(doc->doc, obj, key);
+    if (!media_obj) return DC_ERROR_OUT_OF_MEMORY;
+    dc_status_t st = dc_node_add_str(doc, media_obj, "url", media->url);
+    if (st == DC_OK) st = dc_node_add_str(doc, media_obj, "proxy_url", media->proxy_url);
+    if (st == DC_OK) st = dc_node_add_i32(doc, media_obj, "height", media->height);
+    if (st == DC_OK) st = dc_node_add_i32(doc, media_obj, "width", media->width);
+    if (st == DC_OK) st = dc_node_add_str(doc, media_obj, "content_type", media->content_type);
+    if (st == DC_OK) st = dc_node_add_snowflake(doc, media_obj, "attachment_id", media->attachment_id);
+    return st;
+}
+
+static dc_status_t dc_node_add_media_entry(dc_json_mut_doc_t* doc, yyjson_mut_val* obj,
+                                           const dc_component_media_entry_t* entry) {
+    dc_status_t st = dc_node_add_media(doc, obj, "media", &entry->media);
+    if (st == DC_OK) st = dc_node_add_str(doc, obj, "description", entry->description);
+    if (st == DC_OK) st = dc_node_add_bool(doc, obj, "spoiler", entry->spoiler);
+    return st;
+}
+
+static dc_status_t dc_node_add_children(dc_json_mut_doc_t* doc, yyjson_mut_val* obj,
+                                        const dc_component_children_t* children) {
+    yyjson_mut_val* arr = yyjson_mut_obj_add_arr(doc->doc, obj, "components");
+    if (!arr) return DC_ERROR_OUT_OF_MEMORY;
+    return dc_json_component_nodes_to_mut(doc, arr, children);
+}
+
+static dc_status_t dc_node_add_child(dc_json_mut_doc_t* doc, yyjson_mut_val* obj, const char* key,
+                                     const dc_component_node_t* child) {
+    if (!child) return DC_OK;
+    yyjson_mut_val* child_obj = yyjson_mut_obj_add_obj(doc->doc, obj, key);
+    if (!child_obj) return DC_ERROR_OUT_OF_MEMORY;
+    return dc_json_component_node_to_mut(doc, child_obj, child);
+}
+
+static dc_status_t dc_node_add_select(dc_json_mut_doc_t* doc, yyjson_mut_val* obj,
+                                      const dc_component_select_t* select) {
+    dc_status_t st = dc_node_add_str(doc, obj, "custom_id", select->custom_id);
+    if (st == DC_OK) st = dc_node_add_str(doc, obj, "placeholder", select->placeholder);
+    if (st == DC_OK) st = dc_node_add_i32(doc, obj, "min_values", select->min_values);
+    if (st == DC_OK) st = dc_node_add_i32(doc, obj, "max_values", select->max_values);
+    if (st == DC_OK) st = dc_node_add_bool(doc, obj, "disabled", select->disabled);
+    if (st == DC_OK) st = dc_node_add_bool(doc, obj, "required", select->required);
+    if (st != DC_OK) return st;
+
+    if (select->option_count > 0) {
+        yyjson_mut_val* arr = yyjson_mut_obj_add_arr(doc->doc, obj, "options");
+        if (!arr) return DC_ERROR_OUT_OF_MEMORY;
+        for (size_t i = 0; i < select->option_count; i++) {
+            const dc_component_option_t* option = &select->options[i];
+            if (!option->label || !option->value) return DC_ERROR_INVALID_PARAM;
+            yyjson_mut_val* item = yyjson_mut_arr_add_obj(doc->doc, arr);
+            if (!item) return DC_ERROR_OUT_OF_MEMORY;
+            st = dc_node_add_str(doc, item, "label", option->label);
+            if (st == DC_OK) st = dc_node_add_str(doc, item, "value", option->value);
+            if (st == DC_OK) st = dc_node_add_str(doc, item, "description", option->description);
+            if (st == DC_OK) st = dc_node_add_emoji(doc, item, option->emoji);
+            if (st == DC_OK) st = dc_node_add_bool(doc, item, "default", option->default_val);
+            if (st != DC_OK) return st;
+        }
+    }
+    if (select->default_value_count > 0) {
+        yyjson_mut_val* arr = yyjson_mut_obj_add_arr(doc->doc, obj, "default_values");
+        if (!arr) return DC_ERROR_OUT_OF_MEMORY;
+        for (size_t i = 0; i < select->default_value_count; i++) {
+            const dc_select_default_value_t* dv = &select->default_values[i];
+            const char* type = dv->type == DC_SELECT_DEFAULT_VALUE_TYPE_USER ? "user"
+                             : dv->type == DC_SELECT_DEFAULT_VALUE_TYPE_ROLE ? "role"
+                             : dv->type == DC_SELECT_DEFAULT_VALUE_TYPE_CHANNEL ? "channel" : NULL;
+            if (!type) return DC_ERROR_INVALID_PARAM;
+            yyjson_mut_val* item = yyjson_mut_arr_add_obj(doc->doc, arr);
+            if (!item) return DC_ERROR_OUT_OF_MEMORY;
+            st = dc_json_mut_set_snowflake(doc, item, "id", dv->id);
+            if (st == DC_OK) st = dc_node_add_str(doc, item, "type", type);
+            if (st != DC_OK) return st;
+        }
+    }
+    if (select->channel_type_count > 0) {
+        yyjson_mut_val* arr = yyjson_mut_obj_add_arr(doc->doc, obj, "channel_types");
+        if (!arr) return DC_ERROR_OUT_OF_MEMORY;
+        for (size_t i = 0; i < select->channel_type_count; i++) {
+            if (!yyjson_mut_arr_add_int(doc->doc, arr, select->channel_types[i])) return DC_ERROR_OUT_OF_MEMORY;
+        }
+    }
+    if (select->has_values || select->value_count > 0) {
+        yyjson_mut_val* arr = yyjson_mut_obj_add_arr(doc->doc, obj, "values");
+        if (!arr) return DC_ERROR_OUT_OF_MEMORY;
+        for (size_t i = 0; i < select->value_count; i++) {
+            if (!select->values[i]) return DC_ERROR_INVALID_PARAM;
+            if (!yyjson_mut_arr_add_str(doc->doc, arr, select->values[i])) return DC_ERROR_OUT_OF_MEMORY;
+        }
+    }
+    return DC_OK;
+}
+
+dc_status_t dc_json_component_node_to_mut(dc_json_mut_doc_t* doc, yyjson_mut_val* obj,
+                                          const dc_component_node_t* node) {
+    if (!doc || !doc->doc || !obj || !node) return DC_ERROR_NULL_POINTER;
+    if (!yyjson_mut_is_obj(obj)) return DC_ERROR_INVALID_PARAM;
+
+    const char* type_key = node->uses_component_type ? "component_type" : "type";
+    if (!yyjson_mut_obj_add_int(doc->doc, obj, type_key, (int64_t)node->type)) return DC_ERROR_OUT_OF_MEMORY;
+    dc_status_t st = dc_node_add_i32(doc, obj, "id", node->id);
+    if (st != DC_OK) return st;
+
+    switch (node->type) {
+        case DC_COMPONENT_TYPE_ACTION_ROW:
+            return dc_node_add_children(doc, obj, &node->as.action_row);
+        case DC_COMPONENT_TYPE_BUTTON: {
+            const dc_component_button_t* b = &node->as.button;
+            st = dc_node_add_i32(doc, obj, "style", b->style);
+            if (st == DC_OK) st = dc_node_add_str(doc, obj, "custom_id", b->custom_id);
+            if (st == DC_OK) st = dc_node_add_str(doc, obj, "label", b->label);
+            if (st == DC_OK) st = dc_node_add_emoji(doc, obj, b->emoji);
+            if (st == DC_OK) st = dc_node_add_str(doc, obj, "url", b->url);
+            if (st == DC_OK) st = dc_node_add_snowflake(doc, obj, "sku_id", b->sku_id);
+            if (st == DC_OK) st = dc_node_add_bool(doc, obj, "disabled", b->disabled);
+            return st;
+        }
+        case DC_COMPONENT_TYPE_STRING_SELECT:
+        case DC_COMPONENT_TYPE_USER_SELECT:
+        case DC_COMPONENT_TYPE_ROLE_SELECT:
+        case DC_COMPONENT_TYPE_MENTIONABLE_SELECT:
+        case DC_COMPONENT_TYPE_CHANNEL_SELECT:
+        case DC_COMPONENT_TYPE_FILE_UPLOAD:
+        case DC_COMPONENT_TYPE_RADIO_GROUP:
+        case DC_COMPONENT_TYPE_CHECKBOX_GROUP:
+            return dc_node_add_select(doc, obj, &node->as.select);
+        case DC_COMPONENT_TYPE_TEXT_INPUT: {
+            const dc_component_text_input_t* t = &node->as.text_input;
+            st = dc_node_add_str(doc, obj, "custom_id", t->custom_id);
+            if (st == DC_OK) st = dc_node_add_i32(doc, obj, "style", t->style);
+            if (st == DC_OK) st = dc_node_add_str(doc, obj, "label", t->label);
+            if (st == DC_OK) st = dc_node_add_i32(doc, obj, "min_length", t->min_length);
+            if (st == DC_OK) st = dc_node_add_i32(doc, obj, "max_length", t->max_length);
+            if (st == DC_OK) st = dc_node_add_bool(doc, obj, "required", t->required);
+            if (st == DC_OK) st = dc_node_add_str(doc, obj, "value", t->value);
+            if (st == DC_OK) st = dc_node_add_str(doc, obj, "placeholder", t->placeholder);
+            return st;
+        }
+        case DC_COMPONENT_TYPE_SECTION:
+            st = dc_node_add_children(doc, obj, &node->as.section.components);
+            if (st == DC_OK) st = dc_node_add_child(doc, obj, "accessory", node->as.section.accessory);
+            return st;
+        case DC_COMPONENT_TYPE_TEXT_DISPLAY:
+            return dc_node_add_str(doc, obj, "content", node->as.text_display.content);
+        case DC_COMPONENT_TYPE_THUMBNAIL:
+            return dc_node_add_media_entry(doc, obj, &node->as.thumbnail);
+        case DC_COMPONENT_TYPE_MEDIA_GALLERY: {
+            yyjson_mut_val* arr = yyjson_mut_obj_add_arr(doc->doc, obj, "items");
+            if (!arr) return DC_ERROR_OUT_OF_MEMORY;
+            for (size_t i = 0; i < node->as.media_gallery.item_count; i++) {
+                yyjson_mut_val* item = yyjson_mut_arr_add_obj(doc->doc, arr);
+                if (!item) return DC_ERROR_OUT_OF_MEMORY;
+                st = dc_node_add_media_entry(doc, item, &node->as.media_gallery.items[i]);
+                if (st != DC_OK) return st;
+            }
+            return DC_OK;
+        }
+        case DC_COMPONENT_TYPE_FILE: {
+            const dc_component_file_t* f = &node->as.file;
+            st = dc_node_add_media(doc, obj, "file", &f->file);
+            if (st == DC_OK) st = dc_node_add_bool(doc, obj, "spoiler", f->spoiler);
+            if (st == DC_OK) st = dc_node_add_str(doc, obj, "name", f->name);
+            if (st == DC_OK) st = dc_node_add_i32(doc, obj, "size", f->size);
+            return st;
+        }
+        case DC_COMPONENT_TYPE_SEPARATOR:
+            st = dc_node_add_bool(doc, obj, "divider", node->as.separator.divider);
+            if (st == DC_OK) st = dc_node_add_i32(doc, obj, "spacing", node->as.separator.spacing);
+            return st;
+        case DC_COMPONENT_TYPE_CONTAINER:
+            st = dc_node_add_children(doc, obj, &node->as.container.components);
+            if (st == DC_OK) st = dc_node_add_i32(doc, obj, "accent_color", node->as.container.accent_color);
+            if (st == DC_OK) st = dc_node_add_bool(doc, obj, "spoiler", node->as.container.spoiler);
+            return st;
+        case DC_COMPONENT_TYPE_LABEL:
+            st = dc_node_add_str(doc, obj, "label", node->as.label.label);
+            if (st == DC_OK) st = dc_node_add_str(doc, obj, "description", node->as.label.description);
+            if (st == DC_OK) st = dc_node_add_child(doc, obj, "component", node->as.label.component);
+            return st;
+        case DC_COMPONENT_TYPE_CHECKBOX:
+            st = dc_node_add_str(doc, obj, "custom_id", node->as.checkbox.custom_id);
+            if (st == DC_OK) st = dc_node_add_bool(doc, obj, "default", node->as.checkbox.default_val);
+            if (st == DC_OK) st = dc_node_add_bool(doc, obj, "value", node->as.checkbox.value);
+            return st;
+        default:
+            return DC_OK;
+    }
+}
+
+dc_status_t dc_json_component_nodes_to_mut(dc_json_mut_doc_t* doc, yyjson_mut_val* arr,
+                                           const dc_component_children_t* list) {
+    if (!doc || !doc->doc || !arr || !list) return DC_ERROR_NULL_POINTER;
+    if (!yyjson_mut_is_arr(arr)) return DC_ERROR_INVALID_PARAM;
+    for (const dc_component_node_t* node = list->first; node; node = node->next) {
+        yyjson_mut_val* obj = yyjson_mut_arr_add_obj(doc->doc, arr);
+        if (!obj) return DC_ERROR_OUT_OF_MEMORY;
+        dc_status_t st = dc_json_component_node_to_mut(doc, obj, node);
+        if (st != DC_OK) return st;
+    }
+    return DC_OK;
+}
+
+dc_status_t dc_json_component_nodes_serialize(const dc_component_children_t* list, dc_string_t* out) {
+    if (!list || !out) return DC_ERROR_NULL_POINTER;
+    dc_json_mut_doc_t doc;
+    dc_status_t st = dc_json_mut_doc_create(&doc);
+    if (st != DC_OK) return st;
+    doc.root = yyjson_mut_arr(doc.doc);
+    if (!doc.root) {
+        dc_json_mut_doc_free(&doc);
+        return DC_ERROR_OUT_OF_MEMORY;
+    }
+    yyjson_mut_doc_set_root(doc.doc, doc.root);
+    st = dc_json_component_nodes_to_mut(&doc, doc.root, list);
+    if (st == DC_OK) st = dc_json_write_mut_doc_to_string(doc.doc, 0, out);
+    dc_json_mut_doc_free(&doc);
+    return st;
+}
@@ -0,0 +1,86 @@
+#ifndef DC_JSON_COMPONENT_NODE_H
+#define DC_JSON_COMPONENT_NODE_H
+
+/**
+ * @file dc_json_component_node.h
+ * @brief JSON decoding/encoding for compact component trees
+ *
+ * Decoding reads only the fields of each node's type and copies strings
+ * into the arena, so the tree outlives the JSON document. Encoding adds
+ * strings to the mutable document by reference: keep the arena alive (and
+ * unreset) until the document has been serialized.
+ */
+
+#include "core/dc_arena.h"
+#include "core/dc_status.h"
+#include "core/dc_string.h"
+#include "json/dc_json.h"
+#include "model/dc_component_node.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Decode one component object
+ * @param val Component JSON object
+ * @param arena Arena that owns the result
+ * @param out Receives the node
+ * @return DC_OK on success, error code on failure
+ */
+dc_status_t dc_json_component_node_from_val(yyjson_val* val, dc_arena_t* arena,
+                                            dc_component_node_t** out);
+
+/**
+ * @brief Decode a components array, appending to @p out
+ * @param arr Components JSON array
+ * @param arena Arena that owns the result
+ * @param out List to append to (zero-initialize when empty)
+ * @return DC_OK on success, error code on failure
+ */
+dc_status_t dc_json_component_nodes_from_val(yyjson_val* arr, dc_arena_t* arena,
+                                             dc_component_children_t* out);
+
+/**
+ * @brief Parse a components array from JSON text
+ * @param json JSON array text
+ * @param arena Arena that owns the result
+ * @param out List to append to (zero-initialize when empty)
+ * @return DC_OK on success, error code on failure
+ */
+dc_status_t dc_json_component_nodes_parse(const char* json, dc_arena_t* arena,
+                                          dc_component_children_t* out);
+
+/**
+ * @brief Encode one node into an existing object
+ * @param doc Mutable document
+ * @param obj Target object
+ * @param node Node to encode
+ * @return DC_OK on success, error code on failure
+ */
+dc_status_t dc_json_component_node_to_mut(dc_json_mut_doc_t* doc, yyjson_mut_val* obj,
+                                          const dc_component_node_t* node);
+
+/**
+ * @brief Encode a list into an existing array
+ * @param doc Mutable document
+ * @param arr Target array
+ * @param list Nodes to encode
+ * @return DC_OK on success, error code on failure
+ */
+dc_status_t dc_json_component_nodes_to_mut(dc_json_mut_doc_t* doc, yyjson_mut_val* arr,
+                                           const dc_component_children_t* list);
+
+/**
+ * @brief Serialize a list as a compact JSON array
+ * @param list Nodes to encode
+ * @param out Output string (overwritten)
+ * @return DC_OK on success, error code on failure
+ */
+dc_status_t dc_json_component_nodes_serialize(const dc_component_children_t* list, dc_string_t* out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DC_JSON_COMPONENT_NODE_H */
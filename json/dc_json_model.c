@@ -9,10 +9,25 @@
 #include "model/dc_user.h"
 #include <limits.h>
 #include <inttypes.h>
+#include <stdatomic.h>
 #include <stdlib.h>
 #include <string.h>
 #include <yyjson.h>
 
+static atomic_uint g_raw_capture = DC_JSON_RAW_CAPTURE_DEFAULT;
+
+void dc_json_model_set_raw_capture(uint32_t fields) {
+    atomic_store(&g_raw_capture, fields & DC_JSON_RAW_CAPTURE_ALL);
+}
+
+uint32_t dc_json_model_raw_capture(void) {
+    return atomic_load(&g_raw_capture);
+}
+
+int dc_json_model_raw_capture_enabled(uint32_t fields) {
+    return fields != 0 && (atomic_load(&g_raw_capture) & fields) == fields;
+}
+
 static dc_status_t dc_json_copy_cstr(dc_string_t* dst, const char* src) {
     if (!dst) return DC_ERROR_NULL_POINTER;
     return dc_string_set_cstr(dst, src ? src : "");
@@ -51,8 +66,8 @@ static dc_status_t dc_json_mut_add_raw_json_if_set(dc_json_mut_doc_t* doc,
 
 static dc_status_t dc_json_parse_iso8601_if_set(const char* str) {
     if (!str || str[0] == '\0') return DC_OK;
-    dc_iso8601_t ts;
-    return dc_iso8601_parse(str, &ts);
+    int64_t ms = 0;
+    return dc_iso8601_parse_unix_ms(str, strlen(str), &ms);
 }
 
 static dc_status_t dc_int64_to_int_checked(int64_t val, int* out) {
@@ -2380,16 +2395,20 @@ dc_status_t dc_json_model_presence_from_val(yyjson_val* val, dc_presence_t* pres
     yyjson_val* activities_val = yyjson_obj_get(val, "activities");
     if (activities_val && !yyjson_is_null(activities_val)) {
         if (!yyjson_is_arr(activities_val)) return DC_ERROR_INVALID_FORMAT;
-        st = dc_json_copy_val_raw_json(activities_val, &presence->activities_json);
-        if (st != DC_OK) return st;
+        if (dc_json_model_raw_capture_enabled(DC_JSON_RAW_CAPTURE_PRESENCE_ACTIVITIES)) {
+            st = dc_json_copy_val_raw_json(activities_val, &presence->activities_json);
+            if (st != DC_OK) return st;
+        }
         presence->has_activities = 1;
     }
 
     yyjson_val* client_status_val = yyjson_obj_get(val, "client_status");
     if (client_status_val && !yyjson_is_null(client_status_val)) {
         if (!yyjson_is_obj(client_status_val)) return DC_ERROR_INVALID_FORMAT;
-        st = dc_json_copy_val_raw_json(client_status_val, &presence->client_status_json);
-        if (st != DC_OK) return st;
+        if (dc_json_model_raw_capture_enabled(DC_JSON_RAW_CAPTURE_PRESENCE_CLIENT_STATUS)) {
+            st = dc_json_copy_val_raw_json(client_status_val, &presence->client_status_json);
+            if (st != DC_OK) return st;
+        }
         presence->has_client_status = 1;
     }
 
@@ -20,6 +20,53 @@
 extern "C" {
 #endif
 
+/**
+ * @brief Raw JSON captures, one bit per field
+ *
+ * These fields hold a re-serialized copy of a payload subtree. The guild
+ * subtrees are already decoded into typed fields, so their copies are off
+ * unless enabled here. Presence activities/client_status and the
+ * MESSAGE_UPDATE payload have no typed equivalent and are captured by
+ * default. With a capture off, the matching has_* flag is still set and the
+ * subtree is still type-checked, but the string stays empty.
+ */
+typedef enum {
+    DC_JSON_RAW_CAPTURE_NONE = 0,
+    DC_JSON_RAW_CAPTURE_GUILD_ROLES = 1u << 0,             /**< dc_guild_t.roles_json */
+    DC_JSON_RAW_CAPTURE_GUILD_EMOJIS = 1u << 1,            /**< dc_guild_t.emojis_json */
+    DC_JSON_RAW_CAPTURE_GUILD_WELCOME_SCREEN = 1u << 2,    /**< dc_guild_t.welcome_screen_json */
+    DC_JSON_RAW_CAPTURE_GUILD_STICKERS = 1u << 3,          /**< dc_guild_t.stickers_json */
+    DC_JSON_RAW_CAPTURE_GUILD_INCIDENTS_DATA = 1u << 4,    /**< dc_guild_t.incidents_data_json */
+    DC_JSON_RAW_CAPTURE_PRESENCE_ACTIVITIES = 1u << 5,     /**< dc_presence_t.activities_json */
+    DC_JSON_RAW_CAPTURE_PRESENCE_CLIENT_STATUS = 1u << 6,  /**< dc_presence_t.client_status_json */
+    DC_JSON_RAW_CAPTURE_MESSAGE_UPDATE = 1u << 7,          /**< dc_gateway_message_update_t.raw_json */
+    DC_JSON_RAW_CAPTURE_DEFAULT = (1u << 5) | (1u << 6) | (1u << 7), /**< Fields with no typed equivalent */
+    DC_JSON_RAW_CAPTURE_ALL = 0xFFu
+} dc_json_raw_capture_t;
+
+/**
+ * @brief Select which raw JSON fields decoding fills
+ *
+ * Process-wide; affects payloads decoded afterwards.
+ *
+ * Default: DC_JSON_RAW_CAPTURE_DEFAULT (presence and MESSAGE_UPDATE only).
+ *
+ * @param fields Bitwise OR of dc_json_raw_capture_t values
+ */
+void dc_json_model_set_raw_capture(uint32_t fields);
+
+/**
+ * @brief Raw JSON fields currently captured
+ * @return Bitwise OR of dc_json_raw_capture_t values
+ */
+uint32_t dc_json_model_raw_capture(void);
+
+/**
+ * @brief Whether every field in @p fields is captured
+ * @return 1 if captured, 0 otherwise
+ */
+int dc_json_model_raw_capture_enabled(uint32_t fields);
+
 dc_status_t dc_json_model_user_from_val(yyjson_val* val, dc_user_t* user);
 dc_status_t dc_json_model_guild_from_val(yyjson_val* val, dc_guild_t* guild);
 dc_status_t dc_json_model_guild_member_from_val(yyjson_val* val, dc_guild_member_t* member);
@@ -0,0 +1,511 @@
+/**
+ * @file dc_json_patch.c
+ * @brief Minimal PATCH bodies from model diffs
+ */
+
+#include "dc_json_patch.h"
+#include <inttypes.h>
+#include <string.h>
+
+/*
+ * Bodies are written directly into the caller's string rather than built as
+ * a mutable document and serialized, so a reused buffer never reallocates
+ * once it has grown to the largest body. The first failed append sticks in
+ * st and turns the remaining writes into no-ops.
+ */
+typedef struct {
+    dc_string_t* out;
+    size_t fields;
+    dc_status_t st;
+} dc_json_patch_writer_t;
+
+static void dc_json_patch_begin(dc_json_patch_writer_t* w, dc_string_t* out) {
+    w->out = out;
+    w->fields = 0;
+    w->st = dc_string_clear(out);
+}
+
+static dc_status_t dc_json_patch_end(dc_json_patch_writer_t* w, size_t* out_fields) {
+    if (w->st == DC_OK && w->fields > 0) {
+        w->st = dc_string_append_char(w->out, '}');
+    }
+    if (w->st != DC_OK) {
+        dc_string_clear(w->out);
+        w->fields = 0;
+    }
+    if (out_fields) *out_fields = w->fields;
+    return w->st;
+}
+
+static void dc_json_patch_raw(dc_json_patch_writer_t* w, const char* text) {
+    if (w->st != DC_OK) return;
+    w->st = dc_string_append_cstr(w->out, text);
+}
+
+static void dc_json_patch_key(dc_json_patch_writer_t* w, const char* key) {
+    if (w->st != DC_OK) return;
+    w->st = dc_string_append_char(w->out, w->fields == 0 ? '{' : ',');
+    if (w->st == DC_OK) w->st = dc_string_append_char(w->out, '"');
+    if (w->st == DC_OK) w->st = dc_string_append_cstr(w->out, key);
+    if (w->st == DC_OK) w->st = dc_string_append_buffer(w->out, "\":", 2);
+    w->fields++;
+}
+
+static void dc_json_patch_str_value(dc_json_patch_writer_t* w, const char* data, size_t length) {
+    if (w->st != DC_OK) return;
+    dc_string_t* out = w->out;
+    dc_status_t st = dc_string_append_char(out, '"');
+    size_t run = 0;
+    for (size_t i = 0; st == DC_OK && i < length; i++) {
+        unsigned char c = (unsigned char)data[i];
+        if (c >= 0x20 && c != '"' && c != '\\') continue;
+        st = dc_string_append_buffer(out, data + run, i - run);
+        run = i + 1;
+        if (st != DC_OK) break;
+        switch (c) {
+            case '"': st = dc_string_append_buffer(out, "\\\"", 2); break;
+            case '\\': st = dc_string_append_buffer(out, "\\\\", 2); break;
+            case '\n': st = dc_string_append_buffer(out, "\\n", 2); break;
+            case '\r': st = dc_string_append_buffer(out, "\\r", 2); break;
+            case '\t': st = dc_string_append_buffer(out, "\\t", 2); break;
+            case '\b': st = dc_string_append_buffer(out, "\\b", 2); break;
+            case '\f': st = dc_string_append_buffer(out, "\\f", 2); break;
+            default: st = dc_string_append_printf(out, "\\u%04x", (unsigned)c); break;
+        }
+    }
+    if (st == DC_OK) st = dc_string_append_buffer(out, data + run, length - run);
+    if (st == DC_OK) st = dc_string_append_char(out, '"');
+    w->st = st;
+}
+
+static void dc_json_patch_id_value(dc_json_patch_writer_t* w, uint64_t value) {
+    if (w->st != DC_OK) return;
+    w->st = dc_string_append_printf(w->out, "\"%" PRIu64 "\"", value);
+}
+
+static void dc_json_patch_string(dc_json_patch_writer_t* w, const char* key, const dc_string_t* value) {
+    dc_json_patch_key(w, key);
+    dc_json_patch_str_value(w, value->data ? value->data : "", value->length);
+}
+
+static void dc_json_patch_string_or_null(dc_json_patch_writer_t* w, const char* key,
+                                         const dc_string_t* value) {
+    if (value->length == 0) {
+        dc_json_patch_key(w, key);
+        dc_json_patch_raw(w, "null");
+        return;
+    }
+    dc_json_patch_string(w, key, value);
+}
+
+static void dc_json_patch_nullable(dc_json_patch_writer_t* w, const char* key,
+                                   const dc_nullable_string_t* value) {
+    if (value->is_null) {
+        dc_json_patch_key(w, key);
+        dc_json_patch_raw(w, "null");
+        return;
+    }
+    dc_json_patch_string(w, key, &value->value);
+}
+
+static void dc_json_patch_int(dc_json_patch_writer_t* w, const char* key, int64_t value) {
+    dc_json_patch_key(w, key);
+    if (w->st != DC_OK) return;
+    w->st = dc_string_append_printf(w->out, "%" PRId64, value);
+}
+
+static void dc_json_patch_uint(dc_json_patch_writer_t* w, const char* key, uint64_t value) {
+    dc_json_patch_key(w, key);
+    if (w->st != DC_OK) return;
+    w->st = dc_string_append_printf(w->out, "%" PRIu64, value);
+}
+
+static void dc_json_patch_bool(dc_json_patch_writer_t* w, const char* key, int value) {
+    dc_json_patch_key(w, key);
+    dc_json_patch_raw(w, value ? "true" : "false");
+}
+
+/* Snowflakes and permission bitsets are JSON strings */
+static void dc_json_patch_id(dc_json_patch_writer_t* w, const char* key, uint64_t value) {
+    dc_json_patch_key(w, key);
+    dc_json_patch_id_value(w, value);
+}
+
+static void dc_json_patch_optional_id(dc_json_patch_writer_t* w, const char* key,
+                                      const dc_optional_snowflake_t* value) {
+    if (!value->is_set) {
+        dc_json_patch_key(w, key);
+        dc_json_patch_raw(w, "null");
+        return;
+    }
+    dc_json_patch_id(w, key, value->value);
+}
+
+static void dc_json_patch_id_array(dc_json_patch_writer_t* w, const char* key, const dc_vec_t* ids) {
+    dc_json_patch_key(w, key);
+    dc_json_patch_raw(w, "[");
+    for (size_t i = 0; i < dc_vec_length(ids); i++) {
+        if (i > 0) dc_json_patch_raw(w, ",");
+        dc_json_patch_id_value(w, *(const dc_snowflake_t*)dc_vec_at(ids, i));
+    }
+    dc_json_patch_raw(w, "]");
+}
+
+static int dc_json_patch_str_eq(const dc_string_t* a, const dc_string_t* b) {
+    if (a->length != b->length) return 0;
+    return a->length == 0 || memcmp(a->data, b->data, a->length) == 0;
+}
+
+static int dc_json_patch_nullable_eq(const dc_nullable_string_t* a, const dc_nullable_string_t* b) {
+    if (a->is_null || b->is_null) return a->is_null == b->is_null;
+    return dc_json_patch_str_eq(&a->value, &b->value);
+}
+
+static int dc_json_patch_optional_str_eq(const dc_optional_string_t* a, const dc_optional_string_t* b) {
+    if (!a->is_set || !b->is_set) return a->is_set == b->is_set;
+    return dc_json_patch_str_eq(&a->value, &b->value);
+}
+
+static int dc_json_patch_optional_id_eq(const dc_optional_snowflake_t* a,
+                                        const dc_optional_snowflake_t* b) {
+    if (!a->is_set || !b->is_set) return a->is_set == b->is_set;
+    return a->value == b->value;
+}
+
+static size_t dc_json_patch_id_count(const dc_vec_t* ids, dc_snowflake_t id) {
+    size_t count = 0;
+    for (size_t i = 0; i < dc_vec_length(ids); i++) {
+        if (*(const dc_snowflake_t*)dc_vec_at(ids, i) == id) count++;
+    }
+    return count;
+}
+
+/*
+ * Role and tag lists are compared as multisets: reordering them is not a
+ * change, but a different count of any ID is.
+ */
+static int dc_json_patch_id_set_eq(const dc_vec_t* a, const dc_vec_t* b) {
+    size_t n = dc_vec_length(a);
+    if (n != dc_vec_length(b)) return 0;
+    for (size_t i = 0; i < n; i++) {
+        dc_snowflake_t id = *(const dc_snowflake_t*)dc_vec_at(a, i);
+        if (dc_json_patch_id_count(a, id) != dc_json_patch_id_count(b, id)) return 0;
+    }
+    return 1;
+}
+
+static int dc_json_patch_overwrites_eq(const dc_vec_t* a, const dc_vec_t* b) {
+    size_t n = dc_vec_length(a);
+    if (n != dc_vec_length(b)) return 0;
+    for (size_t i = 0; i < n; i++) {
+        const dc_permission_overwrite_t* x = (const dc_permission_overwrite_t*)dc_vec_at(a, i);
+        const dc_permission_overwrite_t* y = (const dc_permission_overwrite_t*)dc_vec_at(b, i);
+        if (x->id != y->id || x->type != y->type || x->allow != y->allow || x->deny != y->deny) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static void dc_json_patch_overwrites(dc_json_patch_writer_t* w, const char* key, const dc_vec_t* overwrites) {
+    dc_json_patch_key(w, key);
+    dc_json_patch_raw(w, "[");
+    for (size_t i = 0; i < dc_vec_length(overwrites); i++) {
+        const dc_permission_overwrite_t* ow = (const dc_permission_overwrite_t*)dc_vec_at(overwrites, i);
+        dc_json_patch_raw(w, i > 0 ? ",{\"id\":" : "{\"id\":");
+        dc_json_patch_id_value(w, ow->id);
+        if (w->st == DC_OK) {
+            w->st = dc_string_append_printf(w->out, ",\"type\":%d,\"allow\":\"%" PRIu64
+                                            "\",\"deny\":\"%" PRIu64 "\"}",
+                                            (int)ow->type, ow->allow, ow->deny);
+        }
+    }
+    dc_json_patch_raw(w, "]");
+}
+
+static int dc_json_patch_forum_tags_eq(const dc_vec_t* a, const dc_vec_t* b) {
+    size_t n = dc_vec_length(a);
+    if (n != dc_vec_length(b)) return 0;
+    for (size_t i = 0; i < n; i++) {
+        const dc_channel_forum_tag_t* x = (const dc_channel_forum_tag_t*)dc_vec_at(a, i);
+        const dc_channel_forum_tag_t* y = (const dc_channel_forum_tag_t*)dc_vec_at(b, i);
+        if (x->id != y->id || x->moderated != y->moderated ||
+            !dc_json_patch_str_eq(&x->name, &y->name) ||
+            !dc_json_patch_optional_id_eq(&x->emoji_id, &y->emoji_id) ||
+            !dc_json_patch_optional_str_eq(&x->emoji_name, &y->emoji_name)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static void dc_json_patch_emoji_fields(dc_json_patch_writer_t* w, const dc_optional_snowflake_t* emoji_id,
+                                       const dc_optional_string_t* emoji_name) {
+    dc_json_patch_raw(w, "\"emoji_id\":");
+    if (emoji_id->is_set) {
+        dc_json_patch_id_value(w, emoji_id->value);
+    } else {
+        dc_json_patch_raw(w, "null");
+    }
+    dc_json_patch_raw(w, ",\"emoji_name\":");
+    if (emoji_name->is_set) {
+        dc_json_patch_str_value(w, dc_string_cstr(&emoji_name->value), emoji_name->value.length);
+    } else {
+        dc_json_patch_raw(w, "null");
+    }
+}
+
+static void dc_json_patch_forum_tags(dc_json_patch_writer_t* w, const char* key, const dc_vec_t* tags) {
+    dc_json_patch_key(w, key);
+    dc_json_patch_raw(w, "[");
+    for (size_t i = 0; i < dc_vec_length(tags); i++) {
+        const dc_channel_forum_tag_t* tag = (const dc_channel_forum_tag_t*)dc_vec_at(tags, i);
+        dc_json_patch_raw(w, i > 0 ? ",{" : "{");
+        /* New tags have no ID yet */
+        if (tag->id != 0) {
+            dc_json_patch_raw(w, "\"id\":");
+            dc_json_patch_id_value(w, tag->id);
+            dc_json_patch_raw(w, ",");
+        }
+        dc_json_patch_raw(w, "\"name\":");
+        dc_json_patch_str_value(w, dc_string_cstr(&tag->name), tag->name.length);
+        dc_json_patch_raw(w, tag->moderated ? ",\"moderated\":true," : ",\"moderated\":false,");
+        dc_json_patch_emoji_fields(w, &tag->emoji_id, &tag->emoji_name);
+        dc_json_patch_raw(w, "}");
+    }
+    dc_json_patch_raw(w, "]");
+}
+
+static int dc_json_patch_default_reaction_eq(const dc_channel_t* a, const dc_channel_t* b) {
+    if (!a->has_default_reaction_emoji || !b->has_default_reaction_emoji) {
+        return a->has_default_reaction_emoji == b->has_default_reaction_emoji;
+    }
+    return dc_json_patch_optional_id_eq(&a->default_reaction_emoji.emoji_id,
+                                        &b->default_reaction_emoji.emoji_id) &&
+           dc_json_patch_optional_str_eq(&a->default_reaction_emoji.emoji_name,
+                                         &b->default_reaction_emoji.emoji_name);
+}
+
+static int dc_json_patch_string_set_contains(const dc_vec_t* set, const dc_string_t* value) {
+    for (size_t i = 0; i < dc_vec_length(set); i++) {
+        if (dc_json_patch_str_eq((const dc_string_t*)dc_vec_at(set, i), value)) return 1;
+    }
+    return 0;
+}
+
+static int dc_json_patch_string_set_eq(const dc_vec_t* a, const dc_vec_t* b) {
+    size_t n = dc_vec_length(a);
+    if (n != dc_vec_length(b)) return 0;
+    for (size_t i = 0; i < n; i++) {
+        if (!dc_json_patch_string_set_contains(b, (const dc_string_t*)dc_vec_at(a, i))) return 0;
+        if (!dc_json_patch_string_set_contains(a, (const dc_string_t*)dc_vec_at(b, i))) return 0;
+    }
+    return 1;
+}
+
+static void dc_json_patch_string_array(dc_json_patch_writer_t* w, const char* key, const dc_vec_t* values) {
+    dc_json_patch_key(w, key);
+    dc_json_patch_raw(w, "[");
+    for (size_t i = 0; i < dc_vec_length(values); i++) {
+        const dc_string_t* value = (const dc_string_t*)dc_vec_at(values, i);
+        if (i > 0) dc_json_patch_raw(w, ",");
+        dc_json_patch_str_value(w, dc_string_cstr(value), value->length);
+    }
+    dc_json_patch_raw(w, "]");
+}
+
+static void dc_json_patch_thread(dc_json_patch_writer_t* w, const dc_channel_t* original,
+                                 const dc_channel_t* edited) {
+    static const dc_channel_thread_metadata_t none;
+    const dc_channel_thread_metadata_t* o = original->has_thread_metadata ? &original->thread_metadata : &none;
+    const dc_channel_thread_metadata_t* e = &edited->thread_metadata;
+
+    if (o->archived != e->archived) dc_json_patch_bool(w, "archived", e->archived);
+    if (o->auto_archive_duration != e->auto_archive_duration) {
+        dc_json_patch_int(w, "auto_archive_duration", e->auto_archive_duration);
+    }
+    if (o->locked != e->locked) dc_json_patch_bool(w, "locked", e->locked);
+    if (e->invitable.is_set &&
+        (!o->invitable.is_set || o->invitable.value != e->invitable.value)) {
+        dc_json_patch_bool(w, "invitable", e->invitable.value);
+    }
+}
+
+dc_status_t dc_json_patch_channel(const dc_channel_t* original, const dc_channel_t* edited,
+                                  dc_string_t* out, size_t* out_fields) {
+    if (!original || !edited || !out) return DC_ERROR_NULL_POINTER;
+    if (original->id != edited->id) return DC_ERROR_INVALID_PARAM;
+
+    const dc_channel_t* o = original;
+    const dc_channel_t* e = edited;
+    dc_json_patch_writer_t w;
+    dc_json_patch_begin(&w, out);
+
+    if (!dc_json_patch_str_eq(&o->name, &e->name)) dc_json_patch_string(&w, "name", &e->name);
+    if (o->type != e->type) dc_json_patch_int(&w, "type", (int64_t)e->type);
+    if (o->position != e->position) dc_json_patch_int(&w, "position", e->position);
+    if (!dc_json_patch_str_eq(&o->topic, &e->topic)) dc_json_patch_string_or_null(&w, "topic", &e->topic);
+    if (o->nsfw != e->nsfw) dc_json_patch_bool(&w, "nsfw", e->nsfw);
+    if (o->rate_limit_per_user != e->rate_limit_per_user) {
+        dc_json_patch_int(&w, "rate_limit_per_user", e->rate_limit_per_user);
+    }
+    if (o->bitrate != e->bitrate) dc_json_patch_int(&w, "bitrate", e->bitrate);
+    if (o->user_limit != e->user_limit) dc_json_patch_int(&w, "user_limit", e->user_limit);
+    if (!dc_json_patch_overwrites_eq(&o->permission_overwrites, &e->permission_overwrites)) {
+        dc_json_patch_overwrites(&w, "permission_overwrites", &e->permission_overwrites);
+    }
+    if (!dc_json_patch_optional_id_eq(&o->parent_id, &e->parent_id)) {
+        dc_json_patch_optional_id(&w, "parent_id", &e->parent_id);
+    }
+    if (!dc_json_patch_str_eq(&o->rtc_region, &e->rtc_region)) {
+        dc_json_patch_string_or_null(&w, "rtc_region", &e->rtc_region);
+    }
+    if (o->video_quality_mode != e->video_quality_mode) {
+        dc_json_patch_int(&w, "video_quality_mode", e->video_quality_mode);
+    }
+    if (o->default_auto_archive_duration != e->default_auto_archive_duration) {
+        dc_json_patch_int(&w, "default_auto_archive_duration", e->default_auto_archive_duration);
+    }
+    if (o->flags != e->flags) dc_json_patch_uint(&w, "flags", e->flags);
+    if (!dc_json_patch_forum_tags_eq(&o->available_tags, &e->available_tags)) {
+        dc_json_patch_forum_tags(&w, "available_tags", &e->available_tags);
+    }
+    if (!dc_json_patch_default_reaction_eq(o, e)) {
+        dc_json_patch_key(&w, "default_reaction_emoji");
+        if (e->has_default_reaction_emoji) {
+            dc_json_patch_raw(&w, "{");
+            dc_json_patch_emoji_fields(&w, &e->default_reaction_emoji.emoji_id,
+                                       &e->default_reaction_emoji.emoji_name);
+            dc_json_patch_raw(&w, "}");
+        } else {
+            dc_json_patch_raw(&w, "null");
+        }
+    }
+    if (o->default_thread_rate_limit_per_user != e->default_thread_rate_limit_per_user) {
+        dc_json_patch_int(&w, "default_thread_rate_limit_per_user", e->default_thread_rate_limit_per_user);
+    }
+    if (o->default_sort_order != e->default_sort_order) {
+        dc_json_patch_int(&w, "default_sort_order", e->default_sort_order);
+    }
+    if (o->default_forum_layout != e->default_forum_layout) {
+        dc_json_patch_int(&w, "default_forum_layout", e->default_forum_layout);
+    }
+    if (!dc_json_patch_id_set_eq(&o->applied_tags, &e->applied_tags)) {
+        dc_json_patch_id_array(&w, "applied_tags", &e->applied_tags);
+    }
+    if (e->has_thread_metadata) dc_json_patch_thread(&w, o, e);
+
+    return dc_json_patch_end(&w, out_fields);
+}
+
+dc_status_t dc_json_patch_role(const dc_role_t* original, const dc_role_t* edited,
+                               dc_string_t* out, size_t* out_fields) {
+    if (!original || !edited || !out) return DC_ERROR_NULL_POINTER;
+    if (original->id != edited->id) return DC_ERROR_INVALID_PARAM;
+
+    const dc_role_t* o = original;
+    const dc_role_t* e = edited;
+    dc_json_patch_writer_t w;
+    dc_json_patch_begin(&w, out);
+
+    if (!dc_json_patch_str_eq(&o->name, &e->name)) dc_json_patch_string(&w, "name", &e->name);
+    if (o->permissions != e->permissions) dc_json_patch_id(&w, "permissions", e->permissions);
+    if (o->color != e->color) dc_json_patch_uint(&w, "color", e->color);
+    if (o->hoist != e->hoist) dc_json_patch_bool(&w, "hoist", e->hoist);
+    if (!dc_json_patch_nullable_eq(&o->icon, &e->icon)) dc_json_patch_nullable(&w, "icon", &e->icon);
+    if (!dc_json_patch_nullable_eq(&o->unicode_emoji, &e->unicode_emoji)) {
+        dc_json_patch_nullable(&w, "unicode_emoji", &e->unicode_emoji);
+    }
+    if (o->mentionable != e->mentionable) dc_json_patch_bool(&w, "mentionable", e->mentionable);
+
+    return dc_json_patch_end(&w, out_fields);
+}
+
+dc_status_t dc_json_patch_guild_member(const dc_guild_member_t* original,
+                                       const dc_guild_member_t* edited,
+                                       dc_string_t* out, size_t* out_fields) {
+    if (!original || !edited || !out) return DC_ERROR_NULL_POINTER;
+    if (original->has_user && edited->has_user && original->user.id != edited->user.id) {
+        return DC_ERROR_INVALID_PARAM;
+    }
+
+    const dc_guild_member_t* o = original;
+    const dc_guild_member_t* e = edited;
+    dc_json_patch_writer_t w;
+    dc_json_patch_begin(&w, out);
+
+    if (!dc_json_patch_nullable_eq(&o->nick, &e->nick)) dc_json_patch_nullable(&w, "nick", &e->nick);
+    if (!dc_json_patch_id_set_eq(&o->roles, &e->roles)) dc_json_patch_id_array(&w, "roles", &e->roles);
+    if (o->mute != e->mute) dc_json_patch_bool(&w, "mute", e->mute);
+    if (o->deaf != e->deaf) dc_json_patch_bool(&w, "deaf", e->deaf);
+    if (!dc_json_patch_nullable_eq(&o->communication_disabled_until, &e->communication_disabled_until)) {
+        dc_json_patch_nullable(&w, "communication_disabled_until", &e->communication_disabled_until);
+    }
+    if (o->flags != e->flags) dc_json_patch_uint(&w, "flags", e->flags);
+
+    return dc_json_patch_end(&w, out_fields);
+}
+
+dc_status_t dc_json_patch_guild(const dc_guild_t* original, const dc_guild_t* edited,
+                                dc_string_t* out, size_t* out_fields) {
+    if (!original || !edited || !out) return DC_ERROR_NULL_POINTER;
+    if (original->id != edited->id) return DC_ERROR_INVALID_PARAM;
+
+    const dc_guild_t* o = original;
+    const dc_guild_t* e = edited;
+    dc_json_patch_writer_t w;
+    dc_json_patch_begin(&w, out);
+
+    if (!dc_json_patch_str_eq(&o->name, &e->name)) dc_json_patch_string(&w, "name", &e->name);
+    if (o->verification_level != e->verification_level) {
+        dc_json_patch_int(&w, "verification_level", e->verification_level);
+    }
+    if (o->default_message_notifications != e->default_message_notifications) {
+        dc_json_patch_int(&w, "default_message_notifications", e->default_message_notifications);
+    }
+    if (o->explicit_content_filter != e->explicit_content_filter) {
+        dc_json_patch_int(&w, "explicit_content_filter", e->explicit_content_filter);
+    }
+    if (!dc_json_patch_optional_id_eq(&o->afk_channel_id, &e->afk_channel_id)) {
+        dc_json_patch_optional_id(&w, "afk_channel_id", &e->afk_channel_id);
+    }
+    if (o->afk_timeout != e->afk_timeout) dc_json_patch_int(&w, "afk_timeout", e->afk_timeout);
+    if (!dc_json_patch_nullable_eq(&o->icon, &e->icon)) dc_json_patch_nullable(&w, "icon", &e->icon);
+    if (e->owner_id.is_set && !dc_json_patch_optional_id_eq(&o->owner_id, &e->owner_id)) {
+        dc_json_patch_id(&w, "owner_id", e->owner_id.value);
+    }
+    if (!dc_json_patch_nullable_eq(&o->splash, &e->splash)) dc_json_patch_nullable(&w, "splash", &e->splash);
+    if (!dc_json_patch_nullable_eq(&o->discovery_splash, &e->discovery_splash)) {
+        dc_json_patch_nullable(&w, "discovery_splash", &e->discovery_splash);
+    }
+    if (!dc_json_patch_nullable_eq(&o->banner, &e->banner)) dc_json_patch_nullable(&w, "banner", &e->banner);
+    if (!dc_json_patch_optional_id_eq(&o->system_channel_id, &e->system_channel_id)) {
+        dc_json_patch_optional_id(&w, "system_channel_id", &e->system_channel_id);
+    }
+    if (o->system_channel_flags != e->system_channel_flags) {
+        dc_json_patch_uint(&w, "system_channel_flags", e->system_channel_flags);
+    }
+    if (!dc_json_patch_optional_id_eq(&o->rules_channel_id, &e->rules_channel_id)) {
+        dc_json_patch_optional_id(&w, "rules_channel_id", &e->rules_channel_id);
+    }
+    if (!dc_json_patch_optional_id_eq(&o->public_updates_channel_id, &e->public_updates_channel_id)) {
+        dc_json_patch_optional_id(&w, "public_updates_channel_id", &e->public_updates_channel_id);
+    }
+    if (!dc_json_patch_str_eq(&o->preferred_locale, &e->preferred_locale)) {
+        dc_json_patch_string_or_null(&w, "preferred_locale", &e->preferred_locale);
+    }
+    if (!dc_json_patch_string_set_eq(&o->features, &e->features)) {
+        dc_json_patch_string_array(&w, "features", &e->features);
+    }
+    if (!dc_json_patch_nullable_eq(&o->description, &e->description)) {
+        dc_json_patch_nullable(&w, "description", &e->description);
+    }
+    if (o->premium_progress_bar_enabled != e->premium_progress_bar_enabled) {
+        dc_json_patch_bool(&w, "premium_progress_bar_enabled", e->premium_progress_bar_enabled);
+    }
+    if (!dc_json_patch_optional_id_eq(&o->safety_alerts_channel_id, &e->safety_alerts_channel_id)) {
+        dc_json_patch_optional_id(&w, "safety_alerts_channel_id", &e->safety_alerts_channel_id);
+    }
+
+    return dc_json_patch_end(&w, out_fields);
+}
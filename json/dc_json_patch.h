@@ -0,0 +1,107 @@
+#ifndef DC_JSON_PATCH_H
+#define DC_JSON_PATCH_H
+
+/**
+ * @file dc_json_patch.h
+ * @brief Minimal PATCH bodies from model diffs
+ *
+ * Each builder compares an original model (as fetched) with an edited copy
+ * and writes a JSON object holding only the writable fields that changed.
+ * The body is written straight into @p out, which is cleared first but
+ * keeps its capacity, so one buffer can serve every PATCH a caller makes.
+ * When nothing changed, @p out is left empty and the request can be skipped.
+ *
+ * Fields follow the model's conventions for "absent": an unset optional
+ * snowflake, a null nullable string, or an empty topic/rtc_region in the
+ * edited model is sent as JSON null when it differs from the original.
+ * Read-only fields (IDs, counts, timestamps, managed flags) are never sent.
+ */
+
+#include <stddef.h>
+#include "core/dc_status.h"
+#include "core/dc_string.h"
+#include "model/dc_channel.h"
+#include "model/dc_role.h"
+#include "model/dc_guild_member.h"
+#include "model/dc_guild.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Build PATCH /channels/{channel.id} body
+ *
+ * Compares name, type, position, topic, nsfw, rate_limit_per_user, bitrate,
+ * user_limit, permission_overwrites, parent_id, rtc_region,
+ * video_quality_mode, default_auto_archive_duration, flags, available_tags,
+ * default_reaction_emoji, default_thread_rate_limit_per_user,
+ * default_sort_order, default_forum_layout and applied_tags. For threads
+ * (edited has thread_metadata), also archived, auto_archive_duration, locked
+ * and invitable.
+ *
+ * @param original Channel as fetched
+ * @param edited Channel with changes applied (same ID)
+ * @param out Output body (empty if nothing changed)
+ * @param out_fields Optional; receives the number of fields written
+ * @return DC_OK on success, DC_ERROR_INVALID_PARAM if the IDs differ
+ */
+dc_status_t dc_json_patch_channel(const dc_channel_t* original, const dc_channel_t* edited,
+                                  dc_string_t* out, size_t* out_fields);
+
+/**
+ * @brief Build PATCH /guilds/{guild.id}/roles/{role.id} body
+ *
+ * Compares name, permissions, color, hoist, icon, unicode_emoji and
+ * mentionable. Position has its own endpoint and is not compared.
+ *
+ * @param original Role as fetched
+ * @param edited Role with changes applied (same ID)
+ * @param out Output body (empty if nothing changed)
+ * @param out_fields Optional; receives the number of fields written
+ * @return DC_OK on success, DC_ERROR_INVALID_PARAM if the IDs differ
+ */
+dc_status_t dc_json_patch_role(const dc_role_t* original, const dc_role_t* edited,
+                               dc_string_t* out, size_t* out_fields);
+
+/**
+ * @brief Build PATCH /guilds/{guild.id}/members/{user.id} body
+ *
+ * Compares nick, roles (order-insensitive), mute, deaf,
+ * communication_disabled_until and flags.
+ *
+ * @param original Member as fetched
+ * @param edited Member with changes applied
+ * @param out Output body (empty if nothing changed)
+ * @param out_fields Optional; receives the number of fields written
+ * @return DC_OK on success, DC_ERROR_INVALID_PARAM if both carry a user and the user IDs differ
+ */
+dc_status_t dc_json_patch_guild_member(const dc_guild_member_t* original,
+                                       const dc_guild_member_t* edited,
+                                       dc_string_t* out, size_t* out_fields);
+
+/**
+ * @brief Build PATCH /guilds/{guild.id} body
+ *
+ * Compares name, verification_level, default_message_notifications,
+ * explicit_content_filter, afk_channel_id, afk_timeout, icon, owner_id,
+ * splash, discovery_splash, banner, system_channel_id, system_channel_flags,
+ * rules_channel_id, public_updates_channel_id, preferred_locale, features,
+ * description, premium_progress_bar_enabled and safety_alerts_channel_id.
+ * Image fields are sent as stored, so set them to a data URI to upload a
+ * new image. An unset owner_id is never sent.
+ *
+ * @param original Guild as fetched
+ * @param edited Guild with changes applied (same ID)
+ * @param out Output body (empty if nothing changed)
+ * @param out_fields Optional; receives the number of fields written
+ * @return DC_OK on success, DC_ERROR_INVALID_PARAM if the IDs differ
+ */
+dc_status_t dc_json_patch_guild(const dc_guild_t* original, const dc_guild_t* edited,
+                                dc_string_t* out, size_t* out_fields);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DC_JSON_PATCH_H */
@@ -0,0 +1,154 @@
+/**
+ * @file dc_component_node.c
+ * @brief Compact component tree implementation
+ */
+
+#include "model/dc_component_node.h"
+#include <string.h>
+
+void dc_component_media_init(dc_component_media_t* media) {
+    if (!media) return;
+    memset(media, 0, sizeof(*media));
+    media->width = DC_COMPONENT_UNSET;
+    media->height = DC_COMPONENT_UNSET;
+}
+
+void dc_component_option_init(dc_component_option_t* option) {
+    if (!option) return;
+    memset(option, 0, sizeof(*option));
+    option->default_val = DC_COMPONENT_BOOL_UNSET;
+}
+
+void dc_component_media_entry_init(dc_component_media_entry_t* entry) {
+    if (!entry) return;
+    memset(entry, 0, sizeof(*entry));
+    dc_component_media_init(&entry->media);
+    entry->spoiler = DC_COMPONENT_BOOL_UNSET;
+}
+
+static void dc_component_select_init(dc_component_select_t* select) {
+    select->min_values = DC_COMPONENT_UNSET;
+    select->max_values = DC_COMPONENT_UNSET;
+    select->disabled = DC_COMPONENT_BOOL_UNSET;
+    select->required = DC_COMPONENT_BOOL_UNSET;
+}
+
+dc_status_t dc_component_node_create(dc_arena_t* arena, dc_component_type_t type,
+                                     dc_component_node_t** out) {
+    if (!arena || !out) return DC_ERROR_NULL_POINTER;
+    *out = NULL;
+    dc_component_node_t* node = (dc_component_node_t*)dc_arena_alloc(arena, sizeof(*node));
+    if (!node) return DC_ERROR_OUT_OF_MEMORY;
+
+    node->type = type;
+    node->id = DC_COMPONENT_UNSET;
+    switch (type) {
+        case DC_COMPONENT_TYPE_BUTTON:
+            node->as.button.style = DC_COMPONENT_UNSET;
+            node->as.button.disabled = DC_COMPONENT_BOOL_UNSET;
+            break;
+        case DC_COMPONENT_TYPE_STRING_SELECT:
+        case DC_COMPONENT_TYPE_USER_SELECT:
+        case DC_COMPONENT_TYPE_ROLE_SELECT:
+        case DC_COMPONENT_TYPE_MENTIONABLE_SELECT:
+        case DC_COMPONENT_TYPE_CHANNEL_SELECT:
+        case DC_COMPONENT_TYPE_FILE_UPLOAD:
+        case DC_COMPONENT_TYPE_RADIO_GROUP:
+        case DC_COMPONENT_TYPE_CHECKBOX_GROUP:
+            dc_component_select_init(&node->as.select);
+            break;
+        case DC_COMPONENT_TYPE_TEXT_INPUT:
+            node->as.text_input.style = DC_COMPONENT_UNSET;
+            node->as.text_input.min_length = DC_COMPONENT_UNSET;
+            node->as.text_input.max_length = DC_COMPONENT_UNSET;
+            node->as.text_input.required = DC_COMPONENT_BOOL_UNSET;
+            break;
+        case DC_COMPONENT_TYPE_THUMBNAIL:
+            dc_component_media_entry_init(&node->as.thumbnail);
+            break;
+        case DC_COMPONENT_TYPE_FILE:
+            dc_component_media_init(&node->as.file.file);
+            node->as.file.spoiler = DC_COMPONENT_BOOL_UNSET;
+            node->as.file.size = DC_COMPONENT_UNSET;
+            break;
+        case DC_COMPONENT_TYPE_SEPARATOR:
+            node->as.separator.divider = DC_COMPONENT_BOOL_UNSET;
+            node->as.separator.spacing = DC_COMPONENT_UNSET;
+            break;
+        case DC_COMPONENT_TYPE_CONTAINER:
+            node->as.container.accent_color = DC_COMPONENT_UNSET;
+            node->as.container.spoiler = DC_COMPONENT_BOOL_UNSET;
+            break;
+        case DC_COMPONENT_TYPE_CHECKBOX:
+            node->as.checkbox.default_val = DC_COMPONENT_BOOL_UNSET;
+            node->as.checkbox.value = DC_COMPONENT_BOOL_UNSET;
+            break;
+        default:
+            break;
+    }
+
+    *out = node;
+    return DC_OK;
+}
+
+dc_component_children_t* dc_component_node_children(dc_component_node_t* node) {
+    if (!node) return NULL;
+    switch (node->type) {
+        case DC_COMPONENT_TYPE_ACTION_ROW: return &node->as.action_row;
+        case DC_COMPONENT_TYPE_SECTION: return &node->as.section.components;
+        case DC_COMPONENT_TYPE_CONTAINER: return &node->as.container.components;
+        default: return NULL;
+    }
+}
+
+dc_status_t dc_component_children_append(dc_component_children_t* list, dc_component_node_t* node) {
+    if (!list || !node) return DC_ERROR_NULL_POINTER;
+    node->next = NULL;
+    if (list->last) {
+        list->last->next = node;
+    } else {
+        list->first = node;
+    }
+    list->last = node;
+    list->count++;
+    return DC_OK;
+}
+
+dc_status_t dc_component_node_append(dc_component_node_t* parent, dc_component_node_t* child) {
+    if (!parent || !child) return DC_ERROR_NULL_POINTER;
+    dc_component_children_t* children = dc_component_node_children(parent);
+    if (!children) return DC_ERROR_INVALID_PARAM;
+    return dc_component_children_append(children, child);
+}
+
+/* Read-only twin of dc_component_node_children(). */
+static const dc_component_children_t* dc_component_node_children_of(const dc_component_node_t* node) {
+    switch (node->type) {
+        case DC_COMPONENT_TYPE_ACTION_ROW: return &node->as.action_row;
+        case DC_COMPONENT_TYPE_SECTION: return &node->as.section.components;
+        case DC_COMPONENT_TYPE_CONTAINER: return &node->as.container.components;
+        default: return NULL;
+    }
+}
+
+static size_t dc_component_node_count(const dc_component_node_t* node) {
+    size_t total = 1;
+    const dc_component_children_t* children = dc_component_node_children_of(node);
+    if (children) total += dc_component_tree_count(children);
+    if (node->type == DC_COMPONENT_TYPE_SECTION && node->as.section.accessory) {
+        total += dc_component_node_count(node->as.section.accessory);
+    }
+    if (node->type == DC_COMPONENT_TYPE_LABEL && node->as.label.component) {
+        total += dc_component_node_count(node->as.label.component);
+    }
+    return total;
+}
+
+size_t dc_component_tree_count(const dc_component_children_t* list) {
+    if (!list) return 0;
+    size_t total = 0;
+    for (const dc_component_node_t* node = list->first; node; node = node->next) {
+        total += dc_component_node_count(node);
+    }
+    return total;
+}
@@ -0,0 +1,288 @@
+#ifndef DC_COMPONENT_NODE_H
+#define DC_COMPONENT_NODE_H
+
+/**
+ * @file dc_component_node.h
+ * @brief Compact component tree (tagged union, arena-allocated)
+ *
+ * dc_component_t holds every field of every component type, so each button
+ * carries select options, media and text-display fields it never uses. A
+ * dc_component_node_t is a type tag plus a union holding only the fields of
+ * that type. Nodes, strings and arrays all live in one dc_arena_t: building
+ * or decoding a tree costs a few block allocations, and the whole tree is
+ * released with dc_arena_reset() or dc_arena_free().
+ *
+ * Conventions: absent strings are NULL, absent integers are
+ * DC_COMPONENT_UNSET, absent booleans are DC_COMPONENT_BOOL_UNSET and absent
+ * snowflakes are 0. Children are singly linked through @c next.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include "core/dc_arena.h"
+#include "core/dc_status.h"
+#include "core/dc_snowflake.h"
+#include "model/dc_component.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define DC_COMPONENT_UNSET      INT32_MIN
+#define DC_COMPONENT_BOOL_UNSET ((int8_t)-1)
+
+typedef struct dc_component_node dc_component_node_t;
+
+/**
+ * @brief Child list of an action row, section or container
+ */
+typedef struct {
+    dc_component_node_t* first;
+    dc_component_node_t* last;
+    size_t count;
+} dc_component_children_t;
+
+/**
+ * @brief Partial emoji
+ */
+typedef struct {
+    dc_snowflake_t id;
+    const char* name;
+    int8_t animated;
+} dc_component_emoji_t;
+
+/**
+ * @brief Unfurled media item
+ */
+typedef struct {
+    const char* url;
+    const char* proxy_url;
+    const char* content_type;
+    int32_t width;
+    int32_t height;
+    dc_snowflake_t attachment_id;
+} dc_component_media_t;
+
+/**
+ * @brief Select, radio group or checkbox group option
+ */
+typedef struct {
+    const char* label;
+    const char* value;
+    const char* description;
+    dc_component_emoji_t* emoji;
+    int8_t default_val;
+} dc_component_option_t;
+
+/**
+ * @brief Thumbnail, or one media gallery item
+ */
+typedef struct {
+    dc_component_media_t media;
+    const char* description;
+    int8_t spoiler;
+} dc_component_media_entry_t;
+
+/**
+ * @brief Button (type 2)
+ */
+typedef struct {
+    int32_t style;
+    const char* custom_id;
+    const char* label;
+    dc_component_emoji_t* emoji;
+    const char* url;
+    dc_snowflake_t sku_id;
+    int8_t disabled;
+} dc_component_button_t;
+
+/**
+ * @brief Selects (3, 5-8), file upload (19), radio group (21), checkbox group (22)
+ *
+ * @c values holds submitted values from interactions as sent, so the
+ * auto-populated selects carry decimal IDs.
+ */
+typedef struct {
+    const char* custom_id;
+    const char* placeholder;
+    int32_t min_values;
+    int32_t max_values;
+    int8_t disabled;
+    int8_t required;
+    int8_t has_values;
+    dc_component_option_t* options;
+    size_t option_count;
+    dc_select_default_value_t* default_values;
+    size_t default_value_count;
+    int32_t* channel_types;
+    size_t channel_type_count;
+    const char** values;
+    size_t value_count;
+} dc_component_select_t;
+
+/**
+ * @brief Text input (type 4)
+ */
+typedef struct {
+    const char* custom_id;
+    int32_t style;
+    const char* label;
+    int32_t min_length;
+    int32_t max_length;
+    int8_t required;
+    const char* value;
+    const char* placeholder;
+} dc_component_text_input_t;
+
+/**
+ * @brief Section (type 9)
+ */
+typedef struct {
+    dc_component_children_t components;
+    dc_component_node_t* accessory;
+} dc_component_section_t;
+
+/**
+ * @brief File (type 13)
+ */
+typedef struct {
+    dc_component_media_t file;
+    int8_t spoiler;
+    const char* name;
+    int32_t size;
+} dc_component_file_t;
+
+/**
+ * @brief Separator (type 14)
+ */
+typedef struct {
+    int8_t divider;
+    int32_t spacing;
+} dc_component_separator_t;
+
+/**
+ * @brief Container (type 17)
+ */
+typedef struct {
+    dc_component_children_t components;
+    int32_t accent_color;
+    int8_t spoiler;
+} dc_component_container_t;
+
+/**
+ * @brief Label (type 18)
+ */
+typedef struct {
+    const char* label;
+    const char* description;
+    dc_component_node_t* component;
+} dc_component_label_t;
+
+/**
+ * @brief Checkbox (type 23)
+ */
+typedef struct {
+    const char* custom_id;
+    int8_t default_val;
+    int8_t value;
+} dc_component_checkbox_t;
+
+/**
+ * @brief Component node
+ *
+ * Read the union member matching @c type: action_row (1), button (2),
+ * select (3, 5-8, 19, 21, 22), text_input (4), section (9), text_display
+ * (10), thumbnail (11), media_gallery (12), file (13), separator (14),
+ * container (17), label (18), checkbox (23). Unknown types keep only
+ * their type and id.
+ */
+struct dc_component_node {
+    dc_component_type_t type;
+    int32_t id;
+    int uses_component_type;        /**< Decoded from "component_type"; encode the same way */
+    dc_component_node_t* next;      /**< Next sibling */
+    union {
+        dc_component_children_t action_row;
+        dc_component_button_t button;
+        dc_component_select_t select;
+        dc_component_text_input_t text_input;
+        dc_component_section_t section;
+        struct {
+            const char* content;
+        } text_display;
+        dc_component_media_entry_t thumbnail;
+        struct {
+            dc_component_media_entry_t* items;
+            size_t item_count;
+        } media_gallery;
+        dc_component_file_t file;
+        dc_component_separator_t separator;
+        dc_component_container_t container;
+        dc_component_label_t label;
+        dc_component_checkbox_t checkbox;
+    } as;
+};
+
+/**
+ * @brief Allocate a node with every field of its type absent
+ * @param arena Arena that owns the node
+ * @param type Component type
+ * @param out Receives the node
+ * @return DC_OK on success, error code on failure
+ */
+dc_status_t dc_component_node_create(dc_arena_t* arena, dc_component_type_t type,
+                                     dc_component_node_t** out);
+
+/**
+ * @brief Child list of an action row, section or container
+ * @param node Node
+ * @return Child list, or NULL for types without children
+ */
+dc_component_children_t* dc_component_node_children(dc_component_node_t* node);
+
+/**
+ * @brief Append a child to an action row, section or container
+ * @param parent Parent node
+ * @param child Child node (must not be linked elsewhere)
+ * @return DC_OK on success, DC_ERROR_INVALID_PARAM if @p parent has no children
+ */
+dc_status_t dc_component_node_append(dc_component_node_t* parent, dc_component_node_t* child);
+
+/**
+ * @brief Append a node to a top-level list
+ * @param list List (zero-initialized when empty)
+ * @param node Node (must not be linked elsewhere)
+ * @return DC_OK on success, error code on failure
+ */
+dc_status_t dc_component_children_append(dc_component_children_t* list, dc_component_node_t* node);
+
+/**
+ * @brief Reset media fields to absent
+ * @param media Media item
+ */
+void dc_component_media_init(dc_component_media_t* media);
+
+/**
+ * @brief Reset option fields to absent
+ * @param option Option
+ */
+void dc_component_option_init(dc_component_option_t* option);
+
+/**
+ * @brief Reset thumbnail/gallery item fields to absent
+ * @param entry Media entry
+ */
+void dc_component_media_entry_init(dc_component_media_entry_t* entry);
+
+/**
+ * @brief Count nodes in a tree, including accessories and label children
+ * @param list Top-level list
+ * @return Node count
+ */
+size_t dc_component_tree_count(const dc_component_children_t* list);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DC_COMPONENT_NODE_H */
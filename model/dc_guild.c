@@ -562,6 +562,7 @@ static dc_status_t dc_guild_capture_optional_raw_json(yyjson_val* obj,
                                                       const char* key,
                                                       int require_array,
                                                       int require_object,
+                                                      uint32_t capture,
                                                       int* has_field,
                                                       dc_string_t* out) {
     if (!obj || !key || !has_field || !out) return DC_ERROR_NULL_POINTER;
@@ -576,7 +577,9 @@ static dc_status_t dc_guild_capture_optional_raw_json(yyjson_val* obj,
     if (require_array && !yyjson_is_arr(field)) return DC_ERROR_INVALID_FORMAT;
     if (require_object && !yyjson_is_obj(field)) return DC_ERROR_INVALID_FORMAT;
 
-    dc_status_t st = dc_guild_copy_raw_json(field, out);
+    dc_status_t st = dc_json_model_raw_capture_enabled(capture)
+        ? dc_guild_copy_raw_json(field, out)
+        : dc_string_clear(out);
     if (st != DC_OK) return st;
 
     *has_field = 1;
@@ -1076,17 +1079,19 @@ dc_status_t dc_json_model_guild_from_val(yyjson_val* val, dc_guild_t* guild) {
 
     st = dc_guild_get_optional_snowflake(val, "safety_alerts_channel_id", &guild->safety_alerts_channel_id);
     if (st != DC_OK) return st;
-    st = dc_guild_capture_optional_raw_json(val, "roles", 1, 0, &guild->has_roles, &guild->roles_json);
+    st = dc_guild_capture_optional_raw_json(val, "roles", 1, 0, DC_JSON_RAW_CAPTURE_GUILD_ROLES,
+                                            &guild->has_roles, &guild->roles_json);
     if (st != DC_OK) return st;
-    st = dc_guild_capture_optional_raw_json(val, "emojis", 1, 0, &guild->has_emojis, &guild->emojis_json);
+    st = dc_guild_capture_optional_raw_json(val, "emojis", 1, 0, DC_JSON_RAW_CAPTURE_GUILD_EMOJIS,
+                                            &guild->has_emojis, &guild->emojis_json);
     if (st != DC_OK) return st;
-    st = dc_guild_capture_optional_raw_json(val, "welcome_screen", 0, 1,
+    st = dc_guild_capture_optional_raw_json(val, "welcome_screen", 0, 1, DC_JSON_RAW_CAPTURE_GUILD_WELCOME_SCREEN,
                                             &guild->has_welcome_screen, &guild->welcome_screen_json);
     if (st != DC_OK) return st;
-    st = dc_guild_capture_optional_raw_json(val, "stickers", 1, 0,
+    st = dc_guild_capture_optional_raw_json(val, "stickers", 1, 0, DC_JSON_RAW_CAPTURE_GUILD_STICKERS,
                                             &guild->has_stickers, &guild->stickers_json);
     if (st != DC_OK) return st;
-    st = dc_guild_capture_optional_raw_json(val, "incidents_data", 0, 1,
+    st = dc_guild_capture_optional_raw_json(val, "incidents_data", 0, 1, DC_JSON_RAW_CAPTURE_GUILD_INCIDENTS_DATA,
                                             &guild->has_incidents_data, &guild->incidents_data_json);
     if (st != DC_OK) return st;
 
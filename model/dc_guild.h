@@ -107,19 +107,19 @@ typedef struct {
     dc_vec_t features;                             /**< Guild feature list (dc_string_t) */
     int has_roles;                                 /**< Whether roles was present */
     dc_role_list_t roles;                          /**< Parsed role objects */
-    dc_string_t roles_json;                        /**< Raw roles array JSON */
+    dc_string_t roles_json;                        /**< Raw roles array JSON (opt-in, see dc_json_model_set_raw_capture) */
     int has_emojis;                                /**< Whether emojis was present */
     dc_guild_emoji_list_t emojis;                  /**< Parsed emoji objects */
-    dc_string_t emojis_json;                       /**< Raw emojis array JSON */
+    dc_string_t emojis_json;                       /**< Raw emojis array JSON (opt-in) */
     int has_welcome_screen;                        /**< Whether welcome_screen was present */
     dc_guild_welcome_screen_t welcome_screen;      /**< Parsed welcome_screen object */
-    dc_string_t welcome_screen_json;               /**< Raw welcome_screen object JSON */
+    dc_string_t welcome_screen_json;               /**< Raw welcome_screen object JSON (opt-in) */
     int has_stickers;                              /**< Whether stickers was present */
     dc_guild_sticker_list_t stickers;              /**< Parsed sticker objects */
-    dc_string_t stickers_json;                     /**< Raw stickers array JSON */
+    dc_string_t stickers_json;                     /**< Raw stickers array JSON (opt-in) */
     int has_incidents_data;                        /**< Whether incidents_data was present */
     dc_guild_incidents_data_t incidents_data;      /**< Parsed incidents_data object */
-    dc_string_t incidents_data_json;               /**< Raw incidents_data object JSON */
+    dc_string_t incidents_data_json;               /**< Raw incidents_data object JSON (opt-in) */
     int premium_tier;                              /**< Boost tier */
     dc_optional_i32_t premium_subscription_count;  /**< Optional boost count */
     dc_string_t preferred_locale;                  /**< Preferred locale */
@@ -0,0 +1,58 @@
+/**
+ * @file test_arena.c
+ * @brief Arena allocator tests
+ */
+
+#include "test_utils.h"
+#include "core/dc_arena.h"
+#include <stdalign.h>
+#include <stdint.h>
+#include <string.h>
+
+int test_arena_main(void) {
+    TEST_SUITE_BEGIN("Arena Tests");
+
+    dc_arena_t arena;
+    TEST_ASSERT_EQ(DC_OK, dc_arena_init(&arena, 256), "arena init");
+    TEST_ASSERT_EQ(0u, dc_arena_capacity(&arena), "init allocates nothing");
+    TEST_ASSERT_NULL(dc_arena_alloc(&arena, 0), "zero-size alloc");
+
+    unsigned char* a = (unsigned char*)dc_arena_alloc(&arena, 3);
+    unsigned char* b = (unsigned char*)dc_arena_alloc(&arena, 40);
+    TEST_ASSERT(a != NULL && b != NULL, "small allocs");
+    TEST_ASSERT_EQ(0u, (uintptr_t)b % alignof(max_align_t), "allocs are aligned");
+    TEST_ASSERT(b >= a + 3, "allocs do not overlap");
+    TEST_ASSERT_EQ(0, b[39], "allocs are zeroed");
+    TEST_ASSERT_EQ(256u, dc_arena_capacity(&arena), "one block");
+
+    /* Larger than a quarter block: own block, current block keeps filling */
+    unsigned char* big = (unsigned char*)dc_arena_alloc(&arena, 1000);
+    TEST_ASSERT(big != NULL, "oversized alloc");
+    memset(big, 0xAB, 1000);
+    unsigned char* c = (unsigned char*)dc_arena_alloc(&arena, 8);
+    TEST_ASSERT(c != NULL && c < a + 256 && c > a, "current block reused after oversized alloc");
+
+    int ok = 1;
+    for (int i = 0; i < 100; i++) {
+        if (!dc_arena_alloc(&arena, 24)) ok = 0;
+    }
+    TEST_ASSERT(ok, "allocs across blocks");
+
+    char* s = dc_arena_strdup(&arena, "hello");
+    TEST_ASSERT_STR_EQ("hello", s, "strdup");
+    char* n = dc_arena_strndup(&arena, "world!", 5);
+    TEST_ASSERT_STR_EQ("world", n, "strndup terminates");
+    TEST_ASSERT_NULL(dc_arena_strdup(&arena, NULL), "strdup NULL");
+    TEST_ASSERT_NULL(dc_arena_calloc(&arena, SIZE_MAX / 2, 4), "calloc overflow");
+
+    dc_arena_reset(&arena);
+    TEST_ASSERT_EQ(256u, dc_arena_capacity(&arena), "reset keeps one block");
+    unsigned char* d = (unsigned char*)dc_arena_alloc(&arena, 16);
+    TEST_ASSERT(d != NULL && d[0] == 0, "alloc after reset zeroed");
+
+    dc_arena_free(&arena);
+    TEST_ASSERT_EQ(0u, dc_arena_capacity(&arena), "free releases blocks");
+    TEST_ASSERT_EQ(DC_ERROR_NULL_POINTER, dc_arena_init(NULL, 0), "init NULL");
+
+    TEST_SUITE_END("Arena Tests");
+}
@@ -7,6 +7,11 @@
 #include "client/dc_client.h"
 #include "core/dc_status.h"
 #include "core/dc_log.h"
+#include "json/dc_json.h"
+#include "core/dc_platform.h"
+#include <stdio.h>
+#include <string.h>
+#include <yyjson.h>
 
 static void test_client_symbol_surface(void) {
     TEST_ASSERT((&dc_gateway_info_init) != NULL, "symbol dc_gateway_info_init");
@@ -38,8 +43,16 @@ static void test_client_symbol_surface(void) {
     TEST_ASSERT((&dc_client_create_guild_soundboard_sound_json) != NULL, "symbol dc_client_create_guild_soundboard_sound_json");
     TEST_ASSERT((&dc_client_create_guild_sticker_multipart) != NULL, "symbol dc_client_create_guild_sticker_multipart");
     TEST_ASSERT((&dc_client_create_message) != NULL, "symbol dc_client_create_message");
+    TEST_ASSERT((&dc_client_create_message_with_uploads) != NULL, "symbol dc_client_create_message_with_uploads");
     TEST_ASSERT((&dc_client_create_message_command_simple) != NULL, "symbol dc_client_create_message_command_simple");
     TEST_ASSERT((&dc_client_create_message_json) != NULL, "symbol dc_client_create_message_json");
+    TEST_ASSERT((&dc_client_get_hedge_stats) != NULL, "symbol dc_client_get_hedge_stats");
+    TEST_ASSERT((&dc_client_wait_for) != NULL, "symbol dc_client_wait_for");
+    TEST_ASSERT((&dc_client_cancel_waiter) != NULL, "symbol dc_client_cancel_waiter");
+    TEST_ASSERT((&dc_client_dispatch_to_waiters) != NULL, "symbol dc_client_dispatch_to_waiters");
+    TEST_ASSERT((&dc_client_get_preflight) != NULL, "symbol dc_client_get_preflight");
+    TEST_ASSERT((&dc_client_get_interaction_watchdog) != NULL, "symbol dc_client_get_interaction_watchdog");
+    TEST_ASSERT((&dc_client_get_interaction_watchdog_stats) != NULL, "symbol dc_client_get_interaction_watchdog_stats");
     TEST_ASSERT((&dc_client_create_reaction_encoded) != NULL, "symbol dc_client_create_reaction_encoded");
     TEST_ASSERT((&dc_client_create_stage_instance_json) != NULL, "symbol dc_client_create_stage_instance_json");
     TEST_ASSERT((&dc_client_create_user_command_simple) != NULL, "symbol dc_client_create_user_command_simple");
@@ -177,6 +190,9 @@ static void test_client_symbol_surface(void) {
     TEST_ASSERT((&dc_client_list_voice_regions_json) != NULL, "symbol dc_client_list_voice_regions_json");
     TEST_ASSERT((&dc_client_modify_auto_moderation_rule_json) != NULL, "symbol dc_client_modify_auto_moderation_rule_json");
     TEST_ASSERT((&dc_client_modify_channel_json) != NULL, "symbol dc_client_modify_channel_json");
+    TEST_ASSERT((&dc_client_modify_channel_diff) != NULL, "symbol dc_client_modify_channel_diff");
+    TEST_ASSERT((&dc_client_modify_guild_diff) != NULL, "symbol dc_client_modify_guild_diff");
+    TEST_ASSERT((&dc_client_modify_guild_role_diff) != NULL, "symbol dc_client_modify_guild_role_diff");
     TEST_ASSERT((&dc_client_modify_current_application_json) != NULL, "symbol dc_client_modify_current_application_json");
     TEST_ASSERT((&dc_client_modify_current_member_json) != NULL, "symbol dc_client_modify_current_member_json");
     TEST_ASSERT((&dc_client_modify_current_user_json) != NULL, "symbol dc_client_modify_current_user_json");
@@ -190,6 +206,7 @@ static void test_client_symbol_surface(void) {
     TEST_ASSERT((&dc_client_modify_guild_incident_actions_json) != NULL, "symbol dc_client_modify_guild_incident_actions_json");
     TEST_ASSERT((&dc_client_modify_guild_json) != NULL, "symbol dc_client_modify_guild_json");
     TEST_ASSERT((&dc_client_modify_guild_member_json) != NULL, "symbol dc_client_modify_guild_member_json");
+    TEST_ASSERT((&dc_client_modify_guild_member_diff) != NULL, "symbol dc_client_modify_guild_member_diff");
     TEST_ASSERT((&dc_client_modify_guild_onboarding_json) != NULL, "symbol dc_client_modify_guild_onboarding_json");
     TEST_ASSERT((&dc_client_modify_guild_role_json) != NULL, "symbol dc_client_modify_guild_role_json");
     TEST_ASSERT((&dc_client_modify_guild_role_positions_json) != NULL, "symbol dc_client_modify_guild_role_positions_json");
@@ -242,6 +259,8 @@ static void test_client_config_and_lifecycle(void) {
     TEST_ASSERT_EQ((uint32_t)30000, cfg.http_timeout_ms, "config default http timeout");
     TEST_ASSERT_EQ((uint32_t)60000, cfg.gateway_timeout_ms, "config default gw timeout");
     TEST_ASSERT_EQ(DC_LOG_INFO, cfg.log_level, "config default log level");
+    TEST_ASSERT_EQ(0, cfg.hedge_message_sends, "config default hedging off");
+    TEST_ASSERT_EQ((uint32_t)95, cfg.hedge_percentile, "config default hedge percentile");
 
     dc_user_agent_t ua = {
         .name = "fishydslib",
@@ -285,6 +304,1531 @@ static void test_client_config_and_lifecycle(void) {
     dc_client_free(client);
 }
 
+static dc_status_t test_client_capture_transport(void* userdata,
+                                                 const dc_http_request_t* request,
+                                                 dc_http_response_t* response) {
+    dc_string_t* last_body = (dc_string_t*)userdata;
+    dc_string_set_cstr(last_body, dc_string_cstr(&request->body));
+    response->status_code = 200;
+    return dc_string_set_cstr(&response->body, "{\"id\":\"123456789012345678\"}");
+}
+
+static int test_client_sent_nonce(const dc_string_t* body, const char* expected_nonce) {
+    dc_json_doc_t doc;
+    if (dc_json_parse(dc_string_cstr(body), &doc) != DC_OK) return 0;
+    const char* nonce = NULL;
+    int enforce = 0;
+    int ok = dc_json_get_string(doc.root, "nonce", &nonce) == DC_OK &&
+             dc_json_get_bool(doc.root, "enforce_nonce", &enforce) == DC_OK &&
+             enforce && nonce[0] != '\0' &&
+             (!expected_nonce || strcmp(nonce, expected_nonce) == 0);
+    dc_json_doc_free(&doc);
+    return ok;
+}
+
+static void test_client_hedged_message_nonce(void) {
+    dc_string_t last_body;
+    dc_string_init(&last_body);
+
+    dc_client_config_t cfg;
+    dc_client_config_init(&cfg);
+    cfg.token = "test_token";
+    cfg.hedge_message_sends = 1;
+    cfg.rest_transport = test_client_capture_transport;
+    cfg.rest_transport_userdata = &last_body;
+    dc_client_t* client = NULL;
+    TEST_ASSERT_EQ(DC_OK, dc_client_create(&cfg, &client), "hedging client create");
+
+    dc_snowflake_t message_id = 0;
+    TEST_ASSERT_EQ(DC_OK, dc_client_create_message_json(client, 42, "{\"content\":\"hi\"}", &message_id),
+                   "hedged send ok");
+    TEST_ASSERT_EQ((dc_snowflake_t)123456789012345678ULL, message_id, "hedged send message id");
+    TEST_ASSERT(test_client_sent_nonce(&last_body, NULL), "nonce added with enforce_nonce");
+
+    /* A second client (another shard or process) must not reuse the first one's nonce */
+    dc_string_t first_body;
+    dc_string_init(&first_body);
+    dc_string_set_cstr(&first_body, dc_string_cstr(&last_body));
+    dc_client_t* other = NULL;
+    TEST_ASSERT_EQ(DC_OK, dc_client_create(&cfg, &other), "second hedging client create");
+    TEST_ASSERT_EQ(DC_OK, dc_client_create_message_json(other, 42, "{\"content\":\"hi\"}", NULL),
+                   "second client send ok");
+    TEST_ASSERT(test_client_sent_nonce(&last_body, NULL), "second client adds a nonce");
+    TEST_ASSERT(strcmp(dc_string_cstr(&first_body), dc_string_cstr(&last_body)) != 0,
+                "clients pick different nonces");
+    dc_client_free(other);
+    dc_string_free(&first_body);
+
+    TEST_ASSERT_EQ(DC_OK, dc_client_create_message_json(client, 42,
+                                                        "{\"content\":\"hi\",\"nonce\":\"abc\",\"enforce_nonce\":false}",
+                                                        NULL),
+                   "hedged send with caller nonce ok");
+    TEST_ASSERT(test_client_sent_nonce(&last_body, "abc"), "caller nonce kept, enforce_nonce forced");
+
+    dc_rest_hedge_stats_t stats;
+    TEST_ASSERT_EQ(DC_OK, dc_client_get_hedge_stats(client, &stats), "hedge stats ok");
+    TEST_ASSERT_EQ(2, (int)stats.requests, "hedged sends counted");
+
+    dc_client_free(client);
+    dc_string_free(&last_body);
+}
+
+static dc_status_t test_client_body_transport(void* userdata,
+                                              const dc_http_request_t* request,
+                                              dc_http_response_t* response) {
+    const int* status = (const int*)userdata;
+    (void)request;
+    response->status_code = *status;
+    return dc_string_set_cstr(&response->body, *status == 200 ? "[{\"type\":\"github\"}]"
+                                                              : "{\"code\":10013}");
+}
+
+static void test_client_json_out_moves_body(void) {
+    int status = 200;
+    dc_client_config_t cfg;
+    dc_client_config_init(&cfg);
+    cfg.token = "test_token";
+    cfg.rest_transport = test_client_body_transport;
+    cfg.rest_transport_userdata = &status;
+    dc_client_t* client = NULL;
+    TEST_ASSERT_EQ(DC_OK, dc_client_create(&cfg, &client), "body client create");
+
+    /* An empty caller buffer receives the body in place */
+    dc_string_t out;
+    dc_string_init(&out);
+    dc_string_reserve(&out, 4096);
+    const char* storage = out.data;
+    TEST_ASSERT_EQ(DC_OK, dc_client_get_current_user_connections_json(client, &out), "json out ok");
+    TEST_ASSERT_STR_EQ("[{\"type\":\"github\"}]", dc_string_cstr(&out), "json out body");
+    TEST_ASSERT(out.data == storage, "body written into the caller's buffer");
+
+    /* A non-empty one is replaced */
+    TEST_ASSERT_EQ(DC_OK, dc_client_get_current_user_connections_json(client, &out), "json out again");
+    TEST_ASSERT_STR_EQ("[{\"type\":\"github\"}]", dc_string_cstr(&out), "json out replaced");
+
+    dc_string_clear(&out);
+    status = 404;
+    TEST_ASSERT_EQ(DC_ERROR_NOT_FOUND, dc_client_get_current_user_connections_json(client, &out),
+                   "json out error status");
+    TEST_ASSERT_EQ(0u, dc_string_length(&out), "lent buffer empty after error");
+    dc_string_free(&out);
+
+    dc_client_free(client);
+}
+
+typedef struct {
+    int requests;
+    dc_string_t body;
+} test_client_patch_log_t;
+
+static dc_status_t test_client_patch_transport(void* userdata,
+                                               const dc_http_request_t* request,
+                                               dc_http_response_t* response) {
+    test_client_patch_log_t* log = (test_client_patch_log_t*)userdata;
+    log->requests++;
+    dc_string_set_cstr(&log->body, dc_string_cstr(&request->body));
+    response->status_code = 200;
+    return dc_string_set_cstr(&response->body, "{\"id\":\"55\"}");
+}
+
+static void test_client_modify_diff(void) {
+    test_client_patch_log_t log;
+    log.requests = 0;
+    dc_string_init(&log.body);
+    dc_client_config_t cfg;
+    dc_client_config_init(&cfg);
+    cfg.token = "test_token";
+    cfg.rest_transport = test_client_patch_transport;
+    cfg.rest_transport_userdata = &log;
+    dc_client_t* client = NULL;
+    TEST_ASSERT_EQ(DC_OK, dc_client_create(&cfg, &client), "diff client create");
+
+    dc_role_t original;
+    dc_role_t edited;
+    dc_role_init(&original);
+    dc_role_init(&edited);
+    original.id = edited.id = 55;
+    dc_string_set_cstr(&original.name, "mods");
+    dc_string_set_cstr(&edited.name, "mods");
+    original.color = edited.color = 0x3498db;
+
+    TEST_ASSERT_EQ(DC_OK, dc_client_modify_guild_role_diff(client, 10, &original, &edited, NULL),
+                   "unchanged role ok");
+    TEST_ASSERT_EQ(0, log.requests, "unchanged role skips the request");
+
+    edited.hoist = 1;
+    TEST_ASSERT_EQ(DC_OK, dc_client_modify_guild_role_diff(client, 10, &original, &edited, NULL),
+                   "changed role ok");
+    TEST_ASSERT_EQ(1, log.requests, "changed role sends one request");
+    TEST_ASSERT_STR_EQ("{\"hoist\":true}", dc_string_cstr(&log.body), "only the changed field is sent");
+
+    /* The body buffer is reused: the next diff carries only its own fields */
+    edited.hoist = 0;
+    dc_string_set_cstr(&edited.name, "crew");
+    TEST_ASSERT_EQ(DC_OK, dc_client_modify_guild_role_diff(client, 10, &original, &edited, NULL),
+                   "second changed role ok");
+    TEST_ASSERT_EQ(2, log.requests, "second changed role sends one request");
+    TEST_ASSERT_STR_EQ("{\"name\":\"crew\"}", dc_string_cstr(&log.body), "reused body holds only the new diff");
+
+    edited.id = 56;
+    TEST_ASSERT_EQ(DC_ERROR_INVALID_PARAM,
+                   dc_client_modify_guild_role_diff(client, 10, &original, &edited, NULL),
+                   "role ID mismatch rejected");
+    TEST_ASSERT_EQ(2, log.requests, "mismatch sends nothing");
+
+    dc_role_free(&original);
+    dc_role_free(&edited);
+    dc_client_free(client);
+    dc_string_free(&log.body);
+}
+
+static const char* test_preflight_guild =
+    "{\"id\":\"10\",\"owner_id\":\"1\","
+    "\"roles\":[{\"id\":\"10\",\"permissions\":\"68608\",\"position\":0},"
+    "{\"id\":\"20\",\"permissions\":\"268435456\",\"position\":5},"
+    "{\"id\":\"30\",\"permissions\":\"0\",\"position\":7}],"
+    "\"channels\":[{\"id\":\"100\",\"type\":0,\"permission_overwrites\":"
+    "[{\"id\":\"10\",\"type\":0,\"allow\":\"0\",\"deny\":\"2048\"}]},"
+    "{\"id\":\"101\",\"type\":0,\"permission_overwrites\":[]}],"
+    "\"threads\":[{\"id\":\"102\",\"type\":11,\"parent_id\":\"101\"}],"
+    "\"members\":[{\"user\":{\"id\":\"900\"},\"roles\":[\"20\"]}]}";
+
+static void test_client_permission_preflight(void) {
+    test_client_patch_log_t log;
+    log.requests = 0;
+    dc_string_init(&log.body);
+    dc_client_config_t cfg;
+    dc_client_config_init(&cfg);
+    TEST_ASSERT_EQ(0, cfg.permission_preflight, "preflight off by default");
+    cfg.token = "test_token";
+    cfg.rest_transport = test_client_patch_transport;
+    cfg.rest_transport_userdata = &log;
+    cfg.permission_preflight = 1;
+    dc_client_t* client = NULL;
+    TEST_ASSERT_EQ(DC_OK, dc_client_create(&cfg, &client), "preflight client create");
+    dc_preflight_t* preflight = dc_client_get_preflight(client);
+    TEST_ASSERT(preflight != NULL, "preflight available");
+
+    /* Nothing known yet: the request goes out */
+    TEST_ASSERT_EQ(DC_OK, dc_client_create_message(client, 100, "hi", NULL), "unknown channel sends");
+    TEST_ASSERT_EQ(1, log.requests, "unknown channel reached the transport");
+
+    TEST_ASSERT_EQ(DC_OK, dc_preflight_feed_event(preflight, "READY", "{\"user\":{\"id\":\"900\"}}"),
+                   "feed READY");
+    TEST_ASSERT_EQ(DC_OK, dc_preflight_feed_event(preflight, "GUILD_CREATE", test_preflight_guild),
+                   "feed GUILD_CREATE");
+    TEST_ASSERT_EQ(DC_OK, dc_preflight_feed_event(preflight, "MESSAGE_CREATE", "not json"),
+                   "unrelated events are not parsed");
+
+    /* @everyone is denied SEND_MESSAGES in channel 100 */
+    TEST_ASSERT_EQ(DC_ERROR_MISSING_PERMISSIONS, dc_client_create_message(client, 100, "hi", NULL),
+                   "denied send rejected");
+    TEST_ASSERT_EQ(1, log.requests, "denied send never reached the transport");
+    dc_permissions_t missing = 0;
+    TEST_ASSERT_EQ(DC_ERROR_MISSING_PERMISSIONS,
+                   dc_preflight_check(preflight, DC_HTTP_POST,
+                                      "https://discord.com/api/v10/channels/100/messages?wait=true", &missing),
+                   "full URL checked");
+    TEST_ASSERT_EQ(DC_PERMISSION_SEND_MESSAGES, missing, "missing permission reported");
+    TEST_ASSERT_EQ(DC_OK, dc_preflight_check(preflight, DC_HTTP_GET, "/channels/100/messages", NULL),
+                   "reading history allowed");
+
+    TEST_ASSERT_EQ(DC_OK, dc_client_create_message(client, 101, "hi", NULL), "allowed send ok");
+    TEST_ASSERT_EQ(2, log.requests, "allowed send reached the transport");
+
+    /* Threads need SEND_MESSAGES_IN_THREADS, taken from the parent's overwrites */
+    TEST_ASSERT_EQ(DC_ERROR_MISSING_PERMISSIONS, dc_client_create_message(client, 102, "hi", NULL),
+                   "thread send without SEND_MESSAGES_IN_THREADS rejected");
+
+    /* Role hierarchy: MANAGE_ROLES is not enough for roles at or above our own */
+    TEST_ASSERT_EQ(DC_ERROR_MISSING_PERMISSIONS, dc_client_add_guild_member_role(client, 10, 5, 30),
+                   "higher role rejected");
+    TEST_ASSERT_EQ(DC_ERROR_MISSING_PERMISSIONS,
+                   dc_preflight_check(preflight, DC_HTTP_PUT, "/guilds/10/members/5/roles/20", &missing),
+                   "own highest role rejected");
+    TEST_ASSERT_EQ(0u, missing, "hierarchy rejection reports no permission");
+    TEST_ASSERT_EQ(DC_OK, dc_preflight_feed_event(preflight, "GUILD_ROLE_CREATE",
+                   "{\"guild_id\":\"10\",\"role\":{\"id\":\"15\",\"permissions\":\"0\",\"position\":1}}"),
+                   "feed GUILD_ROLE_CREATE");
+    TEST_ASSERT_EQ(DC_OK, dc_client_add_guild_member_role(client, 10, 5, 15), "lower role sent");
+    TEST_ASSERT_EQ(3, log.requests, "lower role reached the transport");
+    TEST_ASSERT_EQ(DC_OK, dc_preflight_check(preflight, DC_HTTP_PUT, "/guilds/10/members/5/roles/99", NULL),
+                   "unknown role sent");
+
+    /* Overwrite removed: sending works again */
+    TEST_ASSERT_EQ(DC_OK, dc_preflight_feed_event(preflight, "CHANNEL_UPDATE",
+                   "{\"id\":\"100\",\"type\":0,\"guild_id\":\"10\",\"permission_overwrites\":[]}"),
+                   "feed CHANNEL_UPDATE");
+    TEST_ASSERT_EQ(DC_OK, dc_preflight_check(preflight, DC_HTTP_POST, "/channels/100/messages", NULL),
+                   "updated overwrites allow send");
+
+    /* Guild gone: back to unknown */
+    TEST_ASSERT_EQ(DC_OK, dc_preflight_feed_event(preflight, "GUILD_DELETE", "{\"id\":\"10\"}"),
+                   "feed GUILD_DELETE");
+    TEST_ASSERT_EQ(DC_OK, dc_preflight_check(preflight, DC_HTTP_POST, "/guilds/10/roles", NULL),
+                   "deleted guild unknown");
+    TEST_ASSERT_EQ(DC_ERROR_NOT_FOUND, dc_preflight_remove_channel(preflight, 100), "guild channels removed");
+
+    dc_preflight_stats_t stats;
+    TEST_ASSERT_EQ(DC_OK, dc_preflight_get_stats(preflight, &stats), "preflight stats");
+    TEST_ASSERT_EQ(5u, stats.rejected, "rejected count");
+    TEST_ASSERT_EQ(3u, stats.unknown, "unknown count");
+    TEST_ASSERT_EQ(12u, stats.checked, "checked count");
+
+    dc_client_free(client);
+    dc_string_free(&log.body);
+}
+
+typedef struct {
+    int matched;
+    int timeouts;
+    int cancelled;
+    int finals;
+    dc_waiter_registry_t* registry;
+    uint64_t cancel_id;             /* cancelled from inside the callback when set */
+} test_waiter_log_t;
+
+static void test_waiter_record(dc_wait_result_t result, const char* event_name,
+                               const char* event_data, int final, void* user_data) {
+    test_waiter_log_t* log = (test_waiter_log_t*)user_data;
+    if (result == DC_WAIT_MATCHED && event_name && event_data) log->matched++;
+    if (result == DC_WAIT_TIMEOUT) log->timeouts++;
+    if (result == DC_WAIT_CANCELLED) log->cancelled++;
+    if (final) log->finals++;
+    if (log->registry && log->cancel_id) {
+        uint64_t id = log->cancel_id;
+        log->cancel_id = 0;
+        (void)dc_waiter_registry_cancel(log->registry, id);
+    }
+}
+
+static const char* test_component_click =
+    "{\"type\":3,\"message\":{\"id\":\"100\"},\"member\":{\"user\":{\"id\":\"7\"}},"
+    "\"data\":{\"custom_id\":\"confirm\",\"component_type\":2}}";
+static const char* test_component_click_other_user =
+    "{\"type\":3,\"message\":{\"id\":\"100\"},\"user\":{\"id\":\"8\"},"
+    "\"data\":{\"custom_id\":\"confirm\",\"component_type\":2}}";
+static const char* test_modal_submit =
+    "{\"type\":5,\"user\":{\"id\":\"7\"},\"data\":{\"custom_id\":\"form:1\",\"components\":[]}}";
+static const char* test_reply_u9 =
+    "{\"id\":\"300\",\"channel_id\":\"5\",\"author\":{\"id\":\"9\"},\"content\":\"yes\"}";
+static const char* test_reply_u4 =
+    "{\"id\":\"301\",\"channel_id\":\"5\",\"author\":{\"id\":\"4\"},\"content\":\"no\"}";
+
+static void test_client_waiter_registry(void) {
+    dc_waiter_registry_t reg;
+    test_waiter_log_t log;
+    memset(&log, 0, sizeof(log));
+    size_t matched = 0;
+    TEST_ASSERT_EQ(DC_OK, dc_waiter_registry_init(&reg), "waiter registry init");
+
+    dc_waiter_spec_t spec;
+    dc_waiter_spec_init(&spec);
+    TEST_ASSERT_EQ(1u, spec.max_matches, "spec default single match");
+    spec.callback = test_waiter_record;
+    spec.user_data = &log;
+    TEST_ASSERT_EQ(DC_ERROR_INVALID_PARAM, dc_waiter_registry_add(&reg, &spec, 0, NULL),
+                   "component waiter needs a message id");
+
+    /* Component click on message 100 by user 7 */
+    spec.message_id = 100;
+    spec.user_id = 7;
+    uint64_t id = 0;
+    TEST_ASSERT_EQ(DC_OK, dc_waiter_registry_add(&reg, &spec, 0, &id), "add component waiter");
+    TEST_ASSERT(id != 0, "waiter id assigned");
+    TEST_ASSERT_EQ(DC_OK, dc_waiter_registry_dispatch(&reg, "INTERACTION_CREATE",
+                                                      test_component_click_other_user, &matched),
+                   "dispatch other user's click");
+    TEST_ASSERT_EQ(0u, matched, "other user's click ignored");
+    TEST_ASSERT_EQ(DC_OK, dc_waiter_registry_dispatch(&reg, "MESSAGE_CREATE", "not json", &matched),
+                   "unwatched event kind is not parsed");
+    TEST_ASSERT_EQ(DC_OK, dc_waiter_registry_dispatch(&reg, "INTERACTION_CREATE",
+                                                      test_component_click, &matched),
+                   "dispatch click");
+    TEST_ASSERT_EQ(1u, matched, "click matched");
+    TEST_ASSERT_EQ(1, log.finals, "single-match waiter completed");
+    TEST_ASSERT_EQ(0u, dc_waiter_registry_count(&reg), "completed waiter removed");
+    TEST_ASSERT_EQ(DC_ERROR_NOT_FOUND, dc_waiter_registry_cancel(&reg, id), "completed waiter not cancellable");
+
+    /* Reply collector for anyone in channel 5, plus one for user 9 only */
+    memset(&log, 0, sizeof(log));
+    dc_waiter_spec_init(&spec);
+    spec.kind = DC_WAIT_REPLY;
+    spec.channel_id = 5;
+    spec.max_matches = 2;
+    spec.callback = test_waiter_record;
+    spec.user_data = &log;
+    TEST_ASSERT_EQ(DC_OK, dc_waiter_registry_add(&reg, &spec, 0, NULL), "add channel collector");
+    spec.user_id = 9;
+    spec.max_matches = 1;
+    TEST_ASSERT_EQ(DC_OK, dc_waiter_registry_add(&reg, &spec, 0, NULL), "add user reply waiter");
+    dc_waiter_registry_dispatch(&reg, "MESSAGE_CREATE", test_reply_u4, &matched);
+    TEST_ASSERT_EQ(1u, matched, "other author only reaches the channel collector");
+    dc_waiter_registry_dispatch(&reg, "MESSAGE_CREATE", test_reply_u9, &matched);
+    TEST_ASSERT_EQ(2u, matched, "author 9 reaches both waiters");
+    TEST_ASSERT_EQ(2, log.finals, "both waiters completed");
+    TEST_ASSERT_EQ(0u, dc_waiter_registry_count(&reg), "reply waiters removed");
+
+    /* Modal submit by custom_id; a component click with the same id does not count */
+    memset(&log, 0, sizeof(log));
+    dc_waiter_spec_init(&spec);
+    spec.kind = DC_WAIT_MODAL;
+    spec.custom_id = "form:1";
+    spec.callback = test_waiter_record;
+    spec.user_data = &log;
+    TEST_ASSERT_EQ(DC_OK, dc_waiter_registry_add(&reg, &spec, 0, NULL), "add modal waiter");
+    dc_waiter_registry_dispatch(&reg, "INTERACTION_CREATE", test_component_click, &matched);
+    TEST_ASSERT_EQ(0u, matched, "component click is not a modal submit");
+    dc_waiter_registry_dispatch(&reg, "INTERACTION_CREATE", test_modal_submit, &matched);
+    TEST_ASSERT_EQ(1u, matched, "modal submit matched");
+
+    /* Deadlines fire in order from the heap */
+    memset(&log, 0, sizeof(log));
+    dc_waiter_spec_init(&spec);
+    spec.callback = test_waiter_record;
+    spec.user_data = &log;
+    uint32_t timeouts[3] = {50, 10, 30};
+    for (size_t i = 0; i < 3; i++) {
+        spec.message_id = 200 + i;
+        spec.timeout_ms = timeouts[i];
+        dc_waiter_registry_add(&reg, &spec, 1000, NULL);
+    }
+    uint64_t next_ms = 0;
+    TEST_ASSERT(dc_waiter_registry_next_deadline(&reg, &next_ms), "deadline pending");
+    TEST_ASSERT_EQ((uint64_t)1010, next_ms, "earliest deadline first");
+    TEST_ASSERT_EQ(0u, dc_waiter_registry_expire(&reg, 1009), "nothing due yet");
+    TEST_ASSERT_EQ(2u, dc_waiter_registry_expire(&reg, 1030), "two waiters due");
+    TEST_ASSERT_EQ(2, log.timeouts, "timeout callbacks ran");
+    TEST_ASSERT(dc_waiter_registry_next_deadline(&reg, &next_ms) && next_ms == 1050, "last deadline left");
+
+    /* A callback cancelling a waiter matched by the same event */
+    memset(&log, 0, sizeof(log));
+    dc_waiter_spec_init(&spec);
+    spec.message_id = 100;
+    spec.callback = test_waiter_record;
+    spec.user_data = &log;
+    spec.max_matches = 0;
+    uint64_t collector = 0;
+    dc_waiter_registry_add(&reg, &spec, 0, &collector);
+    spec.max_matches = 1;
+    dc_waiter_registry_add(&reg, &spec, 0, NULL);
+    log.registry = &reg;
+    log.cancel_id = collector;  /* newest runs first and cancels the collector */
+    dc_waiter_registry_dispatch(&reg, "INTERACTION_CREATE", test_component_click, &matched);
+    TEST_ASSERT_EQ(1u, matched, "one callback for the event");
+    TEST_ASSERT_EQ(1, log.matched, "cancelled collector not matched afterwards");
+    TEST_ASSERT_EQ(1, log.cancelled, "cancel callback ran once");
+    log.registry = NULL;
+
+    /* Many waiters on other messages do not change the result */
+    memset(&log, 0, sizeof(log));
+    for (uint64_t m = 1000; m < 3000; m++) {
+        spec.message_id = m;
+        dc_waiter_registry_add(&reg, &spec, 0, NULL);
+    }
+    spec.message_id = 100;
+    dc_waiter_registry_add(&reg, &spec, 0, NULL);
+    dc_waiter_registry_dispatch(&reg, "INTERACTION_CREATE", test_component_click, &matched);
+    TEST_ASSERT_EQ(1u, matched, "only the indexed waiter runs");
+    size_t pending = dc_waiter_registry_count(&reg);
+    TEST_ASSERT_EQ(2001u, pending, "other waiters still pending");
+
+    dc_waiter_registry_free(&reg);
+    TEST_ASSERT_EQ(2001, log.cancelled, "free cancels pending waiters");
+}
+
+static void test_client_waiters(void) {
+    dc_client_config_t cfg;
+    dc_client_config_init(&cfg);
+    cfg.token = "test_token";
+    dc_client_t* client = NULL;
+    TEST_ASSERT_EQ(DC_OK, dc_client_create(&cfg, &client), "waiter client create");
+
+    test_waiter_log_t log;
+    memset(&log, 0, sizeof(log));
+    dc_waiter_spec_t spec;
+    dc_waiter_spec_init(&spec);
+    spec.message_id = 100;
+    spec.callback = test_waiter_record;
+    spec.user_data = &log;
+    uint64_t id = 0;
+    TEST_ASSERT_EQ(DC_OK, dc_client_wait_for(client, &spec, &id), "client wait_for");
+    TEST_ASSERT_EQ(DC_OK, dc_client_dispatch_to_waiters(client, "INTERACTION_CREATE", test_component_click),
+                   "client dispatch");
+    TEST_ASSERT_EQ(1, log.matched, "client waiter matched");
+
+    TEST_ASSERT_EQ(DC_OK, dc_client_wait_for(client, &spec, &id), "client wait_for again");
+    TEST_ASSERT_EQ(DC_OK, dc_client_cancel_waiter(client, id), "client cancel");
+    TEST_ASSERT_EQ(1, log.cancelled, "client cancel callback");
+
+    spec.timeout_ms = 1;
+    TEST_ASSERT_EQ(DC_OK, dc_client_wait_for(client, &spec, NULL), "client timed waiter");
+    dc_platform_sleep_ms(5);
+    (void)dc_client_process(client, 1000);
+    TEST_ASSERT_EQ(1, log.timeouts, "process expires due waiters");
+
+    dc_client_free(client);
+}
+
+#define TEST_DEPLOY_GUILD_BASE 200000000000000000ULL
+
+typedef struct {
+    dc_platform_mutex_t lock;
+    int requests;
+    int bad_method;
+    int flaky_failures;         /* 503s left for guild +7 */
+    uint64_t plan_size;
+    uint64_t abort_at;          /* generator fails at this index (0 = never) */
+    uint64_t first_index;       /* first index the generator saw */
+    int generated;
+    int results;
+    int result_errors;
+    int progress_calls;
+    int stop_progress;          /* on_progress stops the run */
+    dc_command_deploy_progress_t last_progress;
+} test_deploy_ctx_t;
+
+static dc_status_t test_deploy_transport(void* userdata, const dc_http_request_t* request,
+                                         dc_http_response_t* response) {
+    test_deploy_ctx_t* ctx = (test_deploy_ctx_t*)userdata;
+    char bad_path[96];
+    char flaky_path[96];
+    snprintf(bad_path, sizeof(bad_path), "/applications/555/guilds/%llu/commands",
+             (unsigned long long)(TEST_DEPLOY_GUILD_BASE + 9));
+    snprintf(flaky_path, sizeof(flaky_path), "/applications/555/guilds/%llu/commands",
+             (unsigned long long)(TEST_DEPLOY_GUILD_BASE + 7));
+    const char* url = dc_string_cstr(&request->url);
+    dc_platform_mutex_lock(&ctx->lock);
+    ctx->requests++;
+    if (request->method != DC_HTTP_PUT) ctx->bad_method++;
+    int flaky = strstr(url, flaky_path) != NULL && ctx->flaky_failures > 0;
+    if (flaky) ctx->flaky_failures--;
+    dc_platform_mutex_unlock(&ctx->lock);
+
+    if (strstr(url, bad_path)) {
+        response->status_code = 400;
+        return dc_string_set_cstr(&response->body, "{\"code\":50035,\"message\":\"Invalid Form Body\"}");
+    }
+    if (flaky) {
+        response->status_code = 503;
+        return dc_string_set_cstr(&response->body, "upstream");
+    }
+    response->status_code = 200;
+    return dc_string_set_cstr(&response->body, "[]");
+}
+
+static dc_status_t test_deploy_next(void* user_data, uint64_t index, dc_command_deploy_item_t* item) {
+    test_deploy_ctx_t* ctx = (test_deploy_ctx_t*)user_data;
+    if (ctx->generated == 0) ctx->first_index = index;
+    if (ctx->abort_at != 0 && index == ctx->abort_at) return DC_ERROR_INVALID_STATE;
+    if (index >= ctx->plan_size) return DC_ERROR_NOT_FOUND;
+    ctx->generated++;
+    item->guild_id = TEST_DEPLOY_GUILD_BASE + index;
+    return dc_string_set_cstr(&item->commands_json, "[{\"name\":\"ping\",\"description\":\"Ping\"}]");
+}
+
+static void test_deploy_result(void* user_data, uint64_t index, dc_snowflake_t guild_id, dc_status_t status) {
+    test_deploy_ctx_t* ctx = (test_deploy_ctx_t*)user_data;
+    ctx->results++;
+    if (status != DC_OK) ctx->result_errors++;
+    if (guild_id != TEST_DEPLOY_GUILD_BASE + index) ctx->result_errors += 100;
+}
+
+static dc_status_t test_deploy_progress(void* user_data, const dc_command_deploy_progress_t* progress) {
+    test_deploy_ctx_t* ctx = (test_deploy_ctx_t*)user_data;
+    ctx->progress_calls++;
+    ctx->last_progress = *progress;
+    return ctx->stop_progress ? DC_ERROR_UNKNOWN : DC_OK;
+}
+
+static void test_deploy_reset(test_deploy_ctx_t* ctx, uint64_t plan_size) {
+    ctx->requests = 0;
+    ctx->bad_method = 0;
+    ctx->flaky_failures = 0;
+    ctx->plan_size = plan_size;
+    ctx->abort_at = 0;
+    ctx->first_index = 0;
+    ctx->generated = 0;
+    ctx->results = 0;
+    ctx->result_errors = 0;
+    ctx->progress_calls = 0;
+    ctx->stop_progress = 0;
+    memset(&ctx->last_progress, 0, sizeof(ctx->last_progress));
+}
+
+static void test_client_command_deploy(void) {
+    test_deploy_ctx_t ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    TEST_ASSERT(dc_platform_mutex_init(&ctx.lock), "deploy lock init");
+
+    dc_client_config_t cfg;
+    dc_client_config_init(&cfg);
+    cfg.token = "test_token";
+    cfg.rest_global_rate_limit_per_sec = 100000;
+    cfg.rest_transport = test_deploy_transport;
+    cfg.rest_transport_userdata = &ctx;
+    dc_client_t* client = NULL;
+    TEST_ASSERT_EQ(DC_OK, dc_client_create(&cfg, &client), "deploy client create");
+
+    dc_command_deploy_config_t dcfg;
+    dc_command_deploy_config_init(&dcfg);
+    TEST_ASSERT_EQ(16u, dcfg.concurrency, "default concurrency");
+    TEST_ASSERT_EQ(3u, dcfg.max_attempts, "default attempts");
+    TEST_ASSERT_EQ(DC_ERROR_NULL_POINTER, dc_command_deploy_run(client, &dcfg, NULL), "generator required");
+    dcfg.next = test_deploy_next;
+    TEST_ASSERT_EQ(DC_ERROR_INVALID_PARAM, dc_command_deploy_run(client, &dcfg, NULL), "application id required");
+
+    /* Full plan over several workers: one guild is rejected, one recovers after a 503 */
+    dcfg.application_id = 555;
+    dcfg.on_result = test_deploy_result;
+    dcfg.on_progress = test_deploy_progress;
+    dcfg.user_data = &ctx;
+    dcfg.concurrency = 4;
+    dcfg.total = 40;
+    test_deploy_reset(&ctx, 40);
+    ctx.flaky_failures = 1;
+    dc_command_deploy_progress_t progress;
+    TEST_ASSERT_EQ(DC_OK, dc_command_deploy_run(client, &dcfg, &progress), "deploy run");
+    TEST_ASSERT_EQ(39u, progress.succeeded, "deploy succeeded");
+    TEST_ASSERT_EQ(1u, progress.failed, "rejected guild failed");
+    TEST_ASSERT_EQ(1u, progress.retries, "503 retried once");
+    TEST_ASSERT_EQ(9u, progress.checkpoint, "checkpoint held at the rejected guild");
+    TEST_ASSERT_EQ(0u, progress.in_flight, "nothing in flight");
+    TEST_ASSERT_EQ(41, ctx.requests, "one request per guild plus the retry");
+    TEST_ASSERT_EQ(0, ctx.bad_method, "bulk overwrite uses PUT");
+    TEST_ASSERT_EQ(40, ctx.results, "one result per guild");
+    TEST_ASSERT_EQ(1, ctx.result_errors, "only the rejected guild reports an error");
+    TEST_ASSERT(ctx.progress_calls >= 1, "final progress reported");
+    TEST_ASSERT_EQ(9u, ctx.last_progress.checkpoint, "final progress checkpoint");
+    TEST_ASSERT_EQ(0u, ctx.last_progress.eta_ms, "nothing left at the end");
+
+    /* Interrupted run resumes from its checkpoint */
+    dcfg.concurrency = 1;
+    dcfg.total = 20;
+    test_deploy_reset(&ctx, 20);
+    ctx.abort_at = 10;
+    TEST_ASSERT_EQ(DC_ERROR_INVALID_STATE, dc_command_deploy_run(client, &dcfg, &progress),
+                   "generator error stops the run");
+    TEST_ASSERT_EQ(10u, progress.succeeded + progress.failed, "guilds before the abort finished");
+    TEST_ASSERT_EQ(9u, progress.checkpoint, "checkpoint at the failed guild before the abort");
+    dcfg.start_index = progress.checkpoint;
+    test_deploy_reset(&ctx, 20);
+    TEST_ASSERT_EQ(DC_OK, dc_command_deploy_run(client, &dcfg, &progress), "resumed run");
+    TEST_ASSERT_EQ(9u, ctx.first_index, "resume starts at the checkpoint");
+    TEST_ASSERT_EQ(11, ctx.requests, "resume retries the failed guild and skips deployed ones");
+    TEST_ASSERT_EQ(9u, progress.checkpoint, "still-failing guild keeps the checkpoint");
+
+    /* Without failures the checkpoint reaches the end of the plan */
+    dcfg.start_index = 10;
+    test_deploy_reset(&ctx, 20);
+    TEST_ASSERT_EQ(DC_OK, dc_command_deploy_run(client, &dcfg, &progress), "run past the failure");
+    TEST_ASSERT_EQ(20u, progress.checkpoint, "clean run finishes the plan");
+
+    /* Progress callback can stop the run */
+    dcfg.start_index = 0;
+    dcfg.progress_interval_ms = 0;
+    test_deploy_reset(&ctx, 20);
+    ctx.stop_progress = 1;
+    TEST_ASSERT_EQ(DC_ERROR_UNKNOWN, dc_command_deploy_run(client, &dcfg, &progress), "progress stops the run");
+    TEST_ASSERT_EQ(1u, progress.succeeded, "stopped after the first guild");
+    TEST_ASSERT_EQ(1u, progress.checkpoint, "checkpoint after the stop");
+
+    dc_client_free(client);
+    dc_platform_mutex_destroy(&ctx.lock);
+}
+
+typedef struct {
+    int calls;
+    int updates;
+    int ephemeral;
+    dc_status_t result;
+    dc_snowflake_t last_id;
+} test_watchdog_defer_log_t;
+
+static dc_status_t test_watchdog_defer(void* user_data, dc_snowflake_t interaction_id,
+                                       const char* interaction_token, int update_message,
+                                       int ephemeral) {
+    test_watchdog_defer_log_t* log = (test_watchdog_defer_log_t*)user_data;
+    (void)interaction_token;
+    log->calls++;
+    log->updates += update_message;
+    log->ephemeral += ephemeral;
+    log->last_id = interaction_id;
+    return log->result;
+}
+
+static const char* test_watchdog_command =
+    "{\"id\":\"7001\",\"application_id\":\"900\",\"type\":2,\"token\":\"tok-a\",\"data\":{\"name\":\"slow\"}}";
+static const char* test_watchdog_component =
+    "{\"id\":\"7002\",\"application_id\":\"900\",\"type\":3,\"token\":\"tok-b\",\"data\":{\"custom_id\":\"x\"}}";
+static const char* test_watchdog_autocomplete =
+    "{\"id\":\"7003\",\"application_id\":\"900\",\"type\":4,\"token\":\"tok-c\"}";
+
+static void test_client_interaction_watchdog_core(void) {
+    test_watchdog_defer_log_t log;
+    memset(&log, 0, sizeof(log));
+    log.result = DC_OK;
+
+    dc_interaction_watchdog_config_t cfg;
+    dc_interaction_watchdog_config_init(&cfg);
+    TEST_ASSERT_EQ(2000u, cfg.deadline_ms, "watchdog default deadline");
+    dc_interaction_watchdog_t* wd = NULL;
+    TEST_ASSERT_EQ(DC_ERROR_NULL_POINTER, dc_interaction_watchdog_create(&cfg, &wd), "watchdog needs defer");
+    cfg.use_thread = 0;
+    cfg.defer_ephemeral = 1;
+    cfg.defer = test_watchdog_defer;
+    cfg.user_data = &log;
+    TEST_ASSERT_EQ(DC_OK, dc_interaction_watchdog_create(&cfg, &wd), "watchdog create");
+
+    TEST_ASSERT_EQ(DC_OK, dc_interaction_watchdog_track(wd, test_watchdog_command, 1000), "track command");
+    TEST_ASSERT_EQ(DC_OK, dc_interaction_watchdog_track(wd, test_watchdog_command, 1100), "duplicate ignored");
+    TEST_ASSERT_EQ(DC_OK, dc_interaction_watchdog_track(wd, test_watchdog_component, 1500), "track component");
+    TEST_ASSERT_EQ(DC_OK, dc_interaction_watchdog_track(wd, test_watchdog_autocomplete, 1500), "autocomplete ignored");
+    TEST_ASSERT_NEQ(DC_OK, dc_interaction_watchdog_track(wd, "{\"id\":\"1\",\"type\":2}", 1500),
+                    "payload without token rejected");
+
+    uint64_t next_ms = 0;
+    TEST_ASSERT(dc_interaction_watchdog_next_deadline(wd, &next_ms) && next_ms == 3000, "first deadline");
+    TEST_ASSERT_EQ(0u, dc_interaction_watchdog_poll(wd, 2999), "nothing due yet");
+
+    /* Responses in flight are never deferred */
+    dc_interaction_watchdog_claim_t claim = DC_WATCHDOG_DEFERRED_MESSAGE;
+    TEST_ASSERT_EQ(DC_OK, dc_interaction_watchdog_begin_response(wd, 7002, &claim, NULL), "claim component");
+    TEST_ASSERT_EQ(DC_WATCHDOG_RESPOND, claim, "pending interaction responds normally");
+    TEST_ASSERT_EQ(DC_OK, dc_interaction_watchdog_begin_response(wd, 7001, &claim, NULL), "claim command");
+    TEST_ASSERT_EQ(0u, dc_interaction_watchdog_poll(wd, 9000), "in-flight responses not deferred");
+    TEST_ASSERT(!dc_interaction_watchdog_next_deadline(wd, &next_ms), "no deadline while in flight");
+    dc_interaction_watchdog_end_response(wd, 7002, DC_OK);
+
+    /* A failed response puts the command back; it is past its deadline */
+    dc_interaction_watchdog_end_response(wd, 7001, DC_ERROR_NETWORK);
+    TEST_ASSERT_EQ(1u, dc_interaction_watchdog_poll(wd, 3000), "failed response deferred at deadline");
+    TEST_ASSERT_EQ(1, log.calls, "one deferral sent");
+    TEST_ASSERT_EQ(0, log.updates, "command deferred as message");
+    TEST_ASSERT_EQ(1, log.ephemeral, "deferral ephemeral");
+    TEST_ASSERT_EQ((dc_snowflake_t)7001, log.last_id, "deferred interaction id");
+
+    dc_snowflake_t app_id = 0;
+    TEST_ASSERT_EQ(DC_OK, dc_interaction_watchdog_begin_response(wd, 7001, &claim, &app_id), "claim deferred");
+    TEST_ASSERT_EQ(DC_WATCHDOG_DEFERRED_MESSAGE, claim, "deferred claim");
+    TEST_ASSERT_EQ((dc_snowflake_t)900, app_id, "deferred application id");
+    dc_interaction_watchdog_end_response(wd, 7001, DC_OK);
+
+    /* Failed deferrals stop tracking; unanswered deferrals expire with the token */
+    log.result = DC_ERROR_BAD_REQUEST;
+    dc_interaction_watchdog_track(wd, "{\"id\":\"7004\",\"application_id\":\"900\",\"type\":5,\"token\":\"t\"}", 10000);
+    TEST_ASSERT_EQ(1u, dc_interaction_watchdog_poll(wd, 12000), "modal submit deferred");
+    log.result = DC_OK;
+    dc_interaction_watchdog_track(wd, "{\"id\":\"7005\",\"application_id\":\"900\",\"type\":3,\"token\":\"t\"}", 10000);
+    TEST_ASSERT_EQ(1u, dc_interaction_watchdog_poll(wd, 12000), "component deferred");
+    TEST_ASSERT_EQ(1, log.updates, "component deferred as update");
+    TEST_ASSERT_EQ(0u, dc_interaction_watchdog_poll(wd, 10000 + DC_INTERACTION_TOKEN_TTL_MS), "expiry sends nothing");
+
+    dc_interaction_watchdog_stats_t stats;
+    TEST_ASSERT_EQ(DC_OK, dc_interaction_watchdog_get_stats(wd, &stats), "watchdog stats");
+    TEST_ASSERT_EQ(4, (int)stats.tracked, "tracked count");
+    TEST_ASSERT_EQ(1, (int)stats.responded, "responded count");
+    TEST_ASSERT_EQ(3, (int)stats.missed_deadlines, "missed deadline count");
+    TEST_ASSERT_EQ(2, (int)stats.auto_deferred, "auto-deferred count");
+    TEST_ASSERT_EQ(1, (int)stats.defer_failures, "defer failure count");
+    TEST_ASSERT_EQ(1, (int)stats.converted, "converted count");
+    TEST_ASSERT_EQ(1, (int)stats.expired, "expired count");
+    TEST_ASSERT_EQ(0u, stats.pending, "nothing left pending");
+    dc_interaction_watchdog_free(wd);
+}
+
+typedef struct {
+    dc_platform_mutex_t lock;
+    int started;
+    int in_flight;
+    int max_in_flight;
+} test_watchdog_burst_t;
+
+/* Slow deferral: holds each call long enough for the others to overlap it. */
+static dc_status_t test_watchdog_slow_defer(void* user_data, dc_snowflake_t interaction_id,
+                                            const char* interaction_token, int update_message,
+                                            int ephemeral) {
+    test_watchdog_burst_t* burst = (test_watchdog_burst_t*)user_data;
+    (void)interaction_id;
+    (void)interaction_token;
+    (void)update_message;
+    (void)ephemeral;
+    dc_platform_mutex_lock(&burst->lock);
+    burst->started++;
+    burst->in_flight++;
+    if (burst->in_flight > burst->max_in_flight) burst->max_in_flight = burst->in_flight;
+    dc_platform_mutex_unlock(&burst->lock);
+    dc_platform_sleep_ms(200);
+    dc_platform_mutex_lock(&burst->lock);
+    burst->in_flight--;
+    dc_platform_mutex_unlock(&burst->lock);
+    return DC_OK;
+}
+
+static void test_client_interaction_watchdog_burst(void) {
+#if !defined(_WIN32)
+    test_watchdog_burst_t burst;
+    memset(&burst, 0, sizeof(burst));
+    TEST_ASSERT(dc_platform_mutex_init(&burst.lock), "burst lock init");
+
+    dc_interaction_watchdog_config_t cfg;
+    dc_interaction_watchdog_config_init(&cfg);
+    TEST_ASSERT_EQ(4u, cfg.defer_threads, "watchdog default defer threads");
+    cfg.defer_threads = 3;
+    cfg.defer = test_watchdog_slow_defer;
+    cfg.user_data = &burst;
+    dc_interaction_watchdog_t* wd = NULL;
+    TEST_ASSERT_EQ(DC_OK, dc_interaction_watchdog_create(&cfg, &wd), "threaded watchdog create");
+
+    uint64_t now_ms = 0;
+    dc_platform_now_monotonic_ms(&now_ms);
+    char payload[128];
+    for (int i = 0; i < 3; i++) {
+        snprintf(payload, sizeof(payload),
+                 "{\"id\":\"%d\",\"application_id\":\"900\",\"type\":2,\"token\":\"t%d\"}", 7101 + i, i);
+        TEST_ASSERT_EQ(DC_OK, dc_interaction_watchdog_track(wd, payload, now_ms - 5000), "track burst");
+    }
+    int started = 0;
+    for (int waited = 0; waited < 2000 && started < 3; waited += 5) {
+        dc_platform_sleep_ms(5);
+        dc_platform_mutex_lock(&burst.lock);
+        started = burst.started;
+        dc_platform_mutex_unlock(&burst.lock);
+    }
+    TEST_ASSERT_EQ(3, started, "burst deferrals started");
+
+    /* Blocks until the in-flight deferral settles, then reports it. */
+    dc_interaction_watchdog_claim_t claim = DC_WATCHDOG_RESPOND;
+    TEST_ASSERT_EQ(DC_OK, dc_interaction_watchdog_begin_response(wd, 7101, &claim, NULL),
+                   "claim during deferral");
+    TEST_ASSERT_EQ(DC_WATCHDOG_DEFERRED_MESSAGE, claim, "claim waits for the deferral");
+    dc_interaction_watchdog_end_response(wd, 7101, DC_OK);
+    dc_interaction_watchdog_free(wd);
+
+    TEST_ASSERT_EQ(3, burst.max_in_flight, "burst deferred concurrently");
+    dc_platform_mutex_destroy(&burst.lock);
+#endif
+}
+
+typedef struct {
+    int requests;
+    dc_http_method_t method;
+    dc_string_t url;
+    dc_string_t body;
+} test_watchdog_http_log_t;
+
+static dc_status_t test_watchdog_transport(void* userdata, const dc_http_request_t* request,
+                                           dc_http_response_t* response) {
+    test_watchdog_http_log_t* log = (test_watchdog_http_log_t*)userdata;
+    log->requests++;
+    log->method = request->method;
+    dc_string_set_cstr(&log->url, dc_string_cstr(&request->url));
+    dc_string_set_cstr(&log->body, dc_string_cstr(&request->body));
+    response->status_code = (request->method == DC_HTTP_POST && strstr(dc_string_cstr(&request->url), "/callback"))
+                                ? 204 : 200;
+    return dc_string_set_cstr(&response->body, response->status_code == 204 ? "" : "{\"id\":\"77\"}");
+}
+
+/* 1 if the body has @p key (with string value @p expected when given) */
+static int test_watchdog_body_has(const test_watchdog_http_log_t* log, const char* key, const char* expected) {
+    dc_json_doc_t doc;
+    if (dc_json_parse(dc_string_cstr(&log->body), &doc) != DC_OK) return 0;
+    yyjson_val* val = yyjson_obj_get(doc.root, key);
+    int ok = val != NULL && (!expected || (yyjson_is_str(val) && strcmp(yyjson_get_str(val), expected) == 0));
+    dc_json_doc_free(&doc);
+    return ok;
+}
+
+/* Integer at @p key, or inside "data" when @p in_data; -1 when absent */
+static int64_t test_watchdog_body_int(const test_watchdog_http_log_t* log, const char* key, int in_data) {
+    dc_json_doc_t doc;
+    if (dc_json_parse(dc_string_cstr(&log->body), &doc) != DC_OK) return -1;
+    yyjson_val* obj = in_data ? yyjson_obj_get(doc.root, "data") : doc.root;
+    yyjson_val* val = obj ? yyjson_obj_get(obj, key) : NULL;
+    int64_t out = (val && yyjson_is_int(val)) ? yyjson_get_sint(val) : -1;
+    dc_json_doc_free(&doc);
+    return out;
+}
+
+static void test_client_interaction_watchdog(void) {
+    test_watchdog_http_log_t log;
+    memset(&log, 0, sizeof(log));
+    dc_string_init(&log.url);
+    dc_string_init(&log.body);
+
+    dc_client_config_t cfg;
+    dc_client_config_init(&cfg);
+    cfg.token = "test_token";
+    cfg.rest_transport = test_watchdog_transport;
+    cfg.rest_transport_userdata = &log;
+    dc_client_t* client = NULL;
+    TEST_ASSERT_EQ(DC_OK, dc_client_create(&cfg, &client), "plain client create");
+    TEST_ASSERT_NULL(dc_client_get_interaction_watchdog(client), "watchdog off by default");
+    dc_interaction_watchdog_stats_t stats;
+    TEST_ASSERT_EQ(DC_ERROR_INVALID_STATE, dc_client_get_interaction_watchdog_stats(client, &stats),
+                   "no stats without watchdog");
+    dc_client_free(client);
+
+    cfg.interaction_watchdog = 1;
+    cfg.interaction_watchdog_ephemeral = 1;
+    TEST_ASSERT_EQ(DC_OK, dc_client_create(&cfg, &client), "watchdog client create");
+    dc_interaction_watchdog_t* wd = dc_client_get_interaction_watchdog(client);
+    TEST_ASSERT_NOT_NULL(wd, "watchdog on");
+
+    /* Arrived long ago: the deferral goes out from the watchdog thread or this poll. */
+    uint64_t now_ms = 0;
+    dc_platform_now_monotonic_ms(&now_ms);
+    TEST_ASSERT_EQ(DC_OK, dc_interaction_watchdog_track(wd, test_watchdog_command, now_ms - 5000),
+                   "track overdue command");
+    (void)dc_interaction_watchdog_poll(wd, now_ms);
+    dc_interaction_watchdog_claim_t claim = DC_WATCHDOG_RESPOND;
+    TEST_ASSERT_EQ(DC_OK, dc_interaction_watchdog_begin_response(wd, 7001, &claim, NULL), "peek claim");
+    dc_interaction_watchdog_end_response(wd, 7001, DC_ERROR_NETWORK);
+    TEST_ASSERT_EQ(DC_WATCHDOG_DEFERRED_MESSAGE, claim, "command auto-deferred");
+    TEST_ASSERT_EQ(1, log.requests, "one deferral request");
+    TEST_ASSERT_NOT_NULL(strstr(dc_string_cstr(&log.url), "/interactions/7001/tok-a/callback"), "deferral route");
+    TEST_ASSERT_EQ(5, (int)test_watchdog_body_int(&log, "type", 0), "deferred message callback");
+    TEST_ASSERT_EQ(64, (int)test_watchdog_body_int(&log, "flags", 1), "deferral ephemeral");
+
+    TEST_ASSERT_EQ(DC_OK, dc_client_interaction_respond_message(client, 7001, "tok-a", "done", 1),
+                   "late respond ok");
+    TEST_ASSERT_EQ(2, log.requests, "late respond sent once");
+    TEST_ASSERT_EQ(DC_HTTP_PATCH, log.method, "late respond is an edit");
+    TEST_ASSERT_NOT_NULL(strstr(dc_string_cstr(&log.url), "/webhooks/900/tok-a/messages/@original"),
+                         "late respond edits original");
+    TEST_ASSERT(test_watchdog_body_has(&log, "content", "done"), "edit content");
+    TEST_ASSERT(!test_watchdog_body_has(&log, "flags", NULL), "edit drops flags");
+
+    /* Once answered, the interaction is no longer tracked */
+    TEST_ASSERT_EQ(DC_OK, dc_client_interaction_respond_message(client, 7001, "tok-a", "again", 0),
+                   "untracked respond ok");
+    TEST_ASSERT_EQ(DC_HTTP_POST, log.method, "untracked respond is a callback");
+
+    /* Only EPHEMERAL is cleared on the edit; SUPPRESS_EMBEDS and IS_COMPONENTS_V2 stay */
+    TEST_ASSERT_EQ(DC_OK, dc_interaction_watchdog_track(wd, test_watchdog_command, now_ms - 5000),
+                   "track command again");
+    (void)dc_interaction_watchdog_poll(wd, now_ms);
+    TEST_ASSERT_EQ(DC_OK, dc_client_interaction_callback_json(client, 7001, "tok-a",
+                                                             DC_INTERACTION_CALLBACK_CHANNEL_MESSAGE_WITH_SOURCE,
+                                                             "{\"content\":\"v2\",\"flags\":32836}"),
+                   "late respond with flags ok");
+    TEST_ASSERT_EQ(DC_HTTP_PATCH, log.method, "late respond with flags is an edit");
+    TEST_ASSERT_EQ(32772, (int)test_watchdog_body_int(&log, "flags", 0), "edit keeps non-ephemeral flags");
+
+    /* A component deferred as an update turns a new message into a follow-up */
+    TEST_ASSERT_EQ(DC_OK, dc_interaction_watchdog_track(wd, test_watchdog_component, now_ms - 5000),
+                   "track overdue component");
+    (void)dc_interaction_watchdog_poll(wd, now_ms);
+    TEST_ASSERT_EQ(DC_OK, dc_client_interaction_defer_update(client, 7002, "tok-b"),
+                   "late deferral is a no-op");
+    TEST_ASSERT_EQ(DC_OK, dc_interaction_watchdog_track(wd, test_watchdog_component, now_ms - 5000),
+                   "track component again");
+    (void)dc_interaction_watchdog_poll(wd, now_ms);
+    int before = log.requests;
+    TEST_ASSERT_EQ(DC_OK, dc_client_interaction_respond_message(client, 7002, "tok-b", "new", 1),
+                   "late component message ok");
+    TEST_ASSERT_EQ(before + 1, log.requests, "late component message sent once");
+    TEST_ASSERT_EQ(DC_HTTP_POST, log.method, "follow-up is a POST");
+    TEST_ASSERT_NOT_NULL(strstr(dc_string_cstr(&log.url), "/webhooks/900/tok-b"), "follow-up route");
+    TEST_ASSERT(test_watchdog_body_has(&log, "flags", NULL), "follow-up keeps flags");
+
+    TEST_ASSERT_EQ(DC_OK, dc_client_get_interaction_watchdog_stats(client, &stats), "client watchdog stats");
+    TEST_ASSERT_EQ(4, (int)stats.auto_deferred, "client auto-deferred count");
+    TEST_ASSERT_EQ(4, (int)stats.missed_deadlines, "client missed deadline count");
+    TEST_ASSERT_EQ(4, (int)stats.converted, "client converted count");
+
+    dc_client_free(client);
+    dc_string_free(&log.url);
+    dc_string_free(&log.body);
+}
+
+typedef struct {
+    int requests;
+    int gets;
+    int patches;
+    int puts;
+    int deletes;
+    dc_string_t last_url;
+    dc_string_t last_patch;
+} test_roles_http_log_t;
+
+static dc_status_t test_roles_transport(void* userdata, const dc_http_request_t* request,
+                                        dc_http_response_t* response) {
+    test_roles_http_log_t* log = (test_roles_http_log_t*)userdata;
+    const char* url = dc_string_cstr(&request->url);
+    log->requests++;
+    dc_string_set_cstr(&log->last_url, url);
+    if (strstr(url, "/members/99")) {
+        response->status_code = 403;
+        return dc_string_set_cstr(&response->body, "{\"message\":\"Missing Permissions\",\"code\":50013}");
+    }
+    response->status_code = 200;
+    switch (request->method) {
+        case DC_HTTP_GET:
+            log->gets++;
+            return dc_string_set_cstr(&response->body, "{\"user\":{\"id\":\"22\"},\"roles\":[\"1\"]}");
+        case DC_HTTP_PATCH:
+            /* The member Discord returns has exactly the roles that were sent. */
+            log->patches++;
+            dc_string_set_cstr(&log->last_patch, dc_string_cstr(&request->body));
+            return dc_string_set_cstr(&response->body, dc_string_cstr(&request->body));
+        case DC_HTTP_PUT:
+            log->puts++;
+            break;
+        case DC_HTTP_DELETE:
+            log->deletes++;
+            break;
+        default:
+            break;
+    }
+    response->status_code = 204;
+    return dc_string_set_cstr(&response->body, "");
+}
+
+/* 1 if the last PATCH set exactly the roles in @p expected (a zero-terminated list) */
+static int test_roles_patch_is(const test_roles_http_log_t* log, const dc_snowflake_t* expected) {
+    dc_json_doc_t doc;
+    if (dc_json_parse(dc_string_cstr(&log->last_patch), &doc) != DC_OK) return 0;
+    yyjson_val* roles = yyjson_obj_get(doc.root, "roles");
+    size_t count = 0;
+    while (expected[count] != 0) count++;
+    int ok = roles && yyjson_is_arr(roles) && yyjson_arr_size(roles) == count;
+    for (size_t i = 0; ok && i < count; i++) {
+        int found = 0;
+        size_t idx = 0, max = 0;
+        yyjson_val* item = NULL;
+        yyjson_arr_foreach(roles, idx, max, item) {
+            dc_snowflake_t id = 0;
+            if (yyjson_is_str(item) && dc_snowflake_from_string(yyjson_get_str(item), &id) == DC_OK &&
+                id == expected[i]) {
+                found = 1;
+            }
+        }
+        ok = found;
+    }
+    dc_json_doc_free(&doc);
+    return ok;
+}
+
+typedef struct {
+    int calls;
+    dc_snowflake_t user_id;
+    dc_status_t status;
+} test_roles_result_t;
+
+static void test_roles_on_result(void* user_data, dc_snowflake_t guild_id, dc_snowflake_t user_id,
+                                 dc_status_t status) {
+    test_roles_result_t* r = (test_roles_result_t*)user_data;
+    (void)guild_id;
+    r->calls++;
+    r->user_id = user_id;
+    r->status = status;
+}
+
+static void test_client_role_coalescer(void) {
+    test_roles_http_log_t log;
+    memset(&log, 0, sizeof(log));
+    dc_string_init(&log.last_url);
+    dc_string_init(&log.last_patch);
+    test_roles_result_t result;
+    memset(&result, 0, sizeof(result));
+
+    dc_client_config_t cfg;
+    dc_client_config_init(&cfg);
+    cfg.token = "test_token";
+    cfg.rest_transport = test_roles_transport;
+    cfg.rest_transport_userdata = &log;
+    dc_client_t* client = NULL;
+    TEST_ASSERT_EQ(DC_OK, dc_client_create(&cfg, &client), "client create");
+    TEST_ASSERT_NULL(dc_client_get_role_coalescer(client), "coalescer off by default");
+    TEST_ASSERT_EQ(DC_ERROR_INVALID_STATE, dc_client_queue_add_guild_member_role(client, 10, 20, 3),
+                   "queue needs the coalescer");
+
+    dc_role_coalescer_config_t rc_cfg;
+    dc_role_coalescer_config_init(&rc_cfg);
+    TEST_ASSERT_EQ(250u, rc_cfg.window_ms, "default window");
+    TEST_ASSERT_EQ(30000u, rc_cfg.roles_ttl_ms, "default roles ttl");
+    TEST_ASSERT_EQ(1, rc_cfg.fetch_unknown, "fetch unknown by default");
+    rc_cfg.use_thread = 0;
+    rc_cfg.on_result = test_roles_on_result;
+    rc_cfg.user_data = &result;
+    dc_role_coalescer_t* co = NULL;
+    TEST_ASSERT_EQ(DC_OK, dc_role_coalescer_create(client, &rc_cfg, &co), "coalescer create");
+    TEST_ASSERT_EQ(DC_ERROR_INVALID_PARAM, dc_role_coalescer_add(co, 0, 20, 3, 1000), "invalid guild");
+
+    /* Known roles: four mutations become one PATCH with the final set */
+    const dc_snowflake_t known[] = {1, 2};
+    TEST_ASSERT_EQ(DC_OK, dc_role_coalescer_set_member_roles(co, 10, 20, known, 2, 1000), "seed roles");
+    TEST_ASSERT_EQ(DC_OK, dc_role_coalescer_add(co, 10, 20, 3, 1000), "queue add 3");
+    TEST_ASSERT_EQ(DC_OK, dc_role_coalescer_add(co, 10, 20, 4, 1005), "queue add 4");
+    TEST_ASSERT_EQ(DC_OK, dc_role_coalescer_remove(co, 10, 20, 1, 1010), "queue remove 1");
+    TEST_ASSERT_EQ(DC_OK, dc_role_coalescer_add(co, 10, 20, 2, 1010), "queue add held role");
+    uint64_t due = 0;
+    TEST_ASSERT(dc_role_coalescer_next_deadline(co, &due), "batch pending");
+    TEST_ASSERT_EQ(1250u, (unsigned)due, "window from first mutation");
+    TEST_ASSERT_EQ(0u, dc_role_coalescer_poll(co, 1100), "window still open");
+    TEST_ASSERT_EQ(0, log.requests, "nothing sent inside the window");
+    TEST_ASSERT_EQ(1u, dc_role_coalescer_poll(co, 1300), "batch flushed");
+    TEST_ASSERT_EQ(1, log.requests, "one request for four mutations");
+    TEST_ASSERT_EQ(1, log.patches, "sent as a PATCH");
+    TEST_ASSERT_NOT_NULL(strstr(dc_string_cstr(&log.last_url), "/guilds/10/members/20"), "member route");
+    const dc_snowflake_t final_set[] = {2, 3, 4, 0};
+    TEST_ASSERT(test_roles_patch_is(&log, final_set), "final role set");
+    TEST_ASSERT_EQ(1, result.calls, "result reported");
+    TEST_ASSERT_EQ(DC_OK, result.status, "batch ok");
+    TEST_ASSERT(!dc_role_coalescer_next_deadline(co, &due), "nothing pending");
+
+    /* The last mutation of a role wins; a batch that changes nothing sends nothing */
+    TEST_ASSERT_EQ(DC_OK, dc_role_coalescer_add(co, 10, 20, 5, 2000), "queue add 5");
+    TEST_ASSERT_EQ(DC_OK, dc_role_coalescer_remove(co, 10, 20, 5, 2001), "queue remove 5");
+    TEST_ASSERT_EQ(1u, dc_role_coalescer_poll(co, 2300), "no-op batch flushed");
+    TEST_ASSERT_EQ(1, log.requests, "no-op batch sends nothing");
+
+    /* A single change uses the role route */
+    TEST_ASSERT_EQ(DC_OK, dc_role_coalescer_add(co, 10, 20, 6, 3000), "queue add 6");
+    TEST_ASSERT_EQ(1u, dc_role_coalescer_poll(co, 3300), "single flushed");
+    TEST_ASSERT_EQ(1, log.puts, "single add is a PUT");
+    TEST_ASSERT_NOT_NULL(strstr(dc_string_cstr(&log.last_url), "/guilds/10/members/20/roles/6"), "role route");
+
+    /* Unknown member, two mutations: individual calls */
+    TEST_ASSERT_EQ(DC_OK, dc_role_coalescer_add(co, 10, 21, 7, 4000), "unknown add");
+    TEST_ASSERT_EQ(DC_OK, dc_role_coalescer_remove(co, 10, 21, 8, 4000), "unknown remove");
+    TEST_ASSERT_EQ(1u, dc_role_coalescer_poll(co, 4300), "unknown flushed");
+    TEST_ASSERT_EQ(2, log.puts, "unknown add call");
+    TEST_ASSERT_EQ(1, log.deletes, "unknown remove call");
+
+    /* Unknown member, three mutations: fetch, then one PATCH */
+    TEST_ASSERT_EQ(DC_OK, dc_role_coalescer_add(co, 10, 22, 7, 5000), "fetch add 7");
+    TEST_ASSERT_EQ(DC_OK, dc_role_coalescer_add(co, 10, 22, 8, 5000), "fetch add 8");
+    TEST_ASSERT_EQ(DC_OK, dc_role_coalescer_remove(co, 10, 22, 1, 5000), "fetch remove 1");
+    TEST_ASSERT_EQ(1u, dc_role_coalescer_poll(co, 5300), "fetched batch flushed");
+    TEST_ASSERT_EQ(1, log.gets, "member fetched");
+    TEST_ASSERT_EQ(2, log.patches, "then patched");
+    const dc_snowflake_t fetched_set[] = {7, 8, 0};
+    TEST_ASSERT(test_roles_patch_is(&log, fetched_set), "fetched role set");
+
+    /* Roles from gateway members; stale ones are not trusted */
+    const char* member_update =
+        "{\"guild_id\":\"10\",\"user\":{\"id\":\"24\"},\"roles\":[\"1\",\"2\"]}";
+    TEST_ASSERT_EQ(DC_OK, dc_role_coalescer_feed_event(co, "GUILD_MEMBER_UPDATE", member_update, 6000),
+                   "feed member update");
+    TEST_ASSERT_EQ(DC_OK, dc_role_coalescer_remove(co, 10, 24, 1, 6000), "fed remove 1");
+    TEST_ASSERT_EQ(DC_OK, dc_role_coalescer_add(co, 10, 24, 9, 6000), "fed add 9");
+    TEST_ASSERT_EQ(1u, dc_role_coalescer_poll(co, 6300), "fed batch flushed");
+    TEST_ASSERT_EQ(3, log.patches, "fed member patched");
+    const dc_snowflake_t fed_set[] = {2, 9, 0};
+    TEST_ASSERT(test_roles_patch_is(&log, fed_set), "fed role set");
+
+    dc_role_coalescer_stats_t stats;
+    TEST_ASSERT_EQ(DC_OK, dc_role_coalescer_get_stats(co, &stats), "stats");
+    TEST_ASSERT_EQ(3u, stats.cached, "three members cached");
+    const char* member_remove = "{\"guild_id\":\"10\",\"user\":{\"id\":\"24\"}}";
+    TEST_ASSERT_EQ(DC_OK, dc_role_coalescer_feed_event(co, "GUILD_MEMBER_REMOVE", member_remove, 6400),
+                   "feed member remove");
+    TEST_ASSERT_EQ(DC_OK, dc_role_coalescer_get_stats(co, &stats), "stats after remove");
+    TEST_ASSERT_EQ(2u, stats.cached, "removed member forgotten");
+    TEST_ASSERT_EQ(0u, dc_role_coalescer_poll(co, 40000), "nothing due");
+    TEST_ASSERT_EQ(DC_OK, dc_role_coalescer_get_stats(co, &stats), "stats after ttl");
+    TEST_ASSERT_EQ(0u, stats.cached, "stale roles dropped");
+    TEST_ASSERT_EQ(DC_OK, dc_role_coalescer_add(co, 10, 20, 3, 40000), "stale add");
+    TEST_ASSERT_EQ(DC_OK, dc_role_coalescer_add(co, 10, 20, 4, 40000), "stale add 2");
+    int puts_before = log.puts;
+    TEST_ASSERT_EQ(1u, dc_role_coalescer_poll(co, 40300), "stale batch flushed");
+    TEST_ASSERT_EQ(puts_before + 2, log.puts, "stale member uses individual calls");
+
+    /* Failures reach the result callback */
+    TEST_ASSERT_EQ(DC_OK, dc_role_coalescer_add(co, 10, 99, 3, 50000), "forbidden add");
+    TEST_ASSERT_EQ(1u, dc_role_coalescer_flush(co), "flush ignores the window");
+    TEST_ASSERT_EQ(99u, (unsigned)result.user_id, "failed member reported");
+    TEST_ASSERT(result.status != DC_OK, "failure reported");
+
+    TEST_ASSERT_EQ(DC_OK, dc_role_coalescer_get_stats(co, &stats), "final stats");
+    TEST_ASSERT_EQ(17u, (unsigned)stats.queued, "queued count");
+    TEST_ASSERT_EQ(1u, (unsigned)stats.superseded, "superseded count");
+    TEST_ASSERT_EQ(8u, (unsigned)stats.batches, "batch count");
+    TEST_ASSERT_EQ(10u, (unsigned)stats.requests, "request count");
+    TEST_ASSERT_EQ(3u, (unsigned)stats.patches, "patch count");
+    TEST_ASSERT_EQ(1u, (unsigned)stats.fetches, "fetch count");
+    TEST_ASSERT_EQ(6u, (unsigned)stats.individual, "individual count");
+    TEST_ASSERT_EQ(1u, (unsigned)stats.unchanged, "unchanged count");
+    TEST_ASSERT_EQ(1u, (unsigned)stats.failures, "failure count");
+    TEST_ASSERT_EQ(0u, stats.pending, "nothing pending");
+    dc_role_coalescer_free(co);
+    dc_client_free(client);
+
+    /* Client-owned coalescer: queued mutations are flushed when the client is freed */
+    cfg.role_coalescer = 1;
+    cfg.role_coalescer_window_ms = 60000;
+    TEST_ASSERT_EQ(DC_OK, dc_client_create(&cfg, &client), "coalescing client create");
+    TEST_ASSERT_NOT_NULL(dc_client_get_role_coalescer(client), "coalescer on");
+    int before = log.requests;
+    TEST_ASSERT_EQ(DC_OK, dc_client_queue_add_guild_member_role(client, 10, 30, 3), "client queue add");
+    TEST_ASSERT_EQ(DC_OK, dc_client_queue_remove_guild_member_role(client, 10, 30, 4), "client queue remove");
+    TEST_ASSERT_EQ(DC_OK, dc_client_get_role_coalescer_stats(client, &stats), "client stats");
+    TEST_ASSERT_EQ(1u, stats.pending, "client batch pending");
+    TEST_ASSERT_EQ(before, log.requests, "client batch waits for the window");
+    dc_client_free(client);
+    TEST_ASSERT_EQ(before + 2, log.requests, "free flushes queued mutations");
+
+    /* Without GUILD_MEMBERS observed roles are not trusted: the member is fetched before the PATCH */
+    uint64_t now = 0;
+    const dc_snowflake_t seen[] = {1, 2};
+    TEST_ASSERT_EQ(DC_CLIENT_ROLES_TTL_AUTO, cfg.role_coalescer_roles_ttl_ms, "roles ttl follows intents");
+    TEST_ASSERT_EQ(DC_OK, dc_client_create(&cfg, &client), "untrusting client create");
+    dc_platform_now_monotonic_ms(&now);
+    TEST_ASSERT_EQ(DC_OK, dc_role_coalescer_set_member_roles(dc_client_get_role_coalescer(client), 10, 31,
+                                                             seen, 2, now), "seed untrusted roles");
+    TEST_ASSERT_EQ(DC_OK, dc_client_queue_add_guild_member_role(client, 10, 31, 3), "untrusted add 3");
+    TEST_ASSERT_EQ(DC_OK, dc_client_queue_add_guild_member_role(client, 10, 31, 4), "untrusted add 4");
+    TEST_ASSERT_EQ(DC_OK, dc_client_queue_remove_guild_member_role(client, 10, 31, 1), "untrusted remove 1");
+    int gets_before = log.gets;
+    int patches_before = log.patches;
+    dc_client_free(client);
+    TEST_ASSERT_EQ(gets_before + 1, log.gets, "untrusted member fetched");
+    TEST_ASSERT_EQ(patches_before + 1, log.patches, "untrusted member patched");
+
+    cfg.intents = DC_INTENT_GUILD_MEMBERS;
+    TEST_ASSERT_EQ(DC_OK, dc_client_create(&cfg, &client), "trusting client create");
+    dc_platform_now_monotonic_ms(&now);
+    TEST_ASSERT_EQ(DC_OK, dc_role_coalescer_set_member_roles(dc_client_get_role_coalescer(client), 10, 32,
+                                                             seen, 2, now), "seed trusted roles");
+    TEST_ASSERT_EQ(DC_OK, dc_client_queue_add_guild_member_role(client, 10, 32, 3), "trusted add 3");
+    TEST_ASSERT_EQ(DC_OK, dc_client_queue_add_guild_member_role(client, 10, 32, 4), "trusted add 4");
+    TEST_ASSERT_EQ(DC_OK, dc_client_queue_remove_guild_member_role(client, 10, 32, 1), "trusted remove 1");
+    gets_before = log.gets;
+    dc_client_free(client);
+    TEST_ASSERT_EQ(gets_before, log.gets, "trusted member not fetched");
+    TEST_ASSERT_EQ(patches_before + 2, log.patches, "trusted member patched");
+
+    dc_string_free(&log.last_url);
+    dc_string_free(&log.last_patch);
+}
+
+typedef struct {
+    int lists;
+    int creates;
+    int executes;
+    int fail_create;
+    dc_snowflake_t deleted_below;   /* executes on webhooks with a lower ID answer 404 */
+    int uses[32];                   /* executes per webhook, indexed by ID - 600 */
+    dc_string_t last_url;
+} test_relay_http_log_t;
+
+static void test_relay_add_header(dc_http_response_t* response, const char* name, const char* value) {
+    dc_http_header_t header;
+    dc_string_init_from_cstr(&header.name, name);
+    dc_string_init_from_cstr(&header.value, value);
+    dc_vec_push(&response->headers, &header);
+}
+
+static dc_status_t test_relay_transport(void* userdata, const dc_http_request_t* request,
+                                        dc_http_response_t* response) {
+    test_relay_http_log_t* log = (test_relay_http_log_t*)userdata;
+    const char* url = dc_string_cstr(&request->url);
+    dc_string_set_cstr(&log->last_url, url);
+    if (strstr(url, "/channels/")) {
+        if (request->method == DC_HTTP_GET) {
+            log->lists++;
+            response->status_code = 200;
+            if (strstr(url, "/channels/50/")) {
+                return dc_string_set_cstr(&response->body,
+                    "[{\"id\":\"601\",\"type\":1,\"name\":\"Relay\",\"token\":\"t601\"},"
+                    "{\"id\":\"602\",\"type\":1,\"name\":\"Other\",\"token\":\"t602\"},"
+                    "{\"id\":\"603\",\"type\":2,\"name\":\"Relay\"}]");
+            }
+            return dc_string_set_cstr(&response->body, "[]");
+        }
+        if (log->fail_create) {
+            response->status_code = 403;
+            return dc_string_set_cstr(&response->body, "{\"message\":\"Missing Permissions\",\"code\":50013}");
+        }
+        unsigned id = 611u + (unsigned)log->creates++;
+        response->status_code = 200;
+        return dc_string_printf(&response->body, "{\"id\":\"%u\",\"type\":1,\"name\":\"Relay\",\"token\":\"t%u\"}",
+                                id, id);
+    }
+
+    dc_snowflake_t id = 0;
+    const char* p = strstr(url, "/webhooks/");
+    if (p) id = (dc_snowflake_t)strtoull(p + strlen("/webhooks/"), NULL, 10);
+    log->executes++;
+    if (id < log->deleted_below || id < 600 || id >= 632) {
+        response->status_code = 404;
+        return dc_string_set_cstr(&response->body, "{\"message\":\"Unknown Webhook\",\"code\":10015}");
+    }
+    int used = ++log->uses[id - 600];
+    char remaining[16];
+    char bucket[32];
+    snprintf(remaining, sizeof(remaining), "%d", 5 - used);
+    snprintf(bucket, sizeof(bucket), "wh-%u", (unsigned)id);
+    test_relay_add_header(response, "X-RateLimit-Limit", "5");
+    test_relay_add_header(response, "X-RateLimit-Remaining", remaining);
+    test_relay_add_header(response, "X-RateLimit-Reset-After", "10");
+    test_relay_add_header(response, "X-RateLimit-Bucket", bucket);
+    response->status_code = 200;
+    return dc_string_set_cstr(&response->body, "{\"id\":\"900\",\"channel_id\":\"50\"}");
+}
+
+static void test_client_webhook_relay(void) {
+    test_relay_http_log_t log;
+    memset(&log, 0, sizeof(log));
+    dc_string_init(&log.last_url);
+
+    dc_client_config_t cfg;
+    dc_client_config_init(&cfg);
+    cfg.token = "test_token";
+    cfg.rest_transport = test_relay_transport;
+    cfg.rest_transport_userdata = &log;
+    dc_client_t* client = NULL;
+    TEST_ASSERT_EQ(DC_OK, dc_client_create(&cfg, &client), "client create");
+
+    dc_webhook_relay_config_t rcfg;
+    dc_webhook_relay_config_init(&rcfg);
+    TEST_ASSERT_EQ(4u, rcfg.webhook_count, "default webhook count");
+    TEST_ASSERT_EQ(3u, rcfg.max_attempts, "default attempts");
+    TEST_ASSERT_STR_EQ("Relay", rcfg.webhook_name, "default webhook name");
+    dc_webhook_relay_t* relay = NULL;
+    TEST_ASSERT_EQ(DC_ERROR_INVALID_PARAM, dc_webhook_relay_create(client, &rcfg, &relay), "channel required");
+    rcfg.channel_id = 50;
+    rcfg.webhook_count = 16;
+    TEST_ASSERT_EQ(DC_ERROR_INVALID_PARAM, dc_webhook_relay_create(client, &rcfg, &relay), "count over the channel cap");
+
+    /* Nothing to adopt and no permission to create */
+    rcfg.channel_id = 51;
+    rcfg.webhook_count = 3;
+    log.fail_create = 1;
+    TEST_ASSERT_EQ(DC_ERROR_FORBIDDEN, dc_webhook_relay_create(client, &rcfg, &relay), "no webhook obtained");
+    TEST_ASSERT_NULL(relay, "no pool on failure");
+    log.fail_create = 0;
+
+    /* The named incoming webhook is adopted, the rest are created */
+    rcfg.channel_id = 50;
+    TEST_ASSERT_EQ(DC_OK, dc_webhook_relay_create(client, &rcfg, &relay), "relay create");
+    dc_webhook_relay_stats_t stats;
+    TEST_ASSERT_EQ(DC_OK, dc_webhook_relay_get_stats(relay, &stats), "stats");
+    TEST_ASSERT_EQ(1u, (unsigned)stats.adopted, "one webhook adopted");
+    TEST_ASSERT_EQ(2u, (unsigned)stats.created, "two webhooks created");
+    TEST_ASSERT_EQ(3u, stats.webhooks, "three webhooks usable");
+
+    /* Sends spread over the webhooks by remaining budget */
+    for (int i = 0; i < 6; i++) {
+        TEST_ASSERT_EQ(DC_OK, dc_webhook_relay_send(relay, 0, "{\"content\":\"hi\",\"username\":\"u\"}", NULL),
+                       "relay send");
+    }
+    TEST_ASSERT_EQ(2, log.uses[1], "adopted webhook used twice");
+    TEST_ASSERT_EQ(2, log.uses[11], "first created webhook used twice");
+    TEST_ASSERT_EQ(2, log.uses[12], "second created webhook used twice");
+    dc_rest_route_budget_t budget;
+    TEST_ASSERT_EQ(DC_OK, dc_client_get_route_budget(client, DC_HTTP_POST, "/webhooks/601/t601", &budget),
+                   "route budget");
+    TEST_ASSERT(budget.known, "webhook budget known");
+    TEST_ASSERT_EQ(5u, budget.limit, "webhook limit");
+    TEST_ASSERT_EQ(3u, budget.remaining, "webhook remaining");
+
+    /* Ordered sends, with the created message returned */
+    dc_string_t message;
+    dc_string_init(&message);
+    TEST_ASSERT_EQ(DC_OK, dc_webhook_relay_send(relay, 77, "{\"content\":\"a\"}", &message), "ordered send");
+    TEST_ASSERT_NOT_NULL(strstr(dc_string_cstr(&log.last_url), "wait=true"), "send waits for the message");
+    TEST_ASSERT_NOT_NULL(strstr(dc_string_cstr(&message), "900"), "message returned");
+    TEST_ASSERT_EQ(DC_OK, dc_webhook_relay_send(relay, 77, "{\"content\":\"b\"}", NULL), "second ordered send");
+    TEST_ASSERT_EQ(DC_OK, dc_webhook_relay_get_stats(relay, &stats), "stats after ordered sends");
+    TEST_ASSERT_EQ(0u, (unsigned)stats.ordered_waits, "sequential sends do not wait");
+    TEST_ASSERT_EQ(0u, stats.in_flight, "nothing in flight");
+
+    /* A deleted webhook is replaced and the message retried */
+    log.deleted_below = 613;
+    int creates = log.creates;
+    TEST_ASSERT_EQ(DC_OK, dc_webhook_relay_send(relay, 0, "{\"content\":\"c\"}", NULL), "send after delete");
+    TEST_ASSERT_EQ(creates + 1, log.creates, "replacement created");
+    TEST_ASSERT_EQ(1, log.uses[13], "retried through the replacement");
+
+    /* Every webhook gone and none can be created: the message fails */
+    log.deleted_below = 700;
+    log.fail_create = 1;
+    TEST_ASSERT_EQ(DC_ERROR_NOT_FOUND, dc_webhook_relay_send(relay, 0, "{\"content\":\"d\"}", NULL),
+                   "send gives up after max_attempts");
+    TEST_ASSERT_EQ(DC_ERROR_UNAVAILABLE, dc_webhook_relay_send(relay, 0, "{\"content\":\"e\"}", NULL),
+                   "send without webhooks");
+    TEST_ASSERT_EQ(DC_OK, dc_webhook_relay_get_stats(relay, &stats), "final stats");
+    TEST_ASSERT_EQ(9u, (unsigned)stats.sends, "send count");
+    TEST_ASSERT_EQ(2u, (unsigned)stats.failures, "failure count");
+    TEST_ASSERT_EQ(3u, (unsigned)stats.created, "created count");
+    TEST_ASSERT_EQ(4u, (unsigned)stats.lost, "lost count");
+    TEST_ASSERT_EQ(0u, stats.webhooks, "no webhook left");
+    TEST_ASSERT_EQ(DC_ERROR_NULL_POINTER, dc_webhook_relay_send(relay, 0, NULL, NULL), "null body");
+
+    dc_string_free(&message);
+    dc_webhook_relay_free(relay);
+    dc_client_free(client);
+    dc_string_free(&log.last_url);
+}
+
+typedef struct {
+    int requests;
+    dc_poll_tally_t* tally;     /* fed a vote while answer 2 is being paged */
+} test_poll_http_log_t;
+
+static const char* test_poll_vote_json(char* buf, size_t size, unsigned user, unsigned answer) {
+    snprintf(buf, size, "{\"user_id\":\"%u\",\"channel_id\":\"60\",\"message_id\":\"70\",\"guild_id\":\"5\","
+             "\"answer_id\":%u}", user, answer);
+    return buf;
+}
+
+/* Answer 1 has voters 1001..1150, answer 2 has 2001 and 2002; message 71 fails. */
+static dc_status_t test_poll_transport(void* userdata, const dc_http_request_t* request,
+                                       dc_http_response_t* response) {
+    test_poll_http_log_t* log = (test_poll_http_log_t*)userdata;
+    const char* url = dc_string_cstr(&request->url);
+    log->requests++;
+    if (strstr(url, "/polls/71/")) {
+        response->status_code = 403;
+        return dc_string_set_cstr(&response->body, "{\"message\":\"Missing Access\",\"code\":50001}");
+    }
+    const char* answer_str = strstr(url, "/answers/");
+    unsigned answer = answer_str ? (unsigned)strtoul(answer_str + strlen("/answers/"), NULL, 10) : 0;
+    const char* after_str = strstr(url, "after=");
+    unsigned after = after_str ? (unsigned)strtoul(after_str + strlen("after="), NULL, 10) : 0;
+    unsigned first = 0, last = 0;
+    if (answer == 1) {
+        first = 1001;
+        last = 1150;
+    } else if (answer == 2) {
+        first = 2001;
+        last = 2002;
+        if (log->tally) {
+            /* 2001 takes back the vote after Discord built this page. */
+            char vote[192];
+            dc_poll_tally_feed_event(log->tally, "MESSAGE_POLL_VOTE_REMOVE", test_poll_vote_json(vote, sizeof(vote), 2001, 2));
+            dc_poll_tally_feed_event(log->tally, "MESSAGE_POLL_VOTE_ADD", test_poll_vote_json(vote, sizeof(vote), 3005, 3));
+            log->tally = NULL;
+        }
+    }
+    if (after >= first) first = after + 1;
+    dc_string_set_cstr(&response->body, "{\"users\":[");
+    unsigned count = 0;
+    for (unsigned id = first; first != 0 && id <= last && count < 100; id++, count++) {
+        dc_string_append_printf(&response->body, "%s{\"id\":\"%u\",\"username\":\"u\"}", count ? "," : "", id);
+    }
+    response->status_code = 200;
+    return dc_string_append_cstr(&response->body, "]}");
+}
+
+static void test_client_poll_tally(void) {
+    test_poll_http_log_t log;
+    memset(&log, 0, sizeof(log));
+    char vote[192];
+
+    dc_client_config_t cfg;
+    dc_client_config_init(&cfg);
+    cfg.token = "test_token";
+    cfg.rest_transport = test_poll_transport;
+    cfg.rest_transport_userdata = &log;
+    dc_client_t* client = NULL;
+    TEST_ASSERT_EQ(DC_OK, dc_client_create(&cfg, &client), "client create");
+    TEST_ASSERT_NULL(dc_client_get_poll_tally(client), "tally off by default");
+
+    dc_poll_tally_config_t pt_cfg;
+    dc_poll_tally_config_init(&pt_cfg);
+    TEST_ASSERT_EQ(0, pt_cfg.track_voters, "voters off by default");
+    TEST_ASSERT_EQ(1024u, pt_cfg.max_polls, "default max polls");
+    pt_cfg.track_voters = 1;
+    pt_cfg.max_polls = 3;
+    dc_poll_tally_t* tally = NULL;
+    TEST_ASSERT_EQ(DC_OK, dc_poll_tally_create(client, &pt_cfg, &tally), "tally create");
+
+    /* Votes of untracked polls are ignored */
+    TEST_ASSERT_EQ(DC_OK, dc_poll_tally_feed_event(tally, "MESSAGE_POLL_VOTE_ADD",
+                                                   test_poll_vote_json(vote, sizeof(vote), 1, 1)),
+                   "untracked vote");
+    dc_poll_tally_result_t result;
+    TEST_ASSERT_EQ(DC_ERROR_NOT_FOUND, dc_poll_tally_get(tally, 70, &result), "poll not tracked");
+
+    /* Seeding pages every answer; votes dispatched meanwhile are merged */
+    TEST_ASSERT_EQ(DC_ERROR_INVALID_PARAM, dc_poll_tally_seed(tally, 60, 70, 11), "too many answers");
+    log.tally = tally;
+    TEST_ASSERT_EQ(DC_OK, dc_poll_tally_seed(tally, 60, 70, 3), "seed");
+    TEST_ASSERT_EQ(4, log.requests, "two pages for answer 1, one each for 2 and 3");
+    TEST_ASSERT_EQ(DC_OK, dc_poll_tally_get(tally, 70, &result), "seeded result");
+    TEST_ASSERT(result.seeded, "poll seeded");
+    TEST_ASSERT_EQ(60u, (unsigned)result.channel_id, "poll channel");
+    TEST_ASSERT_EQ(150u, result.votes[0], "answer 1 votes");
+    TEST_ASSERT_EQ(1u, result.votes[1], "vote removed during seeding stays removed");
+    TEST_ASSERT_EQ(1u, result.votes[2], "vote added during seeding counted");
+    TEST_ASSERT_EQ(152u, result.total_votes, "total votes");
+
+    /* Incremental updates, idempotent with voter sets */
+    TEST_ASSERT_EQ(DC_OK, dc_poll_tally_feed_event(tally, "MESSAGE_POLL_VOTE_ADD",
+                                                   test_poll_vote_json(vote, sizeof(vote), 4000, 2)),
+                   "vote add");
+    TEST_ASSERT_EQ(DC_OK, dc_poll_tally_feed_event(tally, "MESSAGE_POLL_VOTE_ADD",
+                                                   test_poll_vote_json(vote, sizeof(vote), 4000, 2)),
+                   "repeated vote add");
+    TEST_ASSERT_EQ(DC_OK, dc_poll_tally_feed_event(tally, "MESSAGE_POLL_VOTE_REMOVE",
+                                                   test_poll_vote_json(vote, sizeof(vote), 1050, 1)),
+                   "vote remove");
+    TEST_ASSERT_EQ(DC_OK, dc_poll_tally_get(tally, 70, &result), "updated result");
+    TEST_ASSERT_EQ(149u, result.votes[0], "answer 1 after remove");
+    TEST_ASSERT_EQ(2u, result.votes[1], "answer 2 after add");
+    int voted = 0;
+    TEST_ASSERT_EQ(DC_OK, dc_poll_tally_has_voted(tally, 70, 2, 4000, &voted), "has voted");
+    TEST_ASSERT(voted, "new voter found");
+    TEST_ASSERT_EQ(DC_OK, dc_poll_tally_has_voted(tally, 70, 1, 1050, &voted), "has voted after remove");
+    TEST_ASSERT(!voted, "removed voter gone");
+    dc_vec_t voters;
+    dc_vec_init(&voters, sizeof(dc_snowflake_t));
+    TEST_ASSERT_EQ(DC_OK, dc_poll_tally_get_voters(tally, 70, 2, &voters), "get voters");
+    TEST_ASSERT_EQ(2u, (unsigned)dc_vec_length(&voters), "answer 2 voters");
+    TEST_ASSERT_EQ(2002u, (unsigned)*(dc_snowflake_t*)dc_vec_at(&voters, 0), "voters in ID order");
+    TEST_ASSERT_EQ(4000u, (unsigned)*(dc_snowflake_t*)dc_vec_at(&voters, 1), "last voter");
+
+    /* A poll the bot just sent starts at zero; a failed seed stops tracking */
+    TEST_ASSERT_EQ(DC_OK, dc_poll_tally_track(tally, 60, 72), "track new poll");
+    TEST_ASSERT_EQ(DC_OK, dc_poll_tally_get(tally, 72, &result), "new poll result");
+    TEST_ASSERT(result.seeded, "new poll needs no seed");
+    TEST_ASSERT_EQ(0u, result.total_votes, "new poll empty");
+    TEST_ASSERT_EQ(DC_ERROR_FORBIDDEN, dc_poll_tally_seed(tally, 60, 71, 2), "seed fails");
+    TEST_ASSERT_EQ(DC_ERROR_NOT_FOUND, dc_poll_tally_get(tally, 71, &result), "failed seed untracked");
+    TEST_ASSERT_EQ(DC_OK, dc_poll_tally_track(tally, 60, 73), "third poll");
+    TEST_ASSERT_EQ(DC_ERROR_BUFFER_TOO_SMALL, dc_poll_tally_track(tally, 60, 74), "max polls");
+
+    /* Deleted poll messages are dropped */
+    TEST_ASSERT_EQ(DC_OK, dc_poll_tally_feed_event(tally, "MESSAGE_DELETE",
+                                                   "{\"id\":\"72\",\"channel_id\":\"60\"}"),
+                   "feed delete");
+    TEST_ASSERT_EQ(DC_OK, dc_poll_tally_feed_event(tally, "MESSAGE_DELETE_BULK",
+                                                   "{\"ids\":[\"73\",\"9\"],\"channel_id\":\"60\"}"),
+                   "feed bulk delete");
+    dc_poll_tally_stats_t stats;
+    TEST_ASSERT_EQ(DC_OK, dc_poll_tally_get_stats(tally, &stats), "stats");
+    TEST_ASSERT_EQ(1u, stats.polls, "one poll left");
+    TEST_ASSERT_EQ(1u, (unsigned)stats.seeds, "one seed");
+    TEST_ASSERT_EQ(4u, (unsigned)stats.pages, "pages fetched");
+    TEST_ASSERT_EQ(1u, (unsigned)stats.ignored, "ignored votes");
+    TEST_ASSERT_EQ(2u, (unsigned)stats.duplicates, "duplicate votes");
+    TEST_ASSERT_EQ(2u, (unsigned)stats.votes_added, "votes added");
+    TEST_ASSERT_EQ(1u, (unsigned)stats.votes_removed, "votes removed");
+    dc_vec_free(&voters);
+    dc_poll_tally_free(tally);
+
+    /* Client-owned tally without voter sets */
+    cfg.poll_tally = 1;
+    dc_client_free(client);
+    TEST_ASSERT_EQ(DC_OK, dc_client_create(&cfg, &client), "tally client create");
+    tally = dc_client_get_poll_tally(client);
+    TEST_ASSERT_NOT_NULL(tally, "tally on");
+    TEST_ASSERT_EQ(DC_OK, dc_poll_tally_seed(tally, 60, 70, 2), "client seed");
+    TEST_ASSERT_EQ(DC_ERROR_INVALID_STATE, dc_poll_tally_has_voted(tally, 70, 1, 1001, &voted),
+                   "no voter sets");
+    TEST_ASSERT_EQ(DC_OK, dc_poll_tally_feed_event(tally, "MESSAGE_POLL_VOTE_ADD",
+                                                   test_poll_vote_json(vote, sizeof(vote), 4000, 1)),
+                   "count-only vote");
+    TEST_ASSERT_EQ(DC_OK, dc_poll_tally_get(tally, 70, &result), "count-only result");
+    TEST_ASSERT_EQ(151u, result.votes[0], "count-only answer 1");
+    TEST_ASSERT_EQ(2u, result.votes[1], "count-only answer 2");
+    dc_client_free(client);
+}
+
 static void test_client_null_guard_coverage(void) {
     TEST_ASSERT_EQ(DC_ERROR_NULL_POINTER, dc_client_start(NULL), "dc_client_start null client");
     TEST_ASSERT_EQ(DC_ERROR_NULL_POINTER, dc_client_start_with_gateway_url(NULL, NULL), "dc_client_start_with_gateway_url null client");
@@ -305,12 +1849,23 @@ static void test_client_null_guard_coverage(void) {
     TEST_ASSERT_EQ(DC_ERROR_NULL_POINTER, dc_client_update_current_user_application_role_connection_json(NULL, (dc_snowflake_t)0, NULL, NULL), "dc_client_update_current_user_application_role_connection_json null client");
     TEST_ASSERT_EQ(DC_ERROR_NULL_POINTER, dc_client_create_message(NULL, (dc_snowflake_t)0, NULL, NULL), "dc_client_create_message null client");
     TEST_ASSERT_EQ(DC_ERROR_NULL_POINTER, dc_client_create_message_json(NULL, (dc_snowflake_t)0, NULL, NULL), "dc_client_create_message_json null client");
+    TEST_ASSERT_EQ(DC_ERROR_NULL_POINTER, dc_client_create_message_with_uploads(NULL, (dc_snowflake_t)0, NULL, NULL, (size_t)0, NULL), "dc_client_create_message_with_uploads null client");
+    TEST_ASSERT_EQ(DC_ERROR_NULL_POINTER, dc_client_get_hedge_stats(NULL, NULL), "dc_client_get_hedge_stats null client");
+    TEST_ASSERT_EQ(DC_ERROR_NULL_POINTER, dc_client_wait_for(NULL, NULL, NULL), "dc_client_wait_for null client");
+    TEST_ASSERT_EQ(DC_ERROR_NULL_POINTER, dc_client_cancel_waiter(NULL, 0), "dc_client_cancel_waiter null client");
+    TEST_ASSERT_EQ(DC_ERROR_NULL_POINTER, dc_client_dispatch_to_waiters(NULL, NULL, NULL), "dc_client_dispatch_to_waiters null client");
+    TEST_ASSERT(dc_client_get_preflight(NULL) == NULL, "dc_client_get_preflight null client");
+    TEST_ASSERT_EQ(DC_ERROR_NULL_POINTER, dc_preflight_check(NULL, DC_HTTP_GET, "/", NULL), "dc_preflight_check null");
+    TEST_ASSERT_EQ(DC_ERROR_NULL_POINTER, dc_preflight_feed_event(NULL, "READY", "{}"), "dc_preflight_feed_event null");
     TEST_ASSERT_EQ(DC_ERROR_NULL_POINTER, dc_client_get_guild_json(NULL, (dc_snowflake_t)0, NULL), "dc_client_get_guild_json null client");
     TEST_ASSERT_EQ(DC_ERROR_NULL_POINTER, dc_client_get_guild(NULL, (dc_snowflake_t)0, NULL), "dc_client_get_guild null client");
     TEST_ASSERT_EQ(DC_ERROR_NULL_POINTER, dc_client_get_guild_channels_json(NULL, (dc_snowflake_t)0, NULL), "dc_client_get_guild_channels_json null client");
     TEST_ASSERT_EQ(DC_ERROR_NULL_POINTER, dc_client_get_guild_channels(NULL, (dc_snowflake_t)0, NULL), "dc_client_get_guild_channels null client");
     TEST_ASSERT_EQ(DC_ERROR_NULL_POINTER, dc_client_get_channel(NULL, (dc_snowflake_t)0, NULL), "dc_client_get_channel null client");
     TEST_ASSERT_EQ(DC_ERROR_NULL_POINTER, dc_client_modify_channel_json(NULL, (dc_snowflake_t)0, NULL, NULL), "dc_client_modify_channel_json null client");
+    TEST_ASSERT_EQ(DC_ERROR_NULL_POINTER, dc_client_modify_channel_diff(NULL, NULL, NULL, NULL), "dc_client_modify_channel_diff null client");
+    TEST_ASSERT_EQ(DC_ERROR_NULL_POINTER, dc_client_modify_guild_diff(NULL, NULL, NULL, NULL), "dc_client_modify_guild_diff null client");
+    TEST_ASSERT_EQ(DC_ERROR_NULL_POINTER, dc_client_modify_guild_role_diff(NULL, (dc_snowflake_t)0, NULL, NULL, NULL), "dc_client_modify_guild_role_diff null client");
     TEST_ASSERT_EQ(DC_ERROR_NULL_POINTER, dc_client_delete_channel(NULL, (dc_snowflake_t)0, NULL), "dc_client_delete_channel null client");
     TEST_ASSERT_EQ(DC_ERROR_NULL_POINTER, dc_client_list_channel_messages_json(NULL, (dc_snowflake_t)0, (uint32_t)0, (dc_snowflake_t)0, (dc_snowflake_t)0, (dc_snowflake_t)0, NULL), "dc_client_list_channel_messages_json null client");
     TEST_ASSERT_EQ(DC_ERROR_NULL_POINTER, dc_client_get_message(NULL, (dc_snowflake_t)0, (dc_snowflake_t)0, NULL), "dc_client_get_message null client");
@@ -403,6 +1958,7 @@ static void test_client_null_guard_coverage(void) {
     TEST_ASSERT_EQ(DC_ERROR_NULL_POINTER, dc_client_list_active_guild_threads_json(NULL, (dc_snowflake_t)0, NULL), "dc_client_list_active_guild_threads_json null client");
     TEST_ASSERT_EQ(DC_ERROR_NULL_POINTER, dc_client_search_guild_members_json(NULL, (dc_snowflake_t)0, NULL, (uint32_t)0, NULL), "dc_client_search_guild_members_json null client");
     TEST_ASSERT_EQ(DC_ERROR_NULL_POINTER, dc_client_modify_guild_member_json(NULL, (dc_snowflake_t)0, (dc_snowflake_t)0, NULL, NULL), "dc_client_modify_guild_member_json null client");
+    TEST_ASSERT_EQ(DC_ERROR_NULL_POINTER, dc_client_modify_guild_member_diff(NULL, (dc_snowflake_t)0, (dc_snowflake_t)0, NULL, NULL, NULL), "dc_client_modify_guild_member_diff null client");
     TEST_ASSERT_EQ(DC_ERROR_NULL_POINTER, dc_client_modify_current_member_json(NULL, (dc_snowflake_t)0, NULL, NULL), "dc_client_modify_current_member_json null client");
     TEST_ASSERT_EQ(DC_ERROR_NULL_POINTER, dc_client_modify_current_user_nick_json(NULL, (dc_snowflake_t)0, NULL, NULL), "dc_client_modify_current_user_nick_json null client");
     TEST_ASSERT_EQ(DC_ERROR_NULL_POINTER, dc_client_get_guild_bans_json(NULL, (dc_snowflake_t)0, (uint32_t)0, (dc_snowflake_t)0, (dc_snowflake_t)0, NULL), "dc_client_get_guild_bans_json null client");
@@ -501,6 +2057,19 @@ int main(void) {
     TEST_SUITE_BEGIN("Client API Tests");
     test_client_symbol_surface();
     test_client_config_and_lifecycle();
+    test_client_hedged_message_nonce();
+    test_client_waiter_registry();
+    test_client_waiters();
+    test_client_json_out_moves_body();
+    test_client_modify_diff();
+    test_client_permission_preflight();
+    test_client_command_deploy();
+    test_client_interaction_watchdog_core();
+    test_client_interaction_watchdog_burst();
+    test_client_interaction_watchdog();
+    test_client_role_coalescer();
+    test_client_webhook_relay();
+    test_client_poll_tally();
     test_client_null_guard_coverage();
     TEST_SUITE_END("Client API Tests");
 }
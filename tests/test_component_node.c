@@ -0,0 +1,143 @@
+/**
+ * @file test_component_node.c
+ * @brief Compact component tree tests
+ */
+
+#include "test_utils.h"
+#include "json/dc_json.h"
+#include "json/dc_json_component_node.h"
+#include <yyjson.h>
+
+static const char* test_layout =
+    "[{\"type\":17,\"accent_color\":3447003,\"components\":["
+    "{\"type\":10,\"id\":1,\"content\":\"# Title\"},"
+    "{\"type\":9,\"components\":[{\"type\":10,\"content\":\"left\"}],"
+    "\"accessory\":{\"type\":11,\"media\":{\"url\":\"https://cdn.example/a.png\",\"width\":64}}},"
+    "{\"type\":14,\"divider\":true,\"spacing\":2},"
+    "{\"type\":12,\"items\":[{\"media\":{\"url\":\"https://cdn.example/b.png\"},\"spoiler\":true}]},"
+    "{\"type\":1,\"components\":["
+    "{\"type\":2,\"style\":1,\"custom_id\":\"ok\",\"label\":\"OK\",\"emoji\":{\"name\":\"\\u2705\"}},"
+    "{\"type\":2,\"style\":5,\"url\":\"https://example.com\",\"label\":\"Docs\",\"disabled\":false}]},"
+    "{\"type\":1,\"components\":[{\"type\":3,\"custom_id\":\"pick\",\"min_values\":1,"
+    "\"options\":[{\"label\":\"A\",\"value\":\"a\",\"default\":true},{\"label\":\"B\",\"value\":\"b\"}]}]},"
+    "{\"type\":1,\"components\":[{\"type\":8,\"custom_id\":\"ch\",\"channel_types\":[0,5],"
+    "\"default_values\":[{\"id\":\"42\",\"type\":\"channel\"}]}]}"
+    "]}]";
+
+int test_component_node_main(void) {
+    TEST_SUITE_BEGIN("Component Node Tests");
+
+    dc_arena_t arena;
+    dc_arena_init(&arena, 0);
+    dc_component_children_t list = {0};
+
+    TEST_ASSERT(sizeof(dc_component_node_t) * 4 < sizeof(dc_component_t), "node is a fraction of dc_component_t");
+
+    TEST_ASSERT_EQ(DC_OK, dc_json_component_nodes_parse(test_layout, &arena, &list), "decode layout");
+    TEST_ASSERT_EQ(1u, list.count, "one top-level container");
+    TEST_ASSERT_EQ(14u, dc_component_tree_count(&list), "node count includes accessory");
+
+    dc_component_node_t* container = list.first;
+    TEST_ASSERT_EQ(DC_COMPONENT_TYPE_CONTAINER, container->type, "container type");
+    TEST_ASSERT_EQ(3447003, container->as.container.accent_color, "accent color");
+    TEST_ASSERT_EQ(DC_COMPONENT_BOOL_UNSET, container->as.container.spoiler, "absent bool unset");
+    TEST_ASSERT_EQ(DC_COMPONENT_UNSET, container->id, "absent id unset");
+    TEST_ASSERT_EQ(7u, container->as.container.components.count, "container children");
+
+    dc_component_node_t* text = container->as.container.components.first;
+    TEST_ASSERT_EQ(1, text->id, "text id");
+    TEST_ASSERT_STR_EQ("# Title", text->as.text_display.content, "text content");
+
+    dc_component_node_t* section = text->next;
+    TEST_ASSERT(section->as.section.accessory != NULL, "section accessory");
+    TEST_ASSERT_STR_EQ("https://cdn.example/a.png", section->as.section.accessory->as.thumbnail.media.url,
+                       "thumbnail url");
+    TEST_ASSERT_EQ(64, section->as.section.accessory->as.thumbnail.media.width, "thumbnail width");
+    TEST_ASSERT_EQ(DC_COMPONENT_UNSET, section->as.section.accessory->as.thumbnail.media.height,
+                   "thumbnail height unset");
+
+    dc_component_node_t* gallery = section->next->next;
+    TEST_ASSERT_EQ(1u, gallery->as.media_gallery.item_count, "gallery items");
+    TEST_ASSERT_EQ(1, gallery->as.media_gallery.items[0].spoiler, "gallery spoiler");
+
+    dc_component_node_t* buttons = gallery->next;
+    dc_component_node_t* ok = buttons->as.action_row.first;
+    TEST_ASSERT_STR_EQ("ok", ok->as.button.custom_id, "button custom_id");
+    TEST_ASSERT(ok->as.button.emoji && ok->as.button.emoji->id == 0, "unicode emoji has no id");
+    TEST_ASSERT_EQ(0, ok->next->as.button.disabled, "explicit false kept");
+    TEST_ASSERT_NULL(ok->next->as.button.custom_id, "link button has no custom_id");
+
+    dc_component_node_t* select = buttons->next->as.action_row.first;
+    TEST_ASSERT_EQ(2u, select->as.select.option_count, "select options");
+    TEST_ASSERT_STR_EQ("b", select->as.select.options[1].value, "option value");
+    TEST_ASSERT_EQ(1, select->as.select.options[0].default_val, "option default");
+    TEST_ASSERT_EQ(DC_COMPONENT_UNSET, select->as.select.max_values, "max_values unset");
+
+    dc_component_node_t* channels = buttons->next->next->as.action_row.first;
+    TEST_ASSERT_EQ(2u, channels->as.select.channel_type_count, "channel types");
+    TEST_ASSERT_EQ(42u, channels->as.select.default_values[0].id, "default value id");
+
+    /* Round trip: re-decoding the encoded tree gives the same encoding */
+    dc_string_t first;
+    dc_string_t second;
+    dc_string_init(&first);
+    dc_string_init(&second);
+    TEST_ASSERT_EQ(DC_OK, dc_json_component_nodes_serialize(&list, &first), "encode layout");
+    dc_component_children_t again = {0};
+    TEST_ASSERT_EQ(DC_OK, dc_json_component_nodes_parse(dc_string_cstr(&first), &arena, &again),
+                   "decode encoded layout");
+    TEST_ASSERT_EQ(DC_OK, dc_json_component_nodes_serialize(&again, &second), "encode again");
+    TEST_ASSERT_STR_EQ(dc_string_cstr(&first), dc_string_cstr(&second), "encoding is stable");
+
+    dc_json_doc_t doc;
+    TEST_ASSERT_EQ(DC_OK, dc_json_parse(dc_string_cstr(&first), &doc), "encoded layout parses");
+    yyjson_val* sep = yyjson_arr_get(yyjson_obj_get(yyjson_arr_get(doc.root, 0), "components"), 2);
+    int64_t spacing = 0;
+    TEST_ASSERT_EQ(DC_OK, dc_json_get_int64(sep, "spacing", &spacing), "separator spacing encoded");
+    TEST_ASSERT_EQ(2, spacing, "separator spacing value");
+    TEST_ASSERT(yyjson_obj_get(sep, "id") == NULL, "unset id not encoded");
+    dc_json_doc_free(&doc);
+
+    /* Building */
+    dc_arena_reset(&arena);
+    dc_component_children_t built = {0};
+    dc_component_node_t* row = NULL;
+    dc_component_node_t* button = NULL;
+    TEST_ASSERT_EQ(DC_OK, dc_component_node_create(&arena, DC_COMPONENT_TYPE_ACTION_ROW, &row), "create row");
+    TEST_ASSERT_EQ(DC_OK, dc_component_node_create(&arena, DC_COMPONENT_TYPE_BUTTON, &button), "create button");
+    button->as.button.style = DC_BUTTON_STYLE_DANGER;
+    button->as.button.custom_id = "del";
+    button->as.button.label = dc_arena_strdup(&arena, "Delete");
+    TEST_ASSERT_EQ(DC_OK, dc_component_node_append(row, button), "append button");
+    TEST_ASSERT_EQ(DC_ERROR_INVALID_PARAM, dc_component_node_append(button, row), "buttons have no children");
+    TEST_ASSERT_EQ(DC_OK, dc_component_children_append(&built, row), "append row");
+    TEST_ASSERT_EQ(DC_OK, dc_json_component_nodes_serialize(&built, &first), "encode built row");
+    TEST_ASSERT_STR_EQ("[{\"type\":1,\"components\":[{\"type\":2,\"style\":4,\"custom_id\":\"del\","
+                       "\"label\":\"Delete\"}]}]",
+                       dc_string_cstr(&first), "built row body");
+
+    /* Interaction data uses component_type and values */
+    dc_arena_reset(&arena);
+    dc_component_children_t submitted = {0};
+    TEST_ASSERT_EQ(DC_OK, dc_json_component_nodes_parse(
+                       "[{\"component_type\":5,\"custom_id\":\"u\",\"values\":[\"1\",\"2\"]}]", &arena, &submitted),
+                   "decode submitted select");
+    TEST_ASSERT(submitted.first->uses_component_type, "component_type remembered");
+    TEST_ASSERT_EQ(2u, submitted.first->as.select.value_count, "submitted values");
+    TEST_ASSERT_STR_EQ("2", submitted.first->as.select.values[1], "submitted value");
+
+    dc_component_children_t bad = {0};
+    TEST_ASSERT_EQ(DC_ERROR_INVALID_FORMAT,
+                   dc_json_component_nodes_parse("[{\"type\":2,\"label\":5}]", &arena, &bad), "wrong field type");
+    TEST_ASSERT_EQ(DC_ERROR_NOT_FOUND, dc_json_component_nodes_parse("[{\"label\":\"x\"}]", &arena, &bad),
+                   "missing type");
+    TEST_ASSERT_EQ(DC_ERROR_INVALID_FORMAT,
+                   dc_json_component_nodes_parse("[{\"type\":2,\"component_type\":3}]", &arena, &bad),
+                   "conflicting types");
+
+    dc_string_free(&first);
+    dc_string_free(&second);
+    dc_arena_free(&arena);
+
+    TEST_SUITE_END("Component Node Tests");
+}
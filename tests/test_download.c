@@ -0,0 +1,364 @@
+/**
+ * @file test_download.c
+ * @brief Ranged downloader tests against a loopback HTTP stand-in
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "test_utils.h"
+#include "http/dc_download.h"
+#include "core/dc_platform.h"
+#include "core/dc_sha256.h"
+
+#if defined(__linux__)
+
+#include <pthread.h>
+#include <poll.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#define TEST_DL_SIZE 300000u
+#define TEST_DL_CHUNK 65536u
+
+/* Loopback server: one thread per connection, Connection: close. */
+typedef struct {
+    int listen_fd;
+    uint16_t port;
+    unsigned char* data;
+    int support_ranges;
+    long fail_from;         /* 503 for ranges starting at or after this (-1 = off) */
+    int drop_once;          /* cut the body of the next non-probe range in half */
+    int fail_once;          /* 503 for this many non-probe ranges */
+    int short_ranges;       /* answer non-probe ranges with their first half only */
+    int stop;
+    int requests;
+    int active;
+    int max_active;
+    long first_offset;      /* range start of the first request (-1 = none) */
+    pthread_t thread;
+} test_dl_server_t;
+
+typedef struct {
+    test_dl_server_t* server;
+    int fd;
+} test_dl_conn_t;
+
+static int test_dl_send_all(int fd, const void* data, size_t len) {
+    const char* p = (const char*)data;
+    while (len > 0) {
+        ssize_t n = send(fd, p, len, MSG_NOSIGNAL);
+        if (n <= 0) return 0;
+        p += n;
+        len -= (size_t)n;
+    }
+    return 1;
+}
+
+static void* test_dl_conn_main(void* arg) {
+    test_dl_conn_t* conn = (test_dl_conn_t*)arg;
+    test_dl_server_t* s = conn->server;
+    int fd = conn->fd;
+    free(conn);
+
+    char req[4096];
+    size_t used = 0;
+    while (used < sizeof(req) - 1) {
+        ssize_t n = recv(fd, req + used, sizeof(req) - 1 - used, 0);
+        if (n <= 0) break;
+        used += (size_t)n;
+        req[used] = '\0';
+        if (strstr(req, "\r\n\r\n")) break;
+    }
+    req[used] = '\0';
+
+    int active = __atomic_add_fetch(&s->active, 1, __ATOMIC_SEQ_CST);
+    int prev = __atomic_load_n(&s->max_active, __ATOMIC_SEQ_CST);
+    while (active > prev &&
+           !__atomic_compare_exchange_n(&s->max_active, &prev, active, 0,
+                                        __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST)) {
+    }
+    __atomic_add_fetch(&s->requests, 1, __ATOMIC_SEQ_CST);
+    dc_platform_sleep_ms(20); /* let parallel ranges overlap */
+
+    unsigned long first = 0;
+    unsigned long last = TEST_DL_SIZE - 1u;
+    const char* range = strstr(req, "Range: bytes=");
+    int ranged = 0;
+    if (range && __atomic_load_n(&s->support_ranges, __ATOMIC_SEQ_CST)) {
+        char* end = NULL;
+        first = strtoul(range + 13, &end, 10);
+        if (end && *end == '-' && end[1] >= '0' && end[1] <= '9') last = strtoul(end + 1, NULL, 10);
+        if (last >= TEST_DL_SIZE) last = TEST_DL_SIZE - 1u;
+        ranged = 1;
+        if (first > 0 && last > first && __atomic_load_n(&s->short_ranges, __ATOMIC_SEQ_CST)) {
+            last = first + (last - first + 1u) / 2u - 1u;
+        }
+    }
+    long expected = -1;
+    __atomic_compare_exchange_n(&s->first_offset, &expected, (long)first, 0,
+                                __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+
+    long fail_from = __atomic_load_n(&s->fail_from, __ATOMIC_SEQ_CST);
+    int fail_now = 0;
+    if (ranged && first > 0) {
+        int left = __atomic_load_n(&s->fail_once, __ATOMIC_SEQ_CST);
+        while (left > 0 && !__atomic_compare_exchange_n(&s->fail_once, &left, left - 1, 0,
+                                                        __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST)) {
+        }
+        fail_now = left > 0;
+    }
+    char head[256];
+    if (ranged && first >= TEST_DL_SIZE) {
+        int n = snprintf(head, sizeof(head),
+                         "HTTP/1.1 416 Range Not Satisfiable\r\nContent-Range: bytes */%u\r\n"
+                         "Content-Length: 0\r\nConnection: close\r\n\r\n", TEST_DL_SIZE);
+        test_dl_send_all(fd, head, (size_t)n);
+    } else if (fail_now || (ranged && fail_from >= 0 && (long)first >= fail_from)) {
+        int n = snprintf(head, sizeof(head),
+                         "HTTP/1.1 503 Service Unavailable\r\nContent-Length: 0\r\n"
+                         "Connection: close\r\n\r\n");
+        test_dl_send_all(fd, head, (size_t)n);
+    } else {
+        size_t len = (size_t)(last - first + 1u);
+        int n;
+        if (ranged) {
+            n = snprintf(head, sizeof(head),
+                         "HTTP/1.1 206 Partial Content\r\nContent-Range: bytes %lu-%lu/%u\r\n"
+                         "Content-Length: %zu\r\nConnection: close\r\n\r\n",
+                         first, last, TEST_DL_SIZE, len);
+        } else {
+            n = snprintf(head, sizeof(head),
+                         "HTTP/1.1 200 OK\r\nContent-Length: %zu\r\nConnection: close\r\n\r\n", len);
+        }
+        test_dl_send_all(fd, head, (size_t)n);
+        size_t send_len = len;
+        int drop = 1;
+        if (ranged && first > 0 &&
+            __atomic_compare_exchange_n(&s->drop_once, &drop, 0, 0,
+                                        __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST)) {
+            send_len = len / 2u;
+        }
+        test_dl_send_all(fd, s->data + first, send_len);
+    }
+    close(fd);
+    __atomic_sub_fetch(&s->active, 1, __ATOMIC_SEQ_CST);
+    return NULL;
+}
+
+static void* test_dl_accept_main(void* arg) {
+    test_dl_server_t* s = (test_dl_server_t*)arg;
+    while (!__atomic_load_n(&s->stop, __ATOMIC_SEQ_CST)) {
+        struct pollfd pfd = { s->listen_fd, POLLIN, 0 };
+        if (poll(&pfd, 1, 50) <= 0) continue;
+        int fd = accept(s->listen_fd, NULL, NULL);
+        if (fd < 0) continue;
+        test_dl_conn_t* conn = (test_dl_conn_t*)malloc(sizeof(*conn));
+        conn->server = s;
+        conn->fd = fd;
+        pthread_t t;
+        if (pthread_create(&t, NULL, test_dl_conn_main, conn) == 0) {
+            pthread_detach(t);
+        } else {
+            close(fd);
+            free(conn);
+        }
+    }
+    return NULL;
+}
+
+static int test_dl_server_start(test_dl_server_t* s, unsigned char* data) {
+    memset(s, 0, sizeof(*s));
+    s->data = data;
+    s->support_ranges = 1;
+    s->fail_from = -1;
+    s->first_offset = -1;
+    s->listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (s->listen_fd < 0) return 0;
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t alen = sizeof(addr);
+    if (bind(s->listen_fd, (struct sockaddr*)&addr, sizeof(addr)) != 0 ||
+        listen(s->listen_fd, 64) != 0 ||
+        getsockname(s->listen_fd, (struct sockaddr*)&addr, &alen) != 0) {
+        close(s->listen_fd);
+        return 0;
+    }
+    s->port = ntohs(addr.sin_port);
+    return pthread_create(&s->thread, NULL, test_dl_accept_main, s) == 0;
+}
+
+static void test_dl_server_stop(test_dl_server_t* s) {
+    __atomic_store_n(&s->stop, 1, __ATOMIC_SEQ_CST);
+    pthread_join(s->thread, NULL);
+    close(s->listen_fd);
+    while (__atomic_load_n(&s->active, __ATOMIC_SEQ_CST) > 0) dc_platform_sleep_ms(1);
+}
+
+static void test_dl_reset_counters(test_dl_server_t* s) {
+    __atomic_store_n(&s->requests, 0, __ATOMIC_SEQ_CST);
+    __atomic_store_n(&s->max_active, 0, __ATOMIC_SEQ_CST);
+    __atomic_store_n(&s->first_offset, -1L, __ATOMIC_SEQ_CST);
+}
+
+static int test_dl_file_matches(int fd, const unsigned char* data, size_t size) {
+    unsigned char* buf = (unsigned char*)malloc(size + 1u);
+    ssize_t n = pread(fd, buf, size + 1u, 0);
+    int ok = (n == (ssize_t)size) && memcmp(buf, data, size) == 0;
+    free(buf);
+    return ok;
+}
+
+static off_t test_dl_file_size(int fd) {
+    return lseek(fd, 0, SEEK_END);
+}
+
+static void test_dl_progress(uint64_t present, uint64_t total, void* user_data) {
+    uint64_t* last = (uint64_t*)user_data;
+    if (present >= *last && present <= total) *last = present;
+}
+
+int test_download_main(void) {
+    TEST_SUITE_BEGIN("Download Tests");
+
+    unsigned char* data = (unsigned char*)malloc(TEST_DL_SIZE);
+    for (size_t i = 0; i < TEST_DL_SIZE; i++) data[i] = (unsigned char)((i * 31u) ^ (i >> 9));
+    char sha_hex[DC_SHA256_DIGEST_SIZE * 2 + 1];
+    {
+        dc_sha256_t ctx;
+        uint8_t digest[DC_SHA256_DIGEST_SIZE];
+        dc_sha256_init(&ctx);
+        dc_sha256_update(&ctx, data, TEST_DL_SIZE);
+        dc_sha256_final(&ctx, digest);
+        for (size_t i = 0; i < DC_SHA256_DIGEST_SIZE; i++) sprintf(sha_hex + i * 2, "%02x", digest[i]);
+    }
+
+    test_dl_server_t server;
+    TEST_ASSERT(test_dl_server_start(&server, data), "start loopback server");
+    char url[64];
+    snprintf(url, sizeof(url), "http://127.0.0.1:%u/attachments/1/2/file.bin", server.port);
+
+    char path[] = "/tmp/dc_download_testXXXXXX";
+    int fd = mkstemp(path);
+    TEST_ASSERT(fd >= 0, "create temp file");
+    unlink(path);
+
+    dc_downloader_t* dl = NULL;
+    TEST_ASSERT_EQ(DC_OK, dc_downloader_create(&dl), "create downloader");
+
+    dc_download_options_t opt;
+    dc_download_options_init(&opt);
+    TEST_ASSERT_EQ(4u, opt.max_connections, "default connections");
+    opt.chunk_size = TEST_DL_CHUNK;
+    opt.expected_sha256 = sha_hex;
+    uint64_t last_progress = 0;
+    opt.progress = test_dl_progress;
+    opt.user_data = &last_progress;
+
+    /* Parallel ranged download with checksum */
+    dc_download_result_t res;
+    TEST_ASSERT_EQ(DC_OK, dc_download_to_fd(dl, url, fd, &opt, &res), "ranged download");
+    TEST_ASSERT(test_dl_file_matches(fd, data, TEST_DL_SIZE), "ranged content matches");
+    TEST_ASSERT_EQ(1, res.ranged, "ranges used");
+    TEST_ASSERT_EQ((uint64_t)TEST_DL_SIZE, res.total_bytes, "total learned");
+    TEST_ASSERT_EQ((uint64_t)TEST_DL_SIZE, res.committed_bytes, "all bytes committed");
+    TEST_ASSERT_EQ(5u, res.requests, "one request per chunk");
+    TEST_ASSERT(server.max_active >= 2, "chunks fetched in parallel");
+    TEST_ASSERT(server.max_active <= 4, "connection cap respected");
+    TEST_ASSERT_EQ((uint64_t)TEST_DL_SIZE, last_progress, "progress reaches total");
+
+    /* Checksum mismatch leaves the file in place */
+    char bad_hex[sizeof(sha_hex)];
+    memcpy(bad_hex, sha_hex, sizeof(sha_hex));
+    bad_hex[0] = (char)(bad_hex[0] == '0' ? '1' : '0');
+    opt.expected_sha256 = bad_hex;
+    opt.progress = NULL;
+    TEST_ASSERT_EQ(DC_ERROR_INVALID_STATE, dc_download_to_fd(dl, url, fd, &opt, &res),
+                   "checksum mismatch reported");
+    TEST_ASSERT_EQ((off_t)TEST_DL_SIZE, test_dl_file_size(fd), "mismatched file kept");
+    opt.expected_sha256 = sha_hex;
+
+    /* Resume after a partial file */
+    TEST_ASSERT(ftruncate(fd, 100000) == 0, "truncate to partial");
+    test_dl_reset_counters(&server);
+    opt.resume = 1;
+    TEST_ASSERT_EQ(DC_OK, dc_download_to_fd(dl, url, fd, &opt, &res), "resumed download");
+    TEST_ASSERT_EQ(100000L, server.first_offset, "resume starts after existing bytes");
+    TEST_ASSERT_EQ((uint64_t)100000u, res.resumed_from, "resume offset reported");
+    TEST_ASSERT(test_dl_file_matches(fd, data, TEST_DL_SIZE), "resumed content matches");
+
+    /* Resuming a complete file is a no-op */
+    TEST_ASSERT_EQ(DC_OK, dc_download_to_fd(dl, url, fd, &opt, &res), "resume complete file");
+    TEST_ASSERT_EQ((uint64_t)TEST_DL_SIZE, res.committed_bytes, "complete file committed");
+    TEST_ASSERT(test_dl_file_matches(fd, data, TEST_DL_SIZE), "complete file untouched");
+    opt.resume = 0;
+
+    /* A dropped connection is retried from where it stopped */
+    test_dl_reset_counters(&server);
+    __atomic_store_n(&server.drop_once, 1, __ATOMIC_SEQ_CST);
+    TEST_ASSERT_EQ(DC_OK, dc_download_to_fd(dl, url, fd, &opt, &res), "download with dropped range");
+    TEST_ASSERT_EQ(6u, res.requests, "dropped range retried once");
+    TEST_ASSERT(test_dl_file_matches(fd, data, TEST_DL_SIZE), "retried content matches");
+
+    /* A 5xx on one range retries that range instead of failing the download */
+    test_dl_reset_counters(&server);
+    __atomic_store_n(&server.fail_once, 1, __ATOMIC_SEQ_CST);
+    TEST_ASSERT_EQ(DC_OK, dc_download_to_fd(dl, url, fd, &opt, &res), "download with one 503 range");
+    TEST_ASSERT_EQ(6u, res.requests, "503 range retried once");
+    TEST_ASSERT(test_dl_file_matches(fd, data, TEST_DL_SIZE), "content matches after 503 retry");
+
+    /* Short ranges count against max_retries instead of restarting forever */
+    test_dl_reset_counters(&server);
+    __atomic_store_n(&server.short_ranges, 1, __ATOMIC_SEQ_CST);
+    TEST_ASSERT_EQ(DC_ERROR_NETWORK, dc_download_to_fd(dl, url, fd, &opt, &res),
+                   "endless short ranges give up");
+    TEST_ASSERT(res.requests <= 1u + 4u * (1u + opt.max_retries), "short range restarts bounded");
+    __atomic_store_n(&server.short_ranges, 0, __ATOMIC_SEQ_CST);
+
+    /* A failing server truncates to the contiguous prefix, then resume completes */
+    __atomic_store_n(&server.fail_from, 3 * (long)TEST_DL_CHUNK, __ATOMIC_SEQ_CST);
+    TEST_ASSERT_EQ(DC_ERROR_UNAVAILABLE, dc_download_to_fd(dl, url, fd, &opt, &res),
+                   "server error surfaces");
+    TEST_ASSERT(res.committed_bytes <= 3u * TEST_DL_CHUNK, "committed stops before failed range");
+    TEST_ASSERT_EQ((off_t)res.committed_bytes, test_dl_file_size(fd), "file truncated to committed");
+    TEST_ASSERT(test_dl_file_matches(fd, data, (size_t)res.committed_bytes), "committed prefix intact");
+    __atomic_store_n(&server.fail_from, -1L, __ATOMIC_SEQ_CST);
+    opt.resume = 1;
+    TEST_ASSERT_EQ(DC_OK, dc_download_to_fd(dl, url, fd, &opt, &res), "resume after failure");
+    TEST_ASSERT(test_dl_file_matches(fd, data, TEST_DL_SIZE), "content complete after resume");
+
+    /* Servers without range support stream once, restarting a resume */
+    __atomic_store_n(&server.support_ranges, 0, __ATOMIC_SEQ_CST);
+    TEST_ASSERT(ftruncate(fd, 1000) == 0, "truncate before non-range resume");
+    TEST_ASSERT_EQ(DC_OK, dc_download_to_fd(dl, url, fd, &opt, &res), "non-range download");
+    TEST_ASSERT_EQ(0, res.ranged, "ranges not used");
+    TEST_ASSERT_EQ((uint64_t)0u, res.resumed_from, "non-range server restarts");
+    TEST_ASSERT_EQ(1u, res.requests, "single streamed request");
+    TEST_ASSERT(test_dl_file_matches(fd, data, TEST_DL_SIZE), "streamed content matches");
+
+    TEST_ASSERT_EQ(DC_ERROR_NULL_POINTER, dc_download_to_fd(dl, NULL, fd, &opt, &res), "null url rejected");
+    TEST_ASSERT_EQ(DC_ERROR_INVALID_PARAM, dc_download_to_fd(dl, url, -1, &opt, &res), "bad fd rejected");
+
+    dc_downloader_free(dl);
+    close(fd);
+    test_dl_server_stop(&server);
+    free(data);
+
+    TEST_SUITE_END("Download Tests");
+}
+
+#else
+
+int test_download_main(void) {
+    TEST_SUITE_BEGIN("Download Tests");
+    dc_download_options_t opt;
+    dc_download_options_init(&opt);
+    TEST_ASSERT_EQ(4u, opt.max_connections, "default connections");
+    TEST_SUITE_END("Download Tests");
+}
+
+#endif
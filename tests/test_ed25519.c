@@ -0,0 +1,70 @@
+/**
+ * @file test_ed25519.c
+ * @brief Ed25519 verification tests (RFC 8032 section 7.1 vectors)
+ */
+
+#include <string.h>
+#include "test_utils.h"
+#include "core/dc_ed25519.h"
+
+int test_ed25519_main(void) {
+    TEST_SUITE_BEGIN("Ed25519 Tests");
+
+    uint8_t pk[DC_ED25519_PUBLIC_KEY_SIZE];
+    uint8_t sig[DC_ED25519_SIGNATURE_SIZE];
+
+    /* TEST 1: empty message */
+    TEST_ASSERT_EQ(DC_OK, dc_ed25519_decode_hex(
+        "d75a980182b10ab7d54bfed3c964073a0ee172f3daa62325af021a68f707511a", pk, sizeof(pk)),
+        "decode public key");
+    TEST_ASSERT_EQ(DC_OK, dc_ed25519_decode_hex(
+        "e5564300c360ac729086e2cc806e828a84877f1eb8e5d974d873e065224901555fb8821590a33bacc61e39701cf9b46bd25bf5f0595bbe24655141438e7a100b",
+        sig, sizeof(sig)), "decode signature");
+    TEST_ASSERT_EQ(DC_OK, dc_ed25519_verify(pk, sig, NULL, 0), "empty message verifies");
+    TEST_ASSERT_EQ(DC_ERROR_UNAUTHORIZED, dc_ed25519_verify(pk, sig, "x", 1), "other message rejected");
+
+    /* TEST 2: one byte, split across prefix and message */
+    TEST_ASSERT_EQ(DC_OK, dc_ed25519_decode_hex(
+        "3d4017c3e843895a92b70aa74d1b7ebc9c982ccf2ec4968cc0cd55f12af4660c", pk, sizeof(pk)),
+        "decode public key 2");
+    TEST_ASSERT_EQ(DC_OK, dc_ed25519_decode_hex(
+        "92a009a9f0d4cab8720e820b5f642540a2b27b5416503f8fb3762223ebdb69da085ac1e43e15996e458f3613d0f11d8c387b2eaeb4302aeeb00d291612bb0c00",
+        sig, sizeof(sig)), "decode signature 2");
+    const uint8_t msg = 0x72;
+    TEST_ASSERT_EQ(DC_OK, dc_ed25519_verify(pk, sig, &msg, 1), "one-byte message verifies");
+    TEST_ASSERT_EQ(DC_OK, dc_ed25519_verify_prefixed(pk, sig, &msg, 1, NULL, 0), "prefix-only verifies");
+
+    sig[10] ^= 0x01;
+    TEST_ASSERT_EQ(DC_ERROR_UNAUTHORIZED, dc_ed25519_verify(pk, sig, &msg, 1), "tampered R rejected");
+    sig[10] ^= 0x01;
+    sig[40] ^= 0x01;
+    TEST_ASSERT_EQ(DC_ERROR_UNAUTHORIZED, dc_ed25519_verify(pk, sig, &msg, 1), "tampered S rejected");
+    sig[40] ^= 0x01;
+
+    /* S + L is the same scalar but non-canonical; must be rejected (malleability). */
+    uint8_t malleable[DC_ED25519_SIGNATURE_SIZE];
+    static const uint8_t order[32] = {
+        0xed, 0xd3, 0xf5, 0x5c, 0x1a, 0x63, 0x12, 0x58, 0xd6, 0x9c, 0xf7, 0xa2, 0xde, 0xf9, 0xde, 0x14,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x10
+    };
+    memcpy(malleable, sig, sizeof(sig));
+    unsigned carry = 0;
+    for (size_t i = 0; i < 32; i++) {
+        unsigned v = malleable[32 + i] + order[i] + carry;
+        malleable[32 + i] = (uint8_t)v;
+        carry = v >> 8;
+    }
+    TEST_ASSERT_EQ(DC_ERROR_UNAUTHORIZED, dc_ed25519_verify(pk, malleable, &msg, 1),
+                   "non-canonical S rejected");
+
+    /* y = 2 is not on the curve. */
+    uint8_t bad_pk[DC_ED25519_PUBLIC_KEY_SIZE] = { 2 };
+    TEST_ASSERT_EQ(DC_ERROR_INVALID_PARAM, dc_ed25519_verify(bad_pk, sig, &msg, 1), "invalid point rejected");
+
+    TEST_ASSERT_EQ(DC_ERROR_INVALID_FORMAT, dc_ed25519_decode_hex("abc", pk, 2), "short hex rejected");
+    TEST_ASSERT_EQ(DC_ERROR_INVALID_FORMAT, dc_ed25519_decode_hex("zz00", pk, 2), "bad hex rejected");
+    TEST_ASSERT_EQ(DC_ERROR_INVALID_FORMAT, dc_ed25519_decode_hex("000000", pk, 2), "long hex rejected");
+    TEST_ASSERT_EQ(DC_ERROR_NULL_POINTER, dc_ed25519_verify(NULL, sig, &msg, 1), "null key rejected");
+
+    TEST_SUITE_END("Ed25519 Tests");
+}
@@ -1,5 +1,8 @@
 #include "test_utils.h"
 #include "gw/dc_events.h"
+#include "gw/dc_presence_stats.h"
+#include "gw/dc_member_index.h"
+#include "gw/dc_spam.h"
 #include "core/dc_status.h"
 #include "core/dc_string.h"
 #include <string.h>
@@ -337,6 +340,37 @@ void test_parse_message_delete_bulk(void) {
     dc_gateway_message_delete_bulk_free(&bulk_delete);
 }
 
+void test_parse_message_poll_vote(void) {
+    const char* json = "{"
+        "\"user_id\": \"73001\","
+        "\"channel_id\": \"73002\","
+        "\"message_id\": \"73003\","
+        "\"guild_id\": \"73004\","
+        "\"answer_id\": 2"
+    "}";
+
+    dc_gateway_message_poll_vote_t vote;
+    TEST_ASSERT_EQ(DC_OK, dc_gateway_event_parse_message_poll_vote(json, &vote), "parse poll vote");
+    TEST_ASSERT_EQ(73001ULL, vote.user_id, "poll vote user id");
+    TEST_ASSERT_EQ(73002ULL, vote.channel_id, "poll vote channel id");
+    TEST_ASSERT_EQ(73003ULL, vote.message_id, "poll vote message id");
+    TEST_ASSERT_EQ(1, vote.guild_id.is_set, "poll vote guild id set");
+    TEST_ASSERT_EQ(73004ULL, vote.guild_id.value, "poll vote guild id");
+    TEST_ASSERT_EQ(2u, vote.answer_id, "poll vote answer id");
+    dc_gateway_message_poll_vote_free(&vote);
+
+    const char* dm = "{\"user_id\":\"73001\",\"channel_id\":\"73005\",\"message_id\":\"73006\",\"answer_id\":1}";
+    TEST_ASSERT_EQ(DC_OK, dc_gateway_event_parse_message_poll_vote(dm, &vote), "parse dm poll vote");
+    TEST_ASSERT_EQ(0, vote.guild_id.is_set, "dm poll vote has no guild");
+    dc_gateway_message_poll_vote_free(&vote);
+
+    const char* bad = "{\"user_id\":\"73001\",\"channel_id\":\"73005\",\"message_id\":\"73006\",\"answer_id\":0}";
+    TEST_ASSERT_EQ(DC_ERROR_INVALID_FORMAT, dc_gateway_event_parse_message_poll_vote(bad, &vote),
+                   "answer ids start at 1");
+    const char* missing = "{\"user_id\":\"73001\",\"channel_id\":\"73005\",\"answer_id\":1}";
+    TEST_ASSERT(dc_gateway_event_parse_message_poll_vote(missing, &vote) != DC_OK, "message id required");
+}
+
 void test_parse_message_with_extra_fields(void) {
     const char* json = "{"
         "\"id\": \"55555\","
@@ -475,6 +509,12 @@ void test_gateway_event_kind_includes_interaction_create(void) {
     TEST_ASSERT_EQ(DC_GATEWAY_EVENT_INTERACTION_CREATE,
                    dc_gateway_event_kind_from_name("INTERACTION_CREATE"),
                    "event kind maps INTERACTION_CREATE");
+    TEST_ASSERT_EQ(DC_GATEWAY_EVENT_MESSAGE_POLL_VOTE_ADD,
+                   dc_gateway_event_kind_from_name("MESSAGE_POLL_VOTE_ADD"),
+                   "event kind maps MESSAGE_POLL_VOTE_ADD");
+    TEST_ASSERT_EQ(DC_GATEWAY_EVENT_MESSAGE_POLL_VOTE_REMOVE,
+                   dc_gateway_event_kind_from_name("MESSAGE_POLL_VOTE_REMOVE"),
+                   "event kind maps MESSAGE_POLL_VOTE_REMOVE");
 }
 
 void test_parse_interaction_create_application_command(void) {
@@ -568,3 +608,207 @@ void test_parse_interaction_create_component_dm(void) {
     TEST_ASSERT_EQ(0, interaction.has_context, "component context absent");
     dc_interaction_free(&interaction);
 }
+
+void test_presence_stats_aggregation(void) {
+    const char* guild_create = "{"
+        "\"id\": \"1001\","
+        "\"name\": \"Stats Guild\","
+        "\"presences\": ["
+            "{\"user\": {\"id\": \"1\"}, \"status\": \"online\", \"activities\": [{\"name\": \"x\", \"type\": 0}]},"
+            "{\"user\": {\"id\": \"2\"}, \"status\": \"idle\"},"
+            "{\"user\": {\"id\": \"3\"}, \"status\": \"dnd\"},"
+            "{\"user\": {\"id\": \"4\"}, \"status\": \"online\"}"
+        "]"
+    "}";
+
+    dc_presence_stats_t stats;
+    TEST_ASSERT_EQ(DC_OK, dc_presence_stats_init(&stats), "presence stats init");
+    TEST_ASSERT_EQ(DC_OK, dc_presence_stats_process_event(&stats, "GUILD_CREATE", guild_create),
+                   "presence stats guild create");
+
+    dc_presence_counts_t counts;
+    TEST_ASSERT_EQ(DC_OK, dc_presence_stats_get_counts(&stats, 1001, &counts), "counts after guild create");
+    TEST_ASSERT_EQ(2u, counts.online, "online count");
+    TEST_ASSERT_EQ(1u, counts.idle, "idle count");
+    TEST_ASSERT_EQ(1u, counts.dnd, "dnd count");
+
+    TEST_ASSERT_EQ(DC_OK, dc_presence_stats_process_event(&stats, "PRESENCE_UPDATE",
+        "{\"user\": {\"id\": \"2\"}, \"guild_id\": \"1001\", \"status\": \"online\", \"activities\": []}"),
+        "presence update idle -> online");
+    TEST_ASSERT_EQ(DC_OK, dc_presence_stats_process_event(&stats, "PRESENCE_UPDATE",
+        "{\"user\": {\"id\": \"3\"}, \"guild_id\": \"1001\", \"status\": \"offline\"}"),
+        "presence update dnd -> offline");
+    TEST_ASSERT_EQ(DC_OK, dc_presence_stats_process_event(&stats, "PRESENCE_UPDATE",
+        "{\"user\": {\"id\": \"5\"}, \"guild_id\": \"1001\", \"status\": \"dnd\"}"),
+        "presence update new member");
+    TEST_ASSERT_EQ(DC_OK, dc_presence_stats_get_counts(&stats, 1001, &counts), "counts after updates");
+    TEST_ASSERT_EQ(3u, counts.online, "online count after updates");
+    TEST_ASSERT_EQ(0u, counts.idle, "idle count after updates");
+    TEST_ASSERT_EQ(1u, counts.dnd, "dnd count after updates");
+
+    dc_presence_status_t status = DC_PRESENCE_STATUS_ONLINE;
+    TEST_ASSERT_EQ(DC_OK, dc_presence_stats_get_status(&stats, 1001, 3, &status), "status lookup offline user");
+    TEST_ASSERT_EQ(DC_PRESENCE_STATUS_OFFLINE, status, "offline user reported offline");
+    TEST_ASSERT_EQ(DC_OK, dc_presence_stats_get_status(&stats, 1001, 5, &status), "status lookup dnd user");
+    TEST_ASSERT_EQ(DC_PRESENCE_STATUS_DND, status, "dnd user status");
+
+    TEST_ASSERT_EQ(DC_OK, dc_presence_stats_process_event(&stats, "GUILD_MEMBER_REMOVE",
+        "{\"guild_id\": \"1001\", \"user\": {\"id\": \"1\", \"username\": \"gone\"}}"),
+        "member remove");
+    TEST_ASSERT_EQ(DC_OK, dc_presence_stats_get_counts(&stats, 1001, &counts), "counts after member remove");
+    TEST_ASSERT_EQ(2u, counts.online, "online count after member remove");
+
+    TEST_ASSERT_EQ(DC_OK, dc_presence_stats_process_event(&stats, "MESSAGE_CREATE", "{}"),
+                   "unrelated event ignored");
+    TEST_ASSERT_EQ(DC_ERROR_INVALID_FORMAT, dc_presence_stats_apply_presence_update(&stats,
+        "{\"guild_id\": \"1001\", \"status\": \"online\"}"), "presence update without user rejected");
+
+    TEST_ASSERT_EQ(DC_OK, dc_presence_stats_process_event(&stats, "GUILD_DELETE",
+        "{\"id\": \"1001\", \"unavailable\": true}"), "guild delete");
+    TEST_ASSERT_EQ(DC_ERROR_NOT_FOUND, dc_presence_stats_get_counts(&stats, 1001, &counts),
+                   "guild dropped after delete");
+
+    dc_presence_stats_free(&stats);
+}
+
+void test_member_index_search(void) {
+    const char* guild_create = "{"
+        "\"id\": \"2001\","
+        "\"name\": \"Index Guild\","
+        "\"members\": ["
+            "{\"user\": {\"id\": \"11\", \"username\": \"alice\", \"global_name\": \"Alice Liddell\"}, \"nick\": null, \"roles\": []},"
+            "{\"user\": {\"id\": \"12\", \"username\": \"alfred\", \"global_name\": null}, \"nick\": \"Butler\", \"roles\": []},"
+            "{\"user\": {\"id\": \"13\", \"username\": \"bob\"}, \"nick\": \"Alpha\", \"roles\": []}"
+        "]"
+    "}";
+
+    dc_member_index_t index;
+    TEST_ASSERT_EQ(DC_OK, dc_member_index_init(&index), "member index init");
+    TEST_ASSERT_EQ(DC_OK, dc_member_index_process_event(&index, "GUILD_CREATE", guild_create),
+                   "member index guild create");
+    TEST_ASSERT_EQ(3u, dc_member_index_count(&index, 2001), "member index count");
+
+    dc_snowflake_t ids[8];
+    size_t count = 0;
+    TEST_ASSERT_EQ(DC_OK, dc_member_index_search_prefix(&index, 2001, "AL", ids, 8, &count),
+                   "prefix search");
+    TEST_ASSERT_EQ(3u, count, "prefix matches username, global_name and nick");
+    TEST_ASSERT_EQ(12ULL, ids[0], "prefix results in name order (alfred)");
+    TEST_ASSERT_EQ(11ULL, ids[1], "prefix results deduplicated (alice)");
+    TEST_ASSERT_EQ(13ULL, ids[2], "prefix results in name order (alpha)");
+
+    TEST_ASSERT_EQ(DC_OK, dc_member_index_search_prefix(&index, 2001, "ali", ids, 8, &count),
+                   "prefix search ali");
+    TEST_ASSERT_EQ(1u, count, "ali matches one member");
+
+    dc_snowflake_t resolved = 0;
+    TEST_ASSERT_EQ(DC_OK, dc_member_index_resolve(&index, 2001, "@Butler", &resolved), "resolve nick mention");
+    TEST_ASSERT_EQ(12ULL, resolved, "resolved nick user");
+    TEST_ASSERT_EQ(DC_ERROR_NOT_FOUND, dc_member_index_resolve(&index, 2001, "carol", &resolved),
+                   "resolve unknown name");
+
+    TEST_ASSERT_EQ(DC_OK, dc_member_index_search_fuzzy(&index, 2001, "alise", ids, 8, &count),
+                   "fuzzy search");
+    TEST_ASSERT(count >= 1, "fuzzy search finds a match");
+    TEST_ASSERT_EQ(11ULL, ids[0], "fuzzy best match");
+
+    TEST_ASSERT_EQ(DC_OK, dc_member_index_process_event(&index, "GUILD_MEMBER_UPDATE",
+        "{\"guild_id\": \"2001\", \"user\": {\"id\": \"13\", \"username\": \"bob\"}, \"nick\": \"Zed\", \"roles\": []}"),
+        "member update renames nick");
+    TEST_ASSERT_EQ(DC_OK, dc_member_index_search_prefix(&index, 2001, "al", ids, 8, &count),
+                   "prefix search after update");
+    TEST_ASSERT_EQ(2u, count, "old nick no longer indexed");
+    TEST_ASSERT_EQ(DC_OK, dc_member_index_resolve(&index, 2001, "zed", &resolved), "resolve new nick");
+    TEST_ASSERT_EQ(13ULL, resolved, "resolved new nick user");
+
+    TEST_ASSERT_EQ(DC_OK, dc_member_index_process_event(&index, "GUILD_MEMBERS_CHUNK",
+        "{\"guild_id\": \"2001\", \"members\": [{\"user\": {\"id\": \"14\", \"username\": \"carol\"}, \"roles\": []}],"
+        " \"chunk_index\": 0, \"chunk_count\": 1}"),
+        "members chunk");
+    TEST_ASSERT_EQ(DC_OK, dc_member_index_resolve(&index, 2001, "Carol", &resolved), "resolve chunk member");
+    TEST_ASSERT_EQ(14ULL, resolved, "resolved chunk member");
+
+    TEST_ASSERT_EQ(DC_OK, dc_member_index_process_event(&index, "GUILD_MEMBER_REMOVE",
+        "{\"guild_id\": \"2001\", \"user\": {\"id\": \"11\", \"username\": \"alice\"}}"),
+        "member remove");
+    TEST_ASSERT_EQ(3u, dc_member_index_count(&index, 2001), "count after remove");
+    TEST_ASSERT_EQ(DC_OK, dc_member_index_search_fuzzy(&index, 2001, "alice", ids, 8, &count),
+                   "fuzzy search after remove");
+    TEST_ASSERT(!(count > 0 && ids[0] == 11ULL), "removed member not returned");
+
+    TEST_ASSERT_EQ(DC_OK, dc_member_index_process_event(&index, "GUILD_DELETE", "{\"id\": \"2001\"}"),
+                   "guild delete");
+    TEST_ASSERT_EQ(0u, dc_member_index_count(&index, 2001), "guild dropped");
+
+    dc_member_index_free(&index);
+}
+
+void test_spam_engine(void) {
+    dc_spam_config_t config;
+    dc_spam_config_init(&config);
+    config.max_messages = 3;
+    config.max_mentions = 4;
+
+    dc_spam_engine_t engine;
+    TEST_ASSERT_EQ(DC_OK, dc_spam_engine_init(&engine, &config), "spam engine init");
+
+    dc_spam_verdict_t v;
+    const uint64_t t0 = 1700000000000ULL;
+    TEST_ASSERT_EQ(DC_OK, dc_spam_engine_observe(&engine, 501, 10, "hello there", 0, 0, t0, &v),
+                   "observe first message");
+    TEST_ASSERT_EQ(0u, v.flags, "first message clean");
+    TEST_ASSERT_EQ(1u, v.messages, "first message counted");
+
+    dc_spam_engine_observe(&engine, 501, 10, "how is everyone doing", 0, 0, t0 + 100, &v);
+    dc_spam_engine_observe(&engine, 501, 10, "what a nice day it is", 0, 0, t0 + 200, &v);
+    TEST_ASSERT_EQ(0u, v.flags, "three distinct messages allowed");
+    dc_spam_engine_observe(&engine, 501, 10, "anyone up for a game", 0, 0, t0 + 300, &v);
+    TEST_ASSERT(v.flags & DC_SPAM_FLAG_RATE, "rate flagged over max_messages");
+    TEST_ASSERT_EQ(4u, v.messages, "window message count");
+    TEST_ASSERT_EQ(0u, v.duplicates, "distinct contents are not duplicates");
+
+    dc_spam_engine_observe(&engine, 501, 10, "calm again", 0, 0, t0 + config.window_ms + 400, &v);
+    TEST_ASSERT_EQ(0u, v.flags & DC_SPAM_FLAG_RATE, "window slides past old messages");
+
+    const char* promo = "FREE NITRO giveaway!!! click https://example.invalid/claim now";
+    const char* promo_variant = "free nitro   giveaway!!! click https://example.invalid/claim now!";
+    uint64_t t1 = t0 + 30000;
+    dc_spam_engine_observe(&engine, 502, 20, promo, 0, 0, t1, &v);
+    TEST_ASSERT_EQ(0u, v.duplicates, "first promo has no duplicates");
+    dc_spam_engine_observe(&engine, 502, 21, promo_variant, 0, 0, t1 + 3000, &v);
+    TEST_ASSERT_EQ(1u, v.duplicates, "case/whitespace variant is a near-duplicate");
+    TEST_ASSERT_EQ(2u, v.duplicate_channels, "duplicate spans two channels");
+    TEST_ASSERT_EQ(0u, v.flags, "one repeat within limits");
+    dc_spam_engine_observe(&engine, 502, 22, promo, 0, 0, t1 + 6000, &v);
+    TEST_ASSERT_EQ(2u, v.duplicates, "third copy sees two duplicates");
+    TEST_ASSERT(v.flags & DC_SPAM_FLAG_CROSS_CHANNEL, "cross-channel flagged");
+    TEST_ASSERT(!(v.flags & DC_SPAM_FLAG_RATE), "slow duplicates are not rate spam");
+    dc_spam_engine_observe(&engine, 502, 22, promo, 0, 0, t1 + 9000, &v);
+    TEST_ASSERT(v.flags & DC_SPAM_FLAG_DUPLICATE, "duplicate flagged over max_duplicates");
+
+    TEST_ASSERT_EQ(DC_OK, dc_spam_engine_process_event(&engine, "MESSAGE_CREATE",
+        "{\"id\": \"1180000000000000000\", \"channel_id\": \"30\", \"content\": \"<@1> <@2> <@3>\","
+        " \"author\": {\"id\": \"503\", \"username\": \"pinger\"},"
+        " \"mentions\": [{\"id\": \"1\"}, {\"id\": \"2\"}, {\"id\": \"3\"}], \"mention_roles\": [\"9\"],"
+        " \"mention_everyone\": true, \"attachments\": []}", 0, &v),
+        "process MESSAGE_CREATE");
+    TEST_ASSERT_EQ(5u, v.mentions, "user, role and everyone mentions counted");
+    TEST_ASSERT(v.flags & DC_SPAM_FLAG_MENTIONS, "mention spam flagged");
+
+    TEST_ASSERT_EQ(DC_OK, dc_spam_engine_process_event(&engine, "MESSAGE_CREATE",
+        "{\"id\": \"1180000000000000001\", \"channel_id\": \"30\", \"content\": \"beep\","
+        " \"author\": {\"id\": \"504\", \"username\": \"robot\", \"bot\": true}}", 0, &v),
+        "process bot MESSAGE_CREATE");
+    TEST_ASSERT_EQ(0u, v.messages, "bot author ignored");
+    TEST_ASSERT_EQ(DC_OK, dc_spam_engine_process_event(&engine, "TYPING_START", "{}", 0, &v),
+                   "unrelated event ignored");
+
+    TEST_ASSERT_EQ(3u, dc_spam_engine_count(&engine), "three tracked users");
+    TEST_ASSERT_EQ(DC_OK, dc_spam_engine_forget(&engine, 503), "forget user");
+    TEST_ASSERT_EQ(2u, dc_spam_engine_count(&engine), "forgotten user dropped");
+    TEST_ASSERT_EQ(2u, dc_spam_engine_sweep(&engine, t1 + 9000 + config.expire_ms + 1),
+                   "sweep drops idle users");
+    TEST_ASSERT_EQ(0u, dc_spam_engine_count(&engine), "no users left");
+
+    dc_spam_engine_free(&engine);
+}
@@ -15,12 +15,16 @@ void test_parse_channel_delete(void);
 void test_parse_message_update_partial(void);
 void test_parse_message_delete(void);
 void test_parse_message_delete_bulk(void);
+void test_parse_message_poll_vote(void);
 void test_parse_message_with_extra_fields(void);
 void test_parse_ready_with_extended_user_fields(void);
 void test_parse_message_with_documented_extended_fields(void);
 void test_gateway_event_kind_includes_interaction_create(void);
 void test_parse_interaction_create_application_command(void);
 void test_parse_interaction_create_component_dm(void);
+void test_presence_stats_aggregation(void);
+void test_member_index_search(void);
+void test_spam_engine(void);
 
 int main(void) {
     printf("Running Gateway Events Expansion tests...\n\n");
@@ -38,12 +42,16 @@ int main(void) {
     test_parse_message_update_partial();
     test_parse_message_delete();
     test_parse_message_delete_bulk();
+    test_parse_message_poll_vote();
     test_parse_message_with_extra_fields();
     test_parse_ready_with_extended_user_fields();
     test_parse_message_with_documented_extended_fields();
     test_gateway_event_kind_includes_interaction_create();
     test_parse_interaction_create_application_command();
     test_parse_interaction_create_component_dm();
+    test_presence_stats_aggregation();
+    test_member_index_search();
+    test_spam_engine();
 
     printf("\n=== Gateway Events Expansion Test Summary ===\n");
     printf("Total tests: %d\n", test_count);
@@ -4,6 +4,8 @@
  */
 
 #include "test_utils.h"
+#include <stdio.h>
+#include <string.h>
 #include "http/dc_http.h"
 #include "http/dc_http_compliance.h"
 #include "http/dc_rest.h"
@@ -20,6 +22,24 @@ static void test_http_add_header(dc_http_response_t* resp, const char* name, con
     dc_vec_push(&resp->headers, &h);
 }
 
+typedef struct {
+    int count;
+    int stop_after;
+    char last_path[64];
+    char last_code[64];
+} test_field_errors_t;
+
+static dc_status_t test_collect_field_error(void* ctx, const char* path, const char* code,
+                                            const char* message) {
+    test_field_errors_t* fe = (test_field_errors_t*)ctx;
+    (void)message;
+    fe->count++;
+    snprintf(fe->last_path, sizeof(fe->last_path), "%s", path);
+    snprintf(fe->last_code, sizeof(fe->last_code), "%s", code);
+    if (fe->stop_after > 0 && fe->count >= fe->stop_after) return DC_ERROR_UNKNOWN;
+    return DC_OK;
+}
+
 static dc_status_t test_rest_transport_rate_limit(void* userdata, const dc_http_request_t* request,
                                                   dc_http_response_t* response) {
     (void)request;
@@ -185,6 +205,58 @@ int test_http_main(void) {
     TEST_ASSERT_EQ(64.57, rlr.retry_after, "rl retry-after");
     dc_http_rate_limit_response_free(&rlr);
 
+    /* Unified 4xx decode: one parse fills the error and the 429 fields */
+    const char* rl_err_json = "{\"message\":\"You are being rate limited.\",\"retry_after\":2.5,"
+                              "\"global\":true,\"code\":20028}";
+    TEST_ASSERT_EQ(DC_OK, dc_http_error_init(&err), "init error for decode");
+    TEST_ASSERT_EQ(DC_OK, dc_http_rate_limit_response_init(&rlr), "init rl for decode");
+    TEST_ASSERT_EQ(DC_OK, dc_http_error_decode(rl_err_json, 0, &err, &rlr), "decode 429");
+    TEST_ASSERT_EQ(20028, err.code, "decode error code");
+    TEST_ASSERT_STR_EQ("You are being rate limited.", dc_string_cstr(&err.message), "decode error message");
+    TEST_ASSERT_EQ(0u, dc_string_length(&err.errors), "decode no field errors");
+    TEST_ASSERT_EQ(2.5, rlr.retry_after, "decode retry_after");
+    TEST_ASSERT_EQ(1, rlr.global, "decode global");
+    TEST_ASSERT_EQ(20028, rlr.code, "decode rl code");
+    TEST_ASSERT_STR_EQ("You are being rate limited.", dc_string_cstr(&rlr.message), "decode rl message");
+    TEST_ASSERT_EQ(DC_ERROR_NULL_POINTER, dc_http_error_decode(rl_err_json, 0, NULL, NULL), "decode needs an output");
+    TEST_ASSERT_EQ(DC_ERROR_INVALID_FORMAT,
+                   dc_http_error_decode("{\"message\":\"x\",\"retry_after\":\"soon\"}", 0, NULL, &rlr),
+                   "decode bad retry_after");
+    TEST_ASSERT_EQ(DC_OK, dc_http_error_decode("{\"message\":\"x\",\"retry_after\":\"soon\"}", 0, &err, NULL),
+                   "retry fields ignored without rl");
+    const char* bad_code_json = "{\"message\":\"slow down\",\"retry_after\":1.5,\"code\":\"x\"}";
+    TEST_ASSERT_EQ(DC_OK, dc_http_rate_limit_response_parse(bad_code_json, 0, &rlr), "rl ignores a bad code");
+    TEST_ASSERT_EQ(1.5, rlr.retry_after, "retry_after kept with a bad code");
+    TEST_ASSERT_EQ(0, rlr.code, "bad code left at 0");
+    TEST_ASSERT_EQ(DC_ERROR_INVALID_FORMAT, dc_http_error_decode(bad_code_json, 0, &err, NULL),
+                   "error rejects a bad code");
+    TEST_ASSERT_EQ(DC_ERROR_JSON, dc_http_error_decode("<html>", 0, &err, &rlr), "decode non-json");
+    dc_http_rate_limit_response_free(&rlr);
+
+    /* Nested field errors are walked on demand */
+    test_field_errors_t fe;
+    memset(&fe, 0, sizeof(fe));
+    TEST_ASSERT_EQ(DC_OK, dc_http_error_foreach_field_error(&err, test_collect_field_error, &fe), "walk empty errors");
+    TEST_ASSERT_EQ(0, fe.count, "no field errors visited");
+    const char* form_json =
+        "{\"code\":50035,\"message\":\"Invalid Form Body\",\"errors\":{"
+        "\"_errors\":[{\"code\":\"BODY\",\"message\":\"top\"}],"
+        "\"content\":{\"_errors\":[{\"code\":\"BASE_TYPE_MAX_LENGTH\",\"message\":\"too long\"}]},"
+        "\"embeds\":{\"0\":{\"title\":{\"_errors\":[{\"code\":\"BASE_TYPE_REQUIRED\",\"message\":\"required\"}]}}}}}";
+    TEST_ASSERT_EQ(DC_OK, dc_http_error_decode(form_json, 0, &err, NULL), "decode form error");
+    TEST_ASSERT_EQ(50035, err.code, "form error code");
+    TEST_ASSERT_EQ(DC_OK, dc_http_error_foreach_field_error(&err, test_collect_field_error, &fe), "walk field errors");
+    TEST_ASSERT_EQ(3, fe.count, "three field errors");
+    TEST_ASSERT_STR_EQ("embeds.0.title", fe.last_path, "nested path");
+    TEST_ASSERT_STR_EQ("BASE_TYPE_REQUIRED", fe.last_code, "nested code");
+    memset(&fe, 0, sizeof(fe));
+    fe.stop_after = 1;
+    TEST_ASSERT_EQ(DC_ERROR_UNKNOWN, dc_http_error_foreach_field_error(&err, test_collect_field_error, &fe),
+                   "callback stops walk");
+    TEST_ASSERT_EQ(1, fe.count, "stopped after first");
+    TEST_ASSERT_STR_EQ("", fe.last_path, "body-level error has empty path");
+    dc_http_error_free(&err);
+
     /* REST rate limit retry */
     dc_rest_client_t* rest_client = NULL;
     dc_rest_mock_state_t mock_state = {0};
@@ -237,6 +309,31 @@ int test_http_main(void) {
     dc_rest_response_free(&rest_resp);
     dc_rest_request_free(&rest_req);
     dc_rest_client_free(invalid_client);
-    
+
+    /* A fired cancel token stops the transfer before it connects */
+    dc_http_cancel_t* cancel = NULL;
+    TEST_ASSERT_EQ(DC_OK, dc_http_cancel_create(&cancel), "cancel create");
+    TEST_ASSERT_EQ(0, dc_http_cancel_fired(cancel), "cancel starts unfired");
+    TEST_ASSERT_EQ(0, dc_http_cancel_fired(NULL), "null cancel never fires");
+    dc_http_cancel_fire(cancel);
+    TEST_ASSERT_EQ(1, dc_http_cancel_fired(cancel), "cancel fired");
+    dc_http_client_t* http_client = NULL;
+    dc_http_request_t http_req;
+    dc_http_response_t http_resp;
+    TEST_ASSERT_EQ(DC_OK, dc_http_client_create(&http_client), "http client create");
+    TEST_ASSERT_EQ(DC_OK, dc_http_request_init(&http_req), "http request init");
+    TEST_ASSERT_EQ(DC_OK, dc_http_response_init(&http_resp), "http response init");
+    TEST_ASSERT(http_req.cancel == NULL, "request has no cancel by default");
+    TEST_ASSERT_EQ(DC_OK, dc_http_request_set_url(&http_req, "https://discord.com/api/v10/gateway"),
+                   "http request url");
+    http_req.cancel = cancel;
+    TEST_ASSERT_EQ(DC_ERROR_NETWORK, dc_http_client_execute(http_client, &http_req, &http_resp),
+                   "cancelled transfer fails");
+    TEST_ASSERT_EQ(0, (int)http_resp.status_code, "cancelled transfer got no answer");
+    dc_http_response_free(&http_resp);
+    dc_http_request_free(&http_req);
+    dc_http_client_free(http_client);
+    dc_http_cancel_free(cancel);
+
     TEST_SUITE_END("HTTP Tests");
 }
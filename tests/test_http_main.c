@@ -8,6 +8,10 @@
 /* Test function declarations */
 int test_http_main(void);
 int test_multipart_main(void);
+int test_interactions_server_main(void);
+int test_download_main(void);
+int test_upload_main(void);
+int test_tls_sessions_main(void);
 
 int main(void) {
     int result = 0;
@@ -16,6 +20,10 @@ int main(void) {
     
     result |= test_http_main();
     result |= test_multipart_main();
+    result |= test_interactions_server_main();
+    result |= test_download_main();
+    result |= test_upload_main();
+    result |= test_tls_sessions_main();
     
     if (result == 0) {
         printf("\nAll HTTP tests passed!\n");
@@ -0,0 +1,248 @@
+/**
+ * @file test_interactions_server.c
+ * @brief HTTP interactions server tests (loopback client harness)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "test_utils.h"
+#include "http/dc_interactions_server.h"
+
+#if defined(__linux__)
+
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+
+/* RFC 8032 test key 1; signatures below cover TIMESTAMP + body. */
+#define TEST_IXS_PUBLIC_KEY "d75a980182b10ab7d54bfed3c964073a0ee172f3daa62325af021a68f707511a"
+#define TEST_IXS_TIMESTAMP "1700000000"
+
+static const char* test_ixs_ping_body =
+    "{\"id\":\"1\",\"application_id\":\"2\",\"type\":1,\"token\":\"t\",\"version\":1}";
+static const char* test_ixs_ping_sig =
+    "92ff0a359935d5fc6b0a7f360163f17e129df3ae7e4fb9b462d0a7f0b8b5fa96"
+    "db90a3ccb855c9babc8d05ad3bc96f52228a57fed9c8500f56ae18560a3fc10e";
+static const char* test_ixs_command_body =
+    "{\"id\":\"3\",\"application_id\":\"2\",\"type\":2,\"token\":\"tok\",\"version\":1,"
+    "\"data\":{\"id\":\"4\",\"name\":\"hello\",\"type\":1}}";
+static const char* test_ixs_command_sig =
+    "b166f8bb02b8e576c11ca87aca13c13886ae35c25067b9e35d21a7279943b632"
+    "40a97aad1dfa95b7ec6314fed98c420148f09a6787d01e232aecdc58671e4b08";
+static const char* test_ixs_component_body =
+    "{\"id\":\"5\",\"application_id\":\"2\",\"type\":3,\"token\":\"tok\",\"version\":1,"
+    "\"data\":{\"custom_id\":\"btn\",\"component_type\":2}}";
+static const char* test_ixs_component_sig =
+    "d651838a84f74cd1624f7bfb7619f45f39a87c4d2b4e0c910446c59beb1dc89b"
+    "799bb6dfcaffc63633755a10fd2734b84e6eb4d4193a60f4b47e1829562ec80c";
+
+static dc_status_t test_ixs_handler(const dc_interaction_t* interaction, const char* raw_body,
+                                    dc_string_t* response_json, void* user_data) {
+    (void)raw_body;
+    int* calls = (int*)user_data;
+    __atomic_add_fetch(calls, 1, __ATOMIC_SEQ_CST);
+    if (interaction->type != DC_INTERACTION_TYPE_APPLICATION_COMMAND) return DC_OK;
+    char data[128];
+    snprintf(data, sizeof(data), "{\"content\":\"hi from %s\"}", dc_string_cstr(&interaction->data.name));
+    return dc_interactions_response_set(response_json, 4, data);
+}
+
+static int test_ixs_connect(uint16_t port) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    struct timeval tv = { 5, 0 };
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (connect(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static int test_ixs_send_all(int fd, const char* data, size_t len) {
+    while (len > 0) {
+        ssize_t n = send(fd, data, len, MSG_NOSIGNAL);
+        if (n <= 0) return 0;
+        data += n;
+        len -= (size_t)n;
+    }
+    return 1;
+}
+
+static void test_ixs_format(dc_string_t* out, const char* method, const char* path,
+                            const char* sig, const char* body, const char* extra) {
+    dc_string_append_printf(out,
+                            "%s %s HTTP/1.1\r\n"
+                            "Host: localhost\r\n"
+                            "Content-Type: application/json\r\n"
+                            "X-Signature-Ed25519: %s\r\n"
+                            "X-Signature-Timestamp: " TEST_IXS_TIMESTAMP "\r\n"
+                            "Content-Length: %zu\r\n"
+                            "%s\r\n%s",
+                            method, path, sig, strlen(body), extra ? extra : "", body);
+}
+
+/* Read exactly one response. Leftover bytes stay in *buf for the next call. */
+static int test_ixs_read_response(int fd, dc_string_t* buf, int* status, dc_string_t* body) {
+    for (;;) {
+        const char* data = dc_string_cstr(buf);
+        const char* end = strstr(data, "\r\n\r\n");
+        if (end) {
+            size_t head = (size_t)(end - data) + 4u;
+            const char* cl = strstr(data, "Content-Length: ");
+            size_t len = cl && cl < end ? (size_t)strtoul(cl + 16, NULL, 10) : 0u;
+            if (dc_string_length(buf) >= head + len) {
+                *status = atoi(data + 9);
+                dc_string_set_buffer(body, data + head, len);
+                dc_string_t rest;
+                dc_string_init_from_cstr(&rest, data + head + len);
+                dc_string_set_cstr(buf, dc_string_cstr(&rest));
+                dc_string_free(&rest);
+                return 1;
+            }
+        }
+        char chunk[1024];
+        ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+        if (n <= 0) return 0;
+        dc_string_append_buffer(buf, chunk, (size_t)n);
+    }
+}
+
+static int test_ixs_roundtrip(int fd, const char* method, const char* path, const char* sig,
+                              const char* body, dc_string_t* resp_body) {
+    dc_string_t req;
+    dc_string_t buf;
+    int status = 0;
+    dc_string_init(&req);
+    dc_string_init(&buf);
+    test_ixs_format(&req, method, path, sig, body, NULL);
+    if (test_ixs_send_all(fd, dc_string_cstr(&req), dc_string_length(&req))) {
+        if (!test_ixs_read_response(fd, &buf, &status, resp_body)) status = -1;
+    }
+    dc_string_free(&req);
+    dc_string_free(&buf);
+    return status;
+}
+
+int test_interactions_server_main(void) {
+    TEST_SUITE_BEGIN("Interactions Server Tests");
+
+    int calls = 0;
+    dc_interactions_server_config_t cfg;
+    dc_interactions_server_config_init(&cfg);
+    TEST_ASSERT_STR_EQ("/interactions", cfg.path, "default path");
+    cfg.public_key_hex = TEST_IXS_PUBLIC_KEY;
+    cfg.handler = test_ixs_handler;
+    cfg.user_data = &calls;
+    cfg.worker_count = 2;
+
+    dc_interactions_server_t* server = NULL;
+    cfg.public_key_hex = "not-hex";
+    TEST_ASSERT_EQ(DC_ERROR_INVALID_FORMAT, dc_interactions_server_create(&cfg, &server), "bad key rejected");
+    cfg.public_key_hex = TEST_IXS_PUBLIC_KEY;
+    TEST_ASSERT_EQ(DC_OK, dc_interactions_server_create(&cfg, &server), "create server");
+    TEST_ASSERT_NOT_NULL(server, "server allocated");
+    uint16_t port = dc_interactions_server_port(server);
+    TEST_ASSERT(port != 0, "ephemeral port bound");
+    TEST_ASSERT_EQ(DC_OK, dc_interactions_server_start(server), "start server");
+    TEST_ASSERT_EQ(DC_ERROR_INVALID_STATE, dc_interactions_server_start(server), "double start rejected");
+
+    int fd = test_ixs_connect(port);
+    TEST_ASSERT(fd >= 0, "client connects");
+
+    dc_string_t body;
+    dc_string_init(&body);
+
+    /* Several requests over one keep-alive connection. */
+    TEST_ASSERT_EQ(200, test_ixs_roundtrip(fd, "POST", "/interactions", test_ixs_ping_sig,
+                                           test_ixs_ping_body, &body), "ping answered");
+    TEST_ASSERT_STR_EQ("{\"type\":1}", dc_string_cstr(&body), "pong body");
+    TEST_ASSERT_EQ(0, calls, "ping not dispatched to handler");
+
+    TEST_ASSERT_EQ(200, test_ixs_roundtrip(fd, "POST", "/interactions", test_ixs_command_sig,
+                                           test_ixs_command_body, &body), "command answered");
+    TEST_ASSERT_STR_EQ("{\"type\":4,\"data\":{\"content\":\"hi from hello\"}}", dc_string_cstr(&body),
+                       "handler response in HTTP body");
+
+    TEST_ASSERT_EQ(200, test_ixs_roundtrip(fd, "POST", "/interactions?x=1", test_ixs_component_sig,
+                                           test_ixs_component_body, &body), "component answered");
+    TEST_ASSERT_STR_EQ("{\"type\":6}", dc_string_cstr(&body), "empty handler response defers update");
+
+    TEST_ASSERT_EQ(401, test_ixs_roundtrip(fd, "POST", "/interactions", test_ixs_ping_sig,
+                                           test_ixs_command_body, &body), "mismatched signature 401");
+    TEST_ASSERT_EQ(401, test_ixs_roundtrip(fd, "POST", "/interactions", "zz",
+                                           test_ixs_ping_body, &body), "malformed signature 401");
+    TEST_ASSERT_EQ(405, test_ixs_roundtrip(fd, "GET", "/interactions", test_ixs_ping_sig,
+                                           "", &body), "GET rejected");
+    TEST_ASSERT_EQ(404, test_ixs_roundtrip(fd, "POST", "/other", test_ixs_ping_sig,
+                                           test_ixs_ping_body, &body), "unknown path 404");
+    TEST_ASSERT_EQ(2, calls, "handler called for command and component only");
+
+    /* Two pipelined requests in one write come back in order. */
+    dc_string_t req;
+    dc_string_t buf;
+    dc_string_init(&req);
+    dc_string_init(&buf);
+    test_ixs_format(&req, "POST", "/interactions", test_ixs_command_sig, test_ixs_command_body, NULL);
+    test_ixs_format(&req, "POST", "/interactions", test_ixs_ping_sig, test_ixs_ping_body, NULL);
+    TEST_ASSERT(test_ixs_send_all(fd, dc_string_cstr(&req), dc_string_length(&req)), "pipelined send");
+    int status = 0;
+    TEST_ASSERT(test_ixs_read_response(fd, &buf, &status, &body), "first pipelined response");
+    TEST_ASSERT(strstr(dc_string_cstr(&body), "hi from hello") != NULL, "first response is the command");
+    TEST_ASSERT(test_ixs_read_response(fd, &buf, &status, &body), "second pipelined response");
+    TEST_ASSERT_STR_EQ("{\"type\":1}", dc_string_cstr(&body), "second response is the pong");
+    close(fd);
+
+    /* Connection: close is honoured. */
+    fd = test_ixs_connect(port);
+    dc_string_clear(&req);
+    dc_string_clear(&buf);
+    test_ixs_format(&req, "POST", "/interactions", test_ixs_ping_sig, test_ixs_ping_body,
+                    "Connection: close\r\n");
+    test_ixs_send_all(fd, dc_string_cstr(&req), dc_string_length(&req));
+    TEST_ASSERT(test_ixs_read_response(fd, &buf, &status, &body), "close response");
+    TEST_ASSERT(strstr(dc_string_cstr(&body), "\"type\":1") != NULL, "close request answered");
+    char tail;
+    TEST_ASSERT_EQ(0, (int)recv(fd, &tail, 1, 0), "server closed connection");
+    close(fd);
+    dc_string_free(&req);
+    dc_string_free(&buf);
+    dc_string_free(&body);
+
+    dc_interactions_server_stats_t stats;
+    TEST_ASSERT_EQ(DC_OK, dc_interactions_server_get_stats(server, &stats), "get stats");
+    TEST_ASSERT_EQ(2u, stats.connections, "connections counted");
+    TEST_ASSERT_EQ(10u, stats.requests, "requests counted");
+    TEST_ASSERT_EQ(3u, stats.pings, "pings counted");
+    TEST_ASSERT_EQ(3u, stats.dispatched, "dispatches counted");
+    TEST_ASSERT_EQ(2u, stats.signature_failures, "signature failures counted");
+    TEST_ASSERT_EQ(2u, stats.bad_requests, "bad requests counted");
+
+    TEST_ASSERT_EQ(DC_OK, dc_interactions_server_stop(server), "stop server");
+    TEST_ASSERT_EQ(DC_OK, dc_interactions_server_stop(server), "stop is idempotent");
+    dc_interactions_server_free(server);
+
+    TEST_SUITE_END("Interactions Server Tests");
+}
+
+#else
+
+int test_interactions_server_main(void) {
+    TEST_SUITE_BEGIN("Interactions Server Tests");
+    dc_interactions_server_config_t cfg;
+    dc_interactions_server_config_init(&cfg);
+    dc_interactions_server_t* server = NULL;
+    TEST_ASSERT_EQ(DC_ERROR_NOT_IMPLEMENTED, dc_interactions_server_create(&cfg, &server),
+                   "unsupported platform");
+    TEST_SUITE_END("Interactions Server Tests");
+}
+
+#endif
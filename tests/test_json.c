@@ -13,6 +13,7 @@
 #include "model/dc_role.h"
 #include "model/dc_channel.h"
 #include "model/dc_message.h"
+#include <string.h>
 #include <yyjson.h>
 
 int test_json_main(void) {
@@ -421,8 +422,23 @@ int test_json_main(void) {
     }
     dc_json_doc_free(&doc);
     dc_string_free(&result);
+    TEST_ASSERT_EQ(0u, dc_string_length(&guild.roles_json), "guild roles raw json off by default");
+    TEST_ASSERT_EQ(0u, dc_string_length(&guild.stickers_json), "guild stickers raw json off by default");
     dc_guild_free(&guild);
 
+    TEST_ASSERT_EQ(1, dc_json_model_raw_capture_enabled(DC_JSON_RAW_CAPTURE_PRESENCE_ACTIVITIES |
+                                                        DC_JSON_RAW_CAPTURE_MESSAGE_UPDATE),
+                   "presence and message update raw json captured by default");
+    dc_json_model_set_raw_capture(DC_JSON_RAW_CAPTURE_DEFAULT | DC_JSON_RAW_CAPTURE_GUILD_ROLES);
+    TEST_ASSERT_EQ(DC_OK, dc_guild_init(&guild), "init guild raw capture");
+    TEST_ASSERT_EQ(DC_OK, dc_guild_from_json(guild_json, &guild), "parse guild with raw capture");
+    TEST_ASSERT_NEQ(NULL, strstr(dc_string_cstr(&guild.roles_json), "\"Admin\""),
+                    "guild roles raw json captured");
+    TEST_ASSERT_EQ(1, guild.has_emojis, "guild emojis set without raw capture");
+    TEST_ASSERT_EQ(0u, dc_string_length(&guild.emojis_json), "guild emojis raw json not captured");
+    dc_guild_free(&guild);
+    dc_json_model_set_raw_capture(DC_JSON_RAW_CAPTURE_DEFAULT);
+
     const char* guild_missing_id = "{\"name\":\"Guild Test\"}";
     TEST_ASSERT_EQ(DC_OK, dc_guild_init(&guild), "init guild missing id");
     TEST_ASSERT_EQ(DC_ERROR_NOT_FOUND, dc_guild_from_json(guild_missing_id, &guild),
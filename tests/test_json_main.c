@@ -7,6 +7,8 @@
 
 /* Test function declarations */
 int test_json_main(void);
+int test_json_patch_main(void);
+int test_component_node_main(void);
 
 int main(void) {
     int result = 0;
@@ -14,6 +16,8 @@ int main(void) {
     printf("Running fishydslib JSON tests...\n");
     
     result |= test_json_main();
+    result |= test_json_patch_main();
+    result |= test_component_node_main();
     
     if (result == 0) {
         printf("\nAll JSON tests passed!\n");
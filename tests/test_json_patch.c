@@ -0,0 +1,151 @@
+/**
+ * @file test_json_patch.c
+ * @brief Diff-based PATCH body tests
+ */
+
+#include "test_utils.h"
+#include "json/dc_json.h"
+#include "json/dc_json_patch.h"
+#include <yyjson.h>
+
+int test_json_patch_main(void) {
+    TEST_SUITE_BEGIN("JSON Patch Tests");
+
+    dc_string_t body;
+    size_t fields = 99;
+    dc_string_init(&body);
+
+    /* Channel: nothing changed */
+    dc_channel_t original;
+    dc_channel_t edited;
+    dc_channel_init(&original);
+    dc_channel_init(&edited);
+    original.id = edited.id = 1000;
+    dc_string_set_cstr(&original.name, "general");
+    dc_string_set_cstr(&edited.name, "general");
+    dc_string_set_cstr(&original.topic, "hello");
+    dc_string_set_cstr(&edited.topic, "hello");
+    original.rate_limit_per_user = edited.rate_limit_per_user = 5;
+    TEST_ASSERT_EQ(DC_OK, dc_json_patch_channel(&original, &edited, &body, &fields), "unchanged channel ok");
+    TEST_ASSERT_EQ(0u, fields, "unchanged channel has no fields");
+    TEST_ASSERT_EQ(0u, dc_string_length(&body), "unchanged channel body empty");
+
+    /* Changed, cleared and escaped fields */
+    dc_string_set_cstr(&edited.name, "news \"daily\"\n");
+    dc_string_clear(&edited.topic);
+    edited.parent_id.is_set = 1;
+    edited.parent_id.value = 77;
+    dc_permission_overwrite_t ow = { 5, DC_PERMISSION_OVERWRITE_TYPE_MEMBER, 1024, 2048 };
+    dc_vec_push(&edited.permission_overwrites, &ow);
+    TEST_ASSERT_EQ(DC_OK, dc_json_patch_channel(&original, &edited, &body, &fields), "changed channel ok");
+    TEST_ASSERT_EQ(4u, fields, "changed channel field count");
+    TEST_ASSERT_STR_EQ("{\"name\":\"news \\\"daily\\\"\\n\",\"topic\":null,"
+                       "\"permission_overwrites\":[{\"id\":\"5\",\"type\":1,\"allow\":\"1024\",\"deny\":\"2048\"}],"
+                       "\"parent_id\":\"77\"}",
+                       dc_string_cstr(&body), "changed channel body");
+
+    dc_json_doc_t doc;
+    TEST_ASSERT_EQ(DC_OK, dc_json_parse(dc_string_cstr(&body), &doc), "changed channel body parses");
+    const char* name = NULL;
+    TEST_ASSERT_EQ(DC_OK, dc_json_get_string(doc.root, "name", &name), "parsed name");
+    TEST_ASSERT_STR_EQ("news \"daily\"\n", name, "escaped name round-trips");
+    dc_json_doc_free(&doc);
+
+    /* The buffer is reused, not reallocated */
+    const char* storage = body.data;
+    size_t capacity = dc_string_capacity(&body);
+    dc_string_set_cstr(&edited.name, "general");
+    TEST_ASSERT_EQ(DC_OK, dc_json_patch_channel(&original, &edited, &body, &fields), "rebuild channel ok");
+    TEST_ASSERT(body.data == storage && dc_string_capacity(&body) == capacity, "body buffer reused");
+    TEST_ASSERT_EQ(3u, fields, "rebuilt channel field count");
+
+    /* Thread fields only when the edited channel is a thread */
+    dc_vec_clear(&edited.permission_overwrites);
+    dc_string_set_cstr(&edited.topic, "hello");
+    edited.parent_id.is_set = 0;
+    edited.has_thread_metadata = 1;
+    edited.thread_metadata.archived = 1;
+    TEST_ASSERT_EQ(DC_OK, dc_json_patch_channel(&original, &edited, &body, &fields), "thread patch ok");
+    TEST_ASSERT_STR_EQ("{\"archived\":true}", dc_string_cstr(&body), "thread patch body");
+
+    edited.id = 1001;
+    TEST_ASSERT_EQ(DC_ERROR_INVALID_PARAM, dc_json_patch_channel(&original, &edited, &body, &fields),
+                   "channel ID mismatch");
+    dc_channel_free(&original);
+    dc_channel_free(&edited);
+
+    /* Role */
+    dc_role_t role_a;
+    dc_role_t role_b;
+    dc_role_init(&role_a);
+    dc_role_init(&role_b);
+    role_a.id = role_b.id = 9;
+    role_a.permissions = 8;
+    role_b.permissions = 8 | 2048;
+    role_b.icon.is_null = 0;
+    dc_string_set_cstr(&role_b.icon.value, "data:image/png;base64,AA==");
+    TEST_ASSERT_EQ(DC_OK, dc_json_patch_role(&role_a, &role_b, &body, NULL), "role patch ok");
+    TEST_ASSERT_STR_EQ("{\"permissions\":\"2056\",\"icon\":\"data:image/png;base64,AA==\"}",
+                       dc_string_cstr(&body), "role patch body");
+    dc_role_free(&role_a);
+    dc_role_free(&role_b);
+
+    /* Member: role order is not a change */
+    dc_guild_member_t member_a;
+    dc_guild_member_t member_b;
+    dc_guild_member_init(&member_a);
+    dc_guild_member_init(&member_b);
+    dc_snowflake_t r1 = 11;
+    dc_snowflake_t r2 = 12;
+    dc_vec_push(&member_a.roles, &r1);
+    dc_vec_push(&member_a.roles, &r2);
+    dc_vec_push(&member_b.roles, &r2);
+    dc_vec_push(&member_b.roles, &r1);
+    TEST_ASSERT_EQ(DC_OK, dc_json_patch_guild_member(&member_a, &member_b, &body, &fields), "reordered roles ok");
+    TEST_ASSERT_EQ(0u, fields, "reordered roles unchanged");
+    dc_vec_push(&member_a.roles, &r1);
+    dc_vec_push(&member_b.roles, &r2);
+    TEST_ASSERT_EQ(DC_OK, dc_json_patch_guild_member(&member_a, &member_b, &body, &fields), "duplicate roles ok");
+    TEST_ASSERT_EQ(1u, fields, "different duplicates are a change");
+    dc_vec_pop(&member_a.roles, NULL);
+    dc_vec_pop(&member_b.roles, NULL);
+    member_a.has_user = 1;
+    member_a.user.id = 100;
+    member_b.has_user = 1;
+    member_b.user.id = 101;
+    TEST_ASSERT_EQ(DC_ERROR_INVALID_PARAM, dc_json_patch_guild_member(&member_a, &member_b, &body, &fields),
+                   "member user mismatch rejected");
+    member_b.user.id = 100;
+    member_a.nick.is_null = 0;
+    dc_string_set_cstr(&member_a.nick.value, "old");
+    member_b.mute = 1;
+    dc_vec_pop(&member_b.roles, NULL);
+    TEST_ASSERT_EQ(DC_OK, dc_json_patch_guild_member(&member_a, &member_b, &body, &fields), "member patch ok");
+    TEST_ASSERT_STR_EQ("{\"nick\":null,\"roles\":[\"12\"],\"mute\":true}", dc_string_cstr(&body),
+                       "member patch body");
+    dc_guild_member_free(&member_a);
+    dc_guild_member_free(&member_b);
+
+    /* Guild */
+    dc_guild_t guild_a;
+    dc_guild_t guild_b;
+    dc_guild_init(&guild_a);
+    dc_guild_init(&guild_b);
+    guild_a.id = guild_b.id = 3;
+    guild_a.owner_id.is_set = 1;
+    guild_a.owner_id.value = 4;
+    guild_b.afk_timeout = 300;
+    dc_string_t feature;
+    dc_string_init_from_cstr(&feature, "COMMUNITY");
+    dc_vec_push(&guild_b.features, &feature);
+    TEST_ASSERT_EQ(DC_OK, dc_json_patch_guild(&guild_a, &guild_b, &body, &fields), "guild patch ok");
+    TEST_ASSERT_STR_EQ("{\"afk_timeout\":300,\"features\":[\"COMMUNITY\"]}", dc_string_cstr(&body),
+                       "guild patch body (unset owner_id not sent)");
+    dc_guild_free(&guild_a);
+    dc_guild_free(&guild_b);
+
+    TEST_ASSERT_EQ(DC_ERROR_NULL_POINTER, dc_json_patch_role(NULL, NULL, &body, NULL), "null role");
+    dc_string_free(&body);
+
+    TEST_SUITE_END("JSON Patch Tests");
+}
@@ -0,0 +1,90 @@
+/**
+ * @file test_markdown.c
+ * @brief Markdown tokenizer tests
+ */
+
+#include "test_utils.h"
+#include "core/dc_markdown.h"
+
+static size_t tokenize(const char* content, dc_markdown_token_t* tokens, size_t max) {
+    dc_markdown_tokenizer_t tok;
+    dc_markdown_tokenizer_init(&tok, content, strlen(content));
+    size_t count = 0;
+    dc_markdown_token_t token;
+    while (dc_markdown_next(&tok, &token)) {
+        if (count < max) tokens[count] = token;
+        count++;
+    }
+    return count;
+}
+
+static int span_is(const char* ptr, size_t len, const char* expected) {
+    return len == strlen(expected) && memcmp(ptr, expected, len) == 0;
+}
+
+int test_markdown_main(void) {
+    TEST_SUITE_BEGIN("Markdown Tests");
+
+    dc_markdown_token_t t[16];
+    size_t n = tokenize("hi <@123> and <@!45> in <#6> for <@&7>", t, 16);
+    TEST_ASSERT_EQ(8u, n, "mention token count");
+    TEST_ASSERT_EQ(DC_MARKDOWN_TOKEN_USER_MENTION, t[1].type, "user mention");
+    TEST_ASSERT_EQ(123u, t[1].id, "user mention id");
+    TEST_ASSERT_EQ(45u, t[3].id, "nick mention id");
+    TEST_ASSERT_EQ(DC_MARKDOWN_TOKEN_CHANNEL_MENTION, t[5].type, "channel mention");
+    TEST_ASSERT_EQ(DC_MARKDOWN_TOKEN_ROLE_MENTION, t[7].type, "role mention");
+    TEST_ASSERT(span_is(t[2].text, t[2].text_length, " and "), "text between mentions");
+
+    n = tokenize("<a:party_blob:99> </ban user:5> <t:-100:R> <t:1700000000> <t:1:x>", t, 16);
+    TEST_ASSERT_EQ(DC_MARKDOWN_TOKEN_EMOJI, t[0].type, "emoji");
+    TEST_ASSERT(t[0].animated && span_is(t[0].name, t[0].name_length, "party_blob"), "animated emoji name");
+    TEST_ASSERT_EQ(DC_MARKDOWN_TOKEN_SLASH_COMMAND, t[2].type, "slash command");
+    TEST_ASSERT(span_is(t[2].name, t[2].name_length, "ban user"), "slash command name");
+    TEST_ASSERT_EQ(-100, t[4].timestamp, "negative timestamp");
+    TEST_ASSERT_EQ('R', t[4].timestamp_style, "timestamp style");
+    TEST_ASSERT_EQ('\0', t[6].timestamp_style, "default timestamp style");
+    TEST_ASSERT_EQ(DC_MARKDOWN_TOKEN_TEXT, t[7].type, "invalid style is text");
+    TEST_ASSERT_EQ(8u, n, "invalid timestamp merges into text");
+
+    n = tokenize("see `<@1>` and\n```c\nint x = <@2>;\n``` ok", t, 16);
+    TEST_ASSERT_EQ(DC_MARKDOWN_TOKEN_INLINE_CODE, t[1].type, "inline code");
+    TEST_ASSERT(span_is(t[1].text, t[1].text_length, "<@1>"), "inline code text");
+    TEST_ASSERT_EQ(DC_MARKDOWN_TOKEN_CODE_BLOCK, t[3].type, "code block");
+    TEST_ASSERT(span_is(t[3].name, t[3].name_length, "c"), "code block language");
+    TEST_ASSERT(span_is(t[3].text, t[3].text_length, "int x = <@2>;\n"), "code block body");
+    TEST_ASSERT_EQ(5u, n, "no mentions inside code");
+
+    n = tokenize("||secret <@9>|| **bold *both*** ~~gone~~ end", t, 16);
+    TEST_ASSERT_EQ(DC_MARKDOWN_TOKEN_SPOILER, t[0].type, "spoiler open");
+    TEST_ASSERT(t[2].styles & DC_MARKDOWN_STYLE_SPOILER, "mention inside spoiler");
+    TEST_ASSERT(t[3].closing, "spoiler close");
+    TEST_ASSERT_EQ(DC_MARKDOWN_TOKEN_BOLD, t[5].type, "bold open");
+    TEST_ASSERT_EQ(DC_MARKDOWN_TOKEN_ITALIC, t[7].type, "italic open");
+    TEST_ASSERT_EQ(DC_MARKDOWN_STYLE_BOLD | DC_MARKDOWN_STYLE_ITALIC, t[8].styles, "nested styles");
+    TEST_ASSERT(t[9].type == DC_MARKDOWN_TOKEN_ITALIC && t[9].closing, "triple run closes italic first");
+    TEST_ASSERT(t[10].type == DC_MARKDOWN_TOKEN_BOLD && t[10].closing, "then bold");
+    TEST_ASSERT_EQ(DC_MARKDOWN_TOKEN_STRIKETHROUGH, t[12].type, "strikethrough");
+    TEST_ASSERT_EQ(0u, t[n - 1].styles, "styles reset after close");
+
+    n = tokenize("snake_case_name 2 * 3 \\*not\\* @everyone", t, 16);
+    TEST_ASSERT_EQ(DC_MARKDOWN_TOKEN_TEXT, t[0].type, "intraword underscores are text");
+    TEST_ASSERT(span_is(t[0].text, t[0].text_length, "snake_case_name 2 * 3 "), "spaced star is text");
+    TEST_ASSERT(span_is(t[1].text, t[1].text_length, "*"), "escaped star");
+    TEST_ASSERT_EQ(DC_MARKDOWN_TOKEN_EVERYONE, t[n - 1].type, "everyone");
+
+    n = tokenize("go to https://example.com/a_(b). or <https://x.io/y> ahttp://no", t, 16);
+    TEST_ASSERT_EQ(DC_MARKDOWN_TOKEN_URL, t[1].type, "bare url");
+    TEST_ASSERT(span_is(t[1].text, t[1].text_length, "https://example.com/a_(b"), "trailing punctuation trimmed");
+    TEST_ASSERT(t[3].type == DC_MARKDOWN_TOKEN_URL && t[3].embed_suppressed, "suppressed url");
+    TEST_ASSERT(span_is(t[3].text, t[3].text_length, "https://x.io/y"), "suppressed url text");
+    TEST_ASSERT_EQ(5u, n, "url inside a word is text");
+
+    const char bounded[] = "<@123>";
+    dc_markdown_tokenizer_t tok;
+    dc_markdown_token_t token;
+    dc_markdown_tokenizer_init(&tok, bounded, 5);
+    TEST_ASSERT(dc_markdown_next(&tok, &token) && token.type == DC_MARKDOWN_TOKEN_TEXT, "length bounds the scan");
+    TEST_ASSERT_EQ(0, dc_markdown_next(&tok, &token), "end of input");
+
+    TEST_SUITE_END("Markdown Tests");
+}
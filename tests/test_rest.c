@@ -6,7 +6,9 @@
 #include "http/dc_rest.h"
 #include "http/dc_http_compliance.h"
 #include "core/dc_alloc.h"
+#include "core/dc_platform.h"
 #include "test_utils.h"
+#include <stdatomic.h>
 #include <string.h>
 #include <stdio.h>
 
@@ -730,3 +732,378 @@ void test_rest_request_headers_case_insensitive_reserved(void) {
 
     dc_rest_request_free(&request);
 }
+
+static void mock_response_add_header(dc_http_response_t* response, const char* name, const char* value) {
+    dc_http_header_t header;
+    dc_string_init_from_cstr(&header.name, name);
+    dc_string_init_from_cstr(&header.value, value);
+    dc_vec_push(&response->headers, &header);
+}
+
+static uint64_t test_rest_timed_execute(dc_rest_client_t* client, const char* path, dc_status_t* out_st) {
+    dc_rest_request_t request;
+    dc_rest_response_t response;
+    uint64_t start_ms = 0;
+    uint64_t end_ms = 0;
+    dc_rest_request_init(&request);
+    dc_rest_response_init(&response);
+    dc_rest_request_set_path(&request, path);
+    dc_platform_now_monotonic_ms(&start_ms);
+    *out_st = dc_rest_execute(client, &request, &response);
+    dc_platform_now_monotonic_ms(&end_ms);
+    dc_rest_response_free(&response);
+    dc_rest_request_free(&request);
+    return end_ms - start_ms;
+}
+
+void test_rest_global_limit_gcra(void) {
+    mock_transport_ctx_t mock_ctx = {0};
+    dc_http_response_t mock_response;
+    dc_http_response_init(&mock_response);
+    mock_response.status_code = 200;
+    dc_string_set_cstr(&mock_response.body, "{}");
+    mock_ctx.mock_response = &mock_response;
+    dc_http_request_init(&mock_ctx.last_request);
+
+    /* 5 per second: a burst of 5, then one every 200ms instead of waiting out a window */
+    dc_rest_client_config_t config = {
+        .token = "test_token",
+        .auth_type = DC_HTTP_AUTH_BOT,
+        .global_rate_limit_per_sec = 5,
+        .global_window_ms = 1000,
+        .transport = mock_transport,
+        .transport_userdata = &mock_ctx
+    };
+
+    dc_rest_client_t* client = NULL;
+    TEST_ASSERT_EQ(DC_OK, dc_rest_client_create(&config, &client), "create GCRA client");
+
+    dc_status_t st = DC_OK;
+    uint64_t burst_ms = 0;
+    for (int i = 0; i < 5; i++) {
+        burst_ms += test_rest_timed_execute(client, "/users/@me", &st);
+    }
+    TEST_ASSERT_EQ(DC_OK, st, "burst requests succeed");
+    TEST_ASSERT(burst_ms < 150, "burst up to the limit is not delayed");
+
+    uint64_t next_ms = test_rest_timed_execute(client, "/users/@me", &st);
+    TEST_ASSERT_EQ(DC_OK, st, "paced request succeeds");
+    TEST_ASSERT(next_ms >= 120 && next_ms < 600, "next request waits one emission interval");
+    TEST_ASSERT_EQ(6, mock_ctx.call_count, "every request reached the transport");
+
+    dc_http_request_free(&mock_ctx.last_request);
+    dc_http_response_free(&mock_response);
+    dc_rest_client_free(client);
+}
+
+void test_rest_shared_bucket_across_routes(void) {
+    mock_transport_ctx_t mock_ctx = {0};
+    dc_http_response_t mock_response;
+    dc_http_response_init(&mock_response);
+    mock_response.status_code = 200;
+    dc_string_set_cstr(&mock_response.body, "{}");
+    mock_response_add_header(&mock_response, "X-RateLimit-Limit", "5");
+    mock_response_add_header(&mock_response, "X-RateLimit-Remaining", "0");
+    mock_response_add_header(&mock_response, "X-RateLimit-Reset-After", "0.3");
+    mock_response_add_header(&mock_response, "X-RateLimit-Bucket", "shared-bucket");
+    mock_ctx.mock_response = &mock_response;
+    dc_http_request_init(&mock_ctx.last_request);
+
+    dc_rest_client_config_t config = {
+        .token = "test_token",
+        .auth_type = DC_HTTP_AUTH_BOT,
+        .transport = mock_transport,
+        .transport_userdata = &mock_ctx
+    };
+
+    dc_rest_client_t* client = NULL;
+    TEST_ASSERT_EQ(DC_OK, dc_rest_client_create(&config, &client), "create shared-bucket client");
+
+    dc_status_t st = DC_OK;
+    uint64_t first_ms = test_rest_timed_execute(client, "/channels/1/messages", &st);
+    TEST_ASSERT_EQ(DC_OK, st, "first route succeeds");
+    uint64_t second_ms = test_rest_timed_execute(client, "/channels/1/pins", &st);
+    TEST_ASSERT_EQ(DC_OK, st, "second route succeeds");
+    TEST_ASSERT(first_ms < 150 && second_ms < 150, "unmapped routes are not delayed");
+
+    /* Both routes now map to the exhausted shared bucket of channel 1 */
+    uint64_t third_ms = test_rest_timed_execute(client, "/channels/1/pins", &st);
+    TEST_ASSERT_EQ(DC_OK, st, "shared bucket request succeeds");
+    TEST_ASSERT(third_ms >= 150, "shared bucket exhaustion delays the other route");
+
+    /* Another major parameter gets its own bucket */
+    uint64_t other_ms = test_rest_timed_execute(client, "/channels/2/pins", &st);
+    TEST_ASSERT_EQ(DC_OK, st, "other channel succeeds");
+    TEST_ASSERT(other_ms < 150, "other major parameter is not delayed");
+
+    dc_http_request_free(&mock_ctx.last_request);
+    dc_http_response_free(&mock_response);
+    dc_rest_client_free(client);
+}
+
+#if !defined(_WIN32)
+#include <pthread.h>
+
+#define TEST_REST_MT_THREADS 8
+#define TEST_REST_MT_REQUESTS 200
+
+/* Echoes the URL so each caller can check it got its own response. */
+static dc_status_t test_rest_echo_transport(void* userdata, const dc_http_request_t* request,
+                                            dc_http_response_t* response) {
+    atomic_int* calls = (atomic_int*)userdata;
+    atomic_fetch_add(calls, 1);
+    response->status_code = 200;
+    mock_response_add_header(response, "X-RateLimit-Limit", "1000");
+    mock_response_add_header(response, "X-RateLimit-Remaining", "999");
+    mock_response_add_header(response, "X-RateLimit-Reset-After", "1");
+    return dc_string_set_cstr(&response->body, dc_string_cstr(&request->url));
+}
+
+typedef struct {
+    dc_rest_client_t* client;
+    int thread_index;
+    int ok;
+    int mismatched;
+} test_rest_mt_worker_t;
+
+static void* test_rest_mt_worker(void* arg) {
+    test_rest_mt_worker_t* w = (test_rest_mt_worker_t*)arg;
+    char path[64];
+    for (int i = 0; i < TEST_REST_MT_REQUESTS; i++) {
+        /* Threads share some buckets (same channel) and not others. */
+        snprintf(path, sizeof(path), "/channels/%d/messages/%d", (w->thread_index + i) % 4 + 1, i);
+        dc_rest_request_t request;
+        dc_rest_response_t response;
+        dc_rest_request_init(&request);
+        dc_rest_response_init(&response);
+        dc_rest_request_set_path(&request, path);
+        if (dc_rest_execute(w->client, &request, &response) == DC_OK &&
+            response.http.status_code == 200) {
+            w->ok++;
+            if (!strstr(dc_string_cstr(&response.http.body), path)) w->mismatched++;
+        }
+        dc_rest_response_free(&response);
+        dc_rest_request_free(&request);
+    }
+    return NULL;
+}
+
+void test_rest_concurrent_execute(void) {
+    atomic_int calls;
+    atomic_init(&calls, 0);
+    dc_rest_client_config_t config = {
+        .token = "test_token",
+        .auth_type = DC_HTTP_AUTH_BOT,
+        .global_rate_limit_per_sec = 100000,
+        .transport = test_rest_echo_transport,
+        .transport_userdata = &calls
+    };
+    dc_rest_client_t* client = NULL;
+    TEST_ASSERT_EQ(DC_OK, dc_rest_client_create(&config, &client), "create shared client");
+
+    pthread_t threads[TEST_REST_MT_THREADS];
+    test_rest_mt_worker_t workers[TEST_REST_MT_THREADS];
+    int started = 0;
+    for (int i = 0; i < TEST_REST_MT_THREADS; i++) {
+        memset(&workers[i], 0, sizeof(workers[i]));
+        workers[i].client = client;
+        workers[i].thread_index = i;
+        if (pthread_create(&threads[i], NULL, test_rest_mt_worker, &workers[i]) == 0) started++;
+    }
+    TEST_ASSERT_EQ(TEST_REST_MT_THREADS, started, "worker threads started");
+    int ok = 0;
+    int mismatched = 0;
+    for (int i = 0; i < started; i++) {
+        pthread_join(threads[i], NULL);
+        ok += workers[i].ok;
+        mismatched += workers[i].mismatched;
+    }
+    TEST_ASSERT_EQ(started * TEST_REST_MT_REQUESTS, ok, "every concurrent request succeeds");
+    TEST_ASSERT_EQ(0, mismatched, "every caller gets its own response");
+    TEST_ASSERT_EQ(started * TEST_REST_MT_REQUESTS, atomic_load(&calls), "each request sent once");
+
+    dc_rest_client_free(client);
+}
+#else
+void test_rest_concurrent_execute(void) {
+}
+#endif
+
+void test_rest_route_budget(void) {
+    mock_transport_ctx_t mock_ctx = {0};
+    dc_http_response_t mock_response;
+    dc_http_response_init(&mock_response);
+    mock_response.status_code = 200;
+    dc_string_set_cstr(&mock_response.body, "{}");
+    mock_response_add_header(&mock_response, "X-RateLimit-Limit", "5");
+    mock_response_add_header(&mock_response, "X-RateLimit-Remaining", "3");
+    mock_response_add_header(&mock_response, "X-RateLimit-Reset-After", "0.2");
+    mock_ctx.mock_response = &mock_response;
+    dc_http_request_init(&mock_ctx.last_request);
+
+    dc_rest_client_config_t config = {
+        .token = "test_token",
+        .auth_type = DC_HTTP_AUTH_BOT,
+        .transport = mock_transport,
+        .transport_userdata = &mock_ctx
+    };
+    dc_rest_client_t* client = NULL;
+    TEST_ASSERT_EQ(DC_OK, dc_rest_client_create(&config, &client), "create budget client");
+
+    dc_rest_route_budget_t budget;
+    TEST_ASSERT_EQ(DC_OK, dc_rest_get_route_budget(client, DC_HTTP_GET, "/webhooks/1/tok", &budget),
+                   "budget of unseen route");
+    TEST_ASSERT_EQ(0, budget.known, "unseen route unknown");
+
+    dc_status_t st = DC_OK;
+    (void)test_rest_timed_execute(client, "/webhooks/1/tok?wait=true", &st);
+    TEST_ASSERT_EQ(DC_OK, st, "webhook request succeeds");
+    TEST_ASSERT_EQ(DC_OK, dc_rest_get_route_budget(client, DC_HTTP_GET, "/webhooks/1/tok", &budget),
+                   "budget after response");
+    TEST_ASSERT_EQ(1, budget.known, "route known");
+    TEST_ASSERT_EQ(5u, budget.limit, "limit");
+    TEST_ASSERT_EQ(3u, budget.remaining, "remaining");
+    TEST_ASSERT(budget.reset_in_ms > 0 && budget.reset_in_ms <= 200, "reset pending");
+
+    TEST_ASSERT_EQ(DC_OK, dc_rest_get_route_budget(client, DC_HTTP_GET, "/webhooks/2/tok", &budget),
+                   "budget of other webhook");
+    TEST_ASSERT_EQ(0, budget.known, "other webhook has its own bucket");
+
+    dc_platform_sleep_ms(250);
+    TEST_ASSERT_EQ(DC_OK, dc_rest_get_route_budget(client, DC_HTTP_GET, "/webhooks/1/tok", &budget),
+                   "budget after reset");
+    TEST_ASSERT_EQ(5u, budget.remaining, "full limit after reset");
+    TEST_ASSERT_EQ(0u, (unsigned)budget.reset_in_ms, "no reset pending");
+
+    dc_http_request_free(&mock_ctx.last_request);
+    dc_http_response_free(&mock_response);
+    dc_rest_client_free(client);
+}
+
+/* Safe for concurrent calls: the primary attempt runs on the caller's thread and the hedge on its own. */
+typedef struct {
+    atomic_int call_count;
+    int slow_call;              /* 1-based transport call that stalls */
+    uint32_t slow_ms;
+    const char* remaining;      /* X-RateLimit-Remaining to report */
+    atomic_int abandoned;       /* stalls cut short by the request's cancel */
+} hedge_transport_ctx_t;
+
+static dc_status_t hedge_transport(void* userdata,
+                                   const dc_http_request_t* request,
+                                   dc_http_response_t* response) {
+    hedge_transport_ctx_t* ctx = (hedge_transport_ctx_t*)userdata;
+    if (!ctx || !request || !response) return DC_ERROR_NULL_POINTER;
+    int n = atomic_fetch_add(&ctx->call_count, 1) + 1;
+    if (n == ctx->slow_call) {
+        for (uint32_t waited = 0; waited < ctx->slow_ms; waited += 5) {
+            if (dc_http_cancel_fired(request->cancel)) {
+                atomic_fetch_add(&ctx->abandoned, 1);
+                return DC_ERROR_NETWORK;
+            }
+            dc_platform_sleep_ms(5);
+        }
+    }
+    response->status_code = 200;
+    dc_string_set_cstr(&response->body, "{\"id\":\"1\"}");
+    mock_response_add_header(response, "X-RateLimit-Limit", "10");
+    mock_response_add_header(response, "X-RateLimit-Remaining", ctx->remaining);
+    return DC_OK;
+}
+
+static uint64_t test_rest_timed_hedged(dc_rest_client_t* client, dc_status_t* out_st) {
+    dc_rest_request_t request;
+    dc_rest_response_t response;
+    uint64_t start_ms = 0;
+    uint64_t end_ms = 0;
+    dc_rest_request_init(&request);
+    dc_rest_response_init(&response);
+    dc_rest_request_set_method(&request, DC_HTTP_POST);
+    dc_rest_request_set_path(&request, "/channels/1/messages");
+    dc_rest_request_set_json_body(&request, "{\"content\":\"hi\",\"nonce\":\"7\"}");
+    dc_platform_now_monotonic_ms(&start_ms);
+    *out_st = dc_rest_execute_hedged(client, &request, &response);
+    dc_platform_now_monotonic_ms(&end_ms);
+    if (*out_st == DC_OK && response.http.status_code != 200) *out_st = DC_ERROR_HTTP;
+    dc_rest_response_free(&response);
+    dc_rest_request_free(&request);
+    return end_ms - start_ms;
+}
+
+void test_rest_hedged_send(void) {
+    hedge_transport_ctx_t ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    atomic_init(&ctx.call_count, 0);
+    atomic_init(&ctx.abandoned, 0);
+    ctx.slow_call = 41;
+    ctx.slow_ms = 400;
+    ctx.remaining = "9";
+
+    dc_rest_client_config_t config = {
+        .token = "test_token",
+        .auth_type = DC_HTTP_AUTH_BOT,
+        .hedge_min_delay_ms = 30,
+        .transport = hedge_transport,
+        .transport_userdata = &ctx
+    };
+    dc_rest_client_t* client = NULL;
+    TEST_ASSERT_EQ(DC_OK, dc_rest_client_create(&config, &client), "create hedging client");
+
+    dc_rest_hedge_stats_t stats;
+    dc_status_t st = DC_OK;
+    for (int i = 0; i < 40; i++) {
+        test_rest_timed_hedged(client, &st);
+    }
+    TEST_ASSERT_EQ(DC_OK, st, "warm-up sends succeed");
+    TEST_ASSERT_EQ(DC_OK, dc_rest_get_hedge_stats(client, &stats), "read hedge stats");
+    TEST_ASSERT_EQ(40, (int)stats.requests, "warm-up calls counted");
+    TEST_ASSERT_EQ(0, (int)stats.hedges_sent, "fast calls are not hedged");
+    TEST_ASSERT_EQ(30, (int)stats.threshold_ms, "threshold floors at hedge_min_delay_ms");
+
+    uint64_t slow_ms = test_rest_timed_hedged(client, &st);
+    TEST_ASSERT_EQ(DC_OK, st, "hedged send succeeds");
+    TEST_ASSERT(slow_ms < 250, "hedge answers before the stalled attempt");
+    TEST_ASSERT_EQ(DC_OK, dc_rest_get_hedge_stats(client, &stats), "read hedge stats again");
+    TEST_ASSERT_EQ(1, (int)stats.hedges_sent, "one hedge sent");
+    TEST_ASSERT_EQ(1, (int)stats.hedges_won, "hedge won the race");
+    TEST_ASSERT_EQ(42, atomic_load(&ctx.call_count), "both attempts reached the transport");
+    TEST_ASSERT_EQ(1, atomic_load(&ctx.abandoned), "the stalled first attempt was abandoned");
+
+    dc_rest_client_free(client);
+}
+
+void test_rest_hedged_send_respects_bucket(void) {
+    hedge_transport_ctx_t ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    atomic_init(&ctx.call_count, 0);
+    atomic_init(&ctx.abandoned, 0);
+    ctx.slow_call = 41;
+    ctx.slow_ms = 200;
+    ctx.remaining = "1";
+
+    dc_rest_client_config_t config = {
+        .token = "test_token",
+        .auth_type = DC_HTTP_AUTH_BOT,
+        .hedge_min_delay_ms = 30,
+        .transport = hedge_transport,
+        .transport_userdata = &ctx
+    };
+    dc_rest_client_t* client = NULL;
+    TEST_ASSERT_EQ(DC_OK, dc_rest_client_create(&config, &client), "create hedging client");
+
+    dc_status_t st = DC_OK;
+    for (int i = 0; i < 40; i++) {
+        test_rest_timed_hedged(client, &st);
+    }
+    uint64_t slow_ms = test_rest_timed_hedged(client, &st);
+    TEST_ASSERT_EQ(DC_OK, st, "slow send succeeds");
+    TEST_ASSERT(slow_ms >= 150, "no hedge without spare bucket budget");
+
+    dc_rest_hedge_stats_t stats;
+    TEST_ASSERT_EQ(DC_OK, dc_rest_get_hedge_stats(client, &stats), "read hedge stats");
+    TEST_ASSERT_EQ(0, (int)stats.hedges_sent, "no hedge sent");
+    TEST_ASSERT_EQ(1, (int)stats.hedges_skipped, "skipped hedge counted");
+    TEST_ASSERT_EQ(41, atomic_load(&ctx.call_count), "only the first attempt was sent");
+
+    dc_rest_client_free(client);
+}
@@ -21,6 +21,12 @@ void test_rest_execute_rejects_non_https_full_url(void);
 void test_rest_execute_rejects_non_discord_https_full_url(void);
 void test_rest_execute_requires_content_type_for_raw_body(void);
 void test_rest_request_headers_case_insensitive_reserved(void);
+void test_rest_global_limit_gcra(void);
+void test_rest_shared_bucket_across_routes(void);
+void test_rest_concurrent_execute(void);
+void test_rest_route_budget(void);
+void test_rest_hedged_send(void);
+void test_rest_hedged_send_respects_bucket(void);
 
 #include <stdio.h>
 #include "test_utils.h"
@@ -45,6 +51,12 @@ int main(void) {
     test_rest_execute_rejects_non_discord_https_full_url();
     test_rest_execute_requires_content_type_for_raw_body();
     test_rest_request_headers_case_insensitive_reserved();
+    test_rest_global_limit_gcra();
+    test_rest_shared_bucket_across_routes();
+    test_rest_concurrent_execute();
+    test_rest_route_budget();
+    test_rest_hedged_send();
+    test_rest_hedged_send_respects_bucket();
     
     printf("\n=== REST Client Test Summary ===\n");
     printf("Total tests: %d\n", test_count);
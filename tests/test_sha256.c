@@ -0,0 +1,52 @@
+/**
+ * @file test_sha256.c
+ * @brief SHA-256 tests (FIPS 180-4 examples)
+ */
+
+#include <string.h>
+#include "test_utils.h"
+#include "core/dc_sha256.h"
+
+int test_sha256_main(void) {
+    TEST_SUITE_BEGIN("SHA-256 Tests");
+
+    uint8_t digest[DC_SHA256_DIGEST_SIZE];
+    dc_sha256_t ctx;
+
+    dc_sha256_init(&ctx);
+    dc_sha256_final(&ctx, digest);
+    TEST_ASSERT_EQ(DC_OK, dc_sha256_compare_hex(digest,
+        "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855"), "empty input");
+
+    dc_sha256_init(&ctx);
+    dc_sha256_update(&ctx, "abc", 3);
+    dc_sha256_final(&ctx, digest);
+    TEST_ASSERT_EQ(DC_OK, dc_sha256_compare_hex(digest,
+        "BA7816BF8F01CFEA414140DE5DAE2223B00361A396177A9CB410FF61F20015AD"), "abc (upper-case hex)");
+
+    /* Two-block message fed in uneven pieces */
+    const char* msg = "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq";
+    dc_sha256_init(&ctx);
+    dc_sha256_update(&ctx, msg, 5);
+    dc_sha256_update(&ctx, msg + 5, 50);
+    dc_sha256_update(&ctx, msg + 55, strlen(msg) - 55);
+    dc_sha256_final(&ctx, digest);
+    TEST_ASSERT_EQ(DC_OK, dc_sha256_compare_hex(digest,
+        "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1"), "two-block message");
+
+    uint8_t block[1000];
+    memset(block, 'a', sizeof(block));
+    dc_sha256_init(&ctx);
+    for (int i = 0; i < 1000; i++) dc_sha256_update(&ctx, block, sizeof(block));
+    dc_sha256_final(&ctx, digest);
+    TEST_ASSERT_EQ(DC_OK, dc_sha256_compare_hex(digest,
+        "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0"), "one million a");
+
+    TEST_ASSERT_EQ(DC_ERROR_INVALID_STATE, dc_sha256_compare_hex(digest,
+        "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd1"), "mismatch detected");
+    TEST_ASSERT_EQ(DC_ERROR_INVALID_FORMAT, dc_sha256_compare_hex(digest, "cdc7"), "short hex rejected");
+    TEST_ASSERT_EQ(DC_ERROR_INVALID_FORMAT, dc_sha256_compare_hex(digest,
+        "zdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0"), "bad hex rejected");
+
+    TEST_SUITE_END("SHA-256 Tests");
+}
@@ -0,0 +1,82 @@
+/**
+ * @file test_snowflake_map.c
+ * @brief Snowflake map tests
+ */
+
+#include "test_utils.h"
+#include "core/dc_snowflake_map.h"
+
+int test_snowflake_map_main(void) {
+    TEST_SUITE_BEGIN("Snowflake Map Tests");
+
+    dc_snowflake_map_t map;
+    TEST_ASSERT_EQ(DC_OK, dc_snowflake_map_init(&map, sizeof(uint32_t)), "map init");
+    TEST_ASSERT_EQ(0u, dc_snowflake_map_length(&map), "map empty");
+    TEST_ASSERT_NULL(dc_snowflake_map_get(&map, 42), "get on empty map");
+    TEST_ASSERT_EQ(DC_ERROR_INVALID_PARAM, dc_snowflake_map_init(&map, 0), "zero element size rejected");
+    TEST_ASSERT_EQ(DC_OK, dc_snowflake_map_init(&map, sizeof(uint32_t)), "map re-init");
+
+    uint32_t v = 7;
+    TEST_ASSERT_EQ(DC_ERROR_INVALID_PARAM, dc_snowflake_map_put(&map, 0, &v), "key 0 rejected");
+
+    /* Snowflake-like keys sharing high bits and stepping the low bits. */
+    const dc_snowflake_t base = 175928847299117063ULL;
+    int ok = 1;
+    for (uint32_t i = 0; i < 1000; i++) {
+        if (dc_snowflake_map_put(&map, base + i, &i) != DC_OK) ok = 0;
+    }
+    TEST_ASSERT(ok, "insert 1000 keys");
+    TEST_ASSERT_EQ(1000u, dc_snowflake_map_length(&map), "length after inserts");
+
+    ok = 1;
+    for (uint32_t i = 0; i < 1000; i++) {
+        const uint32_t* got = (const uint32_t*)dc_snowflake_map_get(&map, base + i);
+        if (!got || *got != i) ok = 0;
+    }
+    TEST_ASSERT(ok, "lookup all keys");
+
+    v = 99;
+    TEST_ASSERT_EQ(DC_OK, dc_snowflake_map_put(&map, base + 5, &v), "overwrite existing");
+    TEST_ASSERT_EQ(1000u, dc_snowflake_map_length(&map), "overwrite keeps length");
+    TEST_ASSERT_EQ(99u, *(const uint32_t*)dc_snowflake_map_get(&map, base + 5), "overwritten value");
+
+    void* slot = NULL;
+    int inserted = -1;
+    TEST_ASSERT_EQ(DC_OK, dc_snowflake_map_upsert(&map, base + 5, &slot, &inserted), "upsert existing");
+    TEST_ASSERT_EQ(0, inserted, "upsert existing not inserted");
+    TEST_ASSERT_EQ(DC_OK, dc_snowflake_map_upsert(&map, 1, &slot, &inserted), "upsert new");
+    TEST_ASSERT_EQ(1, inserted, "upsert new inserted");
+    TEST_ASSERT_EQ(0u, *(const uint32_t*)slot, "upsert new zeroed");
+
+    uint32_t removed = 0;
+    ok = 1;
+    for (uint32_t i = 0; i < 1000; i += 2) {
+        if (dc_snowflake_map_remove(&map, base + i, &removed) != DC_OK) ok = 0;
+        if (removed != i) ok = 0;
+    }
+    TEST_ASSERT(ok, "remove even keys");
+    TEST_ASSERT_EQ(501u, dc_snowflake_map_length(&map), "length after removals");
+    TEST_ASSERT_EQ(DC_ERROR_NOT_FOUND, dc_snowflake_map_remove(&map, base, NULL), "remove missing");
+
+    ok = 1;
+    for (uint32_t i = 0; i < 1000; i++) {
+        int present = dc_snowflake_map_contains(&map, base + i);
+        if (present != (int)(i % 2u)) ok = 0;
+    }
+    TEST_ASSERT(ok, "odd keys survive backward-shift removal");
+
+    size_t cursor = 0;
+    size_t seen = 0;
+    dc_snowflake_t key = 0;
+    while (dc_snowflake_map_next(&map, &cursor, &key, NULL)) seen++;
+    TEST_ASSERT_EQ(501u, seen, "iteration visits every entry");
+
+    TEST_ASSERT_EQ(DC_OK, dc_snowflake_map_clear(&map), "clear");
+    TEST_ASSERT_EQ(0u, dc_snowflake_map_length(&map), "length after clear");
+    TEST_ASSERT(!dc_snowflake_map_contains(&map, base + 1), "cleared key gone");
+
+    dc_snowflake_map_free(&map);
+    TEST_ASSERT_EQ(0u, dc_snowflake_map_length(&map), "length after free");
+
+    TEST_SUITE_END("Snowflake Map Tests");
+}
@@ -12,6 +12,7 @@ void test_status_string(void) {
     TEST_ASSERT_STR_EQ("Out of memory", dc_status_string(DC_ERROR_OUT_OF_MEMORY), "DC_ERROR_OUT_OF_MEMORY string");
     TEST_ASSERT_STR_EQ("Not implemented", dc_status_string(DC_ERROR_NOT_IMPLEMENTED), "DC_ERROR_NOT_IMPLEMENTED string");
     TEST_ASSERT_STR_EQ("Bad request", dc_status_string(DC_ERROR_BAD_REQUEST), "DC_ERROR_BAD_REQUEST string");
+    TEST_ASSERT_STR_EQ("Missing permissions", dc_status_string(DC_ERROR_MISSING_PERMISSIONS), "DC_ERROR_MISSING_PERMISSIONS string");
 }
 
 void test_status_recoverable(void) {
@@ -39,6 +39,22 @@ int test_string_main(void) {
     TEST_ASSERT_EQ(DC_OK, dc_string_shrink_to_fit(&str), "shrink to fit");
     TEST_ASSERT_EQ(dc_string_length(&str) + 1u, dc_string_capacity(&str), "capacity after shrink");
 
+    dc_string_t other;
+    TEST_ASSERT_EQ(DC_OK, dc_string_init_from_cstr(&other, "moved body"), "init other");
+    const char* other_data = other.data;
+    TEST_ASSERT_EQ(DC_OK, dc_string_take(&str, &other), "take");
+    TEST_ASSERT(str.data == other_data, "take moves the buffer");
+    TEST_ASSERT_STR_EQ("moved body", dc_string_cstr(&str), "content after take");
+    TEST_ASSERT_EQ(0u, dc_string_length(&other), "source empty after take");
+    TEST_ASSERT_STR_EQ("", dc_string_cstr(&other), "source cstr after take");
+
+    TEST_ASSERT_EQ(DC_OK, dc_string_set_cstr(&other, "x"), "source reusable after take");
+    dc_string_swap(&str, &other);
+    TEST_ASSERT_STR_EQ("x", dc_string_cstr(&str), "swap first");
+    TEST_ASSERT_STR_EQ("moved body", dc_string_cstr(&other), "swap second");
+    TEST_ASSERT_EQ(DC_ERROR_NULL_POINTER, dc_string_take(NULL, &other), "take null dst");
+    dc_string_free(&other);
+
     dc_string_free(&str);
 
     TEST_SUITE_END("String Tests");
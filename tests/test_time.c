@@ -45,6 +45,37 @@ int test_time_main(void) {
     dc_iso8601_t invalid = { .year = 2023, .month = 13, .day = 1, .hour = 0, .minute = 0, .second = 0, .millisecond = 0, .utc_offset_minutes = 0, .is_utc = 1 };
     TEST_ASSERT_EQ(DC_ERROR_INVALID_PARAM, dc_iso8601_validate(&invalid), "invalid month");
 
+    int64_t fast_ms = 0;
+    TEST_ASSERT_EQ(DC_OK, dc_iso8601_parse_unix_ms("2023-01-01T12:34:56.789000+00:00", 32, &fast_ms),
+                   "fast parse microseconds");
+    TEST_ASSERT_EQ((int64_t)1672576496789LL, fast_ms, "fast microseconds value");
+    TEST_ASSERT_EQ(DC_OK, dc_iso8601_parse_unix_ms("2023-01-01T12:34:56+02:30xx", 25, &fast_ms),
+                   "fast parse honours length");
+    TEST_ASSERT_EQ((int64_t)1672567496000LL, fast_ms, "fast offset value");
+    TEST_ASSERT_EQ(DC_OK, dc_iso8601_parse_unix_ms("1969-12-31T23:59:59Z", 20, &fast_ms), "fast pre-epoch");
+    TEST_ASSERT_EQ((int64_t)-1000, fast_ms, "fast pre-epoch value");
+
+    /* Fast path and fallback agree with dc_iso8601_parse on results and errors */
+    static const char* const samples[] = {
+        "2023-01-01T12:34:56Z", "2023-01-01T12:34:56.789Z", "2023-01-01T12:34:56.789123Z",
+        "2023-01-01T12:34:56+00:00", "2024-02-29T00:00:00.5-08:00", "2023-06-30T23:59:59.12345+05:45",
+        "2023-02-29T00:00:00+00:00", "2023-01-01T24:00:00Z", "2023-01-01T12:34:56+15:00",
+        "2023-01-01 12:34:56+00:00", "2023-01-01T12:34:5x.789Z", "2023-01-01T12:34:56.78a+00:00",
+        "2023-01-01T12:34:56.Z", "2023-01-01T12:34:56", "2023-01-01T12:34:56*00:00", "",
+        "0000-01-01T00:00:00Z", "2000-02-29T00:00:00.123+00:00", "2100-02-29T00:00:00.123456+00:00",
+        "2023-12-31T23:59:59.999999-14:00", "2023-01-01T12:34:56.789+0a:00", "2023-01-01T12:34:56.7x9123Z"
+    };
+    int agree = 1;
+    for (size_t i = 0; i < sizeof(samples) / sizeof(samples[0]); i++) {
+        uint64_t slow_ms = 0;
+        dc_status_t slow = dc_iso8601_parse(samples[i], &ts);
+        dc_status_t fast = dc_iso8601_parse_unix_ms(samples[i], strlen(samples[i]), &fast_ms);
+        if (fast != slow) agree = 0;
+        /* Pre-epoch values only exist on the signed side */
+        if (slow == DC_OK && dc_iso8601_to_unix_ms(&ts, &slow_ms) == DC_OK && (uint64_t)fast_ms != slow_ms) agree = 0;
+    }
+    TEST_ASSERT(agree, "fast parse matches general parser");
+
     dc_iso8601_t now_utc;
     TEST_ASSERT_EQ(DC_OK, dc_iso8601_now_utc(&now_utc), "now utc");
     TEST_ASSERT_EQ(DC_OK, dc_iso8601_validate(&now_utc), "now utc valid");
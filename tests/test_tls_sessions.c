@@ -0,0 +1,433 @@
+/**
+ * @file test_tls_sessions.c
+ * @brief TLS session store and resumption counters, with a loopback TLS server when OpenSSL is available
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "test_utils.h"
+#include "http/dc_tls_sessions.h"
+
+typedef struct {
+    int calls;
+    size_t last_len;
+    unsigned char first_byte;
+} test_tls_visit_t;
+
+static dc_status_t test_tls_visit(void* ctx, const dc_tls_session_t* session) {
+    test_tls_visit_t* v = (test_tls_visit_t*)ctx;
+    v->calls++;
+    v->last_len = session->data_len;
+    v->first_byte = session->data_len > 0 ? session->data[0] : 0;
+    return DC_OK;
+}
+
+#if defined(DC_HAVE_OPENSSL) && defined(__linux__)
+
+#include <curl/curl.h>
+#include <openssl/evp.h>
+#include <openssl/pem.h>
+#include <openssl/ssl.h>
+#include <openssl/x509.h>
+#include <pthread.h>
+#include <poll.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+/* Loopback TLS server: sequential connections, one response each, Connection: close. */
+typedef struct {
+    int listen_fd;
+    uint16_t port;
+    SSL_CTX* ctx;
+    int stop;
+    int handshakes;
+    int resumed;
+    pthread_t thread;
+} test_tls_server_t;
+
+static void test_tls_serve_one(test_tls_server_t* s, int fd) {
+    SSL* ssl = SSL_new(s->ctx);
+    if (!ssl) {
+        close(fd);
+        return;
+    }
+    SSL_set_fd(ssl, fd);
+    if (SSL_accept(ssl) == 1) {
+        __atomic_add_fetch(&s->handshakes, 1, __ATOMIC_SEQ_CST);
+        if (SSL_session_reused(ssl)) __atomic_add_fetch(&s->resumed, 1, __ATOMIC_SEQ_CST);
+        char buf[2048];
+        size_t have = 0;
+        while (have < sizeof(buf) - 1u) {
+            int n = SSL_read(ssl, buf + have, (int)(sizeof(buf) - 1u - have));
+            if (n <= 0) break;
+            have += (size_t)n;
+            buf[have] = '\0';
+            if (strstr(buf, "\r\n\r\n")) break;
+        }
+        static const char resp[] =
+            "HTTP/1.1 200 OK\r\nContent-Length: 2\r\nConnection: close\r\n\r\nok";
+        (void)SSL_write(ssl, resp, (int)(sizeof(resp) - 1u));
+        (void)SSL_shutdown(ssl);
+    }
+    SSL_free(ssl);
+    close(fd);
+}
+
+static void* test_tls_accept_main(void* arg) {
+    test_tls_server_t* s = (test_tls_server_t*)arg;
+    while (!__atomic_load_n(&s->stop, __ATOMIC_SEQ_CST)) {
+        struct pollfd pfd = { s->listen_fd, POLLIN, 0 };
+        if (poll(&pfd, 1, 50) <= 0) continue;
+        int fd = accept(s->listen_fd, NULL, NULL);
+        if (fd < 0) continue;
+        test_tls_serve_one(s, fd);
+    }
+    return NULL;
+}
+
+/* Self-signed P-256 certificate generated in memory. */
+static int test_tls_ctx_init(test_tls_server_t* s) {
+    EVP_PKEY* pkey = NULL;
+    EVP_PKEY_CTX* kctx = EVP_PKEY_CTX_new_id(EVP_PKEY_EC, NULL);
+    if (!kctx || EVP_PKEY_keygen_init(kctx) <= 0 ||
+        EVP_PKEY_CTX_set_ec_paramgen_curve_nid(kctx, NID_X9_62_prime256v1) <= 0 ||
+        EVP_PKEY_keygen(kctx, &pkey) <= 0) {
+        EVP_PKEY_CTX_free(kctx);
+        return 0;
+    }
+    EVP_PKEY_CTX_free(kctx);
+
+    X509* cert = X509_new();
+    int ok = cert != NULL;
+    if (ok) {
+        X509_set_version(cert, 2);
+        ASN1_INTEGER_set(X509_get_serialNumber(cert), 1);
+        X509_gmtime_adj(X509_getm_notBefore(cert), 0);
+        X509_gmtime_adj(X509_getm_notAfter(cert), 3600L);
+        X509_set_pubkey(cert, pkey);
+        X509_NAME* name = X509_get_subject_name(cert);
+        X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC, (const unsigned char*)"localhost", -1, -1, 0);
+        X509_set_issuer_name(cert, name);
+        ok = X509_sign(cert, pkey, EVP_sha256()) > 0;
+    }
+    s->ctx = ok ? SSL_CTX_new(TLS_server_method()) : NULL;
+    ok = s->ctx && SSL_CTX_use_certificate(s->ctx, cert) == 1 &&
+         SSL_CTX_use_PrivateKey(s->ctx, pkey) == 1;
+    X509_free(cert);
+    EVP_PKEY_free(pkey);
+    return ok;
+}
+
+/* Extra CAs go into the context's store next to whatever it already trusts. */
+static void test_tls_extra_ca(void) {
+    test_tls_server_t s;
+    memset(&s, 0, sizeof(s));
+    TEST_ASSERT(test_tls_ctx_init(&s), "generate certificate");
+    BIO* bio = BIO_new(BIO_s_mem());
+    char* pem_data = NULL;
+    long pem_len = 0;
+    if (bio && s.ctx && PEM_write_bio_X509(bio, SSL_CTX_get0_certificate(s.ctx)) == 1) {
+        pem_len = BIO_get_mem_data(bio, &pem_data);
+    }
+    TEST_ASSERT(pem_len > 0, "certificate as PEM");
+    char* pem = (char*)calloc(1, (size_t)(pem_len > 0 ? pem_len : 0) + 1u);
+    if (pem && pem_len > 0) memcpy(pem, pem_data, (size_t)pem_len);
+
+    SSL_CTX* client_ctx = SSL_CTX_new(TLS_client_method());
+    X509_STORE* store = client_ctx ? SSL_CTX_get_cert_store(client_ctx) : NULL;
+    int before = store ? sk_X509_OBJECT_num(X509_STORE_get0_objects(store)) : -1;
+    TEST_ASSERT_EQ(DC_OK, dc_tls_ssl_ctx_add_ca_pem(client_ctx, pem), "add extra CA");
+    int after = store ? sk_X509_OBJECT_num(X509_STORE_get0_objects(store)) : -1;
+    TEST_ASSERT_EQ(before + 1, after, "store holds the certificate");
+    TEST_ASSERT_EQ(DC_OK, dc_tls_ssl_ctx_add_ca_pem(client_ctx, pem), "adding it twice is fine");
+    TEST_ASSERT_EQ(DC_ERROR_INVALID_FORMAT, dc_tls_ssl_ctx_add_ca_pem(client_ctx, "not a certificate"),
+                   "reject non-PEM");
+    TEST_ASSERT_EQ(DC_ERROR_NULL_POINTER, dc_tls_ssl_ctx_add_ca_pem(client_ctx, NULL), "null PEM");
+
+    SSL_CTX_free(client_ctx);
+    free(pem);
+    BIO_free(bio);
+    SSL_CTX_free(s.ctx);
+}
+
+static int test_tls_server_start(test_tls_server_t* s) {
+    memset(s, 0, sizeof(*s));
+    if (!test_tls_ctx_init(s)) return 0;
+    s->listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (s->listen_fd < 0) return 0;
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t alen = sizeof(addr);
+    if (bind(s->listen_fd, (struct sockaddr*)&addr, sizeof(addr)) != 0 ||
+        listen(s->listen_fd, 16) != 0 ||
+        getsockname(s->listen_fd, (struct sockaddr*)&addr, &alen) != 0) {
+        close(s->listen_fd);
+        return 0;
+    }
+    s->port = ntohs(addr.sin_port);
+    return pthread_create(&s->thread, NULL, test_tls_accept_main, s) == 0;
+}
+
+static void test_tls_server_stop(test_tls_server_t* s) {
+    __atomic_store_n(&s->stop, 1, __ATOMIC_SEQ_CST);
+    pthread_join(s->thread, NULL);
+    close(s->listen_fd);
+    SSL_CTX_free(s->ctx);
+}
+
+static size_t test_tls_discard(char* ptr, size_t size, size_t nmemb, void* userdata) {
+    (void)ptr;
+    (void)userdata;
+    return size * nmemb;
+}
+
+/* One request on a fresh handle, so every call opens a new connection. */
+static int test_tls_fetch(const char* url) {
+    CURL* easy = curl_easy_init();
+    if (!easy) return 0;
+    dc_tls_curl_probe_t probe;
+    memset(&probe, 0, sizeof(probe));
+    probe.easy = easy;
+    dc_tls_sessions_attach_curl(easy);
+    dc_tls_sessions_probe_curl(&probe);
+    curl_easy_setopt(easy, CURLOPT_URL, url);
+    curl_easy_setopt(easy, CURLOPT_SSL_VERIFYPEER, 0L);
+    curl_easy_setopt(easy, CURLOPT_SSL_VERIFYHOST, 0L);
+    curl_easy_setopt(easy, CURLOPT_WRITEFUNCTION, test_tls_discard);
+    curl_easy_setopt(easy, CURLOPT_TIMEOUT_MS, 5000L);
+    CURLcode rc = curl_easy_perform(easy);
+    long status = 0;
+    curl_easy_getinfo(easy, CURLINFO_RESPONSE_CODE, &status);
+    if (rc == CURLE_OK) dc_tls_sessions_record_curl(&probe);
+    curl_easy_cleanup(easy);
+    return rc == CURLE_OK && status == 200;
+}
+
+static int test_tls_curl_uses_openssl(void) {
+    const curl_version_info_data* info = curl_version_info(CURLVERSION_NOW);
+    return info && info->ssl_version && strncmp(info->ssl_version, "OpenSSL", 7) == 0;
+}
+
+/* Session import/export is an opt-in libcurl build feature. */
+static int test_tls_curl_can_export(void) {
+#if LIBCURL_VERSION_NUM >= 0x080c00
+    const curl_version_info_data* info = curl_version_info(CURLVERSION_NOW);
+    if (!info || !info->feature_names) return 0;
+    for (const char* const* f = info->feature_names; *f; f++) {
+        if (strcmp(*f, "SSLS-EXPORT") == 0) return 1;
+    }
+#endif
+    return 0;
+}
+
+/* Store that calls back into the library from load, which must not run under its locks. */
+typedef struct {
+    dc_tls_session_store_t inner;
+    int loads;
+} test_tls_reentrant_store_t;
+
+static dc_status_t test_tls_reentrant_save(void* userdata, const dc_tls_session_t* session) {
+    test_tls_reentrant_store_t* rs = (test_tls_reentrant_store_t*)userdata;
+    return rs->inner.save(rs->inner.userdata, session);
+}
+
+static dc_status_t test_tls_reentrant_load(void* userdata, dc_tls_session_source_t source, const char* key,
+                                           dc_tls_session_visit_fn visit, void* visit_ctx) {
+    test_tls_reentrant_store_t* rs = (test_tls_reentrant_store_t*)userdata;
+    rs->loads++;
+    (void)dc_tls_sessions_flush();
+    return rs->inner.load(rs->inner.userdata, source, key, visit, visit_ctx);
+}
+
+static void test_tls_loopback(void) {
+    test_tls_server_t server;
+    TEST_ASSERT(test_tls_server_start(&server), "start loopback TLS server");
+    char url[64];
+    snprintf(url, sizeof(url), "https://127.0.0.1:%u/", server.port);
+    int classified = test_tls_curl_uses_openssl();
+
+    dc_tls_memory_store_t* ms = NULL;
+    TEST_ASSERT_EQ(DC_OK, dc_tls_memory_store_create(&ms), "create store for loopback");
+    dc_tls_session_store_t store;
+    dc_tls_memory_store_bind(ms, &store);
+    TEST_ASSERT_EQ(DC_OK, dc_tls_sessions_set_store(&store), "install store");
+
+    /* In-process: the first connection negotiates, the rest resume from the shared cache */
+    dc_tls_sessions_reset_stats();
+    TEST_ASSERT_EQ(DC_OK, dc_tls_sessions_acquire(), "acquire shared cache");
+    int fetched = 1;
+    for (int i = 0; i < 4; i++) fetched &= test_tls_fetch(url);
+    TEST_ASSERT(fetched, "loopback fetches succeed");
+
+    dc_tls_session_stats_t stats;
+    dc_tls_sessions_get_stats(&stats);
+    TEST_ASSERT_EQ(4, server.handshakes, "one handshake per fetch");
+    TEST_ASSERT_EQ(3, server.resumed, "server saw three resumptions");
+    TEST_ASSERT_EQ(0u, stats.http.reused, "no connection reuse across handles");
+    if (classified) {
+        TEST_ASSERT_EQ(1u, stats.http.full, "one full handshake counted");
+        TEST_ASSERT_EQ(3u, stats.http.resumed, "three resumptions counted");
+    } else {
+        TEST_ASSERT_EQ(4u, stats.http.unclassified, "handshakes counted as unclassified");
+    }
+    if (test_tls_curl_can_export()) {
+        TEST_ASSERT(dc_tls_memory_store_count(ms) >= 1u, "session exported to store");
+        TEST_ASSERT(stats.http.saved >= 1u, "saves counted");
+
+        /* Cross-process: a fresh cache imports the stored session and resumes at once */
+        dc_tls_sessions_release();
+        dc_tls_sessions_reset_stats();
+        TEST_ASSERT_EQ(DC_OK, dc_tls_sessions_acquire(), "reacquire empty cache");
+        dc_tls_sessions_get_stats(&stats);
+        TEST_ASSERT(stats.http.loaded >= 1u, "session imported from store");
+        TEST_ASSERT(test_tls_fetch(url), "fetch after import");
+        TEST_ASSERT_EQ(4, server.resumed, "imported session resumed");
+        if (classified) {
+            dc_tls_sessions_get_stats(&stats);
+            TEST_ASSERT_EQ(1u, stats.http.resumed, "import resumption counted");
+            TEST_ASSERT_EQ(0u, stats.http.full, "no full handshake after import");
+        }
+
+        /* Store callbacks run outside the cache lock, so they may call back in */
+        test_tls_reentrant_store_t rs;
+        memset(&rs, 0, sizeof(rs));
+        rs.inner = store;
+        dc_tls_session_store_t reentrant = { test_tls_reentrant_save, test_tls_reentrant_load, &rs };
+        dc_tls_sessions_release();
+        TEST_ASSERT_EQ(DC_OK, dc_tls_sessions_set_store(&reentrant), "install reentrant store");
+        TEST_ASSERT_EQ(DC_OK, dc_tls_sessions_acquire(), "acquire with reentrant store");
+        TEST_ASSERT_EQ(1, rs.loads, "reentrant store loaded once");
+        TEST_ASSERT(test_tls_fetch(url), "fetch with reentrant store");
+        TEST_ASSERT_EQ(DC_OK, dc_tls_sessions_set_store(&store), "reinstall memory store");
+    }
+
+    /* Offload requested: the transfer works whether or not the kernel takes over */
+    TEST_ASSERT_EQ(DC_OK, dc_tls_set_kernel_offload(1), "enable offload for loopback");
+    dc_tls_sessions_reset_stats();
+    TEST_ASSERT(test_tls_fetch(url), "fetch with offload requested");
+    dc_tls_sessions_get_stats(&stats);
+    TEST_ASSERT(stats.http.ktls_tx <= 1u && stats.http.ktls_rx <= 1u, "offload counted at most once");
+    dc_tls_set_kernel_offload(0);
+
+    dc_tls_sessions_release();
+    TEST_ASSERT_EQ(DC_OK, dc_tls_sessions_set_store(NULL), "uninstall store");
+    dc_tls_memory_store_free(ms);
+    dc_tls_sessions_reset_stats();
+    test_tls_server_stop(&server);
+}
+
+#endif
+
+int test_tls_sessions_main(void) {
+    TEST_SUITE_BEGIN("TLS Session Tests");
+
+    /* Memory store: replace by key, filter by source/key, skip expired */
+    dc_tls_memory_store_t* ms = NULL;
+    TEST_ASSERT_EQ(DC_ERROR_NULL_POINTER, dc_tls_memory_store_create(NULL), "create null");
+    TEST_ASSERT_EQ(DC_OK, dc_tls_memory_store_create(&ms), "create memory store");
+    dc_tls_session_store_t store;
+    TEST_ASSERT_EQ(DC_OK, dc_tls_memory_store_bind(ms, &store), "bind memory store");
+
+    unsigned char blob_a[4] = { 1, 2, 3, 4 };
+    unsigned char blob_b[2] = { 9, 8 };
+    unsigned char mac[3] = { 7, 7, 7 };
+    dc_tls_session_t s;
+    memset(&s, 0, sizeof(s));
+    s.source = DC_TLS_SESSION_SOURCE_HTTP;
+    s.key = "discord.com:443";
+    s.data = blob_a;
+    s.data_len = sizeof(blob_a);
+    TEST_ASSERT_EQ(DC_OK, store.save(store.userdata, &s), "save keyed session");
+    s.data = blob_b;
+    s.data_len = sizeof(blob_b);
+    TEST_ASSERT_EQ(DC_OK, store.save(store.userdata, &s), "replace keyed session");
+    TEST_ASSERT_EQ((size_t)1u, dc_tls_memory_store_count(ms), "replaced, not appended");
+
+    s.source = DC_TLS_SESSION_SOURCE_GATEWAY;
+    s.key = "default_gateway.discord.gg_443";
+    TEST_ASSERT_EQ(DC_OK, store.save(store.userdata, &s), "save gateway session");
+    s.source = DC_TLS_SESSION_SOURCE_HTTP;
+    s.key = NULL;
+    s.shmac = mac;
+    s.shmac_len = sizeof(mac);
+    TEST_ASSERT_EQ(DC_OK, store.save(store.userdata, &s), "save shmac-only session");
+    s.shmac = NULL;
+    s.shmac_len = 0;
+    TEST_ASSERT_EQ(DC_ERROR_INVALID_PARAM, store.save(store.userdata, &s), "reject session without key or shmac");
+    s.key = "expired.example:443";
+    s.valid_until = (int64_t)time(NULL) - 10;
+    TEST_ASSERT_EQ(DC_OK, store.save(store.userdata, &s), "save expired session");
+    TEST_ASSERT_EQ((size_t)4u, dc_tls_memory_store_count(ms), "four sessions held");
+
+    test_tls_visit_t v;
+    memset(&v, 0, sizeof(v));
+    TEST_ASSERT_EQ(DC_OK, store.load(store.userdata, DC_TLS_SESSION_SOURCE_HTTP, NULL, test_tls_visit, &v),
+                   "load all http");
+    TEST_ASSERT_EQ(2, v.calls, "expired and gateway sessions skipped");
+    memset(&v, 0, sizeof(v));
+    store.load(store.userdata, DC_TLS_SESSION_SOURCE_HTTP, "discord.com:443", test_tls_visit, &v);
+    TEST_ASSERT_EQ(1, v.calls, "load by key");
+    TEST_ASSERT_EQ((size_t)2u, v.last_len, "newest data returned");
+    TEST_ASSERT_EQ(9, v.first_byte, "replaced bytes returned");
+    memset(&v, 0, sizeof(v));
+    store.load(store.userdata, DC_TLS_SESSION_SOURCE_GATEWAY, "missing", test_tls_visit, &v);
+    TEST_ASSERT_EQ(0, v.calls, "unknown key visits nothing");
+
+    /* Process-wide store and counters */
+    dc_tls_session_store_t bad = store;
+    bad.save = NULL;
+    TEST_ASSERT_EQ(DC_ERROR_INVALID_PARAM, dc_tls_sessions_set_store(&bad), "store without save rejected");
+    TEST_ASSERT_EQ(0, dc_tls_sessions_has_store(), "no store installed");
+    TEST_ASSERT_EQ(DC_ERROR_NOT_FOUND, dc_tls_sessions_store_save(&s), "save without store");
+    TEST_ASSERT_EQ(DC_OK, dc_tls_sessions_set_store(&store), "install memory store");
+    TEST_ASSERT_EQ(1, dc_tls_sessions_has_store(), "store installed");
+
+    dc_tls_sessions_reset_stats();
+    memset(&v, 0, sizeof(v));
+    TEST_ASSERT_EQ(DC_OK, dc_tls_sessions_store_load(DC_TLS_SESSION_SOURCE_GATEWAY,
+                                                     "default_gateway.discord.gg_443", test_tls_visit, &v),
+                   "load through installed store");
+    TEST_ASSERT_EQ(1, v.calls, "gateway session found");
+    dc_tls_sessions_record_gateway(0, NULL);
+    dc_tls_sessions_record_gateway(1, NULL);
+    dc_tls_sessions_record_gateway(1, NULL);
+    dc_tls_sessions_record_gateway(-1, NULL);
+    dc_tls_session_stats_t stats;
+    dc_tls_sessions_get_stats(&stats);
+    TEST_ASSERT_EQ(1u, stats.gateway.full, "gateway full counted");
+    TEST_ASSERT_EQ(2u, stats.gateway.resumed, "gateway resumed counted");
+    TEST_ASSERT_EQ(1u, stats.gateway.unclassified, "gateway unknown counted");
+    TEST_ASSERT_EQ(1u, stats.gateway.loaded, "gateway load counted");
+    TEST_ASSERT_EQ(0u, stats.http.full, "http untouched");
+    dc_tls_sessions_reset_stats();
+    dc_tls_sessions_get_stats(&stats);
+    TEST_ASSERT_EQ(0u, stats.gateway.resumed, "reset clears counters");
+    TEST_ASSERT_EQ(DC_OK, dc_tls_sessions_flush(), "flush without REST clients");
+
+    /* Kernel offload: off by default, enabling only fails in builds without kTLS support */
+    TEST_ASSERT_EQ(0, dc_tls_kernel_offload_enabled(), "offload off by default");
+    dc_status_t kst = dc_tls_set_kernel_offload(1);
+    TEST_ASSERT(kst == DC_OK || kst == DC_ERROR_NOT_IMPLEMENTED, "enable offload");
+    TEST_ASSERT_EQ(kst == DC_OK ? 1 : 0, dc_tls_kernel_offload_enabled(), "offload state follows result");
+    TEST_ASSERT_EQ(DC_OK, dc_tls_set_kernel_offload(0), "disable offload");
+    TEST_ASSERT_EQ(0, dc_tls_kernel_offload_enabled(), "offload off again");
+    int ktx = 1;
+    int krx = 1;
+    dc_tls_ktls_status(NULL, &ktx, &krx);
+    TEST_ASSERT(ktx == 0 && krx == 0, "no offload without a connection");
+    TEST_ASSERT_EQ(DC_OK, dc_tls_sessions_set_store(NULL), "uninstall store");
+    dc_tls_memory_store_free(ms);
+
+#if defined(DC_HAVE_OPENSSL) && defined(__linux__)
+    test_tls_extra_ca();
+    test_tls_loopback();
+#endif
+
+    TEST_SUITE_END("TLS Session Tests");
+}
@@ -0,0 +1,464 @@
+/**
+ * @file test_upload.c
+ * @brief Direct-to-storage upload tests against a loopback storage stand-in
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "test_utils.h"
+#include "http/dc_upload.h"
+#include "client/dc_client.h"
+#include "core/dc_platform.h"
+#include "json/dc_json.h"
+#include <yyjson.h>
+
+#if defined(__linux__)
+
+#include <pthread.h>
+#include <poll.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#define TEST_UP_FILES 4
+#define TEST_UP_BASE_SIZE 200000u
+
+/* Loopback storage: PUT /u/<n> stores the body in slot n. One thread per connection. */
+typedef struct {
+    int listen_fd;
+    uint16_t port;
+    int stop;
+    int requests;
+    int active;
+    int max_active;
+    int fail_once;          /* answer the next PUT with 503 */
+    int deny;               /* answer every PUT with 403 */
+    unsigned char* bodies[TEST_UP_FILES];
+    size_t lengths[TEST_UP_FILES];
+    char content_types[TEST_UP_FILES][64];
+    pthread_t thread;
+} test_up_server_t;
+
+typedef struct {
+    test_up_server_t* server;
+    int fd;
+} test_up_conn_t;
+
+static int test_up_send_all(int fd, const char* data) {
+    size_t len = strlen(data);
+    while (len > 0) {
+        ssize_t n = send(fd, data, len, MSG_NOSIGNAL);
+        if (n <= 0) return 0;
+        data += n;
+        len -= (size_t)n;
+    }
+    return 1;
+}
+
+static void test_up_header_value(const char* head, const char* name, char* out, size_t cap) {
+    out[0] = '\0';
+    const char* p = strstr(head, name);
+    if (!p) return;
+    p += strlen(name);
+    while (*p == ' ') p++;
+    size_t n = 0;
+    while (p[n] && p[n] != '\r' && n + 1 < cap) n++;
+    memcpy(out, p, n);
+    out[n] = '\0';
+}
+
+static void* test_up_conn_main(void* arg) {
+    test_up_conn_t* conn = (test_up_conn_t*)arg;
+    test_up_server_t* s = conn->server;
+    int fd = conn->fd;
+    free(conn);
+
+    char head[4096];
+    size_t used = 0;
+    char* body_start = NULL;
+    while (used < sizeof(head) - 1) {
+        ssize_t n = recv(fd, head + used, sizeof(head) - 1 - used, 0);
+        if (n <= 0) break;
+        used += (size_t)n;
+        head[used] = '\0';
+        body_start = strstr(head, "\r\n\r\n");
+        if (body_start) break;
+    }
+    if (!body_start) {
+        close(fd);
+        return NULL;
+    }
+    body_start += 4;
+
+    int active = __atomic_add_fetch(&s->active, 1, __ATOMIC_SEQ_CST);
+    int prev = __atomic_load_n(&s->max_active, __ATOMIC_SEQ_CST);
+    while (active > prev &&
+           !__atomic_compare_exchange_n(&s->max_active, &prev, active, 0,
+                                        __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST)) {
+    }
+    __atomic_add_fetch(&s->requests, 1, __ATOMIC_SEQ_CST);
+
+    char value[64];
+    test_up_header_value(head, "Content-Length:", value, sizeof(value));
+    size_t length = (size_t)strtoul(value, NULL, 10);
+    unsigned char* body = (unsigned char*)malloc(length + 1u);
+    size_t have = used - (size_t)(body_start - head);
+    if (have > length) have = length;
+    memcpy(body, body_start, have);
+    while (have < length) {
+        ssize_t n = recv(fd, body + have, length - have, 0);
+        if (n <= 0) break;
+        have += (size_t)n;
+    }
+    dc_platform_sleep_ms(20); /* let parallel uploads overlap */
+
+    unsigned long slot = TEST_UP_FILES;
+    if (strncmp(head, "PUT /u/", 7) == 0) slot = strtoul(head + 7, NULL, 10);
+    int fail = 1;
+    if (__atomic_load_n(&s->deny, __ATOMIC_SEQ_CST)) {
+        test_up_send_all(fd, "HTTP/1.1 403 Forbidden\r\nContent-Length: 0\r\nConnection: close\r\n\r\n");
+        free(body);
+    } else if (__atomic_compare_exchange_n(&s->fail_once, &fail, 0, 0,
+                                           __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST)) {
+        test_up_send_all(fd, "HTTP/1.1 503 Service Unavailable\r\nContent-Length: 0\r\n"
+                             "Connection: close\r\n\r\n");
+        free(body);
+    } else if (slot < TEST_UP_FILES && have == length) {
+        /* Slots are only read after the upload call returns. */
+        free(s->bodies[slot]);
+        s->bodies[slot] = body;
+        s->lengths[slot] = length;
+        test_up_header_value(head, "Content-Type:", s->content_types[slot],
+                             sizeof(s->content_types[slot]));
+        test_up_send_all(fd, "HTTP/1.1 200 OK\r\nContent-Length: 0\r\nConnection: close\r\n\r\n");
+    } else {
+        test_up_send_all(fd, "HTTP/1.1 400 Bad Request\r\nContent-Length: 0\r\nConnection: close\r\n\r\n");
+        free(body);
+    }
+    close(fd);
+    __atomic_sub_fetch(&s->active, 1, __ATOMIC_SEQ_CST);
+    return NULL;
+}
+
+static void* test_up_accept_main(void* arg) {
+    test_up_server_t* s = (test_up_server_t*)arg;
+    while (!__atomic_load_n(&s->stop, __ATOMIC_SEQ_CST)) {
+        struct pollfd pfd = { s->listen_fd, POLLIN, 0 };
+        if (poll(&pfd, 1, 50) <= 0) continue;
+        int fd = accept(s->listen_fd, NULL, NULL);
+        if (fd < 0) continue;
+        test_up_conn_t* conn = (test_up_conn_t*)malloc(sizeof(*conn));
+        conn->server = s;
+        conn->fd = fd;
+        pthread_t t;
+        if (pthread_create(&t, NULL, test_up_conn_main, conn) == 0) {
+            pthread_detach(t);
+        } else {
+            close(fd);
+            free(conn);
+        }
+    }
+    return NULL;
+}
+
+static int test_up_server_start(test_up_server_t* s) {
+    memset(s, 0, sizeof(*s));
+    s->listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (s->listen_fd < 0) return 0;
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t alen = sizeof(addr);
+    if (bind(s->listen_fd, (struct sockaddr*)&addr, sizeof(addr)) != 0 ||
+        listen(s->listen_fd, 64) != 0 ||
+        getsockname(s->listen_fd, (struct sockaddr*)&addr, &alen) != 0) {
+        close(s->listen_fd);
+        return 0;
+    }
+    s->port = ntohs(addr.sin_port);
+    return pthread_create(&s->thread, NULL, test_up_accept_main, s) == 0;
+}
+
+static void test_up_server_reset(test_up_server_t* s) {
+    for (size_t i = 0; i < TEST_UP_FILES; i++) {
+        free(s->bodies[i]);
+        s->bodies[i] = NULL;
+        s->lengths[i] = 0;
+        s->content_types[i][0] = '\0';
+    }
+    __atomic_store_n(&s->requests, 0, __ATOMIC_SEQ_CST);
+    __atomic_store_n(&s->max_active, 0, __ATOMIC_SEQ_CST);
+}
+
+static void test_up_server_stop(test_up_server_t* s) {
+    __atomic_store_n(&s->stop, 1, __ATOMIC_SEQ_CST);
+    pthread_join(s->thread, NULL);
+    close(s->listen_fd);
+    while (__atomic_load_n(&s->active, __ATOMIC_SEQ_CST) > 0) dc_platform_sleep_ms(1);
+    test_up_server_reset(s);
+}
+
+static int test_up_stored(const test_up_server_t* s, size_t slot, const unsigned char* data,
+                          size_t size) {
+    return s->bodies[slot] && s->lengths[slot] == size && memcmp(s->bodies[slot], data, size) == 0;
+}
+
+static void test_up_progress(uint64_t sent, uint64_t total, void* user_data) {
+    uint64_t* last = (uint64_t*)user_data;
+    if (sent <= total) *last = sent;
+}
+
+/* Stand-in for the API host: hands out loopback slots and records the message body. */
+typedef struct {
+    uint16_t port;
+    int slot_calls;
+    int message_calls;
+    dc_string_t slots_body;
+    dc_string_t message_body;
+} test_up_api_t;
+
+static dc_status_t test_up_api_transport(void* userdata, const dc_http_request_t* request,
+                                         dc_http_response_t* response) {
+    test_up_api_t* api = (test_up_api_t*)userdata;
+    const char* url = dc_string_cstr(&request->url);
+    if (request->method == DC_HTTP_POST && strstr(url, "/channels/42/attachments")) {
+        api->slot_calls++;
+        dc_string_set_cstr(&api->slots_body, dc_string_cstr(&request->body));
+        response->status_code = 200;
+        /* Answer out of order to prove slots are matched by id. */
+        return dc_string_printf(&response->body,
+                                "{\"attachments\":["
+                                "{\"id\":1,\"upload_url\":\"http://127.0.0.1:%u/u/1\","
+                                "\"upload_filename\":\"uploads/b.log\"},"
+                                "{\"id\":0,\"upload_url\":\"http://127.0.0.1:%u/u/0\","
+                                "\"upload_filename\":\"uploads/a.bin\"}]}",
+                                api->port, api->port);
+    }
+    if (request->method == DC_HTTP_POST && strstr(url, "/channels/42/messages")) {
+        api->message_calls++;
+        dc_string_set_cstr(&api->message_body, dc_string_cstr(&request->body));
+        response->status_code = 200;
+        return dc_string_set_cstr(&response->body, "{\"id\":\"1234567890123\",\"channel_id\":\"42\"}");
+    }
+    response->status_code = 404;
+    return dc_string_set_cstr(&response->body, "{\"message\":\"Unknown\",\"code\":0}");
+}
+
+static int test_up_write_temp(const unsigned char* data, size_t size, char* path_out) {
+    strcpy(path_out, "/tmp/dc_upload_testXXXXXX");
+    int fd = mkstemp(path_out);
+    if (fd < 0) return -1;
+    if (write(fd, data, size) != (ssize_t)size) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static void test_upload_client_flow(test_up_server_t* server, unsigned char** data, size_t* sizes) {
+    test_up_server_reset(server);
+
+    test_up_api_t api;
+    memset(&api, 0, sizeof(api));
+    api.port = server->port;
+    dc_string_init(&api.slots_body);
+    dc_string_init(&api.message_body);
+
+    dc_client_config_t cfg;
+    dc_client_config_init(&cfg);
+    cfg.token = "test_token";
+    cfg.rest_transport = test_up_api_transport;
+    cfg.rest_transport_userdata = &api;
+    dc_client_t* client = NULL;
+    TEST_ASSERT_EQ(DC_OK, dc_client_create(&cfg, &client), "client with transport override");
+
+    char path[32];
+    char path2[32];
+    int fd = test_up_write_temp(data[0], sizes[0], path);
+    TEST_ASSERT(fd >= 0, "write first temp file");
+    close(fd);
+    int fd2 = test_up_write_temp(data[1], sizes[1], path2);
+    TEST_ASSERT(fd2 >= 0, "write second temp file");
+
+    dc_client_upload_file_t files[2];
+    memset(files, 0, sizeof(files));
+    files[0].path = path;
+    files[0].filename = "a.bin";
+    files[1].path = NULL;
+    files[1].fd = fd2;
+    files[1].filename = "b.log";
+    files[1].description = "build log";
+    files[1].content_type = "text/plain";
+
+    dc_snowflake_t message_id = 0;
+    TEST_ASSERT_EQ(DC_OK,
+                   dc_client_create_message_with_uploads(client, 42,
+                                                         "{\"content\":\"hi\",\"attachments\":[]}",
+                                                         files, 2, &message_id),
+                   "create message with direct uploads");
+    TEST_ASSERT_EQ((dc_snowflake_t)1234567890123ULL, message_id, "message id parsed");
+    TEST_ASSERT_EQ(1, api.slot_calls, "one slot request");
+    TEST_ASSERT_EQ(1, api.message_calls, "one create-message request");
+    TEST_ASSERT(strstr(dc_string_cstr(&api.slots_body), "\"file_size\"") != NULL,
+                "slot request carries file sizes");
+    TEST_ASSERT(test_up_stored(server, 0, data[0], sizes[0]), "first file stored");
+    TEST_ASSERT(test_up_stored(server, 1, data[1], sizes[1]), "second file stored");
+    TEST_ASSERT_STR_EQ("text/plain", server->content_types[1], "content type forwarded");
+
+    dc_json_doc_t doc;
+    TEST_ASSERT_EQ(DC_OK, dc_json_parse(dc_string_cstr(&api.message_body), &doc), "message body parses");
+    const char* content = NULL;
+    TEST_ASSERT_EQ(DC_OK, dc_json_get_string(doc.root, "content", &content), "content kept");
+    yyjson_val* atts = NULL;
+    TEST_ASSERT_EQ(DC_OK, dc_json_get_array(doc.root, "attachments", &atts), "attachments present");
+    TEST_ASSERT_EQ((size_t)2, yyjson_arr_size(atts), "caller attachments replaced");
+    const char* uploaded = NULL;
+    dc_json_get_string(yyjson_arr_get(atts, 1), "uploaded_filename", &uploaded);
+    TEST_ASSERT_STR_EQ("uploads/b.log", uploaded, "uploaded filename matched by id");
+    const char* description = NULL;
+    dc_json_get_string(yyjson_arr_get(atts, 1), "description", &description);
+    TEST_ASSERT_STR_EQ("build log", description, "description forwarded");
+    dc_json_doc_free(&doc);
+
+    /* A storage refusal aborts before the message is created */
+    __atomic_store_n(&server->deny, 1, __ATOMIC_SEQ_CST);
+    TEST_ASSERT_EQ(DC_ERROR_FORBIDDEN,
+                   dc_client_create_message_with_uploads(client, 42, NULL, files, 2, NULL),
+                   "storage refusal surfaces");
+    TEST_ASSERT_EQ(1, api.message_calls, "no message after failed upload");
+    __atomic_store_n(&server->deny, 0, __ATOMIC_SEQ_CST);
+
+    files[0].filename = "bad/name";
+    TEST_ASSERT_EQ(DC_ERROR_INVALID_PARAM,
+                   dc_client_create_message_with_uploads(client, 42, NULL, files, 2, NULL),
+                   "invalid filename rejected");
+    TEST_ASSERT_EQ(DC_ERROR_INVALID_PARAM,
+                   dc_client_create_message_with_uploads(client, 42, NULL, files, 0, NULL),
+                   "empty file list rejected");
+
+    close(fd2);
+    unlink(path);
+    unlink(path2);
+    dc_client_free(client);
+    dc_string_free(&api.slots_body);
+    dc_string_free(&api.message_body);
+}
+
+int test_upload_main(void) {
+    TEST_SUITE_BEGIN("Upload Tests");
+
+    unsigned char* data[TEST_UP_FILES];
+    size_t sizes[TEST_UP_FILES];
+    for (size_t f = 0; f < TEST_UP_FILES; f++) {
+        sizes[f] = TEST_UP_BASE_SIZE + f * 7919u;
+        data[f] = (unsigned char*)malloc(sizes[f]);
+        for (size_t i = 0; i < sizes[f]; i++) data[f][i] = (unsigned char)((i * 131u + f) ^ (i >> 7));
+    }
+
+    test_up_server_t server;
+    TEST_ASSERT(test_up_server_start(&server), "start loopback storage");
+
+    /* All files live in one source file at different offsets. */
+    char path[] = "/tmp/dc_upload_testXXXXXX";
+    int fd = mkstemp(path);
+    TEST_ASSERT(fd >= 0, "create temp file");
+    unlink(path);
+    uint64_t offsets[TEST_UP_FILES];
+    uint64_t at = 0;
+    for (size_t f = 0; f < TEST_UP_FILES; f++) {
+        offsets[f] = at;
+        TEST_ASSERT(pwrite(fd, data[f], sizes[f], (off_t)at) == (ssize_t)sizes[f], "write source");
+        at += sizes[f];
+    }
+
+    char urls[TEST_UP_FILES][64];
+    dc_upload_item_t items[TEST_UP_FILES];
+    memset(items, 0, sizeof(items));
+    for (size_t f = 0; f < TEST_UP_FILES; f++) {
+        snprintf(urls[f], sizeof(urls[f]), "http://127.0.0.1:%u/u/%zu", server.port, f);
+        items[f].url = urls[f];
+        items[f].fd = fd;
+        items[f].offset = offsets[f];
+        items[f].size = sizes[f];
+    }
+    items[2].content_type = "image/png";
+
+    dc_uploader_t* up = NULL;
+    TEST_ASSERT_EQ(DC_OK, dc_uploader_create(&up), "create uploader");
+
+    dc_upload_options_t opt;
+    dc_upload_options_init(&opt);
+    TEST_ASSERT_EQ(4u, opt.max_connections, "default connections");
+    TEST_ASSERT_EQ(2u, opt.max_retries, "default retries");
+    opt.max_connections = 3;
+    uint64_t last_progress = 0;
+    opt.progress = test_up_progress;
+    opt.user_data = &last_progress;
+
+    /* Parallel streamed uploads */
+    TEST_ASSERT_EQ(DC_OK, dc_upload_files(up, items, TEST_UP_FILES, &opt), "parallel upload");
+    for (size_t f = 0; f < TEST_UP_FILES; f++) {
+        TEST_ASSERT(test_up_stored(&server, f, data[f], sizes[f]), "stored body matches");
+        TEST_ASSERT_EQ(DC_OK, items[f].status, "item status ok");
+        TEST_ASSERT_EQ(1u, items[f].requests, "one PUT per file");
+    }
+    TEST_ASSERT(server.max_active >= 2, "files sent in parallel");
+    TEST_ASSERT(server.max_active <= 3, "connection cap respected");
+    TEST_ASSERT_EQ(at, last_progress, "progress reaches total");
+    TEST_ASSERT_STR_EQ("image/png", server.content_types[2], "content type sent");
+    TEST_ASSERT_STR_EQ("application/octet-stream", server.content_types[0], "default content type");
+
+    /* A 5xx answer is retried from the first byte */
+    test_up_server_reset(&server);
+    __atomic_store_n(&server.fail_once, 1, __ATOMIC_SEQ_CST);
+    TEST_ASSERT_EQ(DC_OK, dc_upload_files(up, items, TEST_UP_FILES, &opt), "upload with one 503");
+    TEST_ASSERT_EQ(TEST_UP_FILES + 1, server.requests, "failed PUT retried once");
+    for (size_t f = 0; f < TEST_UP_FILES; f++) {
+        TEST_ASSERT(test_up_stored(&server, f, data[f], sizes[f]), "retried body matches");
+    }
+
+    /* A 4xx answer is final and cancels what has not finished */
+    test_up_server_reset(&server);
+    __atomic_store_n(&server.deny, 1, __ATOMIC_SEQ_CST);
+    TEST_ASSERT_EQ(DC_ERROR_FORBIDDEN, dc_upload_files(up, items, TEST_UP_FILES, &opt),
+                   "expired URL surfaces");
+    TEST_ASSERT_EQ(DC_ERROR_TRY_AGAIN, items[TEST_UP_FILES - 1].status, "queued file not attempted");
+    TEST_ASSERT(server.requests <= 3, "no retries for 4xx");
+    __atomic_store_n(&server.deny, 0, __ATOMIC_SEQ_CST);
+
+    /* A source shorter than the declared size fails instead of hanging */
+    items[0].size = at + 10u;
+    TEST_ASSERT_EQ(DC_ERROR_UNKNOWN, dc_upload_files(up, items, 1, &opt), "short source reported");
+    items[0].size = sizes[0];
+
+    items[1].fd = -1;
+    TEST_ASSERT_EQ(DC_ERROR_INVALID_PARAM, dc_upload_files(up, items, 2, &opt), "bad fd rejected");
+    items[1].fd = fd;
+    TEST_ASSERT_EQ(DC_ERROR_NULL_POINTER, dc_upload_files(NULL, items, 1, &opt), "null uploader rejected");
+    TEST_ASSERT_EQ(DC_OK, dc_upload_files(up, NULL, 0, &opt), "empty batch ok");
+
+    dc_uploader_free(up);
+    close(fd);
+
+    test_upload_client_flow(&server, data, sizes);
+
+    test_up_server_stop(&server);
+    for (size_t f = 0; f < TEST_UP_FILES; f++) free(data[f]);
+
+    TEST_SUITE_END("Upload Tests");
+}
+
+#else
+
+int test_upload_main(void) {
+    TEST_SUITE_BEGIN("Upload Tests");
+    dc_upload_options_t opt;
+    dc_upload_options_init(&opt);
+    TEST_ASSERT_EQ(4u, opt.max_connections, "default connections");
+    TEST_SUITE_END("Upload Tests");
+}
+
+#endif